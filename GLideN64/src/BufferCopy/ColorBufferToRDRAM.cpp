@@ -9,7 +9,11 @@
 #include <Config.h>
 #include <N64.h>
 #include <VI.h>
+#include <FrameBufferInfo.h>
+#include <FrameSkipper.h>
 #include "Log.h"
+#include "PBORing.h"
+#include "main/trace.h"
 #if !defined(GLES2) && !defined(GLES3)
 #include "ColorBufferToRDRAM_GL.h"
 #include "ColorBufferToRDRAM_BufferStorageExt.h"
@@ -48,6 +52,7 @@ void ColorBufferToRDRAM::init()
 
 void ColorBufferToRDRAM::destroy() {
 	_destroyFBTexure();
+	m_copyHistory.clear();
 	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 	if (m_FBO != 0) {
 		glDeleteFramebuffers(1, &m_FBO);
@@ -183,22 +188,6 @@ bool ColorBufferToRDRAM::_prepareCopy(u32 _startAddress)
 	return true;
 }
 
-u8 ColorBufferToRDRAM::_RGBAtoR8(u8 _c) {
-	return _c;
-}
-
-u16 ColorBufferToRDRAM::_RGBAtoRGBA16(u32 _c) {
-	RGBA c;
-	c.raw = _c;
-	return ((c.r >> 3) << 11) | ((c.g >> 3) << 6) | ((c.b >> 3) << 1) | (c.a == 0 ? 0 : 1);
-}
-
-u32 ColorBufferToRDRAM::_RGBAtoRGBA32(u32 _c) {
-	RGBA c;
-	c.raw = _c;
-	return (c.r << 24) | (c.g << 16) | (c.b << 8) | c.a;
-}
-
 void ColorBufferToRDRAM::_copy(u32 _startAddress, u32 _endAddress, bool _sync)
 {
 	const u32 stride = m_pCurFrameBuffer->m_width << m_pCurFrameBuffer->m_size >> 1;
@@ -216,7 +205,7 @@ void ColorBufferToRDRAM::_copy(u32 _startAddress, u32 _endAddress, bool _sync)
 	const GLint y1 = max_height - (_startAddress - m_pCurFrameBuffer->m_startAddress) / stride;
 	const GLsizei height = std::min(max_height, 1u + y1 - y0);
 
-	const bool pixelsRead = _readPixels(x0, y0, width, height, m_pCurFrameBuffer->m_size, _sync);
+	const bool pixelsRead = _readPixels(m_pCurFrameBuffer->m_startAddress, x0, y0, width, height, m_pCurFrameBuffer->m_size, _sync);
 	frameBufferList().setCurrentDrawBuffer();
 	if (!pixelsRead)
 		return;
@@ -224,28 +213,93 @@ void ColorBufferToRDRAM::_copy(u32 _startAddress, u32 _endAddress, bool _sync)
 	if (m_pCurFrameBuffer->m_size == G_IM_SIZ_32b) {
 		u32 *ptr_src = (u32*)m_pixelData.data();
 		u32 *ptr_dst = (u32*)(RDRAM + _startAddress);
-		writeToRdram<u32, u32>(ptr_src, ptr_dst, &ColorBufferToRDRAM::_RGBAtoRGBA32, 0, 0, width, height, numPixels, _startAddress, m_pCurFrameBuffer->m_startAddress, m_pCurFrameBuffer->m_size);
+		writeToRdram(ptr_src, ptr_dst, RGBA8ToRGBA32(), 0, width, height, numPixels, _startAddress, m_pCurFrameBuffer->m_startAddress, m_pCurFrameBuffer->m_size);
 	}
 	else if (m_pCurFrameBuffer->m_size == G_IM_SIZ_16b) {
 		u32 *ptr_src = (u32*)m_pixelData.data();
 		u16 *ptr_dst = (u16*)(RDRAM + _startAddress);
-		writeToRdram<u32, u16>(ptr_src, ptr_dst, &ColorBufferToRDRAM::_RGBAtoRGBA16, 0, 1, width, height, numPixels, _startAddress, m_pCurFrameBuffer->m_startAddress, m_pCurFrameBuffer->m_size);
+		writeToRdram(ptr_src, ptr_dst, RGBA8ToRGBA16(), 0, width, height, numPixels, _startAddress, m_pCurFrameBuffer->m_startAddress, m_pCurFrameBuffer->m_size);
 	}
 	else if (m_pCurFrameBuffer->m_size == G_IM_SIZ_8b) {
 		u8 *ptr_src = (u8*)m_pixelData.data();
 		u8 *ptr_dst = RDRAM + _startAddress;
-		writeToRdram<u8, u8>(ptr_src, ptr_dst, &ColorBufferToRDRAM::_RGBAtoR8, 0, 3, width, height, numPixels, _startAddress, m_pCurFrameBuffer->m_startAddress, m_pCurFrameBuffer->m_size);
+		writeToRdram(ptr_src, ptr_dst, R8ToI8(), 0, width, height, numPixels, _startAddress, m_pCurFrameBuffer->m_startAddress, m_pCurFrameBuffer->m_size);
 	}
 
 	m_pCurFrameBuffer->m_copiedToRdram = true;
 	m_pCurFrameBuffer->copyRdram();
 	m_pCurFrameBuffer->m_cleared = false;
 
+	if (config.frameBufferEmulation.copyToRDRAM == Config::ctAdaptive)
+		_updateCopyHistory(_sync);
+
 	_cleanUp();
 
 	gDP.changed |= CHANGED_SCISSOR;
 }
 
+void ColorBufferToRDRAM::_updateCopyHistory(bool _sync)
+{
+	const u32 bufferAddress = m_pCurFrameBuffer->m_startAddress;
+	auto iter = m_copyHistory.find(bufferAddress);
+	if (iter == m_copyHistory.end()) {
+		CopyHistory history;
+		history.untouchedCopies = 0;
+		history.threshold = 4;
+		history.used = true;
+		history.pending = false;
+		iter = m_copyHistory.emplace(bufferAddress, history).first;
+	}
+	CopyHistory & history = iter->second;
+	if (history.used)
+		history.untouchedCopies = 0;
+	else if (history.untouchedCopies < history.threshold)
+		++history.untouchedCopies;
+	history.used = false;
+	history.pending = !_sync;
+}
+
+bool ColorBufferToRDRAM::isUsedByCPU(u32 _address)
+{
+	// Without the core reporting reads and writes of the buffers, any of them may be used
+	if (!FBInfo::fbInfo.isTracking())
+		return true;
+
+	FrameBuffer * pBuffer = frameBufferList().findBuffer(_address);
+	if (pBuffer == nullptr)
+		return true;
+	auto iter = m_copyHistory.find(pBuffer->m_startAddress);
+	if (iter == m_copyHistory.end())
+		return true;
+
+	// Buffers the CPU left alone for long enough are copied asynchronously
+	const CopyHistory & history = iter->second;
+	return history.used || history.untouchedCopies < history.threshold;
+}
+
+void ColorBufferToRDRAM::usedByCPU(u32 _address)
+{
+	if (m_copyHistory.empty())
+		return;
+
+	FrameBuffer * pBuffer = frameBufferList().findBuffer(_address);
+	if (pBuffer == nullptr)
+		return;
+	auto iter = m_copyHistory.find(pBuffer->m_startAddress);
+	if (iter == m_copyHistory.end())
+		return;
+
+	CopyHistory & history = iter->second;
+	if (history.pending) {
+		// The buffer was copied asynchronously, but the CPU needs it. Copy the current frame now
+		// and wait longer before going asynchronous again.
+		history.pending = false;
+		history.threshold = std::min(history.threshold * 2, 256U);
+		copyToRDRAM(pBuffer->m_startAddress, true);
+	}
+	history.used = true;
+}
+
 u32 ColorBufferToRDRAM::_getRealWidth(u32 _viWidth)
 {
 	u32 index = 0;
@@ -259,8 +313,11 @@ u32 ColorBufferToRDRAM::_getRealWidth(u32 _viWidth)
 
 void ColorBufferToRDRAM::copyToRDRAM(u32 _address, bool _sync)
 {
+	TRACE_ZONE("gfx_fb_copy_to_rdram");
+
 	if (!_prepareCopy(_address))
 		return;
+	frameSkipper.readback();
 	const u32 numBytes = (m_pCurFrameBuffer->m_width*m_pCurFrameBuffer->m_height) << m_pCurFrameBuffer->m_size >> 1;
 	_copy(m_pCurFrameBuffer->m_startAddress, m_pCurFrameBuffer->m_startAddress + numBytes, _sync);
 }
@@ -269,6 +326,7 @@ void ColorBufferToRDRAM::copyChunkToRDRAM(u32 _address)
 {
 	if (!_prepareCopy(_address))
 		return;
+	frameSkipper.readback();
 	_copy(_address, _address + 0x1000, true);
 }
 
@@ -276,10 +334,7 @@ void ColorBufferToRDRAM::copyChunkToRDRAM(u32 _address)
 ColorBufferToRDRAM & ColorBufferToRDRAM::get()
 {
 #if !defined(GLES2) && !defined(GLES3)
-	static bool supportsBufferStorage = OGLVideo::isExtensionSupported("GL_EXT_buffer_storage") ||
-		OGLVideo::isExtensionSupported("GL_ARB_buffer_storage");
-
-	if (supportsBufferStorage) {
+	if (PBORing::isPersistentMappingSupported()) {
 		static ColorBufferToRDRAM_BufferStorageExt cbCopy;
 		return cbCopy;
 	} else {
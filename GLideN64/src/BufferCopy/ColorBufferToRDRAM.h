@@ -4,6 +4,7 @@
 #include <OpenGL.h>
 #include <array>
 #include <vector>
+#include <unordered_map>
 
 struct CachedTexture;
 struct FrameBuffer;
@@ -17,6 +18,12 @@ public:
 	void copyToRDRAM(u32 _address, bool _sync);
 	void copyChunkToRDRAM(u32 _address);
 
+	// Tells whether the copy of the buffer at _address must be synchronous in the adaptive copy mode
+	bool isUsedByCPU(u32 _address);
+	// The CPU reads or writes the buffer at _address. The buffer is copied again, synchronously,
+	// if its last copy was asynchronous.
+	void usedByCPU(u32 _address);
+
 	static ColorBufferToRDRAM & get();
 
 protected:
@@ -31,16 +38,9 @@ private:
 	virtual void _init() = 0;
 	virtual void _initBuffers(void) = 0;
 	virtual void _destroyBuffers(void) = 0;
-	virtual bool _readPixels(GLint _x0, GLint _y0, GLsizei _width, GLsizei _height, u32 _size, bool _sync) = 0;
+	virtual bool _readPixels(u32 _address, GLint _x0, GLint _y0, GLsizei _width, GLsizei _height, u32 _size, bool _sync) = 0;
 	virtual void _cleanUp() = 0;
 
-	union RGBA {
-		struct {
-			u8 r, g, b, a;
-		};
-		u32 raw;
-	};
-
 	void _initFBTexture(void);
 
 	void _destroyFBTexure(void);
@@ -51,10 +51,7 @@ private:
 
 	u32 _getRealWidth(u32 _viWidth);
 
-	// Convert pixel from video memory to N64 buffer format.
-	static u8 _RGBAtoR8(u8 _c);
-	static u16 _RGBAtoRGBA16(u32 _c);
-	static u32 _RGBAtoRGBA32(u32 _c);
+	void _updateCopyHistory(bool _sync);
 
 	GLuint m_FBO;
 	FrameBuffer * m_pCurFrameBuffer;
@@ -65,6 +62,15 @@ private:
 	u32 m_lastBufferHeight;
 
 	std::array<u32, 3> m_allowedRealWidths;
+
+	struct CopyHistory {
+		u32 untouchedCopies;
+		u32 threshold;
+		bool used;		// The CPU used the buffer since its last copy
+		bool pending;	// The last copy was asynchronous, RDRAM may hold an older frame
+	};
+	// Copies of each frame buffer, by buffer address
+	std::unordered_map<u32, CopyHistory> m_copyHistory;
 };
 
 void copyWhiteToRDRAM(FrameBuffer * _pBuffer);
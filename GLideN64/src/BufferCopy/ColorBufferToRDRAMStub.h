@@ -10,6 +10,6 @@ private:
 	void _init() override {}
 	void _initBuffers() override {}
 	void _destroyBuffers(void) override {}
-	bool _readPixels(GLint _x0, GLint _y0, GLsizei _width, GLsizei _height, u32 _size, bool _sync)  override {}
+	bool _readPixels(u32 _address, GLint _x0, GLint _y0, GLsizei _width, GLsizei _height, u32 _size, bool _sync)  override {}
 	void _cleanUp()  override {}
 };
@@ -1,6 +1,5 @@
 #include "ColorBufferToRDRAM.h"
-
-#include "inc/ARB_buffer_storage.h"
+#include "PBORing.h"
 
 
 class ColorBufferToRDRAM_BufferStorageExt : public ColorBufferToRDRAM
@@ -10,17 +9,10 @@ public:
 	~ColorBufferToRDRAM_BufferStorageExt() = default;
 
 private:
-	bool _readPixels(GLint _x0, GLint _y0, GLsizei _width, GLsizei _height, u32 _size, bool _sync)  override;
+	bool _readPixels(u32 _address, GLint _x0, GLint _y0, GLsizei _width, GLsizei _height, u32 _size, bool _sync)  override;
 	void _cleanUp()  override;
 	void _init(void) override;
 	void _initBuffers(void) override;
 	virtual void _destroyBuffers(void) override;
-	static const int _numPBO = 2;
-	GLuint m_PBO[_numPBO];
-	void* m_PBOData[_numPBO];
-	u32 m_curIndex;
-	GLsync m_fence[_numPBO];
-#ifdef GLESX
-	PFNGLBUFFERSTORAGEPROC glBufferStorage;
-#endif
+	PBORing m_ring;
 };
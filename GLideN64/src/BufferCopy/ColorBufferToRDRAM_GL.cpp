@@ -4,10 +4,8 @@
 
 ColorBufferToRDRAM_GL::ColorBufferToRDRAM_GL()
 	: ColorBufferToRDRAM()
-	, m_curIndex(-1)
+	, m_ring("Color buffer")
 {
-	for(int index = 0; index < _numPBO; ++index)
-		m_PBO[index] = 0;
 }
 
 void ColorBufferToRDRAM_GL::_init()
@@ -16,27 +14,15 @@ void ColorBufferToRDRAM_GL::_init()
 
 void ColorBufferToRDRAM_GL::_destroyBuffers()
 {
-	glDeleteBuffers(_numPBO, m_PBO);
-
-	for(int index = 0; index < _numPBO; ++index)
-		m_PBO[index] = 0;
+	m_ring.destroy();
 }
 
 void ColorBufferToRDRAM_GL::_initBuffers(void)
 {
-	// Generate Pixel Buffer Objects
-	glGenBuffers(_numPBO, m_PBO);
-	m_curIndex = 0;
-
-	// Initialize Pixel Buffer Objects
-	for (u32 i = 0; i < _numPBO; ++i) {
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBO[i]);
-		glBufferData(GL_PIXEL_PACK_BUFFER, m_pTexture->textureBytes, nullptr, GL_DYNAMIC_READ);
-	}
-	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	m_ring.init(m_pTexture->textureBytes, false);
 }
 
-bool ColorBufferToRDRAM_GL::_readPixels(GLint _x0, GLint _y0, GLsizei _width, GLsizei _height, u32 _size, bool _sync)
+bool ColorBufferToRDRAM_GL::_readPixels(u32 _address, GLint _x0, GLint _y0, GLsizei _width, GLsizei _height, u32 _size, bool _sync)
 {
 	GLenum colorFormat, colorType, colorFormatBytes;
 	if (_size > G_IM_SIZ_8b) {
@@ -50,19 +36,9 @@ bool ColorBufferToRDRAM_GL::_readPixels(GLint _x0, GLint _y0, GLsizei _width, GL
 	}
 
 	// If Sync, read pixels from the buffer, copy them to RDRAM.
-	// If not Sync, read pixels from the buffer, copy pixels from the previous buffer to RDRAM.
-	if (!_sync) {
-		m_curIndex ^= 1;
-		const u32 nextIndex = m_curIndex ^ 1;
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBO[m_curIndex]);
-		glReadPixels(_x0, _y0, m_pTexture->realWidth, _height, colorFormat, colorType, 0);
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBO[nextIndex]);
-	} else {
-		glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBO[_numPBO - 1]);
-		glReadPixels(_x0, _y0, m_pTexture->realWidth, _height, colorFormat, colorType, 0);
-	}
-
-	GLubyte* pixelData = (GLubyte*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_pTexture->realWidth * _height * colorFormatBytes, GL_MAP_READ_BIT);
+	// If not Sync, read pixels from the buffer, copy pixels of a finished earlier read of the same buffer to RDRAM.
+	m_ring.readPixels({ _address, _x0, _y0, (GLsizei)m_pTexture->realWidth, _height, colorFormat, colorType });
+	const GLubyte* pixelData = m_ring.getPixels(_sync);
 	if (pixelData == nullptr)
 		return false;
 
@@ -73,11 +49,11 @@ bool ColorBufferToRDRAM_GL::_readPixels(GLint _x0, GLint _y0, GLsizei _width, GL
 	for (unsigned int lnIndex = 0; lnIndex < _height; ++lnIndex) {
 		memcpy(pixelDataAlloc + lnIndex*widthBytes, pixelData + (lnIndex*strideBytes), widthBytes);
 	}
+
+	m_ring.release();
 	return true;
 }
 
 void ColorBufferToRDRAM_GL::_cleanUp()
 {
-	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
-	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 }
@@ -1,4 +1,5 @@
 #include "ColorBufferToRDRAM.h"
+#include "PBORing.h"
 
 #include <Textures.h>
 #include <FBOTextureFormats.h>
@@ -12,10 +13,8 @@ public:
 private:
 	void _init() override;
 	void _destroyBuffers() override;
-	bool _readPixels(GLint _x0, GLint _y0, GLsizei _width, GLsizei _height, u32 _size, bool _sync)  override;
+	bool _readPixels(u32 _address, GLint _x0, GLint _y0, GLsizei _width, GLsizei _height, u32 _size, bool _sync)  override;
 	void _cleanUp()  override;
 	void _initBuffers(void) override;
-	static const int _numPBO = 3;
-	GLuint m_PBO[_numPBO];
-	u32 m_curIndex;
+	PBORing m_ring;
 };
@@ -12,12 +12,14 @@
 #include <Config.h>
 #include <N64.h>
 #include <VI.h>
+#include <FrameSkipper.h>
+#include "main/trace.h"
 
 #ifndef GLES2
 
 DepthBufferToRDRAM::DepthBufferToRDRAM()
 	: m_FBO(0)
-	, m_PBO(0)
+	, m_ring("Depth buffer")
 	, m_frameCount(-1)
 	, m_pColorTexture(nullptr)
 	,	m_pDepthTexture(nullptr)
@@ -98,10 +100,7 @@ void DepthBufferToRDRAM::init()
 	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 
 	// Generate and initialize Pixel Buffer Objects
-	glGenBuffers(1, &m_PBO);
-	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBO);
-	glBufferData(GL_PIXEL_PACK_BUFFER, m_pDepthTexture->realWidth * m_pDepthTexture->realHeight * sizeof(float), nullptr, GL_DYNAMIC_READ);
-	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	m_ring.init(m_pDepthTexture->realWidth * m_pDepthTexture->realHeight * sizeof(float), PBORing::isPersistentMappingSupported());
 }
 
 void DepthBufferToRDRAM::destroy() {
@@ -116,10 +115,7 @@ void DepthBufferToRDRAM::destroy() {
 		textureCache().removeFrameBufferTexture(m_pDepthTexture);
 		m_pDepthTexture = nullptr;
 	}
-	if (m_PBO != 0) {
-		glDeleteBuffers(1, &m_PBO);
-		m_PBO = 0;
-	}
+	m_ring.destroy();
 }
 
 bool DepthBufferToRDRAM::_prepareCopy(u32 _address, bool _copyChunk)
@@ -163,17 +159,6 @@ bool DepthBufferToRDRAM::_prepareCopy(u32 _address, bool _copyChunk)
 	return true;
 }
 
-u16 DepthBufferToRDRAM::_FloatToUInt16(f32 _z)
-{
-	static const u16 * const zLUT = depthBufferList().getZLUT();
-	u32 idx = 0x3FFFF;
-	if (_z < 1.0f) {
-		_z *= 262144.0f;
-		idx = std::min(0x3FFFFU, u32(floorf(_z + 0.5f)));
-	}
-	return zLUT[idx];
-}
-
 bool DepthBufferToRDRAM::_copy(u32 _startAddress, u32 _endAddress)
 {
 	const u32 stride = m_pCurDepthBuffer->m_width << 1;
@@ -191,37 +176,39 @@ bool DepthBufferToRDRAM::_copy(u32 _startAddress, u32 _endAddress)
 	const GLint y1 = max_height - (_startAddress - m_pCurDepthBuffer->m_address) / stride;
 	const GLsizei height = std::min(max_height, 1u + y1 - y0);
 
-	PBOBinder binder(GL_PIXEL_PACK_BUFFER, m_PBO);
 	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_FBO);
-	glReadPixels(x0, y0, width, height, fboFormats.depthFormat, fboFormats.depthType, 0);
-
-	GLubyte* pixelData = (GLubyte*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, width * height * fboFormats.depthFormatBytes, GL_MAP_READ_BIT);
+	// The CPU tests depth values of the current frame, so the read is always synchronous.
+	m_ring.readPixels({ m_pCurDepthBuffer->m_address, x0, y0, width, height, fboFormats.depthFormat, fboFormats.depthType });
+	const GLubyte* pixelData = m_ring.getPixels(true);
 	if (pixelData == nullptr)
 		return false;
 
-	f32 * ptr_src = (f32*)pixelData;
+	const f32 * ptr_src = (const f32*)pixelData;
 	u16 *ptr_dst = (u16*)(RDRAM + _startAddress);
 
 	std::vector<f32> srcBuf(width * height);
 	memcpy(srcBuf.data(), ptr_src, width * height * sizeof(f32));
-	writeToRdram<f32, u16>(srcBuf.data(), ptr_dst, &DepthBufferToRDRAM::_FloatToUInt16, 2.0f, 1, width, height, numPixels, _startAddress, m_pCurDepthBuffer->m_address, G_IM_SIZ_16b);
+	writeToRdram(srcBuf.data(), ptr_dst, DepthToZ16(depthBufferList().getZLUT()), 2.0f, width, height, numPixels, _startAddress, m_pCurDepthBuffer->m_address, G_IM_SIZ_16b);
 
 	m_pCurDepthBuffer->m_cleared = false;
 	FrameBuffer * pBuffer = frameBufferList().findBuffer(m_pCurDepthBuffer->m_address);
 	if (pBuffer != nullptr)
 		pBuffer->m_cleared = false;
 
-	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	m_ring.release();
 	gDP.changed |= CHANGED_SCISSOR;
 	return true;
 }
 
 bool DepthBufferToRDRAM::copyToRDRAM(u32 _address)
 {
+	TRACE_ZONE("gfx_depth_copy_to_rdram");
+
 	if (config.frameBufferEmulation.copyDepthToRDRAM == Config::cdSoftwareRender)
 		return true;
 	if (!_prepareCopy(_address, false))
 		return false;
+	frameSkipper.readback();
 
 	const u32 endAddress = m_pCurDepthBuffer->m_address + (std::min(VI.height, m_pCurDepthBuffer->m_lry) * m_pCurDepthBuffer->m_width * 2);
 	return _copy(m_pCurDepthBuffer->m_address, endAddress);
@@ -233,6 +220,7 @@ bool DepthBufferToRDRAM::copyChunkToRDRAM(u32 _address)
 		return true;
 	if (!_prepareCopy(_address, true))
 		return false;
+	frameSkipper.readback();
 
 	const u32 endAddress = _address + 0x1000;
 	return _copy(_address, endAddress);
@@ -2,6 +2,7 @@
 #define DepthBufferToRDRAM_H
 
 #include <OpenGL.h>
+#include "PBORing.h"
 
 struct CachedTexture;
 struct DepthBuffer;
@@ -24,11 +25,8 @@ private:
 	bool _prepareCopy(u32 _address, bool _copyChunk);
 	bool _copy(u32 _startAddress, u32 _endAddress);
 
-	// Convert pixel from video memory to N64 depth buffer format.
-	static u16 _FloatToUInt16(f32 _z);
-
 	GLuint m_FBO;
-	GLuint m_PBO;
+	PBORing m_ring;
 	u32 m_frameCount;
 	CachedTexture * m_pColorTexture;
 	CachedTexture * m_pDepthTexture;
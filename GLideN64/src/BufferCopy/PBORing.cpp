@@ -0,0 +1,234 @@
+#include <assert.h>
+
+#include "PBORing.h"
+
+#include <Log.h>
+
+#if defined(EGL) || defined(GLESX)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#ifndef GLES2
+
+bool PBORing::Request::operator==(const Request & _other) const
+{
+	return address == _other.address &&
+		x0 == _other.x0 &&
+		y0 == _other.y0 &&
+		width == _other.width &&
+		height == _other.height &&
+		format == _other.format &&
+		type == _other.type;
+}
+
+PBORing::PBORing(const char * _name)
+	: m_curIndex(0)
+	, m_serial(0)
+	, m_bufferSize(0)
+	, m_persistent(false)
+	, m_pMapped(nullptr)
+	, m_name(_name)
+	, m_stallsAvoided(0)
+	, m_stallsForced(0)
+	, m_syncFallbacks(0)
+{
+#if defined(GLESX) && !defined(GLES2)
+	glBufferStorage = (PFNGLBUFFERSTORAGEPROC)eglGetProcAddress("glBufferStorageEXT");
+#endif
+
+	for (u32 index = 0; index < _numPBO; ++index) {
+		m_slots[index].PBO = 0;
+		m_slots[index].data = nullptr;
+		m_slots[index].fence = 0;
+		m_slots[index].serial = 0;
+	}
+}
+
+bool PBORing::isPersistentMappingSupported()
+{
+#ifdef GLES3
+	return false;
+#else
+	static bool supportsBufferStorage = OGLVideo::isExtensionSupported("GL_EXT_buffer_storage") ||
+		OGLVideo::isExtensionSupported("GL_ARB_buffer_storage");
+	return supportsBufferStorage;
+#endif
+}
+
+void PBORing::init(GLsizeiptr _bufferSize, bool _persistent)
+{
+	m_bufferSize = _bufferSize;
+	m_persistent = _persistent;
+	m_curIndex = 0;
+	m_serial = 0;
+	m_pMapped = nullptr;
+
+	for (u32 index = 0; index < _numPBO; ++index) {
+		Slot & slot = m_slots[index];
+		glGenBuffers(1, &slot.PBO);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+		slot.fence = 0;
+		slot.serial = 0;
+		slot.data = nullptr;
+#ifndef GLES3
+		if (m_persistent) {
+			glBufferStorage(GL_PIXEL_PACK_BUFFER, m_bufferSize, nullptr, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_CLIENT_STORAGE_BIT);
+			slot.data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_bufferSize, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT);
+			continue;
+		}
+#endif
+		glBufferData(GL_PIXEL_PACK_BUFFER, m_bufferSize, nullptr, GL_DYNAMIC_READ);
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void PBORing::destroy()
+{
+	release();
+
+	if (m_stallsAvoided != 0 || m_stallsForced != 0)
+		LOG(LOG_VERBOSE, "%s read-back: %u GPU stalls avoided, %u GPU stalls forced, %u fence waits failed\n", m_name, m_stallsAvoided, m_stallsForced, m_syncFallbacks);
+
+	for (u32 index = 0; index < _numPBO; ++index) {
+		Slot & slot = m_slots[index];
+		_deleteFence(slot);
+		if (slot.PBO != 0) {
+			// Deleting a buffer unmaps it
+			glDeleteBuffers(1, &slot.PBO);
+			slot.PBO = 0;
+		}
+		slot.data = nullptr;
+		slot.serial = 0;
+	}
+	std::vector<GLubyte>().swap(m_syncPixels);
+}
+
+void PBORing::readPixels(const Request & _request)
+{
+	assert(m_pMapped == nullptr);
+
+	m_curIndex = (m_curIndex + 1) % _numPBO;
+	Slot & slot = m_slots[m_curIndex];
+	_deleteFence(slot);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+	glReadPixels(_request.x0, _request.y0, _request.width, _request.height, _request.format, _request.type, 0);
+
+#ifndef GLES3
+	// Make the data visible through the persistent mapping once the fence is signaled
+	if (m_persistent)
+		glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+#endif
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	slot.request = _request;
+	slot.frame = video().getBuffersSwapCount();
+	slot.serial = ++m_serial;
+}
+
+const GLubyte * PBORing::getPixels(bool _sync)
+{
+	Slot * pSlot = &m_slots[m_curIndex];
+
+	if (!_sync) {
+		// Look for the newest finished read of the same area
+		const u32 curFrame = video().getBuffersSwapCount();
+		Slot * pReady = nullptr;
+		for (u32 index = 0; index < _numPBO; ++index) {
+			Slot & slot = m_slots[index];
+			if (index == m_curIndex || slot.serial == 0 || !(slot.request == pSlot->request))
+				continue;
+			if (curFrame - slot.frame > _maxAge)
+				continue;
+			if (pReady != nullptr && pReady->serial > slot.serial)
+				continue;
+			if (_isReady(slot))
+				pReady = &slot;
+		}
+		if (pReady != nullptr) {
+			++m_stallsAvoided;
+			pSlot = pReady;
+		}
+	}
+
+	if (pSlot == &m_slots[m_curIndex] && !_isReady(*pSlot)) {
+		++m_stallsForced;
+		if (!_wait(*pSlot))
+			return _readPixelsSync(pSlot->request);
+	}
+
+	void * data = pSlot->data;
+	if (!m_persistent) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pSlot->PBO);
+		data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_bufferSize, GL_MAP_READ_BIT);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+	if (data == nullptr)
+		return nullptr;
+
+	m_pMapped = pSlot;
+	return reinterpret_cast<const GLubyte*>(data);
+}
+
+void PBORing::release()
+{
+	if (m_pMapped == nullptr)
+		return;
+
+	if (!m_persistent) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pMapped->PBO);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+	m_pMapped = nullptr;
+}
+
+bool PBORing::_isReady(Slot & _slot)
+{
+	if (_slot.fence == 0)
+		return _slot.serial != 0;
+
+	const GLenum res = glClientWaitSync(_slot.fence, 0, 0);
+	if (res != GL_ALREADY_SIGNALED && res != GL_CONDITION_SATISFIED)
+		return false;
+
+	_deleteFence(_slot);
+	return true;
+}
+
+bool PBORing::_wait(Slot & _slot)
+{
+	if (_slot.fence == 0)
+		return _slot.serial != 0;
+
+	const GLenum res = glClientWaitSync(_slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+	_deleteFence(_slot);
+	if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED)
+		return true;
+
+	// The GPU may still write the buffer. Never serve it.
+	_slot.serial = 0;
+	return false;
+}
+
+const GLubyte * PBORing::_readPixelsSync(const Request & _request)
+{
+	++m_syncFallbacks;
+	m_syncPixels.resize(m_bufferSize);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	glReadPixels(_request.x0, _request.y0, _request.width, _request.height, _request.format, _request.type, m_syncPixels.data());
+	return m_syncPixels.data();
+}
+
+void PBORing::_deleteFence(Slot & _slot)
+{
+	if (_slot.fence != 0) {
+		glDeleteSync(_slot.fence);
+		_slot.fence = 0;
+	}
+}
+
+#endif // GLES2
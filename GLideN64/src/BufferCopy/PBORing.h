@@ -0,0 +1,87 @@
+#ifndef PBORing_H
+#define PBORing_H
+
+#include <OpenGL.h>
+#include <vector>
+
+#if defined(GLESX) && !defined(GLES2)
+#include "inc/ARB_buffer_storage.h"
+#endif
+
+// Ring of pixel pack buffers used to read frame buffers back to the CPU.
+// Each read is fenced. A read the caller does not need immediately is served from
+// an earlier read of the same area which the GPU has already completed, so that
+// the caller does not wait for the GPU to finish the current frame.
+class PBORing
+{
+public:
+	// Identifies the frame buffer area a read was made from
+	struct Request {
+		u32 address;
+		GLint x0;
+		GLint y0;
+		GLsizei width;
+		GLsizei height;
+		GLenum format;
+		GLenum type;
+
+		bool operator==(const Request & _other) const;
+	};
+
+	PBORing(const char * _name);
+	~PBORing() = default;
+
+	void init(GLsizeiptr _bufferSize, bool _persistent);
+	void destroy();
+
+	// Reads the area of the bound read frame buffer into the next buffer of the ring.
+	void readPixels(const Request & _request);
+
+	// Returns the pixels of the last request, or of an earlier completed read of
+	// the same area if _sync is false. If the wait for the GPU fails or times out,
+	// the area is read again without a buffer. The returned data is valid until release().
+	const GLubyte * getPixels(bool _sync);
+	void release();
+
+	u32 getStallsAvoided() const { return m_stallsAvoided; }
+	u32 getStallsForced() const { return m_stallsForced; }
+
+	static bool isPersistentMappingSupported();
+
+private:
+	struct Slot {
+		GLuint PBO;
+		void * data;
+		GLsync fence;
+		Request request;
+		u32 frame;
+		u32 serial;
+	};
+
+	bool _isReady(Slot & _slot);
+	bool _wait(Slot & _slot);
+	const GLubyte * _readPixelsSync(const Request & _request);
+	void _deleteFence(Slot & _slot);
+
+	static const u32 _numPBO = 3;
+	// Reads older than that many frames are not served to asynchronous requests
+	static const u32 _maxAge = 2;
+	Slot m_slots[_numPBO];
+	u32 m_curIndex;
+	u32 m_serial;
+	GLsizeiptr m_bufferSize;
+	bool m_persistent;
+	Slot * m_pMapped;
+	const char * m_name;
+
+	u32 m_stallsAvoided;
+	u32 m_stallsForced;
+	u32 m_syncFallbacks;
+	std::vector<GLubyte> m_syncPixels;
+
+#if defined(GLESX) && !defined(GLES2)
+	PFNGLBUFFERSTORAGEPROC glBufferStorage;
+#endif
+};
+
+#endif // PBORing_H
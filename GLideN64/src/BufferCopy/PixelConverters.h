@@ -0,0 +1,366 @@
+#ifndef PixelConverters_H
+#define PixelConverters_H
+
+#include <math.h>
+#include <algorithm>
+
+#include "../Types.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIXEL_CONVERTERS_SSE2
+#include <emmintrin.h>
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+#elif defined(__ARM_NEON) && !defined(__ARMEB__) && !defined(__AARCH64EB__)
+#define PIXEL_CONVERTERS_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(PIXEL_CONVERTERS_SSE2) || defined(PIXEL_CONVERTERS_NEON)
+#define PIXEL_CONVERTERS_SIMD
+#endif
+
+/*
+ * Pixel format converters for copies between frame buffers and RDRAM.
+ *
+ * Each converter converts one pixel with operator() and blockSize pixels at
+ * once with convertBlock(). RDRAM keeps 16-bit and 8-bit pixels swizzled
+ * within each 32-bit word, so pixel i of a buffer is at index i ^ xorMask.
+ * convertBlock() expects the RDRAM side of the block to begin on a 32-bit word,
+ * which keeps the swizzle inside the block.
+ *
+ * Converters to RDRAM leave pixels equal to the test value untouched.
+ * Converters from RDRAM return the sum of the pixels they read.
+ */
+
+#ifdef PIXEL_CONVERTERS_SSE2
+
+// Swaps the 16-bit halves of each 32-bit word.
+static inline __m128i _swap16(__m128i _v)
+{
+	_v = _mm_shufflelo_epi16(_v, _MM_SHUFFLE(2, 3, 0, 1));
+	return _mm_shufflehi_epi16(_v, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+// Reverses the bytes of each 32-bit word.
+static inline __m128i _bswap32(__m128i _v)
+{
+#ifdef __SSSE3__
+	return _mm_shuffle_epi8(_v, _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3));
+#else
+	_v = _mm_or_si128(_mm_slli_epi16(_v, 8), _mm_srli_epi16(_v, 8));
+	return _swap16(_v);
+#endif
+}
+
+// Packs 32-bit words holding 16-bit values into 16-bit words.
+static inline __m128i _pack32to16(__m128i _lo, __m128i _hi)
+{
+	_lo = _mm_srai_epi32(_mm_slli_epi32(_lo, 16), 16);
+	_hi = _mm_srai_epi32(_mm_slli_epi32(_hi, 16), 16);
+	return _mm_packs_epi32(_lo, _hi);
+}
+
+// Takes _new where _keep is zero and _old elsewhere.
+static inline __m128i _select(__m128i _keep, __m128i _old, __m128i _new)
+{
+	return _mm_or_si128(_mm_and_si128(_keep, _old), _mm_andnot_si128(_keep, _new));
+}
+
+static inline u32 _horizontalSum(__m128i _v)
+{
+	_v = _mm_add_epi32(_v, _mm_shuffle_epi32(_v, _MM_SHUFFLE(1, 0, 3, 2)));
+	_v = _mm_add_epi32(_v, _mm_shuffle_epi32(_v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return (u32)_mm_cvtsi128_si32(_v);
+}
+
+#endif // PIXEL_CONVERTERS_SSE2
+
+// Frame buffer pixel as read by glReadPixels.
+union PixelRGBA8 {
+	struct {
+		u8 r, g, b, a;
+	};
+	u32 raw;
+};
+
+// Frame buffer RGBA8888 to RDRAM RGBA5551.
+struct RGBA8ToRGBA16
+{
+	typedef u32 Src;
+	typedef u16 Dst;
+	static const u32 xorMask = 1;
+	static const u32 blockSize = 8;
+
+	Dst operator()(Src _c) const
+	{
+		PixelRGBA8 c;
+		c.raw = _c;
+		return ((c.r >> 3) << 11) | ((c.g >> 3) << 6) | ((c.b >> 3) << 1) | (c.a == 0 ? 0 : 1);
+	}
+
+#if defined(PIXEL_CONVERTERS_SSE2)
+	static __m128i _convert4(__m128i _c)
+	{
+		const __m128i r = _mm_and_si128(_mm_slli_epi32(_c, 8), _mm_set1_epi32(0xF800));
+		const __m128i g = _mm_and_si128(_mm_srli_epi32(_c, 5), _mm_set1_epi32(0x07C0));
+		const __m128i b = _mm_and_si128(_mm_srli_epi32(_c, 18), _mm_set1_epi32(0x003E));
+		const __m128i transparent = _mm_cmpeq_epi32(_mm_srli_epi32(_c, 24), _mm_setzero_si128());
+		const __m128i a = _mm_andnot_si128(transparent, _mm_set1_epi32(1));
+		return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+	}
+
+	void convertBlock(const Src * _src, Dst * _dst, Src _testValue) const
+	{
+		const __m128i c0 = _mm_loadu_si128((const __m128i*)_src);
+		const __m128i c1 = _mm_loadu_si128((const __m128i*)(_src + 4));
+		const __m128i test = _mm_set1_epi32(_testValue);
+		const __m128i keep = _mm_packs_epi32(_mm_cmpeq_epi32(c0, test), _mm_cmpeq_epi32(c1, test));
+		const __m128i old = _swap16(_mm_loadu_si128((const __m128i*)_dst));
+		const __m128i res = _select(keep, old, _pack32to16(_convert4(c0), _convert4(c1)));
+		_mm_storeu_si128((__m128i*)_dst, _swap16(res));
+	}
+#elif defined(PIXEL_CONVERTERS_NEON)
+	static uint16x4_t _convert4(uint32x4_t _c)
+	{
+		const uint32x4_t r = vandq_u32(vshlq_n_u32(_c, 8), vdupq_n_u32(0xF800));
+		const uint32x4_t g = vandq_u32(vshrq_n_u32(_c, 5), vdupq_n_u32(0x07C0));
+		const uint32x4_t b = vandq_u32(vshrq_n_u32(_c, 18), vdupq_n_u32(0x003E));
+		const uint32x4_t a = vminq_u32(vshrq_n_u32(_c, 24), vdupq_n_u32(1));
+		return vmovn_u32(vorrq_u32(vorrq_u32(r, g), vorrq_u32(b, a)));
+	}
+
+	void convertBlock(const Src * _src, Dst * _dst, Src _testValue) const
+	{
+		const uint32x4_t c0 = vld1q_u32(_src);
+		const uint32x4_t c1 = vld1q_u32(_src + 4);
+		const uint32x4_t test = vdupq_n_u32(_testValue);
+		const uint16x8_t keep = vcombine_u16(vmovn_u32(vceqq_u32(c0, test)), vmovn_u32(vceqq_u32(c1, test)));
+		const uint16x8_t old = vrev32q_u16(vld1q_u16(_dst));
+		const uint16x8_t res = vbslq_u16(keep, old, vcombine_u16(_convert4(c0), _convert4(c1)));
+		vst1q_u16(_dst, vrev32q_u16(res));
+	}
+#endif
+};
+
+// Frame buffer RGBA8888 to RDRAM RGBA8888, which is stored big-endian.
+struct RGBA8ToRGBA32
+{
+	typedef u32 Src;
+	typedef u32 Dst;
+	static const u32 xorMask = 0;
+	static const u32 blockSize = 4;
+
+	Dst operator()(Src _c) const
+	{
+		PixelRGBA8 c;
+		c.raw = _c;
+		return (c.r << 24) | (c.g << 16) | (c.b << 8) | c.a;
+	}
+
+#if defined(PIXEL_CONVERTERS_SSE2)
+	void convertBlock(const Src * _src, Dst * _dst, Src _testValue) const
+	{
+		const __m128i c = _mm_loadu_si128((const __m128i*)_src);
+		const __m128i keep = _mm_cmpeq_epi32(c, _mm_set1_epi32(_testValue));
+		const __m128i old = _mm_loadu_si128((const __m128i*)_dst);
+		_mm_storeu_si128((__m128i*)_dst, _select(keep, old, _bswap32(c)));
+	}
+#elif defined(PIXEL_CONVERTERS_NEON)
+	void convertBlock(const Src * _src, Dst * _dst, Src _testValue) const
+	{
+		const uint32x4_t c = vld1q_u32(_src);
+		const uint32x4_t keep = vceqq_u32(c, vdupq_n_u32(_testValue));
+		const uint32x4_t res = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(c)));
+		vst1q_u32(_dst, vbslq_u32(keep, vld1q_u32(_dst), res));
+	}
+#endif
+};
+
+// Frame buffer red channel to RDRAM I8.
+struct R8ToI8
+{
+	typedef u8 Src;
+	typedef u8 Dst;
+	static const u32 xorMask = 3;
+	static const u32 blockSize = 16;
+
+	Dst operator()(Src _c) const
+	{
+		return _c;
+	}
+
+#if defined(PIXEL_CONVERTERS_SSE2)
+	void convertBlock(const Src * _src, Dst * _dst, Src _testValue) const
+	{
+		const __m128i c = _mm_loadu_si128((const __m128i*)_src);
+		const __m128i keep = _mm_cmpeq_epi8(c, _mm_set1_epi8((char)_testValue));
+		const __m128i old = _bswap32(_mm_loadu_si128((const __m128i*)_dst));
+		_mm_storeu_si128((__m128i*)_dst, _bswap32(_select(keep, old, c)));
+	}
+#elif defined(PIXEL_CONVERTERS_NEON)
+	void convertBlock(const Src * _src, Dst * _dst, Src _testValue) const
+	{
+		const uint8x16_t c = vld1q_u8(_src);
+		const uint8x16_t keep = vceqq_u8(c, vdupq_n_u8(_testValue));
+		const uint8x16_t old = vrev32q_u8(vld1q_u8(_dst));
+		vst1q_u8(_dst, vrev32q_u8(vbslq_u8(keep, old, c)));
+	}
+#endif
+};
+
+// Frame buffer depth to RDRAM 16-bit depth, looked up in the depth buffer LUT.
+struct DepthToZ16
+{
+	typedef f32 Src;
+	typedef u16 Dst;
+	static const u32 xorMask = 1;
+	static const u32 blockSize = 8;
+
+	explicit DepthToZ16(const u16 * _zLUT) : m_zLUT(_zLUT) {}
+
+	Dst operator()(Src _z) const
+	{
+		u32 idx = 0x3FFFF;
+		if (_z < 1.0f) {
+			_z *= 262144.0f;
+			idx = std::min(0x3FFFFU, u32(floorf(_z + 0.5f)));
+		}
+		return m_zLUT[idx];
+	}
+
+#ifdef PIXEL_CONVERTERS_SIMD
+	// Only the LUT index is computed in vectors: the lookup itself is a gather.
+	void convertBlock(const Src * _src, Dst * _dst, Src _testValue) const
+	{
+		u32 idx[blockSize];
+#if defined(PIXEL_CONVERTERS_SSE2)
+		for (u32 i = 0; i < blockSize; i += 4) {
+			const __m128 z = _mm_loadu_ps(_src + i);
+			__m128 t = _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(262144.0f)), _mm_set1_ps(0.5f));
+			t = _mm_max_ps(_mm_min_ps(t, _mm_set1_ps(262143.0f)), _mm_setzero_ps());
+			const __m128i below = _mm_castps_si128(_mm_cmplt_ps(z, _mm_set1_ps(1.0f)));
+			const __m128i res = _select(below, _mm_cvttps_epi32(t), _mm_set1_epi32(0x3FFFF));
+			_mm_storeu_si128((__m128i*)(idx + i), res);
+		}
+#else
+		for (u32 i = 0; i < blockSize; i += 4) {
+			const float32x4_t z = vld1q_f32(_src + i);
+			float32x4_t t = vmlaq_f32(vdupq_n_f32(0.5f), z, vdupq_n_f32(262144.0f));
+			t = vmaxq_f32(vminq_f32(t, vdupq_n_f32(262143.0f)), vdupq_n_f32(0.0f));
+			const uint32x4_t below = vcltq_f32(z, vdupq_n_f32(1.0f));
+			vst1q_u32(idx + i, vbslq_u32(below, vcvtq_u32_f32(t), vdupq_n_u32(0x3FFFF)));
+		}
+#endif
+		for (u32 i = 0; i < blockSize; ++i) {
+			if (_src[i] != _testValue)
+				_dst[i ^ xorMask] = m_zLUT[idx[i]];
+		}
+	}
+#endif
+
+	const u16 * m_zLUT;
+};
+
+// RDRAM RGBA5551 to frame buffer RGBA8888.
+struct RGBA16ToABGR8
+{
+	typedef u16 Src;
+	typedef u32 Dst;
+	static const u32 xorMask = 1;
+	static const u32 blockSize = 8;
+
+	// A color frame buffer (_bCFB) is drawn opaque, whatever its alpha bits.
+	explicit RGBA16ToABGR8(bool _bCFB) : m_alpha(_bCFB ? 0xFF000000 : 0) {}
+
+	Dst operator()(Src _c) const
+	{
+		const u32 r = ((_c >> 11) & 31) << 3;
+		const u32 g = ((_c >> 6) & 31) << 3;
+		const u32 b = ((_c >> 1) & 31) << 3;
+		const u32 a = (_c & 1) > 0 ? 0xFF000000 : m_alpha;
+		return a | (b << 16) | (g << 8) | r;
+	}
+
+#if defined(PIXEL_CONVERTERS_SSE2)
+	__m128i _convert4(__m128i _c) const
+	{
+		const __m128i r = _mm_and_si128(_mm_srli_epi32(_c, 8), _mm_set1_epi32(0x0000F8));
+		const __m128i g = _mm_and_si128(_mm_slli_epi32(_c, 5), _mm_set1_epi32(0x00F800));
+		const __m128i b = _mm_and_si128(_mm_slli_epi32(_c, 18), _mm_set1_epi32(0xF80000));
+		const __m128i a = _mm_or_si128(_mm_srai_epi32(_mm_slli_epi32(_c, 31), 7), _mm_set1_epi32(m_alpha));
+		return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+	}
+
+	u32 convertBlock(const Src * _src, Dst * _dst) const
+	{
+		const __m128i c = _swap16(_mm_loadu_si128((const __m128i*)_src));
+		const __m128i c0 = _mm_unpacklo_epi16(c, _mm_setzero_si128());
+		const __m128i c1 = _mm_unpackhi_epi16(c, _mm_setzero_si128());
+		_mm_storeu_si128((__m128i*)_dst, _convert4(c0));
+		_mm_storeu_si128((__m128i*)(_dst + 4), _convert4(c1));
+		return _horizontalSum(_mm_add_epi32(c0, c1));
+	}
+#elif defined(PIXEL_CONVERTERS_NEON)
+	uint32x4_t _convert4(uint32x4_t _c) const
+	{
+		const uint32x4_t r = vandq_u32(vshrq_n_u32(_c, 8), vdupq_n_u32(0x0000F8));
+		const uint32x4_t g = vandq_u32(vshlq_n_u32(_c, 5), vdupq_n_u32(0x00F800));
+		const uint32x4_t b = vandq_u32(vshlq_n_u32(_c, 18), vdupq_n_u32(0xF80000));
+		const uint32x4_t a1 = vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(vshlq_n_u32(_c, 31)), 7));
+		const uint32x4_t a = vorrq_u32(a1, vdupq_n_u32(m_alpha));
+		return vorrq_u32(vorrq_u32(r, g), vorrq_u32(b, a));
+	}
+
+	u32 convertBlock(const Src * _src, Dst * _dst) const
+	{
+		const uint16x8_t c = vrev32q_u16(vld1q_u16(_src));
+		const uint32x4_t c0 = vmovl_u16(vget_low_u16(c));
+		const uint32x4_t c1 = vmovl_u16(vget_high_u16(c));
+		vst1q_u32(_dst, _convert4(c0));
+		vst1q_u32(_dst + 4, _convert4(c1));
+		const uint32x4_t s = vaddq_u32(c0, c1);
+		return vgetq_lane_u32(s, 0) + vgetq_lane_u32(s, 1) + vgetq_lane_u32(s, 2) + vgetq_lane_u32(s, 3);
+	}
+#endif
+
+	const u32 m_alpha;
+};
+
+// RDRAM RGBA8888, stored big-endian, to frame buffer RGBA8888.
+struct RGBA32ToABGR8
+{
+	typedef u32 Src;
+	typedef u32 Dst;
+	static const u32 xorMask = 0;
+	static const u32 blockSize = 4;
+
+	explicit RGBA32ToABGR8(bool _bCFB) : m_alpha(_bCFB ? 0xFF000000 : 0) {}
+
+	Dst operator()(Src _c) const
+	{
+		return ((_c << 24) | ((_c & 0xFF00) << 8) | ((_c >> 8) & 0xFF00) | (_c >> 24)) | m_alpha;
+	}
+
+#if defined(PIXEL_CONVERTERS_SSE2)
+	u32 convertBlock(const Src * _src, Dst * _dst) const
+	{
+		const __m128i c = _mm_loadu_si128((const __m128i*)_src);
+		_mm_storeu_si128((__m128i*)_dst, _mm_or_si128(_bswap32(c), _mm_set1_epi32(m_alpha)));
+		return _horizontalSum(c);
+	}
+#elif defined(PIXEL_CONVERTERS_NEON)
+	u32 convertBlock(const Src * _src, Dst * _dst) const
+	{
+		const uint32x4_t c = vld1q_u32(_src);
+		const uint32x4_t res = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(c)));
+		vst1q_u32(_dst, vorrq_u32(res, vdupq_n_u32(m_alpha)));
+		return vgetq_lane_u32(c, 0) + vgetq_lane_u32(c, 1) + vgetq_lane_u32(c, 2) + vgetq_lane_u32(c, 3);
+	}
+#endif
+
+	const u32 m_alpha;
+};
+
+#endif // PixelConverters_H
@@ -1,4 +1,6 @@
 #include "RDRAMtoColorBuffer.h"
+#include "PixelConverters.h"
+#include "ReadFromRDRAM.h"
 
 #include <FBOTextureFormats.h>
 #include <FrameBufferInfo.h>
@@ -9,6 +11,7 @@
 #include <Config.h>
 #include <N64.h>
 #include <VI.h>
+#include "main/trace.h"
 
 RDRAMtoColorBuffer::RDRAMtoColorBuffer()
 	: m_pCurBuffer(nullptr)
@@ -71,37 +74,22 @@ void RDRAMtoColorBuffer::addAddress(u32 _address, u32 _size)
 }
 
 // Write the whole buffer
-template <typename TSrc>
-bool _copyBufferFromRdram(u32 _address, u32* _dst, u32(*converter)(TSrc _c, bool _bCFB), u32 _xor, u32 _x0, u32 _y0, u32 _width, u32 _height, bool _bCFB)
+template <typename TConverter>
+bool _copyBufferFromRdram(u32 _address, u32* _dst, const TConverter & _converter, u32 _x0, u32 _y0, u32 _width, u32 _height)
 {
-	TSrc * src = reinterpret_cast<TSrc*>(RDRAM + _address);
+	typedef typename TConverter::Src TSrc;
+	const TSrc * src = reinterpret_cast<const TSrc*>(RDRAM + _address);
 	const u32 bound = (RDRAMSize + 1 - _address) >> (sizeof(TSrc) / 2);
-	TSrc col;
-	u32 idx;
-	u32 summ = 0;
-	u32 dsty = 0;
-	const u32 y1 = _y0 + _height;
-	for (u32 y = _y0; y < y1; ++y) {
-		for (u32 x = _x0; x < _width; ++x) {
-			idx = (x + (_height - y - 1)*_width) ^ _xor;
-			if (idx >= bound)
-				break;
-			col = src[idx];
-			summ += col;
-			_dst[x + dsty*_width] = converter(col, _bCFB);
-		}
-		++dsty;
-	}
-
-	return summ != 0;
+	return readFromRdram(src, bound, _dst, _converter, _x0, _y0, _width, _height) != 0;
 }
 
 // Write only pixels provided with FBWrite
-template <typename TSrc>
-bool _copyPixelsFromRdram(u32 _address, const std::vector<u32> & _vecAddress, u32* _dst, u32(*converter)(TSrc _c, bool _bCFB), u32 _xor, u32 _width, u32 _height, bool _bCFB)
+template <typename TConverter>
+bool _copyPixelsFromRdram(u32 _address, const std::vector<u32> & _vecAddress, u32* _dst, const TConverter & _converter, u32 _width, u32 _height)
 {
+	typedef typename TConverter::Src TSrc;
 	memset(_dst, 0, _width*_height*sizeof(u32));
-	TSrc * src = reinterpret_cast<TSrc*>(RDRAM + _address);
+	const TSrc * src = reinterpret_cast<const TSrc*>(RDRAM + _address);
 	const u32 szPixel = sizeof(TSrc);
 	const size_t numPixels = _vecAddress.size();
 	TSrc col;
@@ -117,42 +105,16 @@ bool _copyPixelsFromRdram(u32 _address, const std::vector<u32> & _vecAddress, u3
 			return false;
 		col = src[idx];
 		summ += col;
-		_dst[(w + (_height - h)*_width) ^ _xor] = converter(col, _bCFB);
+		_dst[(w + (_height - h)*_width) ^ TConverter::xorMask] = _converter(col);
 	}
 
 	return summ != 0;
 }
 
-static
-u32 RGBA16ToABGR32(u16 col, bool _bCFB)
-{
-	u32 r, g, b, a;
-	r = ((col >> 11) & 31) << 3;
-	g = ((col >> 6) & 31) << 3;
-	b = ((col >> 1) & 31) << 3;
-	if (_bCFB)
-		a = 0xFF;
-	else
-		a = (col & 1) > 0 ? 0xFF : 0U;
-	return ((a << 24) | (b << 16) | (g << 8) | r);
-}
-
-static
-u32 RGBA32ToABGR32(u32 col, bool _bCFB)
-{
-	u32 r, g, b, a;
-	r = (col >> 24) & 0xff;
-	g = (col >> 16) & 0xff;
-	b = (col >> 8) & 0xff;
-	if (_bCFB)
-		a = 0xFF;
-	else
-		a = col & 0xFF;
-	return ((a << 24) | (b << 16) | (g << 8) | r);
-}
-
 void RDRAMtoColorBuffer::copyFromRDRAM(u32 _address, bool _bCFB)
 {
+	TRACE_ZONE("gfx_fb_copy_from_rdram");
+
 	Cleaner cleaner(this);
 
 	if (m_pCurBuffer == nullptr) {
@@ -190,15 +152,15 @@ void RDRAMtoColorBuffer::copyFromRDRAM(u32 _address, bool _bCFB)
 	bool bCopy;
 	if (m_vecAddress.empty()) {
 		if (m_pCurBuffer->m_size == G_IM_SIZ_16b)
-			bCopy = _copyBufferFromRdram<u16>(address, dst, RGBA16ToABGR32, 1, x0, y0, width, height, _bCFB);
+			bCopy = _copyBufferFromRdram(address, dst, RGBA16ToABGR8(_bCFB), x0, y0, width, height);
 		else
-			bCopy = _copyBufferFromRdram<u32>(address, dst, RGBA32ToABGR32, 0, x0, y0, width, height, _bCFB);
+			bCopy = _copyBufferFromRdram(address, dst, RGBA32ToABGR8(_bCFB), x0, y0, width, height);
 	}
 	else {
 		if (m_pCurBuffer->m_size == G_IM_SIZ_16b)
-			bCopy = _copyPixelsFromRdram<u16>(address, m_vecAddress, dst, RGBA16ToABGR32, 1, width, height, _bCFB);
+			bCopy = _copyPixelsFromRdram(address, m_vecAddress, dst, RGBA16ToABGR8(_bCFB), width, height);
 		else
-			bCopy = _copyPixelsFromRdram<u32>(address, m_vecAddress, dst, RGBA32ToABGR32, 0, width, height, _bCFB);
+			bCopy = _copyPixelsFromRdram(address, m_vecAddress, dst, RGBA32ToABGR8(_bCFB), width, height);
 	}
 
 	if (bUseAlpha) {
@@ -0,0 +1,48 @@
+#ifndef ReadFromRDRAM_H
+#define ReadFromRDRAM_H
+
+
+#include "../Types.h"
+#include "PixelConverters.h"
+
+// Converts the pixels of RDRAM buffer _src to frame buffer _dst, flipping it vertically.
+// Pixels from index _bound of _src on are left out. Returns the sum of the pixels read.
+template <typename TConverter>
+u32 readFromRdram(const typename TConverter::Src * _src, u32 _bound, u32* _dst, const TConverter & _converter, u32 _x0, u32 _y0, u32 _width, u32 _height)
+{
+	const u32 xorMask = TConverter::xorMask;
+	typename TConverter::Src col;
+	u32 idx;
+	u32 summ = 0;
+	u32 dsty = 0;
+	const u32 y1 = _y0 + _height;
+	for (u32 y = _y0; y < y1; ++y) {
+		const u32 rowStart = (_height - y - 1)*_width;
+		u32 x = _x0;
+#ifdef PIXEL_CONVERTERS_SIMD
+		for (; x < _width && ((rowStart + x) & xorMask) != 0; ++x) {
+			idx = (x + rowStart) ^ xorMask;
+			if (idx >= _bound)
+				break;
+			col = _src[idx];
+			summ += col;
+			_dst[x + dsty*_width] = _converter(col);
+		}
+		for (; x + TConverter::blockSize <= _width && rowStart + x + TConverter::blockSize <= _bound; x += TConverter::blockSize)
+			summ += _converter.convertBlock(_src + rowStart + x, _dst + x + dsty*_width);
+#endif
+		for (; x < _width; ++x) {
+			idx = (x + rowStart) ^ xorMask;
+			if (idx >= _bound)
+				break;
+			col = _src[idx];
+			summ += col;
+			_dst[x + dsty*_width] = _converter(col);
+		}
+		++dsty;
+	}
+
+	return summ;
+}
+
+#endif // ReadFromRDRAM_H
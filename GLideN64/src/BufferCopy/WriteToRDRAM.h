@@ -3,9 +3,34 @@
 
 
 #include "../Types.h"
+#include "PixelConverters.h"
 
-template <typename TSrc, typename TDst>
-void writeToRdram(TSrc* _src, TDst* _dst, TDst(*converter)(TSrc _c), TSrc _testValue, u32 _xor, u32 _width, u32 _height, u32 _numPixels, u32 _startAddress, u32 _bufferAddress, u32 _bufferSize)
+// Converts _count pixels of a frame buffer row to _dst[(_first + x) ^ xorMask].
+template <typename TConverter>
+void writeRowToRdram(const TConverter & _converter, const typename TConverter::Src * _src, typename TConverter::Dst * _dst, u32 _first, u32 _count, typename TConverter::Src _testValue)
+{
+	const u32 xorMask = TConverter::xorMask;
+	typename TConverter::Src c;
+	u32 x = 0;
+#ifdef PIXEL_CONVERTERS_SIMD
+	for (; x < _count && ((_first + x) & xorMask) != 0; ++x) {
+		c = _src[x];
+		if (c != _testValue)
+			_dst[(_first + x) ^ xorMask] = _converter(c);
+	}
+	for (; x + TConverter::blockSize <= _count; x += TConverter::blockSize)
+		_converter.convertBlock(_src + x, _dst + _first + x, _testValue);
+#endif
+	for (; x < _count; ++x) {
+		c = _src[x];
+		if (c != _testValue)
+			_dst[(_first + x) ^ xorMask] = _converter(c);
+	}
+}
+
+// The frame buffer is read bottom-up, so its rows are written to RDRAM in reverse order.
+template <typename TConverter>
+void writeToRdram(const typename TConverter::Src * _src, typename TConverter::Dst * _dst, const TConverter & _converter, typename TConverter::Src _testValue, u32 _width, u32 _height, u32 _numPixels, u32 _startAddress, u32 _bufferAddress, u32 _bufferSize)
 {
 	u32 chunkStart = ((_startAddress - _bufferAddress) >> (_bufferSize - 1)) % _width;
 	if (chunkStart % 2 != 0) {
@@ -16,26 +41,18 @@ void writeToRdram(TSrc* _src, TDst* _dst, TDst(*converter)(TSrc _c), TSrc _testV
 
 	u32 numStored = 0;
 	u32 y = 0;
-	TSrc c;
 	if (chunkStart > 0) {
-		for (u32 x = chunkStart; x < _width; ++x) {
-			c = _src[x + (_height - 1)*_width];
-			if (c != _testValue)
-				_dst[numStored ^ _xor] = converter(c);
-			++numStored;
-		}
+		numStored = _width - chunkStart;
+		writeRowToRdram(_converter, _src + chunkStart + (_height - 1)*_width, _dst, 0, numStored, _testValue);
 		++y;
 		_dst += numStored;
 	}
 
 	u32 dsty = 0;
-	for (; y < _height; ++y) {
-		for (u32 x = 0; x < _width && numStored < _numPixels; ++x) {
-			c = _src[x + (_height - y - 1)*_width];
-			if (c != _testValue)
-				_dst[(x + dsty*_width) ^ _xor] = converter(c);
-			++numStored;
-		}
+	for (; y < _height && numStored < _numPixels; ++y) {
+		const u32 count = std::min(_width, _numPixels - numStored);
+		writeRowToRdram(_converter, _src + (_height - y - 1)*_width, _dst, dsty*_width, count, _testValue);
+		numStored += count;
 		++dsty;
 	}
 }
@@ -0,0 +1,360 @@
+// Checks the pixel converters of PixelConverters.h, as used by writeToRdram and
+// readFromRdram, against the scalar copy loops they replaced, and measures them.
+//
+//   test_pixel_converters            correctness, exits with 1 on mismatches
+//   test_pixel_converters --bench    throughput of 640x480 copies, both ways
+//
+// Makefile.gcc builds it once per instruction set, the plain C path included
+// (-U__SSE2__ or -U__ARM_NEON leave PixelConverters.h without SIMD).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "../WriteToRDRAM.h"
+#include "../ReadFromRDRAM.h"
+
+namespace {
+
+// The copies as they were before the converters, kept as the reference.
+namespace reference {
+
+union RGBA {
+	struct {
+		u8 r, g, b, a;
+	};
+	u32 raw;
+};
+
+u8 RGBAtoR8(u8 _c) {
+	return _c;
+}
+
+u16 RGBAtoRGBA16(u32 _c) {
+	RGBA c;
+	c.raw = _c;
+	return ((c.r >> 3) << 11) | ((c.g >> 3) << 6) | ((c.b >> 3) << 1) | (c.a == 0 ? 0 : 1);
+}
+
+u32 RGBAtoRGBA32(u32 _c) {
+	RGBA c;
+	c.raw = _c;
+	return (c.r << 24) | (c.g << 16) | (c.b << 8) | c.a;
+}
+
+const u16 * zLUT;
+
+u16 FloatToUInt16(f32 _z)
+{
+	u32 idx = 0x3FFFF;
+	if (_z < 1.0f) {
+		_z *= 262144.0f;
+		idx = std::min(0x3FFFFU, u32(floorf(_z + 0.5f)));
+	}
+	return zLUT[idx];
+}
+
+template <typename TSrc, typename TDst>
+void writeToRdram(TSrc* _src, TDst* _dst, TDst(*converter)(TSrc _c), TSrc _testValue, u32 _xor, u32 _width, u32 _height, u32 _numPixels, u32 _startAddress, u32 _bufferAddress, u32 _bufferSize)
+{
+	u32 chunkStart = ((_startAddress - _bufferAddress) >> (_bufferSize - 1)) % _width;
+	if (chunkStart % 2 != 0) {
+		--chunkStart;
+		--_dst;
+		++_numPixels;
+	}
+
+	u32 numStored = 0;
+	u32 y = 0;
+	TSrc c;
+	if (chunkStart > 0) {
+		for (u32 x = chunkStart; x < _width; ++x) {
+			c = _src[x + (_height - 1)*_width];
+			if (c != _testValue)
+				_dst[numStored ^ _xor] = converter(c);
+			++numStored;
+		}
+		++y;
+		_dst += numStored;
+	}
+
+	u32 dsty = 0;
+	for (; y < _height; ++y) {
+		for (u32 x = 0; x < _width && numStored < _numPixels; ++x) {
+			c = _src[x + (_height - y - 1)*_width];
+			if (c != _testValue)
+				_dst[(x + dsty*_width) ^ _xor] = converter(c);
+			++numStored;
+		}
+		++dsty;
+	}
+}
+
+u32 RGBA16ToABGR32(u16 col, bool _bCFB)
+{
+	u32 r, g, b, a;
+	r = ((col >> 11) & 31) << 3;
+	g = ((col >> 6) & 31) << 3;
+	b = ((col >> 1) & 31) << 3;
+	if (_bCFB)
+		a = 0xFF;
+	else
+		a = (col & 1) > 0 ? 0xFF : 0U;
+	return ((a << 24) | (b << 16) | (g << 8) | r);
+}
+
+u32 RGBA32ToABGR32(u32 col, bool _bCFB)
+{
+	u32 r, g, b, a;
+	r = (col >> 24) & 0xff;
+	g = (col >> 16) & 0xff;
+	b = (col >> 8) & 0xff;
+	if (_bCFB)
+		a = 0xFF;
+	else
+		a = col & 0xFF;
+	return ((a << 24) | (b << 16) | (g << 8) | r);
+}
+
+template <typename TSrc>
+u32 readFromRdram(const TSrc * src, u32 bound, u32* _dst, u32(*converter)(TSrc _c, bool _bCFB), u32 _xor, u32 _x0, u32 _y0, u32 _width, u32 _height, bool _bCFB)
+{
+	TSrc col;
+	u32 idx;
+	u32 summ = 0;
+	u32 dsty = 0;
+	const u32 y1 = _y0 + _height;
+	for (u32 y = _y0; y < y1; ++y) {
+		for (u32 x = _x0; x < _width; ++x) {
+			idx = (x + (_height - y - 1)*_width) ^ _xor;
+			if (idx >= bound)
+				break;
+			col = src[idx];
+			summ += col;
+			_dst[x + dsty*_width] = converter(col, _bCFB);
+		}
+		++dsty;
+	}
+
+	return summ;
+}
+
+} // namespace reference
+
+u32 s_seed = 1;
+
+u32 rnd()
+{
+	s_seed = s_seed * 1103515245U + 12345U;
+	return (s_seed >> 16) | (s_seed << 16);
+}
+
+template <typename T>
+T randomPixel(T _testValue)
+{
+	// Every eighth pixel is the test value, which the copy must skip.
+	if (rnd() % 8 == 0)
+		return _testValue;
+	return T(rnd());
+}
+
+template <>
+f32 randomPixel(f32 _testValue)
+{
+	switch (rnd() % 8) {
+	case 0:
+		return _testValue;
+	case 1:
+		return 1.0f;
+	case 2:
+		return 0.0f;
+	case 3:
+		return f32(rnd() % 262144) / 262144.0f + 0.5f / 262144.0f;
+	}
+	return f32(rnd() & 0xFFFFFF) / f32(0x1000000);
+}
+
+int s_failures = 0;
+int s_cases = 0;
+
+// RDRAM of the test: the copy may write one pixel before its start, so each
+// buffer is placed after a guard area, which must stay untouched like the rest.
+const u32 GUARD = 64;
+
+template <typename TConverter>
+void testWrite(const char * _name, const TConverter & _converter, typename TConverter::Dst(*_reference)(typename TConverter::Src),
+	typename TConverter::Src _testValue, u32 _bufferSize)
+{
+	typedef typename TConverter::Src TSrc;
+	typedef typename TConverter::Dst TDst;
+
+	for (u32 i = 0; i < 400; ++i) {
+		const u32 width = 1 + rnd() % 80 + (i % 4 == 0 ? 320 : 0);
+		const u32 height = 1 + rnd() % 24;
+		const u32 chunkStart = rnd() % 3 == 0 ? rnd() % width : 0;
+		const u32 numPixels = std::max(1U, (width * height - chunkStart) - rnd() % (width * height - chunkStart));
+		const u32 bufferAddress = 0x100000;
+		const u32 startAddress = bufferAddress + (chunkStart << (_bufferSize - 1));
+
+		std::vector<TSrc> src(width * height);
+		for (TSrc & c : src)
+			c = randomPixel(_testValue);
+		std::vector<TDst> expected(width * height + 2 * GUARD);
+		for (TDst & c : expected)
+			c = TDst(rnd());
+		std::vector<TDst> result(expected);
+
+		reference::writeToRdram<TSrc, TDst>(src.data(), expected.data() + GUARD, _reference, _testValue, TConverter::xorMask,
+			width, height, numPixels, startAddress, bufferAddress, _bufferSize);
+		writeToRdram(src.data(), result.data() + GUARD, _converter, _testValue,
+			width, height, numPixels, startAddress, bufferAddress, _bufferSize);
+
+		++s_cases;
+		if (memcmp(expected.data(), result.data(), expected.size() * sizeof(TDst)) != 0) {
+			++s_failures;
+			fprintf(stderr, "%s: %ux%u, %u pixels from %u differ\n", _name, width, height, numPixels, chunkStart);
+		}
+	}
+}
+
+template <typename TConverter>
+void testRead(const char * _name, bool _bCFB, u32(*_reference)(typename TConverter::Src, bool))
+{
+	typedef typename TConverter::Src TSrc;
+	const TConverter converter(_bCFB);
+
+	for (u32 i = 0; i < 400; ++i) {
+		const u32 width = 1 + rnd() % 80 + (i % 4 == 0 ? 320 : 0);
+		const u32 height = 1 + rnd() % 24;
+		const u32 x0 = rnd() % 4 == 0 ? rnd() % width : 0;
+		// Some copies run past the end of RDRAM.
+		const u32 bound = rnd() % 4 == 0 ? rnd() % (width * height + 1) : width * height;
+
+		std::vector<TSrc> src(width * height);
+		for (TSrc & c : src)
+			c = TSrc(rnd() % 16 == 0 ? 0 : rnd());
+		std::vector<u32> expected(width * height);
+		for (u32 & c : expected)
+			c = rnd();
+		std::vector<u32> result(expected);
+
+		const u32 expectedSum = reference::readFromRdram<TSrc>(src.data(), bound, expected.data(), _reference, TConverter::xorMask,
+			x0, 0, width, height, _bCFB);
+		const u32 sum = readFromRdram(src.data(), bound, result.data(), converter, x0, 0, width, height);
+
+		++s_cases;
+		if (sum != expectedSum || expected != result) {
+			++s_failures;
+			fprintf(stderr, "%s: %ux%u from %u, bound %u differ\n", _name, width, height, x0, bound);
+		}
+	}
+}
+
+template <typename TFunc>
+double megapixelsPerSecond(u32 _pixels, TFunc _copy)
+{
+	const u32 runs = 200;
+	_copy();
+	const auto start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < runs; ++i)
+		_copy();
+	const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+	return _pixels * double(runs) / seconds.count() / 1e6;
+}
+
+template <typename TConverter>
+void benchWrite(const char * _name, const TConverter & _converter, typename TConverter::Dst(*_reference)(typename TConverter::Src),
+	typename TConverter::Src _testValue, u32 _bufferSize)
+{
+	typedef typename TConverter::Src TSrc;
+	typedef typename TConverter::Dst TDst;
+	const u32 width = 640, height = 480;
+
+	std::vector<TSrc> src(width * height);
+	for (TSrc & c : src)
+		c = randomPixel(_testValue);
+	std::vector<TDst> dst(width * height);
+
+	const double before = megapixelsPerSecond(width * height, [&]() {
+		reference::writeToRdram<TSrc, TDst>(src.data(), dst.data(), _reference, _testValue, TConverter::xorMask,
+			width, height, width * height, 0, 0, _bufferSize);
+	});
+	const double after = megapixelsPerSecond(width * height, [&]() {
+		writeToRdram(src.data(), dst.data(), _converter, _testValue,
+			width, height, width * height, 0, 0, _bufferSize);
+	});
+	printf("%-16s %10.1f %10.1f %6.2fx\n", _name, before, after, after / before);
+}
+
+template <typename TConverter>
+void benchRead(const char * _name, u32(*_reference)(typename TConverter::Src, bool))
+{
+	typedef typename TConverter::Src TSrc;
+	const u32 width = 640, height = 480;
+	const TConverter converter(false);
+
+	std::vector<TSrc> src(width * height);
+	for (TSrc & c : src)
+		c = TSrc(rnd());
+	std::vector<u32> dst(width * height);
+	volatile u32 sum = 0;
+
+	const double before = megapixelsPerSecond(width * height, [&]() {
+		sum += reference::readFromRdram<TSrc>(src.data(), width * height, dst.data(), _reference, TConverter::xorMask,
+			0, 0, width, height, false);
+	});
+	const double after = megapixelsPerSecond(width * height, [&]() {
+		sum += readFromRdram(src.data(), width * height, dst.data(), converter, 0, 0, width, height);
+	});
+	printf("%-16s %10.1f %10.1f %6.2fx\n", _name, before, after, after / before);
+}
+
+const char * instructionSet()
+{
+#if defined(PIXEL_CONVERTERS_SSE2) && defined(__SSSE3__)
+	return "SSSE3";
+#elif defined(PIXEL_CONVERTERS_SSE2)
+	return "SSE2";
+#elif defined(PIXEL_CONVERTERS_NEON)
+	return "NEON";
+#else
+	return "scalar";
+#endif
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	std::vector<u16> zLUT(0x40000);
+	for (u16 & z : zLUT)
+		z = u16(rnd());
+	reference::zLUT = zLUT.data();
+	const DepthToZ16 depthToZ16(zLUT.data());
+
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+		printf("640x480 copies, %s, Mpixel/s\n", instructionSet());
+		printf("%-16s %10s %10s %7s\n", "", "scalar", "converter", "");
+		benchWrite("RGBA8 to RGBA16", RGBA8ToRGBA16(), reference::RGBAtoRGBA16, 0U, 2);
+		benchWrite("RGBA8 to RGBA32", RGBA8ToRGBA32(), reference::RGBAtoRGBA32, 0U, 3);
+		benchWrite("R8 to I8", R8ToI8(), reference::RGBAtoR8, u8(0), 1);
+		benchWrite("depth to Z16", depthToZ16, reference::FloatToUInt16, 2.0f, 2);
+		benchRead<RGBA16ToABGR8>("RGBA16 to RGBA8", reference::RGBA16ToABGR32);
+		benchRead<RGBA32ToABGR8>("RGBA32 to RGBA8", reference::RGBA32ToABGR32);
+		return 0;
+	}
+
+	testWrite("RGBA8 to RGBA16", RGBA8ToRGBA16(), reference::RGBAtoRGBA16, 0U, 2);
+	testWrite("RGBA8 to RGBA32", RGBA8ToRGBA32(), reference::RGBAtoRGBA32, 0U, 3);
+	testWrite("R8 to I8", R8ToI8(), reference::RGBAtoR8, u8(0), 1);
+	testWrite("depth to Z16", depthToZ16, reference::FloatToUInt16, 2.0f, 2);
+	for (int bCFB = 0; bCFB < 2; ++bCFB) {
+		testRead<RGBA16ToABGR8>("RGBA16 to RGBA8", bCFB != 0, reference::RGBA16ToABGR32);
+		testRead<RGBA32ToABGR8>("RGBA32 to RGBA8", bCFB != 0, reference::RGBA32ToABGR32);
+	}
+
+	printf("%s: %d of %d copies differ\n", instructionSet(), s_failures, s_cases);
+	return s_failures != 0 ? 1 : 0;
+}
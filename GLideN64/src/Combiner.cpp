@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <functional>
 #include <stdio.h>
@@ -7,11 +9,14 @@
 #include "Combiner.h"
 #include "GLSLCombiner.h"
 #include "UniformCollection.h"
+#include "ShaderUtils.h"
 #include "Debug.h"
 #include "gDP.h"
 #include "Config.h"
 #include "PluginAPI.h"
 #include "RSP.h"
+#include "Log.h"
+#include "main/trace.h"
 
 static int saRGBExpanded[] =
 {
@@ -75,6 +80,7 @@ void Combiner_Init() {
 	CombinerInfo & cmbInfo = CombinerInfo::get();
 	cmbInfo.init();
 	InitShaderCombiner();
+	cmbInfo.precompile();
 	if (cmbInfo.getCombinersNumber() == 0) {
 		gDP.otherMode.cycleType = G_CYC_COPY;
 		cmbInfo.setCombine(EncodeCombineMode(0, 0, 0, TEXEL0, 0, 0, 0, TEXEL0, 0, 0, 0, TEXEL0, 0, 0, 0, TEXEL0));
@@ -113,15 +119,74 @@ void CombinerInfo::init()
 			delete cur->second;
 		m_combiners.clear();
 	}
+
+	m_bParallelCompile = OGLVideo::isExtensionSupported("GL_KHR_parallel_shader_compile") ||
+						OGLVideo::isExtensionSupported("GL_ARB_parallel_shader_compile");
+	m_frames = 0;
+	m_numCompiled = 0;
+	m_numPrecompiled = 0;
+	m_uberShaderUses = 0;
+	m_stallTime = 0.0;
+	m_maxStall = 0.0;
+}
+
+void CombinerInfo::precompile()
+{
+	if (config.generalEmulation.enableAsyncShaderCompile != 0)
+		m_pUberShader = ShaderCombiner::createUberShader();
+	if (m_pUberShader != nullptr) {
+		m_pUberShader->update(true);
+		m_pUniformCollection->bindWithShaderCombiner(m_pUberShader);
+	}
+
+	// HW lighting depends on the microcode, which is not known yet.
+	if (config.generalEmulation.enableShadersStorage == 0 || config.generalEmulation.enableHWLighting != 0)
+		return;
+
+	std::vector<u64> keys;
+	if (!_loadCombinerKeys(keys))
+		return;
+
+	const u32 cycleType = gDP.otherMode.cycleType;
+	for (u32 i = 0; i < keys.size(); ++i) {
+		if (m_combiners.find(keys[i]) != m_combiners.end())
+			continue;
+		gDPCombine combine;
+		combine.mux = keys[i];
+		gDP.otherMode.cycleType = combine.muxs0 >> 24;
+		combine.muxs0 &= 0x00FFFFFF;
+		ShaderCombiner * pCombiner = _compile(combine.mux);
+		m_combiners[keys[i]] = pCombiner;
+		++m_numPrecompiled;
+		if (m_pUberShader != nullptr && !pCombiner->usesLOD())
+			m_pending[keys[i]] = m_frames;
+		else
+			_finishCompile(pCombiner, true);
+	}
+	gDP.otherMode.cycleType = cycleType;
 }
 
 void CombinerInfo::destroy()
 {
+	if (m_pUniformCollection != nullptr && m_pUniformCollection->getFrames() != 0)
+		LOG(LOG_VERBOSE, "Uniform uploads per frame: %u average, %u max\n",
+			m_pUniformCollection->getAverageUploads(), m_pUniformCollection->getMaxUploads());
+	if (m_numCompiled + m_numPrecompiled != 0)
+		LOG(LOG_VERBOSE, "Combiners: %u compiled while drawing, %u precompiled, %u uber-shader uses; compile stalls %.1f ms total, %.1f ms max\n",
+			m_numCompiled, m_numPrecompiled, m_uberShaderUses, m_stallTime, m_maxStall);
+	// Pending programs are finished, so that they can be saved
+	for (PendingCombiners::const_iterator cur = m_pending.begin(); cur != m_pending.end(); ++cur)
+		m_combiners.at(cur->first)->finishCompile();
+	m_pending.clear();
 	delete m_pUniformCollection;
 	m_pUniformCollection = nullptr;
 	m_pCurrent = nullptr;
+	delete m_pUberShader;
+	m_pUberShader = nullptr;
 	if (m_bShaderCacheSupported)
 		_saveShadersStorage();
+	if (config.generalEmulation.enableShadersStorage != 0)
+		_saveCombinerKeys();
 	m_shadersLoaded = 0;
 	for (Combiners::iterator cur = m_combiners.begin(); cur != m_combiners.end(); ++cur)
 		delete cur->second;
@@ -188,63 +253,105 @@ void SimplifyCycle( CombineCycle *cc, CombinerStage *stage )
 	}
 }
 
+// Decodes and expands the combine mode into the cycles of each combiner stage.
+// Returns the number of stages.
+static
+int DecodeCombine(const gDPCombine & _combine, CombineCycle * _cc, CombineCycle * _ac)
+{
+	// The last cycle is the only stage outside of 2 cycle mode
+	CombineCycle & cc1 = gDP.otherMode.cycleType != G_CYC_2CYCLE ? _cc[0] : _cc[1];
+	CombineCycle & ac1 = gDP.otherMode.cycleType != G_CYC_2CYCLE ? _ac[0] : _ac[1];
+	cc1.sa = saRGBExpanded[_combine.saRGB1];
+	cc1.sb = sbRGBExpanded[_combine.sbRGB1];
+	cc1.m  = mRGBExpanded[_combine.mRGB1];
+	cc1.a  = aRGBExpanded[_combine.aRGB1];
+	ac1.sa = saAExpanded[_combine.saA1];
+	ac1.sb = sbAExpanded[_combine.sbA1];
+	ac1.m  = mAExpanded[_combine.mA1];
+	ac1.a  = aAExpanded[_combine.aA1];
+
+	if (gDP.otherMode.cycleType != G_CYC_2CYCLE)
+		return 1;
+
+	_cc[0].sa = saRGBExpanded[_combine.saRGB0];
+	_cc[0].sb = sbRGBExpanded[_combine.sbRGB0];
+	_cc[0].m = mRGBExpanded[_combine.mRGB0];
+	_cc[0].a = aRGBExpanded[_combine.aRGB0];
+	_ac[0].sa = saAExpanded[_combine.saA0];
+	_ac[0].sb = sbAExpanded[_combine.sbA0];
+	_ac[0].m = mAExpanded[_combine.mA0];
+	_ac[0].a = aAExpanded[_combine.aA0];
+
+	const bool equalStages = (memcmp(_cc, _cc + 1, sizeof(CombineCycle)) | memcmp(_ac, _ac + 1, sizeof(CombineCycle))) == 0;
+	return equalStages ? 1 : 2;
+}
+
 ShaderCombiner * CombinerInfo::_compile(u64 mux) const
 {
+	TRACE_ZONE("gfx_shader_compile");
+
 	gDPCombine combine;
 
 	combine.mux = mux;
 
-	int numCycles;
-
 	Combiner color, alpha;
 
-	numCycles = gDP.otherMode.cycleType + 1;
-	color.numStages = numCycles;
-	alpha.numStages = numCycles;
-
 	CombineCycle cc[2];
 	CombineCycle ac[2];
 
-	// Decode and expand the combine mode into a more general form
-	cc[1].sa = saRGBExpanded[combine.saRGB1];
-	cc[1].sb = sbRGBExpanded[combine.sbRGB1];
-	cc[1].m  = mRGBExpanded[combine.mRGB1];
-	cc[1].a  = aRGBExpanded[combine.aRGB1];
-	ac[1].sa = saAExpanded[combine.saA1];
-	ac[1].sb = sbAExpanded[combine.sbA1];
-	ac[1].m  = mAExpanded[combine.mA1];
-	ac[1].a  = aAExpanded[combine.aA1];
+	const int numStages = DecodeCombine(combine, cc, ac);
+	color.numStages = numStages;
+	alpha.numStages = numStages;
 
 	// Simplify each RDP combiner cycle into a combiner stage
-	if (gDP.otherMode.cycleType != G_CYC_2CYCLE) {
-		SimplifyCycle(&cc[1], &color.stage[0]);
-		SimplifyCycle(&ac[1], &alpha.stage[0]);
-	} else {
-		cc[0].sa = saRGBExpanded[combine.saRGB0];
-		cc[0].sb = sbRGBExpanded[combine.sbRGB0];
-		cc[0].m = mRGBExpanded[combine.mRGB0];
-		cc[0].a = aRGBExpanded[combine.aRGB0];
-		ac[0].sa = saAExpanded[combine.saA0];
-		ac[0].sb = sbAExpanded[combine.sbA0];
-		ac[0].m = mAExpanded[combine.mA0];
-		ac[0].a = aAExpanded[combine.aA0];
-
-		SimplifyCycle(&cc[0], &color.stage[0]);
-		SimplifyCycle(&ac[0], &alpha.stage[0]);
-
-		const bool equalStages = (memcmp(cc, cc + 1, sizeof(CombineCycle)) | memcmp(ac, ac + 1, sizeof(CombineCycle))) == 0;
-		if (!equalStages) {
-			SimplifyCycle(&cc[1], &color.stage[1]);
-			SimplifyCycle(&ac[1], &alpha.stage[1]);
-		} else {
-			color.numStages = 1;
-			alpha.numStages = 1;
-		}
+	for (int i = 0; i < numStages; ++i) {
+		SimplifyCycle(&cc[i], &color.stage[i]);
+		SimplifyCycle(&ac[i], &alpha.stage[i]);
 	}
 
 	return new ShaderCombiner( color, alpha, combine );
 }
 
+bool CombinerInfo::_finishCompile(ShaderCombiner * _pCombiner, bool _bWait)
+{
+	if (!_pCombiner->isCompilePending())
+		return true;
+
+	PendingCombiners::iterator iter = m_pending.find(_pCombiner->getKey());
+	if (iter != m_pending.end()) {
+		// Without parallel compile support the driver had a frame to compile the program
+		if (!_bWait && (config.generalEmulation.enableAsyncShaderCompile == Config::ascUberShaderOnly ||
+			!(m_bParallelCompile ? _pCombiner->isCompileDone() : iter->second != m_frames)))
+			return false;
+		m_pending.erase(iter);
+	}
+
+	_pCombiner->finishCompile();
+	_pCombiner->update(true);
+	m_pUniformCollection->bindWithShaderCombiner(_pCombiner);
+	return true;
+}
+
+void CombinerInfo::_setUberShader(u64 _mux, const ShaderCombiner * _pCombiner)
+{
+	++m_uberShaderUses;
+	const bool bChanged = m_pCurrent != m_pUberShader || m_pUberShader->getKey() != _pCombiner->getKey();
+	m_pCurrent = m_pUberShader;
+	m_pCurrent->update(false);
+	if (bChanged) {
+		gDPCombine combine;
+		combine.mux = _mux;
+		CombineCycle cc[2];
+		CombineCycle ac[2];
+		UberCombinerParams params;
+		getUberCombinerParams(combine, cc, ac, DecodeCombine(combine, cc, ac), params);
+		m_pUberShader->setUberCombine(*_pCombiner, params);
+		// The uber-shader reads the tiles of another combiner now
+		m_pUniformCollection->updateTextureParameters();
+	}
+	m_bChanged = bChanged;
+}
+
 void CombinerInfo::update()
 {
 	// TODO: find, why gDP.changed & CHANGED_COMBINE not always works (e.g. Mario Tennis).
@@ -262,21 +369,39 @@ void CombinerInfo::update()
 void CombinerInfo::setCombine(u64 _mux )
 {
 	const u64 key = getCombinerKey(_mux);
-	if (m_pCurrent != nullptr && m_pCurrent->getKey() == key) {
+	if (m_pCurrent != nullptr && m_pCurrent->getKey() == key && m_pCurrent != m_pUberShader) {
 		m_bChanged = false;
 		m_pCurrent->update(false);
 		return;
 	}
 	Combiners::const_iterator iter = m_combiners.find(key);
-	if (iter != m_combiners.end()) {
-		m_pCurrent = iter->second;
+	ShaderCombiner * pCombiner = iter != m_combiners.end() ? iter->second : nullptr;
+	if (pCombiner != nullptr && !pCombiner->isCompilePending()) {
+		m_pCurrent = pCombiner;
 		m_pCurrent->update(false);
-	} else {
-		m_pCurrent = _compile(_mux);
-		m_pCurrent->update(true);
-		m_pUniformCollection->bindWithShaderCombiner(m_pCurrent);
-		m_combiners[m_pCurrent->getKey()] = m_pCurrent;
+		m_bChanged = true;
+		return;
 	}
+
+	// New or still compiling combiner
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (pCombiner == nullptr) {
+		pCombiner = _compile(_mux);
+		m_combiners[key] = pCombiner;
+		++m_numCompiled;
+		// Mipmapping and HW lighting are not emulated by the uber-shader
+		if (m_pUberShader != nullptr && !pCombiner->usesLOD() && !pCombiner->usesHwLighting())
+			m_pending[key] = m_frames;
+	}
+	if (!_finishCompile(pCombiner, false)) {
+		_setUberShader(_mux, pCombiner);
+		return;
+	}
+	const f64 stall = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+	m_stallTime += stall;
+	m_maxStall = std::max(m_maxStall, stall);
+
+	m_pCurrent = pCombiner;
 	m_bChanged = true;
 }
 
@@ -339,10 +464,17 @@ void CombinerInfo::updateParameters(OGLRender::RENDER_STATE _renderState)
 		m_pUniformCollection->updateUniforms(m_pCurrent, _renderState);
 }
 
+void CombinerInfo::frameDone()
+{
+	++m_frames;
+	if (m_pUniformCollection != nullptr)
+		m_pUniformCollection->frameDone();
+}
+
 #ifndef GLES2
 #define SHADER_STORAGE_FOLDER_NAME L"shaders"
 static
-void getStorageFileName(wchar_t * _fileName)
+void getStorageFileName(wchar_t * _fileName, const wchar_t * _strExtension)
 {
 	wchar_t strCacheFolderPath[PLUGIN_PATH_SIZE];
 	api().GetUserCachePath(strCacheFolderPath);
@@ -362,7 +494,7 @@ void getStorageFileName(wchar_t * _fileName)
 	const wchar_t* strOpenGLType = L"OpenGL";
 #endif
 
-	swprintf(_fileName, PLUGIN_PATH_SIZE, L"%ls/GLideN64.%08lx.%ls.shaders", pPath, std::hash<std::string>()(RSP.romname), strOpenGLType);
+	swprintf(_fileName, PLUGIN_PATH_SIZE, L"%ls/GLideN64.%08lx.%ls.%ls", pPath, std::hash<std::string>()(RSP.romname), strOpenGLType, _strExtension);
 }
 
 u32 CombinerInfo::_getConfigOptionsBitSet() const
@@ -393,7 +525,7 @@ void CombinerInfo::_saveShadersStorage() const
 		return;
 
 	wchar_t fileName[PLUGIN_PATH_SIZE];
-	getStorageFileName(fileName);
+	getStorageFileName(fileName, L"shaders");
 
 #if defined(OS_WINDOWS) && !defined(MINGW)
 	std::ofstream fout(fileName, std::ofstream::binary | std::ofstream::trunc);
@@ -430,7 +562,7 @@ void CombinerInfo::_saveShadersStorage() const
 bool CombinerInfo::_loadShadersStorage()
 {
 	wchar_t fileName[PLUGIN_PATH_SIZE];
-	getStorageFileName(fileName);
+	getStorageFileName(fileName, L"shaders");
 	m_configOptionsBitSet = _getConfigOptionsBitSet();
 
 #if defined(OS_WINDOWS) && !defined(MINGW)
@@ -487,6 +619,75 @@ bool CombinerInfo::_loadShadersStorage()
 	fin.close();
 	return !isGLError();
 }
+
+/*
+Combiner keys format:
+  uint32 - format version;
+  uint32 - number of keys
+  uint64 * - keys of the combiners used by the game
+Unlike the shaders storage, the keys stay valid when the driver changes.
+*/
+static const u32 CombinerKeysFormatVersion = 0x01U;
+void CombinerInfo::_saveCombinerKeys() const
+{
+	std::vector<u64> keys;
+	keys.reserve(m_combiners.size());
+	for (Combiners::const_iterator cur = m_combiners.begin(); cur != m_combiners.end(); ++cur) {
+		if (!cur->second->usesHwLighting())
+			keys.push_back(cur->first);
+	}
+	if (keys.empty())
+		return;
+
+	wchar_t fileName[PLUGIN_PATH_SIZE];
+	getStorageFileName(fileName, L"keys");
+
+#if defined(OS_WINDOWS) && !defined(MINGW)
+	std::ofstream fout(fileName, std::ofstream::binary | std::ofstream::trunc);
+#else
+	char fileName_c[PATH_MAX];
+	wcstombs(fileName_c, fileName, PATH_MAX);
+	std::ofstream fout(fileName_c, std::ofstream::binary | std::ofstream::trunc);
+#endif
+	if (!fout)
+		return;
+
+	fout.write((char*)&CombinerKeysFormatVersion, sizeof(CombinerKeysFormatVersion));
+	const u32 len = keys.size();
+	fout.write((char*)&len, sizeof(len));
+	fout.write((char*)keys.data(), len * sizeof(u64));
+	fout.flush();
+	fout.close();
+}
+
+bool CombinerInfo::_loadCombinerKeys(std::vector<u64> & _keys) const
+{
+	wchar_t fileName[PLUGIN_PATH_SIZE];
+	getStorageFileName(fileName, L"keys");
+
+#if defined(OS_WINDOWS) && !defined(MINGW)
+	std::ifstream fin(fileName, std::ofstream::binary);
+#else
+	char fileName_c[PATH_MAX];
+	wcstombs(fileName_c, fileName, PATH_MAX);
+	std::ifstream fin(fileName_c, std::ofstream::binary);
+#endif
+	if (!fin)
+		return false;
+
+	u32 version = 0;
+	fin.read((char*)&version, sizeof(version));
+	if (version != CombinerKeysFormatVersion)
+		return false;
+
+	u32 len = 0;
+	fin.read((char*)&len, sizeof(len));
+	if (!fin || len > 0x10000)
+		return false;
+	_keys.resize(len);
+	fin.read((char*)_keys.data(), len * sizeof(u64));
+	return !fin.fail();
+}
 #else // GLES2
 void CombinerInfo::_saveShadersStorage() const
 {}
@@ -495,4 +696,12 @@ bool CombinerInfo::_loadShadersStorage()
 {
 	return true;
 }
+
+void CombinerInfo::_saveCombinerKeys() const
+{}
+
+bool CombinerInfo::_loadCombinerKeys(std::vector<u64> & _keys) const
+{
+	return false;
+}
 #endif //GLES2
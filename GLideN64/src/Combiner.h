@@ -1,7 +1,8 @@
 #ifndef COMBINER_H
 #define COMBINER_H
 
-#include <map>
+#include <unordered_map>
+#include <vector>
 
 #include "GLideN64.h"
 #include "OpenGL.h"
@@ -123,11 +124,23 @@ public:
 	void destroy();
 	void update();
 	void setCombine(u64 _mux);
+	// Creates the uber-shader and compiles the combiners used by earlier runs of the game.
+	// Needs the shader objects created by InitShaderCombiner().
+	void precompile();
 
 	ShaderCombiner * getCurrent() const {return m_pCurrent;}
 	bool isChanged() const {return m_bChanged;}
 	bool isShaderCacheSupported() const { return m_bShaderCacheSupported; }
 	size_t getCombinersNumber() const { return m_combiners.size();  }
+	// Combiners compiled while drawing and precompiled, draws with the uber-shader, compile stalls in ms
+	void getStats(u32 & _compiled, u32 & _precompiled, u32 & _uberShaderUses, f64 & _stallTime, f64 & _maxStall) const
+	{
+		_compiled = m_numCompiled;
+		_precompiled = m_numPrecompiled;
+		_uberShaderUses = m_uberShaderUses;
+		_stallTime = m_stallTime;
+		_maxStall = m_maxStall;
+	}
 
 	static CombinerInfo & get();
 
@@ -142,6 +155,8 @@ public:
 	void updateLightParameters();
 	// Update uniforms for GL without UniformBlock support
 	void updateParameters(OGLRender::RENDER_STATE _renderState);
+	// Collect per frame uniform upload statistics, count frames of pending compilations
+	void frameDone();
 
 private:
 	CombinerInfo()
@@ -149,22 +164,47 @@ private:
 		, m_bShaderCacheSupported(false)
 		, m_shadersLoaded(0)
 		, m_configOptionsBitSet(0)
-		, m_pCurrent(nullptr) {}
+		, m_bParallelCompile(false)
+		, m_frames(0)
+		, m_numCompiled(0)
+		, m_numPrecompiled(0)
+		, m_uberShaderUses(0)
+		, m_stallTime(0.0)
+		, m_maxStall(0.0)
+		, m_pCurrent(nullptr)
+		, m_pUberShader(nullptr) {}
 	CombinerInfo(const CombinerInfo &);
 
 	void _saveShadersStorage() const;
 	bool _loadShadersStorage();
 	u32 _getConfigOptionsBitSet() const;
+	void _saveCombinerKeys() const;
+	bool _loadCombinerKeys(std::vector<u64> & _keys) const;
 	ShaderCombiner * _compile(u64 mux) const;
+	bool _finishCompile(ShaderCombiner * _pCombiner, bool _bWait);
+	void _setUberShader(u64 _mux, const ShaderCombiner * _pCombiner);
 
 	bool m_bChanged;
 	bool m_bShaderCacheSupported;
 	u32 m_shadersLoaded;
 	u32 m_configOptionsBitSet;
+	bool m_bParallelCompile;
+	u32 m_frames;
+
+	// Compilation statistics
+	u32 m_numCompiled;
+	u32 m_numPrecompiled;
+	u32 m_uberShaderUses;
+	f64 m_stallTime;
+	f64 m_maxStall;
 
 	ShaderCombiner * m_pCurrent;
-	typedef std::map<u64, ShaderCombiner *> Combiners;
+	ShaderCombiner * m_pUberShader;
+	typedef std::unordered_map<u64, ShaderCombiner *> Combiners;
 	Combiners m_combiners;
+	// Combiners compiled by the driver in the background, with the frame their compilation was issued in
+	typedef std::unordered_map<u64, u32> PendingCombiners;
+	PendingCombiners m_pending;
 	UniformCollection * m_pUniformCollection;
 };
 
@@ -25,6 +25,8 @@ void Config::resetToDefaults()
 	video.verticalSync = 0;
 	video.cropMode = cmDisable;
 	video.cropWidth = video.cropHeight = 0;
+	video.frameSkipMode = fsDisable;
+	video.frameSkipCount = 1;
 
 	texture.maxAnisotropy = 0;
 	texture.bilinearMode = BILINEAR_STANDARD;
@@ -36,6 +38,7 @@ void Config::resetToDefaults()
 	generalEmulation.enableHWLighting = 0;
 	generalEmulation.enableCustomSettings = 1;
 	generalEmulation.enableShadersStorage = 1;
+	generalEmulation.enableAsyncShaderCompile = 0;
 	generalEmulation.correctTexrectCoords = tcDisable;
 	generalEmulation.enableNativeResTexrects = 0;
 	generalEmulation.enableLegacyBlending = 0;
@@ -73,6 +76,7 @@ void Config::resetToDefaults()
 	textureFilter.txEnhancementMode = 0;
 	textureFilter.txDeposterize = 0;
 	textureFilter.txFilterIgnoreBG = 0;
+	textureFilter.txAsyncFilter = 0;
 	textureFilter.txCacheSize = 100 * gc_uMegabyte;
 
 	textureFilter.txHiresEnable = 0;
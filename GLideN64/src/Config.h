@@ -23,6 +23,12 @@ struct Config
 		cmCustom
 	};
 
+	enum FrameSkipMode {
+		fsDisable = 0,
+		fsAuto,
+		fsFixed
+	};
+
 	struct
 	{
 		u32 fullscreen;
@@ -33,6 +39,8 @@ struct Config
 		u32 cropMode;
 		u32 cropWidth;
 		u32 cropHeight;
+		u32 frameSkipMode;
+		u32 frameSkipCount;	// fixed: frames skipped per drawn frame, auto: max consecutive skipped frames
 	} video;
 
 	struct
@@ -44,6 +52,12 @@ struct Config
 		u32 screenShotFormat;
 	} texture;
 
+	enum AsyncShaderCompile {
+		ascDisable = 0,
+		ascEnable,
+		ascUberShaderOnly	// Combiners are never finished while drawing, to test the uber-shader
+	};
+
 	enum TexrectCorrectionMode {
 		tcDisable = 0,
 		tcSmart,
@@ -56,6 +70,7 @@ struct Config
 		u32 enableHWLighting;
 		u32 enableCustomSettings;
 		u32 enableShadersStorage;
+		u32 enableAsyncShaderCompile;	// Draw with an uber-shader while combiners compile
 		u32 correctTexrectCoords;
 		u32 enableNativeResTexrects;
 		u32 enableLegacyBlending;
@@ -80,7 +95,8 @@ struct Config
 	enum CopyToRDRAM {
 		ctDisable = 0,
 		ctSync,
-		ctAsync
+		ctAsync,
+		ctAdaptive
 	};
 
 	enum BufferSwapMode {
@@ -120,6 +136,7 @@ struct Config
 		u32 txEnhancementMode;			// Texture enhancement mode, eg 2xSAI
 		u32 txDeposterize;				// Deposterize texture before enhancement
 		u32 txFilterIgnoreBG;			// Do not apply filtering to backgrounds textures
+		u32 txAsyncFilter;				// Filter textures on worker threads, use unfiltered ones until done
 		u32 txCacheSize;				// Cache size in Mbytes
 
 		u32 txHiresEnable;				// Use high-resolution texture packs
@@ -407,6 +407,73 @@ void DepthBufferList::saveBuffer(u32 _address)
 #endif
 }
 
+void DepthBufferList::getState(DepthBufferListState & _state) const
+{
+	_state.buffers.resize(m_list.size());
+	u32 idx = 0;
+	for (DepthBuffers::const_iterator iter = m_list.begin(); iter != m_list.end(); ++iter) {
+		DepthBufferState & state = _state.buffers[idx++];
+		state.address = iter->m_address;
+		state.width = iter->m_width;
+		state.ulx = iter->m_ulx;
+		state.uly = iter->m_uly;
+		state.lrx = iter->m_lrx;
+		state.lry = iter->m_lry;
+		state.cleared = iter->m_cleared ? 1 : 0;
+	}
+	_state.current = getIndex(m_pCurrent);
+}
+
+void DepthBufferList::setState(const DepthBufferListState & _state)
+{
+	DepthBuffers prevList;
+	prevList.swap(m_list);
+	for (const DepthBufferState & state : _state.buffers) {
+		DepthBuffers::iterator iter = prevList.begin();
+		while (iter != prevList.end() && (iter->m_address != state.address || iter->m_width != state.width))
+			++iter;
+		if (iter != prevList.end())
+			m_list.splice(m_list.end(), prevList, iter);
+		else {
+			m_list.emplace_back();
+			DepthBuffer & buffer = m_list.back();
+			buffer.m_address = state.address;
+			buffer.m_width = state.width;
+			buffer.initDepthBufferTexture(frameBufferList().findBuffer(state.address));
+		}
+		DepthBuffer & buffer = m_list.back();
+		buffer.m_ulx = state.ulx;
+		buffer.m_uly = state.uly;
+		buffer.m_lrx = state.lrx;
+		buffer.m_lry = state.lry;
+		buffer.m_cleared = state.cleared != 0;
+	}
+	for (DepthBuffers::iterator iter = prevList.begin(); iter != prevList.end(); ++iter)
+		frameBufferList().clearDepthBuffer(&(*iter));
+	prevList.clear();
+
+	m_pCurrent = getBuffer(_state.current);
+}
+
+s32 DepthBufferList::getIndex(const DepthBuffer * _pBuffer) const
+{
+	s32 idx = 0;
+	for (DepthBuffers::const_iterator iter = m_list.begin(); iter != m_list.end(); ++iter, ++idx)
+		if (&(*iter) == _pBuffer)
+			return idx;
+	return -1;
+}
+
+DepthBuffer * DepthBufferList::getBuffer(s32 _index)
+{
+	if (_index < 0)
+		return nullptr;
+	for (DepthBuffers::iterator iter = m_list.begin(); iter != m_list.end(); ++iter)
+		if (_index-- == 0)
+			return &(*iter);
+	return nullptr;
+}
+
 void DepthBufferList::clearBuffer(u32 _ulx, u32 _uly, u32 _lrx, u32 _lry)
 {
 	if (m_pCurrent == nullptr)
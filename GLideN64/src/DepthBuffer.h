@@ -1,10 +1,27 @@
 #ifndef DEPTHBUFFER_H
 #define DEPTHBUFFER_H
 
+#include <vector>
+
 #include "Types.h"
 #include "Textures.h"
 
 struct FrameBuffer;
+
+// Descriptor of a depth buffer carried in the savestates, see SaveState.h
+struct DepthBufferState
+{
+	u32 address, width;
+	u32 ulx, uly, lrx, lry;
+	u32 cleared;
+};
+
+struct DepthBufferListState
+{
+	std::vector<DepthBufferState> buffers;
+	s32 current; // index in buffers, -1 if none
+};
+
 struct DepthBuffer
 {
 	DepthBuffer();
@@ -53,6 +70,14 @@ public:
 	void setNotCleared();
 	DepthBuffer *findBuffer(u32 _address);
 	DepthBuffer * getCurrent() const {return m_pCurrent;}
+	void setCurrent(DepthBuffer * _pBuffer) {m_pCurrent = _pBuffer;}
+
+	// Savestates, see SaveState.h. setState keeps the buffers which are
+	// still there and creates the others.
+	void getState(DepthBufferListState & _state) const;
+	void setState(const DepthBufferListState & _state);
+	s32 getIndex(const DepthBuffer * _pBuffer) const;
+	DepthBuffer * getBuffer(s32 _index);
 
 	static DepthBufferList & get();
 
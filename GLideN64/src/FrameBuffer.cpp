@@ -20,6 +20,7 @@
 #include "FrameBufferInfo.h"
 #include "FBOTextureFormats.h"
 #include "Log.h"
+#include "FrameSkipper.h"
 
 #include "BufferCopy/ColorBufferToRDRAM.h"
 #include "BufferCopy/DepthBufferToRDRAM.h"
@@ -215,6 +216,64 @@ void FrameBuffer::setBufferClearParams(u32 _fillcolor, s32 _ulx, s32 _uly, s32 _
 	m_clearParams.lry = _lry;
 }
 
+void FrameBuffer::getState(FrameBufferState & _state) const
+{
+	_state.info.startAddress = m_startAddress;
+	_state.info.endAddress = m_endAddress;
+	_state.info.format = m_pTexture->format;
+	_state.info.size = m_size;
+	_state.info.width = m_width;
+	_state.info.height = m_height;
+	_state.info.flags =
+		(m_cfb ? FrameBufferState::fbCfb : 0) |
+		(m_copiedToRdram ? FrameBufferState::fbCopiedToRdram : 0) |
+		(m_fingerprint ? FrameBufferState::fbFingerprint : 0) |
+		(m_cleared ? FrameBufferState::fbCleared : 0) |
+		(m_changed ? FrameBufferState::fbChanged : 0) |
+		(m_isDepthBuffer ? FrameBufferState::fbIsDepthBuffer : 0) |
+		(m_isPauseScreen ? FrameBufferState::fbIsPauseScreen : 0) |
+		(m_isOBScreen ? FrameBufferState::fbIsOBScreen : 0) |
+		(m_needHeightCorrection ? FrameBufferState::fbNeedHeightCorrection : 0) |
+		(m_readable ? FrameBufferState::fbReadable : 0);
+	_state.info.loadTileUls = m_loadTileOrigin.uls;
+	_state.info.loadTileUlt = m_loadTileOrigin.ult;
+	_state.info.loadType = m_loadType;
+	_state.info.clearFillColor = m_clearParams.fillcolor;
+	_state.info.clearUlx = m_clearParams.ulx;
+	_state.info.clearUly = m_clearParams.uly;
+	_state.info.clearLrx = m_clearParams.lrx;
+	_state.info.clearLry = m_clearParams.lry;
+	_state.info.depthBuffer = depthBufferList().getIndex(m_pDepthBuffer);
+	_state.rdramCopy = m_RdramCopy;
+}
+
+void FrameBuffer::setState(const FrameBufferState & _state)
+{
+	const u32 flags = _state.info.flags;
+	m_endAddress = _state.info.endAddress;
+	m_cfb = (flags & FrameBufferState::fbCfb) != 0;
+	m_copiedToRdram = (flags & FrameBufferState::fbCopiedToRdram) != 0;
+	m_fingerprint = (flags & FrameBufferState::fbFingerprint) != 0;
+	m_cleared = (flags & FrameBufferState::fbCleared) != 0;
+	m_changed = (flags & FrameBufferState::fbChanged) != 0;
+	m_isDepthBuffer = (flags & FrameBufferState::fbIsDepthBuffer) != 0;
+	m_isPauseScreen = (flags & FrameBufferState::fbIsPauseScreen) != 0;
+	m_isOBScreen = (flags & FrameBufferState::fbIsOBScreen) != 0;
+	m_needHeightCorrection = (flags & FrameBufferState::fbNeedHeightCorrection) != 0;
+	m_readable = (flags & FrameBufferState::fbReadable) != 0;
+	m_loadTileOrigin.uls = _state.info.loadTileUls;
+	m_loadTileOrigin.ult = _state.info.loadTileUlt;
+	m_loadType = _state.info.loadType;
+	m_clearParams.fillcolor = _state.info.clearFillColor;
+	m_clearParams.ulx = _state.info.clearUlx;
+	m_clearParams.uly = _state.info.clearUly;
+	m_clearParams.lrx = _state.info.clearLrx;
+	m_clearParams.lry = _state.info.clearLry;
+	m_RdramCopy = _state.rdramCopy;
+	m_validityChecked = 0;
+	m_resolved = false;
+}
+
 void FrameBuffer::copyRdram()
 {
 	const u32 stride = m_width << m_size >> 1;
@@ -752,6 +811,92 @@ void FrameBufferList::fillBufferInfo(void * _pinfo, u32 _size)
 	}
 }
 
+void FrameBufferList::getState(FrameBufferListState & _state) const
+{
+	_state.buffers.resize(m_list.size());
+	u32 idx = 0;
+	for (FrameBuffers::const_iterator iter = m_list.begin(); iter != m_list.end(); ++iter)
+		iter->getState(_state.buffers[idx++]);
+	_state.current = getIndex(m_pCurrent);
+	_state.copy = getIndex(m_pCopy);
+	_state.prevColorImageHeight = m_prevColorImageHeight;
+}
+
+void FrameBufferList::setState(const FrameBufferListState & _state)
+{
+	// std::list::splice keeps the buffers in place, so the pointers to the
+	// ones still there stay valid
+	FrameBuffers prevList;
+	prevList.swap(m_list);
+	for (const FrameBufferState & state : _state.buffers) {
+		FrameBuffers::iterator iter = prevList.begin();
+		while (iter != prevList.end() &&
+			(iter->m_startAddress != state.info.startAddress ||
+			iter->m_width != state.info.width ||
+			iter->m_height != state.info.height ||
+			iter->m_size != state.info.size ||
+			iter->m_pTexture->format != state.info.format))
+			++iter;
+		if (iter != prevList.end())
+			m_list.splice(m_list.end(), prevList, iter);
+		else {
+			m_list.emplace_back();
+			m_list.back().init(state.info.startAddress, state.info.endAddress, state.info.format, state.info.size,
+				state.info.width, state.info.height, (state.info.flags & FrameBufferState::fbCfb) != 0);
+		}
+		m_list.back().setState(state);
+	}
+	prevList.clear();
+
+	m_pCurrent = getBuffer(_state.current);
+	m_pCopy = getBuffer(_state.copy);
+	m_prevColorImageHeight = _state.prevColorImageHeight;
+}
+
+void FrameBufferList::attachDepthBuffers(const FrameBufferListState & _state)
+{
+	DepthBufferList & dbList = depthBufferList();
+	DepthBuffer * pCurrentDepthBuffer = dbList.getCurrent();
+	FrameBuffer * pCurrent = m_pCurrent;
+	u32 idx = 0;
+	for (FrameBuffers::iterator iter = m_list.begin(); iter != m_list.end(); ++iter) {
+		DepthBuffer * pDepthBuffer = dbList.getBuffer(_state.buffers[idx++].info.depthBuffer);
+		if (pDepthBuffer == nullptr)
+			iter->m_pDepthBuffer = nullptr;
+		else if (iter->m_pDepthBuffer != pDepthBuffer) {
+			m_pCurrent = &(*iter);
+			dbList.setCurrent(pDepthBuffer);
+			glBindFramebuffer(GL_FRAMEBUFFER, m_pCurrent->m_FBO);
+			attachDepthBuffer();
+		}
+	}
+	dbList.setCurrent(pCurrentDepthBuffer);
+	m_pCurrent = pCurrent;
+	if (m_pCurrent != nullptr)
+		glBindFramebuffer(GL_FRAMEBUFFER, m_pCurrent->m_FBO);
+	else
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+}
+
+s32 FrameBufferList::getIndex(const FrameBuffer * _pBuffer) const
+{
+	s32 idx = 0;
+	for (FrameBuffers::const_iterator iter = m_list.begin(); iter != m_list.end(); ++iter, ++idx)
+		if (&(*iter) == _pBuffer)
+			return idx;
+	return -1;
+}
+
+FrameBuffer * FrameBufferList::getBuffer(s32 _index)
+{
+	if (_index < 0)
+		return nullptr;
+	for (FrameBuffers::iterator iter = m_list.begin(); iter != m_list.end(); ++iter)
+		if (_index-- == 0)
+			return &(*iter);
+	return nullptr;
+}
+
 void FrameBufferList::attachDepthBuffer()
 {
 	if (m_pCurrent == nullptr)
@@ -864,6 +1009,11 @@ void FrameBufferList::renderBuffer(u32 _address)
 		isLowerField = vStart > vStartPrev;
 	vStartPrev = vStart;
 
+	if (frameSkipper.isDropped()) {
+		ogl.swapBuffers();
+		return;
+	}
+
 	const u32 addrOffset = ((_address - pBuffer->m_startAddress) << 1 >> pBuffer->m_size);
 	srcY0 = addrOffset / (*REG.VI_WIDTH);
 	if ((*REG.VI_WIDTH != addrOffset * 2) && (addrOffset % (*REG.VI_WIDTH) != 0))
@@ -1061,6 +1211,16 @@ void FrameBuffer_CopyToRDRAM(u32 _address, bool _sync)
 	ColorBufferToRDRAM::get().copyToRDRAM(_address, _sync);
 }
 
+bool FrameBuffer_IsUsedByCPU(u32 _address)
+{
+	return ColorBufferToRDRAM::get().isUsedByCPU(_address);
+}
+
+void FrameBuffer_UsedByCPU(u32 _address)
+{
+	ColorBufferToRDRAM::get().usedByCPU(_address);
+}
+
 void FrameBuffer_CopyChunkToRDRAM(u32 _address)
 {
 	ColorBufferToRDRAM::get().copyChunkToRDRAM(_address);
@@ -11,6 +11,41 @@ struct DepthBuffer;
 
 const int fingerprint[4] = { 2, 6, 4, 3 };
 
+// Descriptor of a frame buffer carried in the savestates, see SaveState.h
+struct FrameBufferState
+{
+	enum {
+		fbCfb = 1,
+		fbCopiedToRdram = 2,
+		fbFingerprint = 4,
+		fbCleared = 8,
+		fbChanged = 16,
+		fbIsDepthBuffer = 32,
+		fbIsPauseScreen = 64,
+		fbIsOBScreen = 128,
+		fbNeedHeightCorrection = 256,
+		fbReadable = 512
+	};
+
+	struct {
+		u32 startAddress, endAddress;
+		u32 format, size, width, height;
+		u32 flags;
+		u32 loadTileUls, loadTileUlt, loadType;
+		u32 clearFillColor;
+		s32 clearUlx, clearUly, clearLrx, clearLry;
+		s32 depthBuffer; // index in the depth buffer list, -1 if none
+	} info;
+	std::vector<u8> rdramCopy;
+};
+
+struct FrameBufferListState
+{
+	std::vector<FrameBufferState> buffers;
+	s32 current, copy; // indices in buffers, -1 if none
+	u32 prevColorImageHeight;
+};
+
 struct FrameBuffer
 {
 	FrameBuffer();
@@ -25,6 +60,8 @@ struct FrameBuffer
 	bool isValid(bool _forceCheck) const;
 	bool _isMarioTennisScoreboard() const;
 	bool isAuxiliary() const;
+	void getState(FrameBufferState & _state) const;
+	void setState(const FrameBufferState & _state);
 
 	u32 m_startAddress, m_endAddress;
 	u32 m_size, m_width, m_height;
@@ -100,6 +137,15 @@ public:
 
 	void fillBufferInfo(void * _pinfo, u32 _size);
 
+	// Savestates, see SaveState.h. setState keeps the buffers which are
+	// still there and creates the others, the depth buffers are attached
+	// by attachDepthBuffers once the depth buffer list is restored.
+	void getState(FrameBufferListState & _state) const;
+	void setState(const FrameBufferListState & _state);
+	void attachDepthBuffers(const FrameBufferListState & _state);
+	s32 getIndex(const FrameBuffer * _pBuffer) const;
+	FrameBuffer * getBuffer(s32 _index);
+
 	static FrameBufferList & get();
 
 private:
@@ -143,6 +189,8 @@ u32 cutHeight(u32 _address, u32 _height, u32 _stride);
 void FrameBuffer_Init();
 void FrameBuffer_Destroy();
 void FrameBuffer_CopyToRDRAM( u32 _address , bool _sync );
+bool FrameBuffer_IsUsedByCPU(u32 _address);
+void FrameBuffer_UsedByCPU(u32 _address);
 void FrameBuffer_CopyChunkToRDRAM(u32 _address);
 void FrameBuffer_CopyFromRDRAM(u32 address, bool bUseAlpha);
 void FrameBuffer_AddAddress(u32 address, u32 _size);
@@ -16,10 +16,12 @@ namespace FBInfo {
 		: m_pWriteBuffer(nullptr)
 		, m_pReadBuffer(nullptr)
 		, m_supported(false)
+		, m_tracking(false)
 	{}
 
 	void FBInfo::reset() {
 		m_supported = false;
+		m_tracking = false;
 		m_pWriteBuffer = m_pReadBuffer = nullptr;
 	}
 
@@ -29,6 +31,10 @@ namespace FBInfo {
 		//debugPrint("FBWrite addr=%08lx size=%u\n", addr, size);
 
 		const u32 address = RSP_SegmentToPhysical(addr);
+		if (m_tracking) {
+			FrameBuffer_UsedByCPU(address);
+			return;
+		}
 		if (m_pWriteBuffer == nullptr)
 			m_pWriteBuffer = frameBufferList().findBuffer(address);
 		FrameBuffer_AddAddress(address, size);
@@ -49,6 +55,10 @@ namespace FBInfo {
 		//debugPrint("FBRead addr=%08lx \n", addr);
 
 		const u32 address = RSP_SegmentToPhysical(addr);
+		if (m_tracking) {
+			FrameBuffer_UsedByCPU(address);
+			return;
+		}
 		FrameBuffer * pBuffer = frameBufferList().findBuffer(address);
 		if (pBuffer == nullptr || pBuffer == m_pWriteBuffer)
 			return;
@@ -74,8 +84,20 @@ namespace FBInfo {
 		FrameBufferInfo * pFBInfo = (FrameBufferInfo*)pinfo;
 		memset(pFBInfo, 0, sizeof(FrameBufferInfo)* 6);
 
-		if (config.frameBufferEmulation.fbInfoDisabled != 0)
+		// The copy mode may change between two calls
+		const bool tracking = config.frameBufferEmulation.fbInfoDisabled != 0 &&
+			config.frameBufferEmulation.copyToRDRAM == Config::ctAdaptive;
+		if (tracking && !m_tracking)
+			LOG(LOG_WARNING, "Adaptive copy to RDRAM: the core checks the CPU accesses to the color buffers, which turns its fast memory access off until it is restarted\n");
+		m_tracking = tracking;
+
+		if (config.frameBufferEmulation.fbInfoDisabled != 0) {
+			// The adaptive copy needs to know whether the CPU touches the color buffers.
+			// Report them, but keep copying them at full sync.
+			if (m_tracking)
+				frameBufferList().fillBufferInfo(pFBInfo, 6);
 			return;
+		}
 
 		u32 idx = 0;
 		DepthBuffer * pDepthBuffer = depthBufferList().getCurrent();
@@ -43,12 +43,17 @@ namespace FBInfo {
 
 		bool isSupported() const { return m_supported; }
 
+		// The buffers are reported only to learn which ones the CPU uses, for the adaptive copy to RDRAM.
+		// Reporting them makes the core turn its fast memory access off.
+		bool isTracking() const { return m_tracking; }
+
 		void reset();
 
 	private:
 		const FrameBuffer * m_pWriteBuffer;
 		const FrameBuffer * m_pReadBuffer;
 		bool m_supported;
+		bool m_tracking;
 	};
 
 	extern FBInfo fbInfo;
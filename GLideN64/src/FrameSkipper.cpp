@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cstring>
+#include "FrameSkipper.h"
+#include "Config.h"
+#include "FrameBufferInfo.h"
+#include "VI.h"
+#include "Log.h"
+
+FrameSkipper frameSkipper;
+
+// Frames drawn after a frame buffer read to RDRAM, at least.
+// Readbacks further apart keep frames drawn for twice their interval, up to the maximum.
+static const u32 s_readbackHoldFrames = 30;
+static const u32 s_maxReadbackHoldFrames = 300;
+
+// The plugin reads frame buffers back to RDRAM at some point of a frame
+static bool readbackEnabled()
+{
+	return config.frameBufferEmulation.copyToRDRAM != Config::ctDisable ||
+		config.frameBufferEmulation.copyDepthToRDRAM != Config::cdDisable ||
+		FBInfo::fbInfo.isSupported() || FBInfo::fbInfo.isTracking();
+}
+
+FrameSkipper::FrameSkipper()
+	: m_mode(Config::fsDisable)
+	, m_count(0)
+	, m_skipped(false)
+	, m_dropped(false)
+	, m_readback(false)
+	, m_consecutive(0)
+	, m_framesSinceReadback(-1)
+	, m_readbackInterval(0)
+	, m_vis(0)
+	, m_lag(0)
+{
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void FrameSkipper::reset()
+{
+	m_mode = config.video.frameSkipMode;
+	m_count = config.video.frameSkipCount;
+	if (m_count == 0)
+		m_mode = Config::fsDisable;
+	m_skipped = false;
+	m_dropped = false;
+	m_readback = false;
+	m_consecutive = 0;
+	m_framesSinceReadback = -1;
+	m_readbackInterval = 0;
+	m_vis = 0;
+	m_lag = 0;
+	m_lastFrameTime = Clock::now();
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void FrameSkipper::destroy()
+{
+	if (m_stats.skippedFrames > 0) {
+		LOG(LOG_VERBOSE, "Frame skip: %u of %u frames skipped, %u readbacks; %llu draw calls and %llu triangles not submitted\n",
+			m_stats.skippedFrames, m_stats.frames, m_stats.readbacks, m_stats.drawCalls, m_stats.triangles);
+	}
+	m_skipped = false;
+	m_dropped = false;
+	m_readback = false;
+}
+
+void FrameSkipper::update(bool _newFrame)
+{
+	if (m_mode == Config::fsDisable)
+		return;
+
+	++m_vis;
+	if (!_newFrame)
+		return;
+
+	++m_stats.frames;
+	// A frame read back is always shown, see readback()
+	m_dropped = m_skipped && !m_readback;
+	if (m_dropped)
+		++m_stats.skippedFrames;
+
+	const bool prevReadback = m_readback;
+	m_readback = false;
+	if (prevReadback) {
+		if (m_framesSinceReadback != u32(-1))
+			m_readbackInterval = m_framesSinceReadback + 1;
+		m_framesSinceReadback = 0;
+	} else if (m_framesSinceReadback != u32(-1))
+		++m_framesSinceReadback;
+
+	m_skipped = _needSkip(prevReadback);
+	if (m_skipped)
+		++m_consecutive;
+	else
+		m_consecutive = 0;
+	m_vis = 0;
+}
+
+bool FrameSkipper::_needSkip(bool _prevReadback)
+{
+	const Clock::time_point now = Clock::now();
+	const s64 elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - m_lastFrameTime).count();
+	m_lastFrameTime = now;
+
+	// Compare real time of the frame with its emulated time, the VIs it took.
+	// The lag is bounded, so pauses do not cause long runs of skipped frames
+	// and fast frames do not save credit for the future.
+	const s64 viTime = VI.PAL ? 20000 : 16683;
+	m_lag += elapsed - viTime * m_vis;
+	m_lag = std::max(-viTime, std::min(m_lag, viTime * 4));
+
+	// The frame will probably be read back like the previous one. Its draws must reach the GPU.
+	if (_prevReadback && readbackEnabled())
+		return false;
+
+	// Readbacks go on as long as they keep coming at their usual interval
+	const u32 holdFrames = std::max(s_readbackHoldFrames, std::min(2 * m_readbackInterval, s_maxReadbackHoldFrames));
+	if (m_framesSinceReadback < holdFrames)
+		return false;
+
+	if (m_consecutive >= m_count)
+		return false;
+
+	if (m_mode == Config::fsFixed)
+		return true;
+
+	return m_lag > viTime;
+}
+
+void FrameSkipper::readback()
+{
+	if (m_mode == Config::fsDisable)
+		return;
+	++m_stats.readbacks;
+	m_readback = true;
+	// Draw the rest of the frame. It is shown: dropping the frame the game read
+	// from would show the previous one, while the game goes on from this one.
+	m_skipped = false;
+}
+
+void FrameSkipper::skipDraw(u32 _numTriangles)
+{
+	++m_stats.drawCalls;
+	m_stats.triangles += _numTriangles;
+}
@@ -0,0 +1,64 @@
+#ifndef FRAMESKIPPER_H
+#define FRAMESKIPPER_H
+#include <chrono>
+#include "Types.h"
+
+// Frame skipping.
+// Display lists of a skipped frame are processed as usual, so matrices, TMEM, tiles
+// and frame buffer bookkeeping stay valid, but nothing is submitted to GL:
+// draws, texture uploads, post processing and buffer swap are dropped.
+class FrameSkipper
+{
+public:
+	FrameSkipper();
+	void reset();
+	void destroy();
+
+	// Called on every VI. _newFrame is true when the game finished a new frame since the previous call.
+	void update(bool _newFrame);
+
+	// Frame buffer was read to RDRAM. Skipping is disabled for a while,
+	// since the game uses the result of rendering. A skipped frame is drawn
+	// from this point on, and it is shown.
+	void readback();
+
+	// Draw commands of the current frame are dropped.
+	bool isSkipped() const { return m_skipped; }
+	// The last finished frame was not drawn and must not be shown.
+	bool isDropped() const { return m_dropped; }
+
+	// Count the dropped GPU work.
+	void skipDraw(u32 _numTriangles);
+
+	// GPU work avoided since the plugin started
+	struct Stats {
+		u32 frames;
+		u32 skippedFrames;
+		u32 readbacks;
+		u64 drawCalls;		// not submitted
+		u64 triangles;		// not submitted
+	};
+	const Stats & getStats() const { return m_stats; }
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	bool _needSkip(bool _prevReadback);
+
+	u32 m_mode;
+	u32 m_count;
+	bool m_skipped;
+	bool m_dropped;
+	bool m_readback;	// The current frame was read back
+	u32 m_consecutive;
+	u32 m_framesSinceReadback;
+	u32 m_readbackInterval;	// Frames between the last two frames read back
+	u32 m_vis;
+	s64 m_lag;			// Microseconds the emulation is behind real time
+	Clock::time_point m_lastFrameTime;
+
+	Stats m_stats;
+};
+
+extern FrameSkipper frameSkipper;
+#endif // FRAMESKIPPER_H
@@ -239,6 +239,25 @@ ShaderCombiner::~ShaderCombiner() {
 	m_program = 0;
 }
 
+// GLES2 compiles combiners synchronously and has no uber-shader.
+bool ShaderCombiner::isCompileDone() const
+{
+	return true;
+}
+
+void ShaderCombiner::finishCompile()
+{
+}
+
+ShaderCombiner * ShaderCombiner::createUberShader()
+{
+	return nullptr;
+}
+
+void ShaderCombiner::setUberCombine(const ShaderCombiner & _combiner, const UberCombinerParams & _params)
+{
+}
+
 #define LocateUniform(A) \
 	m_uniforms.A.loc = glGetUniformLocation(m_program, #A);
 
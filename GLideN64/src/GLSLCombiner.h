@@ -1,11 +1,14 @@
 #ifndef GLSL_COMBINER_H
 #define GLSL_COMBINER_H
 
+#include <string>
 #include <vector>
 #include <iostream>
 #include "gDP.h"
 #include "Combiner.h"
 
+struct UberCombinerParams;
+
 class ShaderCombiner {
 public:
 	ShaderCombiner();
@@ -28,6 +31,16 @@ public:
 
 	u64 getKey() const {return m_key;}
 
+	// The constructor only issues compilation, finishCompile() must be called before the combiner is used.
+	bool isCompilePending() const { return m_fragmentShader != 0; }
+	// Non-blocking check with GL_KHR_parallel_shader_compile
+	bool isCompileDone() const;
+	void finishCompile();
+
+	// Shader which runs any combine mode, selected with setUberCombine()
+	static ShaderCombiner * createUberShader();
+	void setUberCombine(const ShaderCombiner & _combiner, const UberCombinerParams & _params);
+
 	bool usesTile(u32 _t) const {
 		if (_t == 0)
 			return (m_nInputs & ((1<<TEXEL0)|(1<<TEXEL0_ALPHA))) != 0;
@@ -51,62 +64,72 @@ private:
 	struct iUniform	{
 		GLint loc = -1;
 		int val = -999;
-		void set(int _val, bool _force) {
+		bool set(int _val, bool _force) {
 			if (loc >= 0 && (_force || val != _val)) {
 				val = _val;
 				glUniform1i(loc, _val);
+				return true;
 			}
+			return false;
 		}
 	};
 
 	struct fUniform {
 		GLint loc = -1;
 		float val = -9999.9f;
-		void set(float _val, bool _force) {
+		bool set(float _val, bool _force) {
 			if (loc >= 0 && (_force || val != _val)) {
 				val = _val;
 				glUniform1f(loc, _val);
+				return true;
 			}
+			return false;
 		}
 	};
 
 	struct fv2Uniform {
 		GLint loc = -1;
 		float val1 = -9999.9f, val2 = -9999.9f;
-		void set(float _val1, float _val2, bool _force) {
+		bool set(float _val1, float _val2, bool _force) {
 			if (loc >= 0 && (_force || val1 != _val1 || val2 != _val2)) {
 				val1 = _val1;
 				val2 = _val2;
 				glUniform2f(loc, _val1, _val2);
+				return true;
 			}
+			return false;
 		}
 	};
 
 	struct iv2Uniform {
 		GLint loc = -1;
 		int val1 = -999, val2 = -999;
-		void set(int _val1, int _val2, bool _force) {
+		bool set(int _val1, int _val2, bool _force) {
 			if (loc >= 0 && (_force || val1 != _val1 || val2 != _val2)) {
 				val1 = _val1;
 				val2 = _val2;
 				glUniform2i(loc, _val1, _val2);
+				return true;
 			}
+			return false;
 		}
 	};
 
 	struct i4Uniform {
 		GLint loc = -1;
 		int val0 = -999, val1 = -999, val2 = -999, val3 = -999;
-		void set(int _val0, int _val1, int _val2, int _val3, bool _force) {
+		bool set(int _val0, int _val1, int _val2, int _val3, bool _force) {
 			if (loc < 0)
-				return;
+				return false;
 			if (_force || _val0 != val0 || _val1 != val1 || _val2 != val2 || _val3 != val3) {
 				val0 = _val0;
 				val1 = _val1;
 				val2 = _val2;
 				val3 = _val3;
 				glUniform4i(loc, val0, val1, val2, val3);
+				return true;
 			}
+			return false;
 		}
 	};
 
@@ -129,6 +152,8 @@ private:
 		iv2Uniform uMSTexEnabled, uFbMonochrome, uFbFixedAlpha;
 
 		i4Uniform uBlendMux1, uBlendMux2;
+
+		i4Uniform uCmbColor0, uCmbColor1, uCmbAlpha0, uCmbAlpha1, uCmbMode;
 	};
 
 #ifdef OS_MAC_OS_X
@@ -140,6 +165,8 @@ private:
 #define glUniform4fv glUniform4fvARB
 #endif
 
+	ShaderCombiner(const std::string & _strUberCombiner);
+	void _compile(const std::string & _strCombiner, bool _bUberShader);
 	void _locate_attributes() const;
 	void _locateUniforms();
 
@@ -148,6 +175,9 @@ private:
 	GLuint m_program;
 	int m_nInputs;
 	bool m_bNeedUpdate;
+	// Fragment shader and its source until the compilation is finished
+	GLuint m_fragmentShader = 0;
+	std::string m_strFragmentShader;
 };
 
 void InitShaderCombiner();
@@ -149,6 +149,7 @@ void UniformBlock::setColorData(ColorUniforms _index, u32 _dataSize, const void
 	}
 
 	glBufferSubData(GL_UNIFORM_BUFFER, m_colorsBlock.m_offsets[_index], _dataSize, _data);
+	++m_uploads;
 }
 
 void UniformBlock::updateTextureParameters()
@@ -156,7 +157,8 @@ void UniformBlock::updateTextureParameters()
 	if (m_textureBlock.m_buffer == 0)
 		return;
 
-	std::vector<GLbyte> temp(m_textureBlockData.size(), 0);
+	std::vector<GLbyte> & temp = m_textureBlockTemp;
+	temp.assign(m_textureBlockData.size(), 0);
 	GLbyte * pData = temp.data();
 	f32 texScale[4] = { gSP.texture.scales, gSP.texture.scalet, 0, 0 };
 	memcpy(pData + m_textureBlock.m_offsets[tuTexScale], texScale, m_textureBlock.m_offsets[tuTexOffset] - m_textureBlock.m_offsets[tuTexScale]);
@@ -230,8 +232,9 @@ void UniformBlock::updateTextureParameters()
 	}
 
 	if(temp != m_textureBlockData) {
-		m_textureBlockData = temp;
-		glBufferSubData(GL_UNIFORM_BUFFER, m_textureBlock.m_offsets[tuTexScale], m_textureBlockData.size(), pData);
+		m_textureBlockData.swap(temp);
+		glBufferSubData(GL_UNIFORM_BUFFER, m_textureBlock.m_offsets[tuTexScale], m_textureBlockData.size(), m_textureBlockData.data());
+		++m_uploads;
 	}
 }
 
@@ -252,6 +255,7 @@ void UniformBlock::updateLightParameters()
 	}
 
 	glBufferSubData(GL_UNIFORM_BUFFER, m_lightBlock.m_offsets[luLightDirection], m_lightBlockData.size(), pData);
+	++m_uploads;
 }
 
 UniformCollection * createUniformCollection()
@@ -69,6 +69,7 @@ private:
 	UniformBlockData<luTotal, 3> m_lightBlock;
 
 	std::vector<GLbyte> m_textureBlockData;
+	std::vector<GLbyte> m_textureBlockTemp; // scratch data of updateTextureParameters()
 	std::vector<GLbyte> m_colorsBlockData;
 	std::vector<GLbyte> m_lightBlockData;
 };
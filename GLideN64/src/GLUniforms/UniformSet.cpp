@@ -5,12 +5,19 @@
 #define LocateUniform2(A) \
 	location.A.loc = glGetUniformLocation(program, #A);
 
+UniformSet::UniformSet() : m_currentProgram(0), m_pCurrentLocation(nullptr)
+{
+	// Locations start with all counts at 0, so every group is out of date
+	for (u32 i = 0; i < ugTotal; ++i)
+		m_changes[i] = 1;
+}
+
 void UniformSet::bindWithShaderCombiner(ShaderCombiner * _pCombiner)
 {
-	const u64 mux = _pCombiner->getKey();
 	const GLuint program = _pCombiner->m_program;
-	m_uniforms.emplace(mux, program);
-	UniformSetLocation & location = m_uniforms.at(mux);
+	UniformSetLocation & location = m_uniforms.emplace(program, program).first->second;
+	m_currentProgram = program;
+	m_pCurrentLocation = &location;
 
 	// Texture parameters
 	if (_pCombiner->usesTexture()) {
@@ -53,19 +60,63 @@ void UniformSet::bindWithShaderCombiner(ShaderCombiner * _pCombiner)
 		}
 		_updateLightUniforms(location, true);
 	}
+
+	memcpy(location.m_synced, m_changes, sizeof(m_changes));
+	location.m_textures[0] = textureCache().current[0];
+	location.m_textures[1] = textureCache().current[1];
+}
+
+void UniformSet::setColorData(ColorUniforms _index, u32 _dataSize, const void * _data)
+{
+	switch (_index) {
+	case cuFogColor:
+		++m_changes[ugFogColor];
+		break;
+	case cuCenterColor:
+	case cuScaleColor:
+		++m_changes[ugKeyColor];
+		break;
+	case cuBlendColor:
+		++m_changes[ugBlendColor];
+		break;
+	case cuEnvColor:
+		++m_changes[ugEnvColor];
+		break;
+	case cuPrimColor:
+	case cuPrimLod:
+		++m_changes[ugPrimColor];
+		break;
+	case cuK4:
+	case cuK5:
+		++m_changes[ugConvert];
+		break;
+	default:
+		break;
+	}
 }
 
 void UniformSet::_updateColorUniforms(UniformSetLocation & _location, bool _bForce)
 {
-	_location.uFogColor.set(&gDP.fogColor.r, _bForce);
-	_location.uCenterColor.set(&gDP.key.center.r, _bForce);
-	_location.uScaleColor.set(&gDP.key.scale.r, _bForce);
-	_location.uBlendColor.set(&gDP.blendColor.r, _bForce);
-	_location.uEnvColor.set(&gDP.envColor.r, _bForce);
-	_location.uPrimColor.set(&gDP.primColor.r, _bForce);
-	_location.uPrimLod.set(gDP.primColor.l, _bForce);
-	_location.uK4.set(gDP.convert.k4*0.0039215689f, _bForce);
-	_location.uK5.set(gDP.convert.k5*0.0039215689f, _bForce);
+	if (_bForce || _location.m_synced[ugFogColor] != m_changes[ugFogColor])
+		m_uploads += _location.uFogColor.set(&gDP.fogColor.r, _bForce);
+	if (_bForce || _location.m_synced[ugKeyColor] != m_changes[ugKeyColor]) {
+		m_uploads += _location.uCenterColor.set(&gDP.key.center.r, _bForce);
+		m_uploads += _location.uScaleColor.set(&gDP.key.scale.r, _bForce);
+	}
+	if (_bForce || _location.m_synced[ugBlendColor] != m_changes[ugBlendColor])
+		m_uploads += _location.uBlendColor.set(&gDP.blendColor.r, _bForce);
+	if (_bForce || _location.m_synced[ugEnvColor] != m_changes[ugEnvColor])
+		m_uploads += _location.uEnvColor.set(&gDP.envColor.r, _bForce);
+	if (_bForce || _location.m_synced[ugPrimColor] != m_changes[ugPrimColor]) {
+		m_uploads += _location.uPrimColor.set(&gDP.primColor.r, _bForce);
+		m_uploads += _location.uPrimLod.set(gDP.primColor.l, _bForce);
+	}
+	if (_bForce || _location.m_synced[ugConvert] != m_changes[ugConvert]) {
+		m_uploads += _location.uK4.set(gDP.convert.k4*0.0039215689f, _bForce);
+		m_uploads += _location.uK5.set(gDP.convert.k5*0.0039215689f, _bForce);
+	}
+	for (u32 i = ugFogColor; i <= ugConvert; ++i)
+		_location.m_synced[i] = m_changes[i];
 }
 
 
@@ -80,7 +131,7 @@ void UniformSet::_updateTextureUniforms(UniformSetLocation & _location, bool _bU
 
 		if (gSP.textureTile[t] != NULL) {
 			if (gSP.textureTile[t]->textureMode == TEXTUREMODE_BGIMAGE || gSP.textureTile[t]->textureMode == TEXTUREMODE_FRAMEBUFFER_BG)
-				_location.uTexOffset[t].set(0.0f, 0.0f, _bForce);
+				m_uploads += _location.uTexOffset[t].set(0.0f, 0.0f, _bForce);
 			else {
 				float fuls = gSP.textureTile[t]->fuls;
 				float fult = gSP.textureTile[t]->fult;
@@ -91,7 +142,7 @@ void UniformSet::_updateTextureUniforms(UniformSetLocation & _location, bool _bU
 					if (gSP.textureTile[t]->maskt > 0 && gSP.textureTile[t]->clampt == 0)
 						fult = float(gSP.textureTile[t]->ult % (1 << gSP.textureTile[t]->maskt));
 				}
-				_location.uTexOffset[t].set(fuls, fult, _bForce);
+				m_uploads += _location.uTexOffset[t].set(fuls, fult, _bForce);
 			}
 		}
 
@@ -99,48 +150,68 @@ void UniformSet::_updateTextureUniforms(UniformSetLocation & _location, bool _bU
 			f32 shiftScaleS = 1.0f;
 			f32 shiftScaleT = 1.0f;
 			getTextureShiftScale(t, cache, shiftScaleS, shiftScaleT);
-			_location.uCacheShiftScale[t].set(shiftScaleS, shiftScaleT, _bForce);
-			_location.uCacheScale[t].set(cache.current[t]->scaleS, cache.current[t]->scaleT, _bForce);
-			_location.uCacheOffset[t].set(cache.current[t]->offsetS, cache.current[t]->offsetT, _bForce);
+			m_uploads += _location.uCacheShiftScale[t].set(shiftScaleS, shiftScaleT, _bForce);
+			m_uploads += _location.uCacheScale[t].set(cache.current[t]->scaleS, cache.current[t]->scaleT, _bForce);
+			m_uploads += _location.uCacheOffset[t].set(cache.current[t]->offsetS, cache.current[t]->offsetT, _bForce);
 			nFB[t] = cache.current[t]->frameBufferTexture;
 		}
 	}
 
-	_location.uCacheFrameBuffer.set(nFB[0], nFB[1], _bForce);
-	_location.uTexScale.set(gSP.texture.scales, gSP.texture.scalet, _bForce);
+	m_uploads += _location.uCacheFrameBuffer.set(nFB[0], nFB[1], _bForce);
+	m_uploads += _location.uTexScale.set(gSP.texture.scales, gSP.texture.scalet, _bForce);
 }
 
 void UniformSet::_updateTextureSize(UniformSetLocation & _location, bool _bUsesT0, bool _bUsesT1, bool _bForce)
 {
 	TextureCache & cache = textureCache();
 	if (_bUsesT0 && cache.current[0] != NULL)
-		_location.uTextureSize[0].set((float)cache.current[0]->realWidth, (float)cache.current[0]->realHeight, _bForce);
+		m_uploads += _location.uTextureSize[0].set((float)cache.current[0]->realWidth, (float)cache.current[0]->realHeight, _bForce);
 	if (_bUsesT1 && cache.current[1] != NULL)
-		_location.uTextureSize[1].set((float)cache.current[1]->realWidth, (float)cache.current[1]->realHeight, _bForce);
+		m_uploads += _location.uTextureSize[1].set((float)cache.current[1]->realWidth, (float)cache.current[1]->realHeight, _bForce);
 }
 
 void UniformSet::_updateLightUniforms(UniformSetLocation & _location, bool _bForce)
 {
 	for (s32 i = 0; i <= gSP.numLights; ++i) {
-		_location.uLightDirection[i].set(&gSP.lights[i].ix, _bForce);
-		_location.uLightColor[i].set(&gSP.lights[i].r, _bForce);
+		m_uploads += _location.uLightDirection[i].set(&gSP.lights[i].ix, _bForce);
+		m_uploads += _location.uLightColor[i].set(&gSP.lights[i].r, _bForce);
 	}
 }
 
 void UniformSet::updateUniforms(ShaderCombiner * _pCombiner, OGLRender::RENDER_STATE _renderState)
 {
-	UniformSetLocation & location = m_uniforms.at(_pCombiner->getKey());
+	const GLuint program = _pCombiner->m_program;
+	if (m_pCurrentLocation == nullptr || m_currentProgram != program) {
+		m_pCurrentLocation = &m_uniforms.at(program);
+		m_currentProgram = program;
+	}
+	UniformSetLocation & location = *m_pCurrentLocation;
 
 	_updateColorUniforms(location, false);
 
-	if ((_renderState == OGLRender::rsTriangle || _renderState == OGLRender::rsLine) && _pCombiner->usesTexture())
-		_updateTextureUniforms(location, _pCombiner->usesTile(0), _pCombiner->usesTile(1), false);
+	const bool bUsesTexture = _pCombiner->usesTexture();
+	if (_renderState == OGLRender::rsTriangle || _renderState == OGLRender::rsLine) {
+		const TextureCache & cache = textureCache();
+		if (bUsesTexture && (location.m_synced[ugTexture] != m_changes[ugTexture] ||
+			location.m_textures[0] != cache.current[0] || location.m_textures[1] != cache.current[1])) {
+			_updateTextureUniforms(location, _pCombiner->usesTile(0), _pCombiner->usesTile(1), false);
+			location.m_synced[ugTexture] = m_changes[ugTexture];
+			location.m_textures[0] = cache.current[0];
+			location.m_textures[1] = cache.current[1];
+		}
+	} else {
+		// Other draws may change tiles and textures without updating texture parameters
+		++m_changes[ugTexture];
+	}
 
-	if (_pCombiner->usesTexture())
+	if (bUsesTexture)
 		_updateTextureSize(location, _pCombiner->usesTile(0), _pCombiner->usesTile(1), false);
 
-	if (config.generalEmulation.enableHWLighting != 0 && GBI.isHWLSupported() && _pCombiner->usesShadeColor())
+	if (config.generalEmulation.enableHWLighting != 0 && GBI.isHWLSupported() && _pCombiner->usesShadeColor() &&
+		location.m_synced[ugLight] != m_changes[ugLight]) {
 		_updateLightUniforms(location, false);
+		location.m_synced[ugLight] = m_changes[ugLight];
+	}
 }
 
 UniformCollection * createUniformCollection()
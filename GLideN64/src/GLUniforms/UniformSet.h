@@ -1,52 +1,80 @@
 #ifndef UNIFORM_SET_H
 #define UNIFORM_SET_H
 
+#include <unordered_map>
 #include "../UniformCollection.h"
 
 class UniformSet : public UniformCollection
 {
 public:
 
-	UniformSet() {}
+	UniformSet();
 	~UniformSet() {}
 
 	virtual void bindWithShaderCombiner(ShaderCombiner * _pCombiner);
-	virtual void setColorData(ColorUniforms _index, u32 _dataSize, const void * _data) {}
-	virtual void updateTextureParameters() {}
-	virtual void updateLightParameters() {}
+	virtual void setColorData(ColorUniforms _index, u32 _dataSize, const void * _data);
+	virtual void updateTextureParameters() { ++m_changes[ugTexture]; }
+	virtual void updateLightParameters() { ++m_changes[ugLight]; }
 	virtual void updateUniforms(ShaderCombiner * _pCombiner, OGLRender::RENDER_STATE _renderState);
 
 private:
+	// Uniforms of a group are only compared with the current state
+	// after the group changed since the program's last update.
+	// Color groups go first.
+	enum UniformGroups {
+		ugFogColor,
+		ugKeyColor,
+		ugBlendColor,
+		ugEnvColor,
+		ugPrimColor,
+		ugConvert,
+		ugTexture,
+		ugLight,
+		ugTotal
+	};
+
 	struct fv3Uniform {
 		GLint loc = -1;
 		float val[3];
-		void set(float * _pVal, bool _force) {
+		bool set(float * _pVal, bool _force) {
 			const size_t szData = sizeof(float)* 3;
 			if (loc >= 0 && (_force || memcmp(val, _pVal, szData) != 0)) {
 				memcpy(val, _pVal, szData);
 				glUniform3fv(loc, 1, _pVal);
+				return true;
 			}
+			return false;
 		}
 	};
 
 	struct fv4Uniform {
 		GLint loc = -1;
 		float val[4];
-		void set(float * _pVal, bool _force) {
+		bool set(float * _pVal, bool _force) {
 			const size_t szData = sizeof(float)* 4;
 			if (loc >= 0 && (_force || memcmp(val, _pVal, szData) != 0)) {
 				memcpy(val, _pVal, szData);
 				glUniform4fv(loc, 1, _pVal);
+				return true;
 			}
+			return false;
 		}
 	};
 
 	struct UniformSetLocation
 	{
-		UniformSetLocation(GLuint _program) : m_program(_program) {}
+		UniformSetLocation(GLuint _program) : m_program(_program) {
+			memset(m_synced, 0, sizeof(m_synced));
+			m_textures[0] = m_textures[1] = nullptr;
+		}
 
 		GLuint m_program;
 
+		// Group change counts the uniforms were last updated with
+		u32 m_synced[ugTotal];
+		// Cached textures the texture uniforms were last updated with
+		const CachedTexture * m_textures[2];
+
 		// Texture parameters
 		ShaderCombiner::fv2Uniform uTexScale, uTexOffset[2], uCacheScale[2], uCacheOffset[2], uCacheShiftScale[2], uTextureSize[2];
 		ShaderCombiner::iv2Uniform uCacheFrameBuffer;
@@ -64,8 +92,12 @@ private:
 	void _updateTextureSize(UniformSetLocation & _location, bool _bUsesT0, bool _bUsesT1, bool _bForce);
 	void _updateLightUniforms(UniformSetLocation & _location, bool _bForce);
 
-	typedef std::map<u64, UniformSetLocation> Uniforms;
+	// Locations by program, the uber-shader reports the key of the combiner it draws for
+	typedef std::unordered_map<GLuint, UniformSetLocation> Uniforms;
 	Uniforms m_uniforms;
+	GLuint m_currentProgram;
+	UniformSetLocation * m_pCurrentLocation;
+	u32 m_changes[ugTotal];
 };
 
 #endif // UNIFORM_SET_H
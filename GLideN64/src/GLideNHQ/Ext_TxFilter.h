@@ -231,6 +231,13 @@ TAPI boolean TAPIENTRY
 txfilter_filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat,
 		 uint64 g64crc, GHQTexInfo *info);
 
+TAPI boolean TAPIENTRY
+txfilter_filter_async(uint8 *src, int srcwidth, int srcheight, uint16 srcformat,
+		 uint64 g64crc);
+
+TAPI boolean TAPIENTRY
+txfilter_async_result(uint64 *g64crc, GHQTexInfo *info);
+
 TAPI boolean TAPIENTRY
 txfilter_hirestex(uint64 g64crc, uint64 r_crc64, uint16 *palette, GHQTexInfo *info);
 
@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include <vector>
 #include "TextureFilters.h"
 #include "TxUtil.h"
+#include "TxThreadPool.h"
 
 /************************************************************************/
 /* 2X filters                                                           */
@@ -36,7 +37,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 // Basic 2x R8G8B8A8 filter with interpolation
 
-void Texture2x_32(uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height)
+void Texture2x_32(uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, int yFirst, int yLast)
 {
 	uint32 *pDst1, *pDst2;
 	uint32 *pSrc, *pSrc2;
@@ -63,7 +64,7 @@ void Texture2x_32(uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch
 	uint32 xSrc;
 	uint32 ySrc;
 
-	for (ySrc = 0; ySrc < nHeight; ySrc++)
+	for (ySrc = yFirst; ySrc < (uint32)yLast; ySrc++)
 	{
 		pSrc = (uint32*)(((uint8*)srcPtr)+ySrc*srcPitch);
 		pSrc2 = (uint32*)(((uint8*)srcPtr)+(ySrc+1)*srcPitch);
@@ -262,7 +263,7 @@ void Texture2x_16(uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch
  * Sharp filters
  * Hiroshi Morii <koolsmoky@users.sourceforge.net>
  */
-void SharpFilter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *dest, uint32 filter)
+void SharpFilter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *dest, uint32 filter, uint32 yFirst, uint32 yLast)
 {
 	// NOTE: for now we get away with copying the boundaries
 	//       filter the boundaries if we face problems
@@ -291,17 +292,17 @@ void SharpFilter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *de
 	break;
 	}
 
-	// setup rows
-	_src1 = src;
-	_src2 = _src1 + srcwidth;
-	_src3 = _src2 + srcwidth;
-	_dest = dest;
-
-	// copy the first row
-	memcpy(_dest, _src1, (srcwidth << 2));
-	_dest += srcwidth;
-	// filter 2nd row to 1 row before the last
-	for (y = 1; y < srcheight-1; y++) {
+	for (y = yFirst; y < yLast; y++) {
+		// setup rows
+		_src2 = src + y * srcwidth;
+		_dest = dest + y * srcwidth;
+		// copy the first and the last row
+		if (y == 0 || y == srcheight - 1) {
+			memcpy(_dest, _src2, (srcwidth << 2));
+			continue;
+		}
+		_src1 = _src2 - srcwidth;
+		_src3 = _src2 + srcwidth;
 		// copy the first pixel
 		_dest[0] = *_src2;
 		// filter 2nd pixel to 1 pixel before last
@@ -328,14 +329,7 @@ void SharpFilter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *de
 		}
 		// copy the ending pixel
 		_dest[srcwidth-1] = *(_src3 - 1);
-		// next row
-		_src1 += srcwidth;
-		_src2 += srcwidth;
-		_src3 += srcwidth;
-		_dest += srcwidth;
 	}
-	// copy the last row
-	memcpy(_dest, _src2, (srcwidth << 2));
 }
 
 #if !_16BPP_HACK
@@ -423,7 +417,7 @@ void SharpFilter_4444(uint16 *src, uint32 srcwidth, uint32 srcheight, uint16 *de
  * Smooth filters
  * Hiroshi Morii <koolsmoky@users.sourceforge.net>
  */
-void SmoothFilter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *dest, uint32 filter)
+void SmoothFilter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *dest, uint32 filter, uint32 yFirst, uint32 yLast)
 {
 	// NOTE: for now we get away with copying the boundaries
 	//       filter the boundaries if we face problems
@@ -466,16 +460,17 @@ void SmoothFilter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *d
 	switch (filter) {
 	case SMOOTH_FILTER_3:
 	case SMOOTH_FILTER_4:
-		// setup rows
-		_src1 = src;
-		_src2 = _src1 + srcwidth;
-		_src3 = _src2 + srcwidth;
-		_dest = dest;
-		// copy the first row
-		memcpy(_dest, _src1, (srcwidth << 2));
-		_dest += srcwidth;
-		// filter 2nd row to 1 row before the last
-		for (y = 1; y < srcheight - 1; y++){
+		for (y = yFirst; y < yLast; y++) {
+			// setup rows
+			_src2 = src + y * srcwidth;
+			_dest = dest + y * srcwidth;
+			// copy the first and the last row
+			if (y == 0 || y == srcheight - 1) {
+				memcpy(_dest, _src2, (srcwidth << 2));
+				continue;
+			}
+			_src1 = _src2 - srcwidth;
+			_src3 = _src2 + srcwidth;
 			// copy the first pixel
 			_dest[0] = _src2[0];
 			// filter 2nd pixel to 1 pixel before last
@@ -498,30 +493,19 @@ void SmoothFilter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *d
 			}
 			// copy the ending pixel
 			_dest[srcwidth-1] = *(_src3 - 1);
-			// next row
-			_src1 += srcwidth;
-			_src2 += srcwidth;
-			_src3 += srcwidth;
-			_dest += srcwidth;
 		}
-		// copy the last row
-		memcpy(_dest, _src2, (srcwidth << 2));
 	break;
 	case SMOOTH_FILTER_1:
 	case SMOOTH_FILTER_2:
 	default:
-		// setup rows
-		_src1 = src;
-		_src2 = _src1 + srcwidth;
-		_src3 = _src2 + srcwidth;
-		_dest = dest;
-		// copy the first row
-		memcpy(_dest, _src1, (srcwidth << 2));
-		_dest += srcwidth;
-		// filter 2nd row to 1 row before the last
-		for (y = 1; y < srcheight - 1; y++) {
-			// filter 1st pixel to the last
-			if (y & 1) {
+		for (y = yFirst; y < yLast; y++) {
+			// setup rows
+			_src2 = src + y * srcwidth;
+			_dest = dest + y * srcwidth;
+			// filter odd rows between the first and the last row, copy the others
+			if (y != srcheight - 1 && (y & 1)) {
+				_src1 = _src2 - srcwidth;
+				_src3 = _src2 + srcwidth;
 				for( x = 0; x < srcwidth; x++) {
 					for( z = 0; z < 4; z++ ) {
 						t2 = *((uint8*)(_src1+x  )+z);
@@ -536,14 +520,7 @@ void SmoothFilter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *d
 			} else {
 				memcpy(_dest, _src2, (srcwidth << 2));
 			}
-			// next row
-			_src1 += srcwidth;
-			_src2 += srcwidth;
-			_src3 += srcwidth;
-			_dest += srcwidth;
 		}
-		// copy the last row
-		memcpy(_dest, _src2, (srcwidth << 2));
 	break;
 	}
 }
@@ -744,17 +721,35 @@ void deposterizeV(uint32* data, uint32* out, int w, int h, int l, int u) {
 	}
 }
 
+/* Runs func(yFirst, yLast) over row bands of the image on the texture worker threads.
+ * The filters read the rows around their band from the whole image, so the result
+ * does not depend on the number of bands. */
+template <typename RowsFunc>
+static
+void forEachBand(uint32 height, const RowsFunc & func) {
+	TxThreadPool *pool = TxThreadPool::getInstance();
+	uint32 bandHeight;
+	const uint32 numBands = pool->getBands(height, bandHeight);
+	pool->parallelFor(numBands, [&](uint32 band, uint32 /* threadIdx */) {
+		const uint32 yFirst = band * bandHeight;
+		const uint32 yLast = band + 1 < numBands ? yFirst + bandHeight : height;
+		func(yFirst, yLast);
+	});
+}
+
+/* every pass reads the rows next to its band from the previous pass */
 static
 void DePosterize(uint32* source, uint32* dest, uint32* buf, int width, int height) {
-	deposterizeH(source, buf, width, 0, height);
-	deposterizeV(buf, dest, width, height, 0, height);
-	deposterizeH(dest, buf, width, 0, height);
-	deposterizeV(buf, dest, width, height, 0, height);
+	forEachBand(height, [&](int l, int u) { deposterizeH(source, buf, width, l, u); });
+	forEachBand(height, [&](int l, int u) { deposterizeV(buf, dest, width, height, l, u); });
+	forEachBand(height, [&](int l, int u) { deposterizeH(dest, buf, width, l, u); });
+	forEachBand(height, [&](int l, int u) { deposterizeV(buf, dest, width, height, l, u); });
 }
 
-void filter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *dest, uint32 filter, uint32 threadId) {
+void filter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *dest, uint32 filter) {
 	if (filter & DEPOSTERIZE) {
 		const auto bufSize = srcwidth * srcheight;
+		const uint32 threadId = TxThreadPool::getInstance()->getThreadIndex();
 		uint32 * tex = TxMemBuf::getInstance()->getThreadBuf(threadId, 0, bufSize);
 		uint32 * buf = TxMemBuf::getInstance()->getThreadBuf(threadId, 1, bufSize);
 		if (tex != nullptr && buf != nullptr) {
@@ -764,40 +759,58 @@ void filter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *dest, u
 	}
 	switch (filter & ENHANCEMENT_MASK) {
 	case BRZ2X_ENHANCEMENT:
-		xbrz::scale(2, (const uint32_t *)const_cast<const uint32 *>(src), (uint32_t *)dest, srcwidth, srcheight, xbrz::ColorFormat::ABGR);
-	return;
 	case BRZ3X_ENHANCEMENT:
-		xbrz::scale(3, (const uint32_t *)const_cast<const uint32 *>(src), (uint32_t *)dest, srcwidth, srcheight, xbrz::ColorFormat::ABGR);
-	return;
 	case BRZ4X_ENHANCEMENT:
-		xbrz::scale(4, (const uint32_t *)const_cast<const uint32 *>(src), (uint32_t *)dest, srcwidth, srcheight, xbrz::ColorFormat::ABGR);
-	return;
 	case BRZ5X_ENHANCEMENT:
-		xbrz::scale(5, (const uint32_t *)const_cast<const uint32 *>(src), (uint32_t *)dest, srcwidth, srcheight, xbrz::ColorFormat::ABGR);
-	return;
 	case BRZ6X_ENHANCEMENT:
-		xbrz::scale(6, (const uint32_t *)const_cast<const uint32 *>(src), (uint32_t *)dest, srcwidth, srcheight, xbrz::ColorFormat::ABGR);
-		return;
+	{
+		size_t factor = 2;
+		switch (filter & ENHANCEMENT_MASK) {
+		case BRZ3X_ENHANCEMENT: factor = 3; break;
+		case BRZ4X_ENHANCEMENT: factor = 4; break;
+		case BRZ5X_ENHANCEMENT: factor = 5; break;
+		case BRZ6X_ENHANCEMENT: factor = 6; break;
+		}
+		forEachBand(srcheight, [&](int yFirst, int yLast) {
+			xbrz::scale(factor, (const uint32_t *)const_cast<const uint32 *>(src), (uint32_t *)dest, srcwidth, srcheight, xbrz::ColorFormat::ABGR,
+						xbrz::ScalerCfg(), yFirst, yLast);
+		});
+	}
+	return;
 	case HQ4X_ENHANCEMENT:
-		hq4x_8888((uint8*)src, (uint8*)dest, srcwidth, srcheight, srcwidth, (srcwidth << 4));
+		forEachBand(srcheight, [&](int yFirst, int yLast) {
+			hq4x_8888((uint8*)src, (uint8*)dest, srcwidth, srcheight, srcwidth, (srcwidth << 4), yFirst, yLast);
+		});
 	return;
 	case HQ2X_ENHANCEMENT:
-		hq2x_32((uint8*)src, (srcwidth << 2), (uint8*)dest, (srcwidth << 3), srcwidth, srcheight);
+		forEachBand(srcheight, [&](int yFirst, int yLast) {
+			hq2x_32((uint8*)src, (srcwidth << 2), (uint8*)dest, (srcwidth << 3), srcwidth, srcheight, yFirst, yLast);
+		});
 	return;
 	case HQ2XS_ENHANCEMENT:
-		hq2xS_32((uint8*)src, (srcwidth << 2), (uint8*)dest, (srcwidth << 3), srcwidth, srcheight);
+		forEachBand(srcheight, [&](int yFirst, int yLast) {
+			hq2xS_32((uint8*)src, (srcwidth << 2), (uint8*)dest, (srcwidth << 3), srcwidth, srcheight, yFirst, yLast);
+		});
 	return;
 	case LQ2X_ENHANCEMENT:
-		lq2x_32((uint8*)src, (srcwidth << 2), (uint8*)dest, (srcwidth << 3), srcwidth, srcheight);
+		forEachBand(srcheight, [&](int yFirst, int yLast) {
+			lq2x_32((uint8*)src, (srcwidth << 2), (uint8*)dest, (srcwidth << 3), srcwidth, srcheight, yFirst, yLast);
+		});
 	return;
 	case LQ2XS_ENHANCEMENT:
-		lq2xS_32((uint8*)src, (srcwidth << 2), (uint8*)dest, (srcwidth << 3), srcwidth, srcheight);
+		forEachBand(srcheight, [&](int yFirst, int yLast) {
+			lq2xS_32((uint8*)src, (srcwidth << 2), (uint8*)dest, (srcwidth << 3), srcwidth, srcheight, yFirst, yLast);
+		});
 	return;
 	case X2SAI_ENHANCEMENT:
-		Super2xSaI_8888((uint32*)src, (uint32*)dest, srcwidth, srcheight, srcwidth);
+		forEachBand(srcheight, [&](uint32 yFirst, uint32 yLast) {
+			Super2xSaI_8888((uint32*)src, (uint32*)dest, srcwidth, srcheight, srcwidth, yFirst, yLast);
+		});
 	return;
 	case X2_ENHANCEMENT:
-		Texture2x_32((uint8*)src, (srcwidth << 2), (uint8*)dest, (srcwidth << 3), srcwidth, srcheight);
+		forEachBand(srcheight, [&](int yFirst, int yLast) {
+			Texture2x_32((uint8*)src, (srcwidth << 2), (uint8*)dest, (srcwidth << 3), srcwidth, srcheight, yFirst, yLast);
+		});
 	return;
 	}
 
@@ -806,11 +819,15 @@ void filter_8888(uint32 *src, uint32 srcwidth, uint32 srcheight, uint32 *dest, u
 	case SMOOTH_FILTER_2:
 	case SMOOTH_FILTER_3:
 	case SMOOTH_FILTER_4:
-		SmoothFilter_8888((uint32*)src, srcwidth, srcheight, (uint32*)dest, (filter & SMOOTH_FILTER_MASK));
+		forEachBand(srcheight, [&](uint32 yFirst, uint32 yLast) {
+			SmoothFilter_8888((uint32*)src, srcwidth, srcheight, (uint32*)dest, (filter & SMOOTH_FILTER_MASK), yFirst, yLast);
+		});
 	return;
 	case SHARP_FILTER_1:
 	case SHARP_FILTER_2:
-		SharpFilter_8888((uint32*)src, srcwidth, srcheight, (uint32*)dest, (filter & SHARP_FILTER_MASK));
+		forEachBand(srcheight, [&](uint32 yFirst, uint32 yLast) {
+			SharpFilter_8888((uint32*)src, srcwidth, srcheight, (uint32*)dest, (filter & SHARP_FILTER_MASK), yFirst, yLast);
+		});
 	return;
 	}
 }
@@ -27,7 +27,7 @@
 
 #define GET_RESULT(A, B, C, D) ((A != C || A != D) - (B != C || B != D))
 
-void Super2xSaI_8888(uint32 *srcPtr, uint32 *destPtr, uint32 width, uint32 height, uint32 pitch)
+void Super2xSaI_8888(uint32 *srcPtr, uint32 *destPtr, uint32 width, uint32 height, uint32 pitch, uint32 yFirst, uint32 yLast)
 {
 #define SAI_INTERPOLATE_8888(A, B) ((A & 0xFEFEFEFE) >> 1) + ((B & 0xFEFEFEFE) >> 1) + (A & B & 0x01010101)
 #define SAI_Q_INTERPOLATE_8888(A, B, C, D) ((A & 0xFCFCFCFC) >> 2) + ((B & 0xFCFCFCFC) >> 2) + ((C & 0xFCFCFCFC) >> 2) + ((D & 0xFCFCFCFC) >> 2) \
@@ -46,6 +46,9 @@ void Super2xSaI_8888(uint32 *srcPtr, uint32 *destPtr, uint32 width, uint32 heigh
   uint32 colorS1, colorS2;
   uint32 product1a, product1b, product2a, product2b;
 
+  srcPtr += yFirst * pitch;
+  destPtr += yFirst * (pitch << 2);
+
 #include "TextureFilters_2xsai.h"
 
 #undef SAI_INTERPOLATE
@@ -72,6 +75,9 @@ void Super2xSaI_4444(uint16 *srcPtr, uint16 *destPtr, uint32 width, uint32 heigh
   uint16 colorS1, colorS2;
   uint16 product1a, product1b, product2a, product2b;
 
+  const uint32 yFirst = 0;
+  const uint32 yLast = height;
+
 #include "TextureFilters_2xsai.h"
 
 #undef SAI_INTERPOLATE
@@ -97,6 +103,9 @@ void Super2xSaI_1555(uint16 *srcPtr, uint16 *destPtr, uint32 width, uint32 heigh
   uint16 colorS1, colorS2;
   uint16 product1a, product1b, product2a, product2b;
 
+  const uint32 yFirst = 0;
+  const uint32 yLast = height;
+
 #include "TextureFilters_2xsai.h"
 
 #undef SAI_INTERPOLATE
@@ -122,6 +131,9 @@ void Super2xSaI_565(uint16 *srcPtr, uint16 *destPtr, uint32 width, uint32 height
   uint16 colorS1, colorS2;
   uint16 product1a, product1b, product2a, product2b;
 
+  const uint32 yFirst = 0;
+  const uint32 yLast = height;
+
 #include "TextureFilters_2xsai.h"
 
 #undef SAI_INTERPOLATE
@@ -147,6 +159,9 @@ void Super2xSaI_8(uint8 *srcPtr, uint8 *destPtr, uint32 width, uint32 height, ui
   uint8 colorS1, colorS2;
   uint8 product1a, product1b, product2a, product2b;
 
+  const uint32 yFirst = 0;
+  const uint32 yLast = height;
+
 #include "TextureFilters_2xsai.h"
 
 #undef SAI_INTERPOLATE
@@ -29,7 +29,7 @@
   uint16 x;
   uint16 y;
 
-  for (y = 0; y < height; y++) {
+  for (y = yFirst; y < yLast; y++) {
     if ((y > 0) && (y < height - 1)) {
       row0 = width;
       row0 = -row0;
@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 /* 2007 Mudlord - Added hq2xS lq2xS filters */
 
 #include "TextureFilters.h"
+#include "TextureFilters_simd.h"
 
 /************************************************************************/
 /* hq2x filters                                                         */
@@ -556,24 +557,8 @@ static void hq2x_32_def(uint32* dst0, uint32* dst1, const uint32* src0, const ui
 	  c[8] = src2[0];
 	}
 
-	mask = 0;
-
-	if (hq2x_interp_32_diff(c[0], c[4]))
-	  mask |= 1 << 0;
-	if (hq2x_interp_32_diff(c[1], c[4]))
-	  mask |= 1 << 1;
-	if (hq2x_interp_32_diff(c[2], c[4]))
-	  mask |= 1 << 2;
-	if (hq2x_interp_32_diff(c[3], c[4]))
-	  mask |= 1 << 3;
-	if (hq2x_interp_32_diff(c[5], c[4]))
-	  mask |= 1 << 4;
-	if (hq2x_interp_32_diff(c[6], c[4]))
-	  mask |= 1 << 5;
-	if (hq2x_interp_32_diff(c[7], c[4]))
-	  mask |= 1 << 6;
-	if (hq2x_interp_32_diff(c[8], c[4]))
-	  mask |= 1 << 7;
+	const uint32 nb[8] = { c[0], c[1], c[2], c[3], c[5], c[6], c[7], c[8] };
+	mask = (unsigned char)hq2x_diff_mask_32(nb, c[4]);
 
 #define P0 dst0[0]
 #define P1 dst0[1]
@@ -1312,62 +1297,35 @@ void hq2xS_16(u8 *srcPtr, u32 srcPitch, u8 * /* deltaPtr */,
 }
 #endif /* !_16BPP_HACK */
 
-void hq2x_32(uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height)
-{
-  uint32 *dst0 = (uint32 *)dstPtr;
-  uint32 *dst1 = dst0 + (dstPitch >> 2);
-
-  uint32 *src0 = (uint32 *)srcPtr;
-  uint32 *src1 = src0 + (srcPitch >> 2);
-  uint32 *src2 = src1 + (srcPitch >> 2);
-
-  int count;
-
-  hq2x_32_def(dst0, dst1, src0, src0, src1, width);
-  if( height == 1 ) return;
-
-  count = height;
+typedef void (*hq2x_32_row)(uint32* dst0, uint32* dst1, const uint32* src0, const uint32* src1, const uint32* src2, unsigned count);
 
-  count -= 2;
-  while(count>0) {
-	dst0 += dstPitch >> 1;
-	dst1 += dstPitch >> 1;
-	hq2x_32_def(dst0, dst1, src0, src1, src2, width);
-	src0 = src1;
-	src1 = src2;
-	src2 += srcPitch >> 2;
-	--count;
+/* Scales source rows [yFirst, yLast). Rows above and below the slice are read
+ * from the source, so slices of one image can be scaled separately. */
+static void hq2x_32_rows(hq2x_32_row edgeRow, hq2x_32_row midRow,
+						 uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, int yFirst, int yLast)
+{
+  for (int y = yFirst; y < yLast; ++y) {
+	const uint32 *src0 = (const uint32 *)(srcPtr + (y > 0 ? y - 1 : y) * srcPitch);
+	const uint32 *src1 = (const uint32 *)(srcPtr + y * srcPitch);
+	const uint32 *src2 = (const uint32 *)(srcPtr + (y < height - 1 ? y + 1 : y) * srcPitch);
+	uint32 *dst0 = (uint32 *)(dstPtr + y * 2 * dstPitch);
+	uint32 *dst1 = dst0 + (dstPitch >> 2);
+
+	if (y == 0 || y == height - 1)
+	  edgeRow(dst0, dst1, src0, src1, src2, width);
+	else
+	  midRow(dst0, dst1, src0, src1, src2, width);
   }
-  dst0 += dstPitch >> 1;
-  dst1 += dstPitch >> 1;
-  hq2x_32_def(dst0, dst1, src0, src1, src1, width);
 }
 
-void hq2xS_32(uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height)
+void hq2x_32(uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, int yFirst, int yLast)
 {
-  uint32 *dst0 = (uint32 *)dstPtr;
-  uint32 *dst1 = dst0 + (dstPitch >> 2);
-
-  uint32 *src0 = (uint32 *)srcPtr;
-  uint32 *src1 = src0 + (srcPitch >> 2);
-  uint32 *src2 = src1 + (srcPitch >> 2);
-  hq2xS_32_def(dst0, dst1, src0, src0, src1, width);
-
-  int count = height;
+  hq2x_32_rows(hq2x_32_def, hq2x_32_def, srcPtr, srcPitch, dstPtr, dstPitch, width, height, yFirst, yLast);
+}
 
-  count -= 2;
-  while(count) {
-	dst0 += dstPitch >> 1;
-	dst1 += dstPitch >> 1;
-	hq2xS_32_def(dst0, dst1, src0, src1, src2, width);
-	src0 = src1;
-	src1 = src2;
-	src2 += srcPitch >> 2;
-	--count;
-  }
-  dst0 += dstPitch >> 1;
-  dst1 += dstPitch >> 1;
-  hq2xS_32_def(dst0, dst1, src0, src1, src1, width);
+void hq2xS_32(uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, int yFirst, int yLast)
+{
+  hq2x_32_rows(hq2xS_32_def, hq2xS_32_def, srcPtr, srcPitch, dstPtr, dstPitch, width, height, yFirst, yLast);
 }
 
 #if !_16BPP_HACK
@@ -1434,66 +1392,15 @@ void lq2xS_16(uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, in
 }
 #endif /* !_16BPP_HACK */
 
-void lq2x_32(uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height)
+/* lq2x only applies to the first and last rows, the rows between are scaled with hq2x */
+void lq2x_32(uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, int yFirst, int yLast)
 {
-  uint32 *dst0 = (uint32 *)dstPtr;
-  uint32 *dst1 = dst0 + (dstPitch >> 2);
-
-  uint32 *src0 = (uint32 *)srcPtr;
-  uint32 *src1 = src0 + (srcPitch >> 2);
-  uint32 *src2 = src1 + (srcPitch >> 2);
-
-  int count;
-
-  lq2x_32_def(dst0, dst1, src0, src0, src1, width);
-  if( height == 1 ) return;
-
-  count = height;
-
-  count -= 2;
-  while(count>0) {
-	dst0 += dstPitch >> 1;
-	dst1 += dstPitch >> 1;
-	hq2x_32_def(dst0, dst1, src0, src1, src2, width);
-	src0 = src1;
-	src1 = src2;
-	src2 += srcPitch >> 2;
-	--count;
-  }
-  dst0 += dstPitch >> 1;
-  dst1 += dstPitch >> 1;
-  lq2x_32_def(dst0, dst1, src0, src1, src1, width);
+  hq2x_32_rows(lq2x_32_def, hq2x_32_def, srcPtr, srcPitch, dstPtr, dstPitch, width, height, yFirst, yLast);
 }
 
-void lq2xS_32(uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height)
+void lq2xS_32(uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, int yFirst, int yLast)
 {
-  uint32 *dst0 = (uint32 *)dstPtr;
-  uint32 *dst1 = dst0 + (dstPitch >> 2);
-
-  uint32 *src0 = (uint32 *)srcPtr;
-  uint32 *src1 = src0 + (srcPitch >> 2);
-  uint32 *src2 = src1 + (srcPitch >> 2);
-
-  int count;
-
-  lq2xS_32_def(dst0, dst1, src0, src0, src1, width);
-  if( height == 1 ) return;
-
-  count = height;
-
-  count -= 2;
-  while(count>0) {
-	dst0 += dstPitch >> 1;
-	dst1 += dstPitch >> 1;
-	hq2x_32_def(dst0, dst1, src0, src1, src2, width);
-	src0 = src1;
-	src1 = src2;
-	src2 += srcPitch >> 2;
-	--count;
-  }
-  dst0 += dstPitch >> 1;
-  dst1 += dstPitch >> 1;
-  lq2xS_32_def(dst0, dst1, src0, src1, src1, width);
+  hq2x_32_rows(lq2xS_32_def, hq2x_32_def, srcPtr, srcPitch, dstPtr, dstPitch, width, height, yFirst, yLast);
 }
 
 /************************************************************************/
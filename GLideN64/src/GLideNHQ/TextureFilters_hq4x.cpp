@@ -26,6 +26,7 @@
 #include <math.h>
 #include <stdlib.h>
 #include "TextureFilters.h"
+#include "TextureFilters_simd.h"
 
 #if !_16BPP_HACK
 static uint32 RGB444toYUV[4096];
@@ -688,7 +689,7 @@ void hq4x_565(unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int
 }
 #endif /* !_16BPP_HACK */
 
-void hq4x_8888(unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int SrcPPL, int BpL)
+void hq4x_8888(unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, int SrcPPL, int BpL, int yFirst, int yLast)
 {
 #define hq4x_Interp1 hq4x_Interp1_8888
 #define hq4x_Interp2 hq4x_Interp2_8888
@@ -709,9 +710,6 @@ void hq4x_8888(unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, in
   uint32  c[10];
 
   int pattern;
-  int flag;
-
-  int YUV1, YUV2;
 
   //   +----+----+----+
   //   |    |    |    |
@@ -724,7 +722,10 @@ void hq4x_8888(unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, in
   //   | w7 | w8 | w9 |
   //   +----+----+----+
 
-  for (j = 0; j < Yres; j++) {
+  pIn += yFirst*SrcPPL*4;
+  pOut += yFirst*(SrcPPL*16 + BpL*3);
+
+  for (j = yFirst; j < yLast; j++) {
 	if (j>0)      prevline = -SrcPPL*4; else prevline = 0;
 	if (j<Yres-1) nextline =  SrcPPL*4; else nextline = 0;
 
@@ -753,23 +754,8 @@ void hq4x_8888(unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, in
 		w[9] = w[8];
 	  }
 
-	  pattern = 0;
-	  flag = 1;
-
-	  YUV1 = RGB888toYUV(w[5]);
-
-	  for (k=1; k<=9; k++) {
-		if (k==5) continue;
-
-		if ( w[k] != w[5] ) {
-		  YUV2 = RGB888toYUV(w[k]);
-		  if ( ( abs((YUV1 & Ymask) - (YUV2 & Ymask)) > trY ) ||
-			   ( abs((YUV1 & Umask) - (YUV2 & Umask)) > trU ) ||
-			   ( abs((YUV1 & Vmask) - (YUV2 & Vmask)) > trV ) )
-			pattern |= flag;
-		}
-		flag <<= 1;
-	  }
+	  const uint32 nb[8] = { w[1], w[2], w[3], w[4], w[6], w[7], w[8], w[9] };
+	  pattern = hq4x_diff_mask_8888(nb, w[5]);
 
 	  for (k=1; k<=9; k++)
 		c[k] = w[k];
@@ -0,0 +1,226 @@
+/*
+ * Texture Filtering
+ * Version:  1.0
+ *
+ * this is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * this is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Make; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __TEXTUREFILTERS_SIMD_H__
+#define __TEXTUREFILTERS_SIMD_H__
+
+#include "TxInternal.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTUREFILTERS_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && !defined(__ARMEB__) && !defined(__AARCH64EB__)
+#define TEXTUREFILTERS_NEON
+#include <arm_neon.h>
+#endif
+
+/* Neighbour comparisons of the hq2x and hq4x enhancers.
+ *
+ * Both filters classify a pixel by comparing it with its eight neighbours in
+ * YUV space. The vector versions compare four neighbours at once and return
+ * the same bits as the scalar code: bit k is set when nb[k] differs from c.
+ * Neighbours are passed in row order without the center pixel.
+ */
+
+/* hq2x: y = r + g + b, u = r - b, v = 2g - r - b of the channel differences */
+#define HQ2X_Y_LIMIT (0x30*4)
+#define HQ2X_U_LIMIT (0x07*4)
+#define HQ2X_V_LIMIT (0x06*8)
+
+/* hq4x: y = (r + g + b) / 4, u = (r - b) / 4, v = (2g - r - b) / 8 of each pixel */
+#define HQ4X_Y_LIMIT 0x30
+#define HQ4X_U_LIMIT 0x07
+#define HQ4X_V_LIMIT 0x06
+
+#if defined(TEXTUREFILTERS_SSE2)
+
+static inline __m128i _txOutside(__m128i v, int limit)
+{
+	return _mm_or_si128(_mm_cmpgt_epi32(v, _mm_set1_epi32(limit)),
+						_mm_cmplt_epi32(v, _mm_set1_epi32(-limit)));
+}
+
+static inline uint32 _hq2xDiff4(const uint32 *nb, __m128i c)
+{
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	const __m128i n = _mm_loadu_si128((const __m128i*)nb);
+	const __m128i r = _mm_sub_epi32(_mm_and_si128(n, mask), _mm_and_si128(c, mask));
+	const __m128i g = _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(n, 8), mask), _mm_and_si128(_mm_srli_epi32(c, 8), mask));
+	const __m128i b = _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(n, 16), mask), _mm_and_si128(_mm_srli_epi32(c, 16), mask));
+	const __m128i rb = _mm_add_epi32(r, b);
+	const __m128i y = _mm_add_epi32(rb, g);
+	const __m128i u = _mm_sub_epi32(r, b);
+	const __m128i v = _mm_sub_epi32(_mm_add_epi32(g, g), rb);
+	const __m128i diff = _mm_or_si128(_mm_or_si128(_txOutside(y, HQ2X_Y_LIMIT), _txOutside(u, HQ2X_U_LIMIT)),
+									  _txOutside(v, HQ2X_V_LIMIT));
+	return (uint32)_mm_movemask_ps(_mm_castsi128_ps(diff));
+}
+
+static inline __m128i _hq4xYUV(__m128i p, __m128i & u, __m128i & v)
+{
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	const __m128i r = _mm_and_si128(p, mask);
+	const __m128i g = _mm_and_si128(_mm_srli_epi32(p, 8), mask);
+	const __m128i b = _mm_and_si128(_mm_srli_epi32(p, 16), mask);
+	u = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(r, _mm_set1_epi32(0x200)), b), 2);
+	v = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(_mm_add_epi32(g, g), _mm_set1_epi32(0x400)), _mm_add_epi32(r, b)), 3);
+	return _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(r, g), b), 2);
+}
+
+static inline uint32 _hq4xDiff4(const uint32 *nb, __m128i cy, __m128i cu, __m128i cv)
+{
+	__m128i u, v;
+	const __m128i y = _hq4xYUV(_mm_loadu_si128((const __m128i*)nb), u, v);
+	const __m128i diff = _mm_or_si128(_mm_or_si128(_txOutside(_mm_sub_epi32(y, cy), HQ4X_Y_LIMIT),
+												   _txOutside(_mm_sub_epi32(u, cu), HQ4X_U_LIMIT)),
+									  _txOutside(_mm_sub_epi32(v, cv), HQ4X_V_LIMIT));
+	return (uint32)_mm_movemask_ps(_mm_castsi128_ps(diff));
+}
+
+static inline uint32 hq2x_diff_mask_32(const uint32 *nb, uint32 c)
+{
+	const __m128i vc = _mm_set1_epi32((int)c);
+	return _hq2xDiff4(nb, vc) | (_hq2xDiff4(nb + 4, vc) << 4);
+}
+
+static inline uint32 hq4x_diff_mask_8888(const uint32 *nb, uint32 c)
+{
+	__m128i cu, cv;
+	const __m128i cy = _hq4xYUV(_mm_set1_epi32((int)c), cu, cv);
+	return _hq4xDiff4(nb, cy, cu, cv) | (_hq4xDiff4(nb + 4, cy, cu, cv) << 4);
+}
+
+#elif defined(TEXTUREFILTERS_NEON)
+
+static inline uint32x4_t _txOutside(int32x4_t v, int limit)
+{
+	return vorrq_u32(vcgtq_s32(v, vdupq_n_s32(limit)), vcltq_s32(v, vdupq_n_s32(-limit)));
+}
+
+static inline uint32 _txMoveMask(uint32x4_t m)
+{
+	static const uint32 bits[4] = { 1, 2, 4, 8 };
+	const uint32x4_t v = vandq_u32(m, vld1q_u32(bits));
+	const uint32x2_t s = vadd_u32(vget_low_u32(v), vget_high_u32(v));
+	return vget_lane_u32(vpadd_u32(s, s), 0);
+}
+
+static inline uint32 _hq2xDiff4(const uint32 *nb, uint32x4_t c)
+{
+	const uint32x4_t mask = vdupq_n_u32(0xFF);
+	const uint32x4_t n = vld1q_u32(nb);
+	const int32x4_t r = vsubq_s32(vreinterpretq_s32_u32(vandq_u32(n, mask)), vreinterpretq_s32_u32(vandq_u32(c, mask)));
+	const int32x4_t g = vsubq_s32(vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(n, 8), mask)),
+								  vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(c, 8), mask)));
+	const int32x4_t b = vsubq_s32(vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(n, 16), mask)),
+								  vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(c, 16), mask)));
+	const int32x4_t rb = vaddq_s32(r, b);
+	const int32x4_t y = vaddq_s32(rb, g);
+	const int32x4_t u = vsubq_s32(r, b);
+	const int32x4_t v = vsubq_s32(vaddq_s32(g, g), rb);
+	return _txMoveMask(vorrq_u32(vorrq_u32(_txOutside(y, HQ2X_Y_LIMIT), _txOutside(u, HQ2X_U_LIMIT)),
+								 _txOutside(v, HQ2X_V_LIMIT)));
+}
+
+static inline int32x4_t _hq4xYUV(uint32x4_t p, int32x4_t & u, int32x4_t & v)
+{
+	const uint32x4_t mask = vdupq_n_u32(0xFF);
+	const uint32x4_t r = vandq_u32(p, mask);
+	const uint32x4_t g = vandq_u32(vshrq_n_u32(p, 8), mask);
+	const uint32x4_t b = vandq_u32(vshrq_n_u32(p, 16), mask);
+	u = vreinterpretq_s32_u32(vshrq_n_u32(vsubq_u32(vaddq_u32(r, vdupq_n_u32(0x200)), b), 2));
+	v = vreinterpretq_s32_u32(vshrq_n_u32(vsubq_u32(vaddq_u32(vaddq_u32(g, g), vdupq_n_u32(0x400)), vaddq_u32(r, b)), 3));
+	return vreinterpretq_s32_u32(vshrq_n_u32(vaddq_u32(vaddq_u32(r, g), b), 2));
+}
+
+static inline uint32 _hq4xDiff4(const uint32 *nb, int32x4_t cy, int32x4_t cu, int32x4_t cv)
+{
+	int32x4_t u, v;
+	const int32x4_t y = _hq4xYUV(vld1q_u32(nb), u, v);
+	return _txMoveMask(vorrq_u32(vorrq_u32(_txOutside(vsubq_s32(y, cy), HQ4X_Y_LIMIT),
+										   _txOutside(vsubq_s32(u, cu), HQ4X_U_LIMIT)),
+								 _txOutside(vsubq_s32(v, cv), HQ4X_V_LIMIT)));
+}
+
+static inline uint32 hq2x_diff_mask_32(const uint32 *nb, uint32 c)
+{
+	const uint32x4_t vc = vdupq_n_u32(c);
+	return _hq2xDiff4(nb, vc) | (_hq2xDiff4(nb + 4, vc) << 4);
+}
+
+static inline uint32 hq4x_diff_mask_8888(const uint32 *nb, uint32 c)
+{
+	int32x4_t cu, cv;
+	const int32x4_t cy = _hq4xYUV(vdupq_n_u32(c), cu, cv);
+	return _hq4xDiff4(nb, cy, cu, cv) | (_hq4xDiff4(nb + 4, cy, cu, cv) << 4);
+}
+
+#else
+
+static inline bool _txOutside(int v, int limit)
+{
+	return v > limit || v < -limit;
+}
+
+static inline uint32 hq2x_diff_mask_32(const uint32 *nb, uint32 c)
+{
+	uint32 mask = 0;
+	for (uint32 k = 0; k < 8; k++) {
+		const uint32 n = nb[k];
+		/* channel differences below 8 never exceed the limits */
+		if ((n & 0xF8F8F8) == (c & 0xF8F8F8))
+			continue;
+		const int r = (int)(n & 0xFF) - (int)(c & 0xFF);
+		const int g = (int)((n >> 8) & 0xFF) - (int)((c >> 8) & 0xFF);
+		const int b = (int)((n >> 16) & 0xFF) - (int)((c >> 16) & 0xFF);
+		if (_txOutside(r + g + b, HQ2X_Y_LIMIT) || _txOutside(r - b, HQ2X_U_LIMIT) || _txOutside(2*g - r - b, HQ2X_V_LIMIT))
+			mask |= 1 << k;
+	}
+	return mask;
+}
+
+static inline int _hq4xYUV(uint32 p, int & u, int & v)
+{
+	const int r = p & 0xFF;
+	const int g = (p >> 8) & 0xFF;
+	const int b = (p >> 16) & 0xFF;
+	u = (0x200 + r - b) >> 2;
+	v = (0x400 + 2*g - r - b) >> 3;
+	return (r + g + b) >> 2;
+}
+
+static inline uint32 hq4x_diff_mask_8888(const uint32 *nb, uint32 c)
+{
+	int cu, cv;
+	const int cy = _hq4xYUV(c, cu, cv);
+	uint32 mask = 0;
+	for (uint32 k = 0; k < 8; k++) {
+		if (nb[k] == c)
+			continue;
+		int u, v;
+		const int y = _hq4xYUV(nb[k], u, v);
+		if (_txOutside(y - cy, HQ4X_Y_LIMIT) || _txOutside(u - cu, HQ4X_U_LIMIT) || _txOutside(v - cv, HQ4X_V_LIMIT))
+			mask |= 1 << k;
+	}
+	return mask;
+}
+
+#endif
+
+#endif /* __TEXTUREFILTERS_SIMD_H__ */
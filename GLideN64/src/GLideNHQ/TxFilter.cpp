@@ -25,18 +25,44 @@
 #pragma warning(disable: 4786)
 #endif
 
-#include <functional>
-#include <thread>
 #include <stdlib.h>
 
 #include <osal_files.h>
 #include "TxFilter.h"
+#include "TxThreadPool.h"
 #include "TextureFilters.h"
 #include "TxDbg.h"
 #include "bldno.h"
 
+/* limits the memory held by textures waiting for enhancement */
+#define MAX_ASYNC_TEXTURES 16
+
+struct TxFilter::AsyncJob
+{
+	uint64 crc;
+	int width;
+	int height;
+	uint16 format;
+	std::vector<uint8> src;
+	std::vector<uint8> tex1;
+	std::vector<uint8> tex2;
+	GHQTexInfo info;
+	boolean filtered;
+};
+
 void TxFilter::clear()
 {
+	/* drop the textures waiting for enhancement and stop the workers */
+#ifndef HAVE_LIBNX
+	_asyncCancel.store(true, std::memory_order_release);
+#else
+	_asyncCancel = true;
+#endif
+	TxThreadPool::getInstance()->stop();
+	_asyncDone.clear();
+	_asyncPending.clear();
+	_asyncResult.reset();
+
 	/* clear hires texture cache */
 	delete _txHiResCache;
 
@@ -59,7 +85,7 @@ TxFilter::~TxFilter()
 TxFilter::TxFilter(int maxwidth, int maxheight, int maxbpp, int options,
 	int cachesize, const wchar_t * path, const wchar_t * texPackPath, const wchar_t * ident,
 				   dispInfoFuncExt callback) :
-	_tex1(nullptr), _tex2(nullptr), _txQuantize(nullptr), _txTexCache(nullptr), _txHiResCache(nullptr), _txImage(nullptr)
+	_tex1(nullptr), _tex2(nullptr), _txQuantize(nullptr), _txTexCache(nullptr), _txHiResCache(nullptr), _txImage(nullptr), _asyncCancel(false)
 {
 	/* HACKALERT: the emulator misbehaves and sometimes forgets to shutdown */
 	if ((ident && wcscmp(ident, wst("DEFAULT")) != 0 && _ident.compare(ident) == 0) &&
@@ -90,8 +116,8 @@ TxFilter::TxFilter(int maxwidth, int maxheight, int maxbpp, int options,
 	_txImage      = new TxImage();
 	_txQuantize   = new TxQuantize();
 
-	/* get number of CPU cores. */
-	_numcore = TxUtil::getNumberofProcessors();
+	/* start a worker for every CPU core but the one of the calling thread. */
+	TxThreadPool::getInstance()->start(TxUtil::getNumberofProcessors());
 
 	_initialized = 0;
 
@@ -127,6 +153,16 @@ TxFilter::TxFilter(int maxwidth, int maxheight, int maxbpp, int options,
 	hq4x_init();
 #endif
 
+	/* initialize xBRZ lookup table before any worker uses it */
+	switch (_options & ENHANCEMENT_MASK) {
+	case BRZ2X_ENHANCEMENT:
+	case BRZ3X_ENHANCEMENT:
+	case BRZ4X_ENHANCEMENT:
+	case BRZ5X_ENHANCEMENT:
+	case BRZ6X_ENHANCEMENT:
+		xbrz::init();
+	}
+
 	/* initialize texture cache in bytes. 128Mb will do nicely in most cases */
 	_txTexCache = new TxTexCache(_options, _cacheSize, _path.c_str(), _ident.c_str(), callback);
 
@@ -145,11 +181,8 @@ TxFilter::TxFilter(int maxwidth, int maxheight, int maxbpp, int options,
 boolean
 TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint64 g64crc, GHQTexInfo *info)
 {
-	uint8 *texture = src;
-	uint8 *tmptex = _tex1;
 	if (srcformat == GL_RGBA)
 		srcformat = GL_RGBA8;
-	uint16 destformat = srcformat;
 
 	/* We need to be initialized first! */
 	if (!_initialized) return 0;
@@ -159,7 +192,7 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 
 		/* calculate checksum of source texture */
 		if (!g64crc)
-			g64crc = (uint64)(TxUtil::checksumTx(texture, srcwidth, srcheight, srcformat));
+			g64crc = (uint64)(TxUtil::checksumTx(src, srcwidth, srcheight, srcformat));
 
 		DBG_INFO(80, wst("filter: crc:%08X %08X %d x %d gfmt:%x\n"),
 				 (uint32)(g64crc >> 32), (uint32)(g64crc & 0xffffffff), srcwidth, srcheight, srcformat);
@@ -174,6 +207,24 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 #endif
 	}
 
+	if (!_filter(src, srcwidth, srcheight, srcformat, _tex1, _tex2, info))
+		return 0;
+
+	/* cache the texture. */
+	if (_cacheSize) _txTexCache->add(g64crc, info);
+
+	DBG_INFO(80, wst("filtered texture: %d x %d gfmt:%x\n"), info->width, info->height, info->format);
+
+	return 1;
+}
+
+boolean
+TxFilter::_filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint8 *tex1, uint8 *tex2, GHQTexInfo *info)
+{
+	uint8 *texture = src;
+	uint8 *tmptex = tex1;
+	uint16 destformat = srcformat;
+
 	/* Leave small textures alone because filtering makes little difference.
    * Moreover, some filters require at least 4 * 4 to work.
    * Bypass _options to do ARGB8888->16bpp if _maxbpp=16 or forced color reduction.
@@ -217,7 +268,6 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 				}
 			break;
 			case BRZ3X_ENHANCEMENT:
-				xbrz::init();
 				if (srcwidth  <= (_maxwidth / 3) && srcheight <= (_maxheight / 3)) {
 					filter |= BRZ3X_ENHANCEMENT;
 					scale = 3;
@@ -229,7 +279,6 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 				}
 			break;
 			case BRZ4X_ENHANCEMENT:
-				xbrz::init();
 				if (srcwidth <= (_maxwidth >> 2) && srcheight <= (_maxheight >> 2)) {
 					filter |= BRZ4X_ENHANCEMENT;
 					scale = 4;
@@ -241,7 +290,6 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 				}
 			break;
 			case BRZ5X_ENHANCEMENT:
-				xbrz::init();
 				if (srcwidth <= (_maxwidth / 5) && srcheight <= (_maxheight / 5)) {
 					filter |= BRZ5X_ENHANCEMENT;
 					scale = 5;
@@ -253,7 +301,6 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 				}
 			break;
 			case BRZ6X_ENHANCEMENT:
-				xbrz::init();
 				if (srcwidth <= (_maxwidth / 6) && srcheight <= (_maxheight / 6)) {
 					filter |= BRZ6X_ENHANCEMENT;
 					scale = 6;
@@ -287,54 +334,9 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 	   */
 			while (num_filters > 0) {
 
-				tmptex = (texture == _tex1) ? _tex2 : _tex1;
+				tmptex = (texture == tex1) ? tex2 : tex1;
 
-				uint8 *_texture = texture;
-				uint8 *_tmptex  = tmptex;
-
-				unsigned int numcore = _numcore;
-				unsigned int blkrow = 0;
-				while (numcore > 1 && blkrow == 0) {
-					blkrow = (srcheight >> 2) / numcore;
-					numcore--;
-				}
-				if (blkrow > 0 && numcore > 1) {
-#ifndef HAVE_LIBNX
-					std::thread *thrd[MAX_NUMCORE];
-#endif
-					unsigned int i;
-					int blkheight = blkrow << 2;
-					unsigned int srcStride = (srcwidth * blkheight) << 2;
-					unsigned int destStride = srcStride * scale * scale;
-					for (i = 0; i < numcore - 1; i++) {
-#ifndef HAVE_LIBNX
-						thrd[i] = new std::thread(std::bind(filter_8888,
-																(uint32*)_texture,
-																srcwidth,
-																blkheight,
-																(uint32*)_tmptex,
-																filter,
-																i));
-#endif
-						_texture += srcStride;
-						_tmptex  += destStride;
-					}
-#ifndef HAVE_LIBNX
-                    thrd[i] = new std::thread(std::bind(filter_8888,
-															(uint32*)_texture,
-															srcwidth,
-															srcheight - blkheight * i,
-															(uint32*)_tmptex,
-															filter,
-															i));
-					for (i = 0; i < numcore; i++) {
-						thrd[i]->join();
-						delete thrd[i];
-					}
-#endif
-				} else {
-					filter_8888((uint32*)_texture, srcwidth, srcheight, (uint32*)_tmptex, filter, 0);
-				}
+				filter_8888((uint32*)texture, srcwidth, srcheight, (uint32*)tmptex, filter);
 
 				if (filter & ENHANCEMENT_MASK) {
 					srcwidth  *= scale;
@@ -354,7 +356,7 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 				if (srcformat == GL_RGBA8)
 					srcformat = GL_RGBA4;
 				if (srcformat != GL_RGBA8) {
-					tmptex = (texture == _tex1) ? _tex2 : _tex1;
+					tmptex = (texture == tex1) ? tex2 : tex1;
 					if (!_txQuantize->quantize(texture, tmptex, srcwidth, srcheight, GL_RGBA8, srcformat)) {
 						DBG_INFO(80, wst("Error: unsupported format! gfmt:%x\n"), srcformat);
 						return 0;
@@ -369,7 +371,7 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 		case GL_RGBA4:
 
 			int scale = 1;
-			tmptex = (texture == _tex1) ? _tex2 : _tex1;
+			tmptex = (texture == tex1) ? tex2 : tex1;
 
 			switch (_options & ENHANCEMENT_MASK) {
 			case HQ4X_ENHANCEMENT:
@@ -424,11 +426,11 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 			}
 
 			if (_options & SMOOTH_FILTER_MASK) {
-				tmptex = (texture == _tex1) ? _tex2 : _tex1;
+				tmptex = (texture == tex1) ? tex2 : tex1;
 				SmoothFilter_4444((uint16*)texture, srcwidth, srcheight, (uint16*)tmptex, (_options & SMOOTH_FILTER_MASK));
 				texture = tmptex;
 			} else if (_options & SHARP_FILTER_MASK) {
-				tmptex = (texture == _tex1) ? _tex2 : _tex1;
+				tmptex = (texture == tex1) ? tex2 : tex1;
 				SharpFilter_4444((uint16*)texture, srcwidth, srcheight, (uint16*)tmptex, (_options & SHARP_FILTER_MASK));
 				texture = tmptex;
 			}
@@ -449,12 +451,129 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 	info->is_hires_tex = 0;
 	setTextureFormat(destformat, info);
 
-	/* cache the texture. */
-	if (_cacheSize) _txTexCache->add(g64crc, info);
+	return 1;
+}
 
-	DBG_INFO(80, wst("filtered texture: %d x %d gfmt:%x\n"), info->width, info->height, info->format);
+/* the largest scale the enhancement in options may apply */
+static int
+maxEnhancementScale(int options)
+{
+	switch (options & ENHANCEMENT_MASK) {
+	case NO_ENHANCEMENT:
+		return 1;
+	case BRZ3X_ENHANCEMENT:
+		return 3;
+	case HQ4X_ENHANCEMENT:
+	case BRZ4X_ENHANCEMENT:
+		return 4;
+	case BRZ5X_ENHANCEMENT:
+		return 5;
+	case BRZ6X_ENHANCEMENT:
+		return 6;
+	}
+	return 2;
+}
+
+boolean
+TxFilter::filterAsync(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint64 g64crc)
+{
+#ifdef HAVE_LIBNX
+	return 0;
+#else
+	if (!_initialized || TxThreadPool::getInstance()->getNumWorkers() == 0)
+		return 0;
+
+	/* small textures are not worth a trip to the workers */
+	if (srcwidth < 4 || srcheight < 4)
+		return 0;
+
+	if (srcformat == GL_RGBA)
+		srcformat = GL_RGBA8;
+
+	const int srcSize = TxUtil::sizeofTx(srcwidth, srcheight, srcformat);
+	if (srcSize == 0)
+		return 0;
+
+	if (!g64crc)
+		g64crc = (uint64)(TxUtil::checksumTx(src, srcwidth, srcheight, srcformat));
+
+	/* already on its way */
+	if (_asyncPending.find(g64crc) != _asyncPending.end())
+		return 1;
+
+	if (_asyncPending.size() >= MAX_ASYNC_TEXTURES)
+		return 0;
+
+	const int scale = maxEnhancementScale(_options);
+	std::shared_ptr<AsyncJob> job = std::make_shared<AsyncJob>();
+	job->crc = g64crc;
+	job->width = srcwidth;
+	job->height = srcheight;
+	job->format = srcformat;
+	job->filtered = 0;
+	try {
+		job->src.assign(src, src + srcSize);
+		job->tex1.resize((srcwidth * srcheight * scale * scale) << 2);
+		job->tex2.resize(job->tex1.size());
+	} catch(std::bad_alloc) {
+		return 0;
+	}
+
+	DBG_INFO(80, wst("filterAsync: crc:%08X %08X %d x %d gfmt:%x\n"),
+			 (uint32)(g64crc >> 32), (uint32)(g64crc & 0xffffffff), srcwidth, srcheight, srcformat);
+
+	_asyncPending.insert(g64crc);
+	const bool posted = TxThreadPool::getInstance()->post([this, job] {
+		if (!_asyncCancel.load(std::memory_order_acquire))
+			job->filtered = _filter(job->src.data(), job->width, job->height, job->format,
+									job->tex1.data(), job->tex2.data(), &job->info);
+		std::lock_guard<std::mutex> lock(_asyncMutex);
+		_asyncDone.push_back(job);
+	});
+	if (!posted) {
+		_asyncPending.erase(g64crc);
+		return 0;
+	}
 
 	return 1;
+#endif
+}
+
+boolean
+TxFilter::getAsyncResult(uint64 *g64crc, GHQTexInfo *info)
+{
+	/* the data of the previous result is not needed anymore */
+	_asyncResult.reset();
+
+#ifndef HAVE_LIBNX
+	while (!_asyncPending.empty()) {
+		std::shared_ptr<AsyncJob> job;
+		{
+			std::lock_guard<std::mutex> lock(_asyncMutex);
+			if (_asyncDone.empty())
+				return 0;
+			job = _asyncDone.front();
+			_asyncDone.pop_front();
+		}
+		_asyncPending.erase(job->crc);
+
+		if (!job->filtered)
+			continue;
+
+		*g64crc = job->crc;
+		*info = job->info;
+
+		/* cache the texture. */
+		if (_cacheSize) _txTexCache->add(job->crc, info);
+
+		DBG_INFO(80, wst("filtered texture: %d x %d gfmt:%x\n"), info->width, info->height, info->format);
+
+		_asyncResult = job;
+		return 1;
+	}
+#endif
+
+	return 0;
 }
 
 boolean
@@ -31,11 +31,17 @@
 #include "TxUtil.h"
 #include "TxImage.h"
 
+#include <deque>
+#include <memory>
+#include <set>
+#ifndef HAVE_LIBNX
+#include <atomic>
+#include <mutex>
+#endif
+
 class TxFilter
 {
 private:
-  int _numcore;
-
   uint8 *_tex1;
   uint8 *_tex2;
   int _maxwidth;
@@ -50,7 +56,22 @@ private:
   TxHiResCache *_txHiResCache;
   TxImage *_txImage;
   boolean _initialized;
+
+  /* textures enhanced on the worker threads */
+  struct AsyncJob;
+  std::set<uint64> _asyncPending;
+  std::deque< std::shared_ptr<AsyncJob> > _asyncDone;
+  std::shared_ptr<AsyncJob> _asyncResult;
+#ifndef HAVE_LIBNX
+  std::mutex _asyncMutex;
+  std::atomic<bool> _asyncCancel;
+#else
+  bool _asyncCancel;
+#endif
+
   void clear();
+  boolean _filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat,
+                  uint8 *tex1, uint8 *tex2, GHQTexInfo *info);
 public:
   ~TxFilter();
   TxFilter(int maxwidth,
@@ -68,6 +89,16 @@ public:
 				  uint16 srcformat,
 				  uint64 g64crc, /* glide64 crc, 64bit for future use */
 				  GHQTexInfo *info);
+  /* Queues the texture for enhancement on a worker thread.
+   * Returns 0 if the texture must be filtered synchronously. */
+  boolean filterAsync(uint8 *src,
+					  int srcwidth,
+					  int srcheight,
+					  uint16 srcformat,
+					  uint64 g64crc);
+  /* Returns the next texture enhanced on a worker thread.
+   * info->data stays valid until the next call. */
+  boolean getAsyncResult(uint64 *g64crc, GHQTexInfo *info);
   boolean hirestex(uint64 g64crc, /* glide64 crc, 64bit for future use */
 					  uint64 r_crc64,   /* checksum hi:palette low:texture */
 					  uint16 *palette,
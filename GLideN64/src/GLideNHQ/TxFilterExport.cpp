@@ -65,6 +65,25 @@ txfilter_filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat,
   return 0;
 }
 
+TAPI boolean TAPIENTRY
+txfilter_filter_async(uint8 *src, int srcwidth, int srcheight, uint16 srcformat,
+		 uint64 g64crc)
+{
+  if (txFilter)
+	return txFilter->filterAsync(src, srcwidth, srcheight, srcformat, g64crc);
+
+  return 0;
+}
+
+TAPI boolean TAPIENTRY
+txfilter_async_result(uint64 *g64crc, GHQTexInfo *info)
+{
+  if (txFilter)
+	return txFilter->getAsyncResult(g64crc, info);
+
+  return 0;
+}
+
 TAPI boolean TAPIENTRY
 txfilter_hirestex(uint64 g64crc, uint64 r_crc64, uint16 *palette, GHQTexInfo *info)
 {
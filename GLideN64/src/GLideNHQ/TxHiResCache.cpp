@@ -96,15 +96,37 @@ TxHiResCache::TxHiResCache(int maxwidth, int maxheight, int maxbpp, int options,
 	return;
   }
 
+  int config = _options & (HIRESTEXTURES_MASK|TILE_HIRESTEX|FORCE16BPP_HIRESTEX|GZ_HIRESTEXCACHE|LET_TEXARTISTS_FLY);
+
+  /* use an indexed pack shipped with the texture pack */
+  if (!_texPackPath.empty()) {
+	tx_wstring packname(_texPackPath);
+	packname += OSAL_DIR_SEPARATOR_STR;
+	packname += _ident + wst(".") + TEXPACK_EXT;
+	if (_pack.open(packname.c_str(), config)) {
+	  _haveCache = 1;
+	  return;
+	}
+  }
+
 #if DUMP_CACHE
+  tx_wstring cachepath(_path);
+  cachepath += OSAL_DIR_SEPARATOR_STR;
+  cachepath += wst("cache");
+  tx_wstring packname(cachepath);
+  packname += OSAL_DIR_SEPARATOR_STR;
+  packname += _ident + wst("_HIRESTEXTURES.") + TEXPACK_EXT;
+
   /* read in hires texture cache */
   if (_options & DUMP_HIRESTEXCACHE) {
+	/* textures converted on a previous run are looked up in the pack directly */
+	if (_pack.open(packname.c_str(), config)) {
+	  _haveCache = 1;
+	  return;
+	}
+
 	/* find it on disk */
 	tx_wstring filename = _ident + wst("_HIRESTEXTURES.") + TEXCACHE_EXT;
-	tx_wstring cachepath(_path);
-	cachepath += OSAL_DIR_SEPARATOR_STR;
-	cachepath += wst("cache");
-	int config = _options & (HIRESTEXTURES_MASK|TILE_HIRESTEX|FORCE16BPP_HIRESTEX|GZ_HIRESTEXCACHE|LET_TEXARTISTS_FLY);
 
 	_haveCache = TxCache::load(cachepath.c_str(), filename.c_str(), config);
   }
@@ -112,12 +134,54 @@ TxHiResCache::TxHiResCache(int maxwidth, int maxheight, int maxbpp, int options,
 
   /* read in hires textures */
   if (!_haveCache) TxHiResCache::load(0);
+
+#if DUMP_CACHE
+  /* convert the textures to an indexed pack and use it instead of the memory cache */
+  if ((_options & DUMP_HIRESTEXCACHE) && !_abortLoad && !_cache.empty()) {
+	osal_mkdirp(cachepath.c_str());
+	if (writePack(packname.c_str(), config) && _pack.open(packname.c_str(), config)) {
+	  TxCache::clear();
+	  _haveCache = 1;
+	}
+  }
+#endif
 }
 
 boolean
 TxHiResCache::empty()
 {
-  return _cache.empty();
+  return _cache.empty() && !_pack.isOpen();
+}
+
+boolean
+TxHiResCache::get(uint64 checksum, GHQTexInfo *info)
+{
+  if (_pack.get(checksum, info))
+	return 1;
+
+  return TxCache::get(checksum, info);
+}
+
+boolean
+TxHiResCache::writePack(const wchar_t *filename, int config)
+{
+  TxHiResPack::Textures textures;
+  std::map<uint64, TXCACHE*>::iterator itMap = _cache.begin();
+  while (itMap != _cache.end()) {
+	textures.insert(TxHiResPack::Textures::value_type((*itMap).first,
+		std::make_pair((*itMap).second->info, (uint32)(*itMap).second->size)));
+	itMap++;
+  }
+
+  if (!TxHiResPack::write(filename, config, textures)) {
+	INFO(80, wst("Error: failed to write hires texture pack %ls\n"), filename);
+	return 0;
+  }
+
+  if (_callback)
+	(*_callback)(wst("Hires textures converted to %ls\n"), filename);
+
+  return 1;
 }
 
 boolean
@@ -125,7 +189,11 @@ TxHiResCache::load(boolean replace) /* 0 : reload, 1 : replace partial */
 {
   if (!_texPackPath.empty() && !_ident.empty()) {
 
-	if (!replace) TxCache::clear();
+	if (!replace) {
+	  TxCache::clear();
+	  /* textures are read from the directory again */
+	  _pack.close();
+	}
 
 	tx_wstring dir_path(_texPackPath);
 
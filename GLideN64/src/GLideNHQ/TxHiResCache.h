@@ -34,6 +34,7 @@
 #include "TxQuantize.h"
 #include "TxImage.h"
 #include "TxReSample.h"
+#include "TxHiResPack.h"
 
 class TxHiResCache : public TxCache
 {
@@ -47,7 +48,9 @@ private:
   TxQuantize *_txQuantize;
   TxReSample *_txReSample;
   tx_wstring _texPackPath;
+  TxHiResPack _pack;
   boolean loadHiResTextures(const wchar_t * dir_path, boolean replace);
+  boolean writePack(const wchar_t *filename, int config);
 public:
   ~TxHiResCache();
   TxHiResCache(int maxwidth, int maxheight, int maxbpp, int options,
@@ -55,6 +58,8 @@ public:
       dispInfoFuncExt callback);
   boolean empty();
   boolean load(boolean replace);
+  boolean get(uint64 checksum, /* checksum hi:palette low:texture */
+              GHQTexInfo *info);
 };
 
 #endif /* __TXHIRESCACHE_H__ */
@@ -0,0 +1,393 @@
+/*
+ * Texture Filtering
+ * Version:  1.0
+ *
+ * this is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * this is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Make; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifdef __MSC__
+#pragma warning(disable: 4786)
+#endif
+
+#include "TxHiResPack.h"
+#include "TxDbg.h"
+#include <zlib.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#if !defined(OS_WINDOWS) && !defined(HAVE_LIBNX)
+#define TXPACK_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define TXPACK_MAGIC "GHTP"
+#define TXPACK_VERSION 1
+
+/* decoded textures kept in memory, in bytes */
+#define TXPACK_DECODED_SIZE (64 * 1024 * 1024)
+
+static FILE *
+openFile(const wchar_t *filename, const char *mode)
+{
+#ifdef OS_WINDOWS
+	wchar_t wmode[4];
+	mbstowcs(wmode, mode, 4);
+	return _wfopen(filename, wmode);
+#else
+	char cbuf[MAX_PATH];
+	wcstombs(cbuf, filename, MAX_PATH);
+	return fopen(cbuf, mode);
+#endif
+}
+
+static bool
+entryLess(const TxHiResPack::Entry &entry, uint64 checksum)
+{
+	return entry.checksum < checksum;
+}
+
+TxHiResPack::TxHiResPack() :
+	_numEntries(0), _index(nullptr), _map(nullptr), _mapSize(0),
+#ifdef OS_WINDOWS
+	_file(INVALID_HANDLE_VALUE), _mapping(nullptr),
+#endif
+	_fp(nullptr), _decodedSize(0), _maxDecodedSize(TXPACK_DECODED_SIZE)
+{
+}
+
+TxHiResPack::~TxHiResPack()
+{
+	close();
+}
+
+boolean
+TxHiResPack::open(const wchar_t *filename, uint32 config)
+{
+	close();
+
+	Header header;
+	uint64 fileSize = 0;
+
+#if defined(OS_WINDOWS)
+	_file = CreateFileW(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (_file != INVALID_HANDLE_VALUE) {
+		LARGE_INTEGER size;
+		if (GetFileSizeEx(_file, &size) && size.QuadPart >= (LONGLONG)sizeof(Header)) {
+			_mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (_mapping != nullptr) {
+				_map = (const uint8*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+				_mapSize = fileSize = size.QuadPart;
+			}
+		}
+	}
+#elif defined(TXPACK_MMAP)
+	char cbuf[MAX_PATH];
+	wcstombs(cbuf, filename, MAX_PATH);
+	const int fd = ::open(cbuf, O_RDONLY);
+	if (fd >= 0) {
+		struct stat st;
+		if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(Header)) {
+			void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			if (map != MAP_FAILED) {
+				_map = (const uint8*)map;
+				_mapSize = fileSize = st.st_size;
+			}
+		}
+		/* the mapping stays valid after the descriptor is closed */
+		::close(fd);
+	}
+#endif
+
+	if (_map != nullptr) {
+		memcpy(&header, _map, sizeof(Header));
+	} else {
+		/* no mapping, read the index and seek to the textures on lookup */
+		_fp = openFile(filename, "rb");
+		if (_fp == nullptr) {
+			close();
+			return 0;
+		}
+		if (fread(&header, sizeof(Header), 1, _fp) != 1 || fseek(_fp, 0, SEEK_END) != 0) {
+			close();
+			return 0;
+		}
+		fileSize = ftell(_fp);
+	}
+
+	if (memcmp(header.magic, TXPACK_MAGIC, 4) != 0 ||
+		header.version != TXPACK_VERSION ||
+		header.config != config ||
+		header.numEntries == 0 ||
+		header.indexOffset < sizeof(Header) ||
+		header.indexOffset + (uint64)header.numEntries * sizeof(Entry) > fileSize) {
+		DBG_INFO(80, wst("Error: hires texture pack does not match! %ls\n"), filename);
+		close();
+		return 0;
+	}
+
+	if (_map != nullptr) {
+		_index = (const Entry*)(_map + header.indexOffset);
+	} else {
+		try {
+			_indexBuf.resize(header.numEntries);
+		} catch (std::bad_alloc) {
+			close();
+			return 0;
+		}
+		if (fseek(_fp, (long)header.indexOffset, SEEK_SET) != 0 ||
+			fread(_indexBuf.data(), sizeof(Entry), header.numEntries, _fp) != header.numEntries) {
+			close();
+			return 0;
+		}
+		_index = _indexBuf.data();
+	}
+
+	/* reject packs with textures outside of the file */
+	for (uint32 i = 0; i < header.numEntries; i++) {
+		if (_index[i].offset < sizeof(Header) ||
+			_index[i].offset + _index[i].size > header.indexOffset) {
+			DBG_INFO(80, wst("Error: hires texture pack is damaged! %ls\n"), filename);
+			close();
+			return 0;
+		}
+	}
+
+	_numEntries = header.numEntries;
+
+	DBG_INFO(80, wst("hires texture pack: %d textures %ls\n"), _numEntries, filename);
+
+	return 1;
+}
+
+void
+TxHiResPack::close()
+{
+#if defined(OS_WINDOWS)
+	if (_map != nullptr)
+		UnmapViewOfFile(_map);
+	if (_mapping != nullptr)
+		CloseHandle(_mapping);
+	if (_file != INVALID_HANDLE_VALUE)
+		CloseHandle(_file);
+	_mapping = nullptr;
+	_file = INVALID_HANDLE_VALUE;
+#elif defined(TXPACK_MMAP)
+	if (_map != nullptr)
+		munmap((void*)_map, _mapSize);
+#endif
+	_map = nullptr;
+	_mapSize = 0;
+
+	if (_fp != nullptr)
+		fclose(_fp);
+	_fp = nullptr;
+	_indexBuf.clear();
+
+	_index = nullptr;
+	_numEntries = 0;
+
+	_decoded.clear();
+	_decodedList.clear();
+	_decodedSize = 0;
+}
+
+const TxHiResPack::Entry *
+TxHiResPack::_find(uint64 checksum) const
+{
+	const Entry *end = _index + _numEntries;
+	const Entry *entry = std::lower_bound(_index, end, checksum, entryLess);
+	if (entry == end || entry->checksum != checksum)
+		return nullptr;
+	return entry;
+}
+
+uint8 *
+TxHiResPack::_allocDecoded(uint64 checksum, uint32 size)
+{
+	/* drop the least recently used textures. the last returned one stays. */
+	while (_decodedSize + size > _maxDecodedSize && _decodedList.size() > 1) {
+		std::map<uint64, Decoded>::iterator itMap = _decoded.find(_decodedList.front());
+		_decodedSize -= itMap->second.data.size();
+		_decoded.erase(itMap);
+		_decodedList.pop_front();
+	}
+
+	Decoded &decoded = _decoded[checksum];
+	try {
+		decoded.data.resize(size);
+	} catch (std::bad_alloc) {
+		_decoded.erase(checksum);
+		return nullptr;
+	}
+	_decodedList.push_back(checksum);
+	decoded.it = --_decodedList.end();
+	_decodedSize += size;
+
+	return decoded.data.data();
+}
+
+const uint8 *
+TxHiResPack::_load(const Entry *entry)
+{
+	const boolean compressed = (entry->format & GL_TEXFMT_GZ) != 0;
+
+	/* uncompressed textures are used right from the mapped file */
+	if (_map != nullptr && !compressed) {
+		if ((int)entry->size < TxUtil::sizeofTx(entry->width, entry->height, entry->format))
+			return nullptr;
+		return _map + entry->offset;
+	}
+
+	std::map<uint64, Decoded>::iterator itMap = _decoded.find(entry->checksum);
+	if (itMap != _decoded.end()) {
+		_decodedList.splice(_decodedList.end(), _decodedList, itMap->second.it);
+		return itMap->second.data.data();
+	}
+
+	const uint8 *src = nullptr;
+	std::vector<uint8> readBuf;
+	if (_map != nullptr) {
+		src = _map + entry->offset;
+	} else {
+		try {
+			readBuf.resize(entry->size);
+		} catch (std::bad_alloc) {
+			return nullptr;
+		}
+		if (fseek(_fp, (long)entry->offset, SEEK_SET) != 0 ||
+			fread(readBuf.data(), 1, entry->size, _fp) != entry->size)
+			return nullptr;
+		src = readBuf.data();
+	}
+
+	if (!compressed) {
+		if ((int)entry->size < TxUtil::sizeofTx(entry->width, entry->height, entry->format))
+			return nullptr;
+		uint8 *dest = _allocDecoded(entry->checksum, entry->size);
+		if (dest != nullptr)
+			memcpy(dest, src, entry->size);
+		return dest;
+	}
+
+	const int dataSize = TxUtil::sizeofTx(entry->width, entry->height, entry->format & ~GL_TEXFMT_GZ);
+	if (dataSize == 0)
+		return nullptr;
+
+	uint8 *dest = _allocDecoded(entry->checksum, dataSize);
+	if (dest == nullptr)
+		return nullptr;
+
+	uLongf destLen = dataSize;
+	if (uncompress(dest, &destLen, src, entry->size) != Z_OK) {
+		DBG_INFO(80, wst("Error: zlib decompression failed!\n"));
+		_decodedSize -= dataSize;
+		_decodedList.pop_back();
+		_decoded.erase(entry->checksum);
+		return nullptr;
+	}
+
+	return dest;
+}
+
+boolean
+TxHiResPack::get(uint64 checksum, GHQTexInfo *info)
+{
+	if (!checksum || _numEntries == 0)
+		return 0;
+
+	const Entry *entry = _find(checksum);
+	if (entry == nullptr)
+		return 0;
+
+	const uint8 *data = _load(entry);
+	if (data == nullptr)
+		return 0;
+
+	info->data = (uint8*)data;
+	info->width = entry->width;
+	info->height = entry->height;
+	info->format = entry->format & ~GL_TEXFMT_GZ;
+	info->texture_format = entry->texture_format;
+	info->pixel_type = entry->pixel_type;
+	info->is_hires_tex = entry->is_hires_tex;
+
+	return 1;
+}
+
+boolean
+TxHiResPack::write(const wchar_t *filename, uint32 config, const Textures &textures)
+{
+	if (textures.empty())
+		return 0;
+
+	FILE *fp = openFile(filename, "wb");
+	if (fp == nullptr)
+		return 0;
+
+	Header header;
+	memcpy(header.magic, TXPACK_MAGIC, 4);
+	header.version = TXPACK_VERSION;
+	header.config = config;
+	header.numEntries = 0;
+	header.indexOffset = 0;
+	header.reserved = 0;
+
+	/* the header is written again once the index is known */
+	boolean ok = fwrite(&header, sizeof(Header), 1, fp) == 1;
+
+	std::vector<Entry> index;
+	index.reserve(textures.size());
+	uint64 offset = sizeof(Header);
+	for (Textures::const_iterator it = textures.begin(); ok && it != textures.end(); ++it) {
+		const GHQTexInfo &info = it->second.first;
+		const uint32 size = it->second.second;
+		if (info.data == nullptr || size == 0)
+			continue;
+
+		Entry entry;
+		memset(&entry, 0, sizeof(Entry));
+		entry.checksum = it->first;
+		entry.offset = offset;
+		entry.size = size;
+		entry.width = info.width;
+		entry.height = info.height;
+		entry.format = info.format;
+		entry.texture_format = info.texture_format;
+		entry.pixel_type = info.pixel_type;
+		entry.is_hires_tex = info.is_hires_tex;
+		index.push_back(entry);
+
+		ok = fwrite(info.data, 1, size, fp) == size;
+		offset += size;
+	}
+
+	if (ok && !index.empty()) {
+		header.numEntries = (uint32)index.size();
+		header.indexOffset = offset;
+		ok = fwrite(index.data(), sizeof(Entry), index.size(), fp) == index.size() &&
+			fseek(fp, 0, SEEK_SET) == 0 &&
+			fwrite(&header, sizeof(Header), 1, fp) == 1;
+	}
+
+	ok = (fclose(fp) == 0) && ok && !index.empty();
+
+	DBG_INFO(80, wst("hires texture pack written: %d textures %ls\n"), index.size(), filename);
+
+	return ok;
+}
@@ -0,0 +1,117 @@
+/*
+ * Texture Filtering
+ * Version:  1.0
+ *
+ * this is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * this is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Make; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __TXHIRESPACK_H__
+#define __TXHIRESPACK_H__
+
+#include "TxInternal.h"
+#include "TxUtil.h"
+#include <stdio.h>
+#include <list>
+#include <map>
+#include <vector>
+
+/* Hi-res texture pack file.
+ *
+ * The textures are stored ready to upload, the way TxHiResCache keeps them in
+ * memory: resized, quantized and optionally zlib compressed (GL_TEXFMT_GZ).
+ * An index sorted by checksum follows the texture data. The file is mapped into
+ * memory on open and a texture is only decompressed when it is looked up.
+ *
+ * All values are in host byte order, like the .htc cache dumps.
+ *
+ *   Header
+ *   texture data...
+ *   Entry[numEntries] sorted by checksum
+ */
+class TxHiResPack
+{
+public:
+  struct Header {
+    char magic[4];      /* "GHTP" */
+    uint32 version;
+    uint32 config;      /* options the textures were converted with */
+    uint32 numEntries;
+    uint64 indexOffset;
+    uint64 reserved;
+  };
+
+  struct Entry {
+    uint64 checksum;    /* hi:palette low:texture */
+    uint64 offset;
+    uint32 size;        /* size of the stored data */
+    uint32 width;
+    uint32 height;
+    uint32 format;      /* GL_TEXFMT_GZ if the data is zlib compressed */
+    uint16 texture_format;
+    uint16 pixel_type;
+    uint8 is_hires_tex;
+    uint8 reserved[3];
+  };
+
+  /* Textures to write, in increasing checksum order. */
+  typedef std::map<uint64, std::pair<GHQTexInfo, uint32> > Textures;
+
+  TxHiResPack();
+  ~TxHiResPack();
+
+  boolean open(const wchar_t *filename, uint32 config);
+  void close();
+  boolean isOpen() const { return _numEntries != 0; }
+  uint32 size() const { return _numEntries; }
+
+  /* info->data is valid until the next call. */
+  boolean get(uint64 checksum, GHQTexInfo *info);
+
+  /* textures maps checksums to texture info and stored data size */
+  static boolean write(const wchar_t *filename, uint32 config, const Textures &textures);
+
+private:
+  TxHiResPack(const TxHiResPack &);
+  const Entry * _find(uint64 checksum) const;
+  const uint8 * _load(const Entry *entry);
+  uint8 * _allocDecoded(uint64 checksum, uint32 size);
+
+  uint32 _numEntries;
+  const Entry *_index;
+
+  /* memory mapped file */
+  const uint8 *_map;
+  uint64 _mapSize;
+#ifdef OS_WINDOWS
+  void *_file;
+  void *_mapping;
+#endif
+
+  /* file and index used where the file cannot be mapped */
+  FILE *_fp;
+  std::vector<Entry> _indexBuf;
+
+  /* most recently used decoded textures, bounded by _maxDecodedSize */
+  struct Decoded {
+    std::vector<uint8> data;
+    std::list<uint64>::iterator it;
+  };
+  std::map<uint64, Decoded> _decoded;
+  std::list<uint64> _decodedList;
+  uint32 _decodedSize;
+  uint32 _maxDecodedSize;
+};
+
+#endif /* __TXHIRESPACK_H__ */
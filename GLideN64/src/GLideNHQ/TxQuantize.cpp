@@ -27,16 +27,12 @@
 
 /* NOTE: The codes are not optimized. They can be made faster. */
 
-#include <functional>
-#include <thread>
-
 #include <convert.h>
 #include "TxQuantize.h"
+#include "TxThreadPool.h"
 
 TxQuantize::TxQuantize()
 {
-	/* get number of CPU cores. */
-	_numcore = TxUtil::getNumberofProcessors();
 }
 
 
@@ -811,10 +807,24 @@ TxQuantize::P8_16BPP(uint32* src, uint32* dest, int width, int height, uint32* p
 	}
 }
 
+void
+TxQuantize::_quantizeBands(quantizerFunc quantizer, uint8* src, uint8* dest, int width, int height, int srcShift, int destShift)
+{
+	TxThreadPool *pool = TxThreadPool::getInstance();
+	uint32 blkheight;
+	const uint32 numBands = pool->getBands(height, blkheight);
+	const unsigned int srcStride = (width * blkheight) << srcShift;
+	const unsigned int destStride = (width * blkheight) << destShift;
+
+	pool->parallelFor(numBands, [&](uint32 band, uint32) {
+		const int rows = band + 1 < numBands ? blkheight : height - blkheight * band;
+		(this->*quantizer)((uint32*)(src + srcStride * band), (uint32*)(dest + destStride * band), width, rows);
+	});
+}
+
 boolean
 TxQuantize::quantize(uint8* src, uint8* dest, int width, int height, uint16 srcformat, uint16 destformat, boolean fastQuantizer)
 {
-	typedef void (TxQuantize::*quantizerFunc)(uint32* src, uint32* dest, int width, int height);
 	quantizerFunc quantizer;
 	int bpp_shift = 0;
 
@@ -836,47 +846,7 @@ TxQuantize::quantize(uint8* src, uint8* dest, int width, int height, uint16 srcf
 		return 0;
 		}
 
-		unsigned int numcore = _numcore;
-		unsigned int blkrow = 0;
-		while (numcore > 1 && blkrow == 0) {
-			blkrow = (height >> 2) / numcore;
-			numcore--;
-		}
-		if (blkrow > 0 && numcore > 1) {
-#ifndef HAVE_LIBNX
-			std::thread *thrd[MAX_NUMCORE];
-#endif
-			unsigned int i;
-			int blkheight = blkrow << 2;
-			unsigned int srcStride = (width * blkheight) << (2 - bpp_shift);
-			unsigned int destStride = srcStride << bpp_shift;
-			for (i = 0; i < numcore - 1; i++) {
-#ifndef HAVE_LIBNX
-				thrd[i] = new std::thread(std::bind(quantizer,
-														this,
-														(uint32*)src,
-														(uint32*)dest,
-														width,
-														blkheight));
-#endif
-				src  += srcStride;
-				dest += destStride;
-			}
-#ifndef HAVE_LIBNX
-			thrd[i] = new std::thread(std::bind(quantizer,
-													this,
-													(uint32*)src,
-													(uint32*)dest,
-													width,
-													height - blkheight * i));
-			for (i = 0; i < numcore; i++) {
-				thrd[i]->join();
-				delete thrd[i];
-			}
-#endif
-		} else {
-			(*this.*quantizer)((uint32*)src, (uint32*)dest, width, height);
-		}
+		_quantizeBands(quantizer, src, dest, width, height, 2 - bpp_shift, 2);
 
 	} else if (srcformat == GL_RGBA8 || srcformat == GL_RGBA) {
 		switch (destformat) {
@@ -896,47 +866,7 @@ TxQuantize::quantize(uint8* src, uint8* dest, int width, int height, uint16 srcf
 		return 0;
 		}
 
-		unsigned int numcore = _numcore;
-		unsigned int blkrow = 0;
-		while (numcore > 1 && blkrow == 0) {
-			blkrow = (height >> 2) / numcore;
-			numcore--;
-		}
-		if (blkrow > 0 && numcore > 1) {
-#ifndef HAVE_LIBNX
-			std::thread *thrd[MAX_NUMCORE];
-#endif
-			unsigned int i;
-			int blkheight = blkrow << 2;
-			unsigned int srcStride = (width * blkheight) << 2;
-			unsigned int destStride = srcStride >> bpp_shift;
-			for (i = 0; i < numcore - 1; i++) {
-#ifndef HAVE_LIBNX
-				thrd[i] = new std::thread(std::bind(quantizer,
-														this,
-														(uint32*)src,
-														(uint32*)dest,
-														width,
-														blkheight));
-#endif
-				src  += srcStride;
-				dest += destStride;
-			}
-#ifndef HAVE_LIBNX
-            thrd[i] = new std::thread(std::bind(quantizer,
-													this,
-													(uint32*)src,
-													(uint32*)dest,
-													width,
-													height - blkheight * i));
-			for (i = 0; i < numcore; i++) {
-				thrd[i]->join();
-				delete thrd[i];
-			}
-#endif
-		} else {
-			(*this.*quantizer)((uint32*)src, (uint32*)dest, width, height);
-		}
+		_quantizeBands(quantizer, src, dest, width, height, 2, 2 - bpp_shift);
 
 	} else {
 		return 0;
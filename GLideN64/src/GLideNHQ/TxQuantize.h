@@ -30,7 +30,10 @@
 class TxQuantize
 {
 private:
-  int _numcore;
+  typedef void (TxQuantize::*quantizerFunc)(uint32* src, uint32* dst, int width, int height);
+
+  /* runs the quantizer over bands of rows on the texture worker threads */
+  void _quantizeBands(quantizerFunc quantizer, uint8* src, uint8* dest, int width, int height, int srcShift, int destShift);
 
   /* fast optimized... well, sort of. */
   void ARGB1555_ARGB8888(uint32* src, uint32* dst, int width, int height);
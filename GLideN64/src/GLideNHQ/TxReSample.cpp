@@ -23,6 +23,7 @@
 
 #include "TxReSample.h"
 #include "TxDbg.h"
+#include "TxThreadPool.h"
 #include <stdlib.h>
 #include <memory.h>
 
@@ -239,74 +240,34 @@ TxReSample::kaiser(double x)
 	return sinc(x) * besselI0(alpha * sqrt(1 - ratio * ratio)) / besselI0(alpha);
 }
 
-boolean
-TxReSample::minify(uint8 **src, int *width, int *height, int ratio)
+void
+TxReSample::_minifyRows(const uint32 *src, int width, int height, int ratio, const double *weight,
+						uint32 *workbuf, uint32 *dest, int tmpwidth, int firstRow, int lastRow)
 {
-	/* NOTE: src must be ARGB8888, ratio is the inverse representation */
-
-	if (!*src || ratio < 2) return 0;
-
-	/* Image Resampling */
-
-	/* half width of filter window.
-   * NOTE: must be 1.0 or larger.
-   *
-   * kaiser-bessel 5, lanczos3 3, mitchell 2, gaussian 1.5, tent 1
-   */
-	double half_window = 5.0;
+	const double half_window = 5.0;
 
 	int x, y, x2, y2, z;
 	double A, R, G, B;
 	uint32 texel;
 
-	int tmpwidth = *width / ratio;
-	int tmpheight = *height / ratio;
-
-	/* resampled destination */
-	uint8 *tmptex = (uint8*)malloc((tmpwidth * tmpheight) << 2);
-	if (!tmptex) return 0;
-
-	/* work buffer. single row */
-	uint8 *workbuf = (uint8*)malloc(*width << 2);
-	if (!workbuf) {
-		free(tmptex);
-		return 0;
-	}
-
-	/* prepare filter lookup table. only half width required for symetric filters. */
-	double *weight = (double*)malloc((int)((half_window * ratio) * sizeof(double)));
-	if (!weight) {
-		free(tmptex);
-		free(workbuf);
-		return 0;
-	}
-	for (x = 0; x < half_window * ratio; x++) {
-		//weight[x] = tent((double)x / ratio) / ratio;
-		//weight[x] = gaussian((double)x / ratio) / ratio;
-		//weight[x] = lanczos3((double)x / ratio) / ratio;
-		//weight[x] = mitchell((double)x / ratio) / ratio;
-		weight[x] = kaiser((double)x / ratio) / ratio;
-	}
-
-	/* linear convolution */
-	for (y = 0; y < tmpheight; y++) {
-		for (x = 0; x < *width; x++) {
-			texel = ((uint32*)*src)[y * ratio * *width + x];
+	for (y = firstRow; y < lastRow; y++) {
+		for (x = 0; x < width; x++) {
+			texel = src[y * ratio * width + x];
 			A = (double)(texel >> 24) * weight[0];
 			R = (double)((texel >> 16) & 0xff) * weight[0];
 			G = (double)((texel >>  8) & 0xff) * weight[0];
 			B = (double)((texel      ) & 0xff) * weight[0];
 			for (y2 = 1; y2 < half_window * ratio; y2++) {
 				z = y * ratio + y2;
-				if (z >= *height) z = *height - 1;
-				texel = ((uint32*)*src)[z * *width + x];
+				if (z >= height) z = height - 1;
+				texel = src[z * width + x];
 				A += (double)(texel >> 24) * weight[y2];
 				R += (double)((texel >> 16) & 0xff) * weight[y2];
 				G += (double)((texel >>  8) & 0xff) * weight[y2];
 				B += (double)((texel      ) & 0xff) * weight[y2];
 				z = y * ratio - y2;
 				if (z < 0) z = 0;
-				texel = ((uint32*)*src)[z * *width + x];
+				texel = src[z * width + x];
 				A += (double)(texel >> 24) * weight[y2];
 				R += (double)((texel >> 16) & 0xff) * weight[y2];
 				G += (double)((texel >>  8) & 0xff) * weight[y2];
@@ -316,25 +277,25 @@ TxReSample::minify(uint8 **src, int *width, int *height, int ratio)
 			if (R < 0) R = 0; else if (R > 255) R = 255;
 			if (G < 0) G = 0; else if (G > 255) G = 255;
 			if (B < 0) B = 0; else if (B > 255) B = 255;
-			((uint32*)workbuf)[x] = (((uint32)A << 24) | ((uint32)R << 16) | ((uint32)G << 8) | (uint32)B);
+			workbuf[x] = (((uint32)A << 24) | ((uint32)R << 16) | ((uint32)G << 8) | (uint32)B);
 		}
 		for (x = 0; x < tmpwidth; x++) {
-			texel = ((uint32*)workbuf)[x * ratio];
+			texel = workbuf[x * ratio];
 			A = (double)(texel >> 24) * weight[0];
 			R = (double)((texel >> 16) & 0xff) * weight[0];
 			G = (double)((texel >>  8) & 0xff) * weight[0];
 			B = (double)((texel      ) & 0xff) * weight[0];
 			for (x2 = 1; x2 < half_window * ratio; x2++) {
 				z = x * ratio + x2;
-				if (z >= *width) z = *width - 1;
-				texel = ((uint32*)workbuf)[z];
+				if (z >= width) z = width - 1;
+				texel = workbuf[z];
 				A += (double)(texel >> 24) * weight[x2];
 				R += (double)((texel >> 16) & 0xff) * weight[x2];
 				G += (double)((texel >>  8) & 0xff) * weight[x2];
 				B += (double)((texel      ) & 0xff) * weight[x2];
 				z = x * ratio - x2;
 				if (z < 0) z = 0;
-				texel = ((uint32*)workbuf)[z];
+				texel = workbuf[z];
 				A += (double)(texel >> 24) * weight[x2];
 				R += (double)((texel >> 16) & 0xff) * weight[x2];
 				G += (double)((texel >>  8) & 0xff) * weight[x2];
@@ -344,9 +305,70 @@ TxReSample::minify(uint8 **src, int *width, int *height, int ratio)
 			if (R < 0) R = 0; else if (R > 255) R = 255;
 			if (G < 0) G = 0; else if (G > 255) G = 255;
 			if (B < 0) B = 0; else if (B > 255) B = 255;
-			((uint32*)tmptex)[y * tmpwidth + x] = (((uint32)A << 24) | ((uint32)R << 16) | ((uint32)G << 8) | (uint32)B);
+			dest[y * tmpwidth + x] = (((uint32)A << 24) | ((uint32)R << 16) | ((uint32)G << 8) | (uint32)B);
 		}
 	}
+}
+
+boolean
+TxReSample::minify(uint8 **src, int *width, int *height, int ratio)
+{
+	/* NOTE: src must be ARGB8888, ratio is the inverse representation */
+
+	if (!*src || ratio < 2) return 0;
+
+	/* Image Resampling */
+
+	/* half width of filter window.
+   * NOTE: must be 1.0 or larger.
+   *
+   * kaiser-bessel 5, lanczos3 3, mitchell 2, gaussian 1.5, tent 1
+   */
+	double half_window = 5.0;
+
+	int x;
+
+	int tmpwidth = *width / ratio;
+	int tmpheight = *height / ratio;
+
+	/* resampled destination */
+	uint8 *tmptex = (uint8*)malloc((tmpwidth * tmpheight) << 2);
+	if (!tmptex) return 0;
+
+	/* work buffer. single row per thread */
+	uint8 *workbuf = (uint8*)malloc((*width * TxThreadPool::getInstance()->getNumThreads()) << 2);
+	if (!workbuf) {
+		free(tmptex);
+		return 0;
+	}
+
+	/* prepare filter lookup table. only half width required for symetric filters. */
+	double *weight = (double*)malloc((int)((half_window * ratio) * sizeof(double)));
+	if (!weight) {
+		free(tmptex);
+		free(workbuf);
+		return 0;
+	}
+	for (x = 0; x < half_window * ratio; x++) {
+		//weight[x] = tent((double)x / ratio) / ratio;
+		//weight[x] = gaussian((double)x / ratio) / ratio;
+		//weight[x] = lanczos3((double)x / ratio) / ratio;
+		//weight[x] = mitchell((double)x / ratio) / ratio;
+		weight[x] = kaiser((double)x / ratio) / ratio;
+	}
+
+	/* linear convolution. output rows are independent, so bands of them run in parallel */
+	TxThreadPool *pool = TxThreadPool::getInstance();
+	int numBands = (int)pool->getNumThreads();
+	if (numBands > tmpheight)
+		numBands = tmpheight > 0 ? tmpheight : 1;
+	const int bandHeight = tmpheight / numBands;
+	pool->parallelFor(numBands, [&](uint32 band, uint32 threadIdx) {
+		const int first = band * bandHeight;
+		const int last = (int)band + 1 < numBands ? first + bandHeight : tmpheight;
+		_minifyRows((uint32*)*src, *width, *height, ratio, weight, (uint32*)workbuf + threadIdx * *width,
+					(uint32*)tmptex, tmpwidth, first, last);
+	});
 
 	free(*src);
 	*src = tmptex;
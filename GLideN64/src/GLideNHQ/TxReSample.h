@@ -36,6 +36,8 @@ private:
   double mitchell(double x);
   double besselI0(double x);
   double kaiser(double x);
+  void _minifyRows(const uint32 *src, int width, int height, int ratio, const double *weight,
+                   uint32 *workbuf, uint32 *dest, int tmpwidth, int firstRow, int lastRow);
 public:
   boolean minify(uint8 **src, int *width, int *height, int ratio);
   boolean nextPow2(uint8** image, int* width, int* height, int bpp, boolean use_3dfx);
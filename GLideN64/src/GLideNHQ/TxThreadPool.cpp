@@ -0,0 +1,228 @@
+/*
+ * Texture Filtering
+ * Version:  1.0
+ *
+ * this is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * this is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Make; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "TxThreadPool.h"
+#include "TxDbg.h"
+
+uint32
+TxThreadPool::getBands(uint32 height, uint32 & bandHeight) const
+{
+	const uint32 numBands = std::min(getNumThreads(), height >> 2);
+	if (numBands < 2) {
+		bandHeight = height;
+		return 1;
+	}
+
+	bandHeight = ((height >> 2) / numBands) << 2;
+	return numBands;
+}
+
+#ifndef HAVE_LIBNX
+
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define TX_THREAD_LOCAL __declspec(thread)
+#else
+#define TX_THREAD_LOCAL thread_local
+#endif
+
+/* 0 for threads outside of the pool, worker number otherwise */
+static TX_THREAD_LOCAL uint32 threadIndex = 0;
+
+struct TxThreadPool::Bands
+{
+	Bands(uint32 num, const BandFunc & f) : numBands(num), func(f), next(0), done(0) {}
+
+	const uint32 numBands;
+	const BandFunc func;
+	std::atomic<uint32> next;
+	uint32 done;
+	std::mutex mutex;
+	std::condition_variable finished;
+};
+
+TxThreadPool::TxThreadPool() : _numWorkers(0), _stopping(false)
+{
+}
+
+uint32
+TxThreadPool::getThreadIndex() const
+{
+	return threadIndex;
+}
+
+TxThreadPool::~TxThreadPool()
+{
+	stop();
+}
+
+void
+TxThreadPool::start(uint32 numThreads)
+{
+	if (_numWorkers != 0 || numThreads < 2)
+		return;
+
+	_numWorkers = numThreads - 1;
+	_workers.reserve(_numWorkers);
+	for (uint32 i = 1; i <= _numWorkers; i++)
+		_workers.emplace_back(&TxThreadPool::_workerLoop, this, i);
+
+	DBG_INFO(80, wst("Texture worker threads : %d\n"), _numWorkers);
+}
+
+void
+TxThreadPool::stop()
+{
+	if (_workers.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_jobAvailable.notify_all();
+
+	/* workers finish the queued jobs before they exit */
+	for (auto & worker : _workers)
+		worker.join();
+
+	_workers.clear();
+	_numWorkers = 0;
+	_stopping = false;
+}
+
+void
+TxThreadPool::_workerLoop(uint32 threadIdx)
+{
+	threadIndex = threadIdx;
+
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_jobAvailable.wait(lock, [this]{ return _stopping || !_jobs.empty(); });
+			if (_jobs.empty())
+				return;
+			job = std::move(_jobs.front());
+			_jobs.pop_front();
+		}
+		job();
+	}
+}
+
+void
+TxThreadPool::_runBands(Bands & bands, uint32 threadIdx)
+{
+	while (true) {
+		const uint32 band = bands.next++;
+		if (band >= bands.numBands)
+			return;
+
+		bands.func(band, threadIdx);
+
+		std::lock_guard<std::mutex> lock(bands.mutex);
+		if (++bands.done == bands.numBands)
+			bands.finished.notify_one();
+	}
+}
+
+void
+TxThreadPool::parallelFor(uint32 numBands, const BandFunc & func)
+{
+	const uint32 threadIdx = threadIndex;
+
+	if (numBands < 2 || _numWorkers == 0) {
+		for (uint32 band = 0; band < numBands; band++)
+			func(band, threadIdx);
+		return;
+	}
+
+	/* helpers may start after the caller took all bands, so they share the state */
+	std::shared_ptr<Bands> bands = std::make_shared<Bands>(numBands, func);
+	const uint32 numHelpers = std::min(numBands - 1, _numWorkers);
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (uint32 i = 0; i < numHelpers; i++)
+			_jobs.emplace_back([bands]{ _runBands(*bands, threadIndex); });
+	}
+	_jobAvailable.notify_all();
+
+	_runBands(*bands, threadIdx);
+
+	std::unique_lock<std::mutex> lock(bands->mutex);
+	bands->finished.wait(lock, [&bands]{ return bands->done == bands->numBands; });
+}
+
+bool
+TxThreadPool::post(std::function<void()> job)
+{
+	if (_numWorkers == 0)
+		return false;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_jobs.emplace_back(std::move(job));
+	}
+	_jobAvailable.notify_one();
+	return true;
+}
+
+#else /* HAVE_LIBNX */
+
+TxThreadPool::TxThreadPool() : _numWorkers(0)
+{
+}
+
+uint32
+TxThreadPool::getThreadIndex() const
+{
+	return 0;
+}
+
+TxThreadPool::~TxThreadPool()
+{
+}
+
+void
+TxThreadPool::start(uint32 numThreads)
+{
+}
+
+void
+TxThreadPool::stop()
+{
+}
+
+void
+TxThreadPool::parallelFor(uint32 numBands, const BandFunc & func)
+{
+	for (uint32 band = 0; band < numBands; band++)
+		func(band, 0);
+}
+
+bool
+TxThreadPool::post(std::function<void()> job)
+{
+	return false;
+}
+
+#endif /* HAVE_LIBNX */
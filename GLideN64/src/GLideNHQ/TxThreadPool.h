@@ -0,0 +1,96 @@
+/*
+ * Texture Filtering
+ * Version:  1.0
+ *
+ * this is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * this is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Make; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __TXTHREADPOOL_H__
+#define __TXTHREADPOOL_H__
+
+#include "TxInternal.h"
+
+#include <functional>
+#include <deque>
+#include <vector>
+#ifndef HAVE_LIBNX
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+/* Worker threads shared by the texture filters, format conversions and
+ * resampling. The threads live as long as the filter, so enhancing a
+ * texture does not pay for creating and joining threads.
+ */
+class TxThreadPool
+{
+public:
+	typedef std::function<void(uint32 band, uint32 threadIdx)> BandFunc;
+
+	static TxThreadPool* getInstance() {
+		static TxThreadPool txThreadPool;
+		return &txThreadPool;
+	}
+	~TxThreadPool();
+
+	/* numThreads counts the calling thread, so numThreads - 1 workers are started. */
+	void start(uint32 numThreads);
+	void stop();
+
+	/* Number of threads which may run bands at once.
+	 * Thread indices passed to band functions are below that number.
+	 */
+	uint32 getNumThreads() const { return _numWorkers + 1; }
+	uint32 getNumWorkers() const { return _numWorkers; }
+
+	/* Index of the calling thread: 0 outside of the pool, the worker number on a worker. */
+	uint32 getThreadIndex() const;
+
+	/* Splits height rows into bands of whole 4-row blocks, at most one band per thread.
+	 * Every band but the last has bandHeight rows, the last one takes the remaining rows.
+	 * Returns the number of bands.
+	 */
+	uint32 getBands(uint32 height, uint32 & bandHeight) const;
+
+	/* Runs func for every band in [0, numBands) and returns when all of them are done.
+	 * The calling thread runs bands too, and idle workers take the bands nobody took yet,
+	 * so a band of work never waits for a busy worker.
+	 */
+	void parallelFor(uint32 numBands, const BandFunc & func);
+
+	/* Runs job on a worker. Returns false if there are no workers. */
+	bool post(std::function<void()> job);
+
+private:
+	TxThreadPool();
+	TxThreadPool(const TxThreadPool &);
+
+	uint32 _numWorkers;
+
+#ifndef HAVE_LIBNX
+	struct Bands;
+	static void _runBands(Bands & bands, uint32 threadIdx);
+	void _workerLoop(uint32 threadIdx);
+
+	std::vector<std::thread> _workers;
+	std::deque< std::function<void()> > _jobs;
+	std::mutex _mutex;
+	std::condition_variable _jobAvailable;
+	bool _stopping;
+#endif
+};
+
+#endif /* __TXTHREADPOOL_H__ */
@@ -23,6 +23,7 @@
 
 #include "TxUtil.h"
 #include "TxDbg.h"
+#include "TxThreadPool.h"
 #include <zlib.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -562,8 +563,8 @@ TxMemBuf::init(int maxwidth, int maxheight)
 		}
 
 		if (_bufs.empty()) {
-			const int numcore = TxUtil::getNumberofProcessors();
-			const size_t numBuffers = numcore*2;
+			/* two buffers for every thread which may run filter bands */
+			const size_t numBuffers = TxThreadPool::getInstance()->getNumThreads() * 2;
 			_bufs.resize(numBuffers);
 		}
 	} catch(std::bad_alloc) {
@@ -584,9 +585,8 @@ TxMemBuf::shutdown()
 		_size[i] = 0;
 	}
 
-	for (auto i: _bufs) {
-		i.clear();
-	}
+	/* the number of threads may differ on the next init */
+	_bufs.clear();
 }
 
 uint8*
@@ -31,6 +31,8 @@
 
 /* extension for cache files */
 #define TEXCACHE_EXT wst("htc")
+/* extension for indexed hires texture packs */
+#define TEXPACK_EXT wst("hts")
 
 #include <vector>
 
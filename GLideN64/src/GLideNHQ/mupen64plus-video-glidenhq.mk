@@ -27,10 +27,12 @@ LOCAL_SRC_FILES :=                          \
     $(SRCDIR)/TxFilter.cpp                  \
     $(SRCDIR)/TxFilterExport.cpp            \
     $(SRCDIR)/TxHiResCache.cpp              \
+    $(SRCDIR)/TxHiResPack.cpp               \
     $(SRCDIR)/TxImage.cpp                   \
     $(SRCDIR)/TxQuantize.cpp                \
     $(SRCDIR)/TxReSample.cpp                \
     $(SRCDIR)/TxTexCache.cpp                \
+    $(SRCDIR)/TxThreadPool.cpp              \
     $(SRCDIR)/TxUtil.cpp                    \
     $(SRCDIR)/txWidestringWrapper.cpp       \
 
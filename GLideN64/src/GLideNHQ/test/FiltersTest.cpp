@@ -0,0 +1,313 @@
+// Golden-image test of the 32bpp texture enhancers and filters of filter_8888.
+//
+//   test_filters [--threads N]... GOLDEN     compares with the golden file, exits with 1 on mismatches
+//   test_filters --write GOLDEN              writes the golden file from this build
+//   test_filters --dump DIR GOLDEN           also writes the differing outputs to DIR as PAM images
+//
+// Every enhancement and filter, with and without deposterize, runs on a fixed corpus
+// of N64 sized textures: noise, palette blocks, gradients with alpha and sprites on a
+// transparent background. The golden file holds a hash of every output. The outputs
+// must be byte-identical, whatever the number of texture threads (1, 3 and 8 unless
+// --threads is given) and whatever the SIMD path of TextureFilters_simd.h.
+//
+// filters_golden.txt was written by the plain C filters as they were before the SIMD
+// edge detection and the row bands, run on one thread. Write it again only after a
+// deliberate change of a filter's output.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../TextureFilters.h"
+#include "../TxThreadPool.h"
+#include "../TxUtil.h"
+
+namespace {
+
+const uint32 guardSize = 64;
+const uint32 guardValue = 0xDEADBEEF;
+
+struct Filter {
+	const char * name;
+	uint32 mode;
+	uint32 scale;
+};
+
+const Filter filters[] = {
+	{ "2x", X2_ENHANCEMENT, 2 },
+	{ "2xsai", X2SAI_ENHANCEMENT, 2 },
+	{ "hq2x", HQ2X_ENHANCEMENT, 2 },
+	{ "lq2x", LQ2X_ENHANCEMENT, 2 },
+	{ "hq4x", HQ4X_ENHANCEMENT, 4 },
+	{ "hq2xs", HQ2XS_ENHANCEMENT, 2 },
+	{ "lq2xs", LQ2XS_ENHANCEMENT, 2 },
+	{ "xbrz2", BRZ2X_ENHANCEMENT, 2 },
+	{ "xbrz3", BRZ3X_ENHANCEMENT, 3 },
+	{ "xbrz4", BRZ4X_ENHANCEMENT, 4 },
+	{ "xbrz5", BRZ5X_ENHANCEMENT, 5 },
+	{ "xbrz6", BRZ6X_ENHANCEMENT, 6 },
+	{ "smooth1", SMOOTH_FILTER_1, 1 },
+	{ "smooth2", SMOOTH_FILTER_2, 1 },
+	{ "smooth3", SMOOTH_FILTER_3, 1 },
+	{ "smooth4", SMOOTH_FILTER_4, 1 },
+	{ "sharp1", SHARP_FILTER_1, 1 },
+	{ "sharp2", SHARP_FILTER_2, 1 },
+};
+
+// Heights of three rows and more; the old code read past one and two row images.
+const struct {
+	uint32 width, height;
+} sizes[] = {
+	{ 4, 4 }, { 8, 3 }, { 13, 7 }, { 16, 16 }, { 32, 8 }, { 64, 32 }, { 100, 75 }, { 128, 128 }, { 256, 64 },
+};
+
+const char * patterns[] = { "noise", "palette", "gradient", "sprite" };
+
+uint32 nextRandom(uint32 & _seed)
+{
+	_seed = _seed * 1103515245 + 12345;
+	return _seed;
+}
+
+uint32 makePixel(uint32 _pattern, uint32 _x, uint32 _y, uint32 _width, uint32 _height, uint32 & _seed)
+{
+	static const uint32 palette[] = {
+		0xFF000000, 0xFFFFFFFF, 0xFF2040C0, 0xFFC04020, 0xFF20C040, 0x80808080, 0xFFE0E000, 0x00000000
+	};
+	switch (_pattern) {
+	case 0:
+		return nextRandom(_seed) ^ (nextRandom(_seed) >> 16);
+	case 1:
+		return palette[((_x >> 2) * 3 + (_y >> 2) * 5 + ((_x ^ _y) >> 3)) & 7];
+	case 2:
+	{
+		const uint32 r = _x * 255 / _width;
+		const uint32 g = _y * 255 / _height;
+		const uint32 b = (_x + _y) * 127 / (_width + _height);
+		const uint32 a = 255 - ((_x * _y) & 0xFF);
+		return (a << 24) | (b << 16) | (g << 8) | r;
+	}
+	default:
+	{
+		// a ring and a diagonal line of a few colors, as in fonts and sprites
+		const int dx = int(_x) - int(_width / 2);
+		const int dy = int(_y) - int(_height / 2);
+		const int r2 = dx * dx + dy * dy;
+		const int radius = int(std::min(_width, _height) / 3);
+		if (r2 >= (radius - 1) * (radius - 1) && r2 <= (radius + 1) * (radius + 1))
+			return 0xFF20E0FF;
+		if (_x * _height / _width == _y)
+			return 0xFF1010A0;
+		return 0x00000000;
+	}
+	}
+}
+
+std::vector<uint32> makeTexture(uint32 _pattern, uint32 _width, uint32 _height)
+{
+	std::vector<uint32> tex(_width * _height);
+	uint32 seed = _pattern * 7919 + _width * 31 + _height;
+	for (uint32 y = 0; y < _height; ++y)
+		for (uint32 x = 0; x < _width; ++x)
+			tex[x + y * _width] = makePixel(_pattern, x, y, _width, _height, seed);
+	return tex;
+}
+
+unsigned long long hashBytes(const void * _data, size_t _size)
+{
+	// FNV-1a
+	const unsigned char * p = static_cast<const unsigned char*>(_data);
+	unsigned long long hash = 0xcbf29ce484222325ULL;
+	for (size_t i = 0; i < _size; ++i) {
+		hash ^= p[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+struct Case {
+	std::string name;
+	uint32 mode;
+	uint32 pattern;
+	uint32 width, height;
+	uint32 scale;
+};
+
+std::vector<Case> allCases()
+{
+	std::vector<Case> cases;
+	for (uint32 deposterize = 0; deposterize < 2; ++deposterize) {
+		for (const Filter & filter : filters) {
+			for (uint32 pattern = 0; pattern < sizeof(patterns) / sizeof(patterns[0]); ++pattern) {
+				for (const auto & size : sizes) {
+					Case c;
+					c.name = std::string(filter.name) + (deposterize ? "+depost" : "");
+					c.mode = filter.mode | (deposterize ? DEPOSTERIZE : 0);
+					c.pattern = pattern;
+					c.width = size.width;
+					c.height = size.height;
+					c.scale = filter.scale;
+					cases.push_back(c);
+				}
+			}
+		}
+	}
+	return cases;
+}
+
+// Returns false if the filter wrote past its output.
+bool runCase(const Case & _case, std::vector<uint32> & _out)
+{
+	std::vector<uint32> src = makeTexture(_case.pattern, _case.width, _case.height);
+	const size_t outSize = size_t(_case.width) * _case.height * _case.scale * _case.scale;
+	std::vector<uint32> dst(outSize + guardSize, guardValue);
+	filter_8888(src.data(), _case.width, _case.height, dst.data(), _case.mode);
+	for (uint32 i = 0; i < guardSize; ++i) {
+		if (dst[outSize + i] != guardValue)
+			return false;
+	}
+	_out.assign(dst.begin(), dst.begin() + outSize);
+	return true;
+}
+
+void writePam(const std::string & _path, const std::vector<uint32> & _pixels, uint32 _width, uint32 _height)
+{
+	FILE * f = fopen(_path.c_str(), "wb");
+	if (f == nullptr)
+		return;
+	fprintf(f, "P7\nWIDTH %u\nHEIGHT %u\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", _width, _height);
+	// the textures are ABGR in memory, R first
+	fwrite(_pixels.data(), 4, _pixels.size(), f);
+	fclose(f);
+}
+
+std::string caseKey(const Case & _case)
+{
+	char key[128];
+	sprintf(key, "%s %s %ux%u", _case.name.c_str(), patterns[_case.pattern], _case.width, _case.height);
+	return key;
+}
+
+void startThreads(uint32 _numThreads)
+{
+	TxThreadPool::getInstance()->start(_numThreads);
+	// deposterize takes its buffers from there, two for every thread
+	TxMemBuf::getInstance()->init(256, 256);
+}
+
+void stopThreads()
+{
+	TxMemBuf::getInstance()->shutdown();
+	TxThreadPool::getInstance()->stop();
+}
+
+int writeGolden(const char * _path)
+{
+	FILE * f = fopen(_path, "w");
+	if (f == nullptr) {
+		fprintf(stderr, "cannot write %s\n", _path);
+		return 1;
+	}
+	startThreads(1);
+	std::vector<uint32> out;
+	for (const Case & c : allCases()) {
+		if (!runCase(c, out)) {
+			fprintf(stderr, "%s: wrote past the output\n", caseKey(c).c_str());
+			fclose(f);
+			return 1;
+		}
+		fprintf(f, "%s %016llx\n", caseKey(c).c_str(), hashBytes(out.data(), out.size() * 4));
+	}
+	stopThreads();
+	fclose(f);
+	return 0;
+}
+
+int check(const char * _path, const std::vector<uint32> & _threads, const char * _dumpDir)
+{
+	FILE * f = fopen(_path, "r");
+	if (f == nullptr) {
+		fprintf(stderr, "cannot read %s\n", _path);
+		return 1;
+	}
+	std::vector<std::string> golden;
+	char line[256];
+	while (fgets(line, sizeof(line), f) != nullptr)
+		golden.push_back(line);
+	fclose(f);
+
+	const std::vector<Case> cases = allCases();
+	if (golden.size() != cases.size()) {
+		fprintf(stderr, "%s has %u outputs, the test makes %u\n", _path, unsigned(golden.size()), unsigned(cases.size()));
+		return 1;
+	}
+
+	int failures = 0;
+	std::vector<uint32> out;
+	for (uint32 numThreads : _threads) {
+		startThreads(numThreads);
+		int differ = 0;
+		for (size_t i = 0; i < cases.size(); ++i) {
+			const Case & c = cases[i];
+			const std::string key = caseKey(c);
+			bool ok = runCase(c, out);
+			if (!ok) {
+				fprintf(stderr, "%u threads, %s: wrote past the output\n", numThreads, key.c_str());
+			} else {
+				char expected[256];
+				sprintf(expected, "%s %016llx\n", key.c_str(), hashBytes(out.data(), out.size() * 4));
+				ok = golden[i] == expected;
+				if (!ok)
+					fprintf(stderr, "%u threads, %s: output differs from the golden image\n", numThreads, key.c_str());
+			}
+			if (!ok) {
+				++differ;
+				if (_dumpDir != nullptr && !out.empty()) {
+					std::string path = std::string(_dumpDir) + "/" + key + ".pam";
+					for (char & ch : path)
+						if (ch == ' ' || ch == '+')
+							ch = '_';
+					writePam(path, out, c.width * c.scale, c.height * c.scale);
+				}
+			}
+		}
+		stopThreads();
+		printf("%u threads: %d of %u outputs differ\n", numThreads, differ, unsigned(cases.size()));
+		failures += differ;
+	}
+	return failures != 0;
+}
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+	std::vector<uint32> threads;
+	const char * dumpDir = nullptr;
+	const char * writePath = nullptr;
+	const char * goldenPath = nullptr;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			threads.push_back(std::max(1, atoi(argv[++i])));
+		else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc)
+			dumpDir = argv[++i];
+		else if (strcmp(argv[i], "--write") == 0 && i + 1 < argc)
+			writePath = argv[++i];
+		else
+			goldenPath = argv[i];
+	}
+
+	if (writePath != nullptr)
+		return writeGolden(writePath);
+
+	if (goldenPath == nullptr) {
+		fprintf(stderr, "usage: %s [--threads N]... [--dump DIR] GOLDEN | --write GOLDEN\n", argv[0]);
+		return 2;
+	}
+	if (threads.empty())
+		threads = { 1, 3, 8 };
+	return check(goldenPath, threads, dumpDir);
+}
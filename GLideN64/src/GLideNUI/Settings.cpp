@@ -29,6 +29,8 @@ void _loadSettings(QSettings & settings)
 	config.video.cropMode = settings.value("cropMode", config.video.cropMode).toInt();
 	config.video.cropWidth = settings.value("cropWidth", config.video.cropWidth).toInt();
 	config.video.cropHeight = settings.value("cropHeight", config.video.cropHeight).toInt();
+	config.video.frameSkipMode = settings.value("frameSkipMode", config.video.frameSkipMode).toInt();
+	config.video.frameSkipCount = settings.value("frameSkipCount", config.video.frameSkipCount).toInt();
 	settings.endGroup();
 
 	settings.beginGroup("texture");
@@ -43,6 +45,7 @@ void _loadSettings(QSettings & settings)
 	config.generalEmulation.enableLOD = settings.value("enableLOD", config.generalEmulation.enableLOD).toInt();
 	config.generalEmulation.enableHWLighting = settings.value("enableHWLighting", config.generalEmulation.enableHWLighting).toInt();
 	config.generalEmulation.enableShadersStorage = settings.value("enableShadersStorage", config.generalEmulation.enableShadersStorage).toInt();
+	config.generalEmulation.enableAsyncShaderCompile = settings.value("enableAsyncShaderCompile", config.generalEmulation.enableAsyncShaderCompile).toInt();
 	config.generalEmulation.enableCustomSettings = settings.value("enableCustomSettings", config.generalEmulation.enableCustomSettings).toInt();
 	config.generalEmulation.correctTexrectCoords = settings.value("correctTexrectCoords", config.generalEmulation.correctTexrectCoords).toInt();
 	config.generalEmulation.enableNativeResTexrects = settings.value("enableNativeResTexrects", config.generalEmulation.enableNativeResTexrects).toInt();
@@ -69,6 +72,7 @@ void _loadSettings(QSettings & settings)
 	config.textureFilter.txEnhancementMode = settings.value("txEnhancementMode", config.textureFilter.txEnhancementMode).toInt();
 	config.textureFilter.txDeposterize = settings.value("txDeposterize", config.textureFilter.txDeposterize).toInt();
 	config.textureFilter.txFilterIgnoreBG = settings.value("txFilterIgnoreBG", config.textureFilter.txFilterIgnoreBG).toInt();
+	config.textureFilter.txAsyncFilter = settings.value("txAsyncFilter", config.textureFilter.txAsyncFilter).toInt();
 	config.textureFilter.txCacheSize = settings.value("txCacheSize", config.textureFilter.txCacheSize).toInt();
 	config.textureFilter.txHiresEnable = settings.value("txHiresEnable", config.textureFilter.txHiresEnable).toInt();
 	config.textureFilter.txHiresFullAlphaChannel = settings.value("txHiresFullAlphaChannel", config.textureFilter.txHiresFullAlphaChannel).toInt();
@@ -155,6 +159,8 @@ void writeSettings(const QString & _strIniFolder)
 	settings.setValue("cropMode", config.video.cropMode);
 	settings.setValue("cropWidth", config.video.cropWidth);
 	settings.setValue("cropHeight", config.video.cropHeight);
+	settings.setValue("frameSkipMode", config.video.frameSkipMode);
+	settings.setValue("frameSkipCount", config.video.frameSkipCount);
 	settings.endGroup();
 
 	settings.beginGroup("texture");
@@ -169,6 +175,7 @@ void writeSettings(const QString & _strIniFolder)
 	settings.setValue("enableLOD", config.generalEmulation.enableLOD);
 	settings.setValue("enableHWLighting", config.generalEmulation.enableHWLighting);
 	settings.setValue("enableShadersStorage", config.generalEmulation.enableShadersStorage);
+	settings.setValue("enableAsyncShaderCompile", config.generalEmulation.enableAsyncShaderCompile);
 	settings.setValue("enableCustomSettings", config.generalEmulation.enableCustomSettings);
 	settings.setValue("correctTexrectCoords", config.generalEmulation.correctTexrectCoords);
 	settings.setValue("enableNativeResTexrects", config.generalEmulation.enableNativeResTexrects);
@@ -194,6 +201,7 @@ void writeSettings(const QString & _strIniFolder)
 	settings.setValue("txEnhancementMode", config.textureFilter.txEnhancementMode);
 	settings.setValue("txDeposterize", config.textureFilter.txDeposterize);
 	settings.setValue("txFilterIgnoreBG", config.textureFilter.txFilterIgnoreBG);
+	settings.setValue("txAsyncFilter", config.textureFilter.txAsyncFilter);
 	settings.setValue("txCacheSize", config.textureFilter.txCacheSize);
 	settings.setValue("txHiresEnable", config.textureFilter.txHiresEnable);
 	settings.setValue("txHiresFullAlphaChannel", config.textureFilter.txHiresFullAlphaChannel);
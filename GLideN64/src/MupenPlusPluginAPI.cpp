@@ -44,4 +44,14 @@ EXPORT void CALL SetRenderingCallback(void (*callback)(int))
 	api().SetRenderingCallback(callback);
 }
 
+EXPORT unsigned int CALL SaveState(void *buffer, unsigned int size)
+{
+	return api().SaveState(buffer, size);
+}
+
+EXPORT int CALL LoadState(const void *buffer, unsigned int size)
+{
+	return api().LoadState(buffer, size);
+}
+
 } // extern "C"
@@ -20,6 +20,10 @@
 
 #define NOISE_TEX_NUM 30
 
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 using namespace std;
 
 static GLuint  g_vertex_shader_object;
@@ -284,15 +288,36 @@ ShaderCombiner::ShaderCombiner(Combiner & _color, Combiner & _alpha, const gDPCo
 	std::string strCombiner;
 	m_nInputs = compileCombiner(_combine, _color, _alpha, strCombiner);
 
-	const bool bUseLod = usesLOD();
-	const bool bUseHWLight = config.generalEmulation.enableHWLighting != 0 && GBI.isHWLSupported() && usesShadeColor();
-
-	if( bUseHWLight )
+	if (config.generalEmulation.enableHWLighting != 0 && GBI.isHWLSupported() && usesShadeColor())
 		m_nInputs |= 1 << HW_LIGHT;
 
+	_compile(strCombiner, false);
+}
+
+// The uber-shader reads every combiner input but LOD and HW lighting, so it can stand in for any combiner without them.
+// It keeps this input mask when it stands in for another combiner, as its program reads the inputs whatever the mux is.
+ShaderCombiner::ShaderCombiner(const std::string & _strUberCombiner) : m_key(~0ULL), m_nInputs(((1 << (ZERO + 1)) - 1) & ~(1 << LOD_FRACTION)), m_bNeedUpdate(true)
+{
+	_compile(_strUberCombiner, true);
+	finishCompile();
+}
+
+ShaderCombiner * ShaderCombiner::createUberShader()
+{
+	std::string strCombiner;
+	compileUberCombiner(strCombiner);
+	return new ShaderCombiner(strCombiner);
+}
+
+void ShaderCombiner::_compile(const std::string & _strCombiner, bool _bUberShader)
+{
+	const bool bUseLod = usesLOD();
+	const bool bUseHWLight = usesHwLighting();
+	const bool bBlendMux2Cycle = (_bUberShader || gDP.otherMode.cycleType == G_CYC_2CYCLE) && config.generalEmulation.enableLegacyBlending == 0;
+
 	if (usesTexture()) {
 		strFragmentShader.assign(fragment_shader_header_common_variables);
-		if (gDP.otherMode.cycleType == G_CYC_2CYCLE && config.generalEmulation.enableLegacyBlending == 0)
+		if (bBlendMux2Cycle)
 			strFragmentShader.append(fragment_shader_header_common_variables_blend_mux_2cycle);
 
 #ifdef GL_MULTISAMPLING_SUPPORT
@@ -325,7 +350,7 @@ ShaderCombiner::ShaderCombiner(Combiner & _color, Combiner & _alpha, const gDPCo
 
 	} else {
 		strFragmentShader.assign(fragment_shader_header_common_variables_notex);
-		if (gDP.otherMode.cycleType == G_CYC_2CYCLE && config.generalEmulation.enableLegacyBlending == 0)
+		if (bBlendMux2Cycle)
 			strFragmentShader.append(fragment_shader_header_common_variables_blend_mux_2cycle);
 		strFragmentShader.append(fragment_shader_header_noise);
 		strFragmentShader.append(fragment_shader_header_noise_dither);
@@ -341,6 +366,9 @@ ShaderCombiner::ShaderCombiner(Combiner & _color, Combiner & _alpha, const gDPCo
 	if (bUseHWLight)
 		strFragmentShader.append(fragment_shader_header_calc_light);
 
+	if (_bUberShader)
+		strFragmentShader.append(fragment_shader_header_uber_combiner);
+
 	strFragmentShader.append(fragment_shader_header_main);
 	if (config.generalEmulation.enableLegacyBlending == 0)
 		strFragmentShader.append(fragment_shader_blend_mux);
@@ -388,7 +416,7 @@ ShaderCombiner::ShaderCombiner(Combiner & _color, Combiner & _alpha, const gDPCo
 		strFragmentShader.append("  input_color = vShadeColor.rgb;\n");
 
 	strFragmentShader.append("  vec_color = vec4(input_color, vShadeColor.a); \n");
-	strFragmentShader.append(strCombiner);
+	strFragmentShader.append(_strCombiner);
 
 	if (video().getRender().isImageTexturesSupported() && config.frameBufferEmulation.N64DepthCompare != 0) {
 		strFragmentShader.append(
@@ -445,12 +473,13 @@ ShaderCombiner::ShaderCombiner(Combiner & _color, Combiner & _alpha, const gDPCo
 	}
 #endif // GLESX
 
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	// Compile and link status are only checked by finishCompile(), so that the driver
+	// may compile the program in the background.
+	m_fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
 	const GLchar * strShaderData = strFragmentShader.data();
-	glShaderSource(fragmentShader, 1, &strShaderData, nullptr);
-	glCompileShader(fragmentShader);
-	if (!checkShaderCompileStatus(fragmentShader))
-		logErrorShader(GL_FRAGMENT_SHADER, strFragmentShader);
+	glShaderSource(m_fragmentShader, 1, &strShaderData, nullptr);
+	glCompileShader(m_fragmentShader);
+	m_strFragmentShader = strFragmentShader;
 
 	m_program = glCreateProgram();
 	_locate_attributes();
@@ -458,7 +487,7 @@ ShaderCombiner::ShaderCombiner(Combiner & _color, Combiner & _alpha, const gDPCo
 		glAttachShader(m_program, g_vertex_shader_object);
 	else
 		glAttachShader(m_program, g_vertex_shader_object_notex);
-	glAttachShader(m_program, fragmentShader);
+	glAttachShader(m_program, m_fragmentShader);
 #ifndef GLESX
 	if (bUseHWLight)
 		glAttachShader(m_program, g_calc_light_shader_object);
@@ -485,11 +514,38 @@ ShaderCombiner::ShaderCombiner(Combiner & _color, Combiner & _alpha, const gDPCo
 	if (CombinerInfo::get().isShaderCacheSupported())
 		glProgramParameteri(m_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glLinkProgram(m_program);
+}
+
+bool ShaderCombiner::isCompileDone() const
+{
+	GLint status = GL_TRUE;
+	glGetProgramiv(m_program, GL_COMPLETION_STATUS_KHR, &status);
+	return status != GL_FALSE;
+}
+
+void ShaderCombiner::finishCompile()
+{
+	if (m_fragmentShader == 0)
+		return;
+	if (!checkShaderCompileStatus(m_fragmentShader))
+		logErrorShader(GL_FRAGMENT_SHADER, m_strFragmentShader);
 	assert(checkProgramLinkStatus(m_program));
-	glDeleteShader(fragmentShader);
+	glDeleteShader(m_fragmentShader);
+	m_fragmentShader = 0;
+	std::string().swap(m_strFragmentShader);
 	_locateUniforms();
 }
 
+void ShaderCombiner::setUberCombine(const ShaderCombiner & _combiner, const UberCombinerParams & _params)
+{
+	m_key = _combiner.m_key;
+	m_uniforms.uCmbColor0.set(_params.color[0][0], _params.color[0][1], _params.color[0][2], _params.color[0][3], false);
+	m_uniforms.uCmbColor1.set(_params.color[1][0], _params.color[1][1], _params.color[1][2], _params.color[1][3], false);
+	m_uniforms.uCmbAlpha0.set(_params.alpha[0][0], _params.alpha[0][1], _params.alpha[0][2], _params.alpha[0][3], false);
+	m_uniforms.uCmbAlpha1.set(_params.alpha[1][0], _params.alpha[1][1], _params.alpha[1][2], _params.alpha[1][3], false);
+	m_uniforms.uCmbMode.set(_params.mode[0], _params.mode[1], _params.mode[2], _params.mode[3], false);
+}
+
 ShaderCombiner::~ShaderCombiner() {
 	glDeleteProgram(m_program);
 	m_program = 0;
@@ -543,6 +599,12 @@ void ShaderCombiner::_locateUniforms() {
 	LocateUniform(uBlendMux1);
 	LocateUniform(uBlendMux2);
 
+	LocateUniform(uCmbColor0);
+	LocateUniform(uCmbColor1);
+	LocateUniform(uCmbAlpha0);
+	LocateUniform(uCmbAlpha1);
+	LocateUniform(uCmbMode);
+
 #ifdef GL_MULTISAMPLING_SUPPORT
 	LocateUniform(uMSTex0);
 	LocateUniform(uMSTex1);
@@ -262,6 +262,14 @@ static const char* fragment_shader_header_common_variables_blend_mux_2cycle =
 "uniform lowp int uForceBlendCycle2;	\n"
 ;
 
+static const char* fragment_shader_header_uber_combiner =
+"uniform lowp ivec4 uCmbColor0;	\n"
+"uniform lowp ivec4 uCmbColor1;	\n"
+"uniform lowp ivec4 uCmbAlpha0;	\n"
+"uniform lowp ivec4 uCmbAlpha1;	\n"
+"uniform lowp ivec4 uCmbMode;	\n"
+;
+
 static const char* fragment_shader_header_noise =
 	"lowp float snoise();\n";
 static const char* fragment_shader_header_write_depth =
@@ -22,6 +22,7 @@
 #include "Log.h"
 #include "TextDrawer.h"
 #include "Performance.h"
+#include "FrameSkipper.h"
 #include "PostProcessor.h"
 #include "ShaderUtils.h"
 #include "SoftwareRender.h"
@@ -174,11 +175,14 @@ void OGLVideo::restart()
 
 void OGLVideo::swapBuffers()
 {
-	m_render.drawOSD();
-	_swapBuffers();
+	if (!frameSkipper.isDropped()) {
+		m_render.drawOSD();
+		_swapBuffers();
+	}
 	gDP.otherMode.l = 0;
 	if ((config.generalEmulation.hacks & hack_doNotResetTLUTmode) == 0)
 		gDPSetTextureLUT(G_TT_NONE);
+	CombinerInfo::get().frameDone();
 	++m_buffersSwapCount;
 }
 
@@ -1226,6 +1230,8 @@ void OGLRender::_updateStates(RENDER_STATE _renderState) const
 	if (gSP.changed & CHANGED_HW_LIGHT)
 		cmbInfo.updateLightParameters();
 
+	textureCache().loadFilteredTextures();
+
 	if ((gSP.changed & CHANGED_TEXTURE) ||
 		(gDP.changed & (CHANGED_TILE|CHANGED_TMEM)) ||
 		cmbInfo.isChanged() ||
@@ -1398,6 +1404,12 @@ void OGLRender::drawScreenSpaceTriangle(u32 _numVtx)
 	if (_numVtx == 0 || !_canDraw())
 		return;
 
+	if (frameSkipper.isSkipped()) {
+		frameSkipper.skipDraw(_numVtx - 2);
+		frameBufferList().setBufferChanged();
+		return;
+	}
+
 	for (u32 i = 0; i < _numVtx; ++i) {
 		SPVertex & vtx = triangles.dmaVertices[i];
 		vtx.modify = MODIFY_ALL;
@@ -1420,12 +1432,16 @@ void OGLRender::drawDMATriangles(u32 _numVtx)
 {
 	if (_numVtx == 0 || !_canDraw())
 		return;
-	_prepareDrawTriangle(true);
-	if (use_vbo) {
-		updateBO(TRI_VBO, sizeof(SPVertex), _numVtx, triangles.dmaVertices.data());
-		glDrawArrays(GL_TRIANGLES, bo_offset[TRI_VBO] - _numVtx, _numVtx);
-	} else
-		glDrawArrays(GL_TRIANGLES, 0, _numVtx);
+	if (frameSkipper.isSkipped())
+		frameSkipper.skipDraw(_numVtx / 3);
+	else {
+		_prepareDrawTriangle(true);
+		if (use_vbo) {
+			updateBO(TRI_VBO, sizeof(SPVertex), _numVtx, triangles.dmaVertices.data());
+			glDrawArrays(GL_TRIANGLES, bo_offset[TRI_VBO] - _numVtx, _numVtx);
+		} else
+			glDrawArrays(GL_TRIANGLES, 0, _numVtx);
+	}
 	if (config.frameBufferEmulation.enable != 0 &&
 		config.frameBufferEmulation.copyDepthToRDRAM == Config::cdSoftwareRender &&
 		gDP.otherMode.depthUpdate != 0) {
@@ -1443,10 +1459,13 @@ void OGLRender::drawTriangles()
 		return;
 	}
 
-	_prepareDrawTriangle(false);
-	if (!use_vbo)
+	if (frameSkipper.isSkipped())
+		frameSkipper.skipDraw(triangles.num / 3);
+	else if (!use_vbo) {
+		_prepareDrawTriangle(false);
 		glDrawElements(GL_TRIANGLES, triangles.num, GL_UNSIGNED_BYTE, triangles.elements);
-	else {
+	} else {
+		_prepareDrawTriangle(false);
 		SPVertex* temp_verts = (SPVertex*)mapBO(TRI_VBO, VERTBUFF_SIZE * sizeof(SPVertex));;
 		GLubyte* temp_elements = (GLubyte*)mapBO(IBO, ELEMBUFF_SIZE * sizeof(GLubyte));;
 		u32 i, p;
@@ -1562,6 +1581,11 @@ void OGLRender::drawLine(int _v0, int _v1, float _width)
 	if (!_canDraw())
 		return;
 
+	if (frameSkipper.isSkipped()) {
+		frameSkipper.skipDraw(2);
+		return;
+	}
+
 	GLfloat lineWidth = _width;
 	if (config.frameBufferEmulation.nativeResFactor == 0)
 		lineWidth *= video().getScaleX();
@@ -1620,6 +1644,10 @@ void OGLRender::drawRect(int _ulx, int _uly, int _lrx, int _lry, float *_pColor)
 	m_texrectDrawer.draw();
 	if (!_canDraw())
 		return;
+	if (frameSkipper.isSkipped()) {
+		frameSkipper.skipDraw(2);
+		return;
+	}
 	gSP.changed &= ~CHANGED_GEOMETRYMODE; // Don't update cull mode
 	if (gSP.changed || gDP.changed)
 		_updateStates(rsRect);
@@ -1852,6 +1880,16 @@ bool(*texturedRectSpecial)(const OGLRender::TexturedRectParams & _params) = null
 
 void OGLRender::drawTexturedRect(const TexturedRectParams & _params)
 {
+	if (frameSkipper.isSkipped()) {
+		m_texrectDrawer.draw();
+		// Special processing may write to RDRAM, it is done anyway
+		if (_params.texrectCmd && texturedRectSpecial != nullptr && texturedRectSpecial(_params))
+			return;
+		if (_canDraw())
+			frameSkipper.skipDraw(2);
+		return;
+	}
+
 	gSP.changed &= ~CHANGED_GEOMETRYMODE; // Don't update cull mode
 	if (!m_texrectDrawer.isEmpty()) {
 		CombinerInfo & cmbInfo = CombinerInfo::get();
@@ -2188,6 +2226,9 @@ void OGLRender::clearDepthBuffer(u32 _ulx, u32 _uly, u32 _lrx, u32 _lry)
 
 	depthBufferList().clearBuffer(_ulx, _uly, _lrx, _lry);
 
+	if (frameSkipper.isSkipped())
+		return;
+
 	glDisable( GL_SCISSOR_TEST );
 
 #ifdef ANDROID
@@ -2369,6 +2410,7 @@ void OGLRender::_initData()
 	TFH.init();
 	PostProcessor::get().init();
 	perf.reset();
+	frameSkipper.reset();
 	FBInfo::fbInfo.reset();
 	m_texrectDrawer.init();
 	m_renderState = rsNone;
@@ -2414,6 +2456,7 @@ void OGLRender::_destroyData()
 #endif
 
 	m_renderState = rsNone;
+	frameSkipper.destroy();
 	m_texrectDrawer.destroy();
 	PostProcessor::get().destroy();
 	if (TFH.optionsChanged())
@@ -78,6 +78,10 @@ public:
 	);
 	void SetRenderingCallback(void (*callback)(int));
 
+	// Savestate extension
+	unsigned int SaveState(void * _dest, unsigned int _size);
+	int LoadState(const void * _src, unsigned int _size);
+
 	// FrameBufferInfo extension
 	void FBWrite(unsigned int addr, unsigned int size);
 	void FBRead(unsigned int addr);
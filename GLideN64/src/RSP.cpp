@@ -14,6 +14,7 @@
 #include "PluginAPI.h"
 #include "Config.h"
 #include "TextureFilterHandler.h"
+#include "main/trace.h"
 
 using namespace std;
 
@@ -139,6 +140,8 @@ void RSP_CheckDLCounter()
 
 void RSP_ProcessDList()
 {
+	TRACE_ZONE("gfx_display_list");
+
 	if (ConfigOpen || video().isResizeWindow()) {
 		*REG.MI_INTR |= MI_INTR_DP;
 		CheckInterrupts();
@@ -0,0 +1,326 @@
+#include <memory>
+#include <cstring>
+#include "SaveState.h"
+#include "N64.h"
+#include "RSP.h"
+#include "gSP.h"
+#include "gDP.h"
+#include "VI.h"
+#include "OpenGL.h"
+#include "Config.h"
+#include "FrameBuffer.h"
+#include "DepthBuffer.h"
+#include "Textures.h"
+#include "Combiner.h"
+
+namespace {
+
+const u32 SaveStateMagic = 0x534E4C47; // "GLNS", byte swapped on the other endianness
+const u32 SaveStateVersion = 1;
+
+struct SaveStateHeader
+{
+	u32 magic, version;
+	u32 gSPSize, gDPSize, VISize;
+};
+
+// What gSP and gDP point to, as indices, and the buffer lists
+struct RendererState
+{
+	s32 textureTiles[2];
+	s32 loadTile;
+	s32 tileFrameBuffers[8];
+	FrameBufferListState frameBuffers;
+	DepthBufferListState depthBuffers;
+};
+
+// Everything derived from gSP and gDP is updated again after a load. The
+// saved states carry these flags too, for a state saved right after a load
+// to be the one loaded.
+const u32 LoadChangedGSP = CHANGED_VIEWPORT | CHANGED_MATRIX | CHANGED_TEXTURE | CHANGED_GEOMETRYMODE |
+	CHANGED_FOGPOSITION | CHANGED_LIGHT | CHANGED_LOOKAT | CHANGED_TEXTURESCALE | CHANGED_HW_LIGHT;
+const u32 LoadChangedGDP = CHANGED_RENDERMODE | CHANGED_CYCLETYPE | CHANGED_SCISSOR | CHANGED_TMEM | CHANGED_TILE |
+	CHANGED_COMBINE | CHANGED_ALPHACOMPARE | CHANGED_FOGCOLOR | CHANGED_BLENDCOLOR | CHANGED_FB_TEXTURE;
+
+// the state loaded last, until SaveState_Restore rebuilds its buffers
+RendererState restoredState;
+bool restorePending = false;
+
+class StateWriter
+{
+public:
+	StateWriter(u8 * _pDest) : m_pDest(_pDest), m_pos(0) {}
+
+	void write(const void * _pData, u32 _size)
+	{
+		if (m_pDest != nullptr)
+			memcpy(m_pDest + m_pos, _pData, _size);
+		m_pos += _size;
+	}
+
+	template <typename T>
+	void write(const T & _value) { write(&_value, sizeof(T)); }
+
+	u32 getPos() const { return m_pos; }
+
+private:
+	u8 * m_pDest;
+	u32 m_pos;
+};
+
+class StateReader
+{
+public:
+	StateReader(const u8 * _pSrc, u32 _size) : m_pSrc(_pSrc), m_size(_size), m_pos(0) {}
+
+	bool read(void * _pData, u32 _size)
+	{
+		if (_size > m_size - m_pos)
+			return false;
+		memcpy(_pData, m_pSrc + m_pos, _size);
+		m_pos += _size;
+		return true;
+	}
+
+	template <typename T>
+	bool read(T & _value) { return read(&_value, sizeof(T)); }
+
+	u32 getPos() const { return m_pos; }
+
+private:
+	const u8 * m_pSrc;
+	u32 m_size;
+	u32 m_pos;
+};
+
+s32 tileIndex(const gDPTile * _pTile)
+{
+	return _pTile != nullptr ? static_cast<s32>(_pTile - gDP.tiles) : -1;
+}
+
+gDPTile * tilePointer(s32 _index)
+{
+	return _index >= 0 ? &gDP.tiles[_index] : nullptr;
+}
+
+void writeState(StateWriter & _writer, const gSPInfo & _gSP, const gDPInfo & _gDP, const RendererState & _state)
+{
+	SaveStateHeader header;
+	header.magic = SaveStateMagic;
+	header.version = SaveStateVersion;
+	header.gSPSize = sizeof(gSPInfo);
+	header.gDPSize = sizeof(gDPInfo);
+	header.VISize = sizeof(VIInfo);
+	_writer.write(header);
+
+	_writer.write(_gSP);
+	_writer.write(_gDP);
+	_writer.write(TMEM, sizeof(TMEM));
+	_writer.write(VI);
+	_writer.write(_state.textureTiles);
+	_writer.write(_state.loadTile);
+	_writer.write(_state.tileFrameBuffers);
+
+	const FrameBufferListState & frameBuffers = _state.frameBuffers;
+	_writer.write(static_cast<u32>(frameBuffers.buffers.size()));
+	_writer.write(frameBuffers.current);
+	_writer.write(frameBuffers.copy);
+	_writer.write(frameBuffers.prevColorImageHeight);
+	for (const FrameBufferState & buffer : frameBuffers.buffers) {
+		_writer.write(buffer.info);
+		_writer.write(static_cast<u32>(buffer.rdramCopy.size()));
+		if (!buffer.rdramCopy.empty())
+			_writer.write(buffer.rdramCopy.data(), buffer.rdramCopy.size());
+	}
+
+	const DepthBufferListState & depthBuffers = _state.depthBuffers;
+	_writer.write(static_cast<u32>(depthBuffers.buffers.size()));
+	_writer.write(depthBuffers.current);
+	for (const DepthBufferState & buffer : depthBuffers.buffers)
+		_writer.write(buffer);
+}
+
+bool isIndex(s32 _index, size_t _count)
+{
+	return _index >= -1 && _index < static_cast<s32>(_count);
+}
+
+bool readBuffers(StateReader & _reader, RendererState & _state)
+{
+	FrameBufferListState & frameBuffers = _state.frameBuffers;
+	u32 count;
+	if (!_reader.read(count) || count > 256 ||
+		!_reader.read(frameBuffers.current) ||
+		!_reader.read(frameBuffers.copy) ||
+		!_reader.read(frameBuffers.prevColorImageHeight))
+		return false;
+	frameBuffers.buffers.resize(count);
+	for (FrameBufferState & buffer : frameBuffers.buffers) {
+		u32 copySize;
+		if (!_reader.read(buffer.info) || !_reader.read(copySize) || copySize > RDRAMSize + 1)
+			return false;
+		buffer.rdramCopy.resize(copySize);
+		if (copySize != 0 && !_reader.read(buffer.rdramCopy.data(), copySize))
+			return false;
+		if (buffer.info.startAddress > RDRAMSize || buffer.info.endAddress < buffer.info.startAddress ||
+			buffer.info.width == 0 || buffer.info.width > 4096 || buffer.info.height > 4096 ||
+			buffer.info.size > G_IM_SIZ_32b)
+			return false;
+	}
+
+	DepthBufferListState & depthBuffers = _state.depthBuffers;
+	if (!_reader.read(count) || count > 256 || !_reader.read(depthBuffers.current))
+		return false;
+	depthBuffers.buffers.resize(count);
+	for (DepthBufferState & buffer : depthBuffers.buffers) {
+		if (!_reader.read(buffer))
+			return false;
+	}
+
+	if (!isIndex(frameBuffers.current, frameBuffers.buffers.size()) ||
+		!isIndex(frameBuffers.copy, frameBuffers.buffers.size()) ||
+		!isIndex(depthBuffers.current, depthBuffers.buffers.size()))
+		return false;
+	for (const FrameBufferState & buffer : frameBuffers.buffers)
+		if (!isIndex(buffer.info.depthBuffer, depthBuffers.buffers.size()))
+			return false;
+	for (u32 i = 0; i < 8; ++i)
+		if (!isIndex(_state.tileFrameBuffers[i], frameBuffers.buffers.size()))
+			return false;
+	return true;
+}
+
+}
+
+u32 SaveState_Save(void * _pDest, u32 _size)
+{
+	// Copied as bytes, padding included, and without their pointers: the
+	// blob must only change with the state for the core to reuse the chunks
+	// of the savestate which didn't change.
+	std::unique_ptr<gSPInfo> pGSP(new gSPInfo);
+	std::unique_ptr<gDPInfo> pGDP(new gDPInfo);
+	memcpy(pGSP.get(), &gSP, sizeof(gSPInfo));
+	memcpy(pGDP.get(), &gDP, sizeof(gDPInfo));
+	std::unique_ptr<RendererState> pState;
+	const RendererState * pSaved = &restoredState;
+
+	if (!restorePending) {
+		pState.reset(new RendererState);
+		pSaved = pState.get();
+		frameBufferList().getState(pState->frameBuffers);
+		depthBufferList().getState(pState->depthBuffers);
+		for (u32 i = 0; i < 8; ++i)
+			pState->tileFrameBuffers[i] = frameBufferList().getIndex(gDP.tiles[i].frameBuffer);
+		pState->textureTiles[0] = tileIndex(gSP.textureTile[0]);
+		pState->textureTiles[1] = tileIndex(gSP.textureTile[1]);
+		pState->loadTile = tileIndex(gDP.loadTile);
+	}
+
+	pGSP->changed |= LoadChangedGSP;
+	pGDP->changed |= LoadChangedGDP;
+	pGSP->textureTile[0] = pGSP->textureTile[1] = nullptr;
+	pGDP->loadTile = nullptr;
+	for (u32 i = 0; i < 8; ++i)
+		pGDP->tiles[i].frameBuffer = nullptr;
+
+	StateWriter sizer(nullptr);
+	writeState(sizer, *pGSP, *pGDP, *pSaved);
+	if (_pDest != nullptr && _size >= sizer.getPos()) {
+		StateWriter writer(static_cast<u8*>(_pDest));
+		writeState(writer, *pGSP, *pGDP, *pSaved);
+	}
+	return sizer.getPos();
+}
+
+bool SaveState_Load(const void * _pSrc, u32 _size)
+{
+	StateReader reader(static_cast<const u8*>(_pSrc), _size);
+	SaveStateHeader header;
+	if (!reader.read(header) ||
+		header.magic != SaveStateMagic ||
+		header.version != SaveStateVersion ||
+		header.gSPSize != sizeof(gSPInfo) ||
+		header.gDPSize != sizeof(gDPInfo) ||
+		header.VISize != sizeof(VIInfo))
+		return false;
+
+	std::unique_ptr<gSPInfo> pGSP(new gSPInfo);
+	std::unique_ptr<gDPInfo> pGDP(new gDPInfo);
+	std::unique_ptr<u64[]> pTMEM(new u64[512]);
+	std::unique_ptr<RendererState> pState(new RendererState);
+	VIInfo vi;
+	if (!reader.read(*pGSP) ||
+		!reader.read(*pGDP) ||
+		!reader.read(pTMEM.get(), sizeof(TMEM)) ||
+		!reader.read(vi) ||
+		!reader.read(pState->textureTiles) ||
+		!reader.read(pState->loadTile) ||
+		!reader.read(pState->tileFrameBuffers) ||
+		!readBuffers(reader, *pState) ||
+		reader.getPos() != _size)
+		return false;
+	if (!isIndex(pState->textureTiles[0], 8) || !isIndex(pState->textureTiles[1], 8) || !isIndex(pState->loadTile, 8))
+		return false;
+
+	memcpy(&gSP, pGSP.get(), sizeof(gSPInfo));
+	memcpy(&gDP, pGDP.get(), sizeof(gDPInfo));
+	memcpy(TMEM, pTMEM.get(), sizeof(TMEM));
+	VI = vi;
+	gSP.textureTile[0] = tilePointer(pState->textureTiles[0]);
+	gSP.textureTile[1] = tilePointer(pState->textureTiles[1]);
+	gDP.loadTile = tilePointer(pState->loadTile);
+
+	// The textures are looked up again from TMEM, the microcode from RDRAM.
+	// The combiner colors are uploaded by SaveState_Restore, on the thread
+	// which renders.
+	gSP.changed |= LoadChangedGSP;
+	gDP.changed |= LoadChangedGDP;
+	RSP.uc_start = RSP.uc_dstart = 0;
+	textureCache().current[0] = textureCache().current[1] = nullptr;
+
+	restoredState.frameBuffers.buffers.swap(pState->frameBuffers.buffers);
+	restoredState.frameBuffers.current = pState->frameBuffers.current;
+	restoredState.frameBuffers.copy = pState->frameBuffers.copy;
+	restoredState.frameBuffers.prevColorImageHeight = pState->frameBuffers.prevColorImageHeight;
+	restoredState.depthBuffers.buffers.swap(pState->depthBuffers.buffers);
+	restoredState.depthBuffers.current = pState->depthBuffers.current;
+	memcpy(restoredState.textureTiles, pState->textureTiles, sizeof(pState->textureTiles));
+	restoredState.loadTile = pState->loadTile;
+	memcpy(restoredState.tileFrameBuffers, pState->tileFrameBuffers, sizeof(pState->tileFrameBuffers));
+	restorePending = true;
+	return true;
+}
+
+void SaveState_Restore()
+{
+	if (!restorePending)
+		return;
+	restorePending = false;
+
+	FrameBufferList & fbList = frameBufferList();
+	if (config.frameBufferEmulation.enable != 0) {
+		fbList.setState(restoredState.frameBuffers);
+		depthBufferList().setState(restoredState.depthBuffers);
+		fbList.attachDepthBuffers(restoredState.frameBuffers);
+	}
+
+	for (u32 i = 0; i < 8; ++i) {
+		gDPTile & tile = gDP.tiles[i];
+		tile.frameBuffer = fbList.getBuffer(restoredState.tileFrameBuffers[i]);
+		if (tile.frameBuffer == nullptr &&
+			(tile.textureMode == TEXTUREMODE_FRAMEBUFFER || tile.textureMode == TEXTUREMODE_FRAMEBUFFER_BG))
+			tile.textureMode = TEXTUREMODE_NORMAL;
+	}
+
+	// the colors are only uploaded when gDP sets them, not on CHANGED flags
+	CombinerInfo & cmbInfo = CombinerInfo::get();
+	cmbInfo.updatePrimColor();
+	cmbInfo.updateEnvColor();
+	cmbInfo.updateFogColor();
+	cmbInfo.updateBlendColor();
+	cmbInfo.updateKeyColor();
+	cmbInfo.updateConvertColor();
+
+	std::vector<FrameBufferState>().swap(restoredState.frameBuffers.buffers);
+	std::vector<DepthBufferState>().swap(restoredState.depthBuffers.buffers);
+}
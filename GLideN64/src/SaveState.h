@@ -0,0 +1,25 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include "Types.h"
+
+// Renderer state carried in the savestates of the core: gSP, gDP, TMEM, VI
+// and the descriptors of the frame and depth buffers, so that a restored
+// state renders its first frame like the saved one did instead of starting
+// from the buffers and tiles of whatever ran before the load.
+// No GL object is saved: buffers still there are kept, the others are
+// created again, and textures are uploaded again when used. gSPInfo and
+// gDPInfo are saved as they are, so the state of another build is rejected
+// and the plugin goes on as without it.
+
+// Writes the state to _pDest if _size is large enough, returns its size.
+u32 SaveState_Save(void * _pDest, u32 _size);
+
+// Restores gSP, gDP, TMEM and VI, returns false if the state can't be used.
+// The buffer lists and the combiner colors need GL, which is only current
+// while the core runs, so they are rebuilt by SaveState_Restore on the next
+// call of the core.
+bool SaveState_Load(const void * _pSrc, u32 _size);
+void SaveState_Restore();
+
+#endif // SAVESTATE_H
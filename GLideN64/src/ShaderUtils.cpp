@@ -302,6 +302,51 @@ void _correctSecondStageParams(CombinerStage & _stage) {
 	}
 }
 
+static
+const char* fragment_shader_alpha_test =
+"  if (uEnableAlphaTest != 0) {							\n"
+"    lowp float alphaTestValue = (uAlphaCompareMode == 3) ? snoise() : uAlphaTestValue;	\n"
+"    lowp float alphaValue;								\n"
+"    if ((uAlphaCvgSel != 0) && (uCvgXAlpha == 0)) {	\n"
+"      alphaValue = 0.125;								\n"
+"    } else {											\n"
+"      alphaValue = clamp(alpha1, 0.0, 1.0);			\n"
+"    }													\n"
+"    if (alphaValue < alphaTestValue) discard;			\n"
+"  }													\n"
+;
+
+// Dithers and blends clampedColor and writes it to fragColor
+static
+void _compileCombinerOutput(bool _bBlender1, bool _bBlender2, std::string & _strShader)
+{
+#ifndef GLES2
+	if (config.generalEmulation.enableNoise != 0) {
+		_strShader.append(
+			"  if (uColorDitherMode == 2) colorNoiseDither(snoise(), clampedColor.rgb);	\n"
+			"  if (uAlphaDitherMode == 2) alphaNoiseDither(snoise(), clampedColor.a);	\n"
+			);
+	}
+#endif
+
+	if (config.generalEmulation.enableLegacyBlending == 0) {
+		if (_bBlender1)
+			_strShader.append(fragment_shader_blender1);
+		if (_bBlender2)
+			_strShader.append(fragment_shader_blender2);
+
+		_strShader.append(
+			"  fragColor = clampedColor;	\n"
+			);
+	} else {
+		_strShader.append(
+			"  fragColor = clampedColor;	\n"
+			"  if (uFogUsage == 1) \n"
+			"    fragColor.rgb = mix(fragColor.rgb, uFogColor.rgb, vShadeColor.a); \n"
+			);
+	}
+}
+
 static
 int _compileCombiner(const CombinerStage & _stage, const char** _Input, std::string & _strShader) {
 	char buf[128];
@@ -377,18 +422,7 @@ int compileCombiner(const gDPCombine & _combine, Combiner & _color, Combiner & _
 	else if (combinedAlphaABD(_combine))
 		_strShader.append(fragment_shader_sign_extend_alpha_abd);
 
-	_strShader.append(
-		"  if (uEnableAlphaTest != 0) {							\n"
-		"    lowp float alphaTestValue = (uAlphaCompareMode == 3) ? snoise() : uAlphaTestValue;	\n"
-	    "    lowp float alphaValue;								\n"
-		"    if ((uAlphaCvgSel != 0) && (uCvgXAlpha == 0)) {	\n"
-	    "      alphaValue = 0.125;								\n"
-	    "    } else {											\n"
-	    "      alphaValue = clamp(alpha1, 0.0, 1.0);			\n"
-	    "    }													\n"
-		"    if (alphaValue < alphaTestValue) discard;			\n"
-		"  }													\n"
-		);
+	_strShader.append(fragment_shader_alpha_test);
 
 	_strShader.append("  color1 = ");
 	nInputs |= _compileCombiner(_color.stage[0], ColorInput, _strShader);
@@ -424,31 +458,103 @@ int compileCombiner(const gDPCombine & _combine, Combiner & _color, Combiner & _
 	else
 		_strShader.append("  lowp vec4 clampedColor = clamp(cmbRes, 0.0, 1.0);\n");
 
+	_compileCombinerOutput(gDP.otherMode.cycleType <= G_CYC_2CYCLE, gDP.otherMode.cycleType == G_CYC_2CYCLE, _strShader);
+
+	return nInputs;
+}
+
 #ifndef GLES2
-	if (config.generalEmulation.enableNoise != 0) {
-		_strShader.append(
-			"  if (uColorDitherMode == 2) colorNoiseDither(snoise(), clampedColor.rgb);	\n"
-			"  if (uAlphaDitherMode == 2) alphaNoiseDither(snoise(), clampedColor.a);	\n"
-			);
+void compileUberCombiner(std::string & _strShader)
+{
+	char buf[128];
+	_strShader.append(
+		"  lowp float lod_frac = 0.0;	\n"
+		"  combined_color = vec4(0.0);	\n"
+		"  lowp vec3 cmbColor[21];		\n"
+		"  lowp float cmbAlpha[21];		\n"
+		);
+	// Some color inputs are scalars, such as COMBINED_ALPHA
+	for (int i = COMBINED; i <= ZERO; ++i) {
+		sprintf(buf, "  cmbColor[%d] = vec3(%s); cmbAlpha[%d] = %s; \n", i, ColorInput[i], i, AlphaInput[i]);
+		_strShader += buf;
 	}
-#endif
 
-	if (config.generalEmulation.enableLegacyBlending == 0) {
-		if (gDP.otherMode.cycleType <= G_CYC_2CYCLE)
-			_strShader.append(fragment_shader_blender1);
-		if (gDP.otherMode.cycleType == G_CYC_2CYCLE)
-			_strShader.append(fragment_shader_blender2);
+	_strShader.append("  alpha1 = (cmbAlpha[uCmbAlpha0[0]] - cmbAlpha[uCmbAlpha0[1]]) * cmbAlpha[uCmbAlpha0[2]] + cmbAlpha[uCmbAlpha0[3]]; \n");
+	_strShader.append("  if (uCmbMode[2] == 1) \n");
+	_strShader.append(fragment_shader_sign_extend_alpha_c);
+	_strShader.append("  else if (uCmbMode[2] == 2) \n");
+	_strShader.append(fragment_shader_sign_extend_alpha_abd);
 
-		_strShader.append(
-			"  fragColor = clampedColor;	\n"
-			);
-	} else {
-		_strShader.append(
-			"  fragColor = clampedColor;	\n"
-			"  if (uFogUsage == 1) \n"
-			"    fragColor.rgb = mix(fragColor.rgb, uFogColor.rgb, vShadeColor.a); \n"
-			);
+	_strShader.append(fragment_shader_alpha_test);
+
+	_strShader.append("  color1 = (cmbColor[uCmbColor0[0]] - cmbColor[uCmbColor0[1]]) * cmbColor[uCmbColor0[2]] + cmbColor[uCmbColor0[3]]; \n");
+	_strShader.append("  if (uCmbMode[1] == 1) \n");
+	_strShader.append(fragment_shader_sign_extend_color_c);
+	_strShader.append("  else if (uCmbMode[1] == 2) \n");
+	_strShader.append(fragment_shader_sign_extend_color_abd);
+
+	// The second stage reads the first one through the COMBINED and COMBINED_ALPHA inputs.
+	_strShader.append(
+		"  combined_color = vec4(color1, alpha1);	\n"
+		"  cmbColor[0] = color1;						\n"
+		"  cmbColor[8] = vec3(alpha1);				\n"
+		"  cmbAlpha[0] = alpha1;						\n"
+		"  cmbAlpha[8] = alpha1;						\n"
+		"  if (uCmbMode[0] == 2) {					\n"
+		"    alpha2 = (cmbAlpha[uCmbAlpha1[0]] - cmbAlpha[uCmbAlpha1[1]]) * cmbAlpha[uCmbAlpha1[2]] + cmbAlpha[uCmbAlpha1[3]]; \n"
+		"    color2 = (cmbColor[uCmbColor1[0]] - cmbColor[uCmbColor1[1]]) * cmbColor[uCmbColor1[2]] + cmbColor[uCmbColor1[3]]; \n"
+		"  } else {									\n"
+		"    alpha2 = alpha1;						\n"
+		"    color2 = color1;						\n"
+		"  }										\n"
+		"  if (uCvgXAlpha != 0 && alpha2 < 0.125) discard; \n"
+		"  lowp vec4 cmbRes = vec4(color2, alpha2);	\n"
+		// Wrap the color like fragment_shader_clamp does if uCmbMode[3] is set.
+		"  lowp vec4 clampedColor = clamp(cmbRes + float(uCmbMode[3]) * (2.0 * step(cmbRes, vec4(-0.51)) - 2.0*step(vec4(1.51), cmbRes)), 0.0, 1.0); \n"
+		);
+	// Blender cycles are enabled by uForceBlendCycle1 and uForceBlendCycle2.
+	_compileCombinerOutput(true, true, _strShader);
+}
+#endif // GLES2
+
+static
+void _getUberCombinerCycle(const CombineCycle & _cycle, int _stage, int * _params)
+{
+	_params[0] = _cycle.sa;
+	_params[1] = _cycle.sb;
+	_params[2] = _cycle.m;
+	_params[3] = _cycle.a;
+	for (int i = 0; i < 4; ++i) {
+		if (_stage == 1)
+			_params[i] = correctSecondStageParam(_params[i]);
+		else if (gDP.otherMode.cycleType != G_CYC_2CYCLE)
+			_params[i] = correctFirstStageParam(_params[i]);
 	}
+}
 
-	return nInputs;
+void getUberCombinerParams(const gDPCombine & _combine, const CombineCycle * _cc, const CombineCycle * _ac, int _numStages, UberCombinerParams & _params)
+{
+	for (int i = 0; i < _numStages; ++i) {
+		_getUberCombinerCycle(_cc[i], i, _params.color[i]);
+		_getUberCombinerCycle(_ac[i], i, _params.alpha[i]);
+	}
+	if (_numStages == 1) {
+		for (int i = 0; i < 4; ++i)
+			_params.color[1][i] = _params.alpha[1][i] = ZERO;
+	}
+
+	_params.mode[0] = _numStages;
+	if (combinedColorC(_combine))
+		_params.mode[1] = 1;
+	else if (combinedColorABD(_combine))
+		_params.mode[1] = 2;
+	else
+		_params.mode[1] = 0;
+	if (combinedAlphaC(_combine))
+		_params.mode[2] = 1;
+	else if (combinedAlphaABD(_combine))
+		_params.mode[2] = 2;
+	else
+		_params.mode[2] = 0;
+	_params.mode[3] = needClampColor() ? 1 : 0;
 }
@@ -10,4 +10,14 @@ bool checkProgramLinkStatus(GLuint obj);
 void logErrorShader(GLenum _shaderType, const std::string & _strShader);
 int compileCombiner(const gDPCombine & _combine, Combiner & _color, Combiner & _alpha, std::string & _strShader);
 
+// Selectors of the uber-shader, which evaluates any combine mode at run time
+struct UberCombinerParams
+{
+	int color[2][4];	// sa, sb, m, a inputs of each stage
+	int alpha[2][4];
+	int mode[4];		// number of stages, color and alpha sign-extend mode, color wrap
+};
+void compileUberCombiner(std::string & _strShader);
+void getUberCombinerParams(const gDPCombine & _combine, const CombineCycle * _cc, const CombineCycle * _ac, int _numStages, UberCombinerParams & _params);
+
 #endif // SHADER_UTILS_H
@@ -17,6 +17,7 @@
 #include "Keys.h"
 #include "GLideNHQ/Ext_TxFilter.h"
 #include "TextureFilterHandler.h"
+#include "main/trace.h"
 
 #ifdef HAVE_LIBNX
 #include <switch.h>
@@ -760,6 +761,8 @@ bool TextureCache::_loadHiresBackground(CachedTexture *_pTexture)
 
 void TextureCache::_loadBackground(CachedTexture *pTexture)
 {
+	TRACE_ZONE("gfx_texture_load");
+
 	if (_loadHiresBackground(pTexture))
 		return;
 
@@ -1051,6 +1054,8 @@ void TextureCache::_getTextureDestData(CachedTexture& tmptex,
 
 void TextureCache::_load(u32 _tile, CachedTexture *_pTexture)
 {
+	TRACE_ZONE("gfx_texture_load");
+
 	u64 ricecrc = 0;
 	if (_loadHiresTexture(_tile, _pTexture, ricecrc))
 		return;
@@ -1118,6 +1123,15 @@ void TextureCache::_load(u32 _tile, CachedTexture *_pTexture)
 		}
 
 		bool bLoaded = false;
+		if (use_txfilter && config.textureFilter.txAsyncFilter != 0 &&
+				txfilter_filter_async((u8*)pDest, tmptex.realWidth, tmptex.realHeight,
+							glInternalFormat, (uint64)_pTexture->crc) != 0) {
+			// Use the texture as is until loadFilteredTextures() gets the filtered one
+			use_txfilter = false;
+#ifndef GLES2
+			glTexStorage2D(GL_TEXTURE_2D, 1, glInternalFormat, _pTexture->realWidth, _pTexture->realHeight);
+#endif
+		}
 		if (use_txfilter)
 		{
 			GHQTexInfo ghqTexInfo;
@@ -1177,6 +1191,47 @@ void TextureCache::_load(u32 _tile, CachedTexture *_pTexture)
 	free(pDest);
 }
 
+void TextureCache::loadFilteredTextures()
+{
+	if (config.textureFilter.txAsyncFilter == 0 || !TFH.isInited())
+		return;
+
+	uint64 crc;
+	GHQTexInfo ghqTexInfo;
+	while (txfilter_async_result(&crc, &ghqTexInfo) != 0) {
+		Texture_Locations::iterator locations_iter = m_lruTextureLocations.find((u32)crc);
+		if (locations_iter == m_lruTextureLocations.end())
+			continue;
+		CachedTexture & texture = *locations_iter->second;
+		if (texture.bHDTexture || ghqTexInfo.data == nullptr)
+			continue;
+
+		// Storage of the unfiltered texture is immutable, so the filtered one gets a new name
+		GLuint glName;
+		glGenTextures(1, &glName);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, glName);
+#ifdef GLES2
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+				ghqTexInfo.width, ghqTexInfo.height,
+				0, GL_RGBA, ghqTexInfo.pixel_type,
+				ghqTexInfo.data);
+#else
+		glTexStorage2D(GL_TEXTURE_2D, 1, ghqTexInfo.format, ghqTexInfo.width, ghqTexInfo.height);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, ghqTexInfo.width, ghqTexInfo.height, ghqTexInfo.texture_format, ghqTexInfo.pixel_type, ghqTexInfo.data);
+#endif
+		glDeleteTextures(1, &texture.glName);
+		texture.glName = glName;
+
+		m_cachedBytes -= texture.textureBytes;
+		_updateCachedTexture(ghqTexInfo, &texture);
+		m_cachedBytes += texture.textureBytes;
+
+		// Rebind current textures and update their parameters
+		gSP.changed |= CHANGED_TEXTURE;
+	}
+}
+
 struct TextureParams
 {
 	u16 width;
@@ -61,6 +61,8 @@ struct TextureCache
 	void activateDummy(u32 _t);
 	void activateMSDummy(u32 _t);
 	void update(u32 _t);
+	// Replaces textures shown unfiltered with the ones filtered on worker threads
+	void loadFilteredTextures();
 
 	static TextureCache & get();
 
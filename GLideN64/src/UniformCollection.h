@@ -34,6 +34,7 @@ public:
 		luTotal
 	};
 
+	UniformCollection() : m_uploads(0), m_frames(0), m_totalUploads(0), m_maxUploads(0) {}
 	virtual ~UniformCollection() {}
 
 	virtual void bindWithShaderCombiner(ShaderCombiner * _pCombiner) = 0;
@@ -41,6 +42,27 @@ public:
 	virtual void updateTextureParameters() = 0;
 	virtual void updateLightParameters() = 0;
 	virtual void updateUniforms(ShaderCombiner * _pCombiner, OGLRender::RENDER_STATE _renderState) = 0;
+
+	// Upload statistics
+	void frameDone() {
+		++m_frames;
+		m_totalUploads += m_uploads;
+		if (m_uploads > m_maxUploads)
+			m_maxUploads = m_uploads;
+		m_uploads = 0;
+	}
+	u32 getFrames() const { return m_frames; }
+	u32 getAverageUploads() const { return m_frames == 0 ? 0 : (u32)(m_totalUploads / m_frames); }
+	u32 getMaxUploads() const { return m_maxUploads; }
+
+protected:
+	// Number of glUniform* or glBufferSubData calls in the current frame
+	u32 m_uploads;
+
+private:
+	u32 m_frames;
+	u64 m_totalUploads;
+	u32 m_maxUploads;
 };
 
 UniformCollection * createUniformCollection();
@@ -12,6 +12,7 @@
 #include "FrameBufferInfo.h"
 #include "Config.h"
 #include "Performance.h"
+#include "FrameSkipper.h"
 #include "Debug.h"
 
 using namespace std;
@@ -137,6 +138,8 @@ void VI_UpdateScreen()
 			break;
 		}
 
+		frameSkipper.update(bNeedSwap && (bCFB || gDP.colorImage.changed != 0));
+
 		if (bNeedSwap) {
 			if (bCFB) {
 				if (pBuffer == nullptr || pBuffer->m_width != VI.width) {
@@ -164,6 +167,7 @@ void VI_UpdateScreen()
 		} 
 	}
 	else {
+		frameSkipper.update((gDP.changed & CHANGED_COLORBUFFER) != 0);
 		if (gDP.changed & CHANGED_COLORBUFFER) {
 			ogl.swapBuffers();
 			gDP.changed &= ~CHANGED_COLORBUFFER;
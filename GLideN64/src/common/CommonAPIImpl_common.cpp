@@ -17,6 +17,7 @@
 #include <Debug.h>
 #include <FrameBufferInfo.h>
 #include <TextureFilterHandler.h>
+#include <SaveState.h>
 #include <Log.h>
 
 PluginAPI & PluginAPI::get()
@@ -156,6 +157,7 @@ void PluginAPI::ProcessDList()
 #ifdef RSPTHREAD
 	_callAPICommand(ProcessDListCommand());
 #else
+	SaveState_Restore();
 	RSP_ProcessDList();
 #endif
 }
@@ -166,6 +168,7 @@ void PluginAPI::ProcessRDPList()
 #ifdef RSPTHREAD
 	_callAPICommand(ProcessRDPListCommand());
 #else
+	SaveState_Restore();
 	RDP_ProcessRDPList();
 #endif
 }
@@ -225,6 +228,7 @@ void PluginAPI::UpdateScreen()
 #ifdef RSPTHREAD
 	_callAPICommand(ProcessUpdateScreenCommand());
 #else
+	SaveState_Restore();
 	VI_UpdateScreen();
 #endif
 }
@@ -270,6 +274,7 @@ void PluginAPI::ChangeWindow()
 
 void PluginAPI::FBWrite(unsigned int _addr, unsigned int _size)
 {
+	SaveState_Restore();
 	FBInfo::fbInfo.Write(_addr, _size);
 }
 
@@ -278,15 +283,31 @@ void PluginAPI::FBRead(unsigned int _addr)
 #ifdef RSPTHREAD
 	_callAPICommand(FBReadCommand(_addr));
 #else
+	SaveState_Restore();
 	FBInfo::fbInfo.Read(_addr);
 #endif
 }
 
 void PluginAPI::FBGetFrameBufferInfo(void * _pinfo)
 {
+	SaveState_Restore();
 	FBInfo::fbInfo.GetInfo(_pinfo);
 }
 
+#ifdef MUPENPLUSAPI
+unsigned int PluginAPI::SaveState(void * _dest, unsigned int _size)
+{
+	LOG(LOG_APIFUNC, "SaveState\n");
+	return SaveState_Save(_dest, _size);
+}
+
+int PluginAPI::LoadState(const void * _src, unsigned int _size)
+{
+	LOG(LOG_APIFUNC, "LoadState\n");
+	return SaveState_Load(_src, _size) ? 1 : 0;
+}
+#endif
+
 #ifndef MUPENPLUSAPI
 void PluginAPI::FBWList(FrameBufferModifyEntry * _plist, unsigned int _size)
 {
@@ -822,6 +822,7 @@ void gDPSetKeyR( u32 cR, u32 sR, u32 wR )
 	gDP.key.center.r = cR * 0.0039215689f;
 	gDP.key.scale.r = sR * 0.0039215689f;
 	gDP.key.width.r = wR * 0.0039215689f;
+	CombinerInfo::get().updateKeyColor();
 }
 
 void gDPSetKeyGB(u32 cG, u32 sG, u32 wG, u32 cB, u32 sB, u32 wB )
@@ -898,13 +899,16 @@ void gDPFullSync()
 
 	video().getRender().flush();
 
-	const bool sync = config.frameBufferEmulation.copyToRDRAM == Config::ctSync;
 	if ((config.frameBufferEmulation.copyToRDRAM != Config::ctDisable || (config.generalEmulation.hacks & hack_subscreen) != 0) &&
 		!FBInfo::fbInfo.isSupported() &&
 		frameBufferList().getCurrent() != nullptr &&
 		!frameBufferList().getCurrent()->isAuxiliary()
-	)
+	) {
+		bool sync = config.frameBufferEmulation.copyToRDRAM == Config::ctSync;
+		if (config.frameBufferEmulation.copyToRDRAM == Config::ctAdaptive)
+			sync = FrameBuffer_IsUsedByCPU(gDP.colorImage.address);
 		FrameBuffer_CopyToRDRAM(gDP.colorImage.address, sync);
+	}
 
 	if (RSP.bLLE) {
 		if (config.frameBufferEmulation.copyDepthToRDRAM != Config::cdDisable && !FBInfo::fbInfo.isSupported())
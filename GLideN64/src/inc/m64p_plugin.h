@@ -212,6 +212,16 @@ EXPORT void CALL FBWrite(unsigned int addr, unsigned int size);
 EXPORT void CALL FBGetFrameBufferInfo(void *p);
 #endif
 
+/* savestate extension, optional: the video plugin state carried in the
+ * savestates. SaveState writes it to buffer if size is large enough and
+ * returns its size, LoadState returns 0 if it can't restore the state. */
+typedef unsigned int (*ptr_SaveState)(void *buffer, unsigned int size);
+typedef int (*ptr_LoadState)(const void *buffer, unsigned int size);
+#if defined(M64P_PLUGIN_PROTOTYPES)
+EXPORT unsigned int CALL SaveState(void *buffer, unsigned int size);
+EXPORT int CALL LoadState(const void *buffer, unsigned int size);
+#endif
+
 /* audio plugin function pointers */
 typedef void (*ptr_AiDacrateChanged)(int SystemType);
 typedef void (*ptr_AiLenChanged)(void);
@@ -43,6 +43,7 @@ MY_LOCAL_SRC_FILES :=                               \
     $(SRCDIR)/FBOTextureFormats.cpp                 \
     $(SRCDIR)/FrameBuffer.cpp                       \
     $(SRCDIR)/FrameBufferInfo.cpp                   \
+    $(SRCDIR)/FrameSkipper.cpp                      \
     $(SRCDIR)/GBI.cpp                               \
     $(SRCDIR)/gDP.cpp                               \
     $(SRCDIR)/GLideN64.cpp                          \
@@ -61,6 +62,7 @@ MY_LOCAL_SRC_FILES :=                               \
     $(SRCDIR)/SoftwareRender.cpp                    \
     $(SRCDIR)/RDP.cpp                               \
     $(SRCDIR)/RSP.cpp                               \
+    $(SRCDIR)/SaveState.cpp                         \
     $(SRCDIR)/S2DEX2.cpp                            \
     $(SRCDIR)/S2DEX.cpp                             \
     $(SRCDIR)/TextureFilterHandler.cpp              \
@@ -60,10 +60,14 @@ extern uint32_t txEnhancementMode;
 extern uint32_t txHiresEnable;
 extern uint32_t txHiresFullAlphaChannel;
 extern uint32_t txFilterIgnoreBG;
+extern uint32_t txAsyncFilter;
 extern uint32_t MultiSampling;
 extern uint32_t EnableFragmentDepthWrite;
 extern uint32_t EnableShadersStorage;
+extern uint32_t EnableAsyncShaderCompile;
 extern uint32_t CropMode;
+extern uint32_t FrameSkipMode;
+extern uint32_t FrameSkipCount;
 extern uint32_t EnableFBEmulation;
 
 #endif
@@ -1,6 +1,8 @@
 #include "PluginAPI.h"
 #include "Types.h"
 #include "OpenGL.h"
+#include "Combiner.h"
+#include "FrameSkipper.h"
 
 extern "C" {
 
@@ -18,4 +20,37 @@ EXPORT void CALL SetRenderingCallback(void (*callback)(int))
 {
 }
 
+EXPORT unsigned int CALL SaveState(void *buffer, unsigned int size)
+{
+	return api().SaveState(buffer, size);
+}
+
+EXPORT int CALL LoadState(const void *buffer, unsigned int size)
+{
+	return api().LoadState(buffer, size);
+}
+
+// Used by retro_get_shader_stats
+void gliden64_get_shader_stats(unsigned *compiled, unsigned *precompiled, unsigned *uber_shader_uses,
+	double *stall_ms, double *max_stall_ms)
+{
+	u32 numCompiled, numPrecompiled, uberShaderUses;
+	CombinerInfo::get().getStats(numCompiled, numPrecompiled, uberShaderUses, *stall_ms, *max_stall_ms);
+	*compiled = numCompiled;
+	*precompiled = numPrecompiled;
+	*uber_shader_uses = uberShaderUses;
+}
+
+// Used by retro_get_frame_skip_stats
+void gliden64_get_frame_skip_stats(unsigned *frames, unsigned *skipped_frames, unsigned *readbacks,
+	unsigned long long *draw_calls, unsigned long long *triangles)
+{
+	const FrameSkipper::Stats & stats = frameSkipper.getStats();
+	*frames = stats.frames;
+	*skipped_frames = stats.skippedFrames;
+	*readbacks = stats.readbacks;
+	*draw_calls = stats.drawCalls;
+	*triangles = stats.triangles;
+}
+
 } // extern "C"
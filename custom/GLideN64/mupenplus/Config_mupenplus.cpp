@@ -147,13 +147,17 @@ void Config_LoadConfig()
 	config.generalEmulation.enableFragmentDepthWrite = EnableFragmentDepthWrite;
 #endif
 	config.generalEmulation.enableShadersStorage = EnableShadersStorage;
+	config.generalEmulation.enableAsyncShaderCompile = EnableAsyncShaderCompile;
 	config.textureFilter.txFilterMode = txFilterMode;
 	config.textureFilter.txEnhancementMode = txEnhancementMode;
 	config.textureFilter.txFilterIgnoreBG = txFilterIgnoreBG;
+	config.textureFilter.txAsyncFilter = txAsyncFilter;
 	config.textureFilter.txHiresEnable = txHiresEnable;
 	config.textureFilter.txHiresFullAlphaChannel = txHiresFullAlphaChannel;
 	config.video.multisampling = MultiSampling;
 	config.video.cropMode = CropMode;
+	config.video.frameSkipMode = FrameSkipMode;
+	config.video.frameSkipCount = FrameSkipCount;
 	config.generalEmulation.hacks = hacks;
 	LoadCustomSettings(true);
 	LoadCustomSettings(false);
@@ -51,6 +51,7 @@
 #include "main/device.h"
 #include "main/eventloop.h"
 #include "main/main.h"
+#include "memory/fastmem.h"
 #include "osal/files.h"
 #include "osal/preproc.h"
 #include "osd/osd.h"
@@ -61,6 +62,8 @@
 #include "plugin/plugin.h"
 #include "plugin/rumble_via_input_plugin.h"
 #include "main/profile.h"
+#include "r4300/cp0.h"
+#include "r4300/op_cost.h"
 #include "r4300/r4300.h"
 #include "r4300/reset.h"
 #include "main/rom.h"
@@ -75,6 +78,8 @@
 
 extern retro_input_poll_t poll_cb;
 extern uint32_t CountPerOp;
+extern uint32_t OpCostScale;
+extern uint32_t LateInputPoll;
 
 /* version number for Core config section */
 #define CONFIG_PARAM_VERSION 1.01
@@ -88,7 +93,7 @@ int         g_MemHasBeenBSwapped = 0;   // store byte-swapped flag so we don't s
 int         g_EmulatorRunning = 0;      // need separate boolean to tell if emulator is running, since --nogui doesn't use a thread
 
 /* XXX: only global because of new dynarec linkage_x86.asm and plugin.c */
-ALIGN(16, uint32_t g_rdram[RDRAM_MAX_SIZE/4]);
+ALIGN(4096, uint32_t g_rdram[RDRAM_MAX_SIZE/4]);
 struct device g_dev;
 
 int g_delay_si = 0;
@@ -102,6 +107,14 @@ static int   l_SpeedFactor = 100;        // percentage of nominal game speed at
 static int   l_FrameAdvance = 0;         // variable to check if we pause on next frame
 static int   l_MainSpeedLimit = 1;       // insert delay during vi_interrupt to keep speed at real-time
 
+static int      l_InputRead = 0;          // the game read the controllers since the last VI
+static uint32_t l_InputPollCount = 0;     // count register when the input was polled
+static uint32_t l_InputReadPollCount = 0; // l_InputPollCount at the first read since the last VI
+
+static unsigned int       l_LatencyFrames = 0;
+static unsigned long long l_LatencyCycles = 0;
+static unsigned int       l_LatencyMaxCycles = 0;
+
 static osd_message_t *l_msgVol = NULL;
 static osd_message_t *l_msgFF = NULL;
 static osd_message_t *l_msgPause = NULL;
@@ -129,9 +142,58 @@ void main_message(m64p_msg_level level, unsigned int corner, const char *format,
     DebugMessage(level, "%s", buffer);
 }
 
-void main_check_inputs(void)
+static void poll_input(void)
 {
     poll_cb();
+    l_InputPollCount = r4300_cp0_regs()[CP0_COUNT_REG];
+}
+
+/* called at each VI and after each SI DMA. With late polling, the input is
+ * polled at the first controller read after a VI instead, so that it is as
+ * recent as possible when the game uses it. */
+void main_check_inputs(void)
+{
+    if (!LateInputPoll)
+        poll_input();
+}
+
+void main_input_read(void)
+{
+    if (l_InputRead)
+        return;
+
+    l_InputRead = 1;
+    /* the new dynarec keeps Count in a host register, its stubs for the
+     * stores to the registers write it back to g_cp0_regs before calling the
+     * handler, so it is already current here, as it is at the VI */
+    cp0_update_count();
+    if (LateInputPoll)
+        poll_input();
+    l_InputReadPollCount = l_InputPollCount;
+}
+
+/* Counts the emulated cycles from the poll of the input the game read since
+ * the last VI to this VI, which presents the frame. */
+static void update_input_latency(void)
+{
+    uint32_t cycles;
+
+    if (!l_InputRead)
+        return;
+
+    cycles = r4300_cp0_regs()[CP0_COUNT_REG] - l_InputReadPollCount;
+    l_LatencyFrames++;
+    l_LatencyCycles += cycles;
+    if (cycles > l_LatencyMaxCycles)
+        l_LatencyMaxCycles = cycles;
+    l_InputRead = 0;
+}
+
+void input_latency_get(unsigned *frames, unsigned long long *cycles, unsigned *max_cycles)
+{
+    *frames     = l_LatencyFrames;
+    *cycles     = l_LatencyCycles;
+    *max_cycles = l_LatencyMaxCycles;
 }
 
 /*********************************************************************************************************
@@ -230,6 +292,7 @@ void new_vi(void)
     gs_apply_cheats();
 
     main_check_inputs();
+    update_input_latency();
 
     retro_return();
 }
@@ -282,6 +345,10 @@ m64p_error main_run(void)
 
 
     no_compiled_jump = 0;
+    l_InputRead = 0;
+    l_LatencyFrames = 0;
+    l_LatencyCycles = 0;
+    l_LatencyMaxCycles = 0;
 #ifdef NEW_DYNAREC
     stop_after_jal = 1;
 #endif
@@ -290,6 +357,7 @@ m64p_error main_run(void)
     count_per_op = CountPerOp;
     if (count_per_op <= 0)
         count_per_op = ROM_PARAMS.countperop;
+    op_cost_init(OpCostScale > 0 ? OpCostScale : ROM_PARAMS.opcostscale, count_per_op);
     cheat_add_hacks();
 
     /* do byte-swapping if it's not been done yet */
@@ -364,6 +432,7 @@ void main_stop(void)
         return;
 
     DebugMessage(M64MSG_STATUS, "Stopping emulation.");
+    fastmem_log_stats();
     stop = 1;
 
     rsp.romClosed();
@@ -21,10 +21,12 @@
 
 #include "api/m64p_types.h"
 #include <libretro.h>
+#include <libretro_replay.h>
 #include "ai/ai_controller.h"
 #include "main/main.h"
 #include "main/device.h"
 #include "main/rom.h"
+#include "main/trace.h"
 #include "plugin/plugin.h"
 #include "ri/ri_controller.h"
 #include "vi/vi_controller.h"
@@ -39,6 +41,17 @@
 #include <audio/conversion/float_to_s16.h>
 #include <audio/conversion/s16_to_float.h>
 #include <audio/audio_resampler.h>
+#include <features/features_cpu.h>
+#include <rthreads/rthreads.h>
+
+#include "audio_plugin.h"
+
+#ifdef _MSC_VER
+#include <windows.h>
+#define AUDIO_BARRIER() MemoryBarrier()
+#else
+#define AUDIO_BARRIER() __sync_synchronize()
+#endif
 
 extern retro_audio_sample_batch_t audio_batch_cb;
 
@@ -46,6 +59,42 @@ static unsigned MAX_AUDIO_FRAMES = 2048;
 
 #define VI_INTR_TIME 500000
 
+#define OUTPUT_FREQ 44100.0
+
+/* Samples go from the AI DMAs to the frontend through two rings of stereo
+ * frames, each with a single producer and a single consumer:
+ *
+ *   aiLenChanged -> in_ring -> resample_pending -> out_ring -> flush_audio_libretro
+ *
+ * resample_pending runs on a thread of its own when init_audio_libretro is
+ * asked for it and the host has more than one core, otherwise in
+ * flush_audio_libretro. Either way, flush_audio_libretro catches up with the
+ * DMAs of the frame, then hands a frame worth of audio to audio_batch_cb,
+ * which libretro only takes from retro_run.
+ *
+ * The DMAs don't land evenly across frames, so out_ring keeps about
+ * AUDIO_TARGET_FILL frames of audio in reserve, and the resampling ratio
+ * follows its fill (dynamic rate control, as in RetroArch): up to
+ * AUDIO_MAX_RATE_DELTA faster when it runs low, as much slower when it runs
+ * high. The ratio only changes between frames, so the thread gives the same
+ * samples as resampling in flush_audio_libretro.
+ *
+ * Without the thread, the audio is direct instead: resampled at the game's
+ * rate in flush_audio_libretro and handed out whole, with no reserve, in the
+ * frame of its DMAs. */
+#define AUDIO_RING_FRAMES 16384
+#define AUDIO_TARGET_FILL 1.5
+#define AUDIO_MAX_RATE_DELTA 0.005
+
+/* head and tail count the frames ever written and read, only the producer
+ * moves head, only the consumer moves tail */
+struct audio_ring
+{
+   volatile uint32_t head;
+   volatile uint32_t tail;
+   int16_t data[2 * AUDIO_RING_FRAMES];
+};
+
 /* Read header for type definition */
 static int GameFreq = 33600;
 static unsigned CountsPerSecond;
@@ -58,13 +107,208 @@ static float *audio_in_buffer_float;
 static float *audio_out_buffer_float;
 static int16_t *audio_out_buffer_s16;
 
+static struct audio_ring *in_ring;
+static struct audio_ring *out_ring;
+static double resample_ratio;
+/* fraction of an output frame carried over to the next frame */
+static double frame_remainder;
+/* out_ring holds its reserve: set once it reaches it, cleared on underrun */
+static int out_primed;
+/* no thread, reserve nor rate control, see above */
+static int audio_direct;
+static struct audio_libretro_stats stats;
+
+static sthread_t *resampler_thread;
+static slock_t *resampler_lock;
+static scond_t *resampler_work;
+static scond_t *resampler_idle;
+/* set by the producer to wake the thread up, cleared by the thread once
+ * in_ring is drained or out_ring is full */
+static volatile int resampler_busy;
+static int resampler_quit;
+
 void (*audio_convert_s16_to_float_arm)(float *out,
       const int16_t *in, size_t samples, float gain);
 void (*audio_convert_float_to_s16_arm)(int16_t *out,
       const float *in, size_t samples);
 
+static size_t ring_fill(const struct audio_ring *ring)
+{
+   return (uint32_t)(ring->head - ring->tail);
+}
+
+/* Producer side: copies up to frames frames in, returns how many fit. */
+static size_t ring_write(struct audio_ring *ring, const int16_t *src, size_t frames)
+{
+   uint32_t head  = ring->head;
+   size_t start   = head & (AUDIO_RING_FRAMES - 1);
+   size_t room    = AUDIO_RING_FRAMES - ring_fill(ring);
+   size_t first;
+
+   AUDIO_BARRIER();
+   if (frames > room)
+      frames = room;
+
+   first = AUDIO_RING_FRAMES - start;
+   if (first > frames)
+      first = frames;
+   memcpy(ring->data + 2 * start, src, first * 4);
+   memcpy(ring->data, src + 2 * first, (frames - first) * 4);
+
+   /* the frames must be there before the consumer sees them */
+   AUDIO_BARRIER();
+   ring->head = head + (uint32_t)frames;
+   return frames;
+}
+
+/* Consumer side: the frames from the tail, up to frames of them, which are
+ * contiguous in data. ring_read then frees them. */
+static const int16_t *ring_peek(const struct audio_ring *ring, size_t *frames)
+{
+   size_t start = ring->tail & (AUDIO_RING_FRAMES - 1);
+   size_t fill  = ring_fill(ring);
+
+   AUDIO_BARRIER();
+   if (*frames > fill)
+      *frames = fill;
+   if (*frames > AUDIO_RING_FRAMES - start)
+      *frames = AUDIO_RING_FRAMES - start;
+   return ring->data + 2 * start;
+}
+
+static void ring_read(struct audio_ring *ring, size_t frames)
+{
+   /* done with the frames before the producer may overwrite them */
+   AUDIO_BARRIER();
+   ring->tail += (uint32_t)frames;
+}
+
+/* Resamples in_ring into out_ring, until in_ring is empty or out_ring has
+ * no room left, returns 1 in the latter case. */
+static int resample_pending(void)
+{
+   double ratio = resample_ratio;
+
+   for (;;)
+   {
+      struct resampler_data data = {0};
+      size_t room       = AUDIO_RING_FRAMES - ring_fill(out_ring);
+      size_t max_frames = room < MAX_AUDIO_FRAMES ? room : MAX_AUDIO_FRAMES;
+      size_t frames, first, second = 0;
+      const int16_t *src;
+
+      /* the sinc resampler makes up to one more frame than the ratio says */
+      max_frames = max_frames > 2 ? (size_t)((max_frames - 2) / ratio) : 0;
+      if (max_frames > MAX_AUDIO_FRAMES)
+         max_frames = MAX_AUDIO_FRAMES;
+
+      if (max_frames == 0)
+         return 1;
+
+      first = max_frames;
+      src   = ring_peek(in_ring, &first);
+      if (first == 0)
+         return 0;
+      convert_s16_to_float(audio_in_buffer_float, src, first * 2, 1.0f);
+      ring_read(in_ring, first);
+
+      /* the rest of the chunk, when in_ring wraps around */
+      if (first < max_frames)
+      {
+         second = max_frames - first;
+         src    = ring_peek(in_ring, &second);
+         convert_s16_to_float(audio_in_buffer_float + first * 2, src, second * 2, 1.0f);
+         ring_read(in_ring, second);
+      }
+      frames = first + second;
+
+      data.data_in      = audio_in_buffer_float;
+      data.data_out     = audio_out_buffer_float;
+      data.input_frames = frames;
+      data.ratio        = ratio;
+
+      TRACE_BEGIN_ARG("audio_resample", frames);
+      resampler->process(resampler_audio_data, &data);
+      convert_float_to_s16(audio_out_buffer_s16, audio_out_buffer_float, data.output_frames * 2);
+      TRACE_END();
+
+      ring_write(out_ring, audio_out_buffer_s16, data.output_frames);
+   }
+}
+
+static void resampler_thread_main(void *data)
+{
+   slock_lock(resampler_lock);
+   for (;;)
+   {
+      int full;
+
+      while (!resampler_busy && !resampler_quit)
+         scond_wait(resampler_work, resampler_lock);
+      if (resampler_quit)
+         break;
+      slock_unlock(resampler_lock);
+
+      full = resample_pending();
+
+      slock_lock(resampler_lock);
+      resampler_busy = 0;
+      /* frames the producer wrote while it saw resampler_busy set, which
+       * resample_pending may have missed: go again. A full out_ring is left
+       * to flush_audio_libretro. */
+      AUDIO_BARRIER();
+      if (!full && ring_fill(in_ring))
+         resampler_busy = 1;
+      else
+         scond_signal(resampler_idle);
+   }
+   slock_unlock(resampler_lock);
+}
+
+static void stop_resampler_thread(void)
+{
+   if (resampler_thread == NULL)
+      return;
+
+   slock_lock(resampler_lock);
+   resampler_quit = 1;
+   scond_signal(resampler_work);
+   slock_unlock(resampler_lock);
+   sthread_join(resampler_thread);
+   scond_free(resampler_idle);
+   scond_free(resampler_work);
+   slock_free(resampler_lock);
+
+   resampler_thread = NULL;
+   resampler_quit   = 0;
+   resampler_busy   = 0;
+}
+
+static void start_resampler_thread(void)
+{
+   /* it would only take turns with the emulation */
+   if (cpu_features_get_core_amount() < 2)
+      return;
+
+   resampler_lock  = slock_new();
+   resampler_work  = scond_new();
+   resampler_idle  = scond_new();
+   if (resampler_lock && resampler_work && resampler_idle)
+      resampler_thread = sthread_create(resampler_thread_main, NULL);
+
+   /* resample in flush_audio_libretro then */
+   if (resampler_thread == NULL)
+   {
+      scond_free(resampler_idle);
+      scond_free(resampler_work);
+      slock_free(resampler_lock);
+   }
+}
+
 void deinit_audio_libretro(void)
 {
+   stop_resampler_thread();
+
    if (resampler && resampler_audio_data)
    {
       resampler->free(resampler_audio_data);
@@ -73,10 +317,14 @@ void deinit_audio_libretro(void)
       free(audio_in_buffer_float);
       free(audio_out_buffer_float);
       free(audio_out_buffer_s16);
+      free(in_ring);
+      free(out_ring);
+      in_ring  = NULL;
+      out_ring = NULL;
    }
 }
 
-void init_audio_libretro(unsigned max_audio_frames)
+void init_audio_libretro(unsigned max_audio_frames, int threaded)
 {
    retro_resampler_realloc(&resampler_audio_data, &resampler, "sinc", RESAMPLER_QUALITY_DONTCARE, 1.0);
 
@@ -85,9 +333,144 @@ void init_audio_libretro(unsigned max_audio_frames)
    audio_in_buffer_float  = malloc(2 * MAX_AUDIO_FRAMES * sizeof(float));
    audio_out_buffer_float = malloc(2 * MAX_AUDIO_FRAMES * sizeof(float));
    audio_out_buffer_s16   = malloc(2 * MAX_AUDIO_FRAMES * sizeof(int16_t));
+   in_ring                = calloc(1, sizeof(*in_ring));
+   out_ring               = calloc(1, sizeof(*out_ring));
+
+   resample_ratio  = OUTPUT_FREQ / GameFreq;
+   frame_remainder = 0.0;
+   out_primed      = 0;
+   audio_direct    = !threaded;
+   memset(&stats, 0, sizeof(stats));
 
    convert_s16_to_float_init_simd();
    convert_float_to_s16_init_simd();
+
+   if (threaded)
+      start_resampler_thread();
+}
+
+/* Waits for the thread to be done with the rings, see flush_audio_libretro. */
+static void wait_resampler_idle(void)
+{
+   if (!resampler_thread)
+      return;
+
+   slock_lock(resampler_lock);
+   while (resampler_busy)
+      scond_wait(resampler_idle, resampler_lock);
+   slock_unlock(resampler_lock);
+}
+
+void reset_audio_libretro(void)
+{
+   if (!in_ring || !out_ring)
+      return;
+
+   wait_resampler_idle();
+
+   in_ring->head   = in_ring->tail  = 0;
+   out_ring->head  = out_ring->tail = 0;
+   resample_ratio  = OUTPUT_FREQ / GameFreq;
+   frame_remainder = 0.0;
+   out_primed      = 0;
+   stats.fill      = 0;
+}
+
+/* Hands out all of out_ring. */
+static void flush_audio_direct(void)
+{
+   size_t left = ring_fill(out_ring);
+
+   while (left)
+   {
+      size_t chunk       = left;
+      const int16_t *out = ring_peek(out_ring, &chunk);
+      size_t ret         = audio_batch_cb(out, chunk);
+
+      ring_read(out_ring, ret);
+      left -= ret;
+   }
+}
+
+void flush_audio_libretro(void)
+{
+   double frame_frames, target, direction;
+   size_t frames, fill;
+
+   if (!resampler || !in_ring || !out_ring)
+      return;
+
+   /* the thread only runs while resampler_busy is set, which only the
+    * producer (this thread) sets: once it is clear, in_ring and out_ring
+    * are ours */
+   wait_resampler_idle();
+   if (audio_direct)
+      resample_ratio = OUTPUT_FREQ / GameFreq;
+   resample_pending();
+
+   if (audio_direct)
+   {
+      flush_audio_direct();
+      stats.frames++;
+      stats.fill  = 0;
+      stats.ratio = resample_ratio;
+      return;
+   }
+
+   frame_frames    = frame_remainder + OUTPUT_FREQ / vi_expected_refresh_rate_from_tv_standard(ROM_PARAMS.systemtype);
+   frames          = (size_t)frame_frames;
+   frame_remainder = frame_frames - frames;
+   target          = AUDIO_TARGET_FILL * frames;
+   fill            = ring_fill(out_ring);
+
+   /* wait for the reserve before starting, and again after running dry,
+    * instead of handing out every frame of audio as it comes */
+   if (!out_primed && fill >= target + frames)
+      out_primed = 1;
+   else if (out_primed && fill < frames)
+   {
+      out_primed = 0;
+      stats.underruns++;
+   }
+
+   if (out_primed)
+   {
+      size_t left = frames;
+      while (left)
+      {
+         size_t chunk      = left;
+         const int16_t *out = ring_peek(out_ring, &chunk);
+
+         while (chunk)
+         {
+            size_t ret = audio_batch_cb(out, chunk);
+            ring_read(out_ring, ret);
+            out   += ret * 2;
+            chunk -= ret;
+            left  -= ret;
+         }
+      }
+      fill -= frames;
+   }
+
+   stats.frames++;
+   stats.fill = (unsigned)fill;
+   if (stats.max_fill < fill)
+      stats.max_fill = (unsigned)fill;
+
+   /* rate control for the next frame */
+   direction = (target - (double)fill) / target;
+   if (direction > 1.0)
+      direction = 1.0;
+   else if (direction < -1.0)
+      direction = -1.0;
+   resample_ratio = OUTPUT_FREQ / GameFreq * (1.0 + AUDIO_MAX_RATE_DELTA * direction);
+   stats.ratio    = resample_ratio;
+}
+
+void audio_libretro_get_stats(struct audio_libretro_stats *out)
+{
+   *out = stats;
 }
 
 static void aiDacrateChanged(void *user_data, unsigned int frequency, unsigned int bits)
@@ -122,14 +505,9 @@ void set_audio_format_via_libretro(void* user_data,
 
 static void aiLenChanged(void* user_data, const void* buffer, size_t size)
 {
-   size_t max_frames, remain_frames;
    uint32_t i;
-   double ratio;
-   struct resampler_data data = {0};
-   int16_t *out      = NULL;
-   int16_t *raw_data = (int16_t*)buffer;
-   size_t frames     = size / 4;
-   uint8_t *p        = (uint8_t*)buffer;
+   size_t frames = size / 4;
+   uint8_t *p    = (uint8_t*)buffer;
 
    for (i = 0; i < size; i += 4)
    {
@@ -141,40 +519,22 @@ static void aiLenChanged(void* user_data, const void* buffer, size_t size)
       p[i + 1] ^= p[i + 3];
    }
 
-audio_batch:
-   out               = NULL;
-   ratio             = 44100.0 / GameFreq;
-   max_frames        = (GameFreq > 44100) ? MAX_AUDIO_FRAMES : (size_t)(MAX_AUDIO_FRAMES / ratio - 1);
-   remain_frames     = 0;
-
-   if (frames > max_frames)
-   {
-      remain_frames = frames - max_frames;
-      frames = max_frames;
-   }
-
-   data.data_in      = audio_in_buffer_float;
-   data.data_out     = audio_out_buffer_float;
-   data.input_frames = frames;
-   data.ratio        = ratio;
+   replay_audio(buffer, size);
 
-   convert_s16_to_float(audio_in_buffer_float, raw_data, frames * 2, 1.0f);
-   resampler->process(resampler_audio_data, &data);
-   convert_float_to_s16(audio_out_buffer_s16, audio_out_buffer_float, data.output_frames * 2);
+   if (!in_ring)
+      return;
 
-   out                    = audio_out_buffer_s16;
+   stats.dropped += frames - ring_write(in_ring, (const int16_t*)buffer, frames);
 
-   while (data.output_frames)
-   {
-      size_t ret          = audio_batch_cb(out, data.output_frames);
-      data.output_frames -= ret;
-      out                += ret * 2;
-   }
-   if (remain_frames)
+   /* wake the thread up unless it is going to see the frames anyway, see
+    * resampler_thread_main */
+   AUDIO_BARRIER();
+   if (resampler_thread && !resampler_busy)
    {
-      raw_data = raw_data + frames * 2;
-      frames   = remain_frames;
-      goto audio_batch;
+      slock_lock(resampler_lock);
+      resampler_busy = 1;
+      scond_signal(resampler_work);
+      slock_unlock(resampler_lock);
    }
 }
 
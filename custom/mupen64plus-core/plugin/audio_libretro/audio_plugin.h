@@ -24,7 +24,30 @@
 
 #include <stddef.h>
 
-void init_audio_libretro(unsigned max_frames);
+struct audio_libretro_stats
+{
+   /* calls to flush_audio_libretro */
+   unsigned frames;
+   /* frames where the output ring ran dry, after holding its reserve */
+   unsigned underruns;
+   /* AI frames dropped on a full input ring */
+   unsigned long long dropped;
+   /* output frames left in the ring after the last flush, and at most */
+   unsigned fill;
+   unsigned max_fill;
+   /* resampling ratio for the next frame, with the rate control */
+   double ratio;
+};
+
+/* threaded: resample on a thread of its own, with a reserve and rate
+ * control, instead of directly in flush_audio_libretro */
+void init_audio_libretro(unsigned max_frames, int threaded);
 void deinit_audio_libretro(void);
+/* drops the audio not handed out yet, after a reset or a state load */
+void reset_audio_libretro(void);
+
+/* hands a frame of audio to audio_batch_cb, once per retro_run */
+void flush_audio_libretro(void);
+void audio_libretro_get_stats(struct audio_libretro_stats *stats);
 
 #endif
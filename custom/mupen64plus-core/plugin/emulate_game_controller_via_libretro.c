@@ -25,6 +25,7 @@
 #include "api/m64p_plugin.h"
 #include "si/game_controller.h"
 #include <libretro.h>
+#include <libretro_replay.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -461,6 +462,7 @@ EXPORT int CALL inputRomOpen(void) { return 1; }
 int egcvip_is_connected(void* opaque, enum pak_type* pak)
 {
     int channel = *(int*)opaque;
+    uint32_t connected;
 
     CONTROL* c = &Controls[channel];
 
@@ -477,7 +479,10 @@ int egcvip_is_connected(void* opaque, enum pak_type* pak)
         *pak = PAK_RUMBLE; break;
     }
 
-    return c->Present;
+    connected = replay_input(REPLAY_CONNECTED, channel, (c->Present ? 1 : 0) | (*pak << 1));
+    *pak = (enum pak_type)(connected >> 1);
+
+    return connected & 1;
 }
 
 uint32_t egcvip_get_input(void* opaque)
@@ -488,6 +493,6 @@ uint32_t egcvip_get_input(void* opaque)
     if (getKeys)
        getKeys(channel, &keys);
 
-    return keys.Value;
+    return replay_input(REPLAY_KEYS, channel, keys.Value);
 
 }
@@ -40,6 +40,7 @@
 #include "main/rom.h"
 #include "main/version.h"
 #include "memory/memory.h"
+#include "plugin/dummy_video.h"
 
 static unsigned int dummy;
 
@@ -72,6 +73,8 @@ static m64p_error EmptyGetVersionFunc(m64p_plugin_type *PluginType, int *PluginV
     EXPORT void CALL FBRead(unsigned int addr); \
     EXPORT void CALL FBWrite(unsigned int addr, unsigned int size); \
     EXPORT void CALL FBGetFrameBufferInfo(void *p); \
+    EXPORT unsigned int CALL SaveState(void *buffer, unsigned int size); \
+    EXPORT int  CALL LoadState(const void *buffer, unsigned int size); \
     \
     static const gfx_plugin_functions gfx_##X = { \
         PluginGetVersion, \
@@ -90,11 +93,35 @@ static m64p_error EmptyGetVersionFunc(m64p_plugin_type *PluginType, int *PluginV
         SetRenderingCallback, \
         FBRead, \
         FBWrite, \
-        FBGetFrameBufferInfo \
+        FBGetFrameBufferInfo, \
+        SaveState, \
+        LoadState \
     }
 
 DEFINE_GFX(gln64);
 
+static const gfx_plugin_functions gfx_dummy = {
+    dummyvideo_PluginGetVersion,
+    dummyvideo_ChangeWindow,
+    dummyvideo_InitiateGFX,
+    dummyvideo_MoveScreen,
+    dummyvideo_ProcessDList,
+    dummyvideo_ProcessRDPList,
+    dummyvideo_RomClosed,
+    dummyvideo_RomOpen,
+    dummyvideo_ShowCFB,
+    dummyvideo_UpdateScreen,
+    dummyvideo_ViStatusChanged,
+    dummyvideo_ViWidthChanged,
+    dummyvideo_ReadScreen2,
+    dummyvideo_SetRenderingCallback,
+    dummyvideo_FBRead,
+    dummyvideo_FBWrite,
+    dummyvideo_FBGetFrameBufferInfo,
+    NULL,
+    NULL
+};
+
 gfx_plugin_functions gfx;
 GFX_INFO gfx_info;
 
@@ -195,12 +222,16 @@ static m64p_error plugin_start_input(void)
         X##PluginGetVersion, \
         X##DoRspCycles, \
         X##InitiateRSP, \
-        X##RomClosed \
+        X##RomClosed, \
+        NULL, \
+        NULL \
     }
 
 DEFINE_RSP(hle);
 #ifndef VC
 DEFINE_RSP(lle);
+EXPORT void CALL lleStartRspCycles(unsigned int Cycles);
+EXPORT unsigned int CALL lleWaitRspCycles(void);
 #endif
 
 rsp_plugin_functions rsp;
@@ -242,17 +273,29 @@ static m64p_error plugin_start_rsp(void)
    return M64ERR_SUCCESS;
 }
 
+extern int gfxPlugin;
 extern int rspMode;
+extern int rspAsync;
 
 /* global functions */
 void plugin_connect_all()
 {
-   gfx = gfx_gln64;
+   if (gfxPlugin == 0)
+      gfx = gfx_gln64;
+   else
+      gfx = gfx_dummy;
    if (rspMode == 0)
       rsp = rsp_hle;
 #ifndef VC
    else
+   {
       rsp = rsp_lle;
+      if (rspAsync)
+      {
+         rsp.startRspCycles = lleStartRspCycles;
+         rsp.waitRspCycles = lleWaitRspCycles;
+      }
+   }
 #endif
    plugin_start_gfx();
    plugin_start_input();
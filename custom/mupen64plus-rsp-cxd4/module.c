@@ -21,11 +21,11 @@
 #include <windows.h>
 #endif
 
+#include <rthreads/rthreads.h>
+
 #include "../../../mupen64plus-rsp-cxd4/module.h"
 #include "../../../mupen64plus-rsp-cxd4/su.h"
 
-RSP_INFO RSP_INFO_NAME;
-
 #define RSP_CXD4_VERSION 0x0101
 
 #if defined(M64P_PLUGIN_API)
@@ -51,6 +51,7 @@ NOINLINE void update_conf(const char* source)
     CFG_HLE_AUD = 0;
     CFG_WAIT_FOR_CPU_HOST = 0;
     CFG_MEND_SEMAPHORE_LOCK = 0;
+    CFG_PREDECODE_IMEM = 1;
 }
 
 static void DebugMessage(int level, const char *message, ...)
@@ -101,7 +102,7 @@ static const char DLL_about[] =
 
 EXPORT void CALL CloseDLL(void)
 {
-    DRAM = NULL; /* so DllTest benchmark doesn't think ROM is still open */
+    rsp_current -> DRAM = NULL; /* so DllTest benchmark doesn't think ROM is still open */
     return;
 }
 
@@ -119,7 +120,7 @@ EXPORT void CALL DllConfig(p_void hParent)
     my_system("sp_cfgui");
     update_conf(CFG_FILE);
 
-    if (DMEM == IMEM || GET_RCP_REG(SP_PC_REG) % 4096 == 0x00000000)
+    if (rsp_current -> DMEM == rsp_current -> IMEM || GET_RCP_REG(SP_PC_REG) % 4096 == 0x00000000)
         return;
     export_SP_memory();
 
@@ -144,12 +145,12 @@ EXPORT u32 CALL lleDoRspCycles(u32 cycles)
 
     task_type = 0x00000000
 #ifdef USE_CLIENT_ENDIAN
-      | *((pi32)(DMEM + 0x000FC0U))
+      | *((pi32)(rsp_current -> DMEM + 0x000FC0U))
 #else
-      | (u32)DMEM[0xFC0] << 24
-      | (u32)DMEM[0xFC1] << 16
-      | (u32)DMEM[0xFC2] <<  8
-      | (u32)DMEM[0xFC3] <<  0
+      | (u32)rsp_current -> DMEM[0xFC0] << 24
+      | (u32)rsp_current -> DMEM[0xFC1] << 16
+      | (u32)rsp_current -> DMEM[0xFC2] <<  8
+      | (u32)rsp_current -> DMEM[0xFC3] <<  0
 #endif
     ;
     switch (task_type) {
@@ -158,7 +159,7 @@ EXPORT u32 CALL lleDoRspCycles(u32 cycles)
         if (CFG_HLE_GFX == 0)
             break;
 
-        if (*(pi32)(DMEM + 0xFF0) == 0x00000000)
+        if (*(pi32)(rsp_current -> DMEM + 0xFF0) == 0x00000000)
             break; /* Resident Evil 2, null task pointers */
         if (GET_RSP_INFO(ProcessDlistList) == NULL)
             { /* branch */ }
@@ -214,9 +215,12 @@ EXPORT u32 CALL lleDoRspCycles(u32 cycles)
 
 #ifdef WAIT_FOR_CPU_HOST
     for (i = 0; i < 32; i++)
-        MFC0_count[i] = 0;
+        rsp_current -> MFC0_count[i] = 0;
 #endif
-    run_task();
+    if (CFG_PREDECODE_IMEM)
+        run_task_predecoded();
+    else
+        run_task();
 
 /*
  * An optional EMMS when compiling with Intel SIMD or MMX support.
@@ -228,25 +232,152 @@ EXPORT u32 CALL lleDoRspCycles(u32 cycles)
     _mm_empty();
 #endif
 
-    if (*CR[0x4] & SP_STATUS_BROKE) /* normal exit, from executing BREAK */
+    if (*rsp_current -> CR[0x4] & SP_STATUS_BROKE) /* normal exit, from executing BREAK */
         return (cycles);
     else if (GET_RCP_REG(MI_INTR_REG) & 1) /* interrupt set by MTC0 to break */
         GET_RSP_INFO(CheckInterrupts)();
-    else if (*CR[0x7] != 0x00000000) /* semaphore lock fixes */
+    else if (*rsp_current -> CR[0x7] != 0x00000000) /* semaphore lock fixes */
         {}
 #ifdef WAIT_FOR_CPU_HOST
     else
-        MF_SP_STATUS_TIMEOUT = 16; /* From now on, wait 16 times, not 32767. */
+        rsp_current -> MF_SP_STATUS_TIMEOUT = 16; /* From now on, wait 16 times, not 32767. */
 #else
     else { /* ??? unknown, possibly external intervention from CPU memory map */
         message("SP_SET_HALT");
         return (cycles);
     }
 #endif
-    *CR[0x4] &= ~SP_STATUS_HALT; /* CPU restarts with the correct SIGs. */
+    *rsp_current -> CR[0x4] &= ~SP_STATUS_HALT; /* CPU restarts with the correct SIGs. */
     return (cycles);
 }
 
+/*
+ * asynchronous tasks
+ *
+ * lleStartRspCycles() runs lleDoRspCycles() on a worker thread, in a context
+ * of its own which takes over the state of the main one for the length of
+ * the task.  Both share DMEM, IMEM and the SP registers, so the caller must
+ * leave these alone until lleWaitRspCycles() returns.  The CPU may keep
+ * raising other interrupts meanwhile, so the worker sets MI_INTR_REG in a
+ * private copy, which lleWaitRspCycles() returns to the caller rather than
+ * merging it into the real register.
+ */
+enum {
+    TASK_IDLE,
+    TASK_RUNNING,
+    TASK_DONE,
+    TASK_QUIT
+};
+
+static RSP_CONTEXT task_context;
+static u32 task_MI_INTR_REG;
+static u32 task_cycles;
+static int task_state = TASK_IDLE;
+static sthread_t* task_thread;
+static slock_t* task_lock;
+static scond_t* task_cond;
+
+static void task_check_interrupts(void)
+{
+    return; /* MI_INTR_REG is only looked at once the task is waited for. */
+}
+
+static void task_thread_main(void* data)
+{
+    rsp_context_make_current(&task_context);
+
+    slock_lock(task_lock);
+    for (;;) {
+        while (task_state != TASK_RUNNING && task_state != TASK_QUIT)
+            scond_wait(task_cond, task_lock);
+        if (task_state == TASK_QUIT)
+            break;
+        slock_unlock(task_lock);
+
+        task_cycles = lleDoRspCycles(task_cycles);
+
+        slock_lock(task_lock);
+        task_state = TASK_DONE;
+        scond_signal(task_cond);
+    }
+    slock_unlock(task_lock);
+    data = NULL; /* unused */
+    return;
+}
+
+static void task_thread_stop(void)
+{
+    if (task_thread == NULL)
+        return;
+
+    slock_lock(task_lock);
+    task_state = TASK_QUIT;
+    scond_signal(task_cond);
+    slock_unlock(task_lock);
+    sthread_join(task_thread);
+    scond_free(task_cond);
+    slock_free(task_lock);
+
+    task_thread = NULL;
+    task_state = TASK_IDLE;
+    return;
+}
+
+EXPORT u32 CALL lleWaitRspCycles(void)
+{
+    RSP_INFO info;
+    int done;
+
+    if (task_thread != NULL) {
+        slock_lock(task_lock);
+        while (task_state == TASK_RUNNING)
+            scond_wait(task_cond, task_lock);
+    }
+    done = (task_state == TASK_DONE);
+    task_state = TASK_IDLE;
+    if (task_thread != NULL)
+        slock_unlock(task_lock);
+    if (!done)
+        return 0x00000000;
+
+    info = rsp_main_context.info;
+    rsp_main_context = task_context;
+    rsp_main_context.info = info;
+    return (task_MI_INTR_REG);
+}
+
+EXPORT void CALL lleStartRspCycles(u32 cycles)
+{
+    lleWaitRspCycles();
+
+    task_context = rsp_main_context;
+    task_context.info.MI_INTR_REG = &task_MI_INTR_REG;
+    task_context.info.CheckInterrupts = task_check_interrupts;
+    task_MI_INTR_REG = 0x00000000;
+    task_cycles = cycles;
+
+    if (task_thread == NULL) {
+        task_lock = slock_new();
+        task_cond = scond_new();
+        task_thread = sthread_create(task_thread_main, NULL);
+    }
+    if (task_thread == NULL) { /* Run it now; there is nothing to wait for. */
+        scond_free(task_cond);
+        slock_free(task_lock);
+        rsp_context_make_current(&task_context);
+        task_cycles = lleDoRspCycles(task_cycles);
+        rsp_context_make_current(&rsp_main_context);
+        task_state = TASK_DONE;
+        return;
+    }
+
+    slock_lock(task_lock);
+    task_state = TASK_RUNNING;
+    scond_signal(task_cond);
+    slock_unlock(task_lock);
+    return;
+}
+
 EXPORT void CALL GetDllInfo(PLUGIN_INFO *PluginInfo)
 {
     PluginInfo -> Version = PLUGIN_API_VERSION;
@@ -263,32 +394,11 @@ EXPORT void CALL lleInitiateRSP(RSP_INFO Rsp_Info, pu32 CycleCount)
         *CycleCount = 0;
     update_conf(CFG_FILE);
 
-    RSP_INFO_NAME = Rsp_Info;
-    DRAM = GET_RSP_INFO(RDRAM);
-    if (Rsp_Info.DMEM == Rsp_Info.IMEM) /* usually dummy RSP data for testing */
+    lleWaitRspCycles();
+    rsp_context_make_current(&rsp_main_context);
+    if (rsp_context_init(&rsp_main_context, &Rsp_Info) == 0)
         return; /* DMA is not executed just because plugin initiates. */
-    DMEM = GET_RSP_INFO(DMEM);
-    IMEM = GET_RSP_INFO(IMEM);
-
-    CR[0x0] = &GET_RCP_REG(SP_MEM_ADDR_REG);
-    CR[0x1] = &GET_RCP_REG(SP_DRAM_ADDR_REG);
-    CR[0x2] = &GET_RCP_REG(SP_RD_LEN_REG);
-    CR[0x3] = &GET_RCP_REG(SP_WR_LEN_REG);
-    CR[0x4] = &GET_RCP_REG(SP_STATUS_REG);
-    CR[0x5] = &GET_RCP_REG(SP_DMA_FULL_REG);
-    CR[0x6] = &GET_RCP_REG(SP_DMA_BUSY_REG);
-    CR[0x7] = &GET_RCP_REG(SP_SEMAPHORE_REG);
     GET_RCP_REG(SP_PC_REG) = 0x04001000;
-    CR[0x8] = &GET_RCP_REG(DPC_START_REG);
-    CR[0x9] = &GET_RCP_REG(DPC_END_REG);
-    CR[0xA] = &GET_RCP_REG(DPC_CURRENT_REG);
-    CR[0xB] = &GET_RCP_REG(DPC_STATUS_REG);
-    CR[0xC] = &GET_RCP_REG(DPC_CLOCK_REG);
-    CR[0xD] = &GET_RCP_REG(DPC_BUFBUSY_REG);
-    CR[0xE] = &GET_RCP_REG(DPC_PIPEBUSY_REG);
-    CR[0xF] = &GET_RCP_REG(DPC_TMEM_REG);
-
-    MF_SP_STATUS_TIMEOUT = 32767;
 #if 1
     GET_RCP_REG(SP_PC_REG) &= 0x00000FFFu; /* hack to fix Mupen64 */
 #endif
@@ -299,6 +409,8 @@ EXPORT void CALL lleRomClosed(void)
 {
     FILE* stream;
 
+    lleWaitRspCycles();
+    task_thread_stop();
     GET_RCP_REG(SP_PC_REG) = 0x04001000;
 
 /*
@@ -414,7 +526,7 @@ NOINLINE void export_data_cache(void)
 
     DMEM_swapped = my_calloc(4096, 1);
     for (i = 0; i < 4096; i++)
-        DMEM_swapped[i] = DMEM[BES(i)];
+        DMEM_swapped[i] = rsp_current -> DMEM[BES(i)];
     out = my_fopen("rcpcache.dhex", "wb");
     my_fwrite(DMEM_swapped, 16, 4096 / 16, out);
     my_fclose(out);
@@ -430,7 +542,7 @@ NOINLINE void export_instruction_cache(void)
 
     IMEM_swapped = my_calloc(4096, 1);
     for (i = 0; i < 4096; i++)
-        IMEM_swapped[i] = IMEM[BES(i)];
+        IMEM_swapped[i] = rsp_current -> IMEM[BES(i)];
     out = my_fopen("rcpcache.ihex", "wb");
     my_fwrite(IMEM_swapped, 16, 4096 / 16, out);
     my_fclose(out);
@@ -0,0 +1,1001 @@
+/* Headless benchmark for the libretro core.
+ *
+ * Loads the core with dlopen, runs it without video output (the
+ * "mupen64plus-gfxplugin" option is set to "none", so no OpenGL context is
+ * needed) unless --gl is given, feeds scripted input and runs a number of VIs
+ * as fast as possible. Results are printed as JSON:
+ *
+ *   mupen64plus_benchmark [options] mupen64plus_libretro.so game.z64
+ *
+ *   --frames N           VIs to run (default 3600)
+ *   --rsp hle|lle        RSP plugin (default hle)
+ *   --cpu NAME           dynamic_recompiler, cached_interpreter or pure_interpreter
+ *   --input FILE         input script, see below
+ *   --option KEY=VALUE   set any other core option
+ *   --system-dir DIR     system directory given to the core (default .)
+ *   --output FILE        write the JSON there instead of stdout
+ *   --verbose            print the core log to stderr
+ *   --record-input FILE  record the input the game reads
+ *   --replay-input FILE  replay a recording instead of the input script
+ *   --state-hashes FILE  write RDRAM, CPU and audio hashes of every VI
+ *   --trace FILE         write the trace zones of the run (core built with
+ *                        TRACE=1) in the Chrome trace event format
+ *   --guest-profile FILE write the hot guest code, exceptions and interrupts
+ *                        of the run (core built with GUEST_PROFILE=1), see
+ *                        guest_profile.py
+ *   --savestates         time retro_serialize and retro_unserialize after
+ *                        the run, see below
+ *   --rdram FILE         write RDRAM after the run, where the test ROMs of
+ *                        the harnesses in this directory leave their results
+ *   --gl                 render with GLideN64 in a surfaceless EGL context,
+ *                        e.g. on Mesa llvmpipe
+ *   --frame FILE         with --gl, write the last frame presented as a PAM
+ *                        image
+ *
+ *   mupen64plus_benchmark --compare HASHES HASHES
+ *
+ * compares the state hashes of two runs, e.g. of two builds replaying the same
+ * recording, and reports the first VI where they differ. The exit status is 2
+ * when they do. Use --option mupen64plus-rsp-async=False for such runs, audio
+ * on a thread does not produce the same samples in the same VI every time.
+ *
+ * Input script: one line per input event, '#' starts a comment.
+ *
+ *   FIRST[-LAST] TOKEN...
+ *
+ * holds the tokens from VI FIRST to VI LAST (only VI FIRST if LAST is omitted)
+ * on port 1. A token is a RetroPad button (A B X Y START SELECT UP DOWN LEFT
+ * RIGHT L R L2 R2 L3 R3) or an analog axis value (LX=-32768 .. RY=32767).
+ *
+ * Time per subsystem is reported when the core is built with PROFILE=1,
+ * otherwise "sections_ns" is null. The core writes messages to stdout too,
+ * so use --output when the JSON is parsed.
+ *
+ * "input_latency_cycles" gives the emulated cycles from the poll of the input
+ * the game read to the VI presenting the frame, over the VIs where the game
+ * read the controllers. Compare --option mupen64plus-InputPoll=Early and Late.
+ *
+ * "audio_ring" gives the audio the core holds back after the run (output
+ * frames at 44.1 kHz), the most it held, the VIs where it ran dry and the AI
+ * frames it had to drop. "audio_frames" counts what it handed out.
+ *
+ * "savestate" gives the size of a state saved after the run, the time to save
+ * it (retro_serialize_size and retro_serialize, as a frontend does), to save
+ * the state of the next VI, and to load the first one back; "roundtrip" tells
+ * whether saving after the load gives the same state again. Compare --option
+ * mupen64plus-SavestateCompression=False and True. "corrupt_rejected" tells
+ * whether the state of the next VI, with a byte flipped in its middle, fails
+ * to load, and "corrupt_intact" whether the emulation is still in the state
+ * loaded before (only compressed states can tell). With --gl,
+ * "video_roundtrip" tells whether the VI run after the load presents the same
+ * frame as the VI run after the save, which needs the renderer state of
+ * GLideN64 to be carried in the state and restored.
+ *
+ * "video" gives the frames presented with --gl and a hash of the last one.
+ * "shaders" gives the combiners GLideN64 compiled while drawing and the ones
+ * it precompiled, the draws made with its uber-shader and the time drawing
+ * waited for compiles. Compare --option
+ * mupen64plus-EnableAsyncShaderCompile=False and True; UberShaderOnly draws
+ * with the uber-shader whenever it can, to test it.
+ *
+ * "frame_skip" gives the frames GLideN64 finished with frame skipping on and
+ * the ones it skipped, the frames read back to RDRAM, which hold skipping
+ * off, and the draw calls and triangles not submitted to GL. Compare --option
+ * mupen64plus-FrameSkip=Off, Auto and 1 to 3.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <sys/resource.h>
+
+#include "libretro.h"
+
+#define MAX_OPTIONS 64
+#define MAX_EVENTS  4096
+
+/* EGL and GL of the --gl mode. libEGL is loaded at run time and GL is
+ * reached through eglGetProcAddress, so the benchmark needs neither to
+ * build, and the values are those of EGL/egl.h, EGL/eglext.h and GL/glext.h. */
+#define EGL_NONE                                     0x3038
+#define EGL_OPENGL_API                               0x30A2
+#define EGL_CONTEXT_MAJOR_VERSION                    0x3098
+#define EGL_CONTEXT_MINOR_VERSION                    0x30FB
+#define EGL_CONTEXT_OPENGL_PROFILE_MASK              0x30FD
+#define EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT          0x1
+#define EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT 0x2
+#define EGL_PLATFORM_SURFACELESS_MESA                0x31DD
+
+#define GL_UNSIGNED_BYTE              0x1401
+#define GL_RGBA                       0x1908
+#define GL_RGBA8                      0x8058
+#define GL_DEPTH24_STENCIL8           0x88F0
+#define GL_PIXEL_PACK_BUFFER          0x88EB
+#define GL_PIXEL_PACK_BUFFER_BINDING  0x88ED
+#define GL_READ_FRAMEBUFFER           0x8CA8
+#define GL_READ_FRAMEBUFFER_BINDING   0x8CAA
+#define GL_FRAMEBUFFER_COMPLETE       0x8CD5
+#define GL_COLOR_ATTACHMENT0          0x8CE0
+#define GL_DEPTH_STENCIL_ATTACHMENT   0x821A
+#define GL_FRAMEBUFFER                0x8D40
+#define GL_RENDERBUFFER               0x8D41
+
+/* enum timed_section of main/profile.h */
+enum
+{
+   SECTION_ALL,
+   SECTION_GFX,
+   SECTION_AUDIO,
+   SECTION_COMPILER,
+   SECTION_IDLE,
+   NUM_SECTIONS
+};
+
+struct option_value
+{
+   const char *key;
+   const char *value;
+};
+
+struct input_event
+{
+   unsigned first, last;
+   unsigned buttons;
+   int analog[2][2];
+   unsigned analog_set;     /* bit index * 2 + axis */
+};
+
+static struct option_value options[MAX_OPTIONS];
+static unsigned num_options;
+
+static struct input_event events[MAX_EVENTS];
+static unsigned num_events;
+
+static const char *system_dir = ".";
+static int verbose;
+static unsigned current_frame;
+static unsigned long long audio_frames;
+
+static struct
+{
+   bool enabled;
+   struct retro_hw_render_callback hw_render;
+   void *(*get_proc_address)(const char *);
+   unsigned framebuffer;
+   unsigned frames;             /* frames the core presented */
+   unsigned long long hash;     /* of the last one */
+   unsigned width, height;      /* of the last one, in pixels */
+   unsigned char *pixels;       /* of the last one, bottom row first */
+   size_t pixels_size;
+
+   void (*GenFramebuffers)(int, unsigned *);
+   void (*BindFramebuffer)(unsigned, unsigned);
+   void (*FramebufferRenderbuffer)(unsigned, unsigned, unsigned, unsigned);
+   unsigned (*CheckFramebufferStatus)(unsigned);
+   void (*GenRenderbuffers)(int, unsigned *);
+   void (*BindRenderbuffer)(unsigned, unsigned);
+   void (*RenderbufferStorage)(unsigned, unsigned, int, int);
+   void (*BindBuffer)(unsigned, unsigned);
+   void (*GetIntegerv)(unsigned, int *);
+   void (*ReadPixels)(int, int, int, int, unsigned, unsigned, void *);
+} gl;
+
+static const struct
+{
+   const char *name;
+   unsigned id;
+} button_names[] = {
+   { "B", RETRO_DEVICE_ID_JOYPAD_B },
+   { "Y", RETRO_DEVICE_ID_JOYPAD_Y },
+   { "SELECT", RETRO_DEVICE_ID_JOYPAD_SELECT },
+   { "START", RETRO_DEVICE_ID_JOYPAD_START },
+   { "UP", RETRO_DEVICE_ID_JOYPAD_UP },
+   { "DOWN", RETRO_DEVICE_ID_JOYPAD_DOWN },
+   { "LEFT", RETRO_DEVICE_ID_JOYPAD_LEFT },
+   { "RIGHT", RETRO_DEVICE_ID_JOYPAD_RIGHT },
+   { "A", RETRO_DEVICE_ID_JOYPAD_A },
+   { "X", RETRO_DEVICE_ID_JOYPAD_X },
+   { "L", RETRO_DEVICE_ID_JOYPAD_L },
+   { "R", RETRO_DEVICE_ID_JOYPAD_R },
+   { "L2", RETRO_DEVICE_ID_JOYPAD_L2 },
+   { "R2", RETRO_DEVICE_ID_JOYPAD_R2 },
+   { "L3", RETRO_DEVICE_ID_JOYPAD_L3 },
+   { "R3", RETRO_DEVICE_ID_JOYPAD_R3 },
+};
+
+static void die(const char *fmt, ...)
+{
+   va_list args;
+   va_start(args, fmt);
+   fprintf(stderr, "benchmark: ");
+   vfprintf(stderr, fmt, args);
+   fprintf(stderr, "\n");
+   va_end(args);
+   exit(1);
+}
+
+static void set_option(const char *key, const char *value)
+{
+   unsigned i;
+   for (i = 0; i < num_options; i++)
+   {
+      if (!strcmp(options[i].key, key))
+      {
+         options[i].value = value;
+         return;
+      }
+   }
+   if (num_options == MAX_OPTIONS)
+      die("too many options");
+   options[num_options].key = key;
+   options[num_options].value = value;
+   num_options++;
+}
+
+static const char *get_option(const char *key)
+{
+   unsigned i;
+   for (i = 0; i < num_options; i++)
+      if (!strcmp(options[i].key, key))
+         return options[i].value;
+   return NULL;
+}
+
+static void parse_token(struct input_event *event, const char *token, const char *file, unsigned line)
+{
+   unsigned i;
+
+   if ((token[0] == 'L' || token[0] == 'R') && (token[1] == 'X' || token[1] == 'Y') && token[2] == '=')
+   {
+      const unsigned index = token[0] == 'L' ? RETRO_DEVICE_INDEX_ANALOG_LEFT : RETRO_DEVICE_INDEX_ANALOG_RIGHT;
+      const unsigned axis = token[1] == 'X' ? RETRO_DEVICE_ID_ANALOG_X : RETRO_DEVICE_ID_ANALOG_Y;
+      const long value = strtol(token + 3, NULL, 0);
+      if (value < -32768 || value > 32767)
+         die("%s:%u: analog value out of range: %s", file, line, token);
+      event->analog[index][axis] = (int)value;
+      event->analog_set |= 1 << (index * 2 + axis);
+      return;
+   }
+
+   for (i = 0; i < sizeof(button_names) / sizeof(button_names[0]); i++)
+   {
+      if (!strcmp(token, button_names[i].name))
+      {
+         event->buttons |= 1 << button_names[i].id;
+         return;
+      }
+   }
+   die("%s:%u: unknown input: %s", file, line, token);
+}
+
+static void load_input_script(const char *file)
+{
+   char buf[1024];
+   unsigned line = 0;
+   FILE *fp = fopen(file, "r");
+   if (!fp)
+      die("cannot open %s", file);
+
+   while (fgets(buf, sizeof(buf), fp))
+   {
+      struct input_event *event;
+      char *token, *end;
+      char *comment = strchr(buf, '#');
+
+      line++;
+      if (comment)
+         *comment = '\0';
+      token = strtok(buf, " \t\r\n");
+      if (!token)
+         continue;
+
+      if (num_events == MAX_EVENTS)
+         die("%s: too many input events", file);
+      event = &events[num_events++];
+      memset(event, 0, sizeof(*event));
+      event->first = (unsigned)strtoul(token, &end, 10);
+      event->last = event->first;
+      if (*end == '-')
+         event->last = (unsigned)strtoul(end + 1, &end, 10);
+      if (*end != '\0' || event->last < event->first)
+         die("%s:%u: bad frame range: %s", file, line, token);
+
+      while ((token = strtok(NULL, " \t\r\n")))
+         parse_token(event, token, file, line);
+   }
+   fclose(fp);
+}
+
+static void core_log(enum retro_log_level level, const char *fmt, ...)
+{
+   va_list args;
+   if (!verbose)
+      return;
+   va_start(args, fmt);
+   vfprintf(stderr, fmt, args);
+   va_end(args);
+}
+
+static uintptr_t gl_current_framebuffer(void)
+{
+   return gl.framebuffer;
+}
+
+static retro_proc_address_t gl_proc_address(const char *sym)
+{
+   return (retro_proc_address_t)gl.get_proc_address(sym);
+}
+
+static bool environment(unsigned cmd, void *data)
+{
+   switch (cmd)
+   {
+      case RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY:
+      case RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY:
+         *(const char **)data = system_dir;
+         return true;
+      case RETRO_ENVIRONMENT_GET_LOG_INTERFACE:
+         ((struct retro_log_callback *)data)->log = core_log;
+         return true;
+      case RETRO_ENVIRONMENT_GET_VARIABLE:
+      {
+         struct retro_variable *var = (struct retro_variable *)data;
+         var->value = get_option(var->key);
+         return var->value != NULL;
+      }
+      case RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE:
+         *(bool *)data = false;
+         return true;
+      case RETRO_ENVIRONMENT_SET_HW_RENDER:
+      {
+         struct retro_hw_render_callback *hw_render = (struct retro_hw_render_callback *)data;
+         if (!gl.enabled || (hw_render->context_type != RETRO_HW_CONTEXT_OPENGL
+               && hw_render->context_type != RETRO_HW_CONTEXT_OPENGL_CORE))
+            return false;
+         hw_render->get_current_framebuffer = gl_current_framebuffer;
+         hw_render->get_proc_address = gl_proc_address;
+         gl.hw_render = *hw_render;
+         return true;
+      }
+      case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
+      case RETRO_ENVIRONMENT_SET_VARIABLES:
+      case RETRO_ENVIRONMENT_SET_CONTROLLER_INFO:
+      case RETRO_ENVIRONMENT_SET_INPUT_DESCRIPTORS:
+      case RETRO_ENVIRONMENT_SET_MESSAGE:
+      case RETRO_ENVIRONMENT_SET_SERIALIZATION_QUIRKS:
+         return true;
+      default:
+         return false;
+   }
+}
+
+static void egl_symbol(void *egl, void *fn, const char *name)
+{
+   if (!(*(void **)fn = dlsym(egl, name)))
+      die("libEGL does not export %s", name);
+}
+
+static void gl_symbol(void *fn, const char *name)
+{
+   if (!(*(void **)fn = gl.get_proc_address(name)))
+      die("no %s in the GL context", name);
+}
+
+/* Makes a surfaceless EGL context of the kind the core asked for current,
+ * with a frame buffer of the given size to render to. */
+static void gl_init(unsigned width, unsigned height)
+{
+   void *(*get_platform_display)(unsigned, void *, const int *);
+   unsigned (*initialize)(void *, int *, int *);
+   unsigned (*bind_api)(unsigned);
+   void *(*create_context)(void *, void *, void *, const int *);
+   unsigned (*make_current)(void *, void *, void *, void *);
+   const bool core_profile = gl.hw_render.context_type == RETRO_HW_CONTEXT_OPENGL_CORE;
+   int attribs[] = {
+      EGL_CONTEXT_MAJOR_VERSION, core_profile ? (int)gl.hw_render.version_major : 3,
+      EGL_CONTEXT_MINOR_VERSION, core_profile ? (int)gl.hw_render.version_minor : 3,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK,
+      core_profile ? EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT : EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+      EGL_NONE
+   };
+   unsigned renderbuffers[2];
+   void *display, *context;
+   void *egl = dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+
+   if (!egl)
+      die("cannot load libEGL.so.1: %s", dlerror());
+   egl_symbol(egl, &gl.get_proc_address, "eglGetProcAddress");
+   egl_symbol(egl, &initialize, "eglInitialize");
+   egl_symbol(egl, &bind_api, "eglBindAPI");
+   egl_symbol(egl, &create_context, "eglCreateContext");
+   egl_symbol(egl, &make_current, "eglMakeCurrent");
+   gl_symbol(&get_platform_display, "eglGetPlatformDisplayEXT");
+
+   display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, NULL, NULL);
+   if (!display || !initialize(display, NULL, NULL) || !bind_api(EGL_OPENGL_API))
+      die("cannot initialize a surfaceless EGL display");
+   /* EGL_KHR_no_config_context and EGL_KHR_surfaceless_context */
+   context = create_context(display, NULL, NULL, attribs);
+   if (!context || !make_current(display, NULL, NULL, context))
+      die("cannot make a GL context current");
+
+   gl_symbol(&gl.GenFramebuffers, "glGenFramebuffers");
+   gl_symbol(&gl.BindFramebuffer, "glBindFramebuffer");
+   gl_symbol(&gl.FramebufferRenderbuffer, "glFramebufferRenderbuffer");
+   gl_symbol(&gl.CheckFramebufferStatus, "glCheckFramebufferStatus");
+   gl_symbol(&gl.GenRenderbuffers, "glGenRenderbuffers");
+   gl_symbol(&gl.BindRenderbuffer, "glBindRenderbuffer");
+   gl_symbol(&gl.RenderbufferStorage, "glRenderbufferStorage");
+   gl_symbol(&gl.BindBuffer, "glBindBuffer");
+   gl_symbol(&gl.GetIntegerv, "glGetIntegerv");
+   gl_symbol(&gl.ReadPixels, "glReadPixels");
+
+   gl.GenRenderbuffers(2, renderbuffers);
+   gl.BindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+   gl.RenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+   gl.BindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+   gl.RenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+   gl.GenFramebuffers(1, &gl.framebuffer);
+   gl.BindFramebuffer(GL_FRAMEBUFFER, gl.framebuffer);
+   gl.FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+   gl.FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+   if (gl.CheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+      die("cannot make a %ux%u frame buffer", width, height);
+}
+
+static void video_refresh(const void *data, unsigned width, unsigned height, size_t pitch)
+{
+   const size_t size = (size_t)width * height * 4;
+   unsigned long long hash = 0xcbf29ce484222325ULL;
+   int framebuffer, pack_buffer;
+   size_t i;
+
+   if (data != RETRO_HW_FRAME_BUFFER_VALID)
+      return;
+
+   /* FNV-1a of the frame, read without disturbing the state of the core */
+   if (size > gl.pixels_size)
+   {
+      gl.pixels = realloc(gl.pixels, size);
+      if (!gl.pixels)
+         die("out of memory");
+      gl.pixels_size = size;
+   }
+   gl.GetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &framebuffer);
+   gl.GetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &pack_buffer);
+   gl.BindFramebuffer(GL_READ_FRAMEBUFFER, gl.framebuffer);
+   gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+   gl.ReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, gl.pixels);
+   gl.BindBuffer(GL_PIXEL_PACK_BUFFER, pack_buffer);
+   gl.BindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+
+   for (i = 0; i < size; i++)
+      hash = (hash ^ gl.pixels[i]) * 0x100000001b3ULL;
+   gl.hash = hash;
+   gl.width = width;
+   gl.height = height;
+   gl.frames++;
+}
+
+static size_t audio_sample_batch(const int16_t *data, size_t frames)
+{
+   audio_frames += frames;
+   return frames;
+}
+
+static void input_poll(void)
+{
+}
+
+static int16_t input_state(unsigned port, unsigned device, unsigned index, unsigned id)
+{
+   unsigned i;
+   int16_t result = 0;
+
+   if (port != 0)
+      return 0;
+
+   for (i = 0; i < num_events; i++)
+   {
+      const struct input_event *event = &events[i];
+      if (current_frame < event->first || current_frame > event->last)
+         continue;
+      if (device == RETRO_DEVICE_JOYPAD && id < 16 && (event->buttons & (1 << id)))
+         result = 1;
+      else if (device == RETRO_DEVICE_ANALOG && index < 2 && id < 2 && (event->analog_set & (1 << (index * 2 + id))))
+         result = (int16_t)event->analog[index][id];
+   }
+   return result;
+}
+
+static void *load_file(const char *path, size_t *size)
+{
+   void *data;
+   long length;
+   FILE *fp = fopen(path, "rb");
+   if (!fp)
+      die("cannot open %s", path);
+   fseek(fp, 0, SEEK_END);
+   length = ftell(fp);
+   fseek(fp, 0, SEEK_SET);
+   data = malloc(length);
+   if (!data || fread(data, 1, length, fp) != (size_t)length)
+      die("cannot read %s", path);
+   fclose(fp);
+   *size = (size_t)length;
+   return data;
+}
+
+static void *core_symbol(void *core, const char *name)
+{
+   void *sym = dlsym(core, name);
+   if (!sym)
+      die("core does not export %s", name);
+   return sym;
+}
+
+static double now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void print_string(FILE *out, const char *str)
+{
+   fputc('"', out);
+   for (; *str; str++)
+   {
+      if (*str == '"' || *str == '\\')
+         fputc('\\', out);
+      if ((unsigned char)*str < 0x20)
+         fprintf(out, "\\u%04x", *str);
+      else
+         fputc(*str, out);
+   }
+   fputc('"', out);
+}
+
+static FILE *open_hashes(const char *path)
+{
+   FILE *fp = fopen(path, "r");
+   if (!fp)
+      die("cannot open %s", path);
+   return fp;
+}
+
+static int read_hashes(FILE *fp, unsigned *frame, unsigned long long hashes[3])
+{
+   char line[256];
+   while (fgets(line, sizeof(line), fp))
+   {
+      if (line[0] == '#')
+         continue;
+      if (sscanf(line, "%u %llx %llx %llx", frame, &hashes[0], &hashes[1], &hashes[2]) == 4)
+         return 1;
+   }
+   return 0;
+}
+
+static int compare_hashes(const char *path_a, const char *path_b, FILE *out)
+{
+   static const char *names[3] = { "rdram", "cpu", "audio" };
+   unsigned long long a[3], b[3];
+   unsigned frame_a, frame_b, frames = 0;
+   FILE *fa = open_hashes(path_a);
+   FILE *fb = open_hashes(path_b);
+   int diverged = 0;
+   int i;
+
+   while (read_hashes(fa, &frame_a, a) && read_hashes(fb, &frame_b, b))
+   {
+      if (frame_a != frame_b)
+         die("%s and %s do not have the same frames", path_a, path_b);
+      if (a[0] != b[0] || a[1] != b[1] || a[2] != b[2])
+      {
+         diverged = 1;
+         break;
+      }
+      frames++;
+   }
+   fclose(fa);
+   fclose(fb);
+
+   fprintf(out, "{\n  \"frames_compared\": %u,\n  \"first_divergence\": ", frames);
+   if (diverged)
+   {
+      fprintf(out, "{\"frame\": %u", frame_a);
+      for (i = 0; i < 3; i++)
+         fprintf(out, ", \"%s\": %s", names[i], a[i] != b[i] ? "true" : "false");
+      fprintf(out, "}\n}\n");
+   }
+   else
+      fprintf(out, "null\n}\n");
+
+   return diverged ? 2 : 0;
+}
+
+static void usage(void)
+{
+   fprintf(stderr,
+      "usage: mupen64plus_benchmark [--frames N] [--rsp hle|lle] [--cpu NAME] [--input FILE]\n"
+      "                             [--option KEY=VALUE]... [--system-dir DIR] [--output FILE]\n"
+      "                             [--record-input FILE] [--replay-input FILE] [--state-hashes FILE]\n"
+      "                             [--trace FILE] [--guest-profile FILE] [--savestates]\n"
+      "                             [--rdram FILE] [--gl] [--frame FILE]\n"
+      "                             [--verbose] CORE ROM\n"
+      "       mupen64plus_benchmark --compare HASHES HASHES\n");
+   exit(1);
+}
+
+int main(int argc, char **argv)
+{
+   void (*core_set_environment)(retro_environment_t);
+   void (*core_set_video_refresh)(retro_video_refresh_t);
+   void (*core_set_audio_sample_batch)(retro_audio_sample_batch_t);
+   void (*core_set_input_poll)(retro_input_poll_t);
+   void (*core_set_input_state)(retro_input_state_t);
+   void (*core_init)(void);
+   void (*core_deinit)(void);
+   bool (*core_load_game)(const struct retro_game_info *);
+   void (*core_unload_game)(void);
+   void (*core_run)(void);
+   void (*core_get_system_info)(struct retro_system_info *);
+   void (*core_get_system_av_info)(struct retro_system_av_info *);
+   bool (*core_get_timed_sections)(long long int *, unsigned);
+   bool (*core_get_input_latency)(unsigned *, unsigned long long *, unsigned *);
+   bool (*core_get_audio_stats)(unsigned *, unsigned *, unsigned *, unsigned long long *);
+   bool (*core_get_shader_stats)(unsigned *, unsigned *, unsigned *, double *, double *);
+   bool (*core_get_frame_skip_stats)(unsigned *, unsigned *, unsigned *, unsigned long long *, unsigned long long *);
+   bool (*core_trace_dump)(const char *);
+   bool (*core_guest_profile_dump)(const char *);
+   size_t (*core_serialize_size)(void);
+   bool (*core_serialize)(void *, size_t);
+   bool (*core_unserialize)(const void *, size_t);
+   void *(*core_get_memory_data)(unsigned);
+   size_t (*core_get_memory_size)(unsigned);
+
+   const char *core_path = NULL, *rom_path = NULL, *output_path = NULL, *trace_path = NULL;
+   const char *guest_profile_path = NULL, *rdram_path = NULL, *frame_path = NULL;
+   unsigned frames = 3600;
+   long long int sections[NUM_SECTIONS];
+   bool have_sections = false;
+   unsigned latency_frames = 0, latency_max = 0;
+   unsigned long long latency_cycles = 0;
+   bool have_latency = false;
+   unsigned audio_fill = 0, audio_max_fill = 0, audio_underruns = 0;
+   unsigned long long audio_dropped = 0;
+   bool have_audio_stats = false;
+   unsigned shaders_compiled = 0, shaders_precompiled = 0, uber_shader_uses = 0;
+   double shader_stall_ms = 0.0, shader_max_stall_ms = 0.0;
+   bool have_shader_stats = false;
+   unsigned skip_frames = 0, skipped_frames = 0, skip_readbacks = 0;
+   unsigned long long skipped_draw_calls = 0, skipped_triangles = 0;
+   bool have_frame_skip_stats = false;
+   bool savestates = false, roundtrip = false;
+   bool corrupt_rejected = false, corrupt_intact = false, video_roundtrip = false;
+   size_t state_size = 0;
+   double save_ms = 0.0, save_next_ms = 0.0, load_ms = 0.0;
+   struct retro_system_info info;
+   struct retro_game_info game;
+   struct rusage usage_info;
+   double start, elapsed;
+   FILE *out = stdout;
+   void *core;
+   int i;
+
+   set_option("mupen64plus-gfxplugin", "none");
+   set_option("mupen64plus-rspmode", "HLE");
+
+   if (argc == 4 && !strcmp(argv[1], "--compare"))
+      return compare_hashes(argv[2], argv[3], stdout);
+
+   for (i = 1; i < argc; i++)
+   {
+      const char *arg = argv[i];
+      if (!strcmp(arg, "--verbose"))
+         verbose = 1;
+      else if (!strcmp(arg, "--savestates"))
+         savestates = true;
+      else if (!strcmp(arg, "--gl"))
+      {
+         gl.enabled = true;
+         set_option("mupen64plus-gfxplugin", "gliden64");
+      }
+      else if (arg[0] == '-' && arg[1] == '-' && i + 1 < argc)
+      {
+         const char *value = argv[++i];
+         if (!strcmp(arg, "--frames"))
+            frames = (unsigned)strtoul(value, NULL, 10);
+         else if (!strcmp(arg, "--rsp"))
+         {
+            if (!strcmp(value, "hle"))
+               set_option("mupen64plus-rspmode", "HLE");
+            else if (!strcmp(value, "lle"))
+               set_option("mupen64plus-rspmode", "LLE");
+            else
+               usage();
+         }
+         else if (!strcmp(arg, "--cpu"))
+            set_option("mupen64plus-cpucore", value);
+         else if (!strcmp(arg, "--input"))
+            load_input_script(value);
+         else if (!strcmp(arg, "--system-dir"))
+            system_dir = value;
+         else if (!strcmp(arg, "--output"))
+            output_path = value;
+         else if (!strcmp(arg, "--record-input"))
+            set_option("mupen64plus-record-input", value);
+         else if (!strcmp(arg, "--replay-input"))
+            set_option("mupen64plus-replay-input", value);
+         else if (!strcmp(arg, "--state-hashes"))
+            set_option("mupen64plus-state-hashes", value);
+         else if (!strcmp(arg, "--trace"))
+            trace_path = value;
+         else if (!strcmp(arg, "--guest-profile"))
+            guest_profile_path = value;
+         else if (!strcmp(arg, "--rdram"))
+            rdram_path = value;
+         else if (!strcmp(arg, "--frame"))
+            frame_path = value;
+         else if (!strcmp(arg, "--option"))
+         {
+            char *eq = strchr(argv[i], '=');
+            if (!eq)
+               usage();
+            *eq = '\0';
+            set_option(argv[i], eq + 1);
+         }
+         else
+            usage();
+      }
+      else if (!core_path)
+         core_path = arg;
+      else if (!rom_path)
+         rom_path = arg;
+      else
+         usage();
+   }
+   if (!rom_path || frames == 0 || (frame_path && !gl.enabled))
+      usage();
+
+   core = dlopen(core_path, RTLD_NOW | RTLD_LOCAL);
+   if (!core)
+      die("cannot load %s: %s", core_path, dlerror());
+
+   *(void **)&core_set_environment = core_symbol(core, "retro_set_environment");
+   *(void **)&core_set_video_refresh = core_symbol(core, "retro_set_video_refresh");
+   *(void **)&core_set_audio_sample_batch = core_symbol(core, "retro_set_audio_sample_batch");
+   *(void **)&core_set_input_poll = core_symbol(core, "retro_set_input_poll");
+   *(void **)&core_set_input_state = core_symbol(core, "retro_set_input_state");
+   *(void **)&core_init = core_symbol(core, "retro_init");
+   *(void **)&core_deinit = core_symbol(core, "retro_deinit");
+   *(void **)&core_load_game = core_symbol(core, "retro_load_game");
+   *(void **)&core_unload_game = core_symbol(core, "retro_unload_game");
+   *(void **)&core_run = core_symbol(core, "retro_run");
+   *(void **)&core_get_system_info = core_symbol(core, "retro_get_system_info");
+   *(void **)&core_get_system_av_info = core_symbol(core, "retro_get_system_av_info");
+   *(void **)&core_serialize_size = core_symbol(core, "retro_serialize_size");
+   *(void **)&core_serialize = core_symbol(core, "retro_serialize");
+   *(void **)&core_unserialize = core_symbol(core, "retro_unserialize");
+   *(void **)&core_get_memory_data = core_symbol(core, "retro_get_memory_data");
+   *(void **)&core_get_memory_size = core_symbol(core, "retro_get_memory_size");
+   *(void **)&core_get_timed_sections = dlsym(core, "retro_get_timed_sections");
+   *(void **)&core_get_input_latency = dlsym(core, "retro_get_input_latency");
+   *(void **)&core_get_audio_stats = dlsym(core, "retro_get_audio_stats");
+   *(void **)&core_get_shader_stats = dlsym(core, "retro_get_shader_stats");
+   *(void **)&core_get_frame_skip_stats = dlsym(core, "retro_get_frame_skip_stats");
+   *(void **)&core_trace_dump = dlsym(core, "retro_trace_dump");
+   *(void **)&core_guest_profile_dump = dlsym(core, "retro_guest_profile_dump");
+
+   core_set_environment(environment);
+   core_set_video_refresh(video_refresh);
+   core_set_audio_sample_batch(audio_sample_batch);
+   core_set_input_poll(input_poll);
+   core_set_input_state(input_state);
+   core_init();
+   core_get_system_info(&info);
+
+   memset(&game, 0, sizeof(game));
+   game.path = rom_path;
+   game.data = load_file(rom_path, &game.size);
+   if (!core_load_game(&game))
+      die("cannot load %s", rom_path);
+   if (gl.enabled)
+   {
+      struct retro_system_av_info av_info;
+
+      if (!gl.hw_render.context_reset)
+         die("the core did not ask for a GL context");
+      core_get_system_av_info(&av_info);
+      gl_init(av_info.geometry.max_width, av_info.geometry.max_height);
+      gl.hw_render.context_reset();
+   }
+
+   start = now();
+   for (current_frame = 0; current_frame < frames; current_frame++)
+      core_run();
+   elapsed = now() - start;
+
+   if (core_get_timed_sections)
+      have_sections = core_get_timed_sections(sections, NUM_SECTIONS);
+   if (core_get_input_latency)
+      have_latency = core_get_input_latency(&latency_frames, &latency_cycles, &latency_max);
+   if (core_get_audio_stats)
+      have_audio_stats = core_get_audio_stats(&audio_fill, &audio_max_fill, &audio_underruns, &audio_dropped);
+   if (core_get_shader_stats)
+      have_shader_stats = core_get_shader_stats(&shaders_compiled, &shaders_precompiled, &uber_shader_uses,
+         &shader_stall_ms, &shader_max_stall_ms);
+   if (core_get_frame_skip_stats)
+      have_frame_skip_stats = core_get_frame_skip_stats(&skip_frames, &skipped_frames, &skip_readbacks,
+         &skipped_draw_calls, &skipped_triangles);
+   getrusage(RUSAGE_SELF, &usage_info);
+
+   if (rdram_path)
+   {
+      FILE *fp = fopen(rdram_path, "wb");
+      size_t size = core_get_memory_size(RETRO_MEMORY_SYSTEM_RAM);
+
+      if (!fp || fwrite(core_get_memory_data(RETRO_MEMORY_SYSTEM_RAM), 1, size, fp) != size)
+         die("cannot write %s", rdram_path);
+      fclose(fp);
+   }
+
+   if (frame_path)
+   {
+      FILE *fp = fopen(frame_path, "wb");
+      unsigned y;
+
+      if (!fp || !gl.frames)
+         die("cannot write %s", frame_path);
+      fprintf(fp, "P7\nWIDTH %u\nHEIGHT %u\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", gl.width, gl.height);
+      for (y = gl.height; y-- > 0;)
+         if (fwrite(gl.pixels + (size_t)y * gl.width * 4, 4, gl.width, fp) != gl.width)
+            die("cannot write %s", frame_path);
+      fclose(fp);
+   }
+
+   if (savestates)
+   {
+      void *state, *next, *again;
+      size_t next_size, again_size;
+      unsigned long long next_hash;
+      unsigned next_frames;
+
+      start = now();
+      state_size = core_serialize_size();
+      state = malloc(state_size);
+      if (!state || !core_serialize(state, state_size))
+         die("cannot save the state");
+      save_ms = (now() - start) * 1000.0;
+
+      core_run();
+      next_hash = gl.hash;
+      next_frames = gl.frames;
+      start = now();
+      next_size = core_serialize_size();
+      next = malloc(next_size);
+      if (!next || !core_serialize(next, next_size))
+         die("cannot save the state");
+      save_next_ms = (now() - start) * 1000.0;
+
+      start = now();
+      if (!core_unserialize(state, state_size))
+         die("cannot load the state");
+      load_ms = (now() - start) * 1000.0;
+
+      again_size = core_serialize_size();
+      again = malloc(again_size);
+      if (!again || !core_serialize(again, again_size))
+         die("cannot save the state");
+      roundtrip = again_size == state_size && !memcmp(state, again, state_size);
+      free(again);
+
+      if (gl.enabled)
+      {
+         core_run();
+         video_roundtrip = gl.frames > next_frames && gl.hash == next_hash;
+         if (!core_unserialize(state, state_size))
+            die("cannot load the state");
+      }
+
+      /* a failed load must leave RDRAM as it was */
+      ((unsigned char *)next)[next_size / 2] ^= 0x55;
+      corrupt_rejected = !core_unserialize(next, next_size);
+      again_size = core_serialize_size();
+      again = malloc(again_size);
+      if (!again || !core_serialize(again, again_size))
+         die("cannot save the state");
+      corrupt_intact = again_size == state_size && !memcmp(state, again, state_size);
+
+      free(state);
+      free(next);
+      free(again);
+   }
+
+   if (trace_path && (!core_trace_dump || !core_trace_dump(trace_path)))
+      die("cannot write the trace to %s, build the core with TRACE=1", trace_path);
+   if (guest_profile_path && (!core_guest_profile_dump || !core_guest_profile_dump(guest_profile_path)))
+      die("cannot write the guest profile to %s, build the core with GUEST_PROFILE=1", guest_profile_path);
+
+   if (output_path)
+   {
+      out = fopen(output_path, "w");
+      if (!out)
+         die("cannot write %s", output_path);
+   }
+
+   fprintf(out, "{\n  \"core\": ");
+   print_string(out, info.library_name);
+   fprintf(out, ",\n  \"core_version\": ");
+   print_string(out, info.library_version);
+   fprintf(out, ",\n  \"rom\": ");
+   print_string(out, rom_path);
+   fprintf(out, ",\n  \"options\": {");
+   for (i = 0; i < (int)num_options; i++)
+   {
+      fprintf(out, "%s\n    ", i ? "," : "");
+      print_string(out, options[i].key);
+      fprintf(out, ": ");
+      print_string(out, options[i].value);
+   }
+   fprintf(out, "\n  },\n");
+   fprintf(out, "  \"frames\": %u,\n", frames);
+   fprintf(out, "  \"seconds\": %.6f,\n", elapsed);
+   fprintf(out, "  \"vis_per_second\": %.3f,\n", frames / elapsed);
+   fprintf(out, "  \"audio_frames\": %llu,\n", audio_frames);
+   if (have_sections)
+      fprintf(out, "  \"sections_ns\": {\"gfx\": %lld, \"audio\": %lld, \"compiler\": %lld, \"idle\": %lld},\n",
+         sections[SECTION_GFX], sections[SECTION_AUDIO], sections[SECTION_COMPILER], sections[SECTION_IDLE]);
+   else
+      fprintf(out, "  \"sections_ns\": null,\n");
+   if (have_latency && latency_frames > 0)
+      fprintf(out, "  \"input_latency_cycles\": {\"frames\": %u, \"average\": %llu, \"max\": %u},\n",
+         latency_frames, latency_cycles / latency_frames, latency_max);
+   else
+      fprintf(out, "  \"input_latency_cycles\": null,\n");
+   if (have_audio_stats)
+      fprintf(out, "  \"audio_ring\": {\"fill\": %u, \"max_fill\": %u, \"underruns\": %u, \"dropped\": %llu},\n",
+         audio_fill, audio_max_fill, audio_underruns, audio_dropped);
+   else
+      fprintf(out, "  \"audio_ring\": null,\n");
+   if (gl.enabled)
+      fprintf(out, "  \"video\": {\"frames\": %u, \"hash\": \"%016llx\"},\n", gl.frames, gl.hash);
+   else
+      fprintf(out, "  \"video\": null,\n");
+   if (have_shader_stats)
+      fprintf(out, "  \"shaders\": {\"compiled\": %u, \"precompiled\": %u, \"uber_shader_uses\": %u, "
+         "\"stall_ms\": %.3f, \"max_stall_ms\": %.3f},\n",
+         shaders_compiled, shaders_precompiled, uber_shader_uses, shader_stall_ms, shader_max_stall_ms);
+   else
+      fprintf(out, "  \"shaders\": null,\n");
+   if (have_frame_skip_stats)
+      fprintf(out, "  \"frame_skip\": {\"frames\": %u, \"skipped\": %u, \"readbacks\": %u, "
+         "\"draw_calls_skipped\": %llu, \"triangles_skipped\": %llu},\n",
+         skip_frames, skipped_frames, skip_readbacks, skipped_draw_calls, skipped_triangles);
+   else
+      fprintf(out, "  \"frame_skip\": null,\n");
+   if (savestates)
+      fprintf(out, "  \"savestate\": {\"size\": %lu, \"save_ms\": %.3f, \"save_next_ms\": %.3f, \"load_ms\": %.3f, \"roundtrip\": %s, "
+         "\"corrupt_rejected\": %s, \"corrupt_intact\": %s, \"video_roundtrip\": %s},\n",
+         (unsigned long)state_size, save_ms, save_next_ms, load_ms, roundtrip ? "true" : "false",
+         corrupt_rejected ? "true" : "false", corrupt_intact ? "true" : "false",
+         !gl.enabled ? "null" : video_roundtrip ? "true" : "false");
+   else
+      fprintf(out, "  \"savestate\": null,\n");
+#ifdef __APPLE__
+   fprintf(out, "  \"peak_rss_kb\": %ld\n", (long)(usage_info.ru_maxrss / 1024));
+#else
+   fprintf(out, "  \"peak_rss_kb\": %ld\n", (long)usage_info.ru_maxrss);
+#endif
+   fprintf(out, "}\n");
+   if (out != stdout)
+      fclose(out);
+
+   core_unload_game();
+   core_deinit();
+   return 0;
+}
@@ -0,0 +1,390 @@
+#!/usr/bin/env python3
+"""Test of the memory accesses of the CPU cores, fastmem (FASTMEM=1) included.
+
+  fastmem_harness.py [--benchmark FILE] [--core FILE] [--cpu NAME]...
+                     [--frames N] [--require-fastmem] [--rom FILE]
+
+Builds a test ROM (see n64rom.py) which
+
+  - runs the same load sites of every size on RDRAM through kseg0, kseg1
+    and a TLB mapped page, and on MI registers, cart ROM and SP IMEM, so
+    that the sites of the recompiler first access RDRAM directly, then
+    fault and are backpatched to the slow path, then read RDRAM again
+    through it,
+  - runs the same store sites of every size on RDRAM through kseg0, kseg1
+    and a TLB mapped page and on SP IMEM, and reads the values back through
+    another view of the same memory,
+  - rewrites the TLB entry of a mapped page and checks that loads and
+    stores through it follow it,
+  - calls a routine in RDRAM, rewrites it through kseg0, kseg1 and a TLB
+    mapped page with word, halfword and byte stores, and calls it again
+    through each view: recompiled code must be invalidated whatever view
+    the store goes through (invalid_code).
+
+and runs it with every CPU core. The results must be the ones of the
+N64; the interpreters serve as a cross-check of the expectations.
+
+With a core built with FASTMEM=1, the log tells whether the recompiler ran
+with fastmem and how many access sites were backpatched. --require-fastmem
+fails when the recompiler did not, or backpatched none.
+
+The harness fails (exit status 1) when a result is wrong. Not tested:
+
+  - accesses that raise exceptions (unmapped pages, stores to clean pages),
+  - a store through kseg1 to code that ran through kseg0 only, or the
+    other way around: the cached interpreter and the recompiler miss it,
+    as they always did, since init_block() marks the other view valid
+    without compiling it.
+"""
+
+import argparse
+import os
+import re
+import sys
+import tempfile
+
+from n64rom import (Program, RESULTS, INDEX, ENTRYLO0, ENTRYLO1, PAGEMASK, ENTRYHI,
+                    T0, T1, T2, T3, S0, S1, S2, V0, ZERO,
+                    read_words, run)
+
+# RDRAM of the test: data, a code page, and the page a TLB entry is moved to
+DATA = 0x00300000
+CODE = 0x00302000
+REMAP = 0x00304000
+TABLE = 0x80305000
+# the TLB views: data at DATA_VADDR (dirty) and DATA_VADDR + 0x1000 (clean),
+# the code page at CODE_VADDR (dirty)
+DATA_VADDR = 0x00400000
+CODE_VADDR = 0x00402000
+
+MI_VERSION_REG = 0xA4300004
+MI_VERSION = 0x02020102
+CART_ROM = 0xB0000000
+ROM_HEADER = 0x80371240
+SP_IMEM = 0xA4001000
+
+KSEG0 = 0x80000000
+KSEG1 = 0xA0000000
+
+LOADS = RESULTS
+STORES = RESULTS + 0x200
+REMAPS = RESULTS + 0x300
+SMC = RESULTS + 0x380
+DONE = RESULTS + 0x3FC
+
+# the words the ROM writes before the loads
+MEMORY = {
+    KSEG0 | DATA: 0x11223344,
+    KSEG0 | DATA + 4: 0x8899AABC,
+    KSEG0 | DATA + 8: 0xCAFEF00D,
+    KSEG0 | DATA + 0x1000: 0x7F80FF01,
+    KSEG0 | REMAP: 0x0BADBEEF,
+    SP_IMEM: 0x55667788,
+}
+
+# address of each pass of the load loop, and the word found there
+LOAD_ADDRESSES = [
+    (KSEG0 | DATA, MEMORY[KSEG0 | DATA]),
+    (MI_VERSION_REG, MI_VERSION),
+    (KSEG1 | DATA + 4, MEMORY[KSEG0 | DATA + 4]),
+    (CART_ROM, ROM_HEADER),
+    (SP_IMEM, MEMORY[SP_IMEM]),
+    (DATA_VADDR + 8, MEMORY[KSEG0 | DATA + 8]),
+    (DATA_VADDR + 0x1000, MEMORY[KSEG0 | DATA + 0x1000]),
+    (KSEG0 | DATA, MEMORY[KSEG0 | DATA]),
+]
+LOAD_RESULTS = 6
+
+# address of each pass of the store loop, the address to read it back
+# from, and the value stored
+STORE_ADDRESSES = [
+    (KSEG0 | DATA + 0x100, KSEG0 | DATA + 0x100, 0x01234567),
+    (SP_IMEM + 0x10, SP_IMEM + 0x10, 0x89ABCDEF),
+    (KSEG1 | DATA + 0x110, KSEG0 | DATA + 0x110, 0xFEDCBA98),
+    (DATA_VADDR + 0x120, KSEG0 | DATA + 0x120, 0x76543210),
+    (KSEG0 | DATA + 0x130, KSEG1 | DATA + 0x130, 0x0F1E2D3C),
+]
+
+REMAP_WORD = 0x600DF00D
+
+JR_RA = 0x03E00008
+
+
+def ori_v0(value):
+    return 13 << 26 | V0 << 16 | value
+
+
+def signed(value, bits):
+    value &= (1 << bits) - 1
+    return value - (1 << bits) if value >> (bits - 1) else value
+
+
+def expected_loads():
+    words = []
+    for _, word in LOAD_ADDRESSES:
+        words += [
+            word,
+            signed(word >> 16, 16) & 0xFFFFFFFF,
+            word & 0xFFFF,
+            signed(word >> 24, 8) & 0xFFFFFFFF,
+            word & 0xFF,
+            word,
+        ]
+    return words
+
+
+def expected_stores():
+    words = []
+    for _, _, value in STORE_ADDRESSES:
+        words += [value, (value & 0xFFFF) << 16 | (value & 0xFF)]
+    return words
+
+
+def expected_remaps():
+    return [MEMORY[KSEG0 | DATA], MEMORY[KSEG0 | REMAP], MEMORY[KSEG0 | DATA],
+            REMAP_WORD, MEMORY[KSEG0 | DATA + 4]]
+
+
+# (view to store through, how, value, view to call) of each step of the
+# self-modifying code test, the ROM writing the whole routine first
+SMC_STEPS = [
+    (KSEG0, 'sw', 2, KSEG0),
+    (CODE_VADDR, 'sw', 3, KSEG0),
+    (KSEG0, 'sh', 4, KSEG0),
+    (KSEG0, 'sb', 5, KSEG0),
+    (KSEG0, 'sw', 6, KSEG1),
+    (None, None, 6, CODE_VADDR),
+    (KSEG0, 'sw', 7, CODE_VADDR),
+    (CODE_VADDR, 'sw', 8, CODE_VADDR),
+    (KSEG1, 'sw', 9, KSEG0),
+    (KSEG1, 'sh', 10, KSEG1),
+]
+
+
+def expected_smc():
+    return [1] + [value for _, _, value, _ in SMC_STEPS]
+
+
+def code_address(view):
+    return CODE_VADDR if view == CODE_VADDR else view | CODE
+
+
+def entry_lo(paddr, dirty):
+    # cacheable noncoherent, valid, global
+    return (paddr >> 12) << 6 | 3 << 3 | dirty << 2 | 1 << 1 | 1
+
+
+def write_tlb(p, index, vaddr, even, odd, odd_dirty):
+    p.li(T0, index)
+    p.mtc0(T0, INDEX)
+    p.mtc0(ZERO, PAGEMASK)
+    p.li(T0, vaddr)
+    p.mtc0(T0, ENTRYHI)
+    p.li(T0, entry_lo(even, 1))
+    p.mtc0(T0, ENTRYLO0)
+    p.li(T0, entry_lo(odd, odd_dirty))
+    p.mtc0(T0, ENTRYLO1)
+    p.tlbwi()
+
+
+def store_word(p, address, value):
+    p.li(T0, address)
+    p.li(T1, value)
+    p.sw(T1, 0, T0)
+
+
+def build_rom(path):
+    p = Program()
+    for address, value in MEMORY.items():
+        store_word(p, address, value)
+    for store, readback, _ in STORE_ADDRESSES:
+        store_word(p, readback + 4, 0)
+    write_tlb(p, 0, DATA_VADDR, DATA, DATA + 0x1000, 0)
+    write_tlb(p, 1, CODE_VADDR, CODE, CODE + 0x1000, 1)
+
+    # the same load sites on every address of the table
+    p.li(T0, TABLE)
+    for address, _ in LOAD_ADDRESSES:
+        p.li(T1, address)
+        p.sw(T1, 0, T0)
+        p.addiu(T0, T0, 4)
+    p.li(S0, LOADS)
+    p.li(S2, TABLE)
+    p.li(S1, len(LOAD_ADDRESSES))
+    p.label('loads')
+    p.lw(T0, 0, S2)
+    p.lw(T1, 0, T0)
+    p.sw(T1, 0, S0)
+    p.lh(T1, 0, T0)
+    p.sw(T1, 4, S0)
+    p.lhu(T1, 2, T0)
+    p.sw(T1, 8, S0)
+    p.lb(T1, 0, T0)
+    p.sw(T1, 12, S0)
+    p.lbu(T1, 3, T0)
+    p.sw(T1, 16, S0)
+    p.lwu(T1, 0, T0)
+    p.sw(T1, 20, S0)
+    p.addiu(S0, S0, 4 * LOAD_RESULTS)
+    p.addiu(S2, S2, 4)
+    p.addiu(S1, S1, -1)
+    p.bne(S1, ZERO, 'loads')
+    p.nop()
+
+    # the same store sites on every address of the table
+    p.li(T0, TABLE)
+    for store, readback, value in STORE_ADDRESSES:
+        for word in (store, readback, value):
+            p.li(T1, word)
+            p.sw(T1, 0, T0)
+            p.addiu(T0, T0, 4)
+    p.li(S0, STORES)
+    p.li(S2, TABLE)
+    p.li(S1, len(STORE_ADDRESSES))
+    p.label('stores')
+    p.lw(T0, 0, S2)
+    p.lw(T2, 4, S2)
+    p.lw(T3, 8, S2)
+    p.sw(T3, 0, T0)
+    p.sh(T3, 4, T0)
+    p.sb(T3, 7, T0)
+    p.lw(T1, 0, T2)
+    p.sw(T1, 0, S0)
+    p.lw(T1, 4, T2)
+    p.sw(T1, 4, S0)
+    p.addiu(S0, S0, 8)
+    p.addiu(S2, S2, 12)
+    p.addiu(S1, S1, -1)
+    p.bne(S1, ZERO, 'stores')
+    p.nop()
+
+    # a TLB entry moved to another page and back
+    p.li(S0, REMAPS)
+    p.li(S2, DATA_VADDR)
+    p.jal('read_mapped')
+    p.nop()
+    write_tlb(p, 0, DATA_VADDR, REMAP, DATA + 0x1000, 0)
+    p.jal('read_mapped')
+    p.nop()
+    p.li(T1, REMAP_WORD)
+    p.sw(T1, 4, S2)
+    write_tlb(p, 0, DATA_VADDR, DATA, DATA + 0x1000, 0)
+    p.jal('read_mapped')
+    p.nop()
+    p.li(T0, KSEG0 | REMAP)
+    p.lw(T1, 4, T0)
+    p.sw(T1, 0, S0)
+    p.lw(T1, 4, S2)
+    p.sw(T1, 4, S0)
+
+    # self-modifying code
+    p.li(S0, SMC)
+    store_word(p, KSEG0 | CODE, JR_RA)
+    store_word(p, KSEG0 | CODE + 4, ori_v0(1))
+    p.li(S1, KSEG0 | CODE)
+    p.jalr(S1)
+    p.nop()
+    p.sw(V0, 0, S0)
+    for step, (store_view, how, value, call_view) in enumerate(SMC_STEPS):
+        if store_view is not None:
+            p.li(T0, code_address(store_view))
+            if how == 'sw':
+                p.li(T1, ori_v0(value))
+                p.sw(T1, 4, T0)
+            elif how == 'sh':
+                p.li(T1, value)
+                p.sh(T1, 6, T0)
+            else:
+                p.li(T1, value)
+                p.sb(T1, 7, T0)
+        p.li(S1, code_address(call_view))
+        p.jalr(S1)
+        p.nop()
+        p.sw(V0, 4 * (step + 1), S0)
+
+    p.li(T0, 1)
+    p.li(T1, DONE)
+    p.sw(T0, 0, T1)
+    p.halt()
+
+    # stores the word at S2 at S0, and advances S0
+    p.label('read_mapped')
+    p.lw(T1, 0, S2)
+    p.sw(T1, 0, S0)
+    p.jr(31)
+    p.addiu(S0, S0, 4)
+    p.write(path)
+
+
+def compare(cpu, section, got, want, names):
+    failures = []
+    for i, (g, w) in enumerate(zip(got, want)):
+        if g != w:
+            failures.append('%s, %s: %s is %08x, not %08x' % (cpu, section, names(i), g, w))
+    return failures
+
+
+def check(args, rom, cpu):
+    rdram, log = run(args.benchmark, args.core, rom, cpu, args.frames, log=True)
+    if read_words(rdram, DONE, 1)[0] != 1:
+        raise SystemExit('%s did not finish the test ROM in %d VIs, raise --frames' % (cpu, args.frames))
+
+    load_names = ['lw', 'lh', 'lhu +2', 'lb', 'lbu +3', 'lwu']
+    failures = []
+    want = expected_loads()
+    failures += compare(cpu, 'loads', read_words(rdram, LOADS, len(want)), want,
+                        lambda i: '%s %08x' % (load_names[i % LOAD_RESULTS],
+                                               LOAD_ADDRESSES[i // LOAD_RESULTS][0]))
+    want = expected_stores()
+    failures += compare(cpu, 'stores', read_words(rdram, STORES, len(want)), want,
+                        lambda i: '%s %08x' % (('sw' if i % 2 == 0 else 'sh +4, sb +7'),
+                                               STORE_ADDRESSES[i // 2][0]))
+    want = expected_remaps()
+    failures += compare(cpu, 'TLB remap', read_words(rdram, REMAPS, len(want)), want,
+                        lambda i: ['load', 'load after the remap', 'load after the remap back',
+                                   'store after the remap', 'store after the remap back'][i])
+    want = expected_smc()
+    failures += compare(cpu, 'self-modifying code', read_words(rdram, SMC, len(want)), want,
+                        lambda i: 'call %d' % i)
+
+    fastmem = re.search(r'fastmem: guest address space', log) is not None
+    patched = re.search(r'fastmem: (\d+) access sites patched', log)
+    patched = int(patched.group(1)) if patched else 0
+    if fastmem:
+        state = 'fastmem, %d access sites backpatched' % patched
+    else:
+        state = 'no fastmem'
+    if args.require_fastmem and cpu == 'dynamic_recompiler' and (not fastmem or patched == 0):
+        failures.append('%s: %s' % (cpu, state))
+    count = len(expected_loads()) + len(expected_stores()) + len(expected_remaps()) + len(expected_smc())
+    print('%-20s %d of %d results wrong, %s' % (cpu, len(failures), count, state))
+    return failures
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    root = os.path.join(here, '..', '..')
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--benchmark', default=os.path.join(root, 'mupen64plus_benchmark'))
+    parser.add_argument('--core', default=os.path.join(root, 'mupen64plus_libretro.so'))
+    parser.add_argument('--cpu', action='append')
+    parser.add_argument('--frames', type=int, default=10)
+    parser.add_argument('--require-fastmem', action='store_true')
+    parser.add_argument('--rom')
+    args = parser.parse_args()
+    cpus = args.cpu or ['pure_interpreter', 'cached_interpreter', 'dynamic_recompiler']
+
+    failures = []
+    with tempfile.TemporaryDirectory() as tmp:
+        rom = args.rom or os.path.join(tmp, 'fastmem.z64')
+        build_rom(rom)
+        for cpu in cpus:
+            failures += check(args, rom, cpu)
+
+    for failure in failures:
+        print('FAIL: ' + failure)
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
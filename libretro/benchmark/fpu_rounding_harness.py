@@ -0,0 +1,356 @@
+#!/usr/bin/env python3
+"""Rounding mode test and microbenchmark of the COP1 instructions.
+
+  fpu_rounding_harness.py [--benchmark FILE] [--core FILE] [--cpu NAME]...
+                          [--frames N] [--no-bench] [--bench-frames N]
+                          [--repeat N] [--rom FILE]
+
+The test ROM (see n64rom.py) sets each of the four rounding modes of FCR31
+with CTC1 and runs inexact COP1 operations: conversions, the four basic
+operations and sqrt, in single and double precision. It runs them right
+after the CTC1, and again after a VI, so that the core returned to the
+frontend in between. Every result must be
+the exactly rounded one of the mode, as the harness computes it with
+fractions. The host rounding mode is set when FCR31 is written, not by
+every COP1 operation (see set_rounding in mupen64plus-core/src/r4300/fpu.h),
+so a core that misses a CTC1, or does not restore the mode when the
+emulation resumes, fails here.
+
+The microbenchmark then runs, for --bench-frames VIs, a loop of eight COP1
+operations and the same loop of integer additions, and reports from the
+iterations run and the time taken the host time of a COP1 operation for
+each CPU core. OpCostScale is 0, so that both loops run as many iterations
+in a VI and the cost of the VIs cancels out.
+
+The harness fails (exit status 1) when a result is not the one of the
+rounding mode. Ties to even are not tested: CVT.W of the interpreters
+rounds them away from zero.
+"""
+
+import argparse
+import math
+import os
+import struct
+import sys
+import tempfile
+from fractions import Fraction
+
+from n64rom import (Program, RESULTS, STATUS, STATUS_CU1,
+                    T0, T1, T4, T5, T6, S0, S1, RA, ZERO,
+                    read_words, run)
+
+MODES = ['nearest', 'zero', 'up', 'down']
+# the results of each mode, right after CTC1 and after a VI
+PHASES = ['after CTC1', 'after a VI']
+BLOCK_STRIDE = 0x100
+DONE = RESULTS + len(MODES) * len(PHASES) * BLOCK_STRIDE
+BENCH_COUNT = RESULTS
+
+OPERAND_A = 2
+OPERAND_B = 4
+RESULT = 6
+
+
+def round_binary(value, mode, bits):
+    """Rounds a Fraction to a binary float with a bits-bit significand."""
+    if value == 0:
+        return Fraction(0)
+    negative = value < 0
+    magnitude = -value if negative else value
+    exponent = magnitude.numerator.bit_length() - magnitude.denominator.bit_length()
+    if Fraction(2) ** exponent > magnitude:
+        exponent -= 1
+    scale = Fraction(2) ** (bits - 1 - exponent)
+    scaled = magnitude * scale
+    quotient, remainder = divmod(scaled.numerator, scaled.denominator)
+    if remainder:
+        if mode == 0:
+            twice = 2 * remainder
+            if twice > scaled.denominator or (twice == scaled.denominator and quotient & 1):
+                quotient += 1
+        elif mode == 2 and not negative or mode == 3 and negative:
+            quotient += 1
+    result = quotient / scale
+    return -result if negative else result
+
+
+def sqrt_binary(value, mode, bits):
+    """Rounds the square root of a positive Fraction like round_binary."""
+    # the root to far more bits than the significand: when it is inexact, no
+    # rounding boundary lies between root and root + 1, so rounding any value
+    # in between, the middle one, rounds the exact root
+    shift = 2 * bits + value.denominator.bit_length()
+    scaled = value * Fraction(4) ** shift
+    root = math.isqrt(scaled.numerator // scaled.denominator)
+    if root * root * scaled.denominator == scaled.numerator:
+        return round_binary(Fraction(root, 2 ** shift), mode, bits)
+    return round_binary(Fraction(2 * root + 1, 2 ** (shift + 1)), mode, bits)
+
+
+def single(value):
+    return struct.unpack('>I', struct.pack('>f', float(value)))[0]
+
+
+def double(value):
+    high, low = struct.unpack('>II', struct.pack('>d', float(value)))
+    return [low, high]
+
+
+def to_int(value, mode):
+    if mode == 0:
+        return math.floor(value + Fraction(1, 2))
+    if mode == 1:
+        return math.trunc(value)
+    if mode == 2:
+        return math.ceil(value)
+    return math.floor(value)
+
+
+def nearest_single(value):
+    return round_binary(value, 0, 24)
+
+
+def nearest_double(value):
+    return round_binary(value, 0, 53)
+
+
+def case_s(name, emit, a, b, exact):
+    """Single precision operation of a and b, exact(a, b) the exact result."""
+    a, b = nearest_single(a), nearest_single(b)
+    return (name, [('S', a), ('S', b)], emit,
+            lambda mode: [single(round_binary(exact(a, b), mode, 24))])
+
+
+def case_d(name, emit, a, b, exact):
+    a, b = nearest_double(a), nearest_double(b)
+    return (name, [('D', a), ('D', b)], emit,
+            lambda mode: double(round_binary(exact(a, b), mode, 53)))
+
+
+def cases():
+    third = Fraction(1, 3)
+    tiny = Fraction(3, 2 ** 25)
+    ulp = Fraction(1, 2 ** 23)
+    big = Fraction(2 ** 24 + 1)
+    return [
+        ('cvt.s.w', [('W', big)], lambda p: p.cvt_s('W', RESULT, OPERAND_A),
+         lambda mode: [single(round_binary(big, mode, 24))]),
+        ('cvt.s.w neg', [('W', -big)], lambda p: p.cvt_s('W', RESULT, OPERAND_A),
+         lambda mode: [single(round_binary(-big, mode, 24))]),
+        case_s('add.s', lambda p: p.add_fmt('S', RESULT, OPERAND_A, OPERAND_B), 1, tiny, lambda a, b: a + b),
+        case_s('add.s neg', lambda p: p.add_fmt('S', RESULT, OPERAND_A, OPERAND_B), -1, -tiny, lambda a, b: a + b),
+        case_s('sub.s', lambda p: p.sub_fmt('S', RESULT, OPERAND_A, OPERAND_B), 1, -tiny, lambda a, b: a - b),
+        case_s('mul.s', lambda p: p.mul_fmt('S', RESULT, OPERAND_A, OPERAND_B), 1 + ulp, 1 + ulp, lambda a, b: a * b),
+        case_s('mul.s neg', lambda p: p.mul_fmt('S', RESULT, OPERAND_A, OPERAND_B), -1 - ulp, 1 + ulp, lambda a, b: a * b),
+        case_s('div.s', lambda p: p.div_fmt('S', RESULT, OPERAND_A, OPERAND_B), 1, 3, lambda a, b: a / b),
+        case_s('div.s neg', lambda p: p.div_fmt('S', RESULT, OPERAND_A, OPERAND_B), -1, 3, lambda a, b: a / b),
+        ('sqrt.s', [('S', Fraction(2))], lambda p: p.sqrt_fmt('S', RESULT, OPERAND_A),
+         lambda mode: [single(sqrt_binary(Fraction(2), mode, 24))]),
+        ('cvt.s.d', [('D', nearest_double(third))], lambda p: p.cvt_s('D', RESULT, OPERAND_A),
+         lambda mode: [single(round_binary(nearest_double(third), mode, 24))]),
+        ('cvt.s.d neg', [('D', -nearest_double(third))], lambda p: p.cvt_s('D', RESULT, OPERAND_A),
+         lambda mode: [single(round_binary(-nearest_double(third), mode, 24))]),
+        case_d('add.d', lambda p: p.add_fmt('D', RESULT, OPERAND_A, OPERAND_B), 1, Fraction(3, 2 ** 54), lambda a, b: a + b),
+        case_d('mul.d', lambda p: p.mul_fmt('D', RESULT, OPERAND_A, OPERAND_B), 1 + Fraction(1, 2 ** 52), 1 + Fraction(1, 2 ** 52), lambda a, b: a * b),
+        case_d('div.d', lambda p: p.div_fmt('D', RESULT, OPERAND_A, OPERAND_B), 1, 3, lambda a, b: a / b),
+        case_d('div.d neg', lambda p: p.div_fmt('D', RESULT, OPERAND_A, OPERAND_B), -1, 3, lambda a, b: a / b),
+        ('sqrt.d', [('D', Fraction(2))], lambda p: p.sqrt_fmt('D', RESULT, OPERAND_A),
+         lambda mode: double(sqrt_binary(Fraction(2), mode, 53))),
+        ('cvt.w.s', [('S', nearest_single(Fraction(27, 10)))], lambda p: p.cvt_w('S', RESULT, OPERAND_A),
+         lambda mode: [to_int(nearest_single(Fraction(27, 10)), mode) & 0xFFFFFFFF]),
+        ('cvt.w.s neg', [('S', -nearest_single(Fraction(27, 10)))], lambda p: p.cvt_w('S', RESULT, OPERAND_A),
+         lambda mode: [to_int(-nearest_single(Fraction(27, 10)), mode) & 0xFFFFFFFF]),
+        ('cvt.w.d', [('D', nearest_double(Fraction(-13, 10)))], lambda p: p.cvt_w('D', RESULT, OPERAND_A),
+         lambda mode: [to_int(nearest_double(Fraction(-13, 10)), mode) & 0xFFFFFFFF]),
+    ]
+
+
+def load_operand(p, reg, fmt, value):
+    if fmt == 'W':
+        p.li(T0, int(value) & 0xFFFFFFFF)
+        p.mtc1(T0, reg)
+    elif fmt == 'S':
+        p.li(T0, single(value))
+        p.mtc1(T0, reg)
+    else:
+        low, high = double(value)
+        p.li(T0, low)
+        p.mtc1(T0, reg)
+        p.li(T0, high)
+        p.mtc1(T0, reg + 1)
+
+
+def layout():
+    """Offsets of the results of every case in a block, after the FCR31
+    rounding mode read back with CFC1."""
+    offsets = []
+    offset = 4
+    for case in cases():
+        words = len(case[3](0))
+        offsets.append(offset)
+        offset += 4 * words
+    assert offset <= BLOCK_STRIDE
+    return offsets
+
+
+def build_rom(path):
+    p = Program()
+    p.li(T0, STATUS_CU1)
+    p.mtc0(T0, STATUS)
+    p.li(S0, RESULTS)
+    p.li(S1, 0)
+
+    p.label('mode')
+    p.ctc1(S1, 31)
+    p.jal('cases')
+    p.nop()
+    p.addiu(S0, S0, BLOCK_STRIDE)
+    # the core goes back to the frontend, which may change the host mode
+    p.wait_vi(T5, T6)
+    p.jal('cases')
+    p.nop()
+    p.addiu(S0, S0, BLOCK_STRIDE)
+    p.addiu(S1, S1, 1)
+    p.li(T0, len(MODES))
+    p.bne(S1, T0, 'mode')
+    p.nop()
+
+    p.ctc1(ZERO, 31)
+    p.li(T0, 1)
+    p.li(T1, DONE)
+    p.sw(T0, 0, T1)
+    p.halt()
+
+    # runs every case, the results to the block at S0
+    p.label('cases')
+    p.cfc1(T1, 31)
+    p.andi(T1, T1, 3)
+    p.sw(T1, 0, S0)
+    for (name, operands, emit, expected), offset in zip(cases(), layout()):
+        for reg, (fmt, value) in zip((OPERAND_A, OPERAND_B), operands):
+            load_operand(p, reg, fmt, value)
+        emit(p)
+        p.mfc1(T1, RESULT)
+        p.sw(T1, offset, S0)
+        if len(expected(0)) == 2:
+            p.mfc1(T1, RESULT + 1)
+            p.sw(T1, offset + 4, S0)
+    p.jr(RA)
+    p.nop()
+    p.write(path)
+
+
+def build_bench_rom(path, cop1):
+    """Counts at BENCH_COUNT the iterations of an endless loop of eight COP1
+    operations, or of eight integer additions."""
+    p = Program()
+    p.li(T0, STATUS_CU1)
+    p.mtc0(T0, STATUS)
+    p.li(T0, single(Fraction(3, 2)))
+    p.mtc1(T0, 2)
+    p.li(T0, single(Fraction(7, 5)))
+    p.mtc1(T0, 4)
+    p.li(T0, 12345)
+    p.mtc1(T0, 16)
+    p.cvt_d('S', 22, 2)
+    p.cvt_d('S', 24, 4)
+    p.li(S0, BENCH_COUNT)
+    p.li(T4, 0)
+    p.label('loop')
+    if cop1:
+        p.add_fmt('S', 8, 2, 4)
+        p.mul_fmt('S', 10, 2, 4)
+        p.div_fmt('S', 12, 2, 4)
+        p.cvt_s('W', 14, 16)
+        p.cvt_w('S', 18, 2)
+        p.add_fmt('D', 20, 22, 24)
+        p.mul_fmt('D', 26, 22, 24)
+        p.cvt_s('D', 28, 22)
+    else:
+        for _ in range(8):
+            p.addu(T1, T0, T4)
+    p.addiu(T4, T4, 1)
+    p.j('loop')
+    p.sw(T4, 0, S0)
+    p.write(path)
+
+
+def check(args, rom, cpu):
+    rdram = run(args.benchmark, args.core, rom, cpu, args.frames)
+    if read_words(rdram, DONE, 1)[0] != 1:
+        raise SystemExit('%s did not finish the test ROM in %d VIs, raise --frames' % (cpu, args.frames))
+    failures = []
+    for mode, mode_name in enumerate(MODES):
+        for phase, phase_name in enumerate(PHASES):
+            base = RESULTS + (mode * len(PHASES) + phase) * BLOCK_STRIDE
+            where = '%s, %s %s' % (cpu, mode_name, phase_name)
+            fcr31 = read_words(rdram, base, 1)[0]
+            if fcr31 != mode:
+                failures.append('%s: CFC1 reads rounding mode %d' % (where, fcr31))
+            for (name, _, _, expected), offset in zip(cases(), layout()):
+                want = expected(mode)
+                got = read_words(rdram, base + offset, len(want))
+                if got != want:
+                    failures.append('%s: %s gives %s, not %s' % (
+                        where, name, ' '.join('%08x' % w for w in got),
+                        ' '.join('%08x' % w for w in want)))
+    print('%-20s %d of %d results wrong' % (cpu, len(failures), len(MODES) * len(PHASES) * (len(cases()) + 1)))
+    return failures
+
+
+def bench(args, roms, cpu):
+    """Host nanoseconds per iteration of each loop."""
+    ns = {}
+    for kind, rom in roms.items():
+        for _ in range(args.repeat):
+            rdram, result = run(args.benchmark, args.core, rom, cpu, args.bench_frames,
+                                ['mupen64plus-OpCostScale=0'], result=True)
+            iterations = read_words(rdram, BENCH_COUNT, 1)[0]
+            if iterations == 0:
+                raise SystemExit('%s did not run the %s loop' % (cpu, kind))
+            value = result['seconds'] * 1e9 / iterations
+            ns[kind] = min(ns.get(kind, value), value)
+    print('%-20s %8.2f ns COP1 loop, %8.2f ns integer loop, %6.2f ns per COP1 operation' % (
+        cpu, ns['cop1'], ns['integer'], (ns['cop1'] - ns['integer']) / 8))
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    root = os.path.join(here, '..', '..')
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--benchmark', default=os.path.join(root, 'mupen64plus_benchmark'))
+    parser.add_argument('--core', default=os.path.join(root, 'mupen64plus_libretro.so'))
+    parser.add_argument('--cpu', action='append')
+    parser.add_argument('--frames', type=int, default=20)
+    parser.add_argument('--no-bench', action='store_true')
+    parser.add_argument('--bench-frames', type=int, default=240)
+    parser.add_argument('--repeat', type=int, default=3)
+    parser.add_argument('--rom')
+    args = parser.parse_args()
+    cpus = args.cpu or ['pure_interpreter', 'cached_interpreter', 'dynamic_recompiler']
+
+    failures = []
+    with tempfile.TemporaryDirectory() as tmp:
+        rom = args.rom or os.path.join(tmp, 'fpu_rounding.z64')
+        build_rom(rom)
+        print('rounding modes')
+        for cpu in cpus:
+            failures += check(args, rom, cpu)
+
+        if not args.no_bench:
+            roms = {'cop1': os.path.join(tmp, 'cop1_bench.z64'),
+                    'integer': os.path.join(tmp, 'integer_bench.z64')}
+            build_bench_rom(roms['cop1'], True)
+            build_bench_rom(roms['integer'], False)
+            print('\nhost time per iteration of 8 operations, best of %d runs of %d VIs'
+                  % (args.repeat, args.bench_frames))
+            for cpu in cpus:
+                bench(args, roms, cpu)
+
+    for failure in failures:
+        print('FAIL: ' + failure)
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""Report of a guest profile written by mupen64plus_benchmark --guest-profile.
+
+  guest_profile.py [--map FILE] [--top N] PROFILE
+
+Lists the hottest blocks (a block starts at each address the guest jumped
+to), the hottest functions when a map file is given, and the exceptions and
+interrupts of the run. Host time is estimated from the samples taken every
+period_us of CPU time, see mupen64plus-core/src/r4300/guest_profile.h.
+
+The map file can be a GNU ld map, the output of nm, or any list of
+"ADDRESS NAME" or "NAME = ADDRESS;" lines: every line holding a hexadecimal
+address and a symbol name defines a function starting there. KSEG1 addresses
+are folded into KSEG0 on both sides.
+"""
+
+import argparse
+import bisect
+import re
+import sys
+
+ADDRESS_FIRST = re.compile(r'^\s*(?:0x)?([0-9A-Fa-f]{8,16})\s+(?:[A-Za-z]\s+)?([A-Za-z_.$][\w.$]*)\s*$')
+NAME_FIRST = re.compile(r'^\s*([A-Za-z_.$][\w.$]*)\s*=\s*0x([0-9A-Fa-f]+)\s*;')
+
+
+def fold(addr):
+    if 0xA0000000 <= addr < 0xC0000000:
+        return addr - 0x20000000
+    return addr
+
+
+class Profile:
+    def __init__(self, path):
+        self.info = {}
+        self.exceptions = []
+        self.interrupts = []
+        # addr -> [entries, samples]
+        self.pcs = {}
+        with open(path) as f:
+            for line in f:
+                fields = line.split()
+                if not fields or fields[0].startswith('#'):
+                    continue
+                if fields[0] == 'pc':
+                    addr = fold(int(fields[1], 16))
+                    counts = self.pcs.setdefault(addr, [0, 0])
+                    counts[0] += int(fields[2])
+                    counts[1] += int(fields[3])
+                elif fields[0] == 'exception':
+                    self.exceptions.append((fields[2], int(fields[3])))
+                elif fields[0] == 'interrupt':
+                    self.interrupts.append((fields[1], int(fields[2])))
+                else:
+                    self.info[fields[0]] = fields[1:]
+
+        self.period_us = int(self.info.get('period_us', ['1000'])[0])
+        samples = self.info.get('samples', ['0', '0'])
+        self.samples = int(samples[0])
+        self.dropped_samples = int(samples[1])
+
+    def blocks(self):
+        """(start, entries, samples) per block, the samples of an address
+        going to the closest block starting before it in its page."""
+        leaders = sorted(addr for addr, counts in self.pcs.items() if counts[0])
+        blocks = {}
+        for addr, (entries, samples) in self.pcs.items():
+            i = bisect.bisect_right(leaders, addr) - 1
+            start = leaders[i] if i >= 0 and leaders[i] >> 12 == addr >> 12 else addr
+            block = blocks.setdefault(start, [0, 0])
+            block[0] += entries
+            block[1] += samples
+        return [(start, e, s) for start, (e, s) in blocks.items()]
+
+
+def load_map(path):
+    symbols = {}
+    with open(path, errors='replace') as f:
+        for line in f:
+            match = ADDRESS_FIRST.match(line)
+            if match:
+                addr, name = int(match.group(1), 16), match.group(2)
+            else:
+                match = NAME_FIRST.match(line)
+                if not match:
+                    continue
+                name, addr = match.group(1), int(match.group(2), 16)
+            addr = fold(addr & 0xFFFFFFFF)
+            # keep the first name of an address, ld maps list sections first
+            if 0x80000000 <= addr and addr not in symbols:
+                symbols[addr] = name
+    addresses = sorted(symbols)
+    return addresses, [symbols[a] for a in addresses]
+
+
+def percent(part, total):
+    return 100.0 * part / total if total else 0.0
+
+
+def print_table(title, header, rows):
+    print(title)
+    print('  ' + header)
+    for row in rows:
+        print('  ' + row)
+    print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('profile')
+    parser.add_argument('--map', help='map file to symbolize the addresses against')
+    parser.add_argument('--top', type=int, default=30, help='lines per table (default 30)')
+    args = parser.parse_args()
+
+    profile = Profile(args.profile)
+    total_entries = sum(counts[0] for counts in profile.pcs.values())
+    total = profile.samples
+
+    print('rom %s, %d samples of %d us (%d outside counted pages), %d block entries'
+          % (' '.join(profile.info.get('rom', [])) or '?', total, profile.period_us,
+             profile.dropped_samples, total_entries))
+    print()
+
+    blocks = sorted(profile.blocks(), key=lambda b: (b[2], b[1]), reverse=True)
+    print_table('hottest blocks', '   samples  host ms   entries  block',
+                ['%6.2f%% %8.1f %9d  %08x' % (percent(s, total), s * profile.period_us / 1000.0, e, start)
+                 for start, e, s in blocks[:args.top]])
+
+    if args.map:
+        addresses, names = load_map(args.map)
+        functions = {}
+        for start, entries, samples in blocks:
+            i = bisect.bisect_right(addresses, start) - 1
+            name = names[i] if i >= 0 else '%08x' % start
+            function = functions.setdefault(name, [0, 0, 0])
+            function[0] += samples
+            function[1] += entries
+            function[2] += 1
+        rows = sorted(functions.items(), key=lambda f: (f[1][0], f[1][1]), reverse=True)
+        print_table('hottest functions', '   samples  host ms   entries  blocks  function',
+                    ['%6.2f%% %8.1f %9d %7d  %s' % (percent(s, total), s * profile.period_us / 1000.0, e, b, name)
+                     for name, (s, e, b) in rows[:args.top]])
+
+    if profile.exceptions:
+        print_table('exceptions', '     count  code',
+                    ['%10d  %s' % (count, name) for name, count in sorted(profile.exceptions, key=lambda x: -x[1])])
+    if profile.interrupts:
+        print_table('interrupt events', '     count  type',
+                    ['%10d  %s' % (count, name) for name, count in sorted(profile.interrupts, key=lambda x: -x[1])])
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
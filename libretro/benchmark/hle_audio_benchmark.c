@@ -0,0 +1,465 @@
+/* Replay harness and micro benchmark of the MusyX and MP3 HLE audio ucodes.
+ *
+ * Builds mupen64plus-rsp-hle on its own and runs audio tasks through
+ * hle_execute, like the plugin does. Tasks come from capture files, saved by
+ * the plugin when it is built with DUMP=1 (see dump_audio_task in hle.c),
+ * and from tasks generated for each ucode:
+ *
+ *   mupen64plus_hle_audio_benchmark [options] [capture.task ...]
+ *
+ *   --synthetic N     generated tasks per ucode (default 16 without captures,
+ *                     0 otherwise)
+ *   --iterations N    timed runs of each task (default 200)
+ *   --hashes FILE     writes the hash of the RDRAM, DMEM and ucode state
+ *                     left by the first run of each task
+ *
+ * The first run of a task starts from its captured or generated input and is
+ * the one hashed. The timed runs follow without restoring the input, which
+ * keeps the work of the task but not its data.
+ *
+ * The benchmark is built twice: with the SSE2 or NEON paths of the ucodes,
+ * and with the scalar code only (-DHLE_NO_SIMD, the _scalar binary). Both
+ * must write the same hashes. Results are printed as JSON.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hle.h"
+#include "hle_internal.h"
+#include "memory.h"
+#include "simd.h"
+
+#define RDRAM_SIZE 0x800000
+#define MAX_UCODES 8
+
+/* what the ucodes need from the plugin */
+void HleVerboseMessage(void* user_defined, const char *message, ...) { (void)user_defined; (void)message; }
+void HleInfoMessage(void* user_defined, const char *message, ...) { (void)user_defined; (void)message; }
+void HleErrorMessage(void* user_defined, const char *message, ...) { (void)user_defined; (void)message; }
+void HleWarnMessage(void* user_defined, const char *message, ...) { (void)user_defined; (void)message; }
+void HleCheckInterrupts(void* user_defined) { (void)user_defined; }
+void HleProcessDlistList(void* user_defined) { (void)user_defined; }
+void HleProcessAlistList(void* user_defined) { (void)user_defined; }
+void HleProcessRdpList(void* user_defined) { (void)user_defined; }
+void HleShowCFB(void* user_defined) { (void)user_defined; }
+int HleForwardTask(void* user_defined) { (void)user_defined; return 0; }
+
+static struct hle_t hle;
+static unsigned char *rdram;
+static unsigned char dmem[0x1000];
+static unsigned char imem[0x1000];
+static unsigned int regs[18];
+
+struct ucode_stats
+{
+   char name[16];
+   unsigned int tasks;
+   double ns;
+};
+
+static struct ucode_stats ucodes[MAX_UCODES];
+static unsigned int ucode_count = 0;
+
+static unsigned int rng_state = 1;
+
+static unsigned int rng(void)
+{
+   rng_state = rng_state * 1103515245 + 12345;
+   return rng_state >> 8;
+}
+
+static uint32_t rng32(void)
+{
+   return (rng() << 16) ^ rng();
+}
+
+static double now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static size_t state_size(void)
+{
+   return sizeof(hle) - offsetof(struct hle_t, alist_buffer);
+}
+
+static void reset(void)
+{
+   memset(rdram, 0, RDRAM_SIZE);
+   memset(dmem, 0, sizeof(dmem));
+   memset(hle.alist_buffer, 0, state_size());
+}
+
+static void fill(uint32_t address, uint32_t size)
+{
+   uint32_t i;
+
+   for (i = 0; i < size; i += 4)
+      *dram_u32(&hle, address + i) = rng32();
+}
+
+/* common task header; ucode_data identifies the ucode, see try_fast_audio_dispatching */
+static void write_task(uint32_t data_ptr, uint32_t data_size)
+{
+   *dmem_u32(&hle, TASK_TYPE) = 2;
+   *dmem_u32(&hle, TASK_UCODE_BOOT_SIZE) = 0xd0;
+   *dmem_u32(&hle, TASK_UCODE_DATA) = 0x1000;
+   *dmem_u32(&hle, TASK_DATA_PTR) = data_ptr;
+   *dmem_u32(&hle, TASK_DATA_SIZE) = data_size;
+}
+
+/* MusyX structures, see the enums at the top of musyx.c */
+enum { SUBFRAME_SIZE = 192, SFD_COUNT = 4, CBUFFER_LENGTH = 8 * SUBFRAME_SIZE };
+
+static void write_voice(uint32_t voice_ptr, uint32_t data, uint32_t output_ptr)
+{
+   unsigned int k;
+   /* 0x180 samples in the first segment, 0x80 in the second one */
+   unsigned int end_point = 0x180 - 8 - rng() % 32;
+
+   for (k = 0; k < 4; k++)
+   {
+      *dram_u32(&hle, voice_ptr + 0x00 + 4 * k) = rng32();
+      *dram_u32(&hle, voice_ptr + 0x10 + 4 * k) = (int32_t)rng32() >> (rng() % 16);
+   }
+   *dram_u16(&hle, voice_ptr + 0x20) = rng();
+   *dram_u16(&hle, voice_ptr + 0x22) = 0x800 + rng() % 0x1000;
+
+   if (rng() & 1)
+   {
+      /* PCM16 */
+      unsigned int skip = rng() % 4;
+      unsigned int size1 = 2 * (rng() % 0x180);
+
+      *dram_u8(&hle, voice_ptr + 0x3c) = 0;
+      *dram_u8(&hle, voice_ptr + 0x3e) = skip;
+      *dram_u16(&hle, voice_ptr + 0x40) = 0x180 - skip;
+      *dram_u16(&hle, voice_ptr + 0x42) = 1;
+
+      *dram_u32(&hle, voice_ptr + 0x24) = data;
+      *dram_u32(&hle, voice_ptr + 0x28) = data + 0x400;
+      *dram_u16(&hle, voice_ptr + 0x2c) = size1;
+      *dram_u16(&hle, voice_ptr + 0x2e) = 0x300 - size1;
+      *dram_u32(&hle, voice_ptr + 0x30) = data + 0x800;
+      *dram_u16(&hle, voice_ptr + 0x38) = 0x100;
+      *dram_u16(&hle, voice_ptr + 0x3a) = 0;
+   }
+   else
+   {
+      /* ADPCM, 12 then 4 frames */
+      *dram_u8(&hle, voice_ptr + 0x3c) = 12;
+      *dram_u8(&hle, voice_ptr + 0x3d) = 4;
+      *dram_u8(&hle, voice_ptr + 0x3e) = rng() % 64;
+      *dram_u8(&hle, voice_ptr + 0x3f) = rng() % 64;
+      *dram_u32(&hle, voice_ptr + 0x40) = data + 0xc00;
+
+      *dram_u32(&hle, voice_ptr + 0x24) = data;
+      *dram_u16(&hle, voice_ptr + 0x2c) = 320;
+      *dram_u16(&hle, voice_ptr + 0x2e) = 0;
+      *dram_u32(&hle, voice_ptr + 0x30) = data + 0x400;
+      *dram_u32(&hle, voice_ptr + 0x34) = data + 0x800;
+      *dram_u16(&hle, voice_ptr + 0x38) = 200;
+      *dram_u16(&hle, voice_ptr + 0x3a) = 120;
+
+      /* frames come in pairs of 40 bytes, a header byte at 8 and 24 selects
+       * one of the 8 predictor books of the table */
+      for (k = 0; k < 320; k += 40)
+      {
+         *dram_u8(&hle, data + k + 8) &= 0x7f;
+         *dram_u8(&hle, data + k + 24) &= 0x7f;
+      }
+      for (k = 0; k < 200; k += 40)
+      {
+         *dram_u8(&hle, data + 0x400 + k + 8) &= 0x7f;
+         *dram_u8(&hle, data + 0x400 + k + 24) &= 0x7f;
+      }
+      for (k = 0; k < 120; k += 40)
+      {
+         *dram_u8(&hle, data + 0x800 + k + 8) &= 0x7f;
+         *dram_u8(&hle, data + 0x800 + k + 24) &= 0x7f;
+      }
+   }
+
+   *dram_u32(&hle, voice_ptr + 0x44) = output_ptr;
+   *dram_u16(&hle, voice_ptr + 0x48) = end_point;
+   *dram_u16(&hle, voice_ptr + 0x4a) = (rng() & 1) ? 0x8000 | (rng() % 0x40) : rng() % 0x40;
+   *dram_u16(&hle, voice_ptr + 0x4e) = rng() % 8;
+}
+
+static void write_sfx(uint32_t sfx_ptr, uint32_t cbuffer_ptr)
+{
+   unsigned int k;
+
+   *dram_u32(&hle, sfx_ptr + 0x00) = cbuffer_ptr;
+   *dram_u32(&hle, sfx_ptr + 0x04) = CBUFFER_LENGTH;
+   *dram_u16(&hle, sfx_ptr + 0x08) = rng() % 9;
+   for (k = 0; k < 8; k++)
+      *dram_u32(&hle, sfx_ptr + 0x0c + 4 * k) = rng() % CBUFFER_LENGTH;
+
+   /* hgain * hcoeff overflows 16 bits for -0x8000 * -0x8000 */
+   if (rng() % 4 == 0)
+   {
+      *dram_u16(&hle, sfx_ptr + 0x0a) = 0x8000;
+      *dram_u16(&hle, sfx_ptr + 0x40 + 2 * (rng() % 4)) = 0x8000;
+   }
+}
+
+static void generate_musyx(int v2)
+{
+   const uint32_t sfd_size = (v2 ? 0x28 : 0x10) + 32 * 0x50;
+   unsigned int sfd, voice;
+
+   fill(0x10000, 0x1f0000);
+
+   *dram_u32(&hle, 0x1000) = v2 ? 1 : 0;
+   *dram_u32(&hle, 0x1010) = v2 ? 0x00010010 : 0x00000001;
+   *dram_u32(&hle, 0x1030) = 0;
+   write_task(0x10000, SFD_COUNT);
+
+   for (sfd = 0; sfd < SFD_COUNT; sfd++)
+   {
+      const uint32_t sfd_ptr = 0x10000 + sfd * sfd_size;
+      const uint32_t voice_ptr = sfd_ptr + (v2 ? 0x28 : 0x10);
+      const uint32_t output_ptr = 0x80000 + sfd * 0x1000;
+      const unsigned int voices = 1 + rng() % 8;
+
+      *dram_u16(&hle, sfd_ptr + 0x02) = rng() % 8;
+      *dram_u32(&hle, sfd_ptr + 0x08) = 0x20000;
+      *dram_u32(&hle, sfd_ptr + 0x0c) = (rng() % 8) ? 0x21000 + sfd * 0x100 : 0;
+      write_sfx(0x21000 + sfd * 0x100, 0x30000 + sfd * 0x1000);
+
+      if (v2)
+      {
+         unsigned int k;
+
+         *dram_u32(&hle, sfd_ptr + 0x10) = 0;
+         *dram_u32(&hle, sfd_ptr + 0x18) = 0xb0000 + sfd * 0x40;
+         *dram_u32(&hle, sfd_ptr + 0x1c) = 0xa0000 + sfd * 0x200;
+         *dram_u32(&hle, sfd_ptr + 0x20) = 0x90000 + sfd * 0x400;
+         *dram_u32(&hle, sfd_ptr + 0x24) = 0xd0000;
+         *dram_u8(&hle, sfd_ptr + 0x15) = rng() % 16;
+         *dram_u16(&hle, sfd_ptr + 0x16) = rng() % 0x100;
+         for (k = 0; k < 8; k++)
+            *dram_u32(&hle, 0xb0000 + sfd * 0x40 + 8 * k) = 0xc0000 + sfd * 0x2800 + k * 0x500;
+      }
+
+      for (voice = 0; voice < voices; voice++)
+         write_voice(voice_ptr + voice * 0x50, 0x100000 + (sfd * 8 + voice) * 0x1000,
+               voice + 1 == voices ? output_ptr : 0);
+
+      /* no voice stage */
+      if (rng() % 8 == 0)
+      {
+         *dram_u16(&hle, voice_ptr + 0x2c) = 0;
+         *dram_u32(&hle, voice_ptr + 0x44) = output_ptr;
+      }
+   }
+}
+
+static void generate_mp3(void)
+{
+   const unsigned int commands = 4;
+   unsigned int k;
+
+   fill(0x10000, 0xf0000);
+   for (k = 0; k < sizeof(hle.mp3_buffer); k++)
+      hle.mp3_buffer[k] = rng();
+
+   *dram_u32(&hle, 0x1000) = 0;
+   *dram_u32(&hle, 0x1010) = 0x1ae8143c;
+   write_task(0x10000, commands * 8);
+
+   /* MP3 commands */
+   for (k = 0; k < commands; k++)
+   {
+      *dram_u32(&hle, 0x10000 + 8 * k) = 0x07000000 | (rng() & 0x1e);
+      *dram_u32(&hle, 0x10004 + 8 * k) = 0x20000 + k * 0x500;
+   }
+}
+
+static int load_capture(const char *path, char *name)
+{
+   char header[24];
+   uint32_t size;
+   int ok;
+   FILE *f = fopen(path, "rb");
+
+   if (!f)
+   {
+      fprintf(stderr, "can't open %s\n", path);
+      return 0;
+   }
+
+   ok = fread(header, 1, sizeof(header), f) == sizeof(header)
+      && !memcmp(header, "HLETASK1", 8)
+      && fread(&size, sizeof(size), 1, f) == 1
+      && size == state_size()
+      && fread(dmem, 1, sizeof(dmem), f) == sizeof(dmem)
+      && fread(hle.alist_buffer, 1, size, f) == size
+      && fread(rdram, 1, RDRAM_SIZE, f) == RDRAM_SIZE;
+   fclose(f);
+
+   if (!ok)
+   {
+      fprintf(stderr, "%s is not a task capture of this build\n", path);
+      return 0;
+   }
+
+   memcpy(name, header + 8, 15);
+   name[15] = '\0';
+   return 1;
+}
+
+static uint64_t hash_bytes(uint64_t h, const unsigned char *bytes, size_t size)
+{
+   size_t i;
+
+   for (i = 0; i < size; i++)
+      h = (h ^ bytes[i]) * UINT64_C(0x100000001b3);
+
+   return h;
+}
+
+static void run(const char *name, const char *label, unsigned int iterations, FILE *hashes)
+{
+   struct ucode_stats *stats = NULL;
+   uint64_t h = UINT64_C(0xcbf29ce484222325);
+   unsigned int i;
+   double start;
+
+   for (i = 0; i < ucode_count; i++)
+      if (!strcmp(ucodes[i].name, name))
+         stats = &ucodes[i];
+   if (!stats && ucode_count < MAX_UCODES)
+   {
+      stats = &ucodes[ucode_count++];
+      strcpy(stats->name, name);
+   }
+
+   hle_execute(&hle);
+
+   if (hashes)
+   {
+      h = hash_bytes(h, rdram, RDRAM_SIZE);
+      h = hash_bytes(h, dmem, sizeof(dmem));
+      h = hash_bytes(h, hle.alist_buffer, state_size());
+      fprintf(hashes, "%s %016llx\n", label, (unsigned long long)h);
+   }
+
+   start = now_ns();
+   for (i = 0; i < iterations; i++)
+      hle_execute(&hle);
+
+   if (stats)
+   {
+      stats->tasks++;
+      stats->ns += (now_ns() - start) / (iterations ? iterations : 1);
+   }
+}
+
+int main(int argc, char **argv)
+{
+   static const char *const generated[] = { "musyx_v1", "musyx_v2", "naudio_mp3" };
+   unsigned int iterations = 200, synthetic = 16, captures = 0;
+   const char *hashes_path = NULL;
+   FILE *hashes = NULL;
+   char name[16], label[64];
+   unsigned int i, k;
+   int arg, synthetic_set = 0;
+
+   for (arg = 1; arg < argc; arg++)
+   {
+      if (arg + 1 < argc && !strcmp(argv[arg], "--synthetic"))
+      {
+         synthetic = strtoul(argv[++arg], NULL, 0);
+         synthetic_set = 1;
+      }
+      else if (arg + 1 < argc && !strcmp(argv[arg], "--iterations"))
+         iterations = strtoul(argv[++arg], NULL, 0);
+      else if (arg + 1 < argc && !strcmp(argv[arg], "--hashes"))
+         hashes_path = argv[++arg];
+      else if (argv[arg][0] == '-')
+      {
+         fprintf(stderr, "usage: %s [--synthetic N] [--iterations N] [--hashes FILE] [capture.task ...]\n", argv[0]);
+         return 1;
+      }
+      else
+         captures++;
+   }
+
+   if (captures && !synthetic_set)
+      synthetic = 0;
+
+   rdram = malloc(RDRAM_SIZE);
+   if (!rdram)
+      return 1;
+
+   if (hashes_path && !(hashes = fopen(hashes_path, "w")))
+   {
+      fprintf(stderr, "can't open %s\n", hashes_path);
+      return 1;
+   }
+
+   hle_init(&hle, rdram, dmem, imem,
+         &regs[0], &regs[1], &regs[2], &regs[3], &regs[4], &regs[5], &regs[6], &regs[7],
+         &regs[8], &regs[9], &regs[10], &regs[11], &regs[12], &regs[13], &regs[14], &regs[15],
+         &regs[16], &regs[17], NULL);
+
+   for (arg = 1; arg < argc; arg++)
+   {
+      if (argv[arg][0] == '-')
+      {
+         arg++;
+         continue;
+      }
+
+      if (!load_capture(argv[arg], name))
+         return 1;
+      run(name, argv[arg], iterations, hashes);
+   }
+
+   for (k = 0; k < sizeof(generated) / sizeof(generated[0]); k++)
+   {
+      for (i = 0; i < synthetic; i++)
+      {
+         rng_state = 1 + i;
+         reset();
+         if (k == 2)
+            generate_mp3();
+         else
+            generate_musyx(k);
+
+         snprintf(label, sizeof(label), "%s_synthetic_%02u", generated[k], i);
+         run(generated[k], label, iterations, hashes);
+      }
+   }
+
+   if (hashes)
+      fclose(hashes);
+
+   printf("{\n");
+#if defined(HLE_SSE2)
+   printf("  \"simd\": \"sse2\",\n");
+#elif defined(HLE_NEON)
+   printf("  \"simd\": \"neon\",\n");
+#else
+   printf("  \"simd\": \"none\",\n");
+#endif
+   printf("  \"iterations\": %u,\n", iterations);
+   printf("  \"ucodes\": [\n");
+   for (i = 0; i < ucode_count; i++)
+      printf("    { \"name\": \"%s\", \"tasks\": %u, \"ns_per_task\": %.0f }%s\n",
+            ucodes[i].name, ucodes[i].tasks, ucodes[i].ns / ucodes[i].tasks,
+            i + 1 < ucode_count ? "," : "");
+   printf("  ]\n");
+   printf("}\n");
+
+   free(rdram);
+   return 0;
+}
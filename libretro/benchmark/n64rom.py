@@ -0,0 +1,439 @@
+#!/usr/bin/env python3
+"""Hand assembler for the test ROMs of the harnesses in this directory.
+
+A test ROM is a bare cartridge image: the PIF (emulated by the core) copies
+its first 4 KiB to SP DMEM and jumps to 0xA4000040, so a Program is
+assembled at that address and may hold up to 1008 instructions. The ROM
+leaves its results in RDRAM, which mupen64plus_benchmark --rdram writes
+to a file after the run (see run()).
+
+  p = Program()
+  p.li(T0, RESULTS)
+  p.label('loop')
+  p.mfc0(T1, COUNT)
+  p.sw(T1, 0, T0)
+  p.j('loop')
+  p.nop()
+  p.write('test.z64')
+
+Branches and jumps take a label; their delay slot is the next instruction.
+"""
+
+import json
+import os
+import struct
+import subprocess
+import tempfile
+
+ZERO, AT, V0, V1, A0, A1, A2, A3 = range(8)
+T0, T1, T2, T3, T4, T5, T6, T7 = range(8, 16)
+S0, S1, S2, S3, S4, S5, S6, S7 = range(16, 24)
+T8, T9, K0, K1, GP, SP, FP, RA = range(24, 32)
+
+# CP0 registers
+INDEX, ENTRYLO0, ENTRYLO1, PAGEMASK = 0, 2, 3, 5
+BADVADDR, COUNT, ENTRYHI, COMPARE, STATUS, CAUSE, EPC = 8, 9, 10, 11, 12, 13, 14
+
+STATUS_CU1 = 0x20000000
+STATUS_FR = 0x04000000
+
+# RCP registers
+MI_INTR_REG = 0xA4300008
+MI_INTR_VI = 0x08
+VI_STATUS_REG = 0xA4400000
+VI_ORIGIN_REG = 0xA4400004
+VI_CURRENT_REG = 0xA4400010
+DPC_START_REG = 0xA4100000
+DPC_END_REG = 0xA4100004
+DPC_STATUS_REG = 0xA410000C
+DPC_CLR_XBUS_DMEM_DMA = 0x01
+PI_DRAM_ADDR_REG = 0xA4600000
+PI_CART_ADDR_REG = 0xA4600004
+PI_WR_LEN_REG = 0xA460000C
+PI_STATUS_REG = 0xA4600010
+PI_STATUS_BUSY = 0x03
+CART_ADDR = 0x10000000
+
+# VI_STATUS_REG to VI_Y_SCALE_REG for a 320x240 NTSC picture from a 16-bit
+# frame buffer, the origin is written last
+VI_NTSC_320X240_16 = [0x0000320E, None, 320, 2, 0, 0x03E52239, 0x0000020D, 0x00000C15,
+                      0x0C150C15, 0x006C02EC, 0x002501FF, 0x000E0204, 0x00000200, 0x00000400]
+
+CODE_BASE = 0xA4000040
+CODE_MAX = (0x1000 - 0x40) // 4
+# where the ROMs leave their results, well above the PIF boot area
+RESULTS = 0xA0100000
+
+FMT = {'S': 16, 'D': 17, 'W': 20, 'L': 21}
+
+
+class Program:
+    def __init__(self, base=CODE_BASE):
+        self.base = base
+        self.code = []
+        self.labels = {}
+        self.fixups = []
+        self.blobs = []
+
+    def addr(self, label=None):
+        """Address of a label, or of the next instruction."""
+        if label is None:
+            return self.base + len(self.code) * 4
+        return self.base + self.labels[label] * 4
+
+    def label(self, name):
+        self.labels[name] = len(self.code)
+
+    def word(self, w):
+        self.code.append(w & 0xFFFFFFFF)
+
+    def itype(self, op, rs, rt, imm):
+        self.word(op << 26 | rs << 21 | rt << 16 | (imm & 0xFFFF))
+
+    def rtype(self, funct, rs=0, rt=0, rd=0, sa=0):
+        self.word(rs << 21 | rt << 16 | rd << 11 | sa << 6 | funct)
+
+    def branch(self, op, rs, rt, label):
+        self.fixups.append((len(self.code), label, 'b'))
+        self.itype(op, rs, rt, 0)
+
+    def jump(self, op, label):
+        self.fixups.append((len(self.code), label, 'j'))
+        self.word(op << 26)
+
+    # pseudo instructions
+    def nop(self):
+        self.word(0)
+
+    def li(self, rt, value):
+        value &= 0xFFFFFFFF
+        if value < 0x10000:
+            self.ori(rt, ZERO, value)
+        else:
+            self.lui(rt, value >> 16)
+            if value & 0xFFFF:
+                self.ori(rt, rt, value & 0xFFFF)
+
+    def move(self, rd, rs):
+        self.addu(rd, rs, ZERO)
+
+    # CPU
+    def j(self, label): self.jump(2, label)
+    def jal(self, label): self.jump(3, label)
+    def beq(self, rs, rt, label): self.branch(4, rs, rt, label)
+    def bne(self, rs, rt, label): self.branch(5, rs, rt, label)
+    def addiu(self, rt, rs, imm): self.itype(9, rs, rt, imm)
+    def andi(self, rt, rs, imm): self.itype(12, rs, rt, imm)
+    def ori(self, rt, rs, imm): self.itype(13, rs, rt, imm)
+    def xori(self, rt, rs, imm): self.itype(14, rs, rt, imm)
+    def lui(self, rt, imm): self.itype(15, 0, rt, imm)
+    def lb(self, rt, offset, base): self.itype(32, base, rt, offset)
+    def lh(self, rt, offset, base): self.itype(33, base, rt, offset)
+    def lw(self, rt, offset, base): self.itype(35, base, rt, offset)
+    def lbu(self, rt, offset, base): self.itype(36, base, rt, offset)
+    def lhu(self, rt, offset, base): self.itype(37, base, rt, offset)
+    def lwu(self, rt, offset, base): self.itype(39, base, rt, offset)
+    def sb(self, rt, offset, base): self.itype(40, base, rt, offset)
+    def sh(self, rt, offset, base): self.itype(41, base, rt, offset)
+    def sw(self, rt, offset, base): self.itype(43, base, rt, offset)
+    def ld(self, rt, offset, base): self.itype(55, base, rt, offset)
+    def sd(self, rt, offset, base): self.itype(63, base, rt, offset)
+    def cache(self, op, offset, base): self.itype(47, base, op, offset)
+    def sll(self, rd, rt, sa): self.rtype(0, 0, rt, rd, sa)
+    def srl(self, rd, rt, sa): self.rtype(2, 0, rt, rd, sa)
+    def jr(self, rs): self.rtype(8, rs)
+    def jalr(self, rs, rd=RA): self.rtype(9, rs, 0, rd)
+    def mfhi(self, rd): self.rtype(16, 0, 0, rd)
+    def mflo(self, rd): self.rtype(18, 0, 0, rd)
+    def mult(self, rs, rt): self.rtype(24, rs, rt)
+    def multu(self, rs, rt): self.rtype(25, rs, rt)
+    def div(self, rs, rt): self.rtype(26, rs, rt)
+    def divu(self, rs, rt): self.rtype(27, rs, rt)
+    def dmult(self, rs, rt): self.rtype(28, rs, rt)
+    def ddiv(self, rs, rt): self.rtype(30, rs, rt)
+    def addu(self, rd, rs, rt): self.rtype(33, rs, rt, rd)
+    def subu(self, rd, rs, rt): self.rtype(35, rs, rt, rd)
+    def and_(self, rd, rs, rt): self.rtype(36, rs, rt, rd)
+    def or_(self, rd, rs, rt): self.rtype(37, rs, rt, rd)
+    def xor(self, rd, rs, rt): self.rtype(38, rs, rt, rd)
+
+    # COP0
+    def mfc0(self, rt, rd): self.word(16 << 26 | 0 << 21 | rt << 16 | rd << 11)
+    def mtc0(self, rt, rd): self.word(16 << 26 | 4 << 21 | rt << 16 | rd << 11)
+    def tlbwi(self): self.word(16 << 26 | 1 << 25 | 2)
+    def eret(self): self.word(16 << 26 | 1 << 25 | 24)
+
+    # COP1
+    def mfc1(self, rt, fs): self.word(17 << 26 | 0 << 21 | rt << 16 | fs << 11)
+    def cfc1(self, rt, fs): self.word(17 << 26 | 2 << 21 | rt << 16 | fs << 11)
+    def mtc1(self, rt, fs): self.word(17 << 26 | 4 << 21 | rt << 16 | fs << 11)
+    def ctc1(self, rt, fs): self.word(17 << 26 | 6 << 21 | rt << 16 | fs << 11)
+    def lwc1(self, ft, offset, base): self.itype(49, base, ft, offset)
+    def swc1(self, ft, offset, base): self.itype(57, base, ft, offset)
+    def sdc1(self, ft, offset, base): self.itype(61, base, ft, offset)
+
+    def fpu(self, funct, fmt, fd, fs, ft=0):
+        """COP1 arithmetic, fmt is 'S', 'D', 'W' or 'L'."""
+        self.word(17 << 26 | FMT[fmt] << 21 | ft << 16 | fs << 11 | fd << 6 | funct)
+
+    def add_fmt(self, fmt, fd, fs, ft): self.fpu(0, fmt, fd, fs, ft)
+    def sub_fmt(self, fmt, fd, fs, ft): self.fpu(1, fmt, fd, fs, ft)
+    def mul_fmt(self, fmt, fd, fs, ft): self.fpu(2, fmt, fd, fs, ft)
+    def div_fmt(self, fmt, fd, fs, ft): self.fpu(3, fmt, fd, fs, ft)
+    def sqrt_fmt(self, fmt, fd, fs): self.fpu(4, fmt, fd, fs)
+    def cvt_s(self, fmt, fd, fs): self.fpu(32, fmt, fd, fs)
+    def cvt_d(self, fmt, fd, fs): self.fpu(33, fmt, fd, fs)
+    def cvt_w(self, fmt, fd, fs): self.fpu(36, fmt, fd, fs)
+
+    # RCP
+    def wait_vi(self, tmp, addr_reg):
+        """Waits for the next VI interrupt and acknowledges it. Uses two
+        registers, addr_reg is left pointing at MI_INTR_REG."""
+        start = 'wait_vi_%d' % len(self.code)
+        self.li(addr_reg, MI_INTR_REG)
+        self.label(start)
+        self.lw(tmp, 0, addr_reg)
+        self.andi(tmp, tmp, MI_INTR_VI)
+        self.beq(tmp, ZERO, start)
+        self.nop()
+        self.li(addr_reg, VI_CURRENT_REG)
+        self.sw(ZERO, 0, addr_reg)
+        self.li(addr_reg, MI_INTR_REG)
+
+    def setup_vi(self, origin, tmp, addr_reg):
+        """Shows a 320x240 16-bit frame buffer at origin, an RDRAM address."""
+        self.li(addr_reg, VI_STATUS_REG)
+        for i, value in enumerate(VI_NTSC_320X240_16):
+            if value is not None:
+                self.li(tmp, value)
+                self.sw(tmp, 4 * i, addr_reg)
+        self.li(tmp, origin & 0x00FFFFFF)
+        self.sw(tmp, VI_ORIGIN_REG - VI_STATUS_REG, addr_reg)
+
+    def pi_dma(self, dram, rom_offset, length, tmp, addr_reg):
+        """Copies length bytes (even) of the ROM at rom_offset to RDRAM at
+        dram, and waits for the copy."""
+        start = 'pi_dma_%d' % len(self.code)
+        self.li(addr_reg, PI_DRAM_ADDR_REG)
+        self.li(tmp, dram & 0x00FFFFFF)
+        self.sw(tmp, 0, addr_reg)
+        self.li(tmp, CART_ADDR + rom_offset)
+        self.sw(tmp, PI_CART_ADDR_REG - PI_DRAM_ADDR_REG, addr_reg)
+        self.li(tmp, length - 1)
+        self.sw(tmp, PI_WR_LEN_REG - PI_DRAM_ADDR_REG, addr_reg)
+        self.label(start)
+        self.lw(tmp, PI_STATUS_REG - PI_DRAM_ADDR_REG, addr_reg)
+        self.andi(tmp, tmp, PI_STATUS_BUSY)
+        self.bne(tmp, ZERO, start)
+        self.nop()
+
+    def run_rdp(self, start, end, tmp, addr_reg):
+        """Has the RDP run the commands from start to end, RDRAM addresses."""
+        self.li(addr_reg, DPC_START_REG)
+        self.li(tmp, DPC_CLR_XBUS_DMEM_DMA)
+        self.sw(tmp, DPC_STATUS_REG - DPC_START_REG, addr_reg)
+        self.li(tmp, start & 0x00FFFFFF)
+        self.sw(tmp, 0, addr_reg)
+        self.li(tmp, end & 0x00FFFFFF)
+        self.sw(tmp, DPC_END_REG - DPC_START_REG, addr_reg)
+
+    def halt(self):
+        """Spins forever: an idle loop, which every core fast-forwards."""
+        name = 'halt_%d' % len(self.code)
+        self.label(name)
+        self.j(name)
+        self.nop()
+
+    def assemble(self):
+        code = list(self.code)
+        for pos, label, kind in self.fixups:
+            target = self.labels[label]
+            if kind == 'b':
+                code[pos] |= (target - pos - 1) & 0xFFFF
+            else:
+                code[pos] |= ((self.base + target * 4) >> 2) & 0x3FFFFFF
+        if len(code) > CODE_MAX:
+            raise ValueError('program of %d instructions does not fit in SP DMEM' % len(code))
+        return b''.join(struct.pack('>I', w) for w in code)
+
+    def blob(self, rom_offset, data):
+        """Puts data in the ROM at rom_offset, past the program (0x1000 on),
+        see pi_dma()."""
+        if rom_offset < 0x1000:
+            raise ValueError('data at %x would overwrite the program' % rom_offset)
+        self.blobs.append((rom_offset, bytes(data)))
+
+    def write(self, path, size=0x100000):
+        """Writes a big-endian (.z64) ROM holding the program."""
+        rom = bytearray(size)
+        # PI BSD domain 1 settings, clock rate, boot address
+        rom[0:12] = struct.pack('>III', 0x80371240, 0, 0x80000400)
+        rom[0x20:0x34] = b'N64 TEST ROM'.ljust(20)
+        code = self.assemble()
+        rom[0x40:0x40 + len(code)] = code
+        for offset, data in self.blobs:
+            rom[offset:offset + len(data)] = data
+        with open(path, 'wb') as f:
+            f.write(rom)
+
+
+# RDP commands, as big-endian bytes. Coordinates are in pixels, and are
+# given to the RDP in 10.2 fixed point. Image formats and sizes:
+FMT_RGBA, FMT_YUV, FMT_CI, FMT_IA, FMT_I = range(5)
+SIZ_4B, SIZ_8B, SIZ_16B, SIZ_32B = range(4)
+
+# set_other_modes() high word
+CYCLE_1, CYCLE_2 = 0 << 20, 1 << 20
+TEXTURE_CONVERT_FILTER = 6 << 9
+RGB_DITHER_NONE = 3 << 6
+ALPHA_DITHER_NONE = 3 << 4
+
+# combiner inputs of set_combine(): RGB a, b, c, d and alpha a, b, c, d
+CC_COMBINED, CC_TEXEL0, CC_TEXEL1, CC_PRIMITIVE, CC_SHADE, CC_ENVIRONMENT = range(6)
+CC_ONE, CC_ZERO = 6, 8          # a
+CC_C_SCALE, CC_C_COMBINED_ALPHA, CC_C_TEXEL0_ALPHA = 6, 7, 8
+CC_C_PRIMITIVE_ALPHA, CC_C_SHADE_ALPHA, CC_C_ENV_ALPHA = 10, 11, 12
+CC_C_PRIM_LOD_FRAC, CC_C_ZERO = 14, 16
+CC_D_ONE, CC_D_ZERO = 6, 7
+AC_COMBINED, AC_TEXEL0, AC_TEXEL1, AC_PRIMITIVE, AC_SHADE, AC_ENVIRONMENT, AC_ONE, AC_ZERO = range(8)
+AC_C_PRIM_LOD_FRAC = 6
+
+
+def _command(cmd, hi, lo=0):
+    return struct.pack('>II', cmd << 24 | (hi & 0x00FFFFFF), lo & 0xFFFFFFFF)
+
+
+def _xy(x, y):
+    return int(x * 4) << 12 | int(y * 4)
+
+
+def sync_pipe():
+    return _command(0x27, 0)
+
+
+def sync_load():
+    return _command(0x26, 0)
+
+
+def sync_full():
+    return _command(0x29, 0)
+
+
+def set_color_image(addr, width, fmt=FMT_RGBA, size=SIZ_16B):
+    return _command(0x3F, fmt << 21 | size << 19 | (width - 1), addr & 0x03FFFFFF)
+
+
+def set_texture_image(addr, width, fmt=FMT_RGBA, size=SIZ_16B):
+    return _command(0x3D, fmt << 21 | size << 19 | (width - 1), addr & 0x03FFFFFF)
+
+
+def set_scissor(x0, y0, x1, y1):
+    return _command(0x2D, _xy(x0, y0), _xy(x1, y1))
+
+
+def set_other_modes(hi, lo=0):
+    return _command(0x2F, hi, lo)
+
+
+def set_combine(cycle0, cycle1=None):
+    """A cycle is ((RGB a, b, c, d), (alpha a, b, c, d)), the second one is
+    the first one by default."""
+    (a0, b0, c0, d0), (aa0, ab0, ac0, ad0) = cycle0
+    (a1, b1, c1, d1), (aa1, ab1, ac1, ad1) = cycle1 or cycle0
+    hi = a0 << 20 | c0 << 15 | aa0 << 12 | ac0 << 9 | a1 << 5 | c1
+    lo = (b0 << 28 | b1 << 24 | aa1 << 21 | ac1 << 18 | d0 << 15 | ab0 << 12 |
+          ad0 << 9 | d1 << 6 | ab1 << 3 | ad1)
+    return _command(0x3C, hi, lo)
+
+
+def set_prim_color(rgba, lod_frac=0):
+    return _command(0x3A, lod_frac, rgba)
+
+
+def set_env_color(rgba):
+    return _command(0x3B, 0, rgba)
+
+
+def set_fill_color(value):
+    return _command(0x37, 0, value)
+
+
+def fill_rectangle(x0, y0, x1, y1):
+    """Fills from (x0, y0) up to (x1, y1) excluded, in 1 and 2 cycle modes."""
+    return _command(0x36, _xy(x1, y1), _xy(x0, y0))
+
+
+def set_tile(tile, line, tmem=0, fmt=FMT_RGBA, size=SIZ_16B):
+    """line and tmem are in 64-bit words. Clamps, without masks."""
+    return _command(0x35, fmt << 21 | size << 19 | line << 9 | tmem, tile << 24)
+
+
+def set_tile_size(tile, s0, t0, s1, t1):
+    return _command(0x32, _xy(s0, t0), tile << 24 | _xy(s1, t1))
+
+
+def load_tile(tile, s0, t0, s1, t1):
+    return _command(0x34, _xy(s0, t0), tile << 24 | _xy(s1, t1))
+
+
+def texture_rectangle(tile, x0, y0, x1, y1, s=0, t=0, dsdx=1.0, dtdy=1.0):
+    """Draws texels from (s, t) on, in 1 and 2 cycle modes."""
+    return (_command(0x24, _xy(x1, y1), tile << 24 | _xy(x0, y0)) +
+            struct.pack('>II', int(s * 32) << 16 | int(t * 32), int(dsdx * 1024) << 16 | int(dtdy * 1024)))
+
+
+def run(benchmark, core, rom, cpu, frames, options=(), verbose=False, result=False, log=False,
+        frame=False, savestates=False):
+    """Runs a ROM headless and returns RDRAM after the run. With result, log
+    and frame, returns a tuple of RDRAM, then the JSON result of the
+    benchmark, the log of the core and the last frame presented, which needs
+    GL (see read_frame()). With savestates, the benchmark saves and loads
+    states after the run and reports it in the result."""
+    with tempfile.TemporaryDirectory() as tmp:
+        rdram = os.path.join(tmp, 'rdram.bin')
+        cmd = [benchmark, '--frames', str(frames), '--cpu', cpu, '--rdram', rdram,
+               '--output', os.path.join(tmp, 'result.json')]
+        if frame:
+            cmd += ['--gl', '--frame', os.path.join(tmp, 'frame.pam')]
+        if savestates:
+            cmd += ['--savestates']
+        for option in options:
+            cmd += ['--option', option]
+        if log:
+            cmd += ['--verbose']
+        cmd += [core, rom]
+        process = subprocess.run(cmd, check=True,
+                                 stdout=None if verbose else subprocess.DEVNULL,
+                                 stderr=subprocess.PIPE if log else None if verbose else subprocess.DEVNULL,
+                                 universal_newlines=True)
+        with open(rdram, 'rb') as f:
+            returned = [f.read()]
+        if result:
+            with open(os.path.join(tmp, 'result.json')) as f:
+                returned.append(json.load(f))
+        if log:
+            returned.append(process.stderr)
+        if frame:
+            returned.append(read_frame(os.path.join(tmp, 'frame.pam')))
+        return returned[0] if len(returned) == 1 else tuple(returned)
+
+
+def read_frame(path):
+    """Reads a frame written by mupen64plus_benchmark --frame: returns its
+    width, height and RGBA pixels, top row first."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    end = data.index(b'ENDHDR\n')
+    header = dict(line.split(' ', 1) for line in data[:end].decode().split('\n')[1:] if line)
+    return int(header['WIDTH']), int(header['HEIGHT']), data[end + 7:]
+
+
+def read_words(rdram, addr, count):
+    """Reads 32-bit words at a KSEG0/KSEG1 address of an RDRAM dump. The core
+    keeps RDRAM as host-endian words."""
+    offset = addr & 0x1FFFFFFF
+    return list(struct.unpack_from('<%dI' % count, rdram, offset))
+
+
+def signed(value):
+    return value - (1 << 32) if value & 0x80000000 else value
@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+"""Accuracy harness of the per-instruction cycle costs (OpCostScale).
+
+  op_cost_harness.py [--benchmark FILE] [--core FILE] [--cpu NAME]...
+                     [--scale N]... [--count-per-op N] [--frames N]
+                     [--reference FILE] [--write-reference FILE]
+                     [--tolerance PERCENT] [--rom FILE]
+
+Builds a test ROM (see n64rom.py) which
+
+  - times 32 back to back instructions of every cost class of
+    mupen64plus-core/src/r4300/op_cost.c by reading the count register
+    around them,
+  - then counts, for VI_TRACE_LENGTH VIs, the iterations of a loop of
+    multiplies, divides and FPU operations run between two VI interrupts,
+
+and runs it with every CPU core and OpCostScale given. It reports the
+cycles each class costs per instruction next to what the cost model gives,
+and the iterations per VI.
+
+The harness fails (exit status 1) when
+
+  - a core does not charge a class what the model gives, or the cores do
+    not agree with each other,
+  - with --reference, the iterations per VI of a run differ by more than
+    --tolerance percent from the reference trace of the same scale.
+
+A reference trace is a previous --write-reference output, e.g. of a build
+known to match the timing of a game, or iterations per VI measured on a
+console with the ROM written by --rom.
+"""
+
+import argparse
+import json
+import os
+import sys
+import tempfile
+
+from n64rom import (Program, RESULTS, COUNT, STATUS, STATUS_CU1,
+                    T0, T1, T2, T3, T4, T5, T6, T7, S0, S1, S2, ZERO,
+                    read_words, run)
+
+REPEAT = 32
+VI_TRACE_LENGTH = 16
+OVERHEAD = RESULTS + 0xF8
+DONE = RESULTS + 0xFC
+VI_TRACE = RESULTS + 0x100
+
+# Latencies in PClock cycles minus the cycle of any instruction, as in
+# op_cost.c.
+CLASSES = [
+    ('none', 0, lambda p: p.addu(T7, T2, T3)),
+    ('mult', 4, lambda p: p.mult(T2, T3)),
+    ('dmult', 7, lambda p: p.dmult(T2, T3)),
+    ('div', 36, lambda p: p.div(T2, T3)),
+    ('ddiv', 68, lambda p: p.ddiv(T2, T3)),
+    ('add.s', 2, lambda p: p.add_fmt('S', 14, 6, 8)),
+    ('mul.s', 4, lambda p: p.mul_fmt('S', 14, 6, 8)),
+    ('mul.d', 7, lambda p: p.mul_fmt('D', 14, 10, 12)),
+    ('div.s', 28, lambda p: p.div_fmt('S', 14, 6, 8)),
+    ('div.d', 57, lambda p: p.div_fmt('D', 14, 10, 12)),
+    ('cvt.s.w', 4, lambda p: p.cvt_s('W', 14, 2)),
+]
+
+
+def build_rom(path):
+    p = Program()
+    p.li(T0, STATUS_CU1)
+    p.mtc0(T0, STATUS)
+    p.li(S0, RESULTS)
+    p.li(T2, 1000)
+    p.li(T3, 7)
+    p.mtc1(T2, 2)
+    p.mtc1(T3, 4)
+    p.cvt_s('W', 6, 2)
+    p.cvt_s('W', 8, 4)
+    p.cvt_d('W', 10, 2)
+    p.cvt_d('W', 12, 4)
+
+    # what reading the count register costs, without any instruction between
+    p.mfc0(T0, COUNT)
+    p.mfc0(T1, COUNT)
+    p.subu(T1, T1, T0)
+    p.sw(T1, OVERHEAD - RESULTS, S0)
+
+    for index, (name, latency, emit) in enumerate(CLASSES):
+        p.mfc0(T0, COUNT)
+        for _ in range(REPEAT):
+            emit(p)
+        p.mfc0(T1, COUNT)
+        p.subu(T1, T1, T0)
+        p.sw(T1, index * 4, S0)
+
+    p.wait_vi(T5, T6)
+    p.li(S1, VI_TRACE_LENGTH)
+    p.li(S2, VI_TRACE)
+    p.label('vi')
+    p.li(T4, 0)
+    p.label('work')
+    p.mult(T2, T3)
+    p.mflo(T7)
+    p.div(T2, T3)
+    p.mflo(T7)
+    p.mul_fmt('D', 14, 10, 12)
+    p.add_fmt('S', 16, 6, 8)
+    p.addiu(T4, T4, 1)
+    p.lw(T5, 0, T6)
+    p.andi(T5, T5, 0x08)
+    p.beq(T5, ZERO, 'work')
+    p.nop()
+    p.wait_vi(T5, T6)
+    p.sw(T4, 0, S2)
+    p.addiu(S2, S2, 4)
+    p.addiu(S1, S1, -1)
+    p.bne(S1, ZERO, 'vi')
+    p.nop()
+
+    p.li(T0, 1)
+    p.li(T1, DONE)
+    p.sw(T0, 0, T1)
+    p.halt()
+    p.write(path)
+
+
+def model_cycles(latency, scale, count_per_op):
+    """Cycles op_cost.c charges per instruction, the instruction included."""
+    slots = (latency * scale // 100 + count_per_op // 2) // count_per_op
+    return (1 + slots) * count_per_op
+
+
+def measure(args, rom, cpu, scale):
+    rdram = run(args.benchmark, args.core, rom, cpu, args.frames,
+                ['mupen64plus-OpCostScale=%d' % scale,
+                 'mupen64plus-CountPerOp=%d' % args.count_per_op])
+    if read_words(rdram, DONE, 1)[0] != 1:
+        raise SystemExit('%s did not finish the test ROM in %d VIs, raise --frames' % (cpu, args.frames))
+    overhead = read_words(rdram, OVERHEAD, 1)[0]
+    deltas = read_words(rdram, RESULTS, len(CLASSES))
+    return {
+        'ops': {name: (deltas[i] - overhead) / REPEAT for i, (name, _, _) in enumerate(CLASSES)},
+        'vi_trace': read_words(rdram, VI_TRACE, VI_TRACE_LENGTH),
+    }
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    root = os.path.join(here, '..', '..')
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--benchmark', default=os.path.join(root, 'mupen64plus_benchmark'))
+    parser.add_argument('--core', default=os.path.join(root, 'mupen64plus_libretro.so'))
+    parser.add_argument('--cpu', action='append')
+    parser.add_argument('--scale', action='append', type=int)
+    parser.add_argument('--count-per-op', type=int, default=2)
+    parser.add_argument('--frames', type=int, default=40)
+    parser.add_argument('--reference')
+    parser.add_argument('--write-reference')
+    parser.add_argument('--tolerance', type=float, default=2.0)
+    parser.add_argument('--rom')
+    args = parser.parse_args()
+    cpus = args.cpu or ['pure_interpreter', 'cached_interpreter', 'dynamic_recompiler']
+    scales = args.scale or [0, 100]
+
+    failures = []
+    results = {}
+    all_runs = {}
+    with tempfile.TemporaryDirectory() as tmp:
+        rom = args.rom or os.path.join(tmp, 'op_cost.z64')
+        build_rom(rom)
+
+        for scale in scales:
+            runs = {cpu: measure(args, rom, cpu, scale) for cpu in cpus}
+            all_runs[scale] = runs
+            results[str(scale)] = runs[cpus[0]]
+
+            print('OpCostScale %d%%, count per op %d: cycles per instruction' % (scale, args.count_per_op))
+            print('  %-8s %6s' % ('class', 'model') + ''.join(' %18s' % cpu for cpu in cpus))
+            for name, latency, _ in CLASSES:
+                model = model_cycles(latency, scale, args.count_per_op)
+                row = [runs[cpu]['ops'][name] for cpu in cpus]
+                print('  %-8s %6d' % (name, model) + ''.join(' %18.2f' % v for v in row))
+                for cpu, value in zip(cpus, row):
+                    if value != model:
+                        failures.append('%s, scale %d: %s costs %.2f cycles, the model %d'
+                                        % (cpu, scale, name, value, model))
+            print('  iterations per VI')
+            for cpu in cpus:
+                print('  %-20s %s' % (cpu, ' '.join(str(v) for v in runs[cpu]['vi_trace'])))
+            print()
+
+    if args.reference:
+        with open(args.reference) as f:
+            reference = json.load(f)
+        for scale in scales:
+            if str(scale) not in reference:
+                failures.append('no reference trace for scale %d' % scale)
+                continue
+            expected = reference[str(scale)]['vi_trace']
+            for cpu in cpus:
+                trace = all_runs[scale][cpu]['vi_trace']
+                worst = max(abs(a - b) * 100.0 / max(b, 1) for a, b in zip(trace, expected))
+                print('%s, scale %d: %.2f%% from the reference trace' % (cpu, scale, worst))
+                if worst > args.tolerance:
+                    failures.append('%s, scale %d: iterations per VI %.2f%% from the reference'
+                                    % (cpu, scale, worst))
+
+    if args.write_reference:
+        with open(args.write_reference, 'w') as f:
+            json.dump(results, f, indent=2)
+
+    for failure in failures:
+        print('FAIL: ' + failure)
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+"""Test of the GLideN64 renderer state carried in the savestates.
+
+  savestate_harness.py [--benchmark FILE] [--core FILE] [--frames N]
+                       [--rom FILE]
+
+Builds a test ROM (see n64rom.py) which, once, has the RDP draw a pattern
+in an off-screen frame buffer, then every VI draws a frame which depends on
+the renderer state of GLideN64 before it:
+
+  - a rectangle in the primitive color set by the frame before, which the
+    combiners of GLideN64 upload only when the color is set,
+  - a rectangle in the primitive color of this frame, which alternates
+    between two colors,
+  - a rectangle textured with the off-screen frame buffer, which only
+    GLideN64 holds: its RDRAM copy is empty.
+
+The ROM is run with mupen64plus_benchmark --gl --savestates and frame buffer
+emulation, which needs GL and runs on Mesa llvmpipe. The benchmark saves a
+state, runs a VI, loads the state back and runs the VI again: the frame must
+be the same, in flat and in compressed states. Loading the state must not leave GLideN64 with the
+colors of the VI run after the save, nor lose the off-screen buffer. Saving
+right after the load must give the same state again.
+"""
+
+import argparse
+import os
+import sys
+import tempfile
+
+from n64rom import (Program, T0, T1, S0, ZERO,
+                    CYCLE_1, TEXTURE_CONVERT_FILTER, RGB_DITHER_NONE, ALPHA_DITHER_NONE,
+                    CC_TEXEL0, CC_PRIMITIVE, CC_ZERO, CC_C_ZERO,
+                    AC_TEXEL0, AC_PRIMITIVE, AC_ZERO,
+                    sync_pipe, sync_load, sync_full, set_color_image, set_texture_image,
+                    set_scissor, set_other_modes, set_combine, set_prim_color, set_fill_color,
+                    fill_rectangle, set_tile, set_tile_size, load_tile, texture_rectangle, run)
+
+# RDRAM of the test: the frame buffer, the off-screen one and the lists
+FRAME_BUFFER = 0x00200000
+OFFSCREEN = 0x00280000
+LISTS = 0x00300000
+WIDTH, HEIGHT = 320, 240
+OFFSCREEN_SIZE = 32
+RECT_SIZE = 32
+ROM_DATA = 0x1000
+
+CYCLE_FILL = 3 << 20
+MODES = CYCLE_1 | TEXTURE_CONVERT_FILTER | RGB_DITHER_NONE | ALPHA_DITHER_NONE
+
+# the primitive colors of even and odd frames
+PRIMS = (0xE0803080, 0x2060C0FF)
+
+FLAT_PRIM = ((CC_ZERO, CC_ZERO, CC_C_ZERO, CC_PRIMITIVE), (AC_ZERO, AC_ZERO, AC_ZERO, AC_PRIMITIVE))
+TEXEL0 = ((CC_ZERO, CC_ZERO, CC_C_ZERO, CC_TEXEL0), (AC_ZERO, AC_ZERO, AC_ZERO, AC_TEXEL0))
+
+# name, top left corner
+RECTS = [('primitive of the frame before', (48, 104)),
+         ('primitive of the frame', (144, 104)),
+         ('off-screen buffer', (240, 104))]
+
+
+def offscreen_list():
+    """Quadrants of 4 colors in the off-screen buffer."""
+    half = OFFSCREEN_SIZE // 2
+    commands = [
+        set_color_image(OFFSCREEN, OFFSCREEN_SIZE),
+        set_scissor(0, 0, OFFSCREEN_SIZE, OFFSCREEN_SIZE),
+        set_other_modes(CYCLE_FILL),
+    ]
+    for i, color in enumerate((0xF801F801, 0x07C107C1, 0x003F003F, 0xFFFFFFFF)):
+        x, y = i % 2 * half, i // 2 * half
+        commands += [sync_pipe(), set_fill_color(color), fill_rectangle(x, y, x + half - 1, y + half - 1)]
+    commands.append(sync_full())
+    return b''.join(commands)
+
+
+def frame_list(prim):
+    def rect(i):
+        x, y = RECTS[i][1]
+        return x, y, x + RECT_SIZE, y + RECT_SIZE
+
+    return b''.join([
+        set_color_image(FRAME_BUFFER, WIDTH),
+        set_scissor(0, 0, WIDTH, HEIGHT),
+        set_other_modes(CYCLE_FILL),
+        set_fill_color(0x00010001),
+        fill_rectangle(0, 0, WIDTH - 1, HEIGHT - 1),
+        sync_pipe(),
+        set_other_modes(MODES),
+        set_combine(FLAT_PRIM),
+        fill_rectangle(*rect(0)),
+        sync_pipe(),
+        set_prim_color(prim),
+        fill_rectangle(*rect(1)),
+        sync_pipe(),
+        set_texture_image(OFFSCREEN, OFFSCREEN_SIZE),
+        set_tile(7, OFFSCREEN_SIZE * 2 // 8),
+        sync_load(),
+        load_tile(7, 0, 0, OFFSCREEN_SIZE - 1, OFFSCREEN_SIZE - 1),
+        sync_pipe(),
+        set_tile(0, OFFSCREEN_SIZE * 2 // 8),
+        set_tile_size(0, 0, 0, OFFSCREEN_SIZE - 1, OFFSCREEN_SIZE - 1),
+        set_combine(TEXEL0),
+        texture_rectangle(0, *rect(2)),
+        sync_full(),
+    ])
+
+
+def build_rom(path):
+    offscreen = offscreen_list()
+    # the frame lists follow the off-screen one, and have the same size
+    size = len(frame_list(0))
+    lists = [offscreen] + [frame_list(prim) for prim in PRIMS]
+    data = b''.join(lists)
+
+    p = Program()
+    p.setup_vi(FRAME_BUFFER, T0, T1)
+    p.pi_dma(LISTS, ROM_DATA, len(data), T0, T1)
+    # GLideN64 only makes frame buffers once the VI has a width
+    p.wait_vi(T0, T1)
+    p.run_rdp(LISTS, LISTS + len(offscreen), T0, T1)
+    # every VI, draws the frame with the primitive color S0 tells
+    p.li(S0, 0)
+    p.label('frame')
+    p.wait_vi(T0, T1)
+    p.bne(S0, ZERO, 'odd')
+    p.nop()
+    for i in range(len(PRIMS)):
+        if i:
+            p.label('odd')
+        start = LISTS + len(offscreen) + i * size
+        p.run_rdp(start, start + size, T0, T1)
+        p.j('frame')
+        p.xori(S0, S0, 1)
+    p.blob(ROM_DATA, data)
+    p.write(path)
+
+
+def rect_color(frame, i):
+    """The color in the middle of a rectangle of a frame."""
+    width, height, pixels = frame
+    x, y = RECTS[i][1]
+    x, y = (x + RECT_SIZE // 2) * width // WIDTH, (y + RECT_SIZE // 2) * height // HEIGHT
+    return pixels[(y * width + x) * 4:(y * width + x) * 4 + 3]
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    root = os.path.join(here, '..', '..')
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--benchmark', default=os.path.join(root, 'mupen64plus_benchmark'))
+    parser.add_argument('--core', default=os.path.join(root, 'mupen64plus_libretro.so'))
+    parser.add_argument('--frames', type=int, default=10)
+    parser.add_argument('--rom')
+    args = parser.parse_args()
+
+    failures = []
+    with tempfile.TemporaryDirectory() as tmp:
+        rom = args.rom or os.path.join(tmp, 'savestate.z64')
+        build_rom(rom)
+        for compression in ('False', 'True'):
+            _, result, frame = run(args.benchmark, args.core, rom, 'cached_interpreter', args.frames,
+                                   options=['mupen64plus-EnableFBEmulation=True',
+                                            'mupen64plus-SavestateCompression=' + compression],
+                                   result=True, frame=True, savestates=True)
+            name = 'compressed' if compression == 'True' else 'flat'
+
+            # the frame must depend on all of the state the test is about
+            width, _, pixels = frame
+            background = pixels[(2 * width + 2) * 4:(2 * width + 2) * 4 + 3]
+            colors = [rect_color(frame, i) for i in range(len(RECTS))]
+            for (rect, _), color in zip(RECTS, colors):
+                if color == background:
+                    failures.append('%s: %s not drawn' % (name, rect))
+            if colors[0] == colors[1]:
+                failures.append('%s: the primitive color does not alternate' % name)
+
+            state = result['savestate']
+            print('%-10s  roundtrip %-5s  video roundtrip %-5s' %
+                  (name, state['roundtrip'], state['video_roundtrip']))
+            if not state['roundtrip']:
+                failures.append('%s: saving after the load gives another state' % name)
+            if not state['video_roundtrip']:
+                failures.append('%s: the frame after the load differs from the one after the save' % name)
+            if compression == 'True' and not (state['corrupt_rejected'] and state['corrupt_intact']):
+                failures.append('%s: a corrupt state is loaded, or the load of it changes the state' % name)
+
+    for failure in failures:
+        print('FAIL ' + failure)
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,204 @@
+/* Micro benchmark of the r4300 TLB translation cache.
+ *
+ * Builds mupen64plus-core/src/r4300/tlb.c on its own and measures, for each
+ * TLB page size:
+ *
+ *   - the TLB write throughput: tlb_unmap and tlb_map of an entry, as done
+ *     by TLBWI and TLBWR,
+ *   - the TLB maintenance cost of a frame: rewriting every entry, then
+ *     translating accesses spread over a working set of pages.
+ *
+ * Results are printed as JSON:
+ *
+ *   mupen64plus_tlb_benchmark [options]
+ *
+ *   --writes N        TLB writes timed per page size (default 100000)
+ *   --frames N        frames timed per page size (default 1000)
+ *   --accesses N      translations per frame (default 20000)
+ *   --working-set N   distinct pages translated per frame (default 512)
+ *
+ * The tables are filled on demand by default, and eagerly when the benchmark
+ * is built with -DNEW_DYNAREC, like the core.
+ *
+ * The checksums of the code pages an entry maps, which TLBWI and TLBWR
+ * compute on the cached interpreter and the recompiler (interpreter_tlb.def),
+ * aren't part of it: run a ROM rewriting the entries of its code through
+ * mupen64plus_benchmark for those.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "api/m64p_types.h"
+#include "main/rom.h"
+#include "r4300/exception.h"
+#include "r4300/tlb.h"
+
+#define TLB_ENTRIES 32
+#define MAX_WORKING_SET 65536
+
+/* what tlb.c needs from the rest of the core */
+unsigned char isGoldeneyeRom = 0;
+m64p_rom_header ROM_HEADER;
+static unsigned long long refill_exceptions = 0;
+
+void TLB_refill_exception(uint32_t addresse, int w)
+{
+   (void)addresse;
+   (void)w;
+   refill_exceptions++;
+}
+
+static const unsigned int page_sizes[] =
+{
+   0x1000, 0x4000, 0x10000, 0x40000, 0x100000, 0x400000, 0x1000000
+};
+
+static unsigned int rng_state = 1;
+
+static unsigned int rng(void)
+{
+   rng_state = rng_state * 1103515245 + 12345;
+   return rng_state >> 8;
+}
+
+static double now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* entry idx maps two pages of page_size at idx * 2 * page_size, like a TLBWI
+ * with EntryLo0 and EntryLo1 valid, dirty and pointing to consecutive
+ * physical pages */
+static void write_entry(unsigned int idx, unsigned int page_size, unsigned int generation)
+{
+   tlb *entry = &tlb_e[idx];
+   unsigned int vaddr = idx * 2 * page_size;
+   unsigned int paddr = ((idx + generation) * 2 * page_size) & 0x7FFFFF & ~(page_size - 1);
+
+   tlb_unmap(entry);
+
+   memset(entry, 0, sizeof(*entry));
+   entry->mask = (page_size - 1) >> 12;
+   entry->vpn2 = vaddr >> 13;
+   entry->g = 1;
+   entry->pfn_even = paddr >> 12;
+   entry->pfn_odd = (paddr + page_size) >> 12;
+   entry->v_even = entry->v_odd = 1;
+   entry->d_even = entry->d_odd = 1;
+
+   entry->start_even = entry->vpn2 << 13;
+   entry->end_even = entry->start_even + (entry->mask << 12) + 0xFFF;
+   entry->phys_even = entry->pfn_even << 12;
+   entry->start_odd = entry->end_even + 1;
+   entry->end_odd = entry->start_odd + (entry->mask << 12) + 0xFFF;
+   entry->phys_odd = entry->pfn_odd << 12;
+
+   tlb_map(entry);
+}
+
+static void reset_tlb(void)
+{
+   memset(tlb_e, 0, sizeof(tlb_e));
+   tlb_reload();
+}
+
+static double bench_writes(unsigned int page_size, unsigned int writes)
+{
+   unsigned int i;
+   double start;
+
+   reset_tlb();
+   start = now_ns();
+   for (i = 0; i < writes; i++)
+      write_entry(i % TLB_ENTRIES, page_size, i / TLB_ENTRIES);
+
+   return writes / ((now_ns() - start) / 1e9);
+}
+
+static double bench_frames(unsigned int page_size, unsigned int frames,
+      unsigned int accesses, unsigned int working_set, uint32_t *checksum)
+{
+   static uint32_t addresses[MAX_WORKING_SET];
+   unsigned int frame, i;
+   double start;
+
+   reset_tlb();
+   for (i = 0; i < working_set; i++)
+      addresses[i] = rng() % (TLB_ENTRIES * 2 * page_size);
+
+   start = now_ns();
+   for (frame = 0; frame < frames; frame++)
+   {
+      for (i = 0; i < TLB_ENTRIES; i++)
+         write_entry(i, page_size, frame);
+
+      for (i = 0; i < accesses; i++)
+      {
+         uint32_t address = addresses[rng() % working_set];
+         *checksum += virtual_to_physical_address(address, i & 1);
+      }
+   }
+
+   return (now_ns() - start) / frames;
+}
+
+int main(int argc, char **argv)
+{
+   unsigned int writes = 100000, frames = 1000, accesses = 20000, working_set = 512;
+   uint32_t checksum = 0;
+   size_t i;
+   int arg;
+
+   for (arg = 1; arg < argc; arg++)
+   {
+      if (arg + 1 < argc && !strcmp(argv[arg], "--writes"))
+         writes = strtoul(argv[++arg], NULL, 0);
+      else if (arg + 1 < argc && !strcmp(argv[arg], "--frames"))
+         frames = strtoul(argv[++arg], NULL, 0);
+      else if (arg + 1 < argc && !strcmp(argv[arg], "--accesses"))
+         accesses = strtoul(argv[++arg], NULL, 0);
+      else if (arg + 1 < argc && !strcmp(argv[arg], "--working-set"))
+         working_set = strtoul(argv[++arg], NULL, 0);
+      else
+      {
+         fprintf(stderr, "usage: %s [--writes N] [--frames N] [--accesses N] [--working-set N]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   if (writes == 0 || frames == 0 || working_set == 0 || working_set > MAX_WORKING_SET)
+   {
+      fprintf(stderr, "invalid parameters\n");
+      return 1;
+   }
+
+   printf("{\n");
+#ifdef NEW_DYNAREC
+   printf("  \"fill\": \"eager\",\n");
+#else
+   printf("  \"fill\": \"lazy\",\n");
+#endif
+   printf("  \"accesses_per_frame\": %u,\n", accesses);
+   printf("  \"working_set\": %u,\n", working_set);
+   printf("  \"page_sizes\": [\n");
+   for (i = 0; i < sizeof(page_sizes) / sizeof(page_sizes[0]); i++)
+   {
+      double writes_per_s = bench_writes(page_sizes[i], writes);
+      double frame_ns = bench_frames(page_sizes[i], frames, accesses, working_set, &checksum);
+
+      printf("    { \"page_size\": %u, \"tlb_writes_per_s\": %.0f, \"frame_ns\": %.0f }%s\n",
+            page_sizes[i], writes_per_s, frame_ns,
+            i + 1 < sizeof(page_sizes) / sizeof(page_sizes[0]) ? "," : "");
+   }
+   printf("  ],\n");
+   printf("  \"refill_exceptions\": %llu,\n", refill_exceptions);
+   printf("  \"checksum\": \"%08x\"\n", checksum);
+   printf("}\n");
+
+   return 0;
+}
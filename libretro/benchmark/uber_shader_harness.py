@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+"""Test of the uber-shader of GLideN64 against the combiners it stands in for.
+
+  uber_shader_harness.py [--benchmark FILE] [--core FILE] [--frames N]
+                         [--tolerance N] [--rom FILE]
+
+Builds a test ROM (see n64rom.py) which has the RDP draw a rectangle with
+each of a set of combine modes: flat colors from the primitive and
+environment colors, a texture alone and blended with them, in 1 and 2 cycle
+modes. The ROM is run twice with mupen64plus_benchmark --gl, which needs GL
+and runs on Mesa llvmpipe:
+
+  - with mupen64plus-EnableAsyncShaderCompile=False, which draws with the
+    combiners compiled for each mode,
+  - with UberShaderOnly, which draws with the uber-shader, the combiners
+    only telling it which inputs to use.
+
+Each rectangle must be drawn (it is not the background), and must look the
+same in both runs, within --tolerance per 8-bit channel. The harness fails
+(exit status 1) when it does not, or when the uber-shader did not draw.
+
+Not tested: noise, LOD, shade and HW lighting, which the uber-shader
+does not emulate or the rectangles do not have.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import tempfile
+
+from n64rom import (Program, T0, T1, S0, ZERO, VI_ORIGIN_REG,
+                    CYCLE_1, CYCLE_2, TEXTURE_CONVERT_FILTER, RGB_DITHER_NONE, ALPHA_DITHER_NONE,
+                    CC_COMBINED, CC_TEXEL0, CC_PRIMITIVE, CC_ENVIRONMENT, CC_ONE, CC_ZERO,
+                    CC_C_TEXEL0_ALPHA, CC_C_ENV_ALPHA, CC_C_PRIM_LOD_FRAC, CC_C_ZERO, CC_D_ZERO,
+                    AC_COMBINED, AC_TEXEL0, AC_PRIMITIVE, AC_ENVIRONMENT, AC_ONE, AC_ZERO,
+                    sync_pipe, sync_load, sync_full, set_color_image, set_texture_image,
+                    set_scissor, set_other_modes, set_combine, set_prim_color, set_env_color,
+                    set_fill_color, fill_rectangle, set_tile, set_tile_size, load_tile,
+                    texture_rectangle, run)
+
+# RDRAM of the test: two frame buffers, the display lists and the texture
+FRAME_BUFFERS = (0x00200000, 0x00240000)
+LISTS = 0x00300000
+WIDTH, HEIGHT = 320, 240
+TEXTURE_SIZE = 32
+RECT_SIZE = 32
+ROM_DATA = 0x1000
+
+CYCLE_FILL = 3 << 20
+MODES = TEXTURE_CONVERT_FILTER | RGB_DITHER_NONE | ALPHA_DITHER_NONE
+
+PRIM = 0xE0803080
+ENV = 0x2060C0A0
+LOD_FRAC = 0x60
+
+FLAT_PRIM = ((CC_ZERO, CC_ZERO, CC_C_ZERO, CC_PRIMITIVE), (AC_ZERO, AC_ZERO, AC_ZERO, AC_PRIMITIVE))
+TEXEL0_PRIM = ((CC_TEXEL0, CC_ZERO, CC_PRIMITIVE, CC_D_ZERO), (AC_TEXEL0, AC_ZERO, AC_PRIMITIVE, AC_ZERO))
+ALPHA_ONE = (AC_ZERO, AC_ZERO, AC_ZERO, AC_ONE)
+
+# name, cycle type, textured, first cycle, second cycle
+COMBINES = [
+    ('primitive', CYCLE_1, False, FLAT_PRIM, None),
+    ('environment', CYCLE_1, False,
+     ((CC_ZERO, CC_ZERO, CC_C_ZERO, CC_ENVIRONMENT), (AC_ZERO, AC_ZERO, AC_ZERO, AC_ENVIRONMENT)), None),
+    ('lerp by env alpha', CYCLE_1, False,
+     ((CC_PRIMITIVE, CC_ENVIRONMENT, CC_C_ENV_ALPHA, CC_ENVIRONMENT),
+      (AC_PRIMITIVE, AC_ENVIRONMENT, AC_ENVIRONMENT, AC_ENVIRONMENT)), None),
+    ('lerp by prim lod frac', CYCLE_1, False,
+     ((CC_PRIMITIVE, CC_ENVIRONMENT, CC_C_PRIM_LOD_FRAC, CC_ENVIRONMENT), ALPHA_ONE), None),
+    ('one minus prim', CYCLE_1, False,
+     ((CC_ONE, CC_PRIMITIVE, CC_ENVIRONMENT, CC_D_ZERO), ALPHA_ONE), None),
+    ('texel0', CYCLE_1, True,
+     ((CC_ZERO, CC_ZERO, CC_C_ZERO, CC_TEXEL0), (AC_ZERO, AC_ZERO, AC_ZERO, AC_TEXEL0)), None),
+    ('texel0 * prim', CYCLE_1, True, TEXEL0_PRIM, None),
+    ('lerp by texel0 alpha', CYCLE_1, True,
+     ((CC_TEXEL0, CC_ENVIRONMENT, CC_C_TEXEL0_ALPHA, CC_ENVIRONMENT), ALPHA_ONE), None),
+    ('2 cycle texel0', CYCLE_2, True, TEXEL0_PRIM,
+     ((CC_COMBINED, CC_ENVIRONMENT, CC_C_ENV_ALPHA, CC_ENVIRONMENT), (AC_ZERO, AC_ZERO, AC_ZERO, AC_COMBINED))),
+    ('2 cycle flat', CYCLE_2, False,
+     ((CC_PRIMITIVE, CC_ENVIRONMENT, CC_C_PRIM_LOD_FRAC, CC_ENVIRONMENT), ALPHA_ONE),
+     ((CC_ONE, CC_COMBINED, CC_PRIMITIVE, CC_D_ZERO), (AC_ZERO, AC_ZERO, AC_ZERO, AC_COMBINED))),
+]
+
+
+def rect_origin(i):
+    return 16 + (i % 5) * 60, 40 + (i // 5) * 80
+
+
+def texture():
+    """RGBA 5551 texels: red and green ramps, blue and alpha patterns."""
+    texels = []
+    for y in range(TEXTURE_SIZE):
+        for x in range(TEXTURE_SIZE):
+            r, g, b = x * 31 // (TEXTURE_SIZE - 1), y * 31 // (TEXTURE_SIZE - 1), (x ^ y) & 31
+            a = 1 if (x // 4 + y // 4) % 2 else 0
+            texels.append(r << 11 | g << 6 | b << 1 | a)
+    return struct.pack('>%dH' % len(texels), *texels)
+
+
+def display_list(frame_buffer, texture_addr):
+    commands = [
+        set_color_image(frame_buffer, WIDTH),
+        set_scissor(0, 0, WIDTH, HEIGHT),
+        set_other_modes(CYCLE_FILL),
+        set_fill_color(0x00010001),
+        fill_rectangle(0, 0, WIDTH - 1, HEIGHT - 1),
+        sync_pipe(),
+        set_texture_image(texture_addr, TEXTURE_SIZE),
+        set_tile(7, TEXTURE_SIZE * 2 // 8),
+        sync_load(),
+        load_tile(7, 0, 0, TEXTURE_SIZE - 1, TEXTURE_SIZE - 1),
+        sync_pipe(),
+        set_tile(0, TEXTURE_SIZE * 2 // 8),
+        set_tile_size(0, 0, 0, TEXTURE_SIZE - 1, TEXTURE_SIZE - 1),
+        set_prim_color(PRIM, LOD_FRAC),
+        set_env_color(ENV),
+    ]
+    for i, (name, cycle_type, textured, cycle0, cycle1) in enumerate(COMBINES):
+        x, y = rect_origin(i)
+        commands += [sync_pipe(), set_other_modes(cycle_type | MODES), set_combine(cycle0, cycle1)]
+        if textured:
+            commands.append(texture_rectangle(0, x, y, x + RECT_SIZE, y + RECT_SIZE))
+        else:
+            commands.append(fill_rectangle(x, y, x + RECT_SIZE, y + RECT_SIZE))
+    commands.append(sync_full())
+    return b''.join(commands)
+
+
+def build_rom(path):
+    # the texture follows the two lists, which have the same size
+    size = len(display_list(0, 0))
+    lists = [display_list(frame_buffer, LISTS + 2 * size) for frame_buffer in FRAME_BUFFERS]
+    data = lists[0] + lists[1] + texture()
+
+    p = Program()
+    p.setup_vi(FRAME_BUFFERS[0], T0, T1)
+    p.pi_dma(LISTS, ROM_DATA, len(data), T0, T1)
+    # every VI, draws a frame buffer and shows it, S0 tells which one
+    p.li(S0, 0)
+    p.label('frame')
+    p.wait_vi(T0, T1)
+    p.bne(S0, ZERO, 'second')
+    p.nop()
+    for i, frame_buffer in enumerate(FRAME_BUFFERS):
+        if i:
+            p.label('second')
+        p.run_rdp(LISTS + i * size, LISTS + (i + 1) * size, T0, T1)
+        p.li(T1, VI_ORIGIN_REG)
+        p.li(T0, frame_buffer)
+        p.sw(T0, 0, T1)
+        p.j('frame')
+        p.xori(S0, S0, 1)
+    p.blob(ROM_DATA, data)
+    p.write(path)
+
+
+def rect_pixels(frame, i):
+    """The pixels of the rectangle of a combine mode in a frame, without
+    its edges, which the scaling to the output blurs."""
+    width, height, pixels = frame
+    x, y = rect_origin(i)
+    x0, x1 = (x + 1) * width // WIDTH, (x + RECT_SIZE - 1) * width // WIDTH
+    y0, y1 = (y + 1) * height // HEIGHT, (y + RECT_SIZE - 1) * height // HEIGHT
+    return [pixels[(row * width + x0) * 4:(row * width + x1) * 4] for row in range(y0, y1)]
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    root = os.path.join(here, '..', '..')
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--benchmark', default=os.path.join(root, 'mupen64plus_benchmark'))
+    parser.add_argument('--core', default=os.path.join(root, 'mupen64plus_libretro.so'))
+    parser.add_argument('--frames', type=int, default=10)
+    parser.add_argument('--tolerance', type=int, default=1)
+    parser.add_argument('--rom')
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        rom = args.rom or os.path.join(tmp, 'uber_shader.z64')
+        build_rom(rom)
+        runs = {}
+        for mode in ('False', 'UberShaderOnly'):
+            _, result, frame = run(args.benchmark, args.core, rom, 'cached_interpreter', args.frames,
+                                   options=['mupen64plus-EnableAsyncShaderCompile=' + mode,
+                                            'mupen64plus-EnableShadersStorage=False'],
+                                   result=True, frame=True)
+            runs[mode] = result, frame
+
+    failures = []
+    uses = runs['UberShaderOnly'][0]['shaders']['uber_shader_uses']
+    if uses == 0 or runs['False'][0]['shaders']['uber_shader_uses'] != 0:
+        failures.append('the uber-shader drew %d times with UberShaderOnly, %d times without' %
+                        (uses, runs['False'][0]['shaders']['uber_shader_uses']))
+    combiners, uber = runs['False'][1], runs['UberShaderOnly'][1]
+    width, _, pixels = combiners
+    background = pixels[(2 * width + 2) * 4:(2 * width + 3) * 4]
+    for i, combine in enumerate(COMBINES):
+        want, got = rect_pixels(combiners, i), rect_pixels(uber, i)
+        if all(row == background * (len(row) // 4) for row in want):
+            failures.append('%s: not drawn' % combine[0])
+            continue
+        diff = max(abs(a - b) for w, g in zip(want, got) for a, b in zip(w, g))
+        status = 'ok' if diff <= args.tolerance else 'WRONG'
+        print('%-24s largest difference %3d  %s' % (combine[0], diff, status))
+        if diff > args.tolerance:
+            failures.append('%s: the uber-shader differs by up to %d' % (combine[0], diff))
+    print('uber-shader draws: %d' % uses)
+
+    for failure in failures:
+        print('FAIL ' + failure)
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+    main()
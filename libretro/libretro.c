@@ -4,6 +4,7 @@
 
 #include "libretro.h"
 #include "libretro_private.h"
+#include "libretro_replay.h"
 #include "GLideN64_libretro.h"
 
 #include <libco.h>
@@ -14,11 +15,14 @@
 #include "plugin/plugin.h"
 #include "api/m64p_types.h"
 #include "r4300/r4300.h"
+#include "r4300/guest_profile.h"
 #include "memory/memory.h"
 #include "main/main.h"
 #include "main/cheat.h"
 #include "main/version.h"
 #include "main/savestates.h"
+#include "main/profile.h"
+#include "main/trace.h"
 #include "main/mupen64plus.ini.h"
 #include "api/m64p_config.h"
 #include "osal_files.h"
@@ -93,14 +97,26 @@ uint32_t txEnhancementMode = 0;
 uint32_t txHiresEnable = 0;
 uint32_t txHiresFullAlphaChannel = 0;
 uint32_t txFilterIgnoreBG = 0;
+uint32_t txAsyncFilter = 0;
 uint32_t MultiSampling = 0;
 uint32_t EnableFragmentDepthWrite = 0;
 uint32_t EnableShadersStorage = 0;
+uint32_t EnableAsyncShaderCompile = 0;
 uint32_t CropMode = 0;
+uint32_t FrameSkipMode = 0;
+uint32_t FrameSkipCount = 1;
 uint32_t EnableFBEmulation = 0;
 uint32_t CountPerOp = 0;
-
+uint32_t OpCostScale = 0;
+uint32_t LateInputPoll = 0;
+uint32_t SavestateCompression = 0;
+uint32_t AudioThread = 1;
+
+// 0: GLideN64, 1: no video output. The latter is not listed in the core
+// options, it lets the benchmark run the core without an OpenGL context.
+int gfxPlugin = 0;
 int rspMode = 0;
+int rspAsync = 0;
 // after the controller's CONTROL* member has been assigned we can update
 // them straight from here...
 extern struct
@@ -137,6 +153,10 @@ static void setup_variables(void)
             "RSP Mode; HLE|LLE" },
 #else
             "RSP Mode; HLE" },
+#endif
+#ifndef VC
+        { "mupen64plus-rsp-async",
+            "LLE RSP audio on a thread; False|True" },
 #endif
         { "mupen64plus-43screensize",
             "4:3 Resolution; 320x240|640x480|960x720|1280x960|1440x1080|1600x1200|1920x1440|2240x1680|2560x1920|2880x2160|3200x2400|3520x2640|3840x2880" },
@@ -156,9 +176,9 @@ static void setup_variables(void)
 #endif				
         { "mupen64plus-EnableCopyColorToRDRAM",
 #ifndef HAVE_OPENGLES
-            "Color buffer to RDRAM; Async|Sync|Off" },
+            "Color buffer to RDRAM (Adaptive slows the CPU down); Async|Sync|Adaptive|Off" },
 #else
-            "Color buffer to RDRAM; Off|Async|Sync" },
+            "Color buffer to RDRAM (Adaptive slows the CPU down); Off|Async|Sync|Adaptive" },
 #endif
 #if !defined(VC) && !defined(CLASSIC)
         { "mupen64plus-EnableCopyDepthToRDRAM",
@@ -183,14 +203,20 @@ static void setup_variables(void)
 #endif
         { "mupen64plus-EnableShadersStorage",
             "Cache GPU Shaders; True|False" },
+        { "mupen64plus-EnableAsyncShaderCompile",
+            "Compile GPU Shaders in background; False|True" },
         { "mupen64plus-CropMode",
             "Crop Mode; Auto|Off" },
+        { "mupen64plus-FrameSkip",
+            "Frame skip; Off|Auto|1|2|3" },
         { "mupen64plus-txFilterMode",
             "Texture filter; None|Smooth filtering 1|Smooth filtering 2|Smooth filtering 3|Smooth filtering 4|Sharp filtering 1|Sharp filtering 2" },
         { "mupen64plus-txEnhancementMode",
             "Texture Enhancement; None|As Is|X2|X2SAI|HQ2X|HQ2XS|LQ2X|LQ2XS|HQ4X|2xBRZ|3xBRZ|4xBRZ|5xBRZ|6xBRZ" },
         { "mupen64plus-txFilterIgnoreBG",
             "Filter background textures; True|False" },
+        { "mupen64plus-txAsyncFilter",
+            "Filter textures in background; False|True" },
         { "mupen64plus-txHiresEnable",
             "Use High-Res textures; False|True" },
         { "mupen64plus-txHiresFullAlphaChannel",
@@ -217,6 +243,14 @@ static void setup_variables(void)
            "Player 4 Pak; none|memory|rumble"},
         { "mupen64plus-CountPerOp",
             "Count Per Op; 0|1|2|3" },
+        { "mupen64plus-OpCostScale",
+            "Multi-cycle Op Cost (%); 0|50|100|150|200" },
+        { "mupen64plus-InputPoll",
+            "Input Polling; Early|Late" },
+        { "mupen64plus-SavestateCompression",
+            "Compressed Savestates; False|True" },
+        { "mupen64plus-AudioThread",
+            "Buffer and Resample Audio on a Thread; True|False" },
         { NULL, NULL },
     };
 
@@ -482,6 +516,16 @@ void update_variables()
 {
     struct retro_variable var;
 
+    var.key = "mupen64plus-gfxplugin";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        if (!strcmp(var.value, "none"))
+            gfxPlugin = 1;
+        else
+            gfxPlugin = 0;
+    }
+
     var.key = "mupen64plus-rspmode";
     var.value = NULL;
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
@@ -492,6 +536,16 @@ void update_variables()
             rspMode = 1;
     }
 
+    var.key = "mupen64plus-rsp-async";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        if (!strcmp(var.value, "True"))
+            rspAsync = 1;
+        else
+            rspAsync = 0;
+    }
+
     var.key = "mupen64plus-BilinearMode";
     var.value = NULL;
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
@@ -527,6 +581,8 @@ void update_variables()
             EnableCopyColorToRDRAM = 2;
         else if (!strcmp(var.value, "Sync"))
             EnableCopyColorToRDRAM = 1;
+        else if (!strcmp(var.value, "Adaptive"))
+            EnableCopyColorToRDRAM = 3;
         else
             EnableCopyColorToRDRAM = 0;
     }
@@ -639,6 +695,16 @@ void update_variables()
             txFilterIgnoreBG = 1;
     }
 
+    var.key = "mupen64plus-txAsyncFilter";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        if (!strcmp(var.value, "True"))
+            txAsyncFilter = 1;
+        else
+            txAsyncFilter = 0;
+    }
+
     var.key = "mupen64plus-txHiresEnable";
     var.value = NULL;
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
@@ -689,6 +755,19 @@ void update_variables()
             EnableShadersStorage = 0;
     }
 
+    var.key = "mupen64plus-EnableAsyncShaderCompile";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        if (!strcmp(var.value, "True"))
+            EnableAsyncShaderCompile = 1;
+        // Not offered to the user: the benchmark draws with the uber-shader only to test it
+        else if (!strcmp(var.value, "UberShaderOnly"))
+            EnableAsyncShaderCompile = 2;
+        else
+            EnableAsyncShaderCompile = 0;
+    }
+
     var.key = "mupen64plus-CropMode";
     var.value = NULL;
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
@@ -699,6 +778,24 @@ void update_variables()
             CropMode = 0;
     }
 
+    var.key = "mupen64plus-FrameSkip";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        if (!strcmp(var.value, "Auto"))
+        {
+            FrameSkipMode = 1;
+            FrameSkipCount = 3;
+        }
+        else if (!strcmp(var.value, "Off"))
+            FrameSkipMode = 0;
+        else
+        {
+            FrameSkipMode = 2;
+            FrameSkipCount = atoi(var.value);
+        }
+    }
+
     var.key = "mupen64plus-cpucore";
     var.value = NULL;
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
@@ -757,6 +854,42 @@ void update_variables()
         CountPerOp = atoi(var.value);
     }
 
+    var.key = "mupen64plus-OpCostScale";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        OpCostScale = atoi(var.value);
+    }
+
+    var.key = "mupen64plus-InputPoll";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        if (!strcmp(var.value, "Late"))
+            LateInputPoll = 1;
+        else
+            LateInputPoll = 0;
+    }
+
+    var.key = "mupen64plus-SavestateCompression";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        // compressed states have the size of what they compress to, and both
+        // kinds hold the video plugin state, whose size varies
+        uint64_t quirks = RETRO_SERIALIZATION_QUIRK_CORE_VARIABLE_SIZE;
+
+        SavestateCompression = !strcmp(var.value, "True");
+        environ_cb(RETRO_ENVIRONMENT_SET_SERIALIZATION_QUIRKS, &quirks);
+    }
+    savestates_set_compression(SavestateCompression);
+
+    // taken into account when the game is loaded
+    var.key = "mupen64plus-AudioThread";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+        AudioThread = !strcmp(var.value, "True");
+
     var.key = "mupen64plus-r-cbutton";
     var.value = NULL;
 
@@ -857,6 +990,27 @@ static bool context_framebuffer_lock(void *data)
     return true;
 }
 
+// Hidden options used by the benchmark to record or replay the input and
+// to write the state hashes of each frame, see libretro_replay.h.
+static bool init_replay(void)
+{
+    struct retro_variable record = { "mupen64plus-record-input", NULL };
+    struct retro_variable replay = { "mupen64plus-replay-input", NULL };
+    struct retro_variable hashes = { "mupen64plus-state-hashes", NULL };
+
+    environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &record);
+    environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &replay);
+    environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &hashes);
+
+    if (!replay_init(record.value, replay.value, hashes.value))
+    {
+        if (log_cb)
+            log_cb(RETRO_LOG_ERROR, "mupen64plus: can't open the input recording or state hash file.\n");
+        return false;
+    }
+    return true;
+}
+
 bool retro_load_game(const struct retro_game_info *game)
 {
     glsm_ctx_params_t params = {0};
@@ -865,7 +1019,7 @@ bool retro_load_game(const struct retro_game_info *game)
     update_variables();
     initial_boot = false;
 
-    init_audio_libretro(audio_buffer_size);
+    init_audio_libretro(audio_buffer_size, AudioThread);
 
     params.context_reset         = context_reset;
     params.context_destroy       = context_destroy;
@@ -874,7 +1028,7 @@ bool retro_load_game(const struct retro_game_info *game)
 
     params.framebuffer_lock      = context_framebuffer_lock;
 
-    if (!glsm_ctl(GLSM_CTL_STATE_CONTEXT_INIT, &params))
+    if (gfxPlugin == 0 && !glsm_ctl(GLSM_CTL_STATE_CONTEXT_INIT, &params))
     {
         if (log_cb)
             log_cb(RETRO_LOG_ERROR, "mupen64plus: libretro frontend doesn't have OpenGL support.");
@@ -888,33 +1042,106 @@ bool retro_load_game(const struct retro_game_info *game)
     if (!emu_step_load_data())
         return false;
 
-    first_context_reset = true;
+    if (!init_replay())
+        return false;
+
+    /* without video output there is no context to wait for */
+    if (gfxPlugin == 0)
+        first_context_reset = true;
+    else
+        emu_step_initialize();
 
     return true;
 }
 
+static void log_input_latency(void)
+{
+    unsigned frames, max_cycles;
+    unsigned long long cycles;
+
+    input_latency_get(&frames, &cycles, &max_cycles);
+    if (log_cb && frames > 0)
+        log_cb(RETRO_LOG_INFO, "mupen64plus: input latency of %s (%s polling): %llu cycles on average, %u at most, over %u frames\n",
+                ROM_PARAMS.headername, LateInputPoll ? "late" : "early",
+                cycles / frames, max_cycles, frames);
+}
+
+static void log_audio_stats(void)
+{
+    struct audio_libretro_stats stats;
+
+    audio_libretro_get_stats(&stats);
+    if (log_cb && stats.frames > 0)
+        log_cb(RETRO_LOG_INFO, "mupen64plus: audio ring at %u frames (%u at most), %u underruns and %llu frames dropped over %u frames\n",
+                stats.fill, stats.max_fill, stats.underruns, stats.dropped, stats.frames);
+}
+
 void retro_unload_game(void)
 {
+    log_input_latency();
+    log_audio_stats();
     CoreDoCommand(M64CMD_ROM_CLOSE, 0, NULL);
     emu_initialized = false;
+    replay_deinit();
 }
 
+#ifdef TRACE
+/* one retro_perf_counter per trace zone, in ns, updated after each frame */
+static struct retro_perf_counter trace_counters[TRACE_MAX_ZONES];
+static uint32_t trace_frame;
+
+static void update_trace_counters(void)
+{
+    struct trace_zone_stats zones[TRACE_MAX_ZONES];
+    unsigned count = trace_zones_get(zones, TRACE_MAX_ZONES);
+    unsigned i, k;
+
+    if (perf_cb.perf_register == NULL)
+        return;
+
+    for (i = 0; i < count; i++)
+    {
+        for (k = 0; k < TRACE_MAX_ZONES && trace_counters[k].ident != NULL
+                && trace_counters[k].ident != zones[i].name; k++);
+
+        if (k == TRACE_MAX_ZONES)
+            continue;
+
+        trace_counters[k].ident = zones[i].name;
+        trace_counters[k].total = zones[i].total_ns;
+        trace_counters[k].call_cnt = zones[i].count;
+        if (!trace_counters[k].registered)
+            perf_cb.perf_register(&trace_counters[k]);
+    }
+}
+#endif
+
 void retro_run (void)
 {
+    TRACE_BEGIN_ARG("retro_run", trace_frame++);
     libretro_swap_buffer = false;
     static bool updated = false;
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated)
         update_controllers();
-    glsm_ctl(GLSM_CTL_STATE_BIND, NULL);
+    if (gfxPlugin == 0)
+        glsm_ctl(GLSM_CTL_STATE_BIND, NULL);
     co_switch(game_thread);
-    glsm_ctl(GLSM_CTL_STATE_UNBIND, NULL);
+    if (gfxPlugin == 0)
+        glsm_ctl(GLSM_CTL_STATE_UNBIND, NULL);
+    flush_audio_libretro();
+    replay_end_frame();
     if (libretro_swap_buffer)
         video_cb(RETRO_HW_FRAME_BUFFER_VALID, retro_screen_width, retro_screen_height, 0);
+    TRACE_END();
+#ifdef TRACE
+    update_trace_counters();
+#endif
 }
 
 void retro_reset (void)
 {
     CoreDoCommand(M64CMD_RESET, 1, (void*)0);
+    reset_audio_libretro();
 }
 
 void *retro_get_memory_data(unsigned type)
@@ -941,7 +1168,11 @@ size_t retro_get_memory_size(unsigned type)
 
 size_t retro_serialize_size (void)
 {
-    return 16788288 + 1024 + 4; // < 16MB and some change... ouch
+    // the size of the states can't be told before the emulation runs
+    if (initializing)
+        return savestates_max_size_m64p();
+
+    return savestates_size_m64p();
 }
 
 bool retro_serialize(void *data, size_t size)
@@ -949,7 +1180,7 @@ bool retro_serialize(void *data, size_t size)
     if (initializing)
         return false;
 
-    int success = savestates_save_m64p(data);
+    int success = savestates_save_m64p(data, size);
     if (success)
         return true;
 
@@ -961,9 +1192,13 @@ bool retro_unserialize(const void * data, size_t size)
     if (initializing)
         return false;
 
-    int success = savestates_load_m64p(data);
+    int success = savestates_load_m64p(data, size);
     if (success)
+    {
+        // the audio of the frames before the load must not play after it
+        reset_audio_libretro();
         return true;
+    }
 
     return false;
 }
@@ -1047,7 +1282,85 @@ void retro_cheat_set(unsigned index, bool enabled, const char* codeLine)
 
 void retro_return(void)
 {
+#ifdef GUEST_PROFILE
+    guest_profile_pause(1);
+#endif
     co_switch(retro_thread);
+#ifdef GUEST_PROFILE
+    guest_profile_pause(0);
+#endif
+
+    // COP1 operations don't set the rounding mode, see fpu.h
+    restore_host_rounding_mode();
+}
+
+bool retro_get_timed_sections(long long int *nsec, unsigned num)
+{
+#ifdef PROFILE
+    long long int sections[NUM_TIMED_SECTIONS];
+    unsigned i;
+
+    timed_sections_get(sections);
+    for (i = 0; i < num && i < NUM_TIMED_SECTIONS; i++)
+        nsec[i] = sections[i];
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool retro_trace_dump(const char *path)
+{
+#ifdef TRACE
+    return trace_dump(path) != 0;
+#else
+    return false;
+#endif
+}
+
+bool retro_guest_profile_dump(const char *path)
+{
+#ifdef GUEST_PROFILE
+    return guest_profile_dump(path) != 0;
+#else
+    return false;
+#endif
+}
+
+bool retro_get_input_latency(unsigned *frames, unsigned long long *cycles, unsigned *max_cycles)
+{
+    input_latency_get(frames, cycles, max_cycles);
+    return true;
+}
+
+bool retro_get_audio_stats(unsigned *fill, unsigned *max_fill, unsigned *underruns, unsigned long long *dropped)
+{
+    struct audio_libretro_stats stats;
+
+    audio_libretro_get_stats(&stats);
+    *fill = stats.fill;
+    *max_fill = stats.max_fill;
+    *underruns = stats.underruns;
+    *dropped = stats.dropped;
+    return true;
+}
+
+bool retro_get_shader_stats(unsigned *compiled, unsigned *precompiled, unsigned *uber_shader_uses,
+      double *stall_ms, double *max_stall_ms)
+{
+    if (gfxPlugin != 0)
+        return false;
+    gliden64_get_shader_stats(compiled, precompiled, uber_shader_uses, stall_ms, max_stall_ms);
+    return true;
+}
+
+bool retro_get_frame_skip_stats(unsigned *frames, unsigned *skipped_frames, unsigned *readbacks,
+      unsigned long long *draw_calls, unsigned long long *triangles)
+{
+    if (gfxPlugin != 0)
+        return false;
+    gliden64_get_frame_skip_stats(frames, skipped_frames, readbacks, draw_calls, triangles);
+    return true;
 }
 
 uint32_t get_retro_screen_width()
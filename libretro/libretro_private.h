@@ -19,6 +19,60 @@ extern retro_perf_register_t perf_register_cb;
 bool libretro_swap_buffer;
 void retro_return();
 
+/* Not part of the libretro API, used by the benchmark.
+ * Fills nsec with the time spent in each enum timed_section (main/profile.h)
+ * since start. Returns false if the core was built without PROFILE. */
+RETRO_API bool retro_get_timed_sections(long long int *nsec, unsigned num);
+
+/* Not part of the libretro API, used by the benchmark.
+ * Writes the trace zones (main/trace.h) recorded so far to path, in the
+ * Chrome trace event format. Returns false if the core was built without
+ * TRACE or the file could not be written. */
+RETRO_API bool retro_trace_dump(const char *path);
+
+/* Not part of the libretro API, used by the benchmark.
+ * Writes the guest profile (r4300/guest_profile.h) of the run to path.
+ * Returns false if the core was built without GUEST_PROFILE or the file
+ * could not be written. */
+RETRO_API bool retro_guest_profile_dump(const char *path);
+
+/* Input latency since the game started: the emulated cycles from the poll
+ * of the input the game read to the VI that presents the frame, summed over
+ * the frames where the game read the controllers. Implemented in main.c. */
+void input_latency_get(unsigned *frames, unsigned long long *cycles, unsigned *max_cycles);
+
+/* Not part of the libretro API, used by the benchmark, see input_latency_get. */
+RETRO_API bool retro_get_input_latency(unsigned *frames, unsigned long long *cycles, unsigned *max_cycles);
+
+/* Not part of the libretro API, used by the benchmark. The audio output ring
+ * after the last frame: the output frames it holds and held at most, the
+ * frames it ran dry and the AI frames dropped on a full input ring, see
+ * audio_backend_libretro.c. */
+RETRO_API bool retro_get_audio_stats(unsigned *fill, unsigned *max_fill, unsigned *underruns, unsigned long long *dropped);
+
+/* Combiners of GLideN64 compiled while drawing and precompiled, draws with
+ * the uber-shader and the time drawing waited for compiles, in ms. Implemented
+ * in custom/GLideN64/MupenPlusPluginAPI.cpp. */
+void gliden64_get_shader_stats(unsigned *compiled, unsigned *precompiled, unsigned *uber_shader_uses,
+      double *stall_ms, double *max_stall_ms);
+
+/* Not part of the libretro API, used by the benchmark, see
+ * gliden64_get_shader_stats. Returns false without video output. */
+RETRO_API bool retro_get_shader_stats(unsigned *compiled, unsigned *precompiled, unsigned *uber_shader_uses,
+      double *stall_ms, double *max_stall_ms);
+
+/* Frames GLideN64 finished with frame skipping on and the ones it skipped,
+ * the frames read back to RDRAM and the draw calls and triangles it did not
+ * submit to GL while skipping.
+ * Implemented in custom/GLideN64/MupenPlusPluginAPI.cpp. */
+void gliden64_get_frame_skip_stats(unsigned *frames, unsigned *skipped_frames, unsigned *readbacks,
+      unsigned long long *draw_calls, unsigned long long *triangles);
+
+/* Not part of the libretro API, used by the benchmark, see
+ * gliden64_get_frame_skip_stats. Returns false without video output. */
+RETRO_API bool retro_get_frame_skip_stats(unsigned *frames, unsigned *skipped_frames, unsigned *readbacks,
+      unsigned long long *draw_calls, unsigned long long *triangles);
+
 #define SDL_GetTicks() FAKE_SDL_TICKS
 
 #ifdef __cplusplus
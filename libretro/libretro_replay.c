@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libretro_replay.h"
+#include "libretro_private.h"
+
+#include "main/main.h"
+#include "main/device.h"
+#include "r4300/r4300_core.h"
+
+#include "xxhash.h"
+
+#define REPLAY_CHANNELS 4
+
+struct replay_event
+{
+    unsigned frame;
+    enum replay_input_type type;
+    unsigned channel;
+    uint32_t value;
+};
+
+static const char *input_type_names[REPLAY_INPUT_TYPES] = { "keys", "connected" };
+
+static FILE *record_file = NULL;
+static FILE *hash_file   = NULL;
+
+static struct replay_event *events = NULL;
+static size_t num_events = 0;
+static size_t next_event = 0;
+static bool   replaying  = false;
+
+static unsigned frame = 0;
+
+/* last recorded or replayed value of each input */
+static uint32_t input_values[REPLAY_INPUT_TYPES][REPLAY_CHANNELS];
+static bool     input_known[REPLAY_INPUT_TYPES][REPLAY_CHANNELS];
+
+static XXH64_state_t *cpu_hash   = NULL;
+static XXH64_state_t *audio_hash = NULL;
+
+static bool load_recording(const char *path)
+{
+    char line[256];
+    unsigned line_number = 0;
+    size_t capacity = 0;
+    FILE *fp = fopen(path, "r");
+
+    if (!fp)
+        return false;
+
+    while (fgets(line, sizeof(line), fp))
+    {
+        struct replay_event event;
+        char type[16];
+        unsigned value;
+        int i;
+
+        line_number++;
+        if (line[0] == '#' || line[0] == '\n')
+            continue;
+
+        if (sscanf(line, "%u %15s %u %x", &event.frame, type, &event.channel, &value) != 4
+                || event.channel >= REPLAY_CHANNELS
+                || (num_events > 0 && event.frame < events[num_events - 1].frame))
+        {
+            if (log_cb)
+                log_cb(RETRO_LOG_ERROR, "mupen64plus: %s:%u: bad input record\n", path, line_number);
+            fclose(fp);
+            return false;
+        }
+
+        for (i = 0; i < REPLAY_INPUT_TYPES; i++)
+            if (!strcmp(type, input_type_names[i]))
+                break;
+        if (i == REPLAY_INPUT_TYPES)
+            continue;
+        event.type  = (enum replay_input_type)i;
+        event.value = value;
+
+        if (num_events == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 1024;
+            events = (struct replay_event*)realloc(events, capacity * sizeof(*events));
+        }
+        events[num_events++] = event;
+    }
+
+    fclose(fp);
+    return true;
+}
+
+/* Makes the inputs recorded up to the current frame visible to the game. */
+static void apply_recorded_inputs(void)
+{
+    while (next_event < num_events && events[next_event].frame <= frame)
+    {
+        const struct replay_event *event = &events[next_event++];
+        input_values[event->type][event->channel] = event->value;
+        input_known[event->type][event->channel]  = true;
+    }
+}
+
+bool replay_init(const char *record_path, const char *replay_path, const char *hash_path)
+{
+    replay_deinit();
+
+    if (replay_path && *replay_path)
+    {
+        if (!load_recording(replay_path))
+            return false;
+        replaying = true;
+        apply_recorded_inputs();
+        if (log_cb)
+            log_cb(RETRO_LOG_INFO, "mupen64plus: replaying %u input changes from %s\n",
+                    (unsigned)num_events, replay_path);
+    }
+    else if (record_path && *record_path)
+    {
+        record_file = fopen(record_path, "w");
+        if (!record_file)
+            return false;
+        fprintf(record_file, "# frame input channel value\n");
+    }
+
+    if (hash_path && *hash_path)
+    {
+        hash_file = fopen(hash_path, "w");
+        if (!hash_file)
+            return false;
+        fprintf(hash_file, "# frame rdram cpu audio\n");
+        cpu_hash   = XXH64_createState();
+        audio_hash = XXH64_createState();
+        XXH64_reset(audio_hash, 0);
+    }
+
+    return true;
+}
+
+void replay_deinit(void)
+{
+    if (record_file)
+        fclose(record_file);
+    if (hash_file)
+        fclose(hash_file);
+    if (cpu_hash)
+        XXH64_freeState(cpu_hash);
+    if (audio_hash)
+        XXH64_freeState(audio_hash);
+    free(events);
+
+    record_file = NULL;
+    hash_file   = NULL;
+    cpu_hash    = NULL;
+    audio_hash  = NULL;
+    events      = NULL;
+    num_events  = 0;
+    next_event  = 0;
+    replaying   = false;
+    frame       = 0;
+    memset(input_known, 0, sizeof(input_known));
+}
+
+uint32_t replay_input(enum replay_input_type type, int channel, uint32_t value)
+{
+    if (channel < 0 || channel >= REPLAY_CHANNELS)
+        return value;
+
+    /* a game reading an input earlier than in the recording gets the live one */
+    if (replaying)
+        return input_known[type][channel] ? input_values[type][channel] : value;
+
+    if (record_file && (!input_known[type][channel] || input_values[type][channel] != value))
+    {
+        fprintf(record_file, "%u %s %d %08x\n", frame, input_type_names[type], channel, value);
+        input_values[type][channel] = value;
+        input_known[type][channel]  = true;
+    }
+
+    return value;
+}
+
+void replay_audio(const void *buffer, size_t size)
+{
+    if (audio_hash)
+        XXH64_update(audio_hash, buffer, size);
+}
+
+static unsigned long long hash_cpu(void)
+{
+    XXH64_reset(cpu_hash, 0);
+    XXH64_update(cpu_hash, r4300_regs(), 32 * sizeof(int64_t));
+    XXH64_update(cpu_hash, r4300_mult_hi(), sizeof(int64_t));
+    XXH64_update(cpu_hash, r4300_mult_lo(), sizeof(int64_t));
+    XXH64_update(cpu_hash, r4300_pc(), sizeof(uint32_t));
+    XXH64_update(cpu_hash, r4300_cp0_regs(), CP0_REGS_COUNT * sizeof(uint32_t));
+    XXH64_update(cpu_hash, r4300_cp1_regs(), 32 * sizeof(int64_t));
+    XXH64_update(cpu_hash, r4300_cp1_fcr31(), sizeof(uint32_t));
+    return XXH64_digest(cpu_hash);
+}
+
+void replay_end_frame(void)
+{
+    if (hash_file)
+    {
+        const struct rdram *rdram = &g_dev.ri.rdram;
+
+        fprintf(hash_file, "%u %016llx %016llx %016llx\n", frame,
+                (unsigned long long)XXH64(rdram->dram, rdram->dram_size, 0),
+                hash_cpu(),
+                (unsigned long long)XXH64_digest(audio_hash));
+        XXH64_reset(audio_hash, 0);
+    }
+
+    frame++;
+    if (replaying)
+        apply_recorded_inputs();
+}
@@ -0,0 +1,40 @@
+#ifndef M64P_LIBRETRO_REPLAY_H
+#define M64P_LIBRETRO_REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <boolean.h>
+
+/* Input recording and replay, and per-frame state hashes.
+ *
+ * The recording holds what the game read from the controllers, after the
+ * libretro input was mapped to N64 buttons, so it replays the same way
+ * whatever the input options are. A frame is one retro_run, i.e. one VI.
+ *
+ * The hash file gets one line per frame with XXH64 hashes of RDRAM, of the
+ * CPU registers and of the audio samples the game sent during the frame.
+ * Two builds replaying the same recording can be compared line by line.
+ */
+
+enum replay_input_type
+{
+    REPLAY_KEYS,        /* BUTTONS.Value of a controller */
+    REPLAY_CONNECTED,   /* present | pak type << 1 */
+    REPLAY_INPUT_TYPES
+};
+
+/* Any path may be NULL. Returns false if a file can't be opened. */
+bool replay_init(const char *record_path, const char *replay_path, const char *hash_path);
+void replay_deinit(void);
+
+/* Called when the game reads a controller. Records value, or returns the
+ * recorded one when replaying. */
+uint32_t replay_input(enum replay_input_type type, int channel, uint32_t value);
+
+/* Samples sent to the audio output, in the byte order of the game. */
+void replay_audio(const void *buffer, size_t size);
+
+/* Called after each retro_run. */
+void replay_end_frame(void);
+
+#endif
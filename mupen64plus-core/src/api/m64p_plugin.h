@@ -212,6 +212,16 @@ EXPORT void CALL FBWrite(unsigned int addr, unsigned int size);
 EXPORT void CALL FBGetFrameBufferInfo(void *p);
 #endif
 
+/* savestate extension, optional: the video plugin state carried in the
+ * savestates. SaveState writes it to buffer if size is large enough and
+ * returns its size, LoadState returns 0 if it can't restore the state. */
+typedef unsigned int (*ptr_SaveState)(void *buffer, unsigned int size);
+typedef int (*ptr_LoadState)(const void *buffer, unsigned int size);
+#if defined(M64P_PLUGIN_PROTOTYPES)
+EXPORT unsigned int CALL SaveState(void *buffer, unsigned int size);
+EXPORT int CALL LoadState(const void *buffer, unsigned int size);
+#endif
+
 /* audio plugin function pointers */
 typedef void (*ptr_AiDacrateChanged)(int SystemType);
 typedef void (*ptr_AiLenChanged)(void);
@@ -259,9 +269,16 @@ EXPORT void CALL RenderCallback(void);
 /* RSP plugin function pointers */
 typedef unsigned int (*ptr_DoRspCycles)(unsigned int Cycles);
 typedef void (*ptr_InitiateRSP)(RSP_INFO Rsp_Info, unsigned int *CycleCount);
+typedef void (*ptr_StartRspCycles)(unsigned int Cycles);
+typedef unsigned int (*ptr_WaitRspCycles)(void);
 #if defined(M64P_PLUGIN_PROTOTYPES)
 EXPORT unsigned int CALL DoRspCycles(unsigned int Cycles);
 EXPORT void CALL InitiateRSP(RSP_INFO Rsp_Info, unsigned int *CycleCount);
+/* optional: same as DoRspCycles, but the task runs on a thread of the
+ * plugin until WaitRspCycles is called.  The task does not touch
+ * MI_INTR_REG:  WaitRspCycles returns the MI_INTR_REG bits it raised. */
+EXPORT void CALL StartRspCycles(unsigned int Cycles);
+EXPORT unsigned int CALL WaitRspCycles(void);
 #endif
 
 #ifdef __cplusplus
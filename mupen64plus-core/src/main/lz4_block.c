@@ -0,0 +1,241 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - lz4_block.c                                             *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "lz4_block.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define MIN_MATCH 4
+#define MAX_DISTANCE 0xffff
+/* the last match must start 12 bytes before the end of the block and end 5
+ * bytes before it, the block ending with literals */
+#define MF_LIMIT 12
+#define LAST_LITERALS 5
+
+/* 4096 entries, the 16KB of the reference implementation */
+#define HASH_LOG 12
+
+static uint32_t read32(const uint8_t* p)
+{
+    uint32_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static unsigned int hash32(uint32_t sequence)
+{
+    return (sequence * UINT32_C(2654435761)) >> (32 - HASH_LOG);
+}
+
+/* writes the extra bytes of a length which didn't fit in its 4 bits */
+static uint8_t* put_length(uint8_t* op, size_t length)
+{
+    for (; length >= 255; length -= 255)
+        *op++ = 255;
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+/* writes the literals [anchor, ip) and, if match_length isn't 0, the match
+ * following them; NULL if they don't fit before oend */
+static uint8_t* put_sequence(uint8_t* op, uint8_t* oend, const uint8_t* anchor, const uint8_t* ip,
+                             unsigned int offset, size_t match_length)
+{
+    size_t literals = (size_t)(ip - anchor);
+    uint8_t* token = op++;
+
+    /* token, lengths, literals and offset */
+    if ((size_t)(oend - op) < literals + literals / 255 + 1 + 2 + match_length / 255 + 1)
+        return NULL;
+
+    if (literals >= 15)
+    {
+        *token = 15 << 4;
+        op = put_length(op, literals - 15);
+    }
+    else
+        *token = (uint8_t)(literals << 4);
+
+    memcpy(op, anchor, literals);
+    op += literals;
+
+    if (match_length == 0)
+        return op;
+
+    *op++ = (uint8_t)offset;
+    *op++ = (uint8_t)(offset >> 8);
+
+    match_length -= MIN_MATCH;
+    if (match_length >= 15)
+    {
+        *token |= 15;
+        op = put_length(op, match_length - 15);
+    }
+    else
+        *token |= (uint8_t)match_length;
+
+    return op;
+}
+
+size_t lz4_compress_block(const void* src, size_t size, void* dst, size_t capacity)
+{
+    /* positions in src, only hints: every match is compared */
+    uint32_t table[1 << HASH_LOG];
+    const uint8_t* const base = (const uint8_t*)src;
+    const uint8_t* const iend = base + size;
+    const uint8_t* ip = base;
+    const uint8_t* anchor = base;
+    uint8_t* op = (uint8_t*)dst;
+    uint8_t* const oend = op + capacity;
+
+    if (size > MF_LIMIT)
+    {
+        const uint8_t* const mflimit = iend - MF_LIMIT;
+        const uint8_t* const matchlimit = iend - LAST_LITERALS;
+        unsigned int misses = 0;
+
+        memset(table, 0, sizeof(table));
+
+        while (ip <= mflimit)
+        {
+            uint32_t sequence = read32(ip);
+            unsigned int h = hash32(sequence);
+            const uint8_t* ref = base + table[h];
+            size_t length;
+
+            table[h] = (uint32_t)(ip - base);
+
+            if (ref >= ip || ip - ref > MAX_DISTANCE || read32(ref) != sequence)
+            {
+                /* skip faster through data which doesn't compress */
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            while (ip > anchor && ref > base && ip[-1] == ref[-1])
+            {
+                --ip;
+                --ref;
+            }
+
+            for (length = MIN_MATCH; ip + length < matchlimit && ip[length] == ref[length]; ++length);
+
+            op = put_sequence(op, oend, anchor, ip, (unsigned int)(ip - ref), length);
+            if (op == NULL)
+                return 0;
+
+            ip += length;
+            anchor = ip;
+
+            /* the position before the next one, for runs */
+            if (ip <= mflimit)
+                table[hash32(read32(ip - 2))] = (uint32_t)(ip - 2 - base);
+        }
+    }
+
+    op = put_sequence(op, oend, anchor, iend, 0, 0);
+    if (op == NULL)
+        return 0;
+
+    return (size_t)(op - (uint8_t*)dst);
+}
+
+/* reads the extra bytes of a length, 0 when the input ends first */
+static int get_length(const uint8_t** ip, const uint8_t* iend, size_t* length)
+{
+    uint8_t byte;
+
+    do
+    {
+        if (*ip >= iend)
+            return 0;
+        byte = *(*ip)++;
+        *length += byte;
+    } while (byte == 255);
+
+    return 1;
+}
+
+int lz4_decompress_block(const void* src, size_t size, void* dst, size_t dst_size)
+{
+    const uint8_t* ip = (const uint8_t*)src;
+    const uint8_t* const iend = ip + size;
+    uint8_t* const ostart = (uint8_t*)dst;
+    uint8_t* op = ostart;
+    uint8_t* const oend = op + dst_size;
+
+    for (;;)
+    {
+        uint8_t token;
+        size_t literals, length, offset;
+        const uint8_t* match;
+
+        if (ip >= iend)
+            return 0;
+        token = *ip++;
+
+        literals = token >> 4;
+        if (literals == 15 && !get_length(&ip, iend, &literals))
+            return 0;
+        if (literals > (size_t)(iend - ip) || literals > (size_t)(oend - op))
+            return 0;
+        memcpy(op, ip, literals);
+        op += literals;
+        ip += literals;
+
+        /* the last sequence has no match */
+        if (ip == iend)
+            break;
+
+        if (iend - ip < 2)
+            return 0;
+        offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - ostart))
+            return 0;
+
+        length = token & 15;
+        if (length == 15 && !get_length(&ip, iend, &length))
+            return 0;
+        length += MIN_MATCH;
+        if (length > (size_t)(oend - op))
+            return 0;
+
+        match = op - offset;
+        if (offset == 1)
+            memset(op, *match, length);
+        else if (offset >= length)
+            memcpy(op, match, length);
+        else
+        {
+            /* overlapping: the match repeats the last offset bytes */
+            size_t i;
+            for (i = 0; i < length; ++i)
+                op[i] = match[i];
+        }
+        op += length;
+    }
+
+    return op == oend;
+}
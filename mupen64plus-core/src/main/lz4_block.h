@@ -0,0 +1,46 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - lz4_block.h                                             *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef M64P_MAIN_LZ4_BLOCK_H
+#define M64P_MAIN_LZ4_BLOCK_H
+
+/* Compressor and decompressor of the LZ4 block format: a sequence of
+ * literals and matches within the last 64KB, with no framing, checksum or
+ * dictionary. The compressor is the greedy one of the reference
+ * implementation, fast enough to compress a savestate in a few ms per
+ * thread; the decompressor checks every length and offset, so that corrupt
+ * input fails instead of writing out of dst. */
+
+#include <stddef.h>
+
+/* worst case compressed size of size bytes */
+#define LZ4_BLOCK_BOUND(size) ((size) + (size) / 255 + 16)
+
+/* compresses src to dst, returns the compressed size, or 0 if it doesn't fit
+ * in capacity bytes */
+size_t lz4_compress_block(const void* src, size_t size, void* dst, size_t capacity);
+
+/* decompresses the size bytes of src to dst, returns 1 if they decode to
+ * exactly dst_size bytes, 0 otherwise */
+int lz4_decompress_block(const void* src, size_t size, void* dst, size_t dst_size);
+
+#endif /* M64P_MAIN_LZ4_BLOCK_H */
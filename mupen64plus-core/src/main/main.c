@@ -62,6 +62,7 @@
 #include "plugin/plugin.h"
 #include "plugin/rumble_via_input_plugin.h"
 #include "profile.h"
+#include "r4300/op_cost.h"
 #include "r4300/r4300.h"
 #include "r4300/reset.h"
 #include "rom.h"
@@ -91,7 +92,7 @@ int         g_MemHasBeenBSwapped = 0;   // store byte-swapped flag so we don't s
 int         g_EmulatorRunning = 0;      // need separate boolean to tell if emulator is running, since --nogui doesn't use a thread
 
 /* XXX: only global because of new dynarec linkage_x86.asm and plugin.c */
-ALIGN(16, uint32_t g_rdram[RDRAM_MAX_SIZE/4]);
+ALIGN(4096, uint32_t g_rdram[RDRAM_MAX_SIZE/4]);
 struct device g_dev;
 
 int g_delay_si = 0;
@@ -193,6 +194,10 @@ void main_check_inputs(void)
     SDL_PumpEvents();
 }
 
+void main_input_read(void)
+{
+}
+
 /*********************************************************************************************************
 * global functions, for adjusting the core emulator behavior
 */
@@ -244,6 +249,7 @@ int main_set_core_defaults(void)
     ConfigSetDefaultString(g_CoreConfig, "SharedDataPath", "", "Path to a directory to search when looking for shared data files");
     ConfigSetDefaultBool(g_CoreConfig, "DelaySI", 1, "Delay interrupt after DMA SI read/write");
     ConfigSetDefaultInt(g_CoreConfig, "CountPerOp", 0, "Force number of cycles per emulated instruction");
+    ConfigSetDefaultInt(g_CoreConfig, "OpCostScale", 0, "Force scale (in percent) of the extra cycles of multi-cycle instructions (0 = use ROM database)");
     ConfigSetDefaultBool(g_CoreConfig, "DisableSpecRecomp", 1, "Disable speculative precompilation in new dynarec");
 
     /* handle upgrades */
@@ -880,6 +886,7 @@ m64p_error main_run(void)
 {
     size_t i;
     unsigned int disable_extra_mem;
+    int op_cost_scale;
     struct storage_file eep;
     struct storage_file fla;
     struct storage_file mpk;
@@ -911,6 +918,8 @@ m64p_error main_run(void)
     count_per_op = ConfigGetParamInt(g_CoreConfig, "CountPerOp");
     if (count_per_op <= 0)
         count_per_op = ROM_PARAMS.countperop;
+    op_cost_scale = ConfigGetParamInt(g_CoreConfig, "OpCostScale");
+    op_cost_init(op_cost_scale > 0 ? op_cost_scale : ROM_PARAMS.opcostscale, count_per_op);
     cheat_add_hacks();
 
     /* do byte-swapping if it's not been done yet */
@@ -38,7 +38,8 @@ extern int g_MemHasBeenBSwapped;
 extern int g_EmulatorRunning;
 
 
-extern ALIGN(16, uint32_t g_rdram[RDRAM_MAX_SIZE/4]);
+/* page aligned, so that memory/fastmem.c can remap it */
+extern ALIGN(4096, uint32_t g_rdram[RDRAM_MAX_SIZE/4]);
 extern struct device g_dev;
 
 extern m64p_frame_callback g_FrameCallback;
@@ -51,6 +52,8 @@ const char* get_savestatepath(void);
 const char* get_savesrampath(void);
 
 void main_check_inputs(void);
+/* Called when the game reads the controllers through the PIF. */
+void main_input_read(void);
 
 void new_frame(void);
 void new_vi(void);
@@ -99,5 +99,12 @@ void timed_sections_refresh()
    }
 }
 
+void timed_sections_get(long long int nsec[NUM_TIMED_SECTIONS])
+{
+   int i;
+   for (i = 0; i < NUM_TIMED_SECTIONS; i++)
+      nsec[i] = time_to_nsec(time_in_section[i]);
+}
+
 #endif
 
@@ -38,6 +38,7 @@ enum timed_section
   void timed_section_start(enum timed_section section);
   void timed_section_end(enum timed_section section);
   void timed_sections_refresh(void);
+  void timed_sections_get(long long int nsec[NUM_TIMED_SECTIONS]);
 #else
   #define timed_section_start(a)
   #define timed_section_end(a)
@@ -40,6 +40,7 @@
 #include "memory/memory.h"
 #include "osal/preproc.h"
 #include "osd/osd.h"
+#include "r4300/op_cost.h"
 #include "r4300/r4300.h"
 #include "rom.h"
 #include "util.h"
@@ -178,6 +179,7 @@ m64p_error open_rom(const unsigned char* romimage, unsigned int size)
     /* add some useful properties to ROM_PARAMS */
     ROM_PARAMS.systemtype = rom_country_code_to_system_type(ROM_HEADER.Country_code);
     ROM_PARAMS.countperop = COUNT_PER_OP_DEFAULT;
+    ROM_PARAMS.opcostscale = OP_COST_SCALE_DEFAULT;
     ROM_PARAMS.cheats = NULL;
 
     memcpy(ROM_PARAMS.headername, ROM_HEADER.Name, 20);
@@ -199,6 +201,7 @@ m64p_error open_rom(const unsigned char* romimage, unsigned int size)
         ROM_SETTINGS.players = entry->players;
         ROM_SETTINGS.rumble = entry->rumble;
         ROM_PARAMS.countperop = entry->countperop;
+        ROM_PARAMS.opcostscale = entry->opcostscale;
         ROM_PARAMS.cheats = entry->cheats;
         g_alternate_vi_timing = entry->alternate_vi_timing;
         if (entry->count_per_scanline > 0)
@@ -213,6 +216,7 @@ m64p_error open_rom(const unsigned char* romimage, unsigned int size)
         ROM_SETTINGS.players = 0;
         ROM_SETTINGS.rumble = 0;
         ROM_PARAMS.countperop = COUNT_PER_OP_DEFAULT;
+        ROM_PARAMS.opcostscale = OP_COST_SCALE_DEFAULT;
         ROM_PARAMS.cheats = NULL;
     }
 
@@ -355,6 +359,12 @@ static size_t romdatabase_resolve_round(void)
             entry->entry.set_flags |= ROMDATABASE_ENTRY_COUNTEROP;
         }
 
+        if (!isset_bitmask(entry->entry.set_flags, ROMDATABASE_ENTRY_OPCOSTSCALE) &&
+            isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_OPCOSTSCALE)) {
+            entry->entry.opcostscale = ref->opcostscale;
+            entry->entry.set_flags |= ROMDATABASE_ENTRY_OPCOSTSCALE;
+        }
+
         if (!isset_bitmask(entry->entry.set_flags, ROMDATABASE_ENTRY_CHEATS) &&
             isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_CHEATS)) {
             if (ref->cheats)
@@ -452,6 +462,7 @@ void romdatabase_open(void)
             search->entry.players = DEFAULT;
             search->entry.rumble = DEFAULT; 
             search->entry.countperop = COUNT_PER_OP_DEFAULT;
+            search->entry.opcostscale = OP_COST_SCALE_DEFAULT;
             search->entry.cheats = NULL;
             search->entry.set_flags = ROMDATABASE_ENTRY_NONE;
 
@@ -579,6 +590,15 @@ void romdatabase_open(void)
                     DebugMessage(M64MSG_WARNING, "ROM Database: Invalid CountPerOp on line %i", lineno);
                 }
             }
+            else if(!strcmp(l.name, "OpCostScale"))
+            {
+                if (string_to_int(l.value, &value) && value >= 0 && value <= 400) {
+                    search->entry.opcostscale = value;
+                    search->entry.set_flags |= ROMDATABASE_ENTRY_OPCOSTSCALE;
+                } else {
+                    DebugMessage(M64MSG_WARNING, "ROM Database: Invalid OpCostScale on line %i", lineno);
+                }
+            }
             else if(!strncmp(l.name, "Cheat", 5))
             {
                 size_t len1 = 0, len2 = 0;
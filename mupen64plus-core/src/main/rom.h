@@ -54,6 +54,7 @@ typedef struct _rom_params
    m64p_system_type systemtype;
    char headername[21];  /* ROM Name as in the header, removing trailing whitespace */
    unsigned char countperop;
+   unsigned short opcostscale;
 } rom_params;
 
 extern m64p_rom_header   ROM_HEADER;
@@ -127,6 +128,7 @@ typedef struct
    unsigned char alternate_vi_timing;
    int count_per_scanline;
    unsigned char countperop;
+   unsigned short opcostscale;
    uint32_t set_flags;
 } romdatabase_entry;
 
@@ -139,7 +141,8 @@ enum romdatabase_entry_set_flags {
     ROMDATABASE_ENTRY_PLAYERS = BIT(4),
     ROMDATABASE_ENTRY_RUMBLE = BIT(5),
     ROMDATABASE_ENTRY_COUNTEROP = BIT(6),
-    ROMDATABASE_ENTRY_CHEATS = BIT(7)
+    ROMDATABASE_ENTRY_CHEATS = BIT(7),
+    ROMDATABASE_ENTRY_OPCOSTSCALE = BIT(8)
 };
 
 typedef struct _romdatabase_search
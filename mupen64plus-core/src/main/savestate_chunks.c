@@ -0,0 +1,647 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - savestate_chunks.c                                      *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "savestate_chunks.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <xxhash.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "lz4_block.h"
+#include "util.h"
+
+#ifdef __LIBRETRO__
+  #include <features/features_cpu.h>
+  #include <rthreads/rthreads.h>
+  #define SAVESTATE_CHUNK_THREADS
+#endif
+
+#define MAX_THREADS 8
+#define TABLE_ENTRY_SIZE 32
+
+enum chunk_codec
+{
+    CODEC_RAW  = 0,
+    CODEC_LZ4  = 1,
+    CODEC_ZERO = 2
+};
+
+struct chunk
+{
+    uint32_t section;
+    uint32_t offset;
+    uint32_t raw_size;
+    uint32_t stored_size;
+    uint32_t codec;
+    uint64_t hash;
+
+    /* section data of the chunk */
+    unsigned char* raw;
+    unsigned int word_size;
+    /* pack: stored data owned by the chunk, unpack: stored data in the
+     * container */
+    unsigned char* stored;
+    /* unpack: the checked raw data, little endian, until it is copied to
+     * raw */
+    unsigned char* decoded;
+    size_t capacity;
+    /* pack: hash and stored data are those of raw_size bytes at offset of
+     * section, from the previous pack */
+    int cached;
+    int failed;
+};
+
+static struct chunk* chunks;
+static unsigned int chunk_count;
+
+/* where the chunks are decompressed and checked before they are copied to
+ * the sections, kept from one unpack to the next */
+static unsigned char* scratch;
+static size_t scratch_size;
+
+/* Runs run on every chunk, on up to MAX_THREADS threads. */
+struct chunk_jobs
+{
+    struct chunk* chunks;
+    unsigned int count;
+    unsigned int next;
+    void (*run)(struct chunk*);
+#ifdef SAVESTATE_CHUNK_THREADS
+    slock_t* lock;
+#endif
+};
+
+static struct chunk* next_chunk(struct chunk_jobs* jobs)
+{
+    struct chunk* c = NULL;
+
+#ifdef SAVESTATE_CHUNK_THREADS
+    if (jobs->lock != NULL)
+        slock_lock(jobs->lock);
+#endif
+    if (jobs->next < jobs->count)
+        c = &jobs->chunks[jobs->next++];
+#ifdef SAVESTATE_CHUNK_THREADS
+    if (jobs->lock != NULL)
+        slock_unlock(jobs->lock);
+#endif
+
+    return c;
+}
+
+static void chunk_worker(struct chunk_jobs* jobs)
+{
+    struct chunk* c;
+
+    while ((c = next_chunk(jobs)) != NULL)
+        jobs->run(c);
+}
+
+#ifdef SAVESTATE_CHUNK_THREADS
+/* The workers are started by the first pack or unpack and kept until
+ * savestate_chunks_deinit. Every run_chunks posts its jobs with a new
+ * generation, the workers which wake up before the jobs are done help the
+ * calling thread with them. */
+static struct
+{
+    slock_t* lock;
+    scond_t* wake;
+    scond_t* idle;
+    sthread_t* threads[MAX_THREADS - 1];
+    unsigned int thread_count;
+    struct chunk_jobs* jobs;
+    unsigned int generation;
+    unsigned int busy;
+    int quit;
+    int started;
+} pool;
+
+static void pool_worker(void* arg)
+{
+    unsigned int generation = 0;
+
+    (void)arg;
+
+    slock_lock(pool.lock);
+    for (;;)
+    {
+        struct chunk_jobs* jobs;
+
+        while (!pool.quit && pool.generation == generation)
+            scond_wait(pool.wake, pool.lock);
+        if (pool.quit)
+            break;
+
+        generation = pool.generation;
+        jobs = pool.jobs;
+        if (jobs == NULL)
+            continue;
+
+        pool.busy++;
+        slock_unlock(pool.lock);
+        chunk_worker(jobs);
+        slock_lock(pool.lock);
+        if (--pool.busy == 0)
+            scond_signal(pool.idle);
+    }
+    slock_unlock(pool.lock);
+}
+
+static void pool_stop(void)
+{
+    unsigned int i;
+
+    if (pool.lock != NULL)
+    {
+        slock_lock(pool.lock);
+        pool.quit = 1;
+        scond_broadcast(pool.wake);
+        slock_unlock(pool.lock);
+    }
+
+    for (i = 0; i < pool.thread_count; i++)
+        sthread_join(pool.threads[i]);
+
+    if (pool.wake != NULL)
+        scond_free(pool.wake);
+    if (pool.idle != NULL)
+        scond_free(pool.idle);
+    if (pool.lock != NULL)
+        slock_free(pool.lock);
+    memset(&pool, 0, sizeof(pool));
+}
+
+static void pool_start(void)
+{
+    unsigned int thread_count = cpu_features_get_core_amount();
+
+    pool.started = 1;
+    if (thread_count > MAX_THREADS)
+        thread_count = MAX_THREADS;
+    if (thread_count < 2)
+        return;
+
+    pool.lock = slock_new();
+    pool.wake = scond_new();
+    pool.idle = scond_new();
+    if (pool.lock == NULL || pool.wake == NULL || pool.idle == NULL)
+    {
+        pool_stop();
+        pool.started = 1;
+        return;
+    }
+
+    /* the calling thread is one of them */
+    while (pool.thread_count < thread_count - 1)
+    {
+        sthread_t* thread = sthread_create(pool_worker, NULL);
+        if (thread == NULL)
+            break;
+        pool.threads[pool.thread_count++] = thread;
+    }
+}
+#endif
+
+static void run_chunks(struct chunk* list, unsigned int count, void (*run)(struct chunk*))
+{
+    struct chunk_jobs jobs;
+
+    jobs.chunks = list;
+    jobs.count = count;
+    jobs.next = 0;
+    jobs.run = run;
+
+#ifdef SAVESTATE_CHUNK_THREADS
+    jobs.lock = NULL;
+    if (!pool.started)
+        pool_start();
+
+    if (pool.thread_count != 0 && count > 1)
+    {
+        jobs.lock = pool.lock;
+
+        slock_lock(pool.lock);
+        pool.jobs = &jobs;
+        pool.generation++;
+        scond_broadcast(pool.wake);
+        slock_unlock(pool.lock);
+
+        chunk_worker(&jobs);
+
+        /* no worker takes the jobs once they are withdrawn */
+        slock_lock(pool.lock);
+        while (pool.busy != 0)
+            scond_wait(pool.idle, pool.lock);
+        pool.jobs = NULL;
+        slock_unlock(pool.lock);
+        return;
+    }
+#endif
+
+    chunk_worker(&jobs);
+}
+
+static int is_zero(const unsigned char* data, size_t size)
+{
+    return size == 0 || (data[0] == 0 && memcmp(data, data + 1, size - 1) == 0);
+}
+
+static void pack_chunk(struct chunk* c)
+{
+    const unsigned char* raw = c->raw;
+    unsigned char* swapped = NULL;
+    uint64_t hash;
+    size_t stored_size;
+
+#ifdef M64P_BIG_ENDIAN
+    if (c->word_size == 4)
+    {
+        swapped = (unsigned char*)malloc(c->raw_size);
+        if (swapped == NULL)
+        {
+            c->failed = 1;
+            return;
+        }
+        memcpy(swapped, c->raw, c->raw_size);
+        to_little_endian_buffer(swapped, 4, c->raw_size / 4);
+        raw = swapped;
+    }
+#endif
+
+    hash = XXH64(raw, c->raw_size, 0);
+    if (c->cached && c->hash == hash)
+    {
+        free(swapped);
+        return;
+    }
+    c->hash = hash;
+
+    if (is_zero(raw, c->raw_size))
+    {
+        c->codec = CODEC_ZERO;
+        c->stored_size = 0;
+        free(swapped);
+        return;
+    }
+
+    if (c->capacity < LZ4_BLOCK_BOUND(c->raw_size))
+    {
+        unsigned char* stored = (unsigned char*)realloc(c->stored, LZ4_BLOCK_BOUND(c->raw_size));
+        if (stored == NULL)
+        {
+            c->failed = 1;
+            free(swapped);
+            return;
+        }
+        c->stored = stored;
+        c->capacity = LZ4_BLOCK_BOUND(c->raw_size);
+    }
+
+    stored_size = lz4_compress_block(raw, c->raw_size, c->stored, c->capacity);
+    if (stored_size == 0 || stored_size >= c->raw_size)
+    {
+        c->codec = CODEC_RAW;
+        c->stored_size = c->raw_size;
+        memcpy(c->stored, raw, c->raw_size);
+    }
+    else
+    {
+        c->codec = CODEC_LZ4;
+        c->stored_size = (uint32_t)stored_size;
+    }
+
+    free(swapped);
+}
+
+size_t savestate_chunks_pack(const struct savestate_section* sections, unsigned int count)
+{
+    unsigned int i, n = 0;
+    size_t offset, size;
+
+    for (i = 0; i < count; i++)
+        n += (unsigned int)((sections[i].size + SAVESTATE_CHUNK_SIZE - 1) / SAVESTATE_CHUNK_SIZE);
+
+    if (n != chunk_count)
+    {
+        struct chunk* list;
+
+        for (i = n; i < chunk_count; i++)
+            free(chunks[i].stored);
+
+        list = (struct chunk*)realloc(chunks, n * sizeof(*list));
+        if (list == NULL && n != 0)
+        {
+            savestate_chunks_free();
+            return 0;
+        }
+        if (n > chunk_count)
+            memset(list + chunk_count, 0, (n - chunk_count) * sizeof(*list));
+        chunks = list;
+        chunk_count = n;
+    }
+
+    /* a chunk stays cached while the layout of the sections is the same */
+    n = 0;
+    for (i = 0; i < count; i++)
+    {
+        for (offset = 0; offset < sections[i].size; offset += SAVESTATE_CHUNK_SIZE, n++)
+        {
+            struct chunk* c = &chunks[n];
+            uint32_t raw_size = (uint32_t)(sections[i].size - offset);
+
+            if (raw_size > SAVESTATE_CHUNK_SIZE)
+                raw_size = SAVESTATE_CHUNK_SIZE;
+
+            c->cached = c->cached && c->section == sections[i].id && c->offset == offset
+                        && c->raw_size == raw_size && c->word_size == sections[i].word_size;
+            c->section = sections[i].id;
+            c->offset = (uint32_t)offset;
+            c->raw_size = raw_size;
+            c->raw = (unsigned char*)sections[i].data + offset;
+            c->word_size = sections[i].word_size;
+            c->failed = 0;
+        }
+    }
+
+    run_chunks(chunks, chunk_count, pack_chunk);
+
+    size = 4 + (size_t)chunk_count * TABLE_ENTRY_SIZE;
+    for (i = 0; i < chunk_count; i++)
+    {
+        if (chunks[i].failed)
+        {
+            DebugMessage(M64MSG_ERROR, "Insufficient memory to compress state.");
+            savestate_chunks_free();
+            return 0;
+        }
+        chunks[i].cached = 1;
+        size += chunks[i].stored_size;
+    }
+
+    return size;
+}
+
+static unsigned char* put32(unsigned char* out, uint32_t x)
+{
+    out[0] = (unsigned char)x;
+    out[1] = (unsigned char)(x >> 8);
+    out[2] = (unsigned char)(x >> 16);
+    out[3] = (unsigned char)(x >> 24);
+    return out + 4;
+}
+
+static uint32_t get32(const unsigned char* in)
+{
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+void savestate_chunks_write(unsigned char* out)
+{
+    unsigned int i;
+
+    out = put32(out, chunk_count);
+
+    for (i = 0; i < chunk_count; i++)
+    {
+        out = put32(out, chunks[i].section);
+        out = put32(out, chunks[i].offset);
+        out = put32(out, chunks[i].raw_size);
+        out = put32(out, chunks[i].stored_size);
+        out = put32(out, chunks[i].codec);
+        out = put32(out, 0);
+        out = put32(out, (uint32_t)chunks[i].hash);
+        out = put32(out, (uint32_t)(chunks[i].hash >> 32));
+    }
+
+    for (i = 0; i < chunk_count; i++)
+    {
+        memcpy(out, chunks[i].stored, chunks[i].stored_size);
+        out += chunks[i].stored_size;
+    }
+}
+
+void savestate_chunks_free(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < chunk_count; i++)
+        free(chunks[i].stored);
+    free(chunks);
+    chunks = NULL;
+    chunk_count = 0;
+
+    free(scratch);
+    scratch = NULL;
+    scratch_size = 0;
+}
+
+void savestate_chunks_deinit(void)
+{
+    savestate_chunks_free();
+#ifdef SAVESTATE_CHUNK_THREADS
+    pool_stop();
+#endif
+}
+
+/* Reads the table of the container to list (if not NULL), checking that the
+ * stored data is within the container. Returns the number of chunks,
+ * (unsigned int)-1 if the container is corrupt. */
+static unsigned int read_table(const unsigned char* data, size_t size, struct chunk* list)
+{
+    unsigned int i, count;
+    size_t stored_offset;
+
+    if (size < 4)
+        return (unsigned int)-1;
+
+    count = get32(data);
+    if (count > (size - 4) / TABLE_ENTRY_SIZE)
+        return (unsigned int)-1;
+
+    stored_offset = 4 + (size_t)count * TABLE_ENTRY_SIZE;
+    for (i = 0; i < count; i++)
+    {
+        const unsigned char* entry = data + 4 + (size_t)i * TABLE_ENTRY_SIZE;
+        uint32_t stored_size = get32(entry + 12);
+
+        if (stored_size > size - stored_offset)
+            return (unsigned int)-1;
+
+        if (list != NULL)
+        {
+            memset(&list[i], 0, sizeof(list[i]));
+            list[i].section = get32(entry);
+            list[i].offset = get32(entry + 4);
+            list[i].raw_size = get32(entry + 8);
+            list[i].stored_size = stored_size;
+            list[i].codec = get32(entry + 16);
+            list[i].hash = get32(entry + 24) | ((uint64_t)get32(entry + 28) << 32);
+            list[i].stored = (unsigned char*)data + stored_offset;
+        }
+        stored_offset += stored_size;
+    }
+
+    return count;
+}
+
+size_t savestate_chunks_section_size(const unsigned char* data, size_t size, uint32_t id)
+{
+    unsigned int i, count = read_table(data, size, NULL);
+    size_t section_size = 0;
+
+    if (count == (unsigned int)-1)
+        return 0;
+
+    for (i = 0; i < count; i++)
+    {
+        const unsigned char* entry = data + 4 + (size_t)i * TABLE_ENTRY_SIZE;
+        if (get32(entry) == id)
+            section_size += get32(entry + 8);
+    }
+
+    return section_size;
+}
+
+static void check_chunk(struct chunk* c)
+{
+    switch (c->codec)
+    {
+    case CODEC_RAW:
+        c->decoded = c->stored;
+        break;
+    case CODEC_LZ4:
+        if (!lz4_decompress_block(c->stored, c->stored_size, c->decoded, c->raw_size))
+        {
+            c->failed = 1;
+            return;
+        }
+        break;
+    case CODEC_ZERO:
+        memset(c->decoded, 0, c->raw_size);
+        break;
+    }
+
+    if (XXH64(c->decoded, c->raw_size, 0) != c->hash)
+        c->failed = 1;
+}
+
+static void copy_chunk(struct chunk* c)
+{
+    memcpy(c->raw, c->decoded, c->raw_size);
+
+    if (c->word_size == 4)
+        to_little_endian_buffer(c->raw, 4, c->raw_size / 4);
+}
+
+int savestate_chunks_unpack(const unsigned char* data, size_t size,
+                            const struct savestate_section* sections, unsigned int count)
+{
+    struct chunk* list;
+    size_t* filled;
+    size_t decoded_size = 0;
+    unsigned int i, k, chunks_in_container, n = 0;
+    int ok = 1;
+
+    chunks_in_container = read_table(data, size, NULL);
+    if (chunks_in_container == (unsigned int)-1)
+        return 0;
+
+    list = (struct chunk*)malloc((chunks_in_container + 1) * sizeof(*list));
+    filled = (size_t*)calloc(count + 1, sizeof(*filled));
+    if (list == NULL || filled == NULL)
+    {
+        free(list);
+        free(filled);
+        return 0;
+    }
+    read_table(data, size, list);
+
+    /* the chunks of a section must follow each other, and fill it */
+    for (i = 0; ok && i < chunks_in_container; i++)
+    {
+        struct chunk c = list[i];
+
+        for (k = 0; k < count && sections[k].id != c.section; k++);
+        if (k == count)
+            continue;
+
+        if (c.offset != filled[k] || c.raw_size > sections[k].size - filled[k]
+         || (sections[k].word_size == 4 && c.raw_size % 4 != 0)
+         || (c.codec == CODEC_RAW && c.stored_size != c.raw_size)
+         || (c.codec == CODEC_ZERO && c.stored_size != 0)
+         || c.codec > CODEC_ZERO)
+        {
+            ok = 0;
+            break;
+        }
+
+        c.raw = (unsigned char*)sections[k].data + c.offset;
+        c.word_size = sections[k].word_size;
+        list[n++] = c;
+        filled[k] += c.raw_size;
+        if (c.codec != CODEC_RAW)
+            decoded_size += c.raw_size;
+    }
+
+    for (k = 0; ok && k < count; k++)
+        ok = (filled[k] == sections[k].size);
+
+    if (ok && decoded_size > scratch_size)
+    {
+        unsigned char* buffer = (unsigned char*)realloc(scratch, decoded_size);
+        if (buffer == NULL)
+            ok = 0;
+        else
+        {
+            scratch = buffer;
+            scratch_size = decoded_size;
+        }
+    }
+
+    /* the sections are only written once every chunk is checked, a corrupt
+     * state leaves them as they were */
+    if (ok)
+    {
+        decoded_size = 0;
+        for (i = 0; i < n; i++)
+        {
+            if (list[i].codec != CODEC_RAW)
+            {
+                list[i].decoded = scratch + decoded_size;
+                decoded_size += list[i].raw_size;
+            }
+        }
+
+        run_chunks(list, n, check_chunk);
+        for (i = 0; i < n; i++)
+            ok = ok && !list[i].failed;
+
+        if (ok)
+            run_chunks(list, n, copy_chunk);
+    }
+
+    free(list);
+    free(filled);
+    return ok;
+}
@@ -0,0 +1,87 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - savestate_chunks.h                                      *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef M64P_MAIN_SAVESTATE_CHUNKS_H
+#define M64P_MAIN_SAVESTATE_CHUNKS_H
+
+/* Chunked container of the m64p savestates 2.0.
+ *
+ * The state is made of sections (the device state, RDRAM, plugin blobs),
+ * split in chunks of at most SAVESTATE_CHUNK_SIZE bytes which are compressed
+ * independently, in parallel, with the LZ4 block format. After the 44 byte
+ * savestate header come (integers little endian):
+ *
+ *   uint32 chunk count
+ *   per chunk: uint32 section, offset in the section, raw size, stored
+ *              size, codec, 0, uint64 XXH64 of the raw data
+ *   the stored data of the chunks, in the order of the table
+ *
+ * Chunks of zeros store nothing. The chunks of the last pack are kept, and
+ * chunks whose hash didn't change since are reused instead of compressed
+ * again, so consecutive saves only compress what the game wrote. Unknown
+ * sections are skipped by the loader. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SAVESTATE_CHUNK_SIZE 0x40000
+
+enum savestate_section_id
+{
+    SAVESTATE_SECTION_DEVICE = 1,
+    SAVESTATE_SECTION_RDRAM  = 2,
+    SAVESTATE_SECTION_PLUGIN = 3
+};
+
+struct savestate_section
+{
+    uint32_t id;
+    void* data;
+    size_t size;
+    /* 4 if data is made of host endian 32 bits words, stored little endian */
+    unsigned int word_size;
+};
+
+/* compresses the sections, returns the size of the container, 0 on failure;
+ * the container is kept until the next pack */
+size_t savestate_chunks_pack(const struct savestate_section* sections, unsigned int count);
+
+/* writes the container of the last pack to out */
+void savestate_chunks_write(unsigned char* out);
+
+/* frees the chunks kept from the last pack */
+void savestate_chunks_free(void);
+
+/* frees the chunks and stops the threads which pack and unpack them */
+void savestate_chunks_deinit(void);
+
+/* size of section id in the container, 0 if it isn't there */
+size_t savestate_chunks_section_size(const unsigned char* data, size_t size, uint32_t id);
+
+/* decompresses the chunks of the sections to their data, which the chunks
+ * must fill exactly; returns 0 if the container is corrupt. Every chunk is
+ * decompressed and checked against its hash before anything is written, so
+ * the data of the sections is left as it was on failure. */
+int savestate_chunks_unpack(const unsigned char* data, size_t size,
+                            const struct savestate_section* sections, unsigned int count);
+
+#endif /* M64P_MAIN_SAVESTATE_CHUNKS_H */
@@ -52,6 +52,7 @@
 #include "ri/ri_controller.h"
 #include "rom.h"
 #include "rsp/rsp_core.h"
+#include "savestate_chunks.h"
 #include "savestates.h"
 #include "si/si_controller.h"
 #include "util.h"
@@ -69,6 +70,7 @@
 
 static const char* savestate_magic = "M64+SAVE";
 static const int savestate_latest_version = 0x00010100;  /* 1.1 */
+static const int savestate_chunked_version = 0x00020000; /* 2.0, see savestate_chunks.h */
 static const unsigned char pj64_magic[4] = { 0xC8, 0xA6, 0xD8, 0x23 };
 
 static savestates_job job = savestates_job_nothing;
@@ -77,15 +79,36 @@ static char *fname = NULL;
 
 static unsigned int slot = 0;
 static int autoinc_save_slot = 0;
+static int compressed_savestates = 1;
 
 #ifdef USE_SDL
 static SDL_mutex *savestates_lock;
 #endif
 
+/* The m64p savestates 1.x are the 44 byte header and M64P_STATE_SIZE bytes of
+ * state, then the event queue and 4 bytes of additional data. The device
+ * section of the 2.0 ones is the same without RDRAM, which is a section of
+ * its own, and the TLB LUT, which is rebuilt from the TLB entries anyway. */
+#define M64P_STATE_SIZE 16788244
+#define M64P_TLB_LUT_SIZE (2 * 0x100000 * sizeof(uint32_t))
+#define M64P_DEVICE_STATE_SIZE (M64P_STATE_SIZE - RDRAM_MAX_SIZE - M64P_TLB_LUT_SIZE)
+
+/* The 1.1 savestates may end with the video plugin state: the 8 byte magic,
+ * its size as a uint32, then the state. Older loaders stop reading before
+ * it. */
+static const char* savestate_plugin_magic = "M64+GFXS";
+#define M64P_PLUGIN_HEADER_SIZE 12
+
+/* A video plugin state larger than this isn't saved, the plugin keeps its
+ * own state on load then, as with the states saved without it. It bounds the
+ * size of a savestate before the plugin runs. */
+#define M64P_PLUGIN_STATE_MAX_SIZE 0x400000
+
 struct savestate_work {
     char *filepath;
     char *data;
     size_t size;
+    int chunked;
     struct work_struct work;
 #ifdef __LIBRETRO__
     void *mempointer;
@@ -152,6 +175,13 @@ void savestates_set_autoinc_slot(int b)
     autoinc_save_slot = b;
 }
 
+/* Selects the m64p savestates written: chunked and compressed (2.0), or flat
+ * (1.1). Both are loaded, and both hold the video plugin state. */
+void savestates_set_compression(int b)
+{
+    compressed_savestates = b;
+}
+
 void savestates_inc_slot(void)
 {
     if(++slot>9)
@@ -199,24 +229,59 @@ static void savestates_clear_job(void)
 #define PUTDATA(buff, type, value) \
     do { type x = value; PUTARRAY(&x, buff, type, 1); } while(0)
 
+#ifndef __LIBRETRO__
+/* Reads the rest of f to a malloc'd buffer, NULL on failure. */
+static unsigned char *gzread_rest(gzFile f, size_t *size)
+{
+    size_t capacity = 0x400000;
+    unsigned char *data = malloc(capacity);
+    int n;
+
+    *size = 0;
+    while (data != NULL && (n = gzread(f, data + *size, (unsigned int)(capacity - *size))) > 0)
+    {
+        *size += n;
+        if (*size == capacity)
+        {
+            unsigned char *grown = realloc(data, capacity *= 2);
+            if (grown == NULL)
+                free(data);
+            data = grown;
+        }
+    }
+
+    if (data != NULL && n < 0)
+    {
+        free(data);
+        data = NULL;
+    }
+    return data;
+}
+#endif
+
 #ifndef __LIBRETRO__
 int savestates_load_m64p(char *filepath)
 #else
-int savestates_load_m64p(const void *data)
+int savestates_load_m64p(const void *data, size_t size)
 #endif
 {
     unsigned char header[44];
     unsigned int version;
-    int i;
+    int i, chunked;
     uint32_t FCR31;
 
     size_t savestateSize;
     unsigned char *savestateData, *curr;
     char queue[1024];
     unsigned char additionalData[4];
+    unsigned char *pluginData = NULL;
+    size_t pluginSize = 0;
 
     uint32_t* cp0_regs = r4300_cp0_regs();
 
+    /* the RSP state must not change under us */
+    rsp_wait_task(&g_dev.sp);
+
 #ifdef USE_SDL
     SDL_LockMutex(savestates_lock);
 #endif
@@ -255,6 +320,11 @@ int savestates_load_m64p(const void *data)
         return 0;
     }
 #else
+    if (size < 44)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Savestate is not a valid Mupen64plus savestate.");
+        return 0;
+    }
     memcpy(header, data, 44);
     curr = header;
     if(strncmp((char *)curr, savestate_magic, 8)!=0)
@@ -270,7 +340,8 @@ int savestates_load_m64p(const void *data)
     version = (version << 8) | *curr++;
     version = (version << 8) | *curr++;
     version = (version << 8) | *curr++;
-    if((version >> 16) != (savestate_latest_version >> 16))
+    chunked = (version >> 16) == (savestate_chunked_version >> 16);
+    if((version >> 16) != (savestate_latest_version >> 16) && !chunked)
     {
         main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State version (%08x) isn't compatible. Please update Mupen64Plus.", version);
 #ifndef __LIBRETRO__
@@ -296,7 +367,7 @@ int savestates_load_m64p(const void *data)
     curr += 32;
 
     /* Read the rest of the savestate */
-    savestateSize = 16788244;
+    savestateSize = chunked ? M64P_DEVICE_STATE_SIZE + sizeof(queue) + sizeof(additionalData) : M64P_STATE_SIZE;
     savestateData = curr = (unsigned char *)malloc(savestateSize);
     if (savestateData == NULL)
     {
@@ -309,7 +380,68 @@ int savestates_load_m64p(const void *data)
 #endif
         return 0;
     }
-    if (version == 0x00010000) /* original savestate version */
+#ifdef __LIBRETRO__
+    if (!chunked && size < 44 + savestateSize + sizeof(queue) + (version == 0x00010000 ? 0 : sizeof(additionalData)))
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Savestate is truncated.");
+        free(savestateData);
+        return 0;
+    }
+#endif
+    if (chunked)
+    {
+        /* RDRAM is decompressed in place, the rest to savestateData and
+         * pluginData; RDRAM is only written if the whole state is sound */
+        struct savestate_section sections[3] = {
+            { SAVESTATE_SECTION_DEVICE, savestateData, savestateSize, 1 },
+            { SAVESTATE_SECTION_RDRAM, g_dev.ri.rdram.dram, RDRAM_MAX_SIZE, 4 },
+            { SAVESTATE_SECTION_PLUGIN, NULL, 0, 1 }
+        };
+        unsigned int count = 2;
+        const unsigned char *container;
+        size_t container_size;
+        int unpacked;
+
+#ifndef __LIBRETRO__
+        unsigned char *fileData = gzread_rest(f, &container_size);
+        container = fileData;
+#else
+        container = (const unsigned char *)data + 44;
+        container_size = size - 44;
+#endif
+        /* the video plugin state is skipped if the plugin can't load it */
+        if (container != NULL && gfx.loadState != NULL)
+        {
+            pluginSize = savestate_chunks_section_size(container, container_size, SAVESTATE_SECTION_PLUGIN);
+            pluginData = pluginSize ? malloc(pluginSize) : NULL;
+            if (pluginData != NULL)
+            {
+                sections[2].data = pluginData;
+                sections[2].size = pluginSize;
+                count = 3;
+            }
+        }
+        unpacked = container != NULL && savestate_chunks_unpack(container, container_size, sections, count);
+#ifndef __LIBRETRO__
+        free(fileData);
+#endif
+        if (!unpacked)
+        {
+            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 2.0 data, the state is corrupt.");
+            free(pluginData);
+            free(savestateData);
+#ifndef __LIBRETRO__
+            gzclose(f);
+#endif
+#ifdef USE_SDL
+            SDL_UnlockMutex(savestates_lock);
+#endif
+            return 0;
+        }
+        memcpy(queue, savestateData + M64P_DEVICE_STATE_SIZE, sizeof(queue));
+        memcpy(additionalData, savestateData + M64P_DEVICE_STATE_SIZE + sizeof(queue), sizeof(additionalData));
+    }
+    else if (version == 0x00010000) /* original savestate version */
     {
 #ifndef __LIBRETRO__
         if (gzread(f, savestateData, savestateSize) != savestateSize ||
@@ -330,6 +462,8 @@ int savestates_load_m64p(const void *data)
     }
     else // version >= 0x00010100  saves entire eventqueue plus 4-byte using_tlb flage
     {
+        /* curr is left pointing to savestateData */
+        unsigned char pluginHeader[M64P_PLUGIN_HEADER_SIZE], *pluginCurr = pluginHeader + 8;
 #ifndef __LIBRETRO__
         if (gzread(f, savestateData, savestateSize) != savestateSize ||
             gzread(f, queue, sizeof(queue)) != sizeof(queue) ||
@@ -343,10 +477,49 @@ int savestates_load_m64p(const void *data)
 #endif
             return 0;
         }
+
+        /* the video plugin state is skipped if the plugin can't load it */
+        if (gfx.loadState != NULL &&
+            gzread(f, pluginHeader, sizeof(pluginHeader)) == sizeof(pluginHeader) &&
+            memcmp(pluginHeader, savestate_plugin_magic, 8) == 0)
+        {
+            pluginSize = GETDATA(pluginCurr, uint32_t);
+            pluginData = pluginSize ? malloc(pluginSize) : NULL;
+            if (pluginData != NULL && gzread(f, pluginData, pluginSize) != (int)pluginSize)
+            {
+                main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read the video plugin state from %s", filepath);
+                free(pluginData);
+                free(savestateData);
+                gzclose(f);
+#ifdef USE_SDL
+                SDL_UnlockMutex(savestates_lock);
+#endif
+                return 0;
+            }
+        }
 #else
+        size_t pluginOffset = 44 + savestateSize + sizeof(queue) + sizeof(additionalData);
+
         memcpy(savestateData, data + 44, savestateSize);
         memcpy(queue, data + 44 + savestateSize, sizeof(queue));
         memcpy(additionalData, data + 44 + savestateSize + sizeof(queue), sizeof(additionalData));
+
+        /* the video plugin state is skipped if the plugin can't load it */
+        if (gfx.loadState != NULL && size - pluginOffset >= M64P_PLUGIN_HEADER_SIZE &&
+            memcmp(data + pluginOffset, savestate_plugin_magic, 8) == 0)
+        {
+            memcpy(pluginHeader, data + pluginOffset, sizeof(pluginHeader));
+            pluginSize = GETDATA(pluginCurr, uint32_t);
+            if (pluginSize > size - pluginOffset - M64P_PLUGIN_HEADER_SIZE)
+            {
+                main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Savestate is truncated.");
+                free(savestateData);
+                return 0;
+            }
+            pluginData = pluginSize ? malloc(pluginSize) : NULL;
+            if (pluginData != NULL)
+                memcpy(pluginData, data + pluginOffset + M64P_PLUGIN_HEADER_SIZE, pluginSize);
+        }
 #endif
     }
 
@@ -472,7 +645,8 @@ int savestates_load_m64p(const void *data)
     g_dev.dp.dps_regs[DPS_BUFTEST_ADDR_REG] = GETDATA(curr, uint32_t);
     g_dev.dp.dps_regs[DPS_BUFTEST_DATA_REG] = GETDATA(curr, uint32_t);
 
-    COPYARRAY(g_dev.ri.rdram.dram, curr, uint32_t, RDRAM_MAX_SIZE/4);
+    if (!chunked)
+        COPYARRAY(g_dev.ri.rdram.dram, curr, uint32_t, RDRAM_MAX_SIZE/4);
     COPYARRAY(g_dev.sp.mem, curr, uint32_t, SP_MEM_SIZE/4);
     COPYARRAY(g_dev.si.pif.ram, curr, uint8_t, PIF_RAM_SIZE);
 
@@ -482,8 +656,9 @@ int savestates_load_m64p(const void *data)
     g_dev.pi.flashram.erase_offset = GETDATA(curr, unsigned int);
     g_dev.pi.flashram.write_pointer = GETDATA(curr, unsigned int);
 
-    COPYARRAY(tlb_LUT_r, curr, unsigned int, 0x100000);
-    COPYARRAY(tlb_LUT_w, curr, unsigned int, 0x100000);
+    /* tlb_LUT_r and tlb_LUT_w, rebuilt from the TLB entries below */
+    if (!chunked)
+        curr += M64P_TLB_LUT_SIZE;
 
     *r4300_llbit() = GETDATA(curr, unsigned int);
     COPYARRAY(r4300_regs(), curr, int64_t, 32);
@@ -525,6 +700,7 @@ int savestates_load_m64p(const void *data)
         tlb_e[i].end_odd = GETDATA(curr, unsigned int);
         tlb_e[i].phys_odd = GETDATA(curr, unsigned int);
     }
+    tlb_reload();
 
     savestates_load_set_pc(GETDATA(curr, uint32_t));
 
@@ -547,6 +723,11 @@ int savestates_load_m64p(const void *data)
 
     *r4300_last_addr() = *r4300_pc();
 
+    /* without it, the plugin goes on from its state before the load */
+    if (pluginData != NULL && !gfx.loadState(pluginData, (unsigned int)pluginSize))
+        DebugMessage(M64MSG_WARNING, "The video plugin couldn't restore its state from the savestate.");
+
+    free(pluginData);
     free(savestateData);
 #ifndef __LIBRETRO__
     main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State loaded from: %s", namefrompath(filepath));
@@ -570,6 +751,9 @@ static int savestates_load_pj64(char *filepath, void *handle,
 
     uint32_t* cp0_regs = r4300_cp0_regs();
 
+    /* the RSP state must not change under us */
+    rsp_wait_task(&g_dev.sp);
+
     /* Read and check Project64 magic number. */
     if (!read_func(handle, header, 8))
     {
@@ -759,8 +943,6 @@ static int savestates_load_pj64(char *filepath, void *handle,
     g_dev.si.regs[SI_STATUS_REG]         = GETDATA(curr, uint32_t);
 
     // tlb
-    memset(tlb_LUT_r, 0, 0x400000);
-    memset(tlb_LUT_w, 0, 0x400000);
     for (i=0; i < 32; i++)
     {
         unsigned int MyPageMask, MyEntryHi, MyEntryLo0, MyEntryLo1;
@@ -795,9 +977,8 @@ static int savestates_load_pj64(char *filepath, void *handle,
         tlb_e[i].end_odd = tlb_e[i].start_odd+
           (tlb_e[i].mask << 12) + 0xFFF;
         tlb_e[i].phys_odd = tlb_e[i].pfn_odd << 12;
-
-        tlb_map(&tlb_e[i]);
     }
+    tlb_reload();
 
     // pif ram
     COPYARRAY(g_dev.si.pif.ram, curr, uint8_t, PIF_RAM_SIZE);
@@ -912,6 +1093,8 @@ static savestates_type savestates_detect_type(char *filepath)
 
     if (magic[0] == 0x1f && magic[1] == 0x8b) // GZIP header
         return savestates_type_m64p;
+    else if (memcmp(magic, savestate_magic, 4) == 0) // M64P 2.0 header
+        return savestates_type_m64p;
     else if (memcmp(magic, "PK\x03\x04", 4) == 0) // ZIP header
         return savestates_type_pj64_zip;
     else if (memcmp(magic, pj64_magic, 4) == 0) // PJ64 header
@@ -984,7 +1167,12 @@ int savestates_load(void)
     {
         switch (type)
         {
+#ifndef __LIBRETRO__
             case savestates_type_m64p: ret = savestates_load_m64p(filepath); break;
+#else
+            /* the frontend loads and saves the m64p states, see retro_serialize */
+            case savestates_type_m64p: ret = 0; break;
+#endif
             case savestates_type_pj64_zip: ret = savestates_load_pj64_zip(filepath); break;
             case savestates_type_pj64_unc: ret = savestates_load_pj64_unc(filepath); break;
             default: ret = 0; break;
@@ -1010,27 +1198,43 @@ static void savestates_save_m64p_work(struct work_struct *work)
 #endif
 
 #ifndef __LIBRETRO__
-    // Write the state to a GZIP file
-    gzFile f;
-    f = gzopen(save->filepath, "wb");
-
-    if (f==NULL)
+    if (save->chunked)
     {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", save->filepath);
-        free(save->data);
-        return;
+        // Write the state as is, it's compressed already
+        FILE *f = fopen(save->filepath, "wb");
+        int written = f != NULL && fwrite(save->data, 1, save->size, f) == save->size;
+
+        if (f != NULL && fclose(f) != 0)
+            written = 0;
+        if (!written)
+            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not write data to state file: %s", save->filepath);
+        else
+            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Saved state to: %s", namefrompath(save->filepath));
     }
-
-    if (gzwrite(f, save->data, save->size) != save->size)
+    else
     {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not write data to state file: %s", save->filepath);
+        // Write the state to a GZIP file
+        gzFile f;
+        f = gzopen(save->filepath, "wb");
+
+        if (f==NULL)
+        {
+            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", save->filepath);
+            free(save->data);
+            return;
+        }
+
+        if (gzwrite(f, save->data, save->size) != save->size)
+        {
+            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not write data to state file: %s", save->filepath);
+            gzclose(f);
+            free(save->data);
+            return;
+        }
+
         gzclose(f);
-        free(save->data);
-        return;
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Saved state to: %s", namefrompath(save->filepath));
     }
-
-    gzclose(f);
-    main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Saved state to: %s", namefrompath(save->filepath));
 #else
     memcpy(save->mempointer, save->data, save->size);
 #endif
@@ -1045,59 +1249,39 @@ static void savestates_save_m64p_work(struct work_struct *work)
 #endif
 }
 
-#ifndef __LIBRETRO__
-int savestates_save_m64p(char *filepath)
-#else
-int savestates_save_m64p(void *data)
-#endif
+/* Returns the malloc'd m64p savestate: the header and the state, without RDRAM
+ * and the TLB LUT if chunked, the device section of the chunked savestates. */
+static char *savestates_build_m64p(int chunked, size_t *size)
 {
     unsigned char outbuf[4];
     int i;
+    int version = chunked ? savestate_chunked_version : savestate_latest_version;
 
     char queue[1024];
-
-    struct savestate_work *save;
-    char *curr;
+    char *data, *curr;
 
     uint32_t* cp0_regs = r4300_cp0_regs();
 
-    save = malloc(sizeof(*save));
-    if (!save) {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
-        return 0;
-    }
-
-#ifndef __LIBRETRO__
-    save->filepath = strdup(filepath);
-#else
-    save->mempointer = data;
-#endif
-
-    if(autoinc_save_slot)
-        savestates_inc_slot();
-
+    /* the same state must give the same savestate, for the chunks to be
+     * reused: no stack garbage after the end of the queue */
+    memset(queue, 0, sizeof(queue));
     save_eventqueue_infos(queue);
 
     // Allocate memory for the save state data
-    save->size = 16788288 + sizeof(queue) + 4;
-    save->data = curr = malloc(save->size);
-    if (save->data == NULL)
-    {
-        free(save->filepath);
-        free(save);
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
-        return 0;
-    }
+    *size = 44 + (chunked ? M64P_DEVICE_STATE_SIZE : M64P_STATE_SIZE) + sizeof(queue) + 4;
+    data = curr = malloc(*size);
+    if (data == NULL)
+        return NULL;
 
-    memset(save->data, 0, save->size);
+    memset(data, 0, *size);
 
     // Write the save state data to memory
     PUTARRAY(savestate_magic, curr, unsigned char, 8);
 
-    outbuf[0] = (savestate_latest_version >> 24) & 0xff;
-    outbuf[1] = (savestate_latest_version >> 16) & 0xff;
-    outbuf[2] = (savestate_latest_version >>  8) & 0xff;
-    outbuf[3] = (savestate_latest_version >>  0) & 0xff;
+    outbuf[0] = (version >> 24) & 0xff;
+    outbuf[1] = (version >> 16) & 0xff;
+    outbuf[2] = (version >>  8) & 0xff;
+    outbuf[3] = (version >>  0) & 0xff;
     PUTARRAY(outbuf, curr, unsigned char, 4);
 
     PUTARRAY(ROM_SETTINGS.MD5, curr, char, 32);
@@ -1242,7 +1426,10 @@ int savestates_save_m64p(void *data)
     PUTDATA(curr, uint32_t, g_dev.dp.dps_regs[DPS_BUFTEST_ADDR_REG]);
     PUTDATA(curr, uint32_t, g_dev.dp.dps_regs[DPS_BUFTEST_DATA_REG]);
 
-    PUTARRAY(g_dev.ri.rdram.dram, curr, uint32_t, RDRAM_MAX_SIZE/4);
+    if (!chunked)
+    {
+        PUTARRAY(g_dev.ri.rdram.dram, curr, uint32_t, RDRAM_MAX_SIZE/4);
+    }
     PUTARRAY(g_dev.sp.mem, curr, uint32_t, SP_MEM_SIZE/4);
     PUTARRAY(g_dev.si.pif.ram, curr, uint8_t, PIF_RAM_SIZE);
 
@@ -1252,8 +1439,12 @@ int savestates_save_m64p(void *data)
     PUTDATA(curr, unsigned int, g_dev.pi.flashram.erase_offset);
     PUTDATA(curr, unsigned int, g_dev.pi.flashram.write_pointer);
 
-    PUTARRAY(tlb_LUT_r, curr, unsigned int, 0x100000);
-    PUTARRAY(tlb_LUT_w, curr, unsigned int, 0x100000);
+    if (!chunked)
+    {
+        tlb_write_LUT((unsigned char*)curr, (unsigned char*)curr + 0x100000 * sizeof(uint32_t));
+        to_little_endian_buffer(curr, sizeof(uint32_t), 2 * 0x100000);
+        curr += M64P_TLB_LUT_SIZE;
+    }
 
     PUTDATA(curr, unsigned int, *r4300_llbit());
     PUTARRAY(r4300_regs(), curr, int64_t, 32);
@@ -1310,6 +1501,205 @@ int savestates_save_m64p(void *data)
     PUTDATA(curr, unsigned int, 0);
 #endif
 
+    return data;
+}
+
+/* Returns the malloc'd state of the video plugin, for it to render the first
+ * frames after a load like it did those after the save; NULL if it has none. */
+static unsigned int savestates_plugin_size(void)
+{
+    unsigned int plugin_size = gfx.saveState != NULL ? gfx.saveState(NULL, 0) : 0;
+
+    return plugin_size <= M64P_PLUGIN_STATE_MAX_SIZE ? plugin_size : 0;
+}
+
+static unsigned char *savestates_plugin_state(size_t *size)
+{
+    unsigned int plugin_size = savestates_plugin_size();
+    unsigned char *plugin;
+
+    if (plugin_size == 0)
+    {
+        if (gfx.saveState != NULL && gfx.saveState(NULL, 0) != 0)
+            DebugMessage(M64MSG_WARNING, "The video plugin state is too large to be saved.");
+        return NULL;
+    }
+
+    plugin = malloc(plugin_size);
+    if (plugin != NULL && gfx.saveState(plugin, plugin_size) != plugin_size)
+    {
+        free(plugin);
+        return NULL;
+    }
+
+    *size = plugin_size;
+    return plugin;
+}
+
+/* Appends the video plugin state to the 1.1 savestate data of *size bytes.
+ * Returns the grown data, NULL on failure, data is freed then. */
+static char *savestates_append_plugin_m64p(char *data, size_t *size)
+{
+    size_t plugin_size;
+    unsigned char *plugin = savestates_plugin_state(&plugin_size);
+    char *grown, *curr;
+
+    if (plugin == NULL)
+        return data;
+
+    grown = realloc(data, *size + M64P_PLUGIN_HEADER_SIZE + plugin_size);
+    if (grown == NULL)
+    {
+        free(plugin);
+        free(data);
+        return NULL;
+    }
+
+    curr = grown + *size;
+    PUTARRAY(savestate_plugin_magic, curr, unsigned char, 8);
+    PUTDATA(curr, uint32_t, (uint32_t)plugin_size);
+    memcpy(curr, plugin, plugin_size);
+    *size += M64P_PLUGIN_HEADER_SIZE + plugin_size;
+
+    free(plugin);
+    return grown;
+}
+
+/* Compresses the chunked savestate, keeping the container until the next
+ * pack. Returns its size, 0 on failure, and writes its header to header. */
+static size_t savestates_pack_m64p(unsigned char *header)
+{
+    struct savestate_section sections[3];
+    unsigned int count = 2;
+    size_t size, container_size, plugin_size;
+    unsigned char *plugin;
+    char *device = savestates_build_m64p(1, &size);
+
+    if (device == NULL)
+        return 0;
+
+    sections[0].id = SAVESTATE_SECTION_DEVICE;
+    sections[0].data = device + 44;
+    sections[0].size = size - 44;
+    sections[0].word_size = 1;
+    sections[1].id = SAVESTATE_SECTION_RDRAM;
+    sections[1].data = g_dev.ri.rdram.dram;
+    sections[1].size = RDRAM_MAX_SIZE;
+    sections[1].word_size = 4;
+
+    plugin = savestates_plugin_state(&plugin_size);
+    if (plugin != NULL)
+    {
+        sections[2].id = SAVESTATE_SECTION_PLUGIN;
+        sections[2].data = plugin;
+        sections[2].size = plugin_size;
+        sections[2].word_size = 1;
+        count = 3;
+    }
+
+    container_size = savestate_chunks_pack(sections, count);
+
+    memcpy(header, device, 44);
+    free(plugin);
+    free(device);
+    return container_size;
+}
+
+#ifdef __LIBRETRO__
+size_t savestates_size_m64p(void)
+{
+    unsigned char header[44];
+    size_t container_size;
+
+    /* the RSP state must not change under us */
+    rsp_wait_task(&g_dev.sp);
+
+    if (!compressed_savestates)
+    {
+        unsigned int plugin_size = savestates_plugin_size();
+        return 44 + M64P_STATE_SIZE + 1024 + 4 + (plugin_size ? M64P_PLUGIN_HEADER_SIZE + plugin_size : 0);
+    }
+
+    /* the state saved next reuses the chunks which didn't change since */
+    container_size = savestates_pack_m64p(header);
+    return container_size ? 44 + container_size : 0;
+}
+
+size_t savestates_max_size_m64p(void)
+{
+    /* a container stores its chunks at most raw, and has no TLB LUT, so it
+     * is smaller than the flat state */
+    return 44 + M64P_STATE_SIZE + 1024 + 4 + M64P_PLUGIN_HEADER_SIZE + M64P_PLUGIN_STATE_MAX_SIZE;
+}
+#endif
+
+#ifndef __LIBRETRO__
+int savestates_save_m64p(char *filepath)
+#else
+int savestates_save_m64p(void *data, size_t size)
+#endif
+{
+    struct savestate_work *save;
+
+    /* the RSP state must not change under us */
+    rsp_wait_task(&g_dev.sp);
+
+    save = malloc(sizeof(*save));
+    if (!save) {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
+        return 0;
+    }
+
+#ifndef __LIBRETRO__
+    save->filepath = strdup(filepath);
+#else
+    save->mempointer = data;
+#endif
+
+    if(autoinc_save_slot)
+        savestates_inc_slot();
+
+    save->chunked = compressed_savestates;
+    if (save->chunked)
+    {
+        unsigned char header[44];
+        size_t container_size = savestates_pack_m64p(header);
+
+        save->size = 44 + container_size;
+        save->data = container_size ? malloc(save->size) : NULL;
+        if (save->data != NULL)
+        {
+            memcpy(save->data, header, 44);
+            savestate_chunks_write((unsigned char *)save->data + 44);
+        }
+    }
+    else
+    {
+        save->data = savestates_build_m64p(0, &save->size);
+        if (save->data != NULL)
+            save->data = savestates_append_plugin_m64p(save->data, &save->size);
+    }
+
+    if (save->data == NULL)
+    {
+#ifndef __LIBRETRO__
+        free(save->filepath);
+#endif
+        free(save);
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
+        return 0;
+    }
+
+#ifdef __LIBRETRO__
+    if (save->size > size)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Savestate buffer too small: %u bytes needed.", (unsigned int)save->size);
+        free(save->data);
+        free(save);
+        return 0;
+    }
+#endif
+
     init_work(&save->work, savestates_save_m64p_work);
     queue_work(&save->work);
 
@@ -1327,6 +1717,9 @@ static int savestates_save_pj64(char *filepath, void *handle,
 
     uint32_t* cp0_regs = r4300_cp0_regs();
 
+    /* the RSP state must not change under us */
+    rsp_wait_task(&g_dev.sp);
+
     // Allocate memory for the save state data
     savestateSize = 8 + SaveRDRAMSize + 0x2754;
     savestateData = curr = (unsigned char *)malloc(savestateSize);
@@ -1571,7 +1964,11 @@ int savestates_save(void)
     {
         switch (type)
         {
+#ifndef __LIBRETRO__
             case savestates_type_m64p: ret = savestates_save_m64p(filepath); break;
+#else
+            case savestates_type_m64p: ret = 0; break;
+#endif
             case savestates_type_pj64_zip: ret = savestates_save_pj64_zip(filepath); break;
             case savestates_type_pj64_unc: ret = savestates_save_pj64_unc(filepath); break;
             default: ret = 0; break;
@@ -1603,4 +2000,5 @@ void savestates_deinit(void)
     SDL_DestroyMutex(savestates_lock);
 #endif
     savestates_clear_job();
+    savestate_chunks_deinit();
 }
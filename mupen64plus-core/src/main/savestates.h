@@ -25,6 +25,8 @@
 #ifndef __SAVESTAVES_H__
 #define __SAVESTAVES_H__
 
+#include <stddef.h>
+
 typedef enum _savestates_job
 {
     savestates_job_nothing,
@@ -49,8 +51,11 @@ int savestates_load(void);
 int savestates_save(void);
 
 #ifdef __LIBRETRO__
-int savestates_save_m64p(void *data);
-int savestates_load_m64p(const void *data);
+size_t savestates_size_m64p(void);
+/* the largest savestate, what savestates_size_m64p can't tell yet */
+size_t savestates_max_size_m64p(void);
+int savestates_save_m64p(void *data, size_t size);
+int savestates_load_m64p(const void *data, size_t size);
 #else
 int savestates_save_m64p(char *filepath);
 int savestates_load_m64p(char *filepath);
@@ -59,6 +64,7 @@ int savestates_load_m64p(char *filepath);
 void savestates_select_slot(unsigned int s);
 unsigned int savestates_get_slot(void);
 void savestates_set_autoinc_slot(int b);
+void savestates_set_compression(int b);
 void savestates_inc_slot(void);
 
 #endif /* __SAVESTAVES_H__ */
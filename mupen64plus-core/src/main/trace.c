@@ -0,0 +1,282 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - trace.c                                                 *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifdef TRACE
+#include "trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+
+#if defined(WIN32)
+  #include <windows.h>
+
+  #define TRACE_THREAD_LOCAL __declspec(thread)
+
+  static uint64_t get_time(void)
+  {
+      static LARGE_INTEGER freq = { 0 };
+      LARGE_INTEGER counter;
+      if (freq.QuadPart == 0)
+          QueryPerformanceFrequency(&freq);
+      QueryPerformanceCounter(&counter);
+      return (uint64_t)((double)counter.QuadPart * 1e9 / (double)freq.QuadPart);
+  }
+
+  static int push_thread(void* volatile* list, void* old_head, void* thread)
+  {
+      return InterlockedCompareExchangePointer(list, thread, old_head) == old_head;
+  }
+
+  static unsigned int next_thread_id(volatile long* count)
+  {
+      return (unsigned int)InterlockedIncrement(count);
+  }
+#else
+  #include <time.h>
+
+  #define TRACE_THREAD_LOCAL __thread
+
+  static uint64_t get_time(void)
+  {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+  }
+
+  static int push_thread(void* volatile* list, void* old_head, void* thread)
+  {
+      return __sync_bool_compare_and_swap(list, old_head, thread);
+  }
+
+  static unsigned int next_thread_id(volatile long* count)
+  {
+      return (unsigned int)__sync_add_and_fetch(count, 1);
+  }
+#endif
+
+#define TRACE_MAX_DEPTH 32
+
+/* a completed zone */
+struct trace_event
+{
+    const char* name;
+    uint64_t start;
+    uint64_t duration;
+    uint32_t arg;
+};
+
+struct trace_open_zone
+{
+    const char* name;
+    uint64_t start;
+    uint32_t arg;
+};
+
+/* Zones of one thread. Only this thread writes to it, trace_dump and
+ * trace_zones_get read it from any thread: an event being written while
+ * they run may come out torn, which is harmless for a trace. */
+struct trace_thread
+{
+    struct trace_thread* next;
+    unsigned int id;
+
+    struct trace_open_zone open[TRACE_MAX_DEPTH];
+    unsigned int depth;
+
+    /* events ever written, the last TRACE_RING_SIZE of them are kept */
+    volatile uint64_t written;
+    struct trace_event events[TRACE_RING_SIZE];
+
+    /* open addressing on the name address */
+    struct trace_zone_stats zones[TRACE_MAX_ZONES];
+};
+
+static TRACE_THREAD_LOCAL struct trace_thread* current_thread;
+static void* volatile threads;
+static volatile long thread_count;
+static uint64_t origin;
+
+static struct trace_thread* register_thread(void)
+{
+    struct trace_thread* thread = calloc(1, sizeof(*thread));
+    void* head;
+
+    if (thread == NULL)
+        return NULL;
+
+    if (origin == 0)
+        origin = get_time();
+
+    thread->id = next_thread_id(&thread_count);
+    do {
+        head = threads;
+        thread->next = head;
+    } while (!push_thread(&threads, head, thread));
+
+    return thread;
+}
+
+static void add_to_stats(struct trace_thread* thread, const char* name, uint64_t duration)
+{
+    unsigned int i = (unsigned int)(((uintptr_t)name >> 3) % TRACE_MAX_ZONES);
+    unsigned int n;
+
+    for (n = 0; n < TRACE_MAX_ZONES; ++n, i = (i + 1) % TRACE_MAX_ZONES) {
+        struct trace_zone_stats* zone = &thread->zones[i];
+
+        if (zone->name == NULL)
+            zone->name = name;
+
+        if (zone->name == name) {
+            zone->total_ns += duration;
+            ++zone->count;
+            return;
+        }
+    }
+}
+
+void trace_begin(const char* name, uint32_t arg)
+{
+    struct trace_thread* thread = current_thread;
+
+    if (thread == NULL) {
+        thread = current_thread = register_thread();
+        if (thread == NULL)
+            return;
+    }
+
+    /* too deep zones are counted, to be ended, but not recorded */
+    if (thread->depth < TRACE_MAX_DEPTH) {
+        struct trace_open_zone* zone = &thread->open[thread->depth];
+        zone->name = name;
+        zone->arg = arg;
+        zone->start = get_time();
+    }
+    ++thread->depth;
+}
+
+void trace_end(void)
+{
+    struct trace_thread* thread = current_thread;
+    const struct trace_open_zone* zone;
+    struct trace_event* event;
+    uint64_t end;
+
+    if (thread == NULL || thread->depth == 0)
+        return;
+
+    if (--thread->depth >= TRACE_MAX_DEPTH)
+        return;
+
+    end = get_time();
+    zone = &thread->open[thread->depth];
+
+    event = &thread->events[thread->written % TRACE_RING_SIZE];
+    event->name = zone->name;
+    event->start = zone->start;
+    event->duration = end - zone->start;
+    event->arg = zone->arg;
+    ++thread->written;
+
+    add_to_stats(thread, zone->name, end - zone->start);
+}
+
+int trace_dump(const char* path)
+{
+    const struct trace_thread* thread;
+    const char* separator = "";
+    FILE* f = fopen(path, "w");
+
+    if (f == NULL) {
+        DebugMessage(M64MSG_ERROR, "Couldn't open trace file %s", path);
+        return 0;
+    }
+
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    for (thread = threads; thread != NULL; thread = thread->next) {
+        uint64_t written = thread->written;
+        uint64_t i = (written > TRACE_RING_SIZE) ? written - TRACE_RING_SIZE : 0;
+
+        fprintf(f, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+                separator, thread->id, thread->id);
+        separator = ",";
+
+        for (; i < written; ++i) {
+            const struct trace_event* event = &thread->events[i % TRACE_RING_SIZE];
+
+            fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                    event->name, thread->id,
+                    (double)(event->start - origin) / 1000.0,
+                    (double)event->duration / 1000.0);
+            if (event->arg != TRACE_NO_ARG)
+                fprintf(f, ",\"args\":{\"arg\":%u}", (unsigned int)event->arg);
+            fputc('}', f);
+        }
+    }
+
+    fprintf(f, "\n]}\n");
+
+    if (fclose(f) != 0) {
+        DebugMessage(M64MSG_ERROR, "Couldn't write trace file %s", path);
+        return 0;
+    }
+
+    return 1;
+}
+
+unsigned int trace_zones_get(struct trace_zone_stats* stats, unsigned int max)
+{
+    const struct trace_thread* thread;
+    unsigned int count = 0;
+    unsigned int i, k;
+
+    for (thread = threads; thread != NULL; thread = thread->next) {
+        for (i = 0; i < TRACE_MAX_ZONES; ++i) {
+            const struct trace_zone_stats* zone = &thread->zones[i];
+
+            if (zone->name == NULL)
+                continue;
+
+            for (k = 0; k < count && stats[k].name != zone->name; ++k);
+
+            if (k == count) {
+                if (count == max)
+                    continue;
+                stats[count].name = zone->name;
+                stats[count].total_ns = 0;
+                stats[count].count = 0;
+                ++count;
+            }
+
+            stats[k].total_ns += zone->total_ns;
+            stats[k].count += zone->count;
+        }
+    }
+
+    return count;
+}
+
+#endif
@@ -0,0 +1,102 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - trace.h                                                 *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_TRACE_H
+#define M64P_MAIN_TRACE_H
+
+/* Trace zones of the core and its plugins, built with TRACE=1.
+ *
+ * A zone is a named span of time on one thread. Zones nest, and are kept in
+ * a ring buffer per thread, the last TRACE_RING_SIZE of each thread, until
+ * trace_dump writes them in the Chrome trace event format, which Perfetto
+ * and chrome://tracing open. The total time and count of each zone is also
+ * kept, see trace_zones_get.
+ *
+ * Zone names must be string literals (or have static storage): only their
+ * address is recorded. A zone must end on the coroutine it began on, so it
+ * cannot span the switch to the frontend at the end of a frame (new_vi).
+ *
+ * Without TRACE, the macros below expand to nothing. */
+
+#include <stdint.h>
+
+#define TRACE_RING_SIZE (1 << 16)
+#define TRACE_MAX_ZONES 64
+
+/* zone without argument */
+#define TRACE_NO_ARG UINT32_C(0xffffffff)
+
+struct trace_zone_stats
+{
+    const char* name;
+    uint64_t total_ns;
+    uint64_t count;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef TRACE
+  /* begin a zone, with an argument shown with it (TRACE_NO_ARG if none) */
+  void trace_begin(const char* name, uint32_t arg);
+  /* end the last zone begun on this thread */
+  void trace_end(void);
+  /* write the zones of all the threads to path, returns 0 on failure */
+  int trace_dump(const char* path);
+  /* fills stats with up to max zones, summed over all the threads,
+   * returns the number of zones */
+  unsigned int trace_zones_get(struct trace_zone_stats* stats, unsigned int max);
+
+  #define TRACE_BEGIN(name) trace_begin(name, TRACE_NO_ARG)
+  #define TRACE_BEGIN_ARG(name, arg) trace_begin(name, arg)
+  #define TRACE_END() trace_end()
+#else
+  #define TRACE_BEGIN(name) ((void)0)
+  #define TRACE_BEGIN_ARG(name, arg) ((void)0)
+  #define TRACE_END() ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+
+/* zone of a C++ scope */
+#ifdef TRACE
+class TraceZone
+{
+public:
+    explicit TraceZone(const char* name, uint32_t arg = TRACE_NO_ARG) { trace_begin(name, arg); }
+    ~TraceZone() { trace_end(); }
+
+private:
+    TraceZone(const TraceZone&);
+    TraceZone& operator=(const TraceZone&);
+};
+
+#define TRACE_ZONE(name) TraceZone trace_zone_(name)
+#define TRACE_ZONE_ARG(name, arg) TraceZone trace_zone_(name, arg)
+#else
+#define TRACE_ZONE(name)
+#define TRACE_ZONE_ARG(name, arg)
+#endif
+#endif
+
+#endif
@@ -0,0 +1,195 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - fastmem.c                                               *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* REG_RIP */
+#endif
+
+#include "fastmem.h"
+
+#ifdef FASTMEM
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "main/main.h"
+
+/* the whole 32-bit address space, and room for an unaligned access at its end */
+#define FASTMEM_SIZE (UINT64_C(0x100000000) + 0x10000)
+
+unsigned char* fastmem_base = NULL;
+
+static int dram_fd = -1;
+static uint32_t* fastmem_dram = NULL;
+static uint32_t fastmem_dram_size = 0;
+
+static struct sigaction old_segv_action;
+
+/* access sites the fault handler sent to their slow path */
+static unsigned int patched_sites = 0;
+
+static void* reserve(void* addr, size_t size)
+{
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+
+    if (addr != NULL)
+        flags |= MAP_FIXED;
+
+    return mmap(addr, size, PROT_NONE, flags, -1, 0);
+}
+
+static void segv_handler(int sig, siginfo_t* info, void* context)
+{
+    ucontext_t* uc = (ucontext_t*)context;
+    unsigned char* rip = (unsigned char*)uc->uc_mcontext.gregs[REG_RIP];
+    unsigned char* fault = (unsigned char*)info->si_addr;
+
+    if (fastmem_base != NULL
+            && fault >= fastmem_base && fault < fastmem_base + FASTMEM_SIZE
+            && rip[FASTMEM_ACCESS_SIZE] == 0xEB)
+    {
+        /* jmp to the slow path, which starts after the jmp ending the access */
+        rip[0] = 0xEB;
+        rip[1] = FASTMEM_ACCESS_SIZE;
+        uc->uc_mcontext.gregs[REG_RIP] = (greg_t)(rip + FASTMEM_ACCESS_SIZE + 2);
+        ++patched_sites;
+        return;
+    }
+
+    if (old_segv_action.sa_flags & SA_SIGINFO)
+        old_segv_action.sa_sigaction(sig, info, context);
+    else if (old_segv_action.sa_handler != SIG_DFL && old_segv_action.sa_handler != SIG_IGN)
+        old_segv_action.sa_handler(sig);
+    else
+    {
+        /* the access faults again on return, and kills the process */
+        signal(sig, SIG_DFL);
+    }
+}
+
+int fastmem_init(uint32_t* dram, uint32_t dram_size)
+{
+    struct sigaction action;
+
+    fastmem_deinit();
+
+    if (((uintptr_t)dram & (sysconf(_SC_PAGESIZE) - 1)) != 0)
+    {
+        DebugMessage(M64MSG_WARNING, "fastmem: RDRAM is not page aligned");
+        return 0;
+    }
+
+    /* move RDRAM to a memfd so that it can be mapped at several addresses */
+    dram_fd = syscall(SYS_memfd_create, "rdram", 0);
+    if (dram_fd < 0
+            || pwrite(dram_fd, dram, RDRAM_MAX_SIZE, 0) != (ssize_t)RDRAM_MAX_SIZE
+            || mmap(dram, RDRAM_MAX_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, dram_fd, 0) == MAP_FAILED)
+    {
+        DebugMessage(M64MSG_WARNING, "fastmem: can't share RDRAM: %s", strerror(errno));
+        if (dram_fd >= 0)
+            close(dram_fd);
+        dram_fd = -1;
+        return 0;
+    }
+    fastmem_dram = dram;
+    fastmem_dram_size = dram_size;
+
+    fastmem_base = (unsigned char*)reserve(NULL, FASTMEM_SIZE);
+    if (fastmem_base == MAP_FAILED)
+    {
+        DebugMessage(M64MSG_WARNING, "fastmem: can't reserve address space: %s", strerror(errno));
+        fastmem_base = NULL;
+        fastmem_deinit();
+        return 0;
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = segv_handler;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGSEGV, &action, &old_segv_action);
+    patched_sites = 0;
+
+    /* kseg0 and kseg1 */
+    fastmem_map(UINT32_C(0x80000000), 0, dram_size, 1);
+    fastmem_map(UINT32_C(0xa0000000), 0, dram_size, 1);
+
+    DebugMessage(M64MSG_INFO, "fastmem: guest address space at %p", fastmem_base);
+    return 1;
+}
+
+void fastmem_deinit(void)
+{
+    if (fastmem_base != NULL)
+    {
+        fastmem_log_stats();
+        sigaction(SIGSEGV, &old_segv_action, NULL);
+        munmap(fastmem_base, FASTMEM_SIZE);
+        fastmem_base = NULL;
+    }
+
+    if (dram_fd >= 0)
+    {
+        /* a private mapping of the memfd keeps the content of RDRAM */
+        mmap(fastmem_dram, RDRAM_MAX_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, dram_fd, 0);
+        close(dram_fd);
+        dram_fd = -1;
+        fastmem_dram = NULL;
+        fastmem_dram_size = 0;
+    }
+}
+
+void fastmem_log_stats(void)
+{
+    if (fastmem_base != NULL)
+        DebugMessage(M64MSG_INFO, "fastmem: %u access sites patched to the slow path", patched_sites);
+}
+
+void fastmem_map(uint32_t vaddr, uint32_t paddr, uint32_t size, int writable)
+{
+    if (fastmem_base == NULL || paddr >= fastmem_dram_size)
+        return;
+
+    if (size > fastmem_dram_size - paddr)
+        size = fastmem_dram_size - paddr;
+
+    if (mmap(fastmem_base + vaddr, size, PROT_READ | (writable ? PROT_WRITE : 0),
+             MAP_SHARED | MAP_FIXED, dram_fd, paddr) == MAP_FAILED)
+        DebugMessage(M64MSG_WARNING, "fastmem: can't map %08x to %08x: %s", vaddr, paddr, strerror(errno));
+}
+
+void fastmem_unmap(uint32_t vaddr, uint32_t size)
+{
+    if (fastmem_base == NULL)
+        return;
+
+    if (reserve(fastmem_base + vaddr, size) == MAP_FAILED)
+        DebugMessage(M64MSG_WARNING, "fastmem: can't unmap %08x: %s", vaddr, strerror(errno));
+}
+
+#endif
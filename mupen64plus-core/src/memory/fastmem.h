@@ -0,0 +1,103 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - fastmem.h                                               *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MEMORY_FASTMEM_H
+#define M64P_MEMORY_FASTMEM_H
+
+#include <stdint.h>
+
+#include "osal/preproc.h"
+
+/* Host-MMU view of the r4300 virtual address space.
+ *
+ * fastmem_base points to a 4GB host reservation in which each guest virtual
+ * address is at the same offset. RDRAM is mapped at its kseg0 and kseg1
+ * addresses and at every address the TLB maps to it. Everything else is left
+ * inaccessible, so recompiled code can load and store at
+ * fastmem_base + address and let the host fault on MMIO, ROM, SP memory and
+ * unmapped addresses.
+ *
+ * A faulting access must be emitted as an instruction padded to
+ * FASTMEM_ACCESS_SIZE bytes, followed by a short jmp over the slow path
+ * doing the same access through the memory handlers. The fault handler
+ * patches the access into a jump to the slow path and resumes there.
+ */
+
+#define FASTMEM_ACCESS_SIZE 4
+
+#ifdef FASTMEM
+
+#if !defined(__linux__) || !defined(__x86_64__)
+#error "FASTMEM is only implemented for x86_64 Linux"
+#endif
+
+extern unsigned char* fastmem_base;
+
+/* Maps dram, which must be page aligned and RDRAM_MAX_SIZE bytes long, into
+ * a new reservation and installs the fault handler. Returns 0 on failure,
+ * in which case fastmem_base stays NULL. */
+int fastmem_init(uint32_t* dram, uint32_t dram_size);
+void fastmem_deinit(void);
+
+/* Logs how many access sites faulted and were patched to their slow path */
+void fastmem_log_stats(void);
+
+/* Maps the size bytes of RDRAM at paddr to vaddr, clipped to the RDRAM
+ * size. Both must be page aligned. */
+void fastmem_map(uint32_t vaddr, uint32_t paddr, uint32_t size, int writable);
+void fastmem_unmap(uint32_t vaddr, uint32_t size);
+
+#else
+
+#define fastmem_base ((unsigned char*)NULL)
+
+static osal_inline int fastmem_init(uint32_t* dram, uint32_t dram_size)
+{
+    (void)dram;
+    (void)dram_size;
+    return 0;
+}
+
+static osal_inline void fastmem_deinit(void)
+{
+}
+
+static osal_inline void fastmem_log_stats(void)
+{
+}
+
+static osal_inline void fastmem_map(uint32_t vaddr, uint32_t paddr, uint32_t size, int writable)
+{
+    (void)vaddr;
+    (void)paddr;
+    (void)size;
+    (void)writable;
+}
+
+static osal_inline void fastmem_unmap(uint32_t vaddr, uint32_t size)
+{
+    (void)vaddr;
+    (void)size;
+}
+
+#endif
+
+#endif /* M64P_MEMORY_FASTMEM_H */
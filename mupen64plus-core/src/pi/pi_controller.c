@@ -27,6 +27,7 @@
 
 #include "api/callbacks.h"
 #include "api/m64p_types.h"
+#include "main/trace.h"
 #include "memory/memory.h"
 #include "r4300/r4300_core.h"
 #include "ri/rdram_detection_hack.h"
@@ -223,12 +224,16 @@ int write_pi_regs(void* opaque, uint32_t address, uint32_t value, uint32_t mask)
     {
     case PI_RD_LEN_REG:
         masked_write(&pi->regs[PI_RD_LEN_REG], value, mask);
+        TRACE_BEGIN_ARG("pi_dma_read", pi->regs[PI_RD_LEN_REG] + 1);
         dma_pi_read(pi);
+        TRACE_END();
         return 0;
 
     case PI_WR_LEN_REG:
         masked_write(&pi->regs[PI_WR_LEN_REG], value, mask);
+        TRACE_BEGIN_ARG("pi_dma_write", pi->regs[PI_WR_LEN_REG] + 1);
         dma_pi_write(pi);
+        TRACE_END();
         return 0;
 
     case PI_STATUS_REG:
@@ -70,7 +70,9 @@ static const gfx_plugin_functions dummy_gfx = {
     dummyvideo_ResizeVideoOutput,
     dummyvideo_FBRead,
     dummyvideo_FBWrite,
-    dummyvideo_FBGetFrameBufferInfo
+    dummyvideo_FBGetFrameBufferInfo,
+    NULL,
+    NULL
 };
 
 static const audio_plugin_functions dummy_audio = {
@@ -106,7 +108,9 @@ static const rsp_plugin_functions dummy_rsp = {
     dummyrsp_PluginGetVersion,
     dummyrsp_DoRspCycles,
     dummyrsp_InitiateRSP,
-    dummyrsp_RomClosed
+    dummyrsp_RomClosed,
+    NULL,
+    NULL
 };
 
 static GFX_INFO gfx_info;
@@ -191,6 +195,13 @@ static m64p_error plugin_connect_gfx(m64p_dynlib_handle plugin_handle)
 
         /* set function pointers for optional functions */
         gfx.resizeVideoOutput = (ptr_ResizeVideoOutput) osal_dynlib_getproc(plugin_handle, "ResizeVideoOutput");
+        gfx.saveState = (ptr_SaveState) osal_dynlib_getproc(plugin_handle, "SaveState");
+        gfx.loadState = (ptr_LoadState) osal_dynlib_getproc(plugin_handle, "LoadState");
+        if (gfx.saveState == NULL || gfx.loadState == NULL)
+        {
+            gfx.saveState = NULL;
+            gfx.loadState = NULL;
+        }
 
         /* check the version info */
         (*gfx.getVersion)(&PluginType, &PluginVersion, &APIVersion, NULL, NULL);
@@ -446,6 +457,15 @@ static m64p_error plugin_connect_rsp(m64p_dynlib_handle plugin_handle)
             return M64ERR_INPUT_INVALID;
         }
 
+        /* set function pointers for optional functions */
+        rsp.startRspCycles = (ptr_StartRspCycles) osal_dynlib_getproc(plugin_handle, "StartRspCycles");
+        rsp.waitRspCycles = (ptr_WaitRspCycles) osal_dynlib_getproc(plugin_handle, "WaitRspCycles");
+        if (rsp.startRspCycles == NULL || rsp.waitRspCycles == NULL)
+        {
+            rsp.startRspCycles = NULL;
+            rsp.waitRspCycles = NULL;
+        }
+
         /* check the version info */
         (*rsp.getVersion)(&PluginType, &PluginVersion, &APIVersion, NULL, NULL);
         if (PluginType != M64PLUGIN_RSP || (APIVersion & 0xffff0000) != (RSP_API_VERSION & 0xffff0000))
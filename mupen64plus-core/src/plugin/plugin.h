@@ -62,6 +62,10 @@ typedef struct _gfx_plugin_functions
 	ptr_FBRead          fBRead;
 	ptr_FBWrite         fBWrite;
 	ptr_FBGetFrameBufferInfo fBGetFrameBufferInfo;
+
+	/* savestate extension, NULL if the plugin has none */
+	ptr_SaveState       saveState;
+	ptr_LoadState       loadState;
 } gfx_plugin_functions;
 
 extern gfx_plugin_functions gfx;
@@ -111,6 +115,8 @@ typedef struct _rsp_plugin_functions
 	ptr_DoRspCycles         doRspCycles;
 	ptr_InitiateRSP         initiateRSP;
 	ptr_RomClosed           romClosed;
+	ptr_StartRspCycles      startRspCycles;
+	ptr_WaitRspCycles       waitRspCycles;
 } rsp_plugin_functions;
 
 extern rsp_plugin_functions rsp;
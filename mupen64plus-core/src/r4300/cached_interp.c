@@ -33,10 +33,13 @@
 #include "cp0_private.h"
 #include "cp1_private.h"
 #include "exception.h"
+#include "guest_profile.h"
+#include "idle_loop.h"
 #include "interupt.h"
 #include "macros.h"
 #include "main/main.h"
 #include "memory/memory.h"
+#include "op_cost.h"
 #include "ops.h"
 #include "r4300.h"
 #include "recomp.h"
@@ -132,16 +135,8 @@ unsigned int jump_to_address;
    static void name##_IDLE(void) \
    { \
       const int take_jump = (condition); \
-      int skip; \
       if (cop1 && check_cop1_unusable()) return; \
-      if (take_jump) \
-      { \
-         cp0_update_count(); \
-         skip = next_interupt - g_cp0_regs[CP0_COUNT_REG]; \
-         if (skip > 3) g_cp0_regs[CP0_COUNT_REG] += (skip & UINT32_C(0xFFFFFFFC)); \
-         else name(); \
-      } \
-      else name(); \
+      if (!idle_loop_skip(take_jump, (destination), PCADDR)) name(); \
    }
 
 #define CHECK_MEMORY() \
@@ -150,6 +145,12 @@ unsigned int jump_to_address;
           current_instruction_table.NOTCOMPILED) \
          invalid_code[address>>12] = 1;
 
+/* The dynarec calls these functions too, with the cost already counted
+ * at compile time (genop_cost). */
+#define ADD_OP_COST(cost_class) \
+   if (r4300emu != CORE_DYNAREC) \
+      g_cp0_regs[CP0_COUNT_REG] += op_cost_cycles(cost_class)
+
 // two functions are defined from the macros above but never used
 // these prototype declarations will prevent a warning
 #if defined(__GNUC__)
@@ -558,6 +559,8 @@ void jump_to_func(void)
      }
    PC=actual->block+((addr-actual->start)>>2);
    
+   /* the interpreters count the entries in their main loop */
+   if (r4300emu == CORE_DYNAREC) GUEST_PROFILE_BLOCK(addr);
    if (r4300emu == CORE_DYNAREC) dyna_jump();
 }
 #undef addr
@@ -22,6 +22,8 @@
 #include <stdint.h>
 
 #include "cp0.h"
+#include "cp1.h"
+#include "fpu.h"
 
 #include "new_dynarec/new_dynarec.h"
 
@@ -159,9 +161,12 @@ void set_fpr_pointers(uint32_t newStatus)
 
 /* XXX: This shouldn't really be here, but rounding_mode is used by the
  * Hacktarux JIT and updated by CTC1 and saved states. Figure out a better
- * place for this. */
+ * place for this.
+ * The host rounding mode is updated here too, COP1 operations don't set it. */
 void update_x86_rounding_mode(uint32_t FCR31)
 {
+    set_rounding(FCR31);
+
     switch (FCR31 & 3)
     {
     case 0: /* Round to nearest, or to even if equidistant */
@@ -178,3 +183,10 @@ void update_x86_rounding_mode(uint32_t FCR31)
         break;
     }
 }
+
+/* Other code running on the emulation thread, like the frontend between
+ * two frames, may change the host rounding mode. */
+void restore_host_rounding_mode(void)
+{
+    set_rounding(FCR31);
+}
@@ -23,6 +23,8 @@
 #include "api/m64p_types.h"
 #include "cp0_private.h"
 #include "exception.h"
+#include "guest_profile.h"
+#include "idle_loop.h"
 #include "memory/memory.h"
 #include "r4300.h"
 #include "r4300_core.h"
@@ -40,6 +42,7 @@ void TLB_refill_exception(uint32_t address, int w)
    g_cp0_regs[CP0_BADVADDR_REG] = address;
    g_cp0_regs[CP0_CONTEXT_REG] = (g_cp0_regs[CP0_CONTEXT_REG] & UINT32_C(0xFF80000F)) | ((address >> 9) & UINT32_C(0x007FFFF0));
    g_cp0_regs[CP0_ENTRYHI_REG] = address & UINT32_C(0xFFFFE000);
+   GUEST_PROFILE_EXCEPTION(g_cp0_regs[CP0_CAUSE_REG]);
    if (g_cp0_regs[CP0_STATUS_REG] & CP0_STATUS_EXL)
      {
     generic_jump_to(UINT32_C(0x80000180));
@@ -113,6 +116,8 @@ void TLB_refill_exception(uint32_t address, int w)
 void exception_general(void)
 {
    cp0_update_count();
+   idle_loop_reset();
+   GUEST_PROFILE_EXCEPTION(g_cp0_regs[CP0_CAUSE_REG]);
    g_cp0_regs[CP0_STATUS_REG] |= CP0_STATUS_EXL;
    
    g_cp0_regs[CP0_EPC_REG] = PC->addr;
@@ -58,11 +58,14 @@
 #define FCR31_CMP_BIT UINT32_C(0x800000)
 
 
-M64P_FPU_INLINE void set_rounding(void)
+/* Sets the host rounding mode to the one of fcr31.
+ * The helpers below don't set it: it is only changed when FCR31 is written
+ * (see update_x86_rounding_mode), and the host FPU keeps it meanwhile. */
+M64P_FPU_INLINE void set_rounding(uint32_t fcr31)
 {
    /* TODO skogaby: fix this for real */
 #if !defined(VITA) && !defined(__SWITCH__)
-   switch(FCR31 & 3)
+   switch(fcr31 & 3)
    {
       case 0: /* Round to nearest, or to even if equidistant */
          fesetround(FE_TONEAREST);
@@ -82,7 +85,6 @@ M64P_FPU_INLINE void set_rounding(void)
 
 M64P_FPU_INLINE void cvt_s_w(const int32_t *source,float *dest)
 {
-  set_rounding();
   *dest = (float) *source;
 }
 M64P_FPU_INLINE void cvt_d_w(const int32_t *source,double *dest)
@@ -91,12 +93,10 @@ M64P_FPU_INLINE void cvt_d_w(const int32_t *source,double *dest)
 }
 M64P_FPU_INLINE void cvt_s_l(const int64_t *source,float *dest)
 {
-  set_rounding();
   *dest = (float) *source;
 }
 M64P_FPU_INLINE void cvt_d_l(const int64_t *source,double *dest)
 {
-  set_rounding();
   *dest = (double) *source;
 }
 M64P_FPU_INLINE void cvt_d_s(const float *source,double *dest)
@@ -105,7 +105,6 @@ M64P_FPU_INLINE void cvt_d_s(const float *source,double *dest)
 }
 M64P_FPU_INLINE void cvt_s_d(const double *source,float *dest)
 {
-  set_rounding();
   *dest = (float) *source;
 }
 
@@ -391,27 +390,22 @@ M64P_FPU_INLINE void c_ngt_d(const double *source,const double *target)
 
 M64P_FPU_INLINE void add_s(const float *source1,const float *source2,float *target)
 {
-  set_rounding();
   *target=(*source1)+(*source2);
 }
 M64P_FPU_INLINE void sub_s(const float *source1,const float *source2,float *target)
 {
-  set_rounding();
   *target=(*source1)-(*source2);
 }
 M64P_FPU_INLINE void mul_s(const float *source1,const float *source2,float *target)
 {
-  set_rounding();
   *target=(*source1)*(*source2);
 }
 M64P_FPU_INLINE void div_s(const float *source1,const float *source2,float *target)
 {
-  set_rounding();
   *target=(*source1)/(*source2);
 }
 M64P_FPU_INLINE void sqrt_s(const float *source,float *target)
 {
-  set_rounding();
   *target=sqrtf(*source);
 }
 M64P_FPU_INLINE void abs_s(const float *source,float *target)
@@ -428,27 +422,22 @@ M64P_FPU_INLINE void neg_s(const float *source,float *target)
 }
 M64P_FPU_INLINE void add_d(const double *source1,const double *source2,double *target)
 {
-  set_rounding();
   *target=(*source1)+(*source2);
 }
 M64P_FPU_INLINE void sub_d(const double *source1,const double *source2,double *target)
 {
-  set_rounding();
   *target=(*source1)-(*source2);
 }
 M64P_FPU_INLINE void mul_d(const double *source1,const double *source2,double *target)
 {
-  set_rounding();
   *target=(*source1)*(*source2);
 }
 M64P_FPU_INLINE void div_d(const double *source1,const double *source2,double *target)
 {
-  set_rounding();
   *target=(*source1)/(*source2);
 }
 M64P_FPU_INLINE void sqrt_d(const double *source,double *target)
 {
-  set_rounding();
   *target=sqrt(*source);
 }
 M64P_FPU_INLINE void abs_d(const double *source,double *target)
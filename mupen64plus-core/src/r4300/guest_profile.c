@@ -0,0 +1,324 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - guest_profile.c                                         *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* REG_RIP */
+#endif
+
+#include "guest_profile.h"
+
+#ifdef GUEST_PROFILE
+
+#include <stdio.h>
+#include <string.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "cached_interp.h"
+#include "cp0.h"
+#include "main/rom.h"
+#include "r4300.h"
+#include "recomp.h"
+
+#if !defined(WIN32)
+  #define GUEST_PROFILE_SAMPLING
+  #include <signal.h>
+  #include <sys/time.h>
+#endif
+
+#if defined(GUEST_PROFILE_SAMPLING) && defined(__linux__) && defined(__x86_64__) \
+        && defined(DYNAREC) && !defined(NEW_DYNAREC)
+  #define GUEST_PROFILE_HOST_PC
+  #include <ucontext.h>
+#endif
+
+struct profile_page
+{
+    uint32_t entries[0x400];
+    uint32_t samples[0x400];
+};
+
+static const char* const exception_names[32] =
+{
+    "Int", "Mod", "TLBL", "TLBS", "AdEL", "AdES", "IBE", "DBE",
+    "Sys", "Bp", "RI", "CpU", "Ov", "Tr", NULL, "FPE",
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL, "WATCH",
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
+};
+
+/* per bit of the interrupt event types of interupt.h */
+static const char* const interrupt_names[11] =
+{
+    "VI", "COMPARE", "CHECK", "SI", "PI", "SPECIAL", "AI", "SP", "DP", "HW2", "NMI"
+};
+
+/* Static, so that the counters are within 2GB of the r4300 registers, which
+ * the x86_64 recompiler addresses them from. Slot + 1 of each virtual page. */
+static struct profile_page pages[GUEST_PROFILE_MAX_PAGES];
+static uint32_t page_addr[GUEST_PROFILE_MAX_PAGES];
+static uint16_t page_slot[0x100000];
+static unsigned int page_count;
+
+static uint64_t dropped_entries;
+static uint64_t exceptions[32];
+static uint64_t interrupts[11];
+
+static volatile int sampling;
+#ifdef GUEST_PROFILE_SAMPLING
+static __thread int sampled_thread;
+#endif
+static volatile int sampling_paused;
+static volatile uint64_t samples;
+static volatile uint64_t dropped_samples;
+
+static struct profile_page* find_page(uint32_t addr)
+{
+    uint16_t slot = page_slot[addr >> 12];
+    return (slot != 0) ? &pages[slot - 1] : NULL;
+}
+
+static struct profile_page* get_page(uint32_t addr)
+{
+    struct profile_page* page = find_page(addr);
+
+    if (page == NULL && page_count < GUEST_PROFILE_MAX_PAGES)
+    {
+        page_addr[page_count] = addr & ~UINT32_C(0xfff);
+        page = &pages[page_count++];
+        /* published once filled, the sampler may read it at any time */
+        page_slot[addr >> 12] = (uint16_t)page_count;
+    }
+
+    return page;
+}
+
+#ifdef GUEST_PROFILE_SAMPLING
+/* The guest instruction being run, 0 if it isn't known. The interpreters,
+ * and the x86_64 recompiler when it calls into C code, point PC to it.
+ * Recompiled code is looked up in the current block, which in-page jumps
+ * never leave. The other recompilers (new_dynarec, x86-32) only update PC
+ * now and then, their samples are dropped rather than given to a stale PC. */
+static int sampled_addr(void* context, uint32_t* addr)
+{
+#ifdef GUEST_PROFILE_HOST_PC
+    const precomp_block* block = actual;
+
+    if (r4300emu == CORE_DYNAREC && block != NULL && block->code != NULL && block->block != NULL)
+    {
+        const unsigned char* rip = (const unsigned char*)((ucontext_t*)context)->uc_mcontext.gregs[REG_RIP];
+
+        if (rip >= block->code && rip < block->code + block->code_length)
+        {
+            unsigned int offset = (unsigned int)(rip - block->code);
+            unsigned int count = (block->end - block->start) / 4;
+            unsigned int i, best = 0, best_offset = 0;
+
+            /* instructions are emitted one after the other: the one
+             * emitted last before the sampled code holds it */
+            for (i = 0; i < count; i++)
+            {
+                unsigned int local_addr = block->block[i].local_addr;
+                if (local_addr <= offset && local_addr >= best_offset)
+                {
+                    best = i;
+                    best_offset = local_addr;
+                }
+            }
+            *addr = block->start + best * 4;
+            return 1;
+        }
+    }
+#elif defined(DYNAREC)
+    if (r4300emu == CORE_DYNAREC)
+        return 0;
+#endif
+    *addr = PC->addr;
+    return 1;
+}
+
+static void sample(int sig, siginfo_t* info, void* context)
+{
+    struct profile_page* page;
+    uint32_t addr;
+
+    /* the timer counts the time of the whole process, the samples of the
+     * other threads and of the frontend are ignored */
+    if (!sampling || !sampled_thread || sampling_paused || PC == NULL)
+        return;
+
+    ++samples;
+    if (!sampled_addr(context, &addr))
+    {
+        ++dropped_samples;
+        return;
+    }
+
+    page = find_page(addr);
+    if (page != NULL)
+        ++page->samples[(addr & 0xfff) >> 2];
+    else
+        ++dropped_samples;
+}
+
+static struct sigaction old_prof_action;
+#endif
+
+void guest_profile_start(void)
+{
+#ifdef GUEST_PROFILE_SAMPLING
+    struct sigaction action;
+    struct itimerval timer;
+#endif
+
+    guest_profile_reset();
+
+#ifdef GUEST_PROFILE_SAMPLING
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = sample;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+
+    if (sigaction(SIGPROF, &action, &old_prof_action) != 0)
+    {
+        DebugMessage(M64MSG_WARNING, "guest profile: couldn't install the sampler");
+        return;
+    }
+
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = GUEST_PROFILE_PERIOD_US;
+    timer.it_value = timer.it_interval;
+    sampled_thread = 1;
+    sampling = 1;
+    if (setitimer(ITIMER_PROF, &timer, NULL) != 0)
+    {
+        sampling = 0;
+        sigaction(SIGPROF, &old_prof_action, NULL);
+        DebugMessage(M64MSG_WARNING, "guest profile: couldn't start the sampling timer");
+    }
+#endif
+}
+
+void guest_profile_stop(void)
+{
+#ifdef GUEST_PROFILE_SAMPLING
+    struct itimerval timer;
+
+    if (!sampling)
+        return;
+
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, NULL);
+    sampling = 0;
+    sigaction(SIGPROF, &old_prof_action, NULL);
+#endif
+}
+
+void guest_profile_pause(int paused)
+{
+    sampling_paused = paused;
+}
+
+uint32_t* guest_profile_counter(uint32_t addr)
+{
+    struct profile_page* page = get_page(addr);
+    return (page != NULL) ? &page->entries[(addr & 0xfff) >> 2] : NULL;
+}
+
+void guest_profile_block(uint32_t addr)
+{
+    uint32_t* counter = guest_profile_counter(addr);
+
+    if (counter != NULL)
+        ++*counter;
+    else
+        ++dropped_entries;
+}
+
+void guest_profile_exception(uint32_t cause)
+{
+    ++exceptions[(cause & CP0_CAUSE_EXCCODE_MASK) >> 2];
+}
+
+void guest_profile_interrupt(int type)
+{
+    unsigned int i;
+
+    for (i = 0; i < 11; i++)
+        if (type & (1 << i))
+            ++interrupts[i];
+}
+
+void guest_profile_reset(void)
+{
+    memset(pages, 0, sizeof(pages));
+    memset(page_slot, 0, sizeof(page_slot));
+    page_count = 0;
+    dropped_entries = 0;
+    memset(exceptions, 0, sizeof(exceptions));
+    memset(interrupts, 0, sizeof(interrupts));
+    samples = 0;
+    dropped_samples = 0;
+}
+
+int guest_profile_dump(const char* path)
+{
+    unsigned int i, k;
+    FILE* f = fopen(path, "w");
+
+    if (f == NULL)
+    {
+        DebugMessage(M64MSG_ERROR, "Couldn't open guest profile file %s", path);
+        return 0;
+    }
+
+    fprintf(f, "# mupen64plus guest profile\n");
+    fprintf(f, "rom %s\n", ROM_PARAMS.headername);
+    fprintf(f, "core %u\n", r4300emu);
+    fprintf(f, "period_us %u\n", GUEST_PROFILE_PERIOD_US);
+    fprintf(f, "samples %llu %llu\n", (unsigned long long)samples, (unsigned long long)dropped_samples);
+    fprintf(f, "dropped_entries %llu\n", (unsigned long long)dropped_entries);
+
+    for (i = 0; i < 32; i++)
+        if (exceptions[i] != 0)
+            fprintf(f, "exception %u %s %llu\n", i,
+                    exception_names[i] ? exception_names[i] : "?", (unsigned long long)exceptions[i]);
+
+    for (i = 0; i < 11; i++)
+        if (interrupts[i] != 0)
+            fprintf(f, "interrupt %s %llu\n", interrupt_names[i], (unsigned long long)interrupts[i]);
+
+    /* addr entries samples */
+    for (i = 0; i < page_count; i++)
+        for (k = 0; k < 0x400; k++)
+            if (pages[i].entries[k] != 0 || pages[i].samples[k] != 0)
+                fprintf(f, "pc %08x %u %u\n", page_addr[i] + k * 4,
+                        (unsigned int)pages[i].entries[k], (unsigned int)pages[i].samples[k]);
+
+    if (fclose(f) != 0)
+    {
+        DebugMessage(M64MSG_ERROR, "Couldn't write guest profile file %s", path);
+        return 0;
+    }
+
+    return 1;
+}
+
+#endif
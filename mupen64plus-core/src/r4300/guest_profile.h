@@ -0,0 +1,78 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - guest_profile.h                                         *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_R4300_GUEST_PROFILE_H
+#define M64P_R4300_GUEST_PROFILE_H
+
+/* Profile of the guest code, built with GUEST_PROFILE=1.
+ *
+ * Counts, per guest virtual address:
+ * - block entries: the taken jumps, branches and exception vectors landing
+ *   there. The interpreters count every PC which isn't 4 or 8 (a branch and
+ *   its delay slot) after the previous one, the x86_64 recompiler counts its
+ *   compiled jumps and the jumps through jump_to_func, but not the jumps it
+ *   hands over to the interpreter, and loops once per idle loop skip.
+ * - samples: every GUEST_PROFILE_PERIOD_US of CPU time, the guest
+ *   instruction being run (or the one which called into C code), so host
+ *   time per block is samples * period. Sampling needs setitimer, and only
+ *   resolves the recompiled code of the x86_64 recompiler: the samples of
+ *   the other recompilers are dropped.
+ * and the taken exceptions per ExcCode and the interrupt events per type.
+ *
+ * guest_profile_dump writes them as text, libretro/benchmark/guest_profile.py
+ * symbolizes them against a map file. Without GUEST_PROFILE, the macros
+ * below expand to nothing. */
+
+#include <stdint.h>
+
+#define GUEST_PROFILE_PERIOD_US 1000
+
+/* pages of 4KB of guest code which are counted, the others are dropped */
+#define GUEST_PROFILE_MAX_PAGES 2048
+
+#ifdef GUEST_PROFILE
+  /* start sampling the calling thread, and stop it */
+  void guest_profile_start(void);
+  void guest_profile_stop(void);
+  /* suspend sampling while the frontend runs on the emulation thread */
+  void guest_profile_pause(int paused);
+
+  /* the entry counter of addr, NULL if its page can't be counted; stable
+   * until the profile is reset, for the recompiler to increment */
+  uint32_t* guest_profile_counter(uint32_t addr);
+  void guest_profile_block(uint32_t addr);
+  void guest_profile_exception(uint32_t cause);
+  void guest_profile_interrupt(int type);
+
+  void guest_profile_reset(void);
+  /* writes the profile to path, returns 0 on failure */
+  int guest_profile_dump(const char* path);
+
+  #define GUEST_PROFILE_BLOCK(addr) guest_profile_block(addr)
+  #define GUEST_PROFILE_EXCEPTION(cause) guest_profile_exception(cause)
+  #define GUEST_PROFILE_INTERRUPT(type) guest_profile_interrupt(type)
+#else
+  #define GUEST_PROFILE_BLOCK(addr) ((void)0)
+  #define GUEST_PROFILE_EXCEPTION(cause) ((void)0)
+  #define GUEST_PROFILE_INTERRUPT(type) ((void)0)
+#endif
+
+#endif /* M64P_R4300_GUEST_PROFILE_H */
@@ -0,0 +1,577 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - idle_loop.c                                             *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Detection of idle loops.
+ *
+ * A loop is considered idle when one iteration leaves the CPU state
+ * unchanged (apart from PC and the count register) as long as memory does
+ * not change. On the N64, memory and device registers only change behind
+ * the CPU's back when an interrupt event is processed (DMA completion, RSP
+ * task end, VI...), so such a loop can be fast-forwarded up to the next
+ * event without any visible difference.
+ *
+ * The body may only contain loads and register arithmetic. Registers
+ * written in the body must be computed from values that are invariant
+ * across iterations, and loads must target memory whose content does not
+ * depend on the count register (VI_CURRENT and AI_LEN do).
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "cp0.h"
+#include "cp0_private.h"
+#include "idle_loop.h"
+#include "main/rom.h"
+#include "memory/memory.h"
+#include "r4300.h"
+#include "tlb.h"
+
+#define REG_HI    32
+#define REG_LO    33
+#define REG_FCR31 34
+#define REG_BIT(r) (UINT64_C(1) << (r))
+
+enum op_kind
+{
+    OP_REJECT,
+    OP_ALU,
+    OP_LOAD,
+    OP_BRANCH
+};
+
+struct loop_info
+{
+    enum idle_loop_type type;
+    /* The branch reads a register which is written later in the
+     * iteration (typically a load in the delay slot). */
+    int carried;
+    /* Registers written anywhere in the loop. */
+    uint64_t written;
+};
+
+static uint32_t armed_branch;
+
+/* The analysis of the loops met so far, so that each loop is analyzed once
+ * instead of every time its branch runs. An entry keeps the code it was made
+ * from and is only used while that code is unchanged. */
+#define IDLE_LOOP_CACHE_SIZE 64
+
+static struct
+{
+    uint32_t branch_addr;
+    uint32_t target;
+    /* 0 for an empty entry */
+    size_t length;
+    uint32_t code[IDLE_LOOP_MAX_LENGTH];
+    struct loop_info info;
+} loop_cache[IDLE_LOOP_CACHE_SIZE];
+
+uint32_t idle_loop_skipped_addr;
+uint32_t idle_loop_skipped_cycles;
+int32_t idle_loop_skipped_ccreg;
+
+#define IDLE_LOOP_STATS_SIZE 32
+
+static struct
+{
+    uint32_t addr;
+    uint64_t skips;
+    uint64_t cycles;
+} loop_stats[IDLE_LOOP_STATS_SIZE];
+static unsigned int loop_stats_count;
+static uint64_t total_skips;
+static uint64_t total_cycles;
+
+static enum op_kind decode_op(uint32_t op, uint64_t* srcs, uint64_t* dsts)
+{
+    unsigned int rs = (op >> 21) & 0x1F;
+    unsigned int rt = (op >> 16) & 0x1F;
+    unsigned int rd = (op >> 11) & 0x1F;
+    enum op_kind kind = OP_REJECT;
+
+    *srcs = 0;
+    *dsts = 0;
+
+    switch (op >> 26)
+    {
+    case 0: /* SPECIAL */
+        switch (op & 0x3F)
+        {
+        case 0: case 2: case 3: /* SLL, SRL, SRA */
+        case 56: case 58: case 59: /* DSLL, DSRL, DSRA */
+        case 60: case 62: case 63: /* DSLL32, DSRL32, DSRA32 */
+            *srcs = REG_BIT(rt);
+            *dsts = REG_BIT(rd);
+            kind = OP_ALU;
+            break;
+        case 4: case 6: case 7: /* SLLV, SRLV, SRAV */
+        case 20: case 22: case 23: /* DSLLV, DSRLV, DSRAV */
+        case 32: case 33: case 34: case 35: /* ADD, ADDU, SUB, SUBU */
+        case 36: case 37: case 38: case 39: /* AND, OR, XOR, NOR */
+        case 42: case 43: /* SLT, SLTU */
+        case 44: case 45: case 46: case 47: /* DADD, DADDU, DSUB, DSUBU */
+            *srcs = REG_BIT(rs) | REG_BIT(rt);
+            *dsts = REG_BIT(rd);
+            kind = OP_ALU;
+            break;
+        case 15: /* SYNC */
+            kind = OP_ALU;
+            break;
+        case 16: /* MFHI */
+            *srcs = REG_BIT(REG_HI);
+            *dsts = REG_BIT(rd);
+            kind = OP_ALU;
+            break;
+        case 17: /* MTHI */
+            *srcs = REG_BIT(rs);
+            *dsts = REG_BIT(REG_HI);
+            kind = OP_ALU;
+            break;
+        case 18: /* MFLO */
+            *srcs = REG_BIT(REG_LO);
+            *dsts = REG_BIT(rd);
+            kind = OP_ALU;
+            break;
+        case 19: /* MTLO */
+            *srcs = REG_BIT(rs);
+            *dsts = REG_BIT(REG_LO);
+            kind = OP_ALU;
+            break;
+        case 24: case 25: case 26: case 27: /* MULT, MULTU, DIV, DIVU */
+        case 28: case 29: case 30: case 31: /* DMULT, DMULTU, DDIV, DDIVU */
+            *srcs = REG_BIT(rs) | REG_BIT(rt);
+            *dsts = REG_BIT(REG_HI) | REG_BIT(REG_LO);
+            kind = OP_ALU;
+            break;
+        }
+        break;
+    case 1: /* REGIMM */
+        switch (rt)
+        {
+        case 0: case 1: case 2: case 3: /* BLTZ, BGEZ, BLTZL, BGEZL */
+            *srcs = REG_BIT(rs);
+            kind = OP_BRANCH;
+            break;
+        case 16: case 17: case 18: case 19: /* BLTZAL, BGEZAL, BLTZALL, BGEZALL */
+            *srcs = REG_BIT(rs);
+            *dsts = REG_BIT(31);
+            kind = OP_BRANCH;
+            break;
+        }
+        break;
+    case 2: /* J */
+        kind = OP_BRANCH;
+        break;
+    case 3: /* JAL */
+        *dsts = REG_BIT(31);
+        kind = OP_BRANCH;
+        break;
+    case 4: case 5: case 20: case 21: /* BEQ, BNE, BEQL, BNEL */
+        *srcs = REG_BIT(rs) | REG_BIT(rt);
+        kind = OP_BRANCH;
+        break;
+    case 6: case 7: case 22: case 23: /* BLEZ, BGTZ, BLEZL, BGTZL */
+        *srcs = REG_BIT(rs);
+        kind = OP_BRANCH;
+        break;
+    case 8: case 9: case 10: case 11: /* ADDI, ADDIU, SLTI, SLTIU */
+    case 12: case 13: case 14: /* ANDI, ORI, XORI */
+    case 24: case 25: /* DADDI, DADDIU */
+        *srcs = REG_BIT(rs);
+        *dsts = REG_BIT(rt);
+        kind = OP_ALU;
+        break;
+    case 15: /* LUI */
+        *dsts = REG_BIT(rt);
+        kind = OP_ALU;
+        break;
+    case 17: /* COP1 */
+        if (rs == 8) /* BC1F, BC1T, BC1FL, BC1TL */
+        {
+            *srcs = REG_BIT(REG_FCR31);
+            kind = OP_BRANCH;
+        }
+        break;
+    case 32: case 33: case 35: /* LB, LH, LW */
+    case 36: case 37: case 39: /* LBU, LHU, LWU */
+    case 55: /* LD */
+        *srcs = REG_BIT(rs);
+        *dsts = REG_BIT(rt);
+        kind = OP_LOAD;
+        break;
+    case 26: case 27: /* LDL, LDR */
+    case 34: case 38: /* LWL, LWR */
+        *srcs = REG_BIT(rs) | REG_BIT(rt);
+        *dsts = REG_BIT(rt);
+        kind = OP_LOAD;
+        break;
+    }
+
+    /* r0 is hardwired to zero */
+    *srcs &= ~REG_BIT(0);
+    *dsts &= ~REG_BIT(0);
+
+    return kind;
+}
+
+static void analyze_loop(const uint32_t* code, size_t length, struct loop_info* info)
+{
+    uint64_t srcs[IDLE_LOOP_MAX_LENGTH];
+    uint64_t dsts[IDLE_LOOP_MAX_LENGTH];
+    enum op_kind kinds[IDLE_LOOP_MAX_LENGTH];
+    uint64_t defined = 0;
+    uint64_t tainted = 0;
+    uint64_t carried = 0;
+    uint64_t depends = 0;
+    size_t branch = length - 2;
+    size_t i;
+
+    info->type = IDLE_LOOP_NONE;
+    info->carried = 0;
+    info->written = 0;
+
+    if (length < 2 || length > IDLE_LOOP_MAX_LENGTH)
+        return;
+
+    for (i = 0; i < length; ++i)
+    {
+        kinds[i] = decode_op(code[i], &srcs[i], &dsts[i]);
+
+        if (kinds[i] == OP_REJECT)
+            return;
+        if ((kinds[i] == OP_BRANCH) != (i == branch))
+            return;
+
+        info->written |= dsts[i];
+    }
+
+    /* Registers are "tainted" when their value derives from a load. */
+    for (i = 0; i < length; ++i)
+    {
+        if (i == branch)
+        {
+            /* Operands written later in the iteration hold the value
+             * computed by the previous one. */
+            carried = srcs[i] & info->written & ~defined;
+            depends = srcs[i] & tainted;
+        }
+        else
+        {
+            /* A register computed from its own value in the previous
+             * iteration (a counter for instance) changes on every
+             * iteration, so the loop is not idle. */
+            if (srcs[i] & info->written & ~defined)
+                return;
+
+            if (kinds[i] == OP_LOAD)
+            {
+                /* Don't follow pointers loaded by the loop itself */
+                if (REG_BIT((code[i] >> 21) & 0x1F) & tainted)
+                    return;
+                tainted |= dsts[i];
+            }
+            else if (srcs[i] & tainted)
+                tainted |= dsts[i];
+            else
+                tainted &= ~dsts[i];
+        }
+
+        defined |= dsts[i];
+    }
+
+    depends |= carried & tainted;
+
+    info->carried = (carried != 0);
+    info->type = (depends || carried) ? IDLE_LOOP_POLL : IDLE_LOOP_WAIT;
+}
+
+enum idle_loop_type idle_loop_analyze(const uint32_t* code, size_t length)
+{
+    struct loop_info info;
+
+    analyze_loop(code, length, &info);
+
+    return info.type;
+}
+
+static const uint32_t* fetch_loop(uint32_t target, uint32_t branch_addr, size_t* length)
+{
+    /* Stay in the page being executed, so the fetch can't fault */
+    if (target > branch_addr
+     || (target & ~UINT32_C(0xFFF)) != ((branch_addr + 4) & ~UINT32_C(0xFFF)))
+        return NULL;
+
+    *length = ((branch_addr - target) >> 2) + 2;
+    if (*length > IDLE_LOOP_MAX_LENGTH)
+        return NULL;
+
+    return fast_mem_access(target);
+}
+
+/* The analysis of the loop closed by the branch at branch_addr, NULL if it
+ * can't be fetched. */
+static const struct loop_info* lookup_loop(uint32_t target, uint32_t branch_addr,
+                                           const uint32_t** code, size_t* length)
+{
+    unsigned int i = (branch_addr >> 2) & (IDLE_LOOP_CACHE_SIZE - 1);
+
+    *code = fetch_loop(target, branch_addr, length);
+    if (*code == NULL)
+        return NULL;
+
+    if (loop_cache[i].length == *length
+     && loop_cache[i].branch_addr == branch_addr
+     && loop_cache[i].target == target
+     && memcmp(loop_cache[i].code, *code, *length * 4) == 0)
+        return &loop_cache[i].info;
+
+    loop_cache[i].branch_addr = branch_addr;
+    loop_cache[i].target = target;
+    loop_cache[i].length = *length;
+    memcpy(loop_cache[i].code, *code, *length * 4);
+    analyze_loop(*code, *length, &loop_cache[i].info);
+
+    /* every core counts a loop when it first meets it, see
+     * idle_loop_stats_record */
+    if (loop_cache[i].info.type != IDLE_LOOP_NONE)
+        idle_loop_stats_record(branch_addr, 0);
+
+    return &loop_cache[i].info;
+}
+
+enum idle_loop_type idle_loop_detect(uint32_t target, uint32_t branch_addr)
+{
+    const struct loop_info* info;
+    const uint32_t* code;
+    size_t length;
+
+    info = lookup_loop(target, branch_addr, &code, &length);
+
+    return info != NULL ? info->type : IDLE_LOOP_NONE;
+}
+
+static int is_stable_address(uint32_t address)
+{
+    if ((address & UINT32_C(0xc0000000)) != UINT32_C(0x80000000))
+    {
+        uint32_t lut = tlb_lookup(address >> 12, 0);
+
+        if (!lut)
+            return 0;
+        address = (lut & UINT32_C(0xFFFFF000)) | (address & UINT32_C(0xFFF));
+    }
+
+    switch ((address & UINT32_C(0x1fffffff)) >> 20)
+    {
+    case 0x044: /* VI_CURRENT_REG follows the count register */
+    case 0x045: /* so does AI_LEN_REG */
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+/* Computes the address of every load of the loop from the current register
+ * values, and checks that none of them can change between two events. */
+static int loads_are_stable(const uint32_t* code, size_t length, uint64_t written)
+{
+    int64_t value[32];
+    uint32_t known;
+    size_t i;
+
+    memcpy(value, reg, sizeof(value));
+    known = ~(uint32_t)written;
+
+    for (i = 0; i < length; ++i)
+    {
+        uint32_t op = code[i];
+        unsigned int rs = (op >> 21) & 0x1F;
+        unsigned int rt = (op >> 16) & 0x1F;
+        uint64_t srcs, dsts;
+        enum op_kind kind = decode_op(op, &srcs, &dsts);
+
+        if (kind == OP_LOAD)
+        {
+            if (!(known & (1u << rs))
+             || !is_stable_address((uint32_t)(value[rs] + (int16_t)op)))
+                return 0;
+        }
+
+        if (kind == OP_BRANCH || (uint32_t)dsts == 0)
+            continue;
+
+        /* Only track the usual ways of building an address */
+        switch (op >> 26)
+        {
+        case 9: /* ADDIU */
+            value[rt] = (int32_t)(value[rs] + (int16_t)op);
+            break;
+        case 13: /* ORI */
+            value[rt] = value[rs] | (uint16_t)op;
+            break;
+        case 15: /* LUI */
+            value[rt] = (int32_t)((uint32_t)(uint16_t)op << 16);
+            break;
+        case 25: /* DADDIU */
+            value[rt] = value[rs] + (int16_t)op;
+            break;
+        default:
+            known &= ~(uint32_t)dsts;
+            continue;
+        }
+
+        if (known & (1u << rs) || (op >> 26) == 15)
+            known |= (uint32_t)dsts;
+        else
+            known &= ~(uint32_t)dsts;
+    }
+
+    return 1;
+}
+
+int idle_loop_skip(int take_jump, uint32_t target, uint32_t branch_addr)
+{
+    const struct loop_info* info;
+    const uint32_t* code;
+    size_t length;
+    int skip;
+
+    if (!take_jump)
+    {
+        armed_branch = 0;
+        return 0;
+    }
+
+    info = lookup_loop(target, branch_addr, &code, &length);
+    if (info == NULL || info->type == IDLE_LOOP_NONE)
+        return 0;
+
+    if (info->type == IDLE_LOOP_POLL)
+    {
+        if (!loads_are_stable(code, length, info->written))
+            return 0;
+
+        /* Let one full iteration run first, so that the values read by the
+         * branch are the ones the loop computes. */
+        if (info->carried && armed_branch != branch_addr)
+        {
+            armed_branch = branch_addr;
+            return 0;
+        }
+    }
+
+    cp0_update_count();
+    skip = next_interupt - g_cp0_regs[CP0_COUNT_REG];
+    if (skip <= 3)
+        return 0;
+
+    skip &= ~3;
+    g_cp0_regs[CP0_COUNT_REG] += skip;
+    idle_loop_stats_record(branch_addr, skip);
+
+    return 1;
+}
+
+void idle_loop_reset(void)
+{
+    armed_branch = 0;
+
+    /* the skip recompiled code made before this event */
+    if (idle_loop_skipped_addr != 0)
+    {
+        uint32_t cycles = idle_loop_skipped_cycles;
+
+        /* new_dynarec skips by ANDing the count relative to next_interupt
+         * with 3 */
+        if (idle_loop_skipped_ccreg < 0)
+            cycles = (uint32_t)-(idle_loop_skipped_ccreg & ~3);
+
+        idle_loop_stats_record(idle_loop_skipped_addr, cycles);
+        idle_loop_skipped_addr = 0;
+        idle_loop_skipped_cycles = 0;
+        idle_loop_skipped_ccreg = 0;
+    }
+}
+
+void idle_loop_stats_record(uint32_t branch_addr, uint32_t cycles)
+{
+    unsigned int i;
+
+    if (cycles != 0)
+    {
+        ++total_skips;
+        total_cycles += cycles;
+    }
+
+    for (i = 0; i < loop_stats_count; ++i)
+    {
+        if (loop_stats[i].addr == branch_addr)
+            break;
+    }
+
+    if (i == loop_stats_count)
+    {
+        if (loop_stats_count == IDLE_LOOP_STATS_SIZE)
+            return;
+        loop_stats[i].addr = branch_addr;
+        loop_stats[i].skips = 0;
+        loop_stats[i].cycles = 0;
+        ++loop_stats_count;
+    }
+
+    if (cycles != 0)
+    {
+        ++loop_stats[i].skips;
+        loop_stats[i].cycles += cycles;
+    }
+}
+
+void idle_loop_stats_reset(void)
+{
+    loop_stats_count = 0;
+    total_skips = 0;
+    total_cycles = 0;
+    armed_branch = 0;
+    idle_loop_skipped_addr = 0;
+    idle_loop_skipped_cycles = 0;
+    idle_loop_skipped_ccreg = 0;
+    memset(loop_cache, 0, sizeof(loop_cache));
+}
+
+void idle_loop_stats_print(void)
+{
+    unsigned int i;
+
+    DebugMessage(M64MSG_INFO, "Idle loops (%s): %u detected, %" PRIu64 " skips, %" PRIu64 " cycles skipped",
+                 ROM_PARAMS.headername, loop_stats_count, total_skips, total_cycles);
+
+    for (i = 0; i < loop_stats_count; ++i)
+    {
+        DebugMessage(M64MSG_VERBOSE, "    %08" PRIX32 ": %" PRIu64 " skips, %" PRIu64 " cycles",
+                     loop_stats[i].addr, loop_stats[i].skips, loop_stats[i].cycles);
+    }
+}
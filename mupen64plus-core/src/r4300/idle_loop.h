@@ -0,0 +1,82 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - idle_loop.h                                             *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_R4300_IDLE_LOOP_H
+#define M64P_R4300_IDLE_LOOP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Longest loop (in instructions, delay slot included) considered for
+ * idle loop detection. Polling loops are short, and keeping this small
+ * bounds the cost of the analysis in the pure interpreter. */
+#define IDLE_LOOP_MAX_LENGTH 16
+
+/* Classification of a backward branch and the code it loops over. */
+enum idle_loop_type
+{
+    /* Not an idle loop: the body has side effects or its state
+     * changes from one iteration to the next. */
+    IDLE_LOOP_NONE = 0,
+    /* The exit condition does not depend on anything the body computes:
+     * only an exception (interrupt) can leave the loop. */
+    IDLE_LOOP_WAIT,
+    /* The exit condition depends on values loaded from memory or
+     * registers which can only change on an interrupt event. */
+    IDLE_LOOP_POLL
+};
+
+/* Analyzes the loop whose first instruction is code[0] and whose last
+ * two instructions (code[length-2], code[length-1]) are the backward branch
+ * and its delay slot. */
+enum idle_loop_type idle_loop_analyze(const uint32_t* code, size_t length);
+
+/* Same as idle_loop_analyze, but fetches the code from emulated memory.
+ * Only loops contained in the page of the delay slot are considered. */
+enum idle_loop_type idle_loop_detect(uint32_t target, uint32_t branch_addr);
+
+/* Called when a branch flagged as an idle loop is executed.
+ * If the loop can be safely fast-forwarded, advances the CP0 count register
+ * up to the next interrupt and returns 1. Otherwise returns 0 and the
+ * branch must be executed normally. */
+int idle_loop_skip(int take_jump, uint32_t target, uint32_t branch_addr);
+
+/* Forgets any partially validated loop (see idle_loop_skip), and records
+ * the skip left in idle_loop_skipped_* by recompiled code.
+ * Must be called whenever an exception or interrupt is taken. */
+void idle_loop_reset(void);
+
+/* Recompiled code which skips an idle loop inline stores the branch
+ * address, and the cycles it skipped (x86 recompilers) or the count
+ * relative to next_interupt before the skip (new_dynarec), for
+ * idle_loop_reset to record on the event which ends the skip. */
+extern uint32_t idle_loop_skipped_addr;
+extern uint32_t idle_loop_skipped_cycles;
+extern int32_t idle_loop_skipped_ccreg;
+
+/* Per-ROM statistics of detected loops and skipped cycles. Every core
+ * records a loop with cycles == 0 when it first decodes or compiles it,
+ * and each skip with the cycles it skipped. */
+void idle_loop_stats_record(uint32_t branch_addr, uint32_t cycles);
+void idle_loop_stats_reset(void);
+void idle_loop_stats_print(void);
+
+#endif /* M64P_R4300_IDLE_LOOP_H */
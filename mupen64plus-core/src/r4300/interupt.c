@@ -33,8 +33,11 @@
 #include "cached_interp.h"
 #include "cp0_private.h"
 #include "exception.h"
+#include "guest_profile.h"
+#include "idle_loop.h"
 #include "main/main.h"
 #include "main/savestates.h"
+#include "main/trace.h"
 #include "mi_controller.h"
 #include "new_dynarec/new_dynarec.h"
 #include "pi/pi_controller.h"
@@ -293,6 +296,15 @@ void remove_event(int type)
     }
 }
 
+void remove_pending_event(int type)
+{
+    /* the event may be the one next_interupt is set for */
+    if (get_next_event_type() == type)
+        remove_interupt_event();
+    else
+        remove_event(type);
+}
+
 void translate_event_queue(unsigned int base)
 {
     struct node* e;
@@ -500,12 +512,17 @@ static void nmi_int_handler(void)
 
 void gen_interupt(void)
 {
+    int traced;
+
     if (stop == 1)
     {
         g_gs_vi_counter = 0; // debug
         dyna_stop();
     }
 
+    /* any event may change what a polling loop is waiting for */
+    idle_loop_reset();
+
     if (!interupt_unsafe_state)
     {
         if (savestates_get_job() == savestates_job_load)
@@ -537,6 +554,12 @@ void gen_interupt(void)
         return;
     } 
 
+    /* the VI yields to the frontend (new_vi), which a zone cannot span */
+    traced = (q.first->data.type != VI_INT);
+    if (traced)
+        TRACE_BEGIN_ARG("interrupt", q.first->data.type);
+    GUEST_PROFILE_INTERRUPT(q.first->data.type);
+
     switch(q.first->data.type)
     {
         case SPECIAL_INT:
@@ -597,6 +620,9 @@ void gen_interupt(void)
             break;
     }
 
+    if (traced)
+        TRACE_END();
+
     if (!interupt_unsafe_state)
     {
         if (savestates_get_job() == savestates_job_save)
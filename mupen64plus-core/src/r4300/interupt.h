@@ -37,6 +37,9 @@ void check_interupt(void);
 
 void translate_event_queue(unsigned int base);
 void remove_event(int type);
+/* same as remove_event, and reschedules the next interrupt when the event was
+ * the one due next (for events withdrawn between two interrupts) */
+void remove_pending_event(int type);
 void add_interupt_event_count(int type, unsigned int count);
 void add_interupt_event(int type, unsigned int delay);
 unsigned int get_event(int type);
@@ -2267,6 +2267,18 @@ static void emit_writeword(int rt, int addr)
   assem_debug("str %s,fp+%d",regname[rt],offset);
   output_w32(0xe5800000|rd_rn_rm(rt,FP,0)|offset);
 }
+// Leave the count before an inline idle loop skip for idle_loop_reset
+// (outside dynarec_local, so through HOST_TEMPREG)
+static void emit_idle_loop_skipped(u_int addr)
+{
+  emit_loadlp((u_int)&idle_loop_skipped_ccreg,HOST_TEMPREG);
+  emit_writeword_indexed(HOST_CCREG,0,HOST_TEMPREG);
+  emit_movimm(addr,HOST_CCREG);
+  emit_loadlp((u_int)&idle_loop_skipped_addr,HOST_TEMPREG);
+  emit_writeword_indexed(HOST_CCREG,0,HOST_TEMPREG);
+  emit_loadlp((u_int)&idle_loop_skipped_ccreg,HOST_TEMPREG);
+  emit_readword_indexed(0,HOST_TEMPREG,HOST_CCREG);
+}
 static void emit_writehword(int rt, int addr)
 {
   u_int offset = addr-(u_int)&dynarec_local;
@@ -3809,11 +3821,15 @@ static void cop1_assemble(int i,struct regstat *i_regs)
     if(copr==31)
     {
       emit_writeword(sl,(int)&FCR31);
-      // Set the rounding mode
-      //FIXME
-      //char temp=get_reg(i_regs->regmap,-1);
-      //emit_andimm(sl,3,temp);
-      //emit_fldcw_indexed((int)&rounding_modes,temp);
+      // Set the rounding mode, the C helpers of fpu.h don't set it
+      u_int hr,reglist=0;
+      for(hr=0;hr<HOST_REGS;hr++) {
+        if(i_regs->regmap[hr]>=0) reglist|=1<<hr;
+      }
+      save_regs(reglist);
+      emit_readword((int)&FCR31,ARG1_REG);
+      emit_call((int)update_x86_rounding_mode);
+      restore_regs(reglist);
     }
   }
 }
@@ -3471,6 +3471,19 @@ static void emit_read_ptr(intptr_t addr, int rt)
   }
 }
 
+// Leave the count before an inline idle loop skip for idle_loop_reset
+// (outside dynarec_local, so through HOST_TEMPREG)
+static void emit_idle_loop_skipped(u_int addr)
+{
+  emit_read_ptr((intptr_t)&idle_loop_skipped_ccreg,HOST_TEMPREG);
+  emit_writeword_indexed(HOST_CCREG,0,HOST_TEMPREG);
+  emit_movimm(addr,HOST_CCREG);
+  emit_read_ptr((intptr_t)&idle_loop_skipped_addr,HOST_TEMPREG);
+  emit_writeword_indexed(HOST_CCREG,0,HOST_TEMPREG);
+  emit_read_ptr((intptr_t)&idle_loop_skipped_ccreg,HOST_TEMPREG);
+  emit_readword_indexed(0,HOST_TEMPREG,HOST_CCREG);
+}
+
 static void emit_sxtw(int rs,int rt)
 {
   assert(rs!=29);
@@ -41,7 +41,9 @@ extern "C" {
 #include "../cached_interp.h"
 #include "../cp0_private.h"
 #include "../cp1_private.h"
+#include "../idle_loop.h"
 #include "../interupt.h"
+#include "../op_cost.h"
 #include "../ops.h"
 #include "../r4300.h"
 #include "../recomp.h"
@@ -4740,6 +4742,17 @@ static void ds_assemble_entry(int i)
   emit_jmp(0);
 }
 
+// Idle loop: a backward branch looping over code which can only be left
+// through an interrupt (see idle_loop.c).  Loops polling memory are not
+// handled here since the cycle count stub never re-executes the body.
+static int is_idle_loop(int i)
+{
+  int t=(ba[i]-start)>>2;
+  if(ba[i]<start||t>i) return 0;
+  if(t==i&&source[i+1]==0) return 1;
+  return idle_loop_analyze(&source[t],i-t+2)==IDLE_LOOP_WAIT;
+}
+
 static void do_cc(int i,signed char i_regmap[],int *adj,int addr,int taken,int invert)
 {
   int count;
@@ -4761,11 +4774,13 @@ static void do_cc(int i,signed char i_regmap[],int *adj,int addr,int taken,int i
     *adj=0;
   }
   count=ccadj[i];
-  if(taken==TAKEN && i==(ba[i]-start)>>2 && source[i+1]==0) {
+  if(taken==TAKEN && is_idle_loop(i)) {
     // Idle loop
+    idle_loop_stats_record(start+i*4,0);
     if(count&1) emit_addimm_and_set_flags(2*(count+2),HOST_CCREG);
     idle=(int)out;
     //emit_subfrommem(&idlecount,HOST_CCREG); // Count idle cycles
+    emit_idle_loop_skipped(start+i*4);
     emit_andimm(HOST_CCREG,3,HOST_CCREG);
     jaddr=(int)out;
     emit_jmp(0);
@@ -5370,7 +5385,7 @@ static void cjump_assemble(int i,struct regstat *i_regs)
     //assem_debug("cycle count (adj)");
     if(unconditional) {
       do_cc(i,branch_regs[i].regmap,&adj,ba[i],TAKEN,0);
-      if(i!=(ba[i]-start)>>2 || source[i+1]!=0) {
+      if(!is_idle_loop(i)) {
         if(adj) emit_addimm(cc,CLOCK_DIVIDER*(ccadj[i]+2-adj),cc);
         load_regs_bt(branch_regs[i].regmap,branch_regs[i].is32,branch_regs[i].dirty,ba[i]);
         if(branch_internal)
@@ -5763,7 +5778,7 @@ static void sjump_assemble(int i,struct regstat *i_regs)
     assem_debug("cycle count (adj)");
     if(unconditional) {
       do_cc(i,branch_regs[i].regmap,&adj,ba[i],TAKEN,0);
-      if(i!=(ba[i]-start)>>2 || source[i+1]!=0) {
+      if(!is_idle_loop(i)) {
         if(adj) emit_addimm(cc,CLOCK_DIVIDER*(ccadj[i]+2-adj),cc);
         load_regs_bt(branch_regs[i].regmap,branch_regs[i].is32,branch_regs[i].dirty,ba[i]);
         if(branch_internal)
@@ -9329,11 +9344,13 @@ int new_recompile_block(int addr)
     ccadj[i]=cc;
     if(i>0&&(itype[i-1]==RJUMP||itype[i-1]==UJUMP||itype[i-1]==CJUMP||itype[i-1]==SJUMP||itype[i-1]==FJUMP||itype[i]==SYSCALL))
     {
+      // Branches count their delay slot, so charge its extra cost to the branch
+      if(itype[i]!=SYSCALL) ccadj[i-1]+=op_cost_slots(source[i]);
       cc=0;
     }
     else
     {
-      cc++;
+      cc+=1+op_cost_slots(source[i]);
     }
 
     flush_dirty_uppers(&current);
@@ -10840,7 +10857,7 @@ int new_recompile_block(int addr)
         store_regs_bt(regs[i-1].regmap,regs[i-1].is32,regs[i-1].dirty,start+i*4);
         if(regs[i-1].regmap[HOST_CCREG]!=CCREG)
           emit_loadreg(CCREG,HOST_CCREG);
-        emit_addimm(HOST_CCREG,CLOCK_DIVIDER*(ccadj[i-1]+1),HOST_CCREG);
+        emit_addimm(HOST_CCREG,CLOCK_DIVIDER*(ccadj[i-1]+1+op_cost_slots(source[i-1])),HOST_CCREG);
       }
       else if(!likely[i-2])
       {
@@ -10863,7 +10880,7 @@ int new_recompile_block(int addr)
     store_regs_bt(regs[i-1].regmap,regs[i-1].is32,regs[i-1].dirty,start+i*4);
     if(regs[i-1].regmap[HOST_CCREG]!=CCREG)
       emit_loadreg(CCREG,HOST_CCREG);
-    emit_addimm(HOST_CCREG,CLOCK_DIVIDER*(ccadj[i-1]+1),HOST_CCREG);
+    emit_addimm(HOST_CCREG,CLOCK_DIVIDER*(ccadj[i-1]+1+op_cost_slots(source[i-1])),HOST_CCREG);
     add_to_linker((int)out,start+i*4,0);
     emit_jmp(0);
   }
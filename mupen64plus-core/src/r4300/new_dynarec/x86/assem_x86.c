@@ -2384,6 +2384,12 @@ static void emit_writeword_imm(int imm, int addr)
   output_w32(addr);
   output_w32(imm);
 }
+// Leave the count before an inline idle loop skip for idle_loop_reset
+static void emit_idle_loop_skipped(u_int addr)
+{
+  emit_writeword(HOST_CCREG,(int)&idle_loop_skipped_ccreg);
+  emit_writeword_imm(addr,(int)&idle_loop_skipped_addr);
+}
 static void emit_writeword_imm_esp(int imm, int addr)
 {
   assem_debug("mov $%x,%x(%%esp)",imm,addr);
@@ -3782,7 +3788,13 @@ static void cop1_assemble(int i,struct regstat *i_regs)
     if(copr==31)
     {
       emit_writeword(sl,(int)&FCR31);
-      // Set the rounding mode
+      // Set the rounding mode, the C helpers of fpu.h don't set it
+      emit_pusha();
+      emit_pushmem((int)&FCR31);
+      emit_call((int)update_x86_rounding_mode);
+      emit_addimm(ESP,4,ESP);
+      emit_popa();
+      // and the x87 control word of the compiled code
       char temp=get_reg(i_regs->regmap,-1);
       emit_movimm(3,temp);
       emit_and(sl,temp,temp);
@@ -0,0 +1,135 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - op_cost.c                                               *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* The count register is advanced by count_per_op cycles for every executed
+ * instruction. That average already covers cache and pipeline stalls of
+ * ordinary code (loads and stores included), but badly underestimates the
+ * multi-cycle arithmetic units: a DDIV blocks the pipeline for 69 cycles.
+ *
+ * The recompilers add the extra latency given here when they count the
+ * cycles of a block, so the cost is computed once at compile time and
+ * costs nothing when running the block. The interpreters add the same
+ * amount when executing the instruction (ADD_OP_COST in interpreter.def).
+ */
+
+#include "op_cost.h"
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+
+/* Latencies in PClock cycles, from the VR4300 user's manual, minus the
+ * cycle spent by any instruction. */
+static const unsigned int op_latency[OP_COST_CLASS_COUNT] =
+{
+    0,  /* OP_COST_NONE */
+    4,  /* OP_COST_MULT */
+    7,  /* OP_COST_DMULT */
+    36, /* OP_COST_DIV */
+    68, /* OP_COST_DDIV */
+    2,  /* OP_COST_FPU_ADD */
+    4,  /* OP_COST_FPU_MUL_S */
+    7,  /* OP_COST_FPU_MUL_D */
+    28, /* OP_COST_FPU_DIV_S */
+    57, /* OP_COST_FPU_DIV_D */
+    4   /* OP_COST_FPU_CVT */
+};
+
+static unsigned int op_slots[OP_COST_CLASS_COUNT];
+static unsigned int op_cycles[OP_COST_CLASS_COUNT];
+
+void op_cost_init(unsigned int scale, unsigned int count_per_op)
+{
+    unsigned int i;
+
+    for (i = 0; i < OP_COST_CLASS_COUNT; ++i)
+    {
+        op_slots[i] = (count_per_op == 0) ? 0 :
+            (op_latency[i] * scale / 100 + count_per_op / 2) / count_per_op;
+        op_cycles[i] = op_slots[i] * count_per_op;
+    }
+
+    if (scale != 0)
+        DebugMessage(M64MSG_INFO, "Per-instruction cycle costs enabled (scale %u%%)", scale);
+}
+
+enum op_cost_class op_cost_classify(uint32_t op)
+{
+    switch (op >> 26)
+    {
+    case 0x00: /* SPECIAL */
+        switch (op & 0x3F)
+        {
+        case 0x18: /* MULT */
+        case 0x19: /* MULTU */
+            return OP_COST_MULT;
+        case 0x1A: /* DIV */
+        case 0x1B: /* DIVU */
+            return OP_COST_DIV;
+        case 0x1C: /* DMULT */
+        case 0x1D: /* DMULTU */
+            return OP_COST_DMULT;
+        case 0x1E: /* DDIV */
+        case 0x1F: /* DDIVU */
+            return OP_COST_DDIV;
+        }
+        break;
+
+    case 0x11: /* COP1 */
+    {
+        uint32_t fmt = (op >> 21) & 0x1F;
+        uint32_t func = op & 0x3F;
+
+        if (fmt != 0x10 && fmt != 0x11 && fmt != 0x14 && fmt != 0x15)
+            break;
+
+        if (func >= 0x20 && func <= 0x25)
+            return OP_COST_FPU_CVT;
+
+        if (fmt == 0x14 || fmt == 0x15)
+            break;
+
+        switch (func)
+        {
+        case 0x00: /* ADD */
+        case 0x01: /* SUB */
+            return OP_COST_FPU_ADD;
+        case 0x02: /* MUL */
+            return (fmt == 0x10) ? OP_COST_FPU_MUL_S : OP_COST_FPU_MUL_D;
+        case 0x03: /* DIV */
+        case 0x04: /* SQRT */
+            return (fmt == 0x10) ? OP_COST_FPU_DIV_S : OP_COST_FPU_DIV_D;
+        }
+        break;
+    }
+    }
+
+    return OP_COST_NONE;
+}
+
+unsigned int op_cost_slots(uint32_t op)
+{
+    return op_slots[op_cost_classify(op)];
+}
+
+unsigned int op_cost_cycles(enum op_cost_class cost_class)
+{
+    return op_cycles[cost_class];
+}
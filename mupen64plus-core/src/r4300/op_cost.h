@@ -0,0 +1,65 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - op_cost.h                                               *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_R4300_OP_COST_H
+#define M64P_R4300_OP_COST_H
+
+#include <stdint.h>
+
+/* Instruction classes whose latency exceeds the average cost of an
+ * instruction (count_per_op). */
+enum op_cost_class
+{
+    OP_COST_NONE = 0,
+    OP_COST_MULT,
+    OP_COST_DMULT,
+    OP_COST_DIV,
+    OP_COST_DDIV,
+    OP_COST_FPU_ADD,
+    OP_COST_FPU_MUL_S,
+    OP_COST_FPU_MUL_D,
+    OP_COST_FPU_DIV_S,
+    OP_COST_FPU_DIV_D,
+    OP_COST_FPU_CVT,
+    OP_COST_CLASS_COUNT
+};
+
+/* Default value of the OpCostScale ROM database entry: the cost model is
+ * only used by ROMs which opt in. */
+#define OP_COST_SCALE_DEFAULT 0
+
+/* Builds the cost table. scale is a percentage applied to the latencies
+ * of the VR4300 (0 disables the model). Extra costs are rounded to a
+ * multiple of count_per_op so that the recompilers can account for them
+ * alongside their instruction counts. */
+void op_cost_init(unsigned int scale, unsigned int count_per_op);
+
+enum op_cost_class op_cost_classify(uint32_t op);
+
+/* Number of instruction slots (each worth count_per_op cycles) to add on
+ * top of the instruction itself. */
+unsigned int op_cost_slots(uint32_t op);
+
+/* Same extra cost in cycles, for the interpreters which add it when they
+ * execute an instruction of that class. */
+unsigned int op_cost_cycles(enum op_cost_class cost_class);
+
+#endif /* M64P_R4300_OP_COST_H */
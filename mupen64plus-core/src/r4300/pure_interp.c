@@ -33,9 +33,12 @@
 #include "cp0_private.h"
 #include "cp1_private.h"
 #include "exception.h"
+#include "guest_profile.h"
+#include "idle_loop.h"
 #include "interupt.h"
 #include "main/main.h"
 #include "memory/memory.h"
+#include "op_cost.h"
 #include "osal/preproc.h"
 #include "r4300.h"
 #include "tlb.h"
@@ -86,18 +89,12 @@ static void InterpretOpcode(void);
    static void name##_IDLE(uint32_t op) \
    { \
       const int take_jump = (condition); \
-      int skip; \
       if (cop1 && check_cop1_unusable()) return; \
-      if (take_jump) \
-      { \
-         cp0_update_count(); \
-         skip = next_interupt - g_cp0_regs[CP0_COUNT_REG]; \
-         if (skip > 3) g_cp0_regs[CP0_COUNT_REG] += (skip & UINT32_C(0xFFFFFFFC)); \
-         else name(op); \
-      } \
-      else name(op); \
+      if (!idle_loop_skip(take_jump, (destination), PCADDR)) name(op); \
    }
 #define CHECK_MEMORY()
+#define ADD_OP_COST(cost_class) \
+   g_cp0_regs[CP0_COUNT_REG] += op_cost_cycles(cost_class)
 
 #define RD_OF(op)      (((op) >> 11) & 0x1F)
 #define RS_OF(op)      (((op) >> 21) & 0x1F)
@@ -110,21 +107,20 @@ static void InterpretOpcode(void);
 #define FT_OF(op)      (((op) >> 16) & 0x1F)
 #define JUMP_OF(op)    ((op) & UINT32_C(0x3FFFFFF))
 
-/* Determines whether a relative jump in a 16-bit immediate goes back to the
- * same instruction without doing any work in its delay slot. The jump is
- * relative to the instruction in the delay slot, so 1 instruction backwards
- * (-1) goes back to the jump. */
+/* Determines whether a relative jump in a 16-bit immediate goes back to a
+ * loop which does no work other than waiting for an interrupt (see
+ * idle_loop.c). The jump is relative to the instruction in the delay slot,
+ * so 1 instruction backwards (-1) goes back to the jump. */
 #define IS_RELATIVE_IDLE_LOOP(op, addr) \
-	(IMM16S_OF(op) == -1 && *fast_mem_access((addr) + 4) == 0)
+	(IMM16S_OF(op) < 0 \
+	 && idle_loop_detect((addr) + (IMM16S_OF(op) + 1) * 4, (addr)) != IDLE_LOOP_NONE)
 
-/* Determines whether an absolute jump in a 26-bit immediate goes back to the
- * same instruction without doing any work in its delay slot. The jump is
+/* Same as above, for an absolute jump in a 26-bit immediate. The jump is
  * in the same 256 MiB segment as the delay slot, so if the jump instruction
- * is at the last address in its segment, it does not jump back to itself. */
+ * is at the last address in its segment, it can't go back to the loop. */
 #define IS_ABSOLUTE_IDLE_LOOP(op, addr) \
-	(JUMP_OF(op) == ((addr) & UINT32_C(0x0FFFFFFF)) >> 2 \
-	 && ((addr) & UINT32_C(0x0FFFFFFF)) != UINT32_C(0x0FFFFFFC) \
-	 && *fast_mem_access((addr) + 4) == 0)
+	(idle_loop_detect((JUMP_OF(op) << 2) | (((addr) + 4) & UINT32_C(0xF0000000)), (addr)) \
+	 != IDLE_LOOP_NONE)
 
 #define SE8(a) ((int64_t) ((int8_t) (a)))
 #define SE16(a) ((int64_t) ((int16_t) (a)))
@@ -724,9 +720,16 @@ void InterpretOpcode()
 
 void pure_interpreter(void)
 {
+#ifdef GUEST_PROFILE
+   uint32_t profiled_addr;
+#endif
+
    stop = 0;
    PC = &interp_PC;
    PC->addr = last_addr = 0xa4000040;
+#ifdef GUEST_PROFILE
+   profiled_addr = 0;
+#endif
 
    while (!stop)
    {
@@ -735,6 +738,11 @@ void pure_interpreter(void)
 #endif
 #ifdef DBG
      if (g_DebuggerActive) update_debugger(PC->addr);
+#endif
+#ifdef GUEST_PROFILE
+     /* a branch runs its delay slot, PC moves by 8 when not taken */
+     if (PC->addr - profiled_addr - 4 > 4) guest_profile_block(PC->addr);
+     profiled_addr = PC->addr;
 #endif
      InterpretOpcode();
    }
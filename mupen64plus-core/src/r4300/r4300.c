@@ -30,9 +30,12 @@
 #include "cached_interp.h"
 #include "cp0_private.h"
 #include "cp1_private.h"
+#include "guest_profile.h"
+#include "idle_loop.h"
 #include "interupt.h"
 #include "main/main.h"
 #include "main/rom.h"
+#include "memory/fastmem.h"
 #include "memory/memory.h"
 #include "mi_controller.h"
 #include "new_dynarec/new_dynarec.h"
@@ -176,6 +179,9 @@ void r4300_execute(void)
 #if (defined(DYNAREC) && defined(PROFILE_R4300))
     unsigned int i;
 #endif
+#ifdef GUEST_PROFILE
+    uint32_t profiled_addr;
+#endif
 
     current_instruction_table = cached_interpreter_table;
 
@@ -187,6 +193,10 @@ void r4300_execute(void)
 #if defined(COUNT_INSTR)
     memset(instr_count, 0, 131*sizeof(instr_count[0]));
 #endif
+    idle_loop_stats_reset();
+#ifdef GUEST_PROFILE
+    guest_profile_start();
+#endif
 
     last_addr = 0xa4000040;
     next_interupt = 624999;
@@ -210,8 +220,11 @@ void r4300_execute(void)
         new_dyna_start();
         new_dynarec_cleanup();
 #else
+        if (fastmem_init(g_dev.ri.rdram.dram, g_dev.ri.rdram.dram_size))
+            tlb_reload();
         dyna_start(dynarec_setup_code);
         PC++;
+        fastmem_deinit();
 #endif
 #if defined(PROFILE_R4300)
         pfProfile = fopen("instructionaddrs.dat", "ab");
@@ -245,6 +258,9 @@ void r4300_execute(void)
             return;
 
         last_addr = PC->addr;
+#ifdef GUEST_PROFILE
+        profiled_addr = 0;
+#endif
         while (!stop)
         {
 #ifdef COMPARE_CORE
@@ -254,6 +270,11 @@ void r4300_execute(void)
 #endif
 #ifdef DBG
             if (g_DebuggerActive) update_debugger(PC->addr);
+#endif
+#ifdef GUEST_PROFILE
+            /* a branch runs its delay slot, PC moves by 8 when not taken */
+            if (PC->addr - profiled_addr - 4 > 4) guest_profile_block(PC->addr);
+            profiled_addr = PC->addr;
 #endif
             PC->ops();
         }
@@ -261,8 +282,14 @@ void r4300_execute(void)
         free_blocks();
     }
 
+#ifdef GUEST_PROFILE
+    guest_profile_stop();
+#endif
+
     DebugMessage(M64MSG_INFO, "R4300 emulator finished.");
 
+    idle_loop_stats_print();
+
     /* print instruction counts */
 #if defined(COUNT_INSTR)
     if (r4300emu == CORE_DYNAREC)
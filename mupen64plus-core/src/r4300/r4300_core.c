@@ -54,8 +54,7 @@ void poweron_r4300(struct r4300_core* r4300)
 
     /* clear TLB entries */
     memset(tlb_e, 0, 32 * sizeof(tlb_e[0]));
-    memset(tlb_LUT_r, 0, 0x100000 * sizeof(tlb_LUT_r[0]));
-    memset(tlb_LUT_w, 0, 0x100000 * sizeof(tlb_LUT_w[0]));
+    tlb_reload();
 
     /* setup CP1 registers */
     memset(reg_cop1_fgr_64, 0, 32 * sizeof(reg_cop1_fgr_64[0]));
@@ -41,7 +41,9 @@
 #include "api/m64p_types.h"
 #include "cached_interp.h"
 #include "cp0_private.h"
+#include "idle_loop.h"
 #include "main/profile.h"
+#include "main/trace.h"
 #include "memory/memory.h"
 #include "ops.h"
 #include "r4300.h"
@@ -74,6 +76,33 @@ static int check_nop; // next instruction is nop ?
 static int delay_slot_compiled = 0;
 
 
+/* Returns 1 when the branch being recompiled jumps to itself with a nop in
+ * its delay slot. */
+static int is_self_loop(uint32_t target)
+{
+   if (target != dst->addr || !check_nop)
+      return 0;
+
+   idle_loop_stats_record(dst->addr, 0);
+   return 1;
+}
+
+/* Returns 1 when the backward branch being recompiled closes an idle loop
+ * lying entirely in the current block. */
+static int is_idle_loop(uint32_t target)
+{
+   uint32_t distance;
+
+   if (target < dst_block->start || target > dst->addr || dst->addr + 4 >= dst_block->end)
+      return 0;
+
+   distance = (dst->addr - target) >> 2;
+   if (idle_loop_analyze(SRC - distance, distance + 2) == IDLE_LOOP_NONE)
+      return 0;
+
+   idle_loop_stats_record(dst->addr, 0);
+   return 1;
+}
 
 static void RSV(void)
 {
@@ -547,13 +576,15 @@ static void RBLTZ(void)
    recomp_func = genbltz;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BLTZ_IDLE;
-         recomp_func = genbltz_idle;
-      }
+      dst->ops = current_instruction_table.BLTZ_IDLE;
+      recomp_func = genbltz_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BLTZ_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -569,13 +600,15 @@ static void RBGEZ(void)
    recomp_func = genbgez;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BGEZ_IDLE;
-         recomp_func = genbgez_idle;
-      }
+      dst->ops = current_instruction_table.BGEZ_IDLE;
+      recomp_func = genbgez_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BGEZ_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -591,13 +624,15 @@ static void RBLTZL(void)
    recomp_func = genbltzl;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BLTZL_IDLE;
-         recomp_func = genbltzl_idle;
-      }
+      dst->ops = current_instruction_table.BLTZL_IDLE;
+      recomp_func = genbltzl_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BLTZL_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -613,13 +648,15 @@ static void RBGEZL(void)
    recomp_func = genbgezl;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BGEZL_IDLE;
-         recomp_func = genbgezl_idle;
-      }
+      dst->ops = current_instruction_table.BGEZL_IDLE;
+      recomp_func = genbgezl_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BGEZL_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -671,13 +708,15 @@ static void RBLTZAL(void)
    recomp_func = genbltzal;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BLTZAL_IDLE;
-         recomp_func = genbltzal_idle;
-      }
+      dst->ops = current_instruction_table.BLTZAL_IDLE;
+      recomp_func = genbltzal_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BLTZAL_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -693,13 +732,15 @@ static void RBGEZAL(void)
    recomp_func = genbgezal;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BGEZAL_IDLE;
-         recomp_func = genbgezal_idle;
-      }
+      dst->ops = current_instruction_table.BGEZAL_IDLE;
+      recomp_func = genbgezal_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BGEZAL_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -715,13 +756,15 @@ static void RBLTZALL(void)
    recomp_func = genbltzall;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BLTZALL_IDLE;
-         recomp_func = genbltzall_idle;
-      }
+      dst->ops = current_instruction_table.BLTZALL_IDLE;
+      recomp_func = genbltzall_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BLTZALL_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -737,13 +780,15 @@ static void RBGEZALL(void)
    recomp_func = genbgezall;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BGEZALL_IDLE;
-         recomp_func = genbgezall_idle;
-      }
+      dst->ops = current_instruction_table.BGEZALL_IDLE;
+      recomp_func = genbgezall_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BGEZALL_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -852,13 +897,15 @@ static void RBC1F(void)
    recomp_func = genbc1f;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BC1F_IDLE;
-         recomp_func = genbc1f_idle;
-      }
+      dst->ops = current_instruction_table.BC1F_IDLE;
+      recomp_func = genbc1f_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BC1F_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -874,13 +921,15 @@ static void RBC1T(void)
    recomp_func = genbc1t;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BC1T_IDLE;
-         recomp_func = genbc1t_idle;
-      }
+      dst->ops = current_instruction_table.BC1T_IDLE;
+      recomp_func = genbc1t_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BC1T_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -896,13 +945,15 @@ static void RBC1FL(void)
    recomp_func = genbc1fl;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BC1FL_IDLE;
-         recomp_func = genbc1fl_idle;
-      }
+      dst->ops = current_instruction_table.BC1FL_IDLE;
+      recomp_func = genbc1fl_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BC1FL_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -918,13 +969,15 @@ static void RBC1TL(void)
    recomp_func = genbc1tl;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BC1TL_IDLE;
-         recomp_func = genbc1tl_idle;
-      }
+      dst->ops = current_instruction_table.BC1TL_IDLE;
+      recomp_func = genbc1tl_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BC1TL_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -1630,13 +1683,15 @@ static void RJ(void)
    recomp_func = genj;
    recompile_standard_j_type();
    target = (dst->f.j.inst_index<<2) | (dst->addr & UINT32_C(0xF0000000));
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.J_IDLE;
-         recomp_func = genj_idle;
-      }
+      dst->ops = current_instruction_table.J_IDLE;
+      recomp_func = genj_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.J_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -1652,13 +1707,15 @@ static void RJAL(void)
    recomp_func = genjal;
    recompile_standard_j_type();
    target = (dst->f.j.inst_index<<2) | (dst->addr & UINT32_C(0xF0000000));
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.JAL_IDLE;
-         recomp_func = genjal_idle;
-      }
+      dst->ops = current_instruction_table.JAL_IDLE;
+      recomp_func = genjal_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.JAL_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -1674,13 +1731,15 @@ static void RBEQ(void)
    recomp_func = genbeq;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BEQ_IDLE;
-         recomp_func = genbeq_idle;
-      }
+      dst->ops = current_instruction_table.BEQ_IDLE;
+      recomp_func = genbeq_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BEQ_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -1696,13 +1755,15 @@ static void RBNE(void)
    recomp_func = genbne;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BNE_IDLE;
-         recomp_func = genbne_idle;
-      }
+      dst->ops = current_instruction_table.BNE_IDLE;
+      recomp_func = genbne_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BNE_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -1718,13 +1779,15 @@ static void RBLEZ(void)
    recomp_func = genblez;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BLEZ_IDLE;
-         recomp_func = genblez_idle;
-      }
+      dst->ops = current_instruction_table.BLEZ_IDLE;
+      recomp_func = genblez_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BLEZ_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -1740,13 +1803,15 @@ static void RBGTZ(void)
    recomp_func = genbgtz;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BGTZ_IDLE;
-         recomp_func = genbgtz_idle;
-      }
+      dst->ops = current_instruction_table.BGTZ_IDLE;
+      recomp_func = genbgtz_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BGTZ_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -1836,13 +1901,15 @@ static void RBEQL(void)
    recomp_func = genbeql;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BEQL_IDLE;
-         recomp_func = genbeql_idle;
-      }
+      dst->ops = current_instruction_table.BEQL_IDLE;
+      recomp_func = genbeql_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BEQL_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -1858,13 +1925,15 @@ static void RBNEL(void)
    recomp_func = genbnel;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BNEL_IDLE;
-         recomp_func = genbnel_idle;
-      }
+      dst->ops = current_instruction_table.BNEL_IDLE;
+      recomp_func = genbnel_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BNEL_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -1880,13 +1949,15 @@ static void RBLEZL(void)
    recomp_func = genblezl;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BLEZL_IDLE;
-         recomp_func = genblezl_idle;
-      }
+      dst->ops = current_instruction_table.BLEZL_IDLE;
+      recomp_func = genblezl_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BLEZL_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -1902,13 +1973,15 @@ static void RBGTZL(void)
    recomp_func = genbgtzl;
    recompile_standard_i_type();
    target = dst->addr + dst->f.i.immediate*4 + 4;
-   if (target == dst->addr)
+   if (is_self_loop(target))
    {
-      if (check_nop)
-      {
-         dst->ops = current_instruction_table.BGTZL_IDLE;
-         recomp_func = genbgtzl_idle;
-      }
+      dst->ops = current_instruction_table.BGTZL_IDLE;
+      recomp_func = genbgtzl_idle;
+   }
+   else if (is_idle_loop(target))
+   {
+      dst->ops = current_instruction_table.BGTZL_IDLE;
+      recomp_func = genidle_loop;
    }
    else if (target < dst_block->start || target >= dst_block->end || dst->addr == (dst_block->end-4))
    {
@@ -2172,6 +2245,7 @@ void init_block(precomp_block *block)
   int i, length, already_exist = 1;
   static int init_length;
   timed_section_start(TIMED_SECTION_COMPILER);
+  TRACE_BEGIN("init_block");
 #ifdef CORE_DBG
   DebugMessage(M64MSG_INFO, "init block %" PRIX32 " - %" PRIX32, block->start, block->end);
 #endif
@@ -2185,6 +2259,7 @@ void init_block(precomp_block *block)
         block->block = (precomp_instr *) malloc_exec(memsize);
         if (!block->block) {
             DebugMessage(M64MSG_ERROR, "Memory error: couldn't allocate executable memory for dynamic recompiler. Try to use an interpreter mode.");
+            TRACE_END();
             return;
         }
     }
@@ -2192,6 +2267,7 @@ void init_block(precomp_block *block)
         block->block = (precomp_instr *) malloc(memsize);
         if (!block->block) {
             DebugMessage(M64MSG_ERROR, "Memory error: couldn't allocate memory for cached interpreter.");
+            TRACE_END();
             return;
         }
     }
@@ -2341,6 +2417,7 @@ void init_block(precomp_block *block)
       init_block(blocks[alt_addr>>12]);
     }
   }
+  TRACE_END();
   timed_section_end(TIMED_SECTION_COMPILER);
 }
 
@@ -2368,6 +2445,7 @@ void recompile_block(const uint32_t *source, precomp_block *block, uint32_t func
    uint32_t i;
    int length, finished=0;
    timed_section_start(TIMED_SECTION_COMPILER);
+   TRACE_BEGIN("recompile_block");
    length = (block->end-block->start)/4;
    dst_block = block;
    
@@ -2415,7 +2493,11 @@ void recompile_block(const uint32_t *source, precomp_block *block, uint32_t func
 #endif
     recomp_func = NULL;
     recomp_ops[((src >> 26) & 0x3F)]();
-    if (r4300emu == CORE_DYNAREC) recomp_func();
+    if (r4300emu == CORE_DYNAREC)
+    {
+       recomp_func();
+       genop_cost(source[i]);
+    }
     dst = block->block + i;
 
     /*if ((dst+1)->ops != NOTCOMPILED && !delay_slot_compiled &&
@@ -2495,6 +2577,7 @@ void recompile_block(const uint32_t *source, precomp_block *block, uint32_t func
    fclose(pfProfile);
    pfProfile = NULL;
 #endif
+   TRACE_END();
    timed_section_end(TIMED_SECTION_COMPILER);
 }
 
@@ -2592,7 +2675,11 @@ void recompile_opcode(void)
 #endif
      recomp_func = NULL;
      recomp_ops[((src >> 26) & 0x3F)]();
-     if (r4300emu == CORE_DYNAREC) recomp_func();
+     if (r4300emu == CORE_DYNAREC)
+     {
+        recomp_func();
+        genop_cost(src);
+     }
    }
    else
    {
@@ -42,6 +42,7 @@ void init_assembler(void *block_jumps_table, int block_jumps_number, void *block
 void free_assembler(void **block_jumps_table, int *block_jumps_number, void **block_riprel_table, int *block_riprel_number);
 
 void gencallinterp(uintptr_t addr, int jump);
+void genop_cost(uint32_t op);
 
 void genupdate_system(int type);
 void genbnel(void);
@@ -289,6 +290,7 @@ void gencheck_interupt_reg(void);
 void gentest(void);
 void gentest_out(void);
 void gentest_idle(void);
+void genidle_loop(void);
 void gentestl(void);
 void gentestl_out(void);
 void gencheck_cop1_unusable(void);
@@ -21,16 +21,100 @@
 
 #include "tlb.h"
 
+#include <string.h>
+
 #include "api/m64p_types.h"
 #include "exception.h"
 #include "main/rom.h"
+#include "memory/fastmem.h"
 
 tlb tlb_e[32];
 
 unsigned int tlb_LUT_r[0x100000];
 unsigned int tlb_LUT_w[0x100000];
 
-void tlb_unmap(tlb *entry)
+#ifndef NEW_DYNAREC
+/* tlb_LUT_r and tlb_LUT_w only cache the translations of tlb_e: a page is
+ * filled by tlb_refill the first time it is translated, and a TLB write drops
+ * the cache by clearing the pages filled since the last flush, instead of
+ * walking every page of the old and new entries. The new dynarec keeps its
+ * memory_map in sync with the tables, so it still fills them eagerly. */
+#define TLB_FILLED_MAX 0x4000
+
+static uint32_t tlb_filled[TLB_FILLED_MAX];
+static unsigned int tlb_filled_count = 0;
+static int tlb_filled_overflow = 0;
+#endif
+
+/* kseg0 and kseg1 keep their direct views of RDRAM in the fastmem space */
+static int is_host_mappable(unsigned int start, unsigned int end)
+{
+    return start < end && (end < UINT32_C(0x80000000) || start >= UINT32_C(0xC0000000));
+}
+
+static void map_host_pages(unsigned int start, unsigned int end, unsigned int phys, char d)
+{
+    if (is_host_mappable(start, end))
+        fastmem_map(start, phys, end - start + 1, d);
+}
+
+static void unmap_host_pages(unsigned int start, unsigned int end)
+{
+    if (is_host_mappable(start, end))
+        fastmem_unmap(start, end - start + 1);
+}
+
+static int is_LUT_mappable(unsigned int start, unsigned int end, unsigned int phys)
+{
+    return start < end && !(start >= 0x80000000 && end < 0xC0000000) && phys < 0x20000000;
+}
+
+uint32_t tlb_entry_LUT(const tlb *entry, uint32_t address, int w)
+{
+    address &= UINT32_C(0xFFFFF000);
+
+    if (entry->v_even && address >= entry->start_even && address <= entry->end_even)
+    {
+        if (!is_LUT_mappable(entry->start_even, entry->end_even, entry->phys_even) || (w && !entry->d_even))
+            return 0;
+        return UINT32_C(0x80000000) | (entry->phys_even + (address - entry->start_even) + 0xFFF);
+    }
+
+    if (entry->v_odd && address >= entry->start_odd && address <= entry->end_odd)
+    {
+        if (!is_LUT_mappable(entry->start_odd, entry->end_odd, entry->phys_odd) || (w && !entry->d_odd))
+            return 0;
+        return UINT32_C(0x80000000) | (entry->phys_odd + (address - entry->start_odd) + 0xFFF);
+    }
+
+    return 0;
+}
+
+#ifdef NEW_DYNAREC
+static void fill_pages(tlb *entry)
+{
+    unsigned int i;
+
+    if (entry->v_even && is_LUT_mappable(entry->start_even, entry->end_even, entry->phys_even))
+    {
+        for (i=entry->start_even;i<entry->end_even;i+=0x1000)
+            tlb_LUT_r[i>>12] = UINT32_C(0x80000000) | (entry->phys_even + (i - entry->start_even) + 0xFFF);
+        if (entry->d_even)
+            for (i=entry->start_even;i<entry->end_even;i+=0x1000)
+                tlb_LUT_w[i>>12] = UINT32_C(0x80000000) | (entry->phys_even + (i - entry->start_even) + 0xFFF);
+    }
+
+    if (entry->v_odd && is_LUT_mappable(entry->start_odd, entry->end_odd, entry->phys_odd))
+    {
+        for (i=entry->start_odd;i<entry->end_odd;i+=0x1000)
+            tlb_LUT_r[i>>12] = UINT32_C(0x80000000) | (entry->phys_odd + (i - entry->start_odd) + 0xFFF);
+        if (entry->d_odd)
+            for (i=entry->start_odd;i<entry->end_odd;i+=0x1000)
+                tlb_LUT_w[i>>12] = UINT32_C(0x80000000) | (entry->phys_odd + (i - entry->start_odd) + 0xFFF);
+    }
+}
+
+static void clear_pages(tlb *entry)
 {
     unsigned int i;
 
@@ -52,42 +136,137 @@ void tlb_unmap(tlb *entry)
                 tlb_LUT_w[i>>12] = 0;
     }
 }
+#endif
 
-void tlb_map(tlb *entry)
+static void flush_LUT(void)
 {
+#ifndef NEW_DYNAREC
     unsigned int i;
 
-    if (entry->v_even)
+    if (!tlb_filled_overflow)
     {
-        if (entry->start_even < entry->end_even &&
-            !(entry->start_even >= 0x80000000 && entry->end_even < 0xC0000000) &&
-            entry->phys_even < 0x20000000)
+        for (i = 0; i < tlb_filled_count; i++)
         {
-            for (i=entry->start_even;i<entry->end_even;i+=0x1000)
-                tlb_LUT_r[i>>12] = UINT32_C(0x80000000) | (entry->phys_even + (i - entry->start_even) + 0xFFF);
-            if (entry->d_even)
-                for (i=entry->start_even;i<entry->end_even;i+=0x1000)
-                    tlb_LUT_w[i>>12] = UINT32_C(0x80000000) | (entry->phys_even + (i - entry->start_even) + 0xFFF);
+            tlb_LUT_r[tlb_filled[i]] = 0;
+            tlb_LUT_w[tlb_filled[i]] = 0;
         }
+        tlb_filled_count = 0;
+        return;
     }
+    tlb_filled_count = 0;
+    tlb_filled_overflow = 0;
+#endif
+
+    memset(tlb_LUT_r, 0, 0x100000 * sizeof(tlb_LUT_r[0]));
+    memset(tlb_LUT_w, 0, 0x100000 * sizeof(tlb_LUT_w[0]));
+}
 
+uint32_t tlb_refill(uint32_t page, int w)
+{
+#ifndef NEW_DYNAREC
+    uint32_t lut;
+    int i;
+
+    /* the last entry wins when entries overlap, like in tlb_write_LUT */
+    for (i = 31; i >= 0; i--)
+    {
+        lut = tlb_entry_LUT(&tlb_e[i], page << 12, 0);
+        if (lut != 0)
+        {
+            tlb_LUT_r[page] = lut;
+            tlb_LUT_w[page] = tlb_entry_LUT(&tlb_e[i], page << 12, 1);
+
+            /* when the list is full, the next flush clears the whole tables */
+            if (tlb_filled_count < TLB_FILLED_MAX)
+                tlb_filled[tlb_filled_count++] = page;
+            else
+                tlb_filled_overflow = 1;
+
+            return w ? tlb_LUT_w[page] : lut;
+        }
+    }
+#else
+    (void)page;
+    (void)w;
+#endif
+
+    return 0;
+}
+
+void tlb_unmap(tlb *entry)
+{
+    if (entry->v_even)
+        unmap_host_pages(entry->start_even, entry->end_even);
     if (entry->v_odd)
+        unmap_host_pages(entry->start_odd, entry->end_odd);
+
+#ifdef NEW_DYNAREC
+    clear_pages(entry);
+#else
+    if (entry->v_even || entry->v_odd)
+        flush_LUT();
+#endif
+}
+
+void tlb_map(tlb *entry)
+{
+    if (entry->v_even && is_LUT_mappable(entry->start_even, entry->end_even, entry->phys_even))
+        map_host_pages(entry->start_even, entry->end_even, entry->phys_even, entry->d_even);
+    if (entry->v_odd && is_LUT_mappable(entry->start_odd, entry->end_odd, entry->phys_odd))
+        map_host_pages(entry->start_odd, entry->end_odd, entry->phys_odd, entry->d_odd);
+
+#ifdef NEW_DYNAREC
+    fill_pages(entry);
+#endif
+}
+
+void tlb_reload(void)
+{
+    unsigned int i;
+
+    flush_LUT();
+    fastmem_unmap(UINT32_C(0x00000000), UINT32_C(0x80000000));
+    fastmem_unmap(UINT32_C(0xC0000000), UINT32_C(0x40000000));
+
+    for (i = 0; i < 32; i++)
+        tlb_map(&tlb_e[i]);
+}
+
+void tlb_write_LUT(unsigned char *lut_r, unsigned char *lut_w)
+{
+    uint32_t lut;
+    unsigned int i, page;
+
+    memset(lut_r, 0, 0x100000 * sizeof(uint32_t));
+    memset(lut_w, 0, 0x100000 * sizeof(uint32_t));
+
+    /* in TLB order, so that the last entry wins when entries overlap */
+    for (i = 0; i < 32; i++)
     {
-        if (entry->start_odd < entry->end_odd &&
-            !(entry->start_odd >= 0x80000000 && entry->end_odd < 0xC0000000) &&
-            entry->phys_odd < 0x20000000)
+        const tlb *entry = &tlb_e[i];
+        unsigned int start[2] = { entry->start_even, entry->start_odd };
+        unsigned int end[2] = { entry->end_even, entry->end_odd };
+        int j;
+
+        for (j = 0; j < 2; j++)
         {
-            for (i=entry->start_odd;i<entry->end_odd;i+=0x1000)
-                tlb_LUT_r[i>>12] = UINT32_C(0x80000000) | (entry->phys_odd + (i - entry->start_odd) + 0xFFF);
-            if (entry->d_odd)
-                for (i=entry->start_odd;i<entry->end_odd;i+=0x1000)
-                    tlb_LUT_w[i>>12] = UINT32_C(0x80000000) | (entry->phys_odd + (i - entry->start_odd) + 0xFFF);
+            for (page = start[j] >> 12; start[j] < end[j] && page <= (end[j] >> 12); page++)
+            {
+                lut = tlb_entry_LUT(entry, page << 12, 0);
+                if (lut != 0)
+                    memcpy(lut_r + page * sizeof(uint32_t), &lut, sizeof(lut));
+                lut = tlb_entry_LUT(entry, page << 12, 1);
+                if (lut != 0)
+                    memcpy(lut_w + page * sizeof(uint32_t), &lut, sizeof(lut));
+            }
         }
     }
 }
 
 uint32_t virtual_to_physical_address(uint32_t addresse, int w)
 {
+    uint32_t lut;
+
     if (addresse >= UINT32_C(0x7f000000) && addresse < UINT32_C(0x80000000) && isGoldeneyeRom)
     {
         /**************************************************
@@ -114,16 +293,9 @@ uint32_t virtual_to_physical_address(uint32_t addresse, int w)
             break;
         }
     }
-    if (w == 1)
-    {
-        if (tlb_LUT_w[addresse>>12])
-            return (tlb_LUT_w[addresse>>12] & UINT32_C(0xFFFFF000)) | (addresse & UINT32_C(0xFFF));
-    }
-    else
-    {
-        if (tlb_LUT_r[addresse>>12])
-            return (tlb_LUT_r[addresse>>12] & UINT32_C(0xFFFFF000)) | (addresse & UINT32_C(0xFFF));
-    }
+    lut = tlb_lookup(addresse >> 12, w == 1);
+    if (lut != 0)
+        return (lut & UINT32_C(0xFFFFF000)) | (addresse & UINT32_C(0xFFF));
     //printf("tlb exception !!! @ %x, %x, add:%x\n", addresse, w, PC->addr);
     //getchar();
     TLB_refill_exception(addresse,w);
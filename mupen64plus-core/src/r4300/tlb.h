@@ -24,6 +24,8 @@
 
 #include <stdint.h>
 
+#include "osal/preproc.h"
+
 typedef struct _tlb
 {
    short mask;
@@ -50,11 +52,33 @@ typedef struct _tlb
 } tlb;
 
 extern tlb tlb_e[32];
+/* Per virtual page: 0 if the page isn't translated, otherwise
+ * 0x80000000 | physical address of the page | 0xFFF. Except with the new
+ * dynarec, pages are only filled on demand, so use tlb_lookup to read them. */
 extern uint32_t tlb_LUT_r[0x100000];
 extern uint32_t tlb_LUT_w[0x100000];
 
 void tlb_unmap(tlb *entry);
 void tlb_map(tlb *entry);
+/* Rebuilds tlb_LUT_r, tlb_LUT_w and the fastmem views of the TLB from tlb_e,
+ * after the TLB was reset or loaded without tlb_map. */
+void tlb_reload(void);
+/* Fills the page of tlb_LUT_r and tlb_LUT_w from tlb_e, and returns its
+ * entry of tlb_LUT_w if w is set, of tlb_LUT_r otherwise. */
+uint32_t tlb_refill(uint32_t page, int w);
+/* Returns the tlb_LUT_r (or tlb_LUT_w if w is set) value of address if
+ * entry translates it, 0 otherwise. */
+uint32_t tlb_entry_LUT(const tlb *entry, uint32_t address, int w);
+/* Writes the tlb_LUT_r and tlb_LUT_w tables with every page filled, in host
+ * byte order, as stored in savestates. */
+void tlb_write_LUT(unsigned char *lut_r, unsigned char *lut_w);
 uint32_t virtual_to_physical_address(uint32_t addresse, int w);
 
+static osal_inline uint32_t tlb_lookup(uint32_t page, int w)
+{
+    uint32_t lut = w ? tlb_LUT_w[page] : tlb_LUT_r[page];
+
+    return lut != 0 ? lut : tlb_refill(page, w);
+}
+
 #endif /* M64P_R4300_TLB_H */
@@ -182,6 +182,14 @@ static osal_inline void add_m32_reg32(unsigned int *m32, int reg32)
    put32((unsigned int)(m32));
 }
 
+static osal_inline void add_m32_imm32(unsigned int *m32, unsigned int imm32)
+{
+   put8(0x81);
+   put8(0x05);
+   put32((unsigned int)(m32));
+   put32(imm32);
+}
+
 static osal_inline void sub_reg32_m32(int reg32, unsigned int *m32)
 {
    put8(0x2B);
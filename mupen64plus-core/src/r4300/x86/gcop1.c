@@ -25,6 +25,7 @@
 #include "assemble.h"
 #include "interpret.h"
 #include "memory/memory.h"
+#include "r4300/cached_interp.h"
 #include "r4300/cp1_private.h"
 #include "r4300/macros.h"
 #include "r4300/ops.h"
@@ -113,29 +114,12 @@ void genctc1(void)
    gencallinterp((unsigned int)cached_interpreter_table.CTC1, 0);
 #else
    gencheck_cop1_unusable();
-   
+
    if (dst->f.r.nrd != 31) return;
-   mov_eax_memoffs32((unsigned int*)dst->f.r.rt);
-   mov_memoffs32_eax((unsigned int*)&FCR31);
-   and_eax_imm32(3);
-   
-   cmp_eax_imm32(0);
-   jne_rj(12);
-   mov_m32_imm32((unsigned int*)&rounding_mode, 0x33F); // 10
-   jmp_imm_short(48); // 2
-   
-   cmp_eax_imm32(1); // 5
-   jne_rj(12); // 2
-   mov_m32_imm32((unsigned int*)&rounding_mode, 0xF3F); // 10
-   jmp_imm_short(29); // 2
-   
-   cmp_eax_imm32(2); // 5
-   jne_rj(12); // 2
-   mov_m32_imm32((unsigned int*)&rounding_mode, 0xB3F); // 10
-   jmp_imm_short(10); // 2
-   
-   mov_m32_imm32((unsigned int*)&rounding_mode, 0x73F); // 10
-   
+
+   /* The interpreter updates rounding_mode and the rounding mode of the
+    * host FPU, which COP1 helpers called from C rely on. */
+   gencallinterp((unsigned int)cached_interpreter_table.CTC1, 0);
    fldcw_m16((unsigned short*)&rounding_mode);
 #endif
 }
@@ -28,7 +28,9 @@
 #include "r4300/cp0_private.h"
 #include "r4300/cp1_private.h"
 #include "r4300/exception.h"
+#include "r4300/idle_loop.h"
 #include "r4300/interupt.h"
+#include "r4300/op_cost.h"
 #include "r4300/ops.h"
 #include "r4300/r4300.h"
 #include "r4300/recomph.h"
@@ -80,6 +82,13 @@ static void gencheck_interupt_out(unsigned int addr)
    call_reg32(EAX);
 }
 
+/* Tell idle_loop_reset() how many cycles the inline skip at dst just added */
+static void genidle_skip_stats(int reg)
+{
+   mov_m32_reg32((unsigned int*)(&idle_loop_skipped_cycles), reg);
+   mov_m32_imm32((unsigned int*)(&idle_loop_skipped_addr), dst->addr);
+}
+
 static void genbeq_test(void)
 {
    int rs_64bit = is64((unsigned int *)dst->f.i.rs);
@@ -367,6 +376,14 @@ void gencallinterp(uintptr_t addr, int jump)
      }
 }
 
+void genop_cost(uint32_t op)
+{
+   unsigned int slots = op_cost_slots(op);
+
+   if (slots != 0)
+     add_m32_imm32((unsigned int*)(&g_cp0_regs[CP0_COUNT_REG]), slots * count_per_op);
+}
+
 void gendelayslot(void)
 {
    mov_m32_imm32(&delay_slot, 1);
@@ -472,11 +489,14 @@ void genj_idle(void)
    mov_eax_memoffs32((unsigned int *)(&next_interupt));
    sub_reg32_m32(EAX, (unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]));
    cmp_reg32_imm8(EAX, 3);
-   jbe_rj(11);
+   jbe_rj(0);
+   jump_start_rel8();
    
-   and_eax_imm32(0xFFFFFFFC);  // 5
-   add_m32_reg32((unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]), EAX); // 6
+   and_eax_imm32(0xFFFFFFFC);
+   add_m32_reg32((unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]), EAX);
+   genidle_skip_stats(EAX);
   
+   jump_end_rel8();
    genj();
 #endif
 }
@@ -559,11 +579,14 @@ void genjal_idle(void)
    mov_eax_memoffs32((unsigned int *)(&next_interupt));
    sub_reg32_m32(EAX, (unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]));
    cmp_reg32_imm8(EAX, 3);
-   jbe_rj(11);
+   jbe_rj(0);
+   jump_start_rel8();
    
    and_eax_imm32(0xFFFFFFFC);
    add_m32_reg32((unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]), EAX);
+   genidle_skip_stats(EAX);
   
+   jump_end_rel8();
    genjal();
 #endif
 }
@@ -658,15 +681,25 @@ void gentest_idle(void)
    mov_reg32_m32(reg, (unsigned int *)(&next_interupt));
    sub_reg32_m32(reg, (unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]));
    cmp_reg32_imm8(reg, 5);
-   jbe_rj(18);
+   jbe_rj(0);
+   jump_start_rel8();
    
-   sub_reg32_imm32(reg, 2); // 6
-   and_reg32_imm32(reg, 0xFFFFFFFC); // 6
-   add_m32_reg32((unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]), reg); // 6
+   sub_reg32_imm32(reg, 2);
+   and_reg32_imm32(reg, 0xFFFFFFFC);
+   add_m32_reg32((unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]), reg);
+   genidle_skip_stats(reg);
    
+   jump_end_rel8();
    jump_end_rel32();
 }
 
+/* Multi-instruction idle loops (see idle_loop.c) need their loads checked
+ * at run time, so they always go through the interpreter. */
+void genidle_loop(void)
+{
+   gencallinterp((unsigned int)dst->ops, 1);
+}
+
 void genbeq_idle(void)
 {
 #ifdef INTERPRET_BEQ_IDLE
@@ -353,6 +353,17 @@ static osal_inline void add_m32rel_xreg32(unsigned int *m32, int xreg32)
    put32(offset);
 }
 
+static osal_inline void add_m32rel_imm32(unsigned int *m32, unsigned int imm32)
+{
+   int offset = rel_r15_offset(m32, "add_m32rel_imm32");
+
+   put8(0x41);
+   put8(0x81);
+   put8(0x87);
+   put32(offset);
+   put32(imm32);
+}
+
 static osal_inline void sub_xreg32_m32rel(int xreg32, unsigned int *m32)
 {
    int offset = rel_r15_offset(m32, "sub_xreg32_m32rel");
@@ -526,6 +537,18 @@ static osal_inline void inc_m32rel(unsigned int *m32)
    put32(offset);
 }
 
+/* inc dword [m32 + reg64*4] */
+static osal_inline void inc_m32rel_preg64x4(unsigned int *m32, int reg64)
+{
+   int offset = rel_r15_offset(m32, "inc_m32rel_preg64x4");
+
+   put8(0x41 | ((reg64 & 8) >> 2));
+   put8(0xFF);
+   put8(0x84);
+   put8(0x87 | ((reg64 & 7) << 3));
+   put32(offset);
+}
+
 static osal_inline void cmp_m32rel_imm32(unsigned int *m32, unsigned int imm32)
 {
    int offset = rel_r15_offset(m32, "cmp_m32rel_imm32");
@@ -1024,6 +1047,22 @@ static osal_inline void movsx_reg32_16preg64preg64(int reg1, int reg2, int reg3)
    put8((reg2 << 3) | reg3);
 }
 
+static osal_inline void movzx_reg32_8preg64preg64(int reg1, int reg2, int reg3)
+{
+   put8(0x0F);
+   put8(0xB6);
+   put8((reg1 << 3) | 0x04);
+   put8((reg2 << 3) | reg3);
+}
+
+static osal_inline void movzx_reg32_16preg64preg64(int reg1, int reg2, int reg3)
+{
+   put8(0x0F);
+   put8(0xB7);
+   put8((reg1 << 3) | 0x04);
+   put8((reg2 << 3) | reg3);
+}
+
 static osal_inline void movsx_xreg32_m16rel(int xreg32, unsigned short *m16)
 {
    int offset = rel_r15_offset(m16, "movsx_xreg32_m16rel");
@@ -26,6 +26,7 @@
 #include "assemble.h"
 #include "interpret.h"
 #include "memory/memory.h"
+#include "r4300/cached_interp.h"
 #include "r4300/cp1_private.h"
 #include "r4300/macros.h"
 #include "r4300/ops.h"
@@ -136,29 +137,12 @@ void genctc1(void)
    gencallinterp((unsigned long long)cached_interpreter_table.CTC1, 0);
 #else
    gencheck_cop1_unusable();
-   
+
    if (dst->f.r.nrd != 31) return;
-   mov_xreg32_m32rel(EAX, (unsigned int*)dst->f.r.rt);
-   mov_m32rel_xreg32((unsigned int*)&FCR31, EAX);
-   and_eax_imm32(3);
-   
-   cmp_eax_imm32(0);
-   jne_rj(13);
-   mov_m32rel_imm32((unsigned int*)&rounding_mode, 0x33F); // 11
-   jmp_imm_short(51); // 2
-   
-   cmp_eax_imm32(1); // 5
-   jne_rj(13); // 2
-   mov_m32rel_imm32((unsigned int*)&rounding_mode, 0xF3F); // 11
-   jmp_imm_short(31); // 2
-   
-   cmp_eax_imm32(2); // 5
-   jne_rj(13); // 2
-   mov_m32rel_imm32((unsigned int*)&rounding_mode, 0xB3F); // 11
-   jmp_imm_short(11); // 2
-   
-   mov_m32rel_imm32((unsigned int*)&rounding_mode, 0x73F); // 11
-   
+
+   /* The interpreter updates rounding_mode and the rounding mode of the
+    * host FPU, which COP1 helpers called from C rely on. */
+   gencallinterp((unsigned long long)cached_interpreter_table.CTC1, 0);
    fldcw_m16rel((unsigned short*)&rounding_mode);
 #endif
 }
@@ -27,21 +27,28 @@
 #include "assemble.h"
 #include "interpret.h"
 #include "main/main.h"
+#include "memory/fastmem.h"
 #include "memory/memory.h"
 #include "r4300/cached_interp.h"
 #include "r4300/cp0_private.h"
 #include "r4300/cp1_private.h"
 #include "r4300/exception.h"
+#include "r4300/idle_loop.h"
 #include "r4300/interupt.h"
+#include "r4300/op_cost.h"
 #include "r4300/ops.h"
 #include "r4300/r4300.h"
 #include "r4300/recomp.h"
 #include "r4300/recomph.h"
+#include "r4300/tlb.h"
 #include "regcache.h"
 
 #if defined(COUNT_INSTR)
 #include "r4300/instr_counters.h"
 #endif
+#if defined(GUEST_PROFILE)
+#include "r4300/guest_profile.h"
+#endif
 
 #if !defined(offsetof)
 #   define offsetof(TYPE,MEMBER) ((unsigned int) &((TYPE*)0)->MEMBER)
@@ -104,6 +111,13 @@ static void gencheck_interupt_out(unsigned int addr)
    jump_end_rel8();
 }
 
+/* Tell idle_loop_reset() how many cycles the inline skip at dst just added */
+static void genidle_skip_stats(int reg)
+{
+   mov_m32rel_xreg32((unsigned int*)(&idle_loop_skipped_cycles), reg);
+   mov_m32rel_imm32((unsigned int*)(&idle_loop_skipped_addr), dst->addr);
+}
+
 static void genbeq_test(void)
 {
    int rs_64bit = is64((unsigned int *)dst->f.i.rs);
@@ -258,6 +272,163 @@ static void ld_register_alloc(int *pGpr1, int *pGpr2, int *pBase1, int *pBase2)
    *pBase2 = base2;
 }
 
+/* Ends an access to fastmem_base started at code offset access_start, and
+ * starts the slow path the fault handler sends it to (see memory/fastmem.h).
+ * The slow path must end with jump_end_rel8(). */
+static void genfastmem_access_end(unsigned int access_start)
+{
+   while (code_length < access_start + FASTMEM_ACCESS_SIZE)
+     put8(0x90); // nop
+   jmp_imm_short(0);
+   jump_start_rel8();
+}
+
+/* Loads the bits wide value at the address in gpr1 and gpr2 to gpr1 */
+static void genld_fastmem(int gpr1, int gpr2, int base1, void (**read_table)(void), int bits, int sign)
+{
+   unsigned int access_start;
+
+   mov_reg64_imm64(base1, (unsigned long long) fastmem_base);
+   if (bits == 8)
+     xor_reg8_imm8(gpr1, 3);
+   else if (bits == 16)
+     xor_reg8_imm8(gpr1, 2);
+
+   access_start = code_length;
+   if (bits == 8 && sign)
+     movsx_reg32_8preg64preg64(gpr1, gpr1, base1);
+   else if (bits == 8)
+     movzx_reg32_8preg64preg64(gpr1, gpr1, base1);
+   else if (bits == 16 && sign)
+     movsx_reg32_16preg64preg64(gpr1, gpr1, base1);
+   else if (bits == 16)
+     movzx_reg32_16preg64preg64(gpr1, gpr1, base1);
+   else
+     mov_reg32_preg64preg64(gpr1, gpr1, base1);
+   genfastmem_access_end(access_start);
+
+   mov_reg64_imm64(base1, (unsigned long long) read_table);
+   mov_reg64_imm64(gpr1, (unsigned long long) (dst+1));
+   mov_m64rel_xreg64((unsigned long long *)(&PC), gpr1);
+   mov_m32rel_xreg32((unsigned int *)(&address), gpr2);
+   mov_reg64_imm64(gpr1, (unsigned long long) dst->f.i.rt);
+   mov_m64rel_xreg64((unsigned long long *)(&rdword), gpr1);
+   shr_reg32_imm8(gpr2, 16);
+   mov_reg64_preg64x8preg64(gpr2, gpr2, base1);
+   call_reg64(gpr2);
+   if (bits == 8 && sign)
+     movsx_xreg32_m8rel(gpr1, (unsigned char *)dst->f.i.rt);
+   else if (bits == 16 && sign)
+     movsx_xreg32_m16rel(gpr1, (unsigned short *)dst->f.i.rt);
+   else
+     mov_xreg32_m32rel(gpr1, (unsigned int *)dst->f.i.rt);
+
+   jump_end_rel8();
+}
+
+/* Marks the code at the address in EAX as invalid after a store */
+static void gencheck_invalid_code(void)
+{
+   mov_reg64_imm64(RSI, (unsigned long long) invalid_code);
+   mov_reg32_reg32(EBX, EAX);
+   shr_reg32_imm8(EBX, 12);
+   cmp_preg64preg64_imm8(RBX, RSI, 0);
+   jne_rj(65);
+
+   mov_reg64_imm64(RDI, (unsigned long long) blocks); // 10
+   mov_reg32_reg32(ECX, EBX); // 2
+   mov_reg64_preg64x8preg64(RBX, RBX, RDI);  // 4
+   mov_reg64_preg64pimm32(RBX, RBX, (int) offsetof(precomp_block, block)); // 7
+   mov_reg64_imm64(RDI, (unsigned long long) cached_interpreter_table.NOTCOMPILED); // 10
+   and_eax_imm32(0xFFF); // 5
+   shr_reg32_imm8(EAX, 2); // 3
+   mov_reg32_imm32(EDX, sizeof(precomp_instr)); // 5
+   mul_reg32(EDX); // 2
+   mov_reg64_preg64preg64pimm32(RAX, RAX, RBX, (int) offsetof(precomp_instr, ops)); // 8
+   cmp_reg64_reg64(RAX, RDI); // 3
+   je_rj(4); // 2
+   mov_preg64preg64_imm8(RCX, RSI, 1); // 4
+}
+
+/* Marks the code at the physical address of a TLB mapped store as invalid */
+static void fastmem_check_tlb_store(void)
+{
+   unsigned int paddr = virtual_to_physical_address(address, 1);
+
+   if (paddr)
+     invalidate_cached_code_hacktarux(paddr, 4);
+}
+
+/* Stores the bits wide value in CL, CX or ECX at the address in EAX and EBX */
+static void genst_fastmem(void (**write_table)(void), int bits)
+{
+   unsigned int access_start;
+   unsigned int slow_path_end;
+   unsigned int check_end;
+
+   mov_reg64_imm64(RSI, (unsigned long long) fastmem_base);
+   if (bits == 8)
+     xor_reg8_imm8(BL, 3);
+   else if (bits == 16)
+     xor_reg8_imm8(BL, 2);
+
+   access_start = code_length;
+   if (bits == 8)
+     mov_preg64preg64_reg8(RBX, RSI, CL);
+   else if (bits == 16)
+     mov_preg64preg64_reg16(RBX, RSI, CX);
+   else
+     mov_preg64preg64_reg32(RBX, RSI, ECX);
+   genfastmem_access_end(access_start);
+
+   mov_reg64_imm64(RSI, (unsigned long long) write_table);
+   mov_reg32_reg32(EBX, EAX);
+   mov_reg64_imm64(RAX, (unsigned long long) (dst+1));
+   mov_m64rel_xreg64((unsigned long long *)(&PC), RAX);
+   mov_m32rel_xreg32((unsigned int *)(&address), EBX);
+   if (bits == 8)
+     mov_m8rel_xreg8((unsigned char *)(&cpu_byte), CL);
+   else if (bits == 16)
+     mov_m16rel_xreg16((unsigned short *)(&cpu_hword), CX);
+   else
+     mov_m32rel_xreg32((unsigned int *)(&cpu_word), ECX);
+   shr_reg32_imm8(EBX, 16);
+   mov_reg64_preg64x8preg64(RBX, RBX, RSI);
+   call_reg64(RBX);
+   mov_xreg32_m32rel(EAX, (unsigned int *)(&address));
+   jmp_imm_short(0);
+   slow_path_end = code_length;
+
+   jump_end_rel8();
+
+   /* the slow path goes through write_nomem(), which checks the physical
+    * address of a TLB mapped store too, the fast path does it here */
+   mov_m32rel_xreg32((unsigned int *)(&address), EAX);
+   sub_eax_imm32(0x80000000);
+   cmp_eax_imm32(0x3FFFFFFF);
+   jbe_rj(12);
+   mov_reg64_imm64(RAX, (unsigned long long) fastmem_check_tlb_store); // 10
+   call_reg64(RAX); // 2
+   mov_xreg32_m32rel(EAX, (unsigned int *)(&address));
+
+   /* the jmp ending the slow path lands here */
+   check_end = code_length;
+   code_length = slow_path_end - 1;
+   put8(check_end - slow_path_end);
+   code_length = check_end;
+
+   gencheck_invalid_code();
+}
+
+#if defined(GUEST_PROFILE)
+/* counts an entry of the block at addr, on the taken path of a jump or
+ * branch, as the interpreters do (see guest_profile.h) */
+static void genprofile_block(unsigned int addr)
+{
+   unsigned int *counter = guest_profile_counter(addr);
+   if (counter != NULL) inc_m32rel(counter);
+}
+#endif
 
 /* global functions */
 
@@ -333,6 +504,14 @@ void gencallinterp(uintptr_t addr, int jump)
    }
 }
 
+void genop_cost(uint32_t op)
+{
+   unsigned int slots = op_cost_slots(op);
+
+   if (slots != 0)
+     add_m32rel_imm32((unsigned int*)(&g_cp0_regs[CP0_COUNT_REG]), slots * count_per_op);
+}
+
 void gendelayslot(void)
 {
    mov_m32rel_imm32((void*)(&delay_slot), 1);
@@ -407,6 +586,9 @@ void genj(void)
    
    mov_m32rel_imm32((void*)(&last_addr), naddr);
    gencheck_interupt((unsigned long long) &actual->block[(naddr-actual->start)/4]);
+#if defined(GUEST_PROFILE)
+   genprofile_block(naddr);
+#endif
    jmp(naddr);
 #endif
 }
@@ -459,11 +641,14 @@ void genj_idle(void)
    mov_xreg32_m32rel(EAX, (unsigned int *)(&next_interupt));
    sub_xreg32_m32rel(EAX, (unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]));
    cmp_reg32_imm8(EAX, 3);
-   jbe_rj(12);
+   jbe_rj(0);
+   jump_start_rel8();
 
-   and_eax_imm32(0xFFFFFFFC);  // 5
-   add_m32rel_xreg32((unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]), EAX); // 7
+   and_eax_imm32(0xFFFFFFFC);
+   add_m32rel_xreg32((unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]), EAX);
+   genidle_skip_stats(EAX);
 
+   jump_end_rel8();
    genj();
 #endif
 }
@@ -497,6 +682,9 @@ void genjal(void)
 
    mov_m32rel_imm32((void*)(&last_addr), naddr);
    gencheck_interupt((unsigned long long) &actual->block[(naddr-actual->start)/4]);
+#if defined(GUEST_PROFILE)
+   genprofile_block(naddr);
+#endif
    jmp(naddr);
 #endif
 }
@@ -556,11 +744,14 @@ void genjal_idle(void)
    mov_xreg32_m32rel(EAX, (unsigned int *)(&next_interupt));
    sub_xreg32_m32rel(EAX, (unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]));
    cmp_reg32_imm8(EAX, 3);
-   jbe_rj(12);
-   
-   and_eax_imm32(0xFFFFFFFC);  // 5
-   add_m32rel_xreg32((unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]), EAX); // 7
-  
+   jbe_rj(0);
+   jump_start_rel8();
+
+   and_eax_imm32(0xFFFFFFFC);
+   add_m32rel_xreg32((unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]), EAX);
+   genidle_skip_stats(EAX);
+
+   jump_end_rel8();
    genjal();
 #endif
 }
@@ -573,6 +764,9 @@ void gentest(void)
 
    mov_m32rel_imm32((void*)(&last_addr), dst->addr + (dst-1)->f.i.immediate*4);
    gencheck_interupt((unsigned long long) (dst + (dst-1)->f.i.immediate));
+#if defined(GUEST_PROFILE)
+   genprofile_block(dst->addr + (dst-1)->f.i.immediate*4);
+#endif
    jmp(dst->addr + (dst-1)->f.i.immediate*4);
 
    jump_end_rel32();
@@ -663,11 +857,19 @@ void gentest_idle(void)
    
    and_reg32_imm32(reg, 0xFFFFFFFC);
    add_m32rel_xreg32((unsigned int *)(&g_cp0_regs[CP0_COUNT_REG]), reg);
+   genidle_skip_stats(reg);
    
    jump_end_rel8();
    jump_end_rel32();
 }
 
+/* Multi-instruction idle loops (see idle_loop.c) need their loads checked
+ * at run time, so they always go through the interpreter. */
+void genidle_loop(void)
+{
+   gencallinterp((unsigned long long)dst->ops, 1);
+}
+
 void genbeq_idle(void)
 {
 #ifdef INTERPRET_BEQ_IDLE
@@ -1005,6 +1207,9 @@ void gentestl(void)
    gendelayslot();
    mov_m32rel_imm32((void*)(&last_addr), dst->addr + (dst-1)->f.i.immediate*4);
    gencheck_interupt((unsigned long long) (dst + (dst-1)->f.i.immediate));
+#if defined(GUEST_PROFILE)
+   genprofile_block(dst->addr + (dst-1)->f.i.immediate*4);
+#endif
    jmp(dst->addr + (dst-1)->f.i.immediate*4);
    
    jump_end_rel32();
@@ -1337,6 +1542,13 @@ void genlb(void)
 
    ld_register_alloc(&gpr1, &gpr2, &base1, &base2);
 
+   if (fast_memory && fastmem_base != NULL)
+   {
+      genld_fastmem(gpr1, gpr2, base1, readmemb, 8, 1);
+      set_register_state(gpr1, (unsigned int*)dst->f.i.rt, 1, 0);
+      return;
+   }
+
    mov_reg64_imm64(base1, (unsigned long long) readmemb);
    if(fast_memory)
      {
@@ -1387,6 +1599,13 @@ void genlh(void)
 
    ld_register_alloc(&gpr1, &gpr2, &base1, &base2);
 
+   if (fast_memory && fastmem_base != NULL)
+   {
+      genld_fastmem(gpr1, gpr2, base1, readmemh, 16, 1);
+      set_register_state(gpr1, (unsigned int*)dst->f.i.rt, 1, 0);
+      return;
+   }
+
    mov_reg64_imm64(base1, (unsigned long long) readmemh);
    if(fast_memory)
      {
@@ -1445,6 +1664,13 @@ void genlw(void)
 
    ld_register_alloc(&gpr1, &gpr2, &base1, &base2);
 
+   if (fast_memory && fastmem_base != NULL)
+   {
+      genld_fastmem(gpr1, gpr2, base1, readmem, 32, 0);
+      set_register_state(gpr1, (unsigned int*)dst->f.i.rt, 1, 0);
+      return;
+   }
+
    mov_reg64_imm64(base1, (unsigned long long) readmem);
    if(fast_memory)
      {
@@ -1495,6 +1721,13 @@ void genlbu(void)
 
    ld_register_alloc(&gpr1, &gpr2, &base1, &base2);
 
+   if (fast_memory && fastmem_base != NULL)
+   {
+      genld_fastmem(gpr1, gpr2, base1, readmemb, 8, 0);
+      set_register_state(gpr1, (unsigned int*)dst->f.i.rt, 1, 0);
+      return;
+   }
+
    mov_reg64_imm64(base1, (unsigned long long) readmemb);
    if(fast_memory)
      {
@@ -1546,6 +1779,13 @@ void genlhu(void)
 
    ld_register_alloc(&gpr1, &gpr2, &base1, &base2);
 
+   if (fast_memory && fastmem_base != NULL)
+   {
+      genld_fastmem(gpr1, gpr2, base1, readmemh, 16, 0);
+      set_register_state(gpr1, (unsigned int*)dst->f.i.rt, 1, 0);
+      return;
+   }
+
    mov_reg64_imm64(base1, (unsigned long long) readmemh);
    if(fast_memory)
      {
@@ -1605,6 +1845,13 @@ void genlwu(void)
 
    ld_register_alloc(&gpr1, &gpr2, &base1, &base2);
 
+   if (fast_memory && fastmem_base != NULL)
+   {
+      genld_fastmem(gpr1, gpr2, base1, readmem, 32, 0);
+      set_register_state(gpr1, (unsigned int*)dst->f.i.rt, 1, 1);
+      return;
+   }
+
    mov_reg64_imm64(base1, (unsigned long long) readmem);
    if(fast_memory)
      {
@@ -1655,6 +1902,11 @@ void gensb(void)
    mov_xreg32_m32rel(EAX, (unsigned int *)dst->f.i.rs);
    add_eax_imm32((int)dst->f.i.immediate);
    mov_reg32_reg32(EBX, EAX);
+   if (fast_memory && fastmem_base != NULL)
+   {
+      genst_fastmem(writememb, 8);
+      return;
+   }
    mov_reg64_imm64(RSI, (unsigned long long) writememb);
    if(fast_memory)
      {
@@ -1722,6 +1974,11 @@ void gensh(void)
    mov_xreg32_m32rel(EAX, (unsigned int *)dst->f.i.rs);
    add_eax_imm32((int)dst->f.i.immediate);
    mov_reg32_reg32(EBX, EAX);
+   if (fast_memory && fastmem_base != NULL)
+   {
+      genst_fastmem(writememh, 16);
+      return;
+   }
    mov_reg64_imm64(RSI, (unsigned long long) writememh);
    if(fast_memory)
      {
@@ -1797,6 +2054,11 @@ void gensw(void)
    mov_xreg32_m32rel(EAX, (unsigned int *)dst->f.i.rs);
    add_eax_imm32((int)dst->f.i.immediate);
    mov_reg32_reg32(EBX, EAX);
+   if (fast_memory && fastmem_base != NULL)
+   {
+      genst_fastmem(writemem, 32);
+      return;
+   }
    mov_reg64_imm64(RSI, (unsigned long long) writemem);
    if(fast_memory)
      {
@@ -37,6 +37,9 @@
 #if defined(COUNT_INSTR)
 #include "r4300/instr_counters.h"
 #endif
+#if defined(GUEST_PROFILE)
+#include "r4300/guest_profile.h"
+#endif
 
 #if !defined(offsetof)
 #   define offsetof(TYPE,MEMBER) ((unsigned int) &((TYPE*)0)->MEMBER)
@@ -232,6 +235,13 @@ void genjr(void)
    mov_reg32_reg32(EAX, EBX);
    sub_eax_imm32(dst_block->start);
    shr_reg32_imm8(EAX, 2);
+#if defined(GUEST_PROFILE)
+   {
+      /* EAX is the index of the target in the page */
+      unsigned int *counters = guest_profile_counter(dst_block->start);
+      if (counters != NULL) inc_m32rel_preg64x4(counters, RAX);
+   }
+#endif
    mul_m32rel((unsigned int *)(&precomp_instr_size));
    
    mov_reg32_preg64preg64pimm32(EBX, RAX, RSI, diff_need);
@@ -307,6 +317,13 @@ void genjalr(void)
    mov_reg32_reg32(EAX, EBX);
    sub_eax_imm32(dst_block->start);
    shr_reg32_imm8(EAX, 2);
+#if defined(GUEST_PROFILE)
+   {
+      /* EAX is the index of the target in the page */
+      unsigned int *counters = guest_profile_counter(dst_block->start);
+      if (counters != NULL) inc_m32rel_preg64x4(counters, RAX);
+   }
+#endif
    mul_m32rel((unsigned int *)(&precomp_instr_size));
 
    mov_reg32_preg64preg64pimm32(EBX, RAX, RSI, diff_need);
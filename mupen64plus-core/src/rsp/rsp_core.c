@@ -25,6 +25,7 @@
 
 #include "main/main.h"
 #include "main/profile.h"
+#include "main/trace.h"
 #include "memory/memory.h"
 #include "plugin/plugin.h"
 #include "r4300/r4300_core.h"
@@ -163,6 +164,8 @@ void init_rsp(struct rsp_core* sp,
 
 void poweron_rsp(struct rsp_core* sp)
 {
+    rsp_wait_task(sp);
+
     memset(sp->mem, 0, SP_MEM_SIZE);
     memset(sp->regs, 0, SP_REGS_COUNT*sizeof(uint32_t));
     memset(sp->regs2, 0, SP_REGS2_COUNT*sizeof(uint32_t));
@@ -176,6 +179,8 @@ int read_rsp_mem(void* opaque, uint32_t address, uint32_t* value)
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t addr = rsp_mem_address(address);
 
+    rsp_wait_task(sp);
+
     *value = sp->mem[addr];
 
     return 0;
@@ -186,6 +191,8 @@ int write_rsp_mem(void* opaque, uint32_t address, uint32_t value, uint32_t mask)
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t addr = rsp_mem_address(address);
 
+    rsp_wait_task(sp);
+
     masked_write(&sp->mem[addr], value, mask);
 
     return 0;
@@ -197,6 +204,8 @@ int read_rsp_regs(void* opaque, uint32_t address, uint32_t* value)
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t reg = rsp_reg(address);
 
+    rsp_wait_task(sp);
+
     *value = sp->regs[reg];
 
     if (reg == SP_SEMAPHORE_REG)
@@ -212,6 +221,8 @@ int write_rsp_regs(void* opaque, uint32_t address, uint32_t value, uint32_t mask
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t reg = rsp_reg(address);
 
+    rsp_wait_task(sp);
+
     switch(reg)
     {
     case SP_STATUS_REG:
@@ -226,10 +237,14 @@ int write_rsp_regs(void* opaque, uint32_t address, uint32_t value, uint32_t mask
     switch(reg)
     {
     case SP_RD_LEN_REG:
+        TRACE_BEGIN("sp_dma_write");
         dma_sp_write(sp);
+        TRACE_END();
         break;
     case SP_WR_LEN_REG:
+        TRACE_BEGIN("sp_dma_read");
         dma_sp_read(sp);
+        TRACE_END();
         break;
     case SP_SEMAPHORE_REG:
         sp->regs[SP_SEMAPHORE_REG] = 0;
@@ -245,6 +260,8 @@ int read_rsp_regs2(void* opaque, uint32_t address, uint32_t* value)
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t reg = rsp_reg2(address);
 
+    rsp_wait_task(sp);
+
     *value = sp->regs2[reg];
 
     return 0;
@@ -255,6 +272,8 @@ int write_rsp_regs2(void* opaque, uint32_t address, uint32_t value, uint32_t mas
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t reg = rsp_reg2(address);
 
+    rsp_wait_task(sp);
+
     masked_write(&sp->regs2[reg], value, mask);
 
     return 0;
@@ -262,7 +281,11 @@ int write_rsp_regs2(void* opaque, uint32_t address, uint32_t value, uint32_t mas
 
 void do_SP_Task(struct rsp_core* sp)
 {
-    uint32_t save_pc = sp->regs2[SP_PC_REG] & ~0xfff;
+    uint32_t save_pc;
+
+    rsp_wait_task(sp);
+
+    save_pc = sp->regs2[SP_PC_REG] & ~0xfff;
 
     if (sp->mem[0xfc0/4] == 1)
     {
@@ -278,7 +301,9 @@ void do_SP_Task(struct rsp_core* sp)
         //gfx.processDList();
         sp->regs2[SP_PC_REG] &= 0xfff;
         timed_section_start(TIMED_SECTION_GFX);
+        TRACE_BEGIN("rsp_gfx_task");
         rsp.doRspCycles(0xffffffff);
+        TRACE_END();
         timed_section_end(TIMED_SECTION_GFX);
         sp->regs2[SP_PC_REG] |= save_pc;
         new_frame();
@@ -297,8 +322,26 @@ void do_SP_Task(struct rsp_core* sp)
     {
         //audio.processAList();
         sp->regs2[SP_PC_REG] &= 0xfff;
+
+        if (rsp.startRspCycles != NULL)
+        {
+            /* Let the task run alongside the CPU. It is waited for when
+             * the SP interrupt is due, or as soon as the CPU accesses the RSP
+             * (see rsp_wait_task). The interrupt is expected, as audio tasks
+             * end with a BREAK; it is withdrawn if the task did not raise it. */
+            sp->async_task = 1;
+            sp->async_save_pc = save_pc;
+            rsp.startRspCycles(0xffffffff);
+
+            cp0_update_count();
+            add_interupt_event(SP_INT, 4000/*500*/);
+            return;
+        }
+
         timed_section_start(TIMED_SECTION_AUDIO);
+        TRACE_BEGIN("rsp_audio_task");
         rsp.doRspCycles(0xffffffff);
+        TRACE_END();
         timed_section_end(TIMED_SECTION_AUDIO);
         sp->regs2[SP_PC_REG] |= save_pc;
 
@@ -311,7 +354,9 @@ void do_SP_Task(struct rsp_core* sp)
     else
     {
         sp->regs2[SP_PC_REG] &= 0xfff;
+        TRACE_BEGIN_ARG("rsp_task", sp->mem[0xfc0/4]);
         rsp.doRspCycles(0xffffffff);
+        TRACE_END();
         sp->regs2[SP_PC_REG] |= save_pc;
 
         cp0_update_count();
@@ -322,8 +367,35 @@ void do_SP_Task(struct rsp_core* sp)
     }
 }
 
+int rsp_wait_task(struct rsp_core* sp)
+{
+    int intr;
+
+    if (!sp->async_task)
+        return 0;
+
+    sp->async_task = 0;
+    timed_section_start(TIMED_SECTION_AUDIO);
+    TRACE_BEGIN("rsp_audio_task_wait");
+    /* the interrupts the task raised, apart from those already pending */
+    intr = (rsp.waitRspCycles() & MI_INTR_SP) != 0;
+    TRACE_END();
+    timed_section_end(TIMED_SECTION_AUDIO);
+    sp->regs2[SP_PC_REG] |= sp->async_save_pc;
+
+    if (!intr)
+        remove_pending_event(SP_INT);
+    sp->regs[SP_STATUS_REG] &= ~(SP_STATUS_TASKDONE | SP_STATUS_YIELDED);
+
+    return intr;
+}
+
 void rsp_interrupt_event(struct rsp_core* sp)
 {
+    /* a background task which did not ask for the interrupt */
+    if (sp->async_task && !rsp_wait_task(sp))
+        return;
+
     /* XXX: assume task has fully completed */
     sp->regs[SP_STATUS_REG] |=
         SP_STATUS_TASKDONE | SP_STATUS_BROKE | SP_STATUS_HALT;
@@ -80,6 +80,10 @@ struct rsp_core
     uint32_t regs[SP_REGS_COUNT];
     uint32_t regs2[SP_REGS2_COUNT];
 
+    /* set while an audio task runs on the RSP plugin's own thread */
+    int async_task;
+    uint32_t async_save_pc;
+
     struct r4300_core* r4300;
     struct rdp_core* dp;
     struct ri_controller* ri;
@@ -118,6 +122,11 @@ int write_rsp_regs2(void* opaque, uint32_t address, uint32_t value, uint32_t mas
 
 void do_SP_Task(struct rsp_core* sp);
 
+/* Waits for the task started in the background by do_SP_Task, if any.
+ * Must be called before accessing the RSP memory or registers.
+ * Returns 1 if the task raised the SP interrupt. */
+int rsp_wait_task(struct rsp_core* sp);
+
 void rsp_interrupt_event(struct rsp_core* sp);
 
 #endif
@@ -26,6 +26,7 @@
 #include "api/callbacks.h"
 #include "api/m64p_types.h"
 #include "main/main.h"
+#include "main/trace.h"
 #include "memory/memory.h"
 #include "r4300/r4300_core.h"
 #include "ri/ri_controller.h"
@@ -73,6 +74,7 @@ static void dma_si_read(struct si_controller* si)
         return;
     }
 
+    main_input_read();
     update_pif_read(si);
 
     for (i = 0; i < PIF_RAM_SIZE; i += 4)
@@ -148,12 +150,16 @@ int write_si_regs(void* opaque, uint32_t address, uint32_t value, uint32_t mask)
 
     case SI_PIF_ADDR_RD64B_REG:
         masked_write(&si->regs[SI_PIF_ADDR_RD64B_REG], value, mask);
+        TRACE_BEGIN("si_dma_read");
         dma_si_read(si);
+        TRACE_END();
         break;
 
     case SI_PIF_ADDR_WR64B_REG:
         masked_write(&si->regs[SI_PIF_ADDR_WR64B_REG], value, mask);
+        TRACE_BEGIN("si_dma_write");
         dma_si_write(si);
+        TRACE_END();
         break;
 
     case SI_STATUS_REG:
@@ -0,0 +1,65 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - context.c                                               *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <string.h>
+
+#include "context.h"
+
+RSP_CONTEXT rsp_main_context;
+THREAD_LOCAL RSP_CONTEXT* rsp_current = &rsp_main_context;
+
+int rsp_context_init(RSP_CONTEXT* context, const RSP_INFO* info)
+{
+    memset(context, 0, sizeof(RSP_CONTEXT));
+
+    context -> info = *info;
+    context -> DRAM = info -> RDRAM;
+    if (info -> DMEM == info -> IMEM) /* usually dummy RSP data for testing */
+        return 0; /* DMA is not executed just because plugin initiates. */
+    context -> DMEM = info -> DMEM;
+    context -> IMEM = info -> IMEM;
+
+    context -> CR[0x0] = info -> SP_MEM_ADDR_REG;
+    context -> CR[0x1] = info -> SP_DRAM_ADDR_REG;
+    context -> CR[0x2] = info -> SP_RD_LEN_REG;
+    context -> CR[0x3] = info -> SP_WR_LEN_REG;
+    context -> CR[0x4] = info -> SP_STATUS_REG;
+    context -> CR[0x5] = info -> SP_DMA_FULL_REG;
+    context -> CR[0x6] = info -> SP_DMA_BUSY_REG;
+    context -> CR[0x7] = info -> SP_SEMAPHORE_REG;
+    context -> CR[0x8] = info -> DPC_START_REG;
+    context -> CR[0x9] = info -> DPC_END_REG;
+    context -> CR[0xA] = info -> DPC_CURRENT_REG;
+    context -> CR[0xB] = info -> DPC_STATUS_REG;
+    context -> CR[0xC] = info -> DPC_CLOCK_REG;
+    context -> CR[0xD] = info -> DPC_BUFBUSY_REG;
+    context -> CR[0xE] = info -> DPC_PIPEBUSY_REG;
+    context -> CR[0xF] = info -> DPC_TMEM_REG;
+
+    context -> MF_SP_STATUS_TIMEOUT = 32767;
+    return 1;
+}
+
+void rsp_context_make_current(RSP_CONTEXT* context)
+{
+    rsp_current = context;
+    return;
+}
@@ -0,0 +1,123 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - context.h                                               *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef _CONTEXT_H_
+#define _CONTEXT_H_
+
+#include "my_types.h"
+#include "rsp.h"
+#include "vu/vu.h"
+
+#define NUMBER_OF_CP0_REGISTERS         16
+
+/*
+ * one IMEM word as pre-decoded by `run_task_predecoded'
+ * `inst' is the word the slot was decoded from:  Whenever IMEM holds anything
+ * else at that address (DMA or the CPU overwrote it), the slot is decoded
+ * again, so nothing has to tell the cache about writes to IMEM.
+ * An all-zero slot is a decoded NOP, the decoding of an all-zero word.
+ */
+typedef struct {
+    u32 inst;
+    u8 op; /* handler number, or 0 for instructions with no effect */
+    u8 rd; /* rd, or vd for vector computes */
+    u8 rs; /* rs/base, or vs for vector computes */
+    u8 rt; /* rt, or vt for vector computes */
+    u8 sa; /* shift amount, or element for vector computes */
+    u8 func;
+    u16 imm;
+} RSP_DECODED;
+
+/*
+ * All of the architectural state of one RSP, plus the interpreter's scratch
+ * space.  Each thread runs tasks on the context made current on that thread,
+ * so several contexts may execute at once as long as they were initiated
+ * with different DMEM/IMEM and register blocks.
+ */
+typedef struct {
+    RSP_INFO info;
+
+    pu8 DRAM;
+    pu8 DMEM;
+    pu8 IMEM;
+    pu32 CR[NUMBER_OF_CP0_REGISTERS];
+
+    u32 SR[32];
+    u32 inst_word;
+    int temp_PC;
+    int stage;
+    short MFC0_count[32];
+    int MF_SP_STATUS_TIMEOUT;
+
+    ALIGNED i16 VR[32][N << VR_STATIC_WRAPAROUND];
+    ALIGNED i16 VACC[3][N];
+    ALIGNED i16 V_result[N];
+
+    /*
+     * These normally should have type `int` because they are Boolean arrays.
+     * However, since SSE2 uses 128-bit XMM's, and Win32 `int` is 32-bit,
+     * we have the problem of 32*8 > 128 bits, so we use `short` instead.
+     */
+    ALIGNED i16 cf_ne[N]; /* $vco:  high "NOTEQUAL" */
+    ALIGNED i16 cf_co[N]; /* $vco:  low "carry/borrow in/out" */
+    ALIGNED i16 cf_clip[N]; /* $vcc:  high (clip tests:  VCL, VCH, VCR) */
+    ALIGNED i16 cf_comp[N]; /* $vcc:  low (VEQ, VNE, VLT, VGE, VCL, VCH, VCR) */
+    ALIGNED i16 cf_vce[N]; /* $vce:  vector compare extension register */
+
+    ALIGNED i16 shuffle_temporary[N];
+
+    s32 DivIn; /* buffered numerator of division read from vector file */
+    s32 DivOut; /* global division result set by VRCP/VRCPL/VRSQ/VRSQL */
+    int DPH; /* Double-precision high was the last vector divide op? */
+
+    RSP_DECODED IMEM_decoded[0x1000 / 4];
+} RSP_CONTEXT;
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL    __declspec(thread)
+#elif defined(__GNUC__)
+#define THREAD_LOCAL    __thread __attribute__((tls_model("initial-exec")))
+#else
+#define THREAD_LOCAL
+#endif
+
+/*
+ * the context used by the thread the plugin was initiated from
+ * Every thread starts out with this one as its current context.
+ */
+extern RSP_CONTEXT rsp_main_context;
+extern THREAD_LOCAL RSP_CONTEXT* rsp_current;
+
+/*
+ * Wipes the context and attaches it to the memory and registers of `info'.
+ * Returns zero if DMEM and IMEM are the same dummy buffer, in which case
+ * only the RDRAM pointer was set up.
+ */
+extern int rsp_context_init(RSP_CONTEXT* context, const RSP_INFO* info);
+extern void rsp_context_make_current(RSP_CONTEXT* context);
+
+/*
+ * rsp.h's GET_RSP_INFO() and GET_RCP_REG() read the RSP_INFO of the
+ * current context.
+ */
+#undef RSP_INFO_NAME
+#define RSP_INFO_NAME           (rsp_current -> info)
+
+#endif
@@ -8,6 +8,7 @@ obj="$src/obj"
 
 OBJ_LIST="\
     $obj/module.o \
+    $obj/context.o \
     $obj/su.o \
     $obj/vu/vu.o \
     $obj/vu/multiply.o \
@@ -59,6 +60,7 @@ C_FLAGS=$FLAGS_x86 # default since Intel SIMD was the most tested
 
 echo Compiling C source code...
 cc -S $C_FLAGS -o $obj/module.s  $src/module.c
+cc -S $C_FLAGS -o $obj/context.s $src/context.c
 cc -S $C_FLAGS -o $obj/su.s      $src/su.c
 cc -S $C_FLAGS -o $obj/vu/vu.s       $src/vu/vu.c
 cc -S $C_FLAGS -o $obj/vu/multiply.s $src/vu/multiply.c
@@ -69,6 +71,7 @@ cc -S $C_FLAGS -o $obj/vu/divide.s   $src/vu/divide.c
 
 echo Assembling compiled sources...
 as --statistics -o $obj/module.o $obj/module.s
+as --statistics -o $obj/context.o $obj/context.s
 as --statistics -o $obj/su.o     $obj/su.s
 as --statistics -o $obj/vu/vu.o  $obj/vu/vu.s
 as -o $obj/vu/multiply.o $obj/vu/multiply.s
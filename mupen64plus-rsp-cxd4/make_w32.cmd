@@ -8,6 +8,7 @@ set obj=%rsp%\obj
 
 set OBJ_LIST=^
 %obj%\module.o ^
+%obj%\context.o ^
 %obj%\su.o ^
 %obj%\vu\vu.o ^
 %obj%\vu\multiply.o ^
@@ -41,6 +42,7 @@ cd %MinGW%\bin
 
 ECHO Compiling C source code...
 cc -S %C_FLAGS% -o %obj%\module.asm      %rsp%\module.c
+cc -S %C_FLAGS% -o %obj%\context.asm     %rsp%\context.c
 cc -S %C_FLAGS% -o %obj%\su.asm          %rsp%\su.c
 cc -S %C_FLAGS% -o %obj%\vu\vu.asm       %rsp%\vu\vu.c
 cc -S %C_FLAGS% -o %obj%\vu\multiply.asm %rsp%\vu\multiply.c
@@ -52,6 +54,7 @@ ECHO.
 
 ECHO Assembling compiled sources...
 as --statistics -o %obj%\module.o %obj%\module.asm
+as --statistics -o %obj%\context.o %obj%\context.asm
 as --statistics -o %obj%\su.o     %obj%\su.asm
 as --statistics -o %obj%\vu\vu.o  %obj%\vu\vu.asm
 as -o %obj%\vu\multiply.o %obj%\vu\multiply.asm
@@ -9,6 +9,7 @@ set obj=%rsp%\obj
 
 set OBJ_LIST=^
 %obj%\module.o ^
+%obj%\context.o ^
 %obj%\su.o ^
 %obj%\vu\vu.o ^
 %obj%\vu\multiply.o ^
@@ -41,6 +42,7 @@ cd %MinGW%\bin
 
 ECHO Compiling C source code...
 %MinGW%\bin\gcc.exe -S -Os %C_FLAGS% -o %obj%\module.asm      %rsp%\module.c
+%MinGW%\bin\gcc.exe -S -O3 %C_FLAGS% -o %obj%\context.asm     %rsp%\context.c
 %MinGW%\bin\gcc.exe -S -O3 %C_FLAGS% -o %obj%\su.asm          %rsp%\su.c
 %MinGW%\bin\gcc.exe -S -O3 %C_FLAGS% -o %obj%\vu\vu.asm       %rsp%\vu\vu.c
 %MinGW%\bin\gcc.exe -S -O3 %C_FLAGS% -o %obj%\vu\multiply.asm %rsp%\vu\multiply.c
@@ -52,6 +54,7 @@ ECHO.
 
 ECHO Assembling compiled sources...
 %MinGW%\bin\as.exe -o %obj%\module.o      %obj%\module.asm
+%MinGW%\bin\as.exe -o %obj%\context.o     %obj%\context.asm
 %MinGW%\bin\as.exe -o %obj%\su.o          %obj%\su.asm
 %MinGW%\bin\as.exe -o %obj%\vu\vu.o       %obj%\vu\vu.asm
 %MinGW%\bin\as.exe -o %obj%\vu\multiply.o %obj%\vu\multiply.asm
@@ -24,8 +24,6 @@
 #include "module.h"
 #include "su.h"
 
-RSP_INFO RSP_INFO_NAME;
-
 #define RSP_CXD4_VERSION 0x0101
 
 #if defined(M64P_PLUGIN_API)
@@ -60,6 +58,7 @@ NOINLINE void update_conf(const char* source)
     CFG_HLE_AUD = ConfigGetParamBool(l_ConfigRsp, "AudioListToAudioPlugin");
     CFG_WAIT_FOR_CPU_HOST = ConfigGetParamBool(l_ConfigRsp, "WaitForCPUHost");
     CFG_MEND_SEMAPHORE_LOCK = ConfigGetParamBool(l_ConfigRsp, "SupportCPUSemaphoreLock");
+    CFG_PREDECODE_IMEM = ConfigGetParamBool(l_ConfigRsp, "PredecodeIMEM");
 }
 
 static void DebugMessage(int level, const char *message, ...)
@@ -165,6 +164,7 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle, void *Con
     ConfigSetDefaultBool(l_ConfigRsp, "AudioListToAudioPlugin", 0, "Send audio lists to the audio plugin");
     ConfigSetDefaultBool(l_ConfigRsp, "WaitForCPUHost", 0, "Force CPU-RSP signals synchronization");
     ConfigSetDefaultBool(l_ConfigRsp, "SupportCPUSemaphoreLock", 0, "Support CPU-RSP semaphore lock");
+    ConfigSetDefaultBool(l_ConfigRsp, "PredecodeIMEM", 1, "Execute pre-decoded IMEM instead of decoding every instruction");
 
     if (bSaveConfig && ConfigAPIVersion >= 0x020100)
         ConfigSaveSection("rsp-cxd4");
@@ -223,7 +223,7 @@ static const char DLL_about[] =
 
 EXPORT void CALL CloseDLL(void)
 {
-    DRAM = NULL; /* so DllTest benchmark doesn't think ROM is still open */
+    rsp_current -> DRAM = NULL; /* so DllTest benchmark doesn't think ROM is still open */
     return;
 }
 
@@ -241,7 +241,7 @@ EXPORT void CALL DllConfig(p_void hParent)
     my_system("sp_cfgui");
     update_conf(CFG_FILE);
 
-    if (DMEM == IMEM || GET_RCP_REG(SP_PC_REG) % 4096 == 0x00000000)
+    if (rsp_current -> DMEM == rsp_current -> IMEM || GET_RCP_REG(SP_PC_REG) % 4096 == 0x00000000)
         return;
     export_SP_memory();
 
@@ -266,12 +266,12 @@ EXPORT u32 CALL DoRspCycles(u32 cycles)
 
     task_type = 0x00000000
 #ifdef USE_CLIENT_ENDIAN
-      | *((pi32)(DMEM + 0x000FC0U))
+      | *((pi32)(rsp_current -> DMEM + 0x000FC0U))
 #else
-      | (u32)DMEM[0xFC0] << 24
-      | (u32)DMEM[0xFC1] << 16
-      | (u32)DMEM[0xFC2] <<  8
-      | (u32)DMEM[0xFC3] <<  0
+      | (u32)rsp_current -> DMEM[0xFC0] << 24
+      | (u32)rsp_current -> DMEM[0xFC1] << 16
+      | (u32)rsp_current -> DMEM[0xFC2] <<  8
+      | (u32)rsp_current -> DMEM[0xFC3] <<  0
 #endif
     ;
     switch (task_type) {
@@ -280,7 +280,7 @@ EXPORT u32 CALL DoRspCycles(u32 cycles)
         if (CFG_HLE_GFX == 0)
             break;
 
-        if (*(pi32)(DMEM + 0xFF0) == 0x00000000)
+        if (*(pi32)(rsp_current -> DMEM + 0xFF0) == 0x00000000)
             break; /* Resident Evil 2, null task pointers */
         if (GET_RSP_INFO(ProcessDlistList) == NULL)
             { /* branch */ }
@@ -336,9 +336,12 @@ EXPORT u32 CALL DoRspCycles(u32 cycles)
 
 #ifdef WAIT_FOR_CPU_HOST
     for (i = 0; i < 32; i++)
-        MFC0_count[i] = 0;
+        rsp_current -> MFC0_count[i] = 0;
 #endif
-    run_task();
+    if (CFG_PREDECODE_IMEM)
+        run_task_predecoded();
+    else
+        run_task();
 
 /*
  * An optional EMMS when compiling with Intel SIMD or MMX support.
@@ -350,22 +353,22 @@ EXPORT u32 CALL DoRspCycles(u32 cycles)
     _mm_empty();
 #endif
 
-    if (*CR[0x4] & SP_STATUS_BROKE) /* normal exit, from executing BREAK */
+    if (*rsp_current -> CR[0x4] & SP_STATUS_BROKE) /* normal exit, from executing BREAK */
         return (cycles);
     else if (GET_RCP_REG(MI_INTR_REG) & 1) /* interrupt set by MTC0 to break */
         GET_RSP_INFO(CheckInterrupts)();
-    else if (*CR[0x7] != 0x00000000) /* semaphore lock fixes */
+    else if (*rsp_current -> CR[0x7] != 0x00000000) /* semaphore lock fixes */
         {}
 #ifdef WAIT_FOR_CPU_HOST
     else
-        MF_SP_STATUS_TIMEOUT = 16; /* From now on, wait 16 times, not 32767. */
+        rsp_current -> MF_SP_STATUS_TIMEOUT = 16; /* From now on, wait 16 times, not 32767. */
 #else
     else { /* ??? unknown, possibly external intervention from CPU memory map */
         message("SP_SET_HALT");
         return (cycles);
     }
 #endif
-    *CR[0x4] &= ~SP_STATUS_HALT; /* CPU restarts with the correct SIGs. */
+    *rsp_current -> CR[0x4] &= ~SP_STATUS_HALT; /* CPU restarts with the correct SIGs. */
     return (cycles);
 }
 
@@ -385,32 +388,10 @@ EXPORT void CALL InitiateRSP(RSP_INFO Rsp_Info, pu32 CycleCount)
         *CycleCount = 0;
     update_conf(CFG_FILE);
 
-    RSP_INFO_NAME = Rsp_Info;
-    DRAM = GET_RSP_INFO(RDRAM);
-    if (Rsp_Info.DMEM == Rsp_Info.IMEM) /* usually dummy RSP data for testing */
+    rsp_context_make_current(&rsp_main_context);
+    if (rsp_context_init(&rsp_main_context, &Rsp_Info) == 0)
         return; /* DMA is not executed just because plugin initiates. */
-    DMEM = GET_RSP_INFO(DMEM);
-    IMEM = GET_RSP_INFO(IMEM);
-
-    CR[0x0] = &GET_RCP_REG(SP_MEM_ADDR_REG);
-    CR[0x1] = &GET_RCP_REG(SP_DRAM_ADDR_REG);
-    CR[0x2] = &GET_RCP_REG(SP_RD_LEN_REG);
-    CR[0x3] = &GET_RCP_REG(SP_WR_LEN_REG);
-    CR[0x4] = &GET_RCP_REG(SP_STATUS_REG);
-    CR[0x5] = &GET_RCP_REG(SP_DMA_FULL_REG);
-    CR[0x6] = &GET_RCP_REG(SP_DMA_BUSY_REG);
-    CR[0x7] = &GET_RCP_REG(SP_SEMAPHORE_REG);
     GET_RCP_REG(SP_PC_REG) = 0x04001000;
-    CR[0x8] = &GET_RCP_REG(DPC_START_REG);
-    CR[0x9] = &GET_RCP_REG(DPC_END_REG);
-    CR[0xA] = &GET_RCP_REG(DPC_CURRENT_REG);
-    CR[0xB] = &GET_RCP_REG(DPC_STATUS_REG);
-    CR[0xC] = &GET_RCP_REG(DPC_CLOCK_REG);
-    CR[0xD] = &GET_RCP_REG(DPC_BUFBUSY_REG);
-    CR[0xE] = &GET_RCP_REG(DPC_PIPEBUSY_REG);
-    CR[0xF] = &GET_RCP_REG(DPC_TMEM_REG);
-
-    MF_SP_STATUS_TIMEOUT = 32767;
 #if 1
     GET_RCP_REG(SP_PC_REG) &= 0x00000FFFu; /* hack to fix Mupen64 */
 #endif
@@ -536,7 +517,7 @@ NOINLINE void export_data_cache(void)
 
     DMEM_swapped = my_calloc(4096, 1);
     for (i = 0; i < 4096; i++)
-        DMEM_swapped[i] = DMEM[BES(i)];
+        DMEM_swapped[i] = rsp_current -> DMEM[BES(i)];
     out = my_fopen("rcpcache.dhex", "wb");
     my_fwrite(DMEM_swapped, 16, 4096 / 16, out);
     my_fclose(out);
@@ -552,7 +533,7 @@ NOINLINE void export_instruction_cache(void)
 
     IMEM_swapped = my_calloc(4096, 1);
     for (i = 0; i < 4096; i++)
-        IMEM_swapped[i] = IMEM[BES(i)];
+        IMEM_swapped[i] = rsp_current -> IMEM[BES(i)];
     out = my_fopen("rcpcache.ihex", "wb");
     my_fwrite(IMEM_swapped, 16, 4096 / 16, out);
     my_fclose(out);
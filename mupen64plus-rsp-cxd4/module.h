@@ -64,6 +64,11 @@ typedef enum {
 #define CFG_MEND_SEMAPHORE_LOCK     (*(pi32)(conf + 0x14))
 #define CFG_TRACE_RSP_REGISTERS     (*(pi32)(conf + 0x18))
 
+/*
+ * Run tasks through the pre-decoded interpreter loop (`run_task_predecoded').
+ */
+#define CFG_PREDECODE_IMEM          (*(pi32)(conf + 0x1C))
+
 /*
  * Update RSP configuration memory from local file resource.
  */
@@ -21,15 +21,8 @@
  */
 #include "module.h"
 
-u32 inst_word;
-
-u32 SR[32];
 typedef VECTOR_OPERATION(*p_vector_func)(v16, v16);
 
-pu8 DRAM;
-pu8 DMEM;
-pu8 IMEM;
-
 NOINLINE void res_S(void)
 {
     message("RESERVED.");
@@ -38,22 +31,19 @@ NOINLINE void res_S(void)
 
 void set_PC(unsigned int address)
 {
-    temp_PC = 0x04001000 + FIT_IMEM(address);
+    rsp_current -> temp_PC = 0x04001000 + FIT_IMEM(address);
 #ifndef EMULATE_STATIC_PC
-    stage = 1;
+    rsp_current -> stage = 1;
 #endif
     return;
 }
 
-pu32 CR[NUMBER_OF_CP0_REGISTERS];
 u8 conf[32];
 
-int MF_SP_STATUS_TIMEOUT;
-
 void SP_CP0_MF(unsigned int rt, unsigned int rd)
 {
-    SR[rt] = *(CR[rd %= NUMBER_OF_CP0_REGISTERS]);
-    SR[zero] = 0x00000000;
+    rsp_current -> SR[rt] = *(rsp_current -> CR[rd %= NUMBER_OF_CP0_REGISTERS]);
+    rsp_current -> SR[zero] = 0x00000000;
     if (rd == 0x7) {
         if (CFG_MEND_SEMAPHORE_LOCK == 0)
             return;
@@ -65,8 +55,8 @@ void SP_CP0_MF(unsigned int rt, unsigned int rd)
     }
 #ifdef WAIT_FOR_CPU_HOST
     if (rd == 0x4) {
-        MFC0_count[rt] += 1;
-        GET_RCP_REG(SP_STATUS_REG) |= (MFC0_count[rt] >= MF_SP_STATUS_TIMEOUT);
+        rsp_current -> MFC0_count[rt] += 1;
+        GET_RCP_REG(SP_STATUS_REG) |= (rsp_current -> MFC0_count[rt] >= rsp_current -> MF_SP_STATUS_TIMEOUT);
     }
 #endif
     return;
@@ -74,23 +64,23 @@ void SP_CP0_MF(unsigned int rt, unsigned int rd)
 
 static void MT_DMA_CACHE(unsigned int rt)
 {
-    *CR[0x0] = SR[rt] & 0xFFFFFFF8ul; /* & 0x00001FF8 */
+    *rsp_current -> CR[0x0] = rsp_current -> SR[rt] & 0xFFFFFFF8ul; /* & 0x00001FF8 */
     return; /* Reserved upper bits are ignored during DMA R/W. */
 }
 static void MT_DMA_DRAM(unsigned int rt)
 {
-    *CR[0x1] = SR[rt] & 0xFFFFFFF8ul; /* & 0x00FFFFF8 */
+    *rsp_current -> CR[0x1] = rsp_current -> SR[rt] & 0xFFFFFFF8ul; /* & 0x00FFFFF8 */
     return; /* Let the reserved bits get sent, but the pointer is 24-bit. */
 }
 static void MT_DMA_READ_LENGTH(unsigned int rt)
 {
-    *CR[0x2] = SR[rt] | 07;
+    *rsp_current -> CR[0x2] = rsp_current -> SR[rt] | 07;
     SP_DMA_READ();
     return;
 }
 static void MT_DMA_WRITE_LENGTH(unsigned int rt)
 {
-    *CR[0x3] = SR[rt] | 07;
+    *rsp_current -> CR[0x3] = rsp_current -> SR[rt] | 07;
     SP_DMA_WRITE();
     return;
 }
@@ -99,49 +89,49 @@ static void MT_SP_STATUS(unsigned int rt)
     pu32 MI_INTR_REG;
     pu32 SP_STATUS_REG;
 
-    if (SR[rt] & 0xFE000040)
+    if (rsp_current -> SR[rt] & 0xFE000040)
         message("MTC0\nSP_STATUS");
     MI_INTR_REG = GET_RSP_INFO(MI_INTR_REG);
     SP_STATUS_REG = GET_RSP_INFO(SP_STATUS_REG);
 
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00000001) <<  0);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00000002) <<  0);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00000004) <<  1);
-    *MI_INTR_REG &= ~((SR[rt] & 0x00000008) >> 3); /* SP_CLR_INTR */
-    *MI_INTR_REG |=  ((SR[rt] & 0x00000010) >> 4); /* SP_SET_INTR */
-    *SP_STATUS_REG |= (SR[rt] & 0x00000010) >> 4; /* int set halt */
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00000020) <<  5);
+    *SP_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00000001) <<  0);
+    *SP_STATUS_REG |=  (!!(rsp_current -> SR[rt] & 0x00000002) <<  0);
+    *SP_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00000004) <<  1);
+    *MI_INTR_REG &= ~((rsp_current -> SR[rt] & 0x00000008) >> 3); /* SP_CLR_INTR */
+    *MI_INTR_REG |=  ((rsp_current -> SR[rt] & 0x00000010) >> 4); /* SP_SET_INTR */
+    *SP_STATUS_REG |= (rsp_current -> SR[rt] & 0x00000010) >> 4; /* int set halt */
+    *SP_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00000020) <<  5);
  /* *SP_STATUS_REG |=  (!!(SR[rt] & 0x00000040) <<  5); */
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00000080) <<  6);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00000100) <<  6);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00000200) <<  7);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00000400) <<  7); /* yield request? */
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00000800) <<  8);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00001000) <<  8); /* yielded? */
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00002000) <<  9);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00004000) <<  9); /* task done? */
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00008000) << 10);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00010000) << 10);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00020000) << 11);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00040000) << 11);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00080000) << 12);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00100000) << 12);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00200000) << 13);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x00400000) << 13);
-    *SP_STATUS_REG &= ~(!!(SR[rt] & 0x00800000) << 14);
-    *SP_STATUS_REG |=  (!!(SR[rt] & 0x01000000) << 14);
+    *SP_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00000080) <<  6);
+    *SP_STATUS_REG |=  (!!(rsp_current -> SR[rt] & 0x00000100) <<  6);
+    *SP_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00000200) <<  7);
+    *SP_STATUS_REG |=  (!!(rsp_current -> SR[rt] & 0x00000400) <<  7); /* yield request? */
+    *SP_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00000800) <<  8);
+    *SP_STATUS_REG |=  (!!(rsp_current -> SR[rt] & 0x00001000) <<  8); /* yielded? */
+    *SP_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00002000) <<  9);
+    *SP_STATUS_REG |=  (!!(rsp_current -> SR[rt] & 0x00004000) <<  9); /* task done? */
+    *SP_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00008000) << 10);
+    *SP_STATUS_REG |=  (!!(rsp_current -> SR[rt] & 0x00010000) << 10);
+    *SP_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00020000) << 11);
+    *SP_STATUS_REG |=  (!!(rsp_current -> SR[rt] & 0x00040000) << 11);
+    *SP_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00080000) << 12);
+    *SP_STATUS_REG |=  (!!(rsp_current -> SR[rt] & 0x00100000) << 12);
+    *SP_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00200000) << 13);
+    *SP_STATUS_REG |=  (!!(rsp_current -> SR[rt] & 0x00400000) << 13);
+    *SP_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00800000) << 14);
+    *SP_STATUS_REG |=  (!!(rsp_current -> SR[rt] & 0x01000000) << 14);
     return;
 }
 static void MT_SP_RESERVED(unsigned int rt)
 {
-    const u32 source = SR[rt] & 0x00000000ul; /* forced (zilmar, dox) */
+    const u32 source = rsp_current -> SR[rt] & 0x00000000ul; /* forced (zilmar, dox) */
 
     GET_RCP_REG(SP_SEMAPHORE_REG) = source;
     return;
 }
 static void MT_CMD_START(unsigned int rt)
 {
-    const u32 source = SR[rt] & 0xFFFFFFF8ul; /* Funnelcube demo by marshallh */
+    const u32 source = rsp_current -> SR[rt] & 0xFFFFFFF8ul; /* Funnelcube demo by marshallh */
 
     if (GET_RCP_REG(DPC_BUFBUSY_REG)) /* lock hazards not implemented */
         message("MTC0\nCMD_START");
@@ -155,7 +145,7 @@ static void MT_CMD_END(unsigned int rt)
 {
     if (GET_RCP_REG(DPC_BUFBUSY_REG))
         message("MTC0\nCMD_END"); /* This is just CA-related. */
-    GET_RCP_REG(DPC_END_REG) = SR[rt] & 0xFFFFFFF8ul;
+    GET_RCP_REG(DPC_END_REG) = rsp_current -> SR[rt] & 0xFFFFFFF8ul;
     if (GET_RSP_INFO(ProcessRdpList) == NULL) /* zilmar GFX #1.2 */
         return;
     GET_RSP_INFO(ProcessRdpList)();
@@ -165,27 +155,27 @@ static void MT_CMD_STATUS(unsigned int rt)
 {
     pu32 DPC_STATUS_REG;
 
-    if (SR[rt] & 0xFFFFFD80ul) /* unsupported or reserved bits */
+    if (rsp_current -> SR[rt] & 0xFFFFFD80ul) /* unsupported or reserved bits */
         message("MTC0\nCMD_STATUS");
     DPC_STATUS_REG = GET_RSP_INFO(DPC_STATUS_REG);
 
-    *DPC_STATUS_REG &= ~(!!(SR[rt] & 0x00000001) << 0);
-    *DPC_STATUS_REG |=  (!!(SR[rt] & 0x00000002) << 0);
-    *DPC_STATUS_REG &= ~(!!(SR[rt] & 0x00000004) << 1);
-    *DPC_STATUS_REG |=  (!!(SR[rt] & 0x00000008) << 1);
-    *DPC_STATUS_REG &= ~(!!(SR[rt] & 0x00000010) << 2);
-    *DPC_STATUS_REG |=  (!!(SR[rt] & 0x00000020) << 2);
+    *DPC_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00000001) << 0);
+    *DPC_STATUS_REG |=  (!!(rsp_current -> SR[rt] & 0x00000002) << 0);
+    *DPC_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00000004) << 1);
+    *DPC_STATUS_REG |=  (!!(rsp_current -> SR[rt] & 0x00000008) << 1);
+    *DPC_STATUS_REG &= ~(!!(rsp_current -> SR[rt] & 0x00000010) << 2);
+    *DPC_STATUS_REG |=  (!!(rsp_current -> SR[rt] & 0x00000020) << 2);
 /* Some NUS-CIC-6105 SP tasks try to clear some DPC cycle timers. */
-    GET_RCP_REG(DPC_TMEM_REG)     &= !(SR[rt] & 0x00000040) ? ~0u : 0u;
+    GET_RCP_REG(DPC_TMEM_REG)     &= !(rsp_current -> SR[rt] & 0x00000040) ? ~0u : 0u;
  /* GET_RCP_REG(DPC_PIPEBUSY_REG) &= !(SR[rt] & 0x00000080) ? ~0u : 0u; */
  /* GET_RCP_REG(DPC_BUFBUSY_REG)  &= !(SR[rt] & 0x00000100) ? ~0u : 0u; */
-    GET_RCP_REG(DPC_CLOCK_REG)    &= !(SR[rt] & 0x00000200) ? ~0u : 0u;
+    GET_RCP_REG(DPC_CLOCK_REG)    &= !(rsp_current -> SR[rt] & 0x00000200) ? ~0u : 0u;
     return;
 }
 static void MT_CMD_CLOCK(unsigned int rt)
 {
     message("MTC0\nCMD_CLOCK"); /* read-only?? */
-    GET_RCP_REG(DPC_CLOCK_REG) = SR[rt];
+    GET_RCP_REG(DPC_CLOCK_REG) = rsp_current -> SR[rt];
     return; /* Appendix says this is RW; elsewhere it says R. */
 }
 static void MT_READ_ONLY(unsigned int rt)
@@ -227,17 +217,17 @@ void SP_DMA_READ(void)
         i = 0;
         --count;
         do {
-            offC = (count*length + *CR[0x0] + i) & 0x00001FF8ul;
-            offD = (count*skip + *CR[0x1] + i) & 0x00FFFFF8ul;
-            *(pi64)(DMEM + offC) =
-                *(pi64)(DRAM + offD)
+            offC = (count*length + *rsp_current -> CR[0x0] + i) & 0x00001FF8ul;
+            offD = (count*skip + *rsp_current -> CR[0x1] + i) & 0x00FFFFF8ul;
+            *(pi64)(rsp_current -> DMEM + offC) =
+                *(pi64)(rsp_current -> DRAM + offD)
               & (offD & ~MAX_DRAM_DMA_ADDR ? 0 : ~0) /* 0 if (addr > limit) */
             ;
             i += 0x008;
         } while (i < length);
     } while (count);
 
-    if ((*CR[0x0] & 0x1000) ^ (offC & 0x1000))
+    if ((*rsp_current -> CR[0x0] & 0x1000) ^ (offC & 0x1000))
         message("DMA over the DMEM-to-IMEM gap.");
     GET_RCP_REG(SP_DMA_BUSY_REG)  =  0x00000000;
     GET_RCP_REG(SP_STATUS_REG)   &= ~SP_STATUS_DMA_BUSY;
@@ -266,14 +256,14 @@ void SP_DMA_WRITE(void)
         i = 0;
         --count;
         do {
-            offC = (count*length + *CR[0x0] + i) & 0x00001FF8ul;
-            offD = (count*skip + *CR[0x1] + i) & 0x00FFFFF8ul;
-            *(pi64)(DRAM + offD) = *(pi64)(DMEM + offC);
+            offC = (count*length + *rsp_current -> CR[0x0] + i) & 0x00001FF8ul;
+            offD = (count*skip + *rsp_current -> CR[0x1] + i) & 0x00FFFFF8ul;
+            *(pi64)(rsp_current -> DRAM + offD) = *(pi64)(rsp_current -> DMEM + offC);
             i += 0x000008;
         } while (i < length);
     } while (count);
 
-    if ((*CR[0x0] & 0x1000) ^ (offC & 0x1000))
+    if ((*rsp_current -> CR[0x0] & 0x1000) ^ (offC & 0x1000))
         message("DMA over the DMEM-to-IMEM gap.");
     GET_RCP_REG(SP_DMA_BUSY_REG)  =  0x00000000;
     GET_RCP_REG(SP_STATUS_REG)   &= ~SP_STATUS_DMA_BUSY;
@@ -288,7 +278,7 @@ PROFILE_MODE void J(u32 inst)
 }
 PROFILE_MODE void JAL(u32 inst, u32 PC)
 {
-    SR[ra] = FIT_IMEM(PC + LINK_OFF);
+    rsp_current -> SR[ra] = FIT_IMEM(PC + LINK_OFF);
     set_PC(4 * inst);
 }
 
@@ -297,7 +287,7 @@ PROFILE_MODE int BEQ(u32 inst, u32 PC)
     const unsigned int rs = (inst >> 21) % (1 << 5);
     const unsigned int rt = (inst >> 16) % (1 << 5);
 
-    if (!(SR[rs] == SR[rt]))
+    if (!(rsp_current -> SR[rs] == rsp_current -> SR[rt]))
         return 0;
     set_PC(PC + 4*inst + SLOT_OFF);
     return 1;
@@ -307,7 +297,7 @@ PROFILE_MODE int BNE(u32 inst, u32 PC)
     const unsigned int rs = (inst >> 21) % (1 << 5);
     const unsigned int rt = (inst >> 16) % (1 << 5);
 
-    if (!(SR[rs] != SR[rt]))
+    if (!(rsp_current -> SR[rs] != rsp_current -> SR[rt]))
         return 0;
     set_PC(PC + 4*inst + SLOT_OFF);
     return 1;
@@ -316,7 +306,7 @@ PROFILE_MODE int BLEZ(u32 inst, u32 PC)
 {
     const unsigned int rs = (inst >> 21) % (1 << 5);
 
-    if (!((s32)SR[rs] <= 0))
+    if (!((s32)rsp_current -> SR[rs] <= 0))
         return 0;
     set_PC(PC + 4*inst + SLOT_OFF);
     return 1;
@@ -325,7 +315,7 @@ PROFILE_MODE int BGTZ(u32 inst, u32 PC)
 {
     const unsigned int rs = (inst >> 21) % (1 << 5);
 
-    if (!((s32)SR[rs] >  0))
+    if (!((s32)rsp_current -> SR[rs] >  0))
         return 0;
     set_PC(PC + 4*inst + SLOT_OFF);
     return 1;
@@ -339,8 +329,8 @@ PROFILE_MODE void ANDI(u32 inst)
     const unsigned int rs = (inst >> 21) % (1 << 5);
     const unsigned int rt = (inst >> 16) % (1 << 5);
 
-    SR[rt] = SR[rs] & immediate;
-    SR[zero] = 0x00000000;
+    rsp_current -> SR[rt] = rsp_current -> SR[rs] & immediate;
+    rsp_current -> SR[zero] = 0x00000000;
 }
 PROFILE_MODE void ORI(u32 inst)
 {
@@ -348,8 +338,8 @@ PROFILE_MODE void ORI(u32 inst)
     const unsigned int rs = (inst >> 21) % (1 << 5);
     const unsigned int rt = (inst >> 16) % (1 << 5);
 
-    SR[rt] = SR[rs] | immediate;
-    SR[zero] = 0x00000000;
+    rsp_current -> SR[rt] = rsp_current -> SR[rs] | immediate;
+    rsp_current -> SR[zero] = 0x00000000;
 }
 PROFILE_MODE void XORI(u32 inst)
 {
@@ -357,16 +347,16 @@ PROFILE_MODE void XORI(u32 inst)
     const unsigned int rs = (inst >> 21) % (1 << 5);
     const unsigned int rt = (inst >> 16) % (1 << 5);
 
-    SR[rt] = SR[rs] ^ immediate;
-    SR[zero] = 0x00000000;
+    rsp_current -> SR[rt] = rsp_current -> SR[rs] ^ immediate;
+    rsp_current -> SR[zero] = 0x00000000;
 }
 PROFILE_MODE void LUI(u32 inst)
 {
     const u16 immediate = (u16)(inst & 0x0000FFFFu);
     const unsigned int rt = (inst >> 16) % (1 << 5);
 
-    SR[rt] = (u32)immediate << 16; /* or:  SR[rt] = 0; SR[rt]31..16 = imm; */
-    SR[zero] = 0x00000000;
+    rsp_current -> SR[rt] = (u32)immediate << 16; /* or:  SR[rt] = 0; SR[rt]31..16 = imm; */
+    rsp_current -> SR[zero] = 0x00000000;
 }
 
 /*** scalar, R4000 arithmetic operations ***/
@@ -377,8 +367,8 @@ PROFILE_MODE void ADDIU(u32 inst)
     const unsigned int rs = (inst >> 21) % (1 << 5);
     const unsigned int rt = (inst >> 16) % (1 << 5);
 
-    SR[rt] = SR[rs] + (s16)(immediate);
-    SR[zero] = 0x00000000;
+    rsp_current -> SR[rt] = rsp_current -> SR[rs] + (s16)(immediate);
+    rsp_current -> SR[zero] = 0x00000000;
 }
 PROFILE_MODE void SLTI(u32 inst)
 {
@@ -386,8 +376,8 @@ PROFILE_MODE void SLTI(u32 inst)
     const unsigned int rs = (inst >> 21) % (1 << 5);
     const unsigned int rt = (inst >> 16) % (1 << 5);
 
-    SR[rt] = ((s32)(SR[rs]) < (s16)(immediate)) ? 1 : 0;
-    SR[zero] = 0x00000000;
+    rsp_current -> SR[rt] = ((s32)(rsp_current -> SR[rs]) < (s16)(immediate)) ? 1 : 0;
+    rsp_current -> SR[zero] = 0x00000000;
 }
 PROFILE_MODE void SLTIU(u32 inst)
 {
@@ -395,8 +385,8 @@ PROFILE_MODE void SLTIU(u32 inst)
     const unsigned int rs = (inst >> 21) % (1 << 5);
     const unsigned int rt = (inst >> 16) % (1 << 5);
 
-    SR[rt] = ((u32)(SR[rs]) < (u16)(immediate)) ? 1 : 0;
-    SR[zero] = 0x00000000;
+    rsp_current -> SR[rt] = ((u32)(rsp_current -> SR[rs]) < (u16)(immediate)) ? 1 : 0;
+    rsp_current -> SR[zero] = 0x00000000;
 }
 
 /*** scalar, R4000 memory loads and stores ***/
@@ -408,10 +398,10 @@ PROFILE_MODE void LB(u32 inst)
     const unsigned int base = (inst >> 21) % (1 << 5);
     const unsigned int rt   = (inst >> 16) % (1 << 5);
 
-    addr = SR[base] + offset;
-    SR[rt] = DMEM[BES(addr) & 0x00000FFFul];
-    SR[rt] = (s8)SR[rt];
-    SR[zero] = 0x00000000;
+    addr = rsp_current -> SR[base] + offset;
+    rsp_current -> SR[rt] = rsp_current -> DMEM[BES(addr) & 0x00000FFFul];
+    rsp_current -> SR[rt] = (s8)rsp_current -> SR[rt];
+    rsp_current -> SR[zero] = 0x00000000;
 }
 PROFILE_MODE void LH(u32 inst)
 {
@@ -420,13 +410,13 @@ PROFILE_MODE void LH(u32 inst)
     const unsigned int base = (inst >> 21) % (1 << 5);
     const unsigned int rt   = (inst >> 16) % (1 << 5);
 
-    addr = SR[base] + offset;
-    SR[rt] = 0x00000000
-      | DMEM[BES(addr + 0) & 0x00000FFFul] <<  8
-      | DMEM[BES(addr + 1) & 0x00000FFFul] <<  0
+    addr = rsp_current -> SR[base] + offset;
+    rsp_current -> SR[rt] = 0x00000000
+      | rsp_current -> DMEM[BES(addr + 0) & 0x00000FFFul] <<  8
+      | rsp_current -> DMEM[BES(addr + 1) & 0x00000FFFul] <<  0
     ;
-    SR[rt] = (s16)SR[rt];
-    SR[zero] = 0x00000000;
+    rsp_current -> SR[rt] = (s16)rsp_current -> SR[rt];
+    rsp_current -> SR[zero] = 0x00000000;
 }
 PROFILE_MODE void LW(u32 inst)
 {
@@ -435,12 +425,12 @@ PROFILE_MODE void LW(u32 inst)
     const unsigned int base = (inst >> 21) % (1 << 5);
     const unsigned int rt   = (inst >> 16) % (1 << 5);
 
-    addr = SR[base] + offset;
-    SR_B(rt, 0) = DMEM[BES(addr + 0) & 0x00000FFFul];
-    SR_B(rt, 1) = DMEM[BES(addr + 1) & 0x00000FFFul];
-    SR_B(rt, 2) = DMEM[BES(addr + 2) & 0x00000FFFul];
-    SR_B(rt, 3) = DMEM[BES(addr + 3) & 0x00000FFFul];
-    SR[zero] = 0x00000000;
+    addr = rsp_current -> SR[base] + offset;
+    SR_B(rt, 0) = rsp_current -> DMEM[BES(addr + 0) & 0x00000FFFul];
+    SR_B(rt, 1) = rsp_current -> DMEM[BES(addr + 1) & 0x00000FFFul];
+    SR_B(rt, 2) = rsp_current -> DMEM[BES(addr + 2) & 0x00000FFFul];
+    SR_B(rt, 3) = rsp_current -> DMEM[BES(addr + 3) & 0x00000FFFul];
+    rsp_current -> SR[zero] = 0x00000000;
 }
 PROFILE_MODE void LBU(u32 inst)
 {
@@ -449,9 +439,9 @@ PROFILE_MODE void LBU(u32 inst)
     const unsigned int base = (inst >> 21) % (1 << 5);
     const unsigned int rt   = (inst >> 16) % (1 << 5);
 
-    addr = SR[base] + offset;
-    SR[rt] = DMEM[BES(addr) & 0x00000FFFul];
-    SR[zero] = 0x00000000;
+    addr = rsp_current -> SR[base] + offset;
+    rsp_current -> SR[rt] = rsp_current -> DMEM[BES(addr) & 0x00000FFFul];
+    rsp_current -> SR[zero] = 0x00000000;
 }
 PROFILE_MODE void LHU(u32 inst)
 {
@@ -460,12 +450,12 @@ PROFILE_MODE void LHU(u32 inst)
     const unsigned int base = (inst >> 21) % (1 << 5);
     const unsigned int rt   = (inst >> 16) % (1 << 5);
 
-    addr = SR[base] + offset;
-    SR[rt] = 0x00000000
-      | DMEM[BES(addr + 0) & 0x00000FFFul] <<  8
-      | DMEM[BES(addr + 1) & 0x00000FFFul] <<  0
+    addr = rsp_current -> SR[base] + offset;
+    rsp_current -> SR[rt] = 0x00000000
+      | rsp_current -> DMEM[BES(addr + 0) & 0x00000FFFul] <<  8
+      | rsp_current -> DMEM[BES(addr + 1) & 0x00000FFFul] <<  0
     ;
-    SR[zero] = 0x00000000;
+    rsp_current -> SR[zero] = 0x00000000;
 }
 
 PROFILE_MODE void SB(u32 inst)
@@ -475,8 +465,8 @@ PROFILE_MODE void SB(u32 inst)
     const unsigned int base = (inst >> 21) % (1 << 5);
     const unsigned int rt   = (inst >> 16) % (1 << 5);
 
-    addr = SR[base] + offset;
-    DMEM[BES(addr) & 0x00000FFFul] = (u8)(SR[rt] & 0xFFu);
+    addr = rsp_current -> SR[base] + offset;
+    rsp_current -> DMEM[BES(addr) & 0x00000FFFul] = (u8)(rsp_current -> SR[rt] & 0xFFu);
 }
 PROFILE_MODE void SH(u32 inst)
 {
@@ -485,9 +475,9 @@ PROFILE_MODE void SH(u32 inst)
     const unsigned int base = (inst >> 21) % (1 << 5);
     const unsigned int rt   = (inst >> 16) % (1 << 5);
 
-    addr = SR[base] + offset;
-    DMEM[BES(addr + 0) & 0x00000FFFul] = SR_B(rt, 2);
-    DMEM[BES(addr + 1) & 0x00000FFFul] = SR_B(rt, 3);
+    addr = rsp_current -> SR[base] + offset;
+    rsp_current -> DMEM[BES(addr + 0) & 0x00000FFFul] = SR_B(rt, 2);
+    rsp_current -> DMEM[BES(addr + 1) & 0x00000FFFul] = SR_B(rt, 3);
 }
 PROFILE_MODE void SW(u32 inst)
 {
@@ -496,11 +486,11 @@ PROFILE_MODE void SW(u32 inst)
     const unsigned int base = (inst >> 21) % (1 << 5);
     const unsigned int rt   = (inst >> 16) % (1 << 5);
 
-    addr = SR[base] + offset;
-    DMEM[BES(addr + 0) & 0x00000FFFul] = SR_B(rt, 0);
-    DMEM[BES(addr + 1) & 0x00000FFFul] = SR_B(rt, 1);
-    DMEM[BES(addr + 2) & 0x00000FFFul] = SR_B(rt, 2);
-    DMEM[BES(addr + 3) & 0x00000FFFul] = SR_B(rt, 3);
+    addr = rsp_current -> SR[base] + offset;
+    rsp_current -> DMEM[BES(addr + 0) & 0x00000FFFul] = SR_B(rt, 0);
+    rsp_current -> DMEM[BES(addr + 1) & 0x00000FFFul] = SR_B(rt, 1);
+    rsp_current -> DMEM[BES(addr + 2) & 0x00000FFFul] = SR_B(rt, 2);
+    rsp_current -> DMEM[BES(addr + 3) & 0x00000FFFul] = SR_B(rt, 3);
 }
 
 /*** scalar, coprocessor operations (vector unit) ***/
@@ -518,7 +508,7 @@ void rwW_VCE(u16 vce)
 
     vce = 0x00 | (vce & 0xFF);
     for (i = 0; i < 8; i++)
-        cf_vce[i] = (vce >> i) & 1;
+        rsp_current -> cf_vce[i] = (vce >> i) & 1;
     return;
 }
 
@@ -533,8 +523,8 @@ void MFC2(unsigned int rt, unsigned int vs, unsigned int e)
     SR_B(rt, 2) = VR_B(vs, e);
     e = (e + 0x1) & 0xF;
     SR_B(rt, 3) = VR_B(vs, e);
-    SR[rt] = (s16)(SR[rt]);
-    SR[zero] = 0x00000000;
+    rsp_current -> SR[rt] = (s16)(rsp_current -> SR[rt]);
+    rsp_current -> SR[zero] = 0x00000000;
     return;
 }
 void MTC2(unsigned int rt, unsigned int vd, unsigned int e)
@@ -545,13 +535,13 @@ void MTC2(unsigned int rt, unsigned int vd, unsigned int e)
 }
 void CFC2(unsigned int rt, unsigned int rd)
 {
-    SR[rt] = (s16)R_VCF[rd & 3]();
-    SR[zero] = 0x00000000;
+    rsp_current -> SR[rt] = (s16)R_VCF[rd & 3]();
+    rsp_current -> SR[zero] = 0x00000000;
     return;
 }
 void CTC2(unsigned int rt, unsigned int rd)
 {
-    W_VCF[rd & 3](SR[rt] & 0x0000FFFF);
+    W_VCF[rd & 3](rsp_current -> SR[rt] & 0x0000FFFF);
     return;
 }
 
@@ -562,8 +552,8 @@ void LBV(unsigned vt, unsigned element, signed offset, unsigned base)
     register u32 addr;
     const unsigned int e = element;
 
-    addr = (SR[base] + 1*offset) & 0x00000FFF;
-    VR_B(vt, e) = DMEM[BES(addr)];
+    addr = (rsp_current -> SR[base] + 1*offset) & 0x00000FFF;
+    VR_B(vt, e) = rsp_current -> DMEM[BES(addr)];
     return;
 }
 void LSV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -576,14 +566,14 @@ void LSV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LSV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 2*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 2*offset) & 0x00000FFF;
     correction = (signed)(addr % 0x004);
     if (correction == 0x003) {
         message("LSV\nWeird addr.");
         return;
     }
     correction = (correction - 1) * HES(0x000);
-    VR_S(vt, e) = *(pi16)(DMEM + addr - correction);
+    VR_S(vt, e) = *(pi16)(rsp_current -> DMEM + addr - correction);
     return;
 }
 void LLV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -596,21 +586,21 @@ void LLV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LLV\nOdd element.");
         return;
     } /* Illegal (but still even) elements are used by Boss Game Studios. */
-    addr = (SR[base] + 4*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 4*offset) & 0x00000FFF;
     if (addr & 0x00000001) {
-        VR_A(vt, e+0x0) = DMEM[BES(addr)];
+        VR_A(vt, e+0x0) = rsp_current -> DMEM[BES(addr)];
         addr = (addr + 0x00000001) & 0x00000FFF;
-        VR_U(vt, e+0x1) = DMEM[BES(addr)];
+        VR_U(vt, e+0x1) = rsp_current -> DMEM[BES(addr)];
         addr = (addr + 0x00000001) & 0x00000FFF;
-        VR_A(vt, e+0x2) = DMEM[BES(addr)];
+        VR_A(vt, e+0x2) = rsp_current -> DMEM[BES(addr)];
         addr = (addr + 0x00000001) & 0x00000FFF;
-        VR_U(vt, e+0x3) = DMEM[BES(addr)];
+        VR_U(vt, e+0x3) = rsp_current -> DMEM[BES(addr)];
         return;
     } /* branch very unlikely:  "Star Wars:  Battle for Naboo" unaligned addr */
     correction = HES(0x000)*(addr%0x004 - 1);
-    VR_S(vt, e+0x0) = *(pi16)(DMEM + addr - correction);
+    VR_S(vt, e+0x0) = *(pi16)(rsp_current -> DMEM + addr - correction);
     addr = (addr + 0x00000002) & 0x00000FFF; /* F3DLX 1.23:  addr%4 is 0x002. */
-    VR_S(vt, e+0x2) = *(pi16)(DMEM + addr + correction);
+    VR_S(vt, e+0x2) = *(pi16)(rsp_current -> DMEM + addr + correction);
     return;
 }
 void LDV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -622,78 +612,78 @@ void LDV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LDV\nOdd element.");
         return;
     } /* Illegal (but still even) elements are used by Boss Game Studios. */
-    addr = (SR[base] + 8*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 8*offset) & 0x00000FFF;
 
     switch (addr & 07) {
     case 00:
-        VR_S(vt, e+0x0) = *(pi16)(DMEM + addr + HES(0x000));
-        VR_S(vt, e+0x2) = *(pi16)(DMEM + addr + HES(0x002));
-        VR_S(vt, e+0x4) = *(pi16)(DMEM + addr + HES(0x004));
-        VR_S(vt, e+0x6) = *(pi16)(DMEM + addr + HES(0x006));
+        VR_S(vt, e+0x0) = *(pi16)(rsp_current -> DMEM + addr + HES(0x000));
+        VR_S(vt, e+0x2) = *(pi16)(rsp_current -> DMEM + addr + HES(0x002));
+        VR_S(vt, e+0x4) = *(pi16)(rsp_current -> DMEM + addr + HES(0x004));
+        VR_S(vt, e+0x6) = *(pi16)(rsp_current -> DMEM + addr + HES(0x006));
         break;
     case 01: /* standard ABI ucodes (unlike e.g. MusyX w/ even addresses) */
-        VR_S(vt, e+0x0) = *(pi16)(DMEM + addr + 0x000);
-        VR_A(vt, e+0x2) = DMEM[addr + 0x002 - BES(0x000)];
-        VR_U(vt, e+0x3) = DMEM[addr + 0x003 + BES(0x000)];
-        VR_S(vt, e+0x4) = *(pi16)(DMEM + addr + 0x004);
-        VR_A(vt, e+0x6) = DMEM[addr + 0x006 - BES(0x000)];
+        VR_S(vt, e+0x0) = *(pi16)(rsp_current -> DMEM + addr + 0x000);
+        VR_A(vt, e+0x2) = rsp_current -> DMEM[addr + 0x002 - BES(0x000)];
+        VR_U(vt, e+0x3) = rsp_current -> DMEM[addr + 0x003 + BES(0x000)];
+        VR_S(vt, e+0x4) = *(pi16)(rsp_current -> DMEM + addr + 0x004);
+        VR_A(vt, e+0x6) = rsp_current -> DMEM[addr + 0x006 - BES(0x000)];
         addr += 0x007 + BES(00);
         addr &= 0x00000FFF;
-        VR_U(vt, e+0x7) = DMEM[addr];
+        VR_U(vt, e+0x7) = rsp_current -> DMEM[addr];
         break;
     case 02:
-        VR_S(vt, e+0x0) = *(pi16)(DMEM + addr + 0x000 - HES(0x000));
-        VR_S(vt, e+0x2) = *(pi16)(DMEM + addr + 0x002 + HES(0x000));
-        VR_S(vt, e+0x4) = *(pi16)(DMEM + addr + 0x004 - HES(0x000));
+        VR_S(vt, e+0x0) = *(pi16)(rsp_current -> DMEM + addr + 0x000 - HES(0x000));
+        VR_S(vt, e+0x2) = *(pi16)(rsp_current -> DMEM + addr + 0x002 + HES(0x000));
+        VR_S(vt, e+0x4) = *(pi16)(rsp_current -> DMEM + addr + 0x004 - HES(0x000));
         addr += 0x006 + HES(00);
         addr &= 0x00000FFF;
-        VR_S(vt, e+0x6) = *(pi16)(DMEM + addr);
+        VR_S(vt, e+0x6) = *(pi16)(rsp_current -> DMEM + addr);
         break;
     case 03: /* standard ABI ucodes (unlike e.g. MusyX w/ even addresses) */
-        VR_A(vt, e+0x0) = DMEM[addr + 0x000 - BES(0x000)];
-        VR_U(vt, e+0x1) = DMEM[addr + 0x001 + BES(0x000)];
-        VR_S(vt, e+0x2) = *(pi16)(DMEM + addr + 0x002);
-        VR_A(vt, e+0x4) = DMEM[addr + 0x004 - BES(0x000)];
+        VR_A(vt, e+0x0) = rsp_current -> DMEM[addr + 0x000 - BES(0x000)];
+        VR_U(vt, e+0x1) = rsp_current -> DMEM[addr + 0x001 + BES(0x000)];
+        VR_S(vt, e+0x2) = *(pi16)(rsp_current -> DMEM + addr + 0x002);
+        VR_A(vt, e+0x4) = rsp_current -> DMEM[addr + 0x004 - BES(0x000)];
         addr += 0x005 + BES(00);
         addr &= 0x00000FFF;
-        VR_U(vt, e+0x5) = DMEM[addr];
-        VR_S(vt, e+0x6) = *(pi16)(DMEM + addr + 0x001 - BES(0x000));
+        VR_U(vt, e+0x5) = rsp_current -> DMEM[addr];
+        VR_S(vt, e+0x6) = *(pi16)(rsp_current -> DMEM + addr + 0x001 - BES(0x000));
         break;
     case 04:
-        VR_S(vt, e+0x0) = *(pi16)(DMEM + addr + HES(0x000));
-        VR_S(vt, e+0x2) = *(pi16)(DMEM + addr + HES(0x002));
+        VR_S(vt, e+0x0) = *(pi16)(rsp_current -> DMEM + addr + HES(0x000));
+        VR_S(vt, e+0x2) = *(pi16)(rsp_current -> DMEM + addr + HES(0x002));
         addr += 0x004 + WES(00);
         addr &= 0x00000FFF;
-        VR_S(vt, e+0x4) = *(pi16)(DMEM + addr + HES(0x000));
-        VR_S(vt, e+0x6) = *(pi16)(DMEM + addr + HES(0x002));
+        VR_S(vt, e+0x4) = *(pi16)(rsp_current -> DMEM + addr + HES(0x000));
+        VR_S(vt, e+0x6) = *(pi16)(rsp_current -> DMEM + addr + HES(0x002));
         break;
     case 05: /* standard ABI ucodes (unlike e.g. MusyX w/ even addresses) */
-        VR_S(vt, e+0x0) = *(pi16)(DMEM + addr + 0x000);
-        VR_A(vt, e+0x2) = DMEM[addr + 0x002 - BES(0x000)];
+        VR_S(vt, e+0x0) = *(pi16)(rsp_current -> DMEM + addr + 0x000);
+        VR_A(vt, e+0x2) = rsp_current -> DMEM[addr + 0x002 - BES(0x000)];
         addr += 0x003;
         addr &= 0x00000FFF;
-        VR_U(vt, e+0x3) = DMEM[addr + BES(0x000)];
-        VR_S(vt, e+0x4) = *(pi16)(DMEM + addr + 0x001);
-        VR_A(vt, e+0x6) = DMEM[addr + BES(0x003)];
-        VR_U(vt, e+0x7) = DMEM[addr + BES(0x004)];
+        VR_U(vt, e+0x3) = rsp_current -> DMEM[addr + BES(0x000)];
+        VR_S(vt, e+0x4) = *(pi16)(rsp_current -> DMEM + addr + 0x001);
+        VR_A(vt, e+0x6) = rsp_current -> DMEM[addr + BES(0x003)];
+        VR_U(vt, e+0x7) = rsp_current -> DMEM[addr + BES(0x004)];
         break;
     case 06:
-        VR_S(vt, e+0x0) = *(pi16)(DMEM + addr - HES(0x000));
+        VR_S(vt, e+0x0) = *(pi16)(rsp_current -> DMEM + addr - HES(0x000));
         addr += 0x002;
         addr &= 0x00000FFF;
-        VR_S(vt, e+0x2) = *(pi16)(DMEM + addr + HES(0x000));
-        VR_S(vt, e+0x4) = *(pi16)(DMEM + addr + HES(0x002));
-        VR_S(vt, e+0x6) = *(pi16)(DMEM + addr + HES(0x004));
+        VR_S(vt, e+0x2) = *(pi16)(rsp_current -> DMEM + addr + HES(0x000));
+        VR_S(vt, e+0x4) = *(pi16)(rsp_current -> DMEM + addr + HES(0x002));
+        VR_S(vt, e+0x6) = *(pi16)(rsp_current -> DMEM + addr + HES(0x004));
         break;
     case 07: /* standard ABI ucodes (unlike e.g. MusyX w/ even addresses) */
-        VR_A(vt, e+0x0) = DMEM[addr - BES(0x000)];
+        VR_A(vt, e+0x0) = rsp_current -> DMEM[addr - BES(0x000)];
         addr += 0x001;
         addr &= 0x00000FFF;
-        VR_U(vt, e+0x1) = DMEM[addr + BES(0x000)];
-        VR_S(vt, e+0x2) = *(pi16)(DMEM + addr + 0x001);
-        VR_A(vt, e+0x4) = DMEM[addr + BES(0x003)];
-        VR_U(vt, e+0x5) = DMEM[addr + BES(0x004)];
-        VR_S(vt, e+0x6) = *(pi16)(DMEM + addr + 0x005);
+        VR_U(vt, e+0x1) = rsp_current -> DMEM[addr + BES(0x000)];
+        VR_S(vt, e+0x2) = *(pi16)(rsp_current -> DMEM + addr + 0x001);
+        VR_A(vt, e+0x4) = rsp_current -> DMEM[addr + BES(0x003)];
+        VR_U(vt, e+0x5) = rsp_current -> DMEM[addr + BES(0x004)];
+        VR_S(vt, e+0x6) = *(pi16)(rsp_current -> DMEM + addr + 0x005);
         break;
     }
     return;
@@ -703,8 +693,8 @@ void SBV(unsigned vt, unsigned element, signed offset, unsigned base)
     register u32 addr;
     const unsigned int e = element;
 
-    addr = (SR[base] + 1*offset) & 0x00000FFF;
-    DMEM[BES(addr)] = VR_B(vt, e);
+    addr = (rsp_current -> SR[base] + 1*offset) & 0x00000FFF;
+    rsp_current -> DMEM[BES(addr)] = VR_B(vt, e);
     return;
 }
 void SSV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -712,10 +702,10 @@ void SSV(unsigned vt, unsigned element, signed offset, unsigned base)
     register u32 addr;
     const unsigned int e = element;
 
-    addr = (SR[base] + 2*offset) & 0x00000FFF;
-    DMEM[BES(addr)] = VR_B(vt, (e + 0x0));
+    addr = (rsp_current -> SR[base] + 2*offset) & 0x00000FFF;
+    rsp_current -> DMEM[BES(addr)] = VR_B(vt, (e + 0x0));
     addr = (addr + 0x00000001) & 0x00000FFF;
-    DMEM[BES(addr)] = VR_B(vt, (e + 0x1) & 0xF);
+    rsp_current -> DMEM[BES(addr)] = VR_B(vt, (e + 0x1) & 0xF);
     return;
 }
 void SLV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -728,15 +718,15 @@ void SLV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("SLV\nIllegal element.");
         return;
     } /* must support illegal even elements in F3DEX2 */
-    addr = (SR[base] + 4*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 4*offset) & 0x00000FFF;
     if (addr & 0x00000001) {
         message("SLV\nOdd addr.");
         return;
     }
     correction = HES(0x000)*(addr%0x004 - 1);
-    *(pi16)(DMEM + addr - correction) = VR_S(vt, e+0x0);
+    *(pi16)(rsp_current -> DMEM + addr - correction) = VR_S(vt, e+0x0);
     addr = (addr + 0x00000002) & 0x00000FFF; /* F3DLX 0.95:  "Mario Kart 64" */
-    *(pi16)(DMEM + addr + correction) = VR_S(vt, e+0x2);
+    *(pi16)(rsp_current -> DMEM + addr + correction) = VR_S(vt, e+0x2);
     return;
 }
 void SDV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -744,86 +734,86 @@ void SDV(unsigned vt, unsigned element, signed offset, unsigned base)
     register u32 addr;
     const unsigned int e = element;
 
-    addr = (SR[base] + 8*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 8*offset) & 0x00000FFF;
     if (e > 0x8 || (e & 0x1)) {
         register unsigned int i;
 
 #if (VR_STATIC_WRAPAROUND == 1)
-        vector_copy(VR[vt] + N, VR[vt]);
+        vector_copy(rsp_current -> VR[vt] + N, rsp_current -> VR[vt]);
         for (i = 0; i < 8; i++)
-            DMEM[BES(addr++ & 0x00000FFF)] = VR_B(vt, e + i);
+            rsp_current -> DMEM[BES(addr++ & 0x00000FFF)] = VR_B(vt, e + i);
 #else
         for (i = 0; i < 8; i++)
-            DMEM[BES(addr++ & 0x00000FFF)] = VR_B(vt, (e+i)&0xF);
+            rsp_current -> DMEM[BES(addr++ & 0x00000FFF)] = VR_B(vt, (e+i)&0xF);
 #endif
         return;
     } /* Illegal elements with Boss Game Studios publications. */
     switch (addr & 07) {
     case 00:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR_S(vt, e+0x0);
-        *(pi16)(DMEM + addr + HES(0x002)) = VR_S(vt, e+0x2);
-        *(pi16)(DMEM + addr + HES(0x004)) = VR_S(vt, e+0x4);
-        *(pi16)(DMEM + addr + HES(0x006)) = VR_S(vt, e+0x6);
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x000)) = VR_S(vt, e+0x0);
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x002)) = VR_S(vt, e+0x2);
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x004)) = VR_S(vt, e+0x4);
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x006)) = VR_S(vt, e+0x6);
         break;
     case 01: /* "Tetrisphere" audio ucode */
-        *(pi16)(DMEM + addr + 0x000) = VR_S(vt, e+0x0);
-        DMEM[addr + 0x002 - BES(0x000)] = VR_A(vt, e+0x2);
-        DMEM[addr + 0x003 + BES(0x000)] = VR_U(vt, e+0x3);
-        *(pi16)(DMEM + addr + 0x004) = VR_S(vt, e+0x4);
-        DMEM[addr + 0x006 - BES(0x000)] = VR_A(vt, e+0x6);
+        *(pi16)(rsp_current -> DMEM + addr + 0x000) = VR_S(vt, e+0x0);
+        rsp_current -> DMEM[addr + 0x002 - BES(0x000)] = VR_A(vt, e+0x2);
+        rsp_current -> DMEM[addr + 0x003 + BES(0x000)] = VR_U(vt, e+0x3);
+        *(pi16)(rsp_current -> DMEM + addr + 0x004) = VR_S(vt, e+0x4);
+        rsp_current -> DMEM[addr + 0x006 - BES(0x000)] = VR_A(vt, e+0x6);
         addr += 0x007 + BES(0x000);
         addr &= 0x00000FFF;
-        DMEM[addr] = VR_U(vt, e+0x7);
+        rsp_current -> DMEM[addr] = VR_U(vt, e+0x7);
         break;
     case 02:
-        *(pi16)(DMEM + addr + 0x000 - HES(0x000)) = VR_S(vt, e+0x0);
-        *(pi16)(DMEM + addr + 0x002 + HES(0x000)) = VR_S(vt, e+0x2);
-        *(pi16)(DMEM + addr + 0x004 - HES(0x000)) = VR_S(vt, e+0x4);
+        *(pi16)(rsp_current -> DMEM + addr + 0x000 - HES(0x000)) = VR_S(vt, e+0x0);
+        *(pi16)(rsp_current -> DMEM + addr + 0x002 + HES(0x000)) = VR_S(vt, e+0x2);
+        *(pi16)(rsp_current -> DMEM + addr + 0x004 - HES(0x000)) = VR_S(vt, e+0x4);
         addr += 0x006 + HES(0x000);
         addr &= 0x00000FFF;
-        *(pi16)(DMEM + addr) = VR_S(vt, e+0x6);
+        *(pi16)(rsp_current -> DMEM + addr) = VR_S(vt, e+0x6);
         break;
     case 03: /* "Tetrisphere" audio ucode */
-        DMEM[addr + 0x000 - BES(0x000)] = VR_A(vt, e+0x0);
-        DMEM[addr + 0x001 + BES(0x000)] = VR_U(vt, e+0x1);
-        *(pi16)(DMEM + addr + 0x002) = VR_S(vt, e+0x2);
-        DMEM[addr + 0x004 - BES(0x000)] = VR_A(vt, e+0x4);
+        rsp_current -> DMEM[addr + 0x000 - BES(0x000)] = VR_A(vt, e+0x0);
+        rsp_current -> DMEM[addr + 0x001 + BES(0x000)] = VR_U(vt, e+0x1);
+        *(pi16)(rsp_current -> DMEM + addr + 0x002) = VR_S(vt, e+0x2);
+        rsp_current -> DMEM[addr + 0x004 - BES(0x000)] = VR_A(vt, e+0x4);
         addr += 0x005 + BES(0x000);
         addr &= 0x00000FFF;
-        DMEM[addr] = VR_U(vt, e+0x5);
-        *(pi16)(DMEM + addr + 0x001 - BES(0x000)) = VR_S(vt, 0x6);
+        rsp_current -> DMEM[addr] = VR_U(vt, e+0x5);
+        *(pi16)(rsp_current -> DMEM + addr + 0x001 - BES(0x000)) = VR_S(vt, 0x6);
         break;
     case 04:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR_S(vt, e+0x0);
-        *(pi16)(DMEM + addr + HES(0x002)) = VR_S(vt, e+0x2);
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x000)) = VR_S(vt, e+0x0);
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x002)) = VR_S(vt, e+0x2);
         addr = (addr + 0x004) & 0x00000FFF;
-        *(pi16)(DMEM + addr + HES(0x000)) = VR_S(vt, e+0x4);
-        *(pi16)(DMEM + addr + HES(0x002)) = VR_S(vt, e+0x6);
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x000)) = VR_S(vt, e+0x4);
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x002)) = VR_S(vt, e+0x6);
         break;
     case 05: /* "Tetrisphere" audio ucode */
-        *(pi16)(DMEM + addr + 0x000) = VR_S(vt, e+0x0);
-        DMEM[addr + 0x002 - BES(0x000)] = VR_A(vt, e+0x2);
+        *(pi16)(rsp_current -> DMEM + addr + 0x000) = VR_S(vt, e+0x0);
+        rsp_current -> DMEM[addr + 0x002 - BES(0x000)] = VR_A(vt, e+0x2);
         addr = (addr + 0x003) & 0x00000FFF;
-        DMEM[addr + BES(0x000)] = VR_U(vt, e+0x3);
-        *(pi16)(DMEM + addr + 0x001) = VR_S(vt, e+0x4);
-        DMEM[addr + BES(0x003)] = VR_A(vt, e+0x6);
-        DMEM[addr + BES(0x004)] = VR_U(vt, e+0x7);
+        rsp_current -> DMEM[addr + BES(0x000)] = VR_U(vt, e+0x3);
+        *(pi16)(rsp_current -> DMEM + addr + 0x001) = VR_S(vt, e+0x4);
+        rsp_current -> DMEM[addr + BES(0x003)] = VR_A(vt, e+0x6);
+        rsp_current -> DMEM[addr + BES(0x004)] = VR_U(vt, e+0x7);
         break;
     case 06:
-        *(pi16)(DMEM + addr - HES(0x000)) = VR_S(vt, e+0x0);
+        *(pi16)(rsp_current -> DMEM + addr - HES(0x000)) = VR_S(vt, e+0x0);
         addr = (addr + 0x002) & 0x00000FFF;
-        *(pi16)(DMEM + addr + HES(0x000)) = VR_S(vt, e+0x2);
-        *(pi16)(DMEM + addr + HES(0x002)) = VR_S(vt, e+0x4);
-        *(pi16)(DMEM + addr + HES(0x004)) = VR_S(vt, e+0x6);
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x000)) = VR_S(vt, e+0x2);
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x002)) = VR_S(vt, e+0x4);
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x004)) = VR_S(vt, e+0x6);
         break;
     case 07: /* "Tetrisphere" audio ucode */
-        DMEM[addr - BES(0x000)] = VR_A(vt, e+0x0);
+        rsp_current -> DMEM[addr - BES(0x000)] = VR_A(vt, e+0x0);
         addr = (addr + 0x001) & 0x00000FFF;
-        DMEM[addr + BES(0x000)] = VR_U(vt, e+0x1);
-        *(pi16)(DMEM + addr + 0x001) = VR_S(vt, e+0x2);
-        DMEM[addr + BES(0x003)] = VR_A(vt, e+0x4);
-        DMEM[addr + BES(0x004)] = VR_U(vt, e+0x5);
-        *(pi16)(DMEM + addr + 0x005) = VR_S(vt, e+0x6);
+        rsp_current -> DMEM[addr + BES(0x000)] = VR_U(vt, e+0x1);
+        *(pi16)(rsp_current -> DMEM + addr + 0x001) = VR_S(vt, e+0x2);
+        rsp_current -> DMEM[addr + BES(0x003)] = VR_A(vt, e+0x4);
+        rsp_current -> DMEM[addr + BES(0x004)] = VR_U(vt, e+0x5);
+        *(pi16)(rsp_current -> DMEM + addr + 0x005) = VR_S(vt, e+0x6);
         break;
     }
     return;
@@ -870,103 +860,103 @@ void LPV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LPV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 8*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 8*offset) & 0x00000FFF;
     b = addr & 07;
     addr &= ~07;
     switch (b) {
     case 00:
-        VR[vt][07] = DMEM[addr + BES(0x007)] << 8;
-        VR[vt][06] = DMEM[addr + BES(0x006)] << 8;
-        VR[vt][05] = DMEM[addr + BES(0x005)] << 8;
-        VR[vt][04] = DMEM[addr + BES(0x004)] << 8;
-        VR[vt][03] = DMEM[addr + BES(0x003)] << 8;
-        VR[vt][02] = DMEM[addr + BES(0x002)] << 8;
-        VR[vt][01] = DMEM[addr + BES(0x001)] << 8;
-        VR[vt][00] = DMEM[addr + BES(0x000)] << 8;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + BES(0x007)] << 8;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x006)] << 8;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x005)] << 8;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x004)] << 8;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x003)] << 8;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x002)] << 8;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x001)] << 8;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x000)] << 8;
         break;
     case 01: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        VR[vt][00] = DMEM[addr + BES(0x001)] << 8;
-        VR[vt][01] = DMEM[addr + BES(0x002)] << 8;
-        VR[vt][02] = DMEM[addr + BES(0x003)] << 8;
-        VR[vt][03] = DMEM[addr + BES(0x004)] << 8;
-        VR[vt][04] = DMEM[addr + BES(0x005)] << 8;
-        VR[vt][05] = DMEM[addr + BES(0x006)] << 8;
-        VR[vt][06] = DMEM[addr + BES(0x007)] << 8;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x001)] << 8;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x002)] << 8;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x003)] << 8;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x004)] << 8;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x005)] << 8;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x006)] << 8;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x007)] << 8;
         addr += BES(0x008);
         addr &= 0x00000FFF;
-        VR[vt][07] = DMEM[addr] << 8;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr] << 8;
         break;
     case 02: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        VR[vt][00] = DMEM[addr + BES(0x002)] << 8;
-        VR[vt][01] = DMEM[addr + BES(0x003)] << 8;
-        VR[vt][02] = DMEM[addr + BES(0x004)] << 8;
-        VR[vt][03] = DMEM[addr + BES(0x005)] << 8;
-        VR[vt][04] = DMEM[addr + BES(0x006)] << 8;
-        VR[vt][05] = DMEM[addr + BES(0x007)] << 8;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x002)] << 8;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x003)] << 8;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x004)] << 8;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x005)] << 8;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x006)] << 8;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x007)] << 8;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][06] = DMEM[addr + BES(0x000)] << 8;
-        VR[vt][07] = DMEM[addr + BES(0x001)] << 8;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x000)] << 8;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + BES(0x001)] << 8;
         break;
     case 03: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        VR[vt][00] = DMEM[addr + BES(0x003)] << 8;
-        VR[vt][01] = DMEM[addr + BES(0x004)] << 8;
-        VR[vt][02] = DMEM[addr + BES(0x005)] << 8;
-        VR[vt][03] = DMEM[addr + BES(0x006)] << 8;
-        VR[vt][04] = DMEM[addr + BES(0x007)] << 8;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x003)] << 8;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x004)] << 8;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x005)] << 8;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x006)] << 8;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x007)] << 8;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][05] = DMEM[addr + BES(0x000)] << 8;
-        VR[vt][06] = DMEM[addr + BES(0x001)] << 8;
-        VR[vt][07] = DMEM[addr + BES(0x002)] << 8;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x000)] << 8;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x001)] << 8;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + BES(0x002)] << 8;
         break;
     case 04: /* "Resident Evil 2" in-game 3-D, F3DLX 2.08--"WWF No Mercy" */
-        VR[vt][00] = DMEM[addr + BES(0x004)] << 8;
-        VR[vt][01] = DMEM[addr + BES(0x005)] << 8;
-        VR[vt][02] = DMEM[addr + BES(0x006)] << 8;
-        VR[vt][03] = DMEM[addr + BES(0x007)] << 8;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x004)] << 8;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x005)] << 8;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x006)] << 8;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x007)] << 8;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][04] = DMEM[addr + BES(0x000)] << 8;
-        VR[vt][05] = DMEM[addr + BES(0x001)] << 8;
-        VR[vt][06] = DMEM[addr + BES(0x002)] << 8;
-        VR[vt][07] = DMEM[addr + BES(0x003)] << 8;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x000)] << 8;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x001)] << 8;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x002)] << 8;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + BES(0x003)] << 8;
         break;
     case 05: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        VR[vt][00] = DMEM[addr + BES(0x005)] << 8;
-        VR[vt][01] = DMEM[addr + BES(0x006)] << 8;
-        VR[vt][02] = DMEM[addr + BES(0x007)] << 8;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x005)] << 8;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x006)] << 8;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x007)] << 8;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][03] = DMEM[addr + BES(0x000)] << 8;
-        VR[vt][04] = DMEM[addr + BES(0x001)] << 8;
-        VR[vt][05] = DMEM[addr + BES(0x002)] << 8;
-        VR[vt][06] = DMEM[addr + BES(0x003)] << 8;
-        VR[vt][07] = DMEM[addr + BES(0x004)] << 8;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x000)] << 8;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x001)] << 8;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x002)] << 8;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x003)] << 8;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + BES(0x004)] << 8;
         break;
     case 06: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        VR[vt][00] = DMEM[addr + BES(0x006)] << 8;
-        VR[vt][01] = DMEM[addr + BES(0x007)] << 8;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x006)] << 8;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x007)] << 8;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][02] = DMEM[addr + BES(0x000)] << 8;
-        VR[vt][03] = DMEM[addr + BES(0x001)] << 8;
-        VR[vt][04] = DMEM[addr + BES(0x002)] << 8;
-        VR[vt][05] = DMEM[addr + BES(0x003)] << 8;
-        VR[vt][06] = DMEM[addr + BES(0x004)] << 8;
-        VR[vt][07] = DMEM[addr + BES(0x005)] << 8;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x000)] << 8;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x001)] << 8;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x002)] << 8;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x003)] << 8;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x004)] << 8;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + BES(0x005)] << 8;
         break;
     case 07: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        VR[vt][00] = DMEM[addr + BES(0x007)] << 8;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x007)] << 8;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][01] = DMEM[addr + BES(0x000)] << 8;
-        VR[vt][02] = DMEM[addr + BES(0x001)] << 8;
-        VR[vt][03] = DMEM[addr + BES(0x002)] << 8;
-        VR[vt][04] = DMEM[addr + BES(0x003)] << 8;
-        VR[vt][05] = DMEM[addr + BES(0x004)] << 8;
-        VR[vt][06] = DMEM[addr + BES(0x005)] << 8;
-        VR[vt][07] = DMEM[addr + BES(0x006)] << 8;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x000)] << 8;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x001)] << 8;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x002)] << 8;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x003)] << 8;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x004)] << 8;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x005)] << 8;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + BES(0x006)] << 8;
         break;
     }
     return;
@@ -977,11 +967,11 @@ void LUV(unsigned vt, unsigned element, signed offset, unsigned base)
     register unsigned int b;
     const unsigned int e = element;
 
-    addr = (SR[base] + 8*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 8*offset) & 0x00000FFF;
     if (e != 0x0) {
         addr += (~e + 0x1) & 0xF;
         for (b = 0; b < 8; b++) {
-            VR[vt][b] = DMEM[BES(addr &= 0x00000FFF)] << 7;
+            rsp_current -> VR[vt][b] = rsp_current -> DMEM[BES(addr &= 0x00000FFF)] << 7;
             addr -= 16 * (e - b - 1 == 0x0);
             ++addr;
         }
@@ -991,98 +981,98 @@ void LUV(unsigned vt, unsigned element, signed offset, unsigned base)
     addr &= ~07;
     switch (b) {
     case 00:
-        VR[vt][07] = DMEM[addr + BES(0x007)] << 7;
-        VR[vt][06] = DMEM[addr + BES(0x006)] << 7;
-        VR[vt][05] = DMEM[addr + BES(0x005)] << 7;
-        VR[vt][04] = DMEM[addr + BES(0x004)] << 7;
-        VR[vt][03] = DMEM[addr + BES(0x003)] << 7;
-        VR[vt][02] = DMEM[addr + BES(0x002)] << 7;
-        VR[vt][01] = DMEM[addr + BES(0x001)] << 7;
-        VR[vt][00] = DMEM[addr + BES(0x000)] << 7;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + BES(0x007)] << 7;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x006)] << 7;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x005)] << 7;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x004)] << 7;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x003)] << 7;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x002)] << 7;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x001)] << 7;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x000)] << 7;
         break;
     case 01: /* PKMN Puzzle League HVQM decoder */
-        VR[vt][00] = DMEM[addr + BES(0x001)] << 7;
-        VR[vt][01] = DMEM[addr + BES(0x002)] << 7;
-        VR[vt][02] = DMEM[addr + BES(0x003)] << 7;
-        VR[vt][03] = DMEM[addr + BES(0x004)] << 7;
-        VR[vt][04] = DMEM[addr + BES(0x005)] << 7;
-        VR[vt][05] = DMEM[addr + BES(0x006)] << 7;
-        VR[vt][06] = DMEM[addr + BES(0x007)] << 7;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x001)] << 7;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x002)] << 7;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x003)] << 7;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x004)] << 7;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x005)] << 7;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x006)] << 7;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x007)] << 7;
         addr += BES(0x008);
         addr &= 0x00000FFF;
-        VR[vt][07] = DMEM[addr] << 7;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr] << 7;
         break;
     case 02: /* PKMN Puzzle League HVQM decoder */
-        VR[vt][00] = DMEM[addr + BES(0x002)] << 7;
-        VR[vt][01] = DMEM[addr + BES(0x003)] << 7;
-        VR[vt][02] = DMEM[addr + BES(0x004)] << 7;
-        VR[vt][03] = DMEM[addr + BES(0x005)] << 7;
-        VR[vt][04] = DMEM[addr + BES(0x006)] << 7;
-        VR[vt][05] = DMEM[addr + BES(0x007)] << 7;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x002)] << 7;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x003)] << 7;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x004)] << 7;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x005)] << 7;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x006)] << 7;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x007)] << 7;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][06] = DMEM[addr + BES(0x000)] << 7;
-        VR[vt][07] = DMEM[addr + BES(0x001)] << 7;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x000)] << 7;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + BES(0x001)] << 7;
         break;
     case 03: /* PKMN Puzzle League HVQM decoder */
-        VR[vt][00] = DMEM[addr + BES(0x003)] << 7;
-        VR[vt][01] = DMEM[addr + BES(0x004)] << 7;
-        VR[vt][02] = DMEM[addr + BES(0x005)] << 7;
-        VR[vt][03] = DMEM[addr + BES(0x006)] << 7;
-        VR[vt][04] = DMEM[addr + BES(0x007)] << 7;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x003)] << 7;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x004)] << 7;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x005)] << 7;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x006)] << 7;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x007)] << 7;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][05] = DMEM[addr + BES(0x000)] << 7;
-        VR[vt][06] = DMEM[addr + BES(0x001)] << 7;
-        VR[vt][07] = DMEM[addr + BES(0x002)] << 7;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x000)] << 7;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x001)] << 7;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + BES(0x002)] << 7;
         break;
     case 04: /* PKMN Puzzle League HVQM decoder */
-        VR[vt][00] = DMEM[addr + BES(0x004)] << 7;
-        VR[vt][01] = DMEM[addr + BES(0x005)] << 7;
-        VR[vt][02] = DMEM[addr + BES(0x006)] << 7;
-        VR[vt][03] = DMEM[addr + BES(0x007)] << 7;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x004)] << 7;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x005)] << 7;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x006)] << 7;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x007)] << 7;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][04] = DMEM[addr + BES(0x000)] << 7;
-        VR[vt][05] = DMEM[addr + BES(0x001)] << 7;
-        VR[vt][06] = DMEM[addr + BES(0x002)] << 7;
-        VR[vt][07] = DMEM[addr + BES(0x003)] << 7;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x000)] << 7;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x001)] << 7;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x002)] << 7;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + BES(0x003)] << 7;
         break;
     case 05: /* PKMN Puzzle League HVQM decoder */
-        VR[vt][00] = DMEM[addr + BES(0x005)] << 7;
-        VR[vt][01] = DMEM[addr + BES(0x006)] << 7;
-        VR[vt][02] = DMEM[addr + BES(0x007)] << 7;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x005)] << 7;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x006)] << 7;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x007)] << 7;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][03] = DMEM[addr + BES(0x000)] << 7;
-        VR[vt][04] = DMEM[addr + BES(0x001)] << 7;
-        VR[vt][05] = DMEM[addr + BES(0x002)] << 7;
-        VR[vt][06] = DMEM[addr + BES(0x003)] << 7;
-        VR[vt][07] = DMEM[addr + BES(0x004)] << 7;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x000)] << 7;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x001)] << 7;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x002)] << 7;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x003)] << 7;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + BES(0x004)] << 7;
         break;
     case 06: /* PKMN Puzzle League HVQM decoder */
-        VR[vt][00] = DMEM[addr + BES(0x006)] << 7;
-        VR[vt][01] = DMEM[addr + BES(0x007)] << 7;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x006)] << 7;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x007)] << 7;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][02] = DMEM[addr + BES(0x000)] << 7;
-        VR[vt][03] = DMEM[addr + BES(0x001)] << 7;
-        VR[vt][04] = DMEM[addr + BES(0x002)] << 7;
-        VR[vt][05] = DMEM[addr + BES(0x003)] << 7;
-        VR[vt][06] = DMEM[addr + BES(0x004)] << 7;
-        VR[vt][07] = DMEM[addr + BES(0x005)] << 7;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x000)] << 7;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x001)] << 7;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x002)] << 7;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x003)] << 7;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x004)] << 7;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + BES(0x005)] << 7;
         break;
     case 07: /* PKMN Puzzle League HVQM decoder */
-        VR[vt][00] = DMEM[addr + BES(0x007)] << 7;
+        rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + BES(0x007)] << 7;
         addr += 0x008;
         addr &= 0x00000FFF;
-        VR[vt][01] = DMEM[addr + BES(0x000)] << 7;
-        VR[vt][02] = DMEM[addr + BES(0x001)] << 7;
-        VR[vt][03] = DMEM[addr + BES(0x002)] << 7;
-        VR[vt][04] = DMEM[addr + BES(0x003)] << 7;
-        VR[vt][05] = DMEM[addr + BES(0x004)] << 7;
-        VR[vt][06] = DMEM[addr + BES(0x005)] << 7;
-        VR[vt][07] = DMEM[addr + BES(0x006)] << 7;
+        rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + BES(0x000)] << 7;
+        rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + BES(0x001)] << 7;
+        rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + BES(0x002)] << 7;
+        rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + BES(0x003)] << 7;
+        rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + BES(0x004)] << 7;
+        rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + BES(0x005)] << 7;
+        rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + BES(0x006)] << 7;
         break;
     }
     return;
@@ -1097,103 +1087,103 @@ void SPV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("SPV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 8*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 8*offset) & 0x00000FFF;
     b = addr & 07;
     addr &= ~07;
     switch (b) {
     case 00:
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][07] >> 8);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][06] >> 8);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][05] >> 8);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][04] >> 8);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][03] >> 8);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][02] >> 8);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][01] >> 8);
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][00] >> 8);
+        rsp_current -> DMEM[addr + BES(0x007)] = (u8)(rsp_current -> VR[vt][07] >> 8);
+        rsp_current -> DMEM[addr + BES(0x006)] = (u8)(rsp_current -> VR[vt][06] >> 8);
+        rsp_current -> DMEM[addr + BES(0x005)] = (u8)(rsp_current -> VR[vt][05] >> 8);
+        rsp_current -> DMEM[addr + BES(0x004)] = (u8)(rsp_current -> VR[vt][04] >> 8);
+        rsp_current -> DMEM[addr + BES(0x003)] = (u8)(rsp_current -> VR[vt][03] >> 8);
+        rsp_current -> DMEM[addr + BES(0x002)] = (u8)(rsp_current -> VR[vt][02] >> 8);
+        rsp_current -> DMEM[addr + BES(0x001)] = (u8)(rsp_current -> VR[vt][01] >> 8);
+        rsp_current -> DMEM[addr + BES(0x000)] = (u8)(rsp_current -> VR[vt][00] >> 8);
         break;
     case 01: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][00] >> 8);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][01] >> 8);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][02] >> 8);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][03] >> 8);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][04] >> 8);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][05] >> 8);
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][06] >> 8);
+        rsp_current -> DMEM[addr + BES(0x001)] = (u8)(rsp_current -> VR[vt][00] >> 8);
+        rsp_current -> DMEM[addr + BES(0x002)] = (u8)(rsp_current -> VR[vt][01] >> 8);
+        rsp_current -> DMEM[addr + BES(0x003)] = (u8)(rsp_current -> VR[vt][02] >> 8);
+        rsp_current -> DMEM[addr + BES(0x004)] = (u8)(rsp_current -> VR[vt][03] >> 8);
+        rsp_current -> DMEM[addr + BES(0x005)] = (u8)(rsp_current -> VR[vt][04] >> 8);
+        rsp_current -> DMEM[addr + BES(0x006)] = (u8)(rsp_current -> VR[vt][05] >> 8);
+        rsp_current -> DMEM[addr + BES(0x007)] = (u8)(rsp_current -> VR[vt][06] >> 8);
         addr += BES(0x008);
         addr &= 0x00000FFF;
-        DMEM[addr] = (u8)(VR[vt][07] >> 8);
+        rsp_current -> DMEM[addr] = (u8)(rsp_current -> VR[vt][07] >> 8);
         break;
     case 02: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][00] >> 8);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][01] >> 8);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][02] >> 8);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][03] >> 8);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][04] >> 8);
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][05] >> 8);
+        rsp_current -> DMEM[addr + BES(0x002)] = (u8)(rsp_current -> VR[vt][00] >> 8);
+        rsp_current -> DMEM[addr + BES(0x003)] = (u8)(rsp_current -> VR[vt][01] >> 8);
+        rsp_current -> DMEM[addr + BES(0x004)] = (u8)(rsp_current -> VR[vt][02] >> 8);
+        rsp_current -> DMEM[addr + BES(0x005)] = (u8)(rsp_current -> VR[vt][03] >> 8);
+        rsp_current -> DMEM[addr + BES(0x006)] = (u8)(rsp_current -> VR[vt][04] >> 8);
+        rsp_current -> DMEM[addr + BES(0x007)] = (u8)(rsp_current -> VR[vt][05] >> 8);
         addr += 0x008;
         addr &= 0x00000FFF;
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][06] >> 8);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][07] >> 8);
+        rsp_current -> DMEM[addr + BES(0x000)] = (u8)(rsp_current -> VR[vt][06] >> 8);
+        rsp_current -> DMEM[addr + BES(0x001)] = (u8)(rsp_current -> VR[vt][07] >> 8);
         break;
     case 03: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][00] >> 8);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][01] >> 8);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][02] >> 8);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][03] >> 8);
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][04] >> 8);
+        rsp_current -> DMEM[addr + BES(0x003)] = (u8)(rsp_current -> VR[vt][00] >> 8);
+        rsp_current -> DMEM[addr + BES(0x004)] = (u8)(rsp_current -> VR[vt][01] >> 8);
+        rsp_current -> DMEM[addr + BES(0x005)] = (u8)(rsp_current -> VR[vt][02] >> 8);
+        rsp_current -> DMEM[addr + BES(0x006)] = (u8)(rsp_current -> VR[vt][03] >> 8);
+        rsp_current -> DMEM[addr + BES(0x007)] = (u8)(rsp_current -> VR[vt][04] >> 8);
         addr += 0x008;
         addr &= 0x00000FFF;
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][05] >> 8);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][06] >> 8);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][07] >> 8);
+        rsp_current -> DMEM[addr + BES(0x000)] = (u8)(rsp_current -> VR[vt][05] >> 8);
+        rsp_current -> DMEM[addr + BES(0x001)] = (u8)(rsp_current -> VR[vt][06] >> 8);
+        rsp_current -> DMEM[addr + BES(0x002)] = (u8)(rsp_current -> VR[vt][07] >> 8);
         break;
     case 04: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][00] >> 8);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][01] >> 8);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][02] >> 8);
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][03] >> 8);
+        rsp_current -> DMEM[addr + BES(0x004)] = (u8)(rsp_current -> VR[vt][00] >> 8);
+        rsp_current -> DMEM[addr + BES(0x005)] = (u8)(rsp_current -> VR[vt][01] >> 8);
+        rsp_current -> DMEM[addr + BES(0x006)] = (u8)(rsp_current -> VR[vt][02] >> 8);
+        rsp_current -> DMEM[addr + BES(0x007)] = (u8)(rsp_current -> VR[vt][03] >> 8);
         addr += 0x008;
         addr &= 0x00000FFF;
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][04] >> 8);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][05] >> 8);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][06] >> 8);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][07] >> 8);
+        rsp_current -> DMEM[addr + BES(0x000)] = (u8)(rsp_current -> VR[vt][04] >> 8);
+        rsp_current -> DMEM[addr + BES(0x001)] = (u8)(rsp_current -> VR[vt][05] >> 8);
+        rsp_current -> DMEM[addr + BES(0x002)] = (u8)(rsp_current -> VR[vt][06] >> 8);
+        rsp_current -> DMEM[addr + BES(0x003)] = (u8)(rsp_current -> VR[vt][07] >> 8);
         break;
     case 05: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][00] >> 8);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][01] >> 8);
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][02] >> 8);
+        rsp_current -> DMEM[addr + BES(0x005)] = (u8)(rsp_current -> VR[vt][00] >> 8);
+        rsp_current -> DMEM[addr + BES(0x006)] = (u8)(rsp_current -> VR[vt][01] >> 8);
+        rsp_current -> DMEM[addr + BES(0x007)] = (u8)(rsp_current -> VR[vt][02] >> 8);
         addr += 0x008;
         addr &= 0x00000FFF;
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][03] >> 8);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][04] >> 8);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][05] >> 8);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][06] >> 8);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][07] >> 8);
+        rsp_current -> DMEM[addr + BES(0x000)] = (u8)(rsp_current -> VR[vt][03] >> 8);
+        rsp_current -> DMEM[addr + BES(0x001)] = (u8)(rsp_current -> VR[vt][04] >> 8);
+        rsp_current -> DMEM[addr + BES(0x002)] = (u8)(rsp_current -> VR[vt][05] >> 8);
+        rsp_current -> DMEM[addr + BES(0x003)] = (u8)(rsp_current -> VR[vt][06] >> 8);
+        rsp_current -> DMEM[addr + BES(0x004)] = (u8)(rsp_current -> VR[vt][07] >> 8);
         break;
     case 06: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][00] >> 8);
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][01] >> 8);
+        rsp_current -> DMEM[addr + BES(0x006)] = (u8)(rsp_current -> VR[vt][00] >> 8);
+        rsp_current -> DMEM[addr + BES(0x007)] = (u8)(rsp_current -> VR[vt][01] >> 8);
         addr += 0x008;
         addr &= 0x00000FFF;
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][02] >> 8);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][03] >> 8);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][04] >> 8);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][05] >> 8);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][06] >> 8);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][07] >> 8);
+        rsp_current -> DMEM[addr + BES(0x000)] = (u8)(rsp_current -> VR[vt][02] >> 8);
+        rsp_current -> DMEM[addr + BES(0x001)] = (u8)(rsp_current -> VR[vt][03] >> 8);
+        rsp_current -> DMEM[addr + BES(0x002)] = (u8)(rsp_current -> VR[vt][04] >> 8);
+        rsp_current -> DMEM[addr + BES(0x003)] = (u8)(rsp_current -> VR[vt][05] >> 8);
+        rsp_current -> DMEM[addr + BES(0x004)] = (u8)(rsp_current -> VR[vt][06] >> 8);
+        rsp_current -> DMEM[addr + BES(0x005)] = (u8)(rsp_current -> VR[vt][07] >> 8);
         break;
     case 07: /* F3DZEX 2.08J "Doubutsu no Mori" (Animal Forest) CPU CFB */
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][00] >> 8);
+        rsp_current -> DMEM[addr + BES(0x007)] = (u8)(rsp_current -> VR[vt][00] >> 8);
         addr += 0x008;
         addr &= 0x00000FFF;
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][01] >> 8);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][02] >> 8);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][03] >> 8);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][04] >> 8);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][05] >> 8);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][06] >> 8);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][07] >> 8);
+        rsp_current -> DMEM[addr + BES(0x000)] = (u8)(rsp_current -> VR[vt][01] >> 8);
+        rsp_current -> DMEM[addr + BES(0x001)] = (u8)(rsp_current -> VR[vt][02] >> 8);
+        rsp_current -> DMEM[addr + BES(0x002)] = (u8)(rsp_current -> VR[vt][03] >> 8);
+        rsp_current -> DMEM[addr + BES(0x003)] = (u8)(rsp_current -> VR[vt][04] >> 8);
+        rsp_current -> DMEM[addr + BES(0x004)] = (u8)(rsp_current -> VR[vt][05] >> 8);
+        rsp_current -> DMEM[addr + BES(0x005)] = (u8)(rsp_current -> VR[vt][06] >> 8);
+        rsp_current -> DMEM[addr + BES(0x006)] = (u8)(rsp_current -> VR[vt][07] >> 8);
         break;
     }
     return;
@@ -1208,31 +1198,31 @@ void SUV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("SUV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 8*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 8*offset) & 0x00000FFF;
     b = addr & 07;
     addr &= ~07;
     switch (b) {
     case 00:
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][07] >> 7);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][06] >> 7);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][05] >> 7);
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][04] >> 7);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][03] >> 7);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][02] >> 7);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][01] >> 7);
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][00] >> 7);
+        rsp_current -> DMEM[addr + BES(0x007)] = (u8)(rsp_current -> VR[vt][07] >> 7);
+        rsp_current -> DMEM[addr + BES(0x006)] = (u8)(rsp_current -> VR[vt][06] >> 7);
+        rsp_current -> DMEM[addr + BES(0x005)] = (u8)(rsp_current -> VR[vt][05] >> 7);
+        rsp_current -> DMEM[addr + BES(0x004)] = (u8)(rsp_current -> VR[vt][04] >> 7);
+        rsp_current -> DMEM[addr + BES(0x003)] = (u8)(rsp_current -> VR[vt][03] >> 7);
+        rsp_current -> DMEM[addr + BES(0x002)] = (u8)(rsp_current -> VR[vt][02] >> 7);
+        rsp_current -> DMEM[addr + BES(0x001)] = (u8)(rsp_current -> VR[vt][01] >> 7);
+        rsp_current -> DMEM[addr + BES(0x000)] = (u8)(rsp_current -> VR[vt][00] >> 7);
         break;
     case 04: /* "Indiana Jones and the Infernal Machine" in-game */
-        DMEM[addr + BES(0x004)] = (u8)(VR[vt][00] >> 7);
-        DMEM[addr + BES(0x005)] = (u8)(VR[vt][01] >> 7);
-        DMEM[addr + BES(0x006)] = (u8)(VR[vt][02] >> 7);
-        DMEM[addr + BES(0x007)] = (u8)(VR[vt][03] >> 7);
+        rsp_current -> DMEM[addr + BES(0x004)] = (u8)(rsp_current -> VR[vt][00] >> 7);
+        rsp_current -> DMEM[addr + BES(0x005)] = (u8)(rsp_current -> VR[vt][01] >> 7);
+        rsp_current -> DMEM[addr + BES(0x006)] = (u8)(rsp_current -> VR[vt][02] >> 7);
+        rsp_current -> DMEM[addr + BES(0x007)] = (u8)(rsp_current -> VR[vt][03] >> 7);
         addr += 0x008;
         addr &= 0x00000FFF;
-        DMEM[addr + BES(0x000)] = (u8)(VR[vt][04] >> 7);
-        DMEM[addr + BES(0x001)] = (u8)(VR[vt][05] >> 7);
-        DMEM[addr + BES(0x002)] = (u8)(VR[vt][06] >> 7);
-        DMEM[addr + BES(0x003)] = (u8)(VR[vt][07] >> 7);
+        rsp_current -> DMEM[addr + BES(0x000)] = (u8)(rsp_current -> VR[vt][04] >> 7);
+        rsp_current -> DMEM[addr + BES(0x001)] = (u8)(rsp_current -> VR[vt][05] >> 7);
+        rsp_current -> DMEM[addr + BES(0x002)] = (u8)(rsp_current -> VR[vt][06] >> 7);
+        rsp_current -> DMEM[addr + BES(0x003)] = (u8)(rsp_current -> VR[vt][07] >> 7);
         break;
     default: /* Completely legal, just never seen it be done. */
         message("SUV\nWeird addr.");
@@ -1253,20 +1243,20 @@ void LHV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LHV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 16*offset) & 0x00000FFF;
     if (addr & 0x0000000E) {
         message("LHV\nIllegal addr.");
         return;
     }
     addr ^= MES(00);
-    VR[vt][07] = DMEM[addr + HES(0x00E)] << 7;
-    VR[vt][06] = DMEM[addr + HES(0x00C)] << 7;
-    VR[vt][05] = DMEM[addr + HES(0x00A)] << 7;
-    VR[vt][04] = DMEM[addr + HES(0x008)] << 7;
-    VR[vt][03] = DMEM[addr + HES(0x006)] << 7;
-    VR[vt][02] = DMEM[addr + HES(0x004)] << 7;
-    VR[vt][01] = DMEM[addr + HES(0x002)] << 7;
-    VR[vt][00] = DMEM[addr + HES(0x000)] << 7;
+    rsp_current -> VR[vt][07] = rsp_current -> DMEM[addr + HES(0x00E)] << 7;
+    rsp_current -> VR[vt][06] = rsp_current -> DMEM[addr + HES(0x00C)] << 7;
+    rsp_current -> VR[vt][05] = rsp_current -> DMEM[addr + HES(0x00A)] << 7;
+    rsp_current -> VR[vt][04] = rsp_current -> DMEM[addr + HES(0x008)] << 7;
+    rsp_current -> VR[vt][03] = rsp_current -> DMEM[addr + HES(0x006)] << 7;
+    rsp_current -> VR[vt][02] = rsp_current -> DMEM[addr + HES(0x004)] << 7;
+    rsp_current -> VR[vt][01] = rsp_current -> DMEM[addr + HES(0x002)] << 7;
+    rsp_current -> VR[vt][00] = rsp_current -> DMEM[addr + HES(0x000)] << 7;
     return;
 }
 void LFV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -1283,20 +1273,20 @@ void SHV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("SHV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 16*offset) & 0x00000FFF;
     if (addr & 0x0000000E) {
         message("SHV\nIllegal addr.");
         return;
     }
     addr ^= MES(00);
-    DMEM[addr + HES(0x00E)] = (u8)(VR[vt][07] >> 7);
-    DMEM[addr + HES(0x00C)] = (u8)(VR[vt][06] >> 7);
-    DMEM[addr + HES(0x00A)] = (u8)(VR[vt][05] >> 7);
-    DMEM[addr + HES(0x008)] = (u8)(VR[vt][04] >> 7);
-    DMEM[addr + HES(0x006)] = (u8)(VR[vt][03] >> 7);
-    DMEM[addr + HES(0x004)] = (u8)(VR[vt][02] >> 7);
-    DMEM[addr + HES(0x002)] = (u8)(VR[vt][01] >> 7);
-    DMEM[addr + HES(0x000)] = (u8)(VR[vt][00] >> 7);
+    rsp_current -> DMEM[addr + HES(0x00E)] = (u8)(rsp_current -> VR[vt][07] >> 7);
+    rsp_current -> DMEM[addr + HES(0x00C)] = (u8)(rsp_current -> VR[vt][06] >> 7);
+    rsp_current -> DMEM[addr + HES(0x00A)] = (u8)(rsp_current -> VR[vt][05] >> 7);
+    rsp_current -> DMEM[addr + HES(0x008)] = (u8)(rsp_current -> VR[vt][04] >> 7);
+    rsp_current -> DMEM[addr + HES(0x006)] = (u8)(rsp_current -> VR[vt][03] >> 7);
+    rsp_current -> DMEM[addr + HES(0x004)] = (u8)(rsp_current -> VR[vt][02] >> 7);
+    rsp_current -> DMEM[addr + HES(0x002)] = (u8)(rsp_current -> VR[vt][01] >> 7);
+    rsp_current -> DMEM[addr + HES(0x000)] = (u8)(rsp_current -> VR[vt][00] >> 7);
     return;
 }
 void SFV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -1304,21 +1294,21 @@ void SFV(unsigned vt, unsigned element, signed offset, unsigned base)
     register u32 addr;
     const unsigned int e = element;
 
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 16*offset) & 0x00000FFF;
     addr &= 0x00000FF3;
     addr ^= BES(00);
     switch (e) {
     case 0x0:
-        DMEM[addr + 0x000] = (u8)(VR[vt][00] >> 7);
-        DMEM[addr + 0x004] = (u8)(VR[vt][01] >> 7);
-        DMEM[addr + 0x008] = (u8)(VR[vt][02] >> 7);
-        DMEM[addr + 0x00C] = (u8)(VR[vt][03] >> 7);
+        rsp_current -> DMEM[addr + 0x000] = (u8)(rsp_current -> VR[vt][00] >> 7);
+        rsp_current -> DMEM[addr + 0x004] = (u8)(rsp_current -> VR[vt][01] >> 7);
+        rsp_current -> DMEM[addr + 0x008] = (u8)(rsp_current -> VR[vt][02] >> 7);
+        rsp_current -> DMEM[addr + 0x00C] = (u8)(rsp_current -> VR[vt][03] >> 7);
         break;
     case 0x8:
-        DMEM[addr + 0x000] = (u8)(VR[vt][04] >> 7);
-        DMEM[addr + 0x004] = (u8)(VR[vt][05] >> 7);
-        DMEM[addr + 0x008] = (u8)(VR[vt][06] >> 7);
-        DMEM[addr + 0x00C] = (u8)(VR[vt][07] >> 7);
+        rsp_current -> DMEM[addr + 0x000] = (u8)(rsp_current -> VR[vt][04] >> 7);
+        rsp_current -> DMEM[addr + 0x004] = (u8)(rsp_current -> VR[vt][05] >> 7);
+        rsp_current -> DMEM[addr + 0x008] = (u8)(rsp_current -> VR[vt][06] >> 7);
+        rsp_current -> DMEM[addr + 0x00C] = (u8)(rsp_current -> VR[vt][07] >> 7);
         break;
     default:
         message("SFV\nIllegal element.");
@@ -1340,7 +1330,7 @@ void LQV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LQV\nOdd element.");
         return;
     }
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 16*offset) & 0x00000FFF;
     if (addr & 0x00000001) {
         message("LQV\nOdd addr.");
         return;
@@ -1350,56 +1340,56 @@ void LQV(unsigned vt, unsigned element, signed offset, unsigned base)
     addr &= ~0x0000000F;
     switch (b/2) { /* mistake in SGI patent regarding LQV */
     case 0x0/2:
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x000));
-        VR_S(vt,e+0x2) = *(pi16)(DMEM + addr + HES(0x002));
-        VR_S(vt,e+0x4) = *(pi16)(DMEM + addr + HES(0x004));
-        VR_S(vt,e+0x6) = *(pi16)(DMEM + addr + HES(0x006));
-        VR_S(vt,e+0x8) = *(pi16)(DMEM + addr + HES(0x008));
-        VR_S(vt,e+0xA) = *(pi16)(DMEM + addr + HES(0x00A));
-        VR_S(vt,e+0xC) = *(pi16)(DMEM + addr + HES(0x00C));
-        VR_S(vt,e+0xE) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(rsp_current -> DMEM + addr + HES(0x000));
+        VR_S(vt,e+0x2) = *(pi16)(rsp_current -> DMEM + addr + HES(0x002));
+        VR_S(vt,e+0x4) = *(pi16)(rsp_current -> DMEM + addr + HES(0x004));
+        VR_S(vt,e+0x6) = *(pi16)(rsp_current -> DMEM + addr + HES(0x006));
+        VR_S(vt,e+0x8) = *(pi16)(rsp_current -> DMEM + addr + HES(0x008));
+        VR_S(vt,e+0xA) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00A));
+        VR_S(vt,e+0xC) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00C));
+        VR_S(vt,e+0xE) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00E));
         break;
     case 0x2/2:
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x002));
-        VR_S(vt,e+0x2) = *(pi16)(DMEM + addr + HES(0x004));
-        VR_S(vt,e+0x4) = *(pi16)(DMEM + addr + HES(0x006));
-        VR_S(vt,e+0x6) = *(pi16)(DMEM + addr + HES(0x008));
-        VR_S(vt,e+0x8) = *(pi16)(DMEM + addr + HES(0x00A));
-        VR_S(vt,e+0xA) = *(pi16)(DMEM + addr + HES(0x00C));
-        VR_S(vt,e+0xC) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(rsp_current -> DMEM + addr + HES(0x002));
+        VR_S(vt,e+0x2) = *(pi16)(rsp_current -> DMEM + addr + HES(0x004));
+        VR_S(vt,e+0x4) = *(pi16)(rsp_current -> DMEM + addr + HES(0x006));
+        VR_S(vt,e+0x6) = *(pi16)(rsp_current -> DMEM + addr + HES(0x008));
+        VR_S(vt,e+0x8) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00A));
+        VR_S(vt,e+0xA) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00C));
+        VR_S(vt,e+0xC) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00E));
         break;
     case 0x4/2:
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x004));
-        VR_S(vt,e+0x2) = *(pi16)(DMEM + addr + HES(0x006));
-        VR_S(vt,e+0x4) = *(pi16)(DMEM + addr + HES(0x008));
-        VR_S(vt,e+0x6) = *(pi16)(DMEM + addr + HES(0x00A));
-        VR_S(vt,e+0x8) = *(pi16)(DMEM + addr + HES(0x00C));
-        VR_S(vt,e+0xA) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(rsp_current -> DMEM + addr + HES(0x004));
+        VR_S(vt,e+0x2) = *(pi16)(rsp_current -> DMEM + addr + HES(0x006));
+        VR_S(vt,e+0x4) = *(pi16)(rsp_current -> DMEM + addr + HES(0x008));
+        VR_S(vt,e+0x6) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00A));
+        VR_S(vt,e+0x8) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00C));
+        VR_S(vt,e+0xA) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00E));
         break;
     case 0x6/2:
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x006));
-        VR_S(vt,e+0x2) = *(pi16)(DMEM + addr + HES(0x008));
-        VR_S(vt,e+0x4) = *(pi16)(DMEM + addr + HES(0x00A));
-        VR_S(vt,e+0x6) = *(pi16)(DMEM + addr + HES(0x00C));
-        VR_S(vt,e+0x8) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(rsp_current -> DMEM + addr + HES(0x006));
+        VR_S(vt,e+0x2) = *(pi16)(rsp_current -> DMEM + addr + HES(0x008));
+        VR_S(vt,e+0x4) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00A));
+        VR_S(vt,e+0x6) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00C));
+        VR_S(vt,e+0x8) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00E));
         break;
     case 0x8/2: /* "Resident Evil 2" cinematics and Boss Game Studios */
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x008));
-        VR_S(vt,e+0x2) = *(pi16)(DMEM + addr + HES(0x00A));
-        VR_S(vt,e+0x4) = *(pi16)(DMEM + addr + HES(0x00C));
-        VR_S(vt,e+0x6) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(rsp_current -> DMEM + addr + HES(0x008));
+        VR_S(vt,e+0x2) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00A));
+        VR_S(vt,e+0x4) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00C));
+        VR_S(vt,e+0x6) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00E));
         break;
     case 0xA/2: /* "Conker's Bad Fur Day" audio microcode by Rareware */
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x00A));
-        VR_S(vt,e+0x2) = *(pi16)(DMEM + addr + HES(0x00C));
-        VR_S(vt,e+0x4) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00A));
+        VR_S(vt,e+0x2) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00C));
+        VR_S(vt,e+0x4) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00E));
         break;
     case 0xC/2: /* "Conker's Bad Fur Day" audio microcode by Rareware */
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x00C));
-        VR_S(vt,e+0x2) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00C));
+        VR_S(vt,e+0x2) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00E));
         break;
     case 0xE/2: /* "Conker's Bad Fur Day" audio microcode by Rareware */
-        VR_S(vt,e+0x0) = *(pi16)(DMEM + addr + HES(0x00E));
+        VR_S(vt,e+0x0) = *(pi16)(rsp_current -> DMEM + addr + HES(0x00E));
         break;
     }
     return;
@@ -1414,7 +1404,7 @@ void LRV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LRV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 16*offset) & 0x00000FFF;
     if (addr & 0x00000001) {
         message("LRV\nOdd addr.");
         return;
@@ -1423,46 +1413,46 @@ void LRV(unsigned vt, unsigned element, signed offset, unsigned base)
     addr &= ~0x0000000F;
     switch (b/2) {
     case 0xE/2:
-        VR[vt][01] = *(pi16)(DMEM + addr + HES(0x000));
-        VR[vt][02] = *(pi16)(DMEM + addr + HES(0x002));
-        VR[vt][03] = *(pi16)(DMEM + addr + HES(0x004));
-        VR[vt][04] = *(pi16)(DMEM + addr + HES(0x006));
-        VR[vt][05] = *(pi16)(DMEM + addr + HES(0x008));
-        VR[vt][06] = *(pi16)(DMEM + addr + HES(0x00A));
-        VR[vt][07] = *(pi16)(DMEM + addr + HES(0x00C));
+        rsp_current -> VR[vt][01] = *(pi16)(rsp_current -> DMEM + addr + HES(0x000));
+        rsp_current -> VR[vt][02] = *(pi16)(rsp_current -> DMEM + addr + HES(0x002));
+        rsp_current -> VR[vt][03] = *(pi16)(rsp_current -> DMEM + addr + HES(0x004));
+        rsp_current -> VR[vt][04] = *(pi16)(rsp_current -> DMEM + addr + HES(0x006));
+        rsp_current -> VR[vt][05] = *(pi16)(rsp_current -> DMEM + addr + HES(0x008));
+        rsp_current -> VR[vt][06] = *(pi16)(rsp_current -> DMEM + addr + HES(0x00A));
+        rsp_current -> VR[vt][07] = *(pi16)(rsp_current -> DMEM + addr + HES(0x00C));
         break;
     case 0xC/2:
-        VR[vt][02] = *(pi16)(DMEM + addr + HES(0x000));
-        VR[vt][03] = *(pi16)(DMEM + addr + HES(0x002));
-        VR[vt][04] = *(pi16)(DMEM + addr + HES(0x004));
-        VR[vt][05] = *(pi16)(DMEM + addr + HES(0x006));
-        VR[vt][06] = *(pi16)(DMEM + addr + HES(0x008));
-        VR[vt][07] = *(pi16)(DMEM + addr + HES(0x00A));
+        rsp_current -> VR[vt][02] = *(pi16)(rsp_current -> DMEM + addr + HES(0x000));
+        rsp_current -> VR[vt][03] = *(pi16)(rsp_current -> DMEM + addr + HES(0x002));
+        rsp_current -> VR[vt][04] = *(pi16)(rsp_current -> DMEM + addr + HES(0x004));
+        rsp_current -> VR[vt][05] = *(pi16)(rsp_current -> DMEM + addr + HES(0x006));
+        rsp_current -> VR[vt][06] = *(pi16)(rsp_current -> DMEM + addr + HES(0x008));
+        rsp_current -> VR[vt][07] = *(pi16)(rsp_current -> DMEM + addr + HES(0x00A));
         break;
     case 0xA/2:
-        VR[vt][03] = *(pi16)(DMEM + addr + HES(0x000));
-        VR[vt][04] = *(pi16)(DMEM + addr + HES(0x002));
-        VR[vt][05] = *(pi16)(DMEM + addr + HES(0x004));
-        VR[vt][06] = *(pi16)(DMEM + addr + HES(0x006));
-        VR[vt][07] = *(pi16)(DMEM + addr + HES(0x008));
+        rsp_current -> VR[vt][03] = *(pi16)(rsp_current -> DMEM + addr + HES(0x000));
+        rsp_current -> VR[vt][04] = *(pi16)(rsp_current -> DMEM + addr + HES(0x002));
+        rsp_current -> VR[vt][05] = *(pi16)(rsp_current -> DMEM + addr + HES(0x004));
+        rsp_current -> VR[vt][06] = *(pi16)(rsp_current -> DMEM + addr + HES(0x006));
+        rsp_current -> VR[vt][07] = *(pi16)(rsp_current -> DMEM + addr + HES(0x008));
         break;
     case 0x8/2:
-        VR[vt][04] = *(pi16)(DMEM + addr + HES(0x000));
-        VR[vt][05] = *(pi16)(DMEM + addr + HES(0x002));
-        VR[vt][06] = *(pi16)(DMEM + addr + HES(0x004));
-        VR[vt][07] = *(pi16)(DMEM + addr + HES(0x006));
+        rsp_current -> VR[vt][04] = *(pi16)(rsp_current -> DMEM + addr + HES(0x000));
+        rsp_current -> VR[vt][05] = *(pi16)(rsp_current -> DMEM + addr + HES(0x002));
+        rsp_current -> VR[vt][06] = *(pi16)(rsp_current -> DMEM + addr + HES(0x004));
+        rsp_current -> VR[vt][07] = *(pi16)(rsp_current -> DMEM + addr + HES(0x006));
         break;
     case 0x6/2:
-        VR[vt][05] = *(pi16)(DMEM + addr + HES(0x000));
-        VR[vt][06] = *(pi16)(DMEM + addr + HES(0x002));
-        VR[vt][07] = *(pi16)(DMEM + addr + HES(0x004));
+        rsp_current -> VR[vt][05] = *(pi16)(rsp_current -> DMEM + addr + HES(0x000));
+        rsp_current -> VR[vt][06] = *(pi16)(rsp_current -> DMEM + addr + HES(0x002));
+        rsp_current -> VR[vt][07] = *(pi16)(rsp_current -> DMEM + addr + HES(0x004));
         break;
     case 0x4/2:
-        VR[vt][06] = *(pi16)(DMEM + addr + HES(0x000));
-        VR[vt][07] = *(pi16)(DMEM + addr + HES(0x002));
+        rsp_current -> VR[vt][06] = *(pi16)(rsp_current -> DMEM + addr + HES(0x000));
+        rsp_current -> VR[vt][07] = *(pi16)(rsp_current -> DMEM + addr + HES(0x002));
         break;
     case 0x2/2:
-        VR[vt][07] = *(pi16)(DMEM + addr + HES(0x000));
+        rsp_current -> VR[vt][07] = *(pi16)(rsp_current -> DMEM + addr + HES(0x000));
         break;
     case 0x0/2:
         break;
@@ -1475,17 +1465,17 @@ void SQV(unsigned vt, unsigned element, signed offset, unsigned base)
     register unsigned int b;
     const unsigned int e = element;
 
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 16*offset) & 0x00000FFF;
     if (e != 0x0) {
         register unsigned int i;
 
 #if (VR_STATIC_WRAPAROUND == 1)
-        vector_copy(VR[vt] + N, VR[vt]);
+        vector_copy(rsp_current -> VR[vt] + N, rsp_current -> VR[vt]);
         for (i = 0; i < 16 - addr%16; i++)
-            DMEM[BES((addr + i) & 0xFFF)] = VR_B(vt, e + i);
+            rsp_current -> DMEM[BES((addr + i) & 0xFFF)] = VR_B(vt, e + i);
 #else
         for (i = 0; i < 16 - addr%16; i++)
-            DMEM[BES((addr + i) & 0xFFF)] = VR_B(vt, (e + i) & 0xF);
+            rsp_current -> DMEM[BES((addr + i) & 0xFFF)] = VR_B(vt, (e + i) & 0xF);
 #endif
         return;
     } /* illegal SQV, happens with "Mia Hamm Soccer 64" */
@@ -1493,38 +1483,38 @@ void SQV(unsigned vt, unsigned element, signed offset, unsigned base)
     addr &= ~0x0000000F;
     switch (b) {
     case 00:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][00];
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][01];
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][02];
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][03];
-        *(pi16)(DMEM + addr + HES(0x008)) = VR[vt][04];
-        *(pi16)(DMEM + addr + HES(0x00A)) = VR[vt][05];
-        *(pi16)(DMEM + addr + HES(0x00C)) = VR[vt][06];
-        *(pi16)(DMEM + addr + HES(0x00E)) = VR[vt][07];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x000)) = rsp_current -> VR[vt][00];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x002)) = rsp_current -> VR[vt][01];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x004)) = rsp_current -> VR[vt][02];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x006)) = rsp_current -> VR[vt][03];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x008)) = rsp_current -> VR[vt][04];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00A)) = rsp_current -> VR[vt][05];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00C)) = rsp_current -> VR[vt][06];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00E)) = rsp_current -> VR[vt][07];
         break;
     case 02:
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][00];
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][01];
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][02];
-        *(pi16)(DMEM + addr + HES(0x008)) = VR[vt][03];
-        *(pi16)(DMEM + addr + HES(0x00A)) = VR[vt][04];
-        *(pi16)(DMEM + addr + HES(0x00C)) = VR[vt][05];
-        *(pi16)(DMEM + addr + HES(0x00E)) = VR[vt][06];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x002)) = rsp_current -> VR[vt][00];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x004)) = rsp_current -> VR[vt][01];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x006)) = rsp_current -> VR[vt][02];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x008)) = rsp_current -> VR[vt][03];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00A)) = rsp_current -> VR[vt][04];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00C)) = rsp_current -> VR[vt][05];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00E)) = rsp_current -> VR[vt][06];
         break;
     case 04:
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][00];
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][01];
-        *(pi16)(DMEM + addr + HES(0x008)) = VR[vt][02];
-        *(pi16)(DMEM + addr + HES(0x00A)) = VR[vt][03];
-        *(pi16)(DMEM + addr + HES(0x00C)) = VR[vt][04];
-        *(pi16)(DMEM + addr + HES(0x00E)) = VR[vt][05];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x004)) = rsp_current -> VR[vt][00];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x006)) = rsp_current -> VR[vt][01];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x008)) = rsp_current -> VR[vt][02];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00A)) = rsp_current -> VR[vt][03];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00C)) = rsp_current -> VR[vt][04];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00E)) = rsp_current -> VR[vt][05];
         break;
     case 06:
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][00];
-        *(pi16)(DMEM + addr + HES(0x008)) = VR[vt][01];
-        *(pi16)(DMEM + addr + HES(0x00A)) = VR[vt][02];
-        *(pi16)(DMEM + addr + HES(0x00C)) = VR[vt][03];
-        *(pi16)(DMEM + addr + HES(0x00E)) = VR[vt][04];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x006)) = rsp_current -> VR[vt][00];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x008)) = rsp_current -> VR[vt][01];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00A)) = rsp_current -> VR[vt][02];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00C)) = rsp_current -> VR[vt][03];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00E)) = rsp_current -> VR[vt][04];
         break;
     default:
         message("SQV\nWeird addr.");
@@ -1541,7 +1531,7 @@ void SRV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("SRV\nIllegal element.");
         return;
     }
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 16*offset) & 0x00000FFF;
     if (addr & 0x00000001) {
         message("SRV\nOdd addr.");
         return;
@@ -1551,46 +1541,46 @@ void SRV(unsigned vt, unsigned element, signed offset, unsigned base)
     addr &= ~0x0000000F;
     switch (b/2) {
     case 0xE/2:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][01];
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][02];
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][03];
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][04];
-        *(pi16)(DMEM + addr + HES(0x008)) = VR[vt][05];
-        *(pi16)(DMEM + addr + HES(0x00A)) = VR[vt][06];
-        *(pi16)(DMEM + addr + HES(0x00C)) = VR[vt][07];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x000)) = rsp_current -> VR[vt][01];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x002)) = rsp_current -> VR[vt][02];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x004)) = rsp_current -> VR[vt][03];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x006)) = rsp_current -> VR[vt][04];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x008)) = rsp_current -> VR[vt][05];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00A)) = rsp_current -> VR[vt][06];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00C)) = rsp_current -> VR[vt][07];
         break;
     case 0xC/2:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][02];
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][03];
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][04];
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][05];
-        *(pi16)(DMEM + addr + HES(0x008)) = VR[vt][06];
-        *(pi16)(DMEM + addr + HES(0x00A)) = VR[vt][07];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x000)) = rsp_current -> VR[vt][02];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x002)) = rsp_current -> VR[vt][03];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x004)) = rsp_current -> VR[vt][04];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x006)) = rsp_current -> VR[vt][05];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x008)) = rsp_current -> VR[vt][06];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x00A)) = rsp_current -> VR[vt][07];
         break;
     case 0xA/2:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][03];
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][04];
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][05];
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][06];
-        *(pi16)(DMEM + addr + HES(0x008)) = VR[vt][07];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x000)) = rsp_current -> VR[vt][03];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x002)) = rsp_current -> VR[vt][04];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x004)) = rsp_current -> VR[vt][05];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x006)) = rsp_current -> VR[vt][06];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x008)) = rsp_current -> VR[vt][07];
         break;
     case 0x8/2:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][04];
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][05];
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][06];
-        *(pi16)(DMEM + addr + HES(0x006)) = VR[vt][07];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x000)) = rsp_current -> VR[vt][04];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x002)) = rsp_current -> VR[vt][05];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x004)) = rsp_current -> VR[vt][06];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x006)) = rsp_current -> VR[vt][07];
         break;
     case 0x6/2:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][05];
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][06];
-        *(pi16)(DMEM + addr + HES(0x004)) = VR[vt][07];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x000)) = rsp_current -> VR[vt][05];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x002)) = rsp_current -> VR[vt][06];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x004)) = rsp_current -> VR[vt][07];
         break;
     case 0x4/2:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][06];
-        *(pi16)(DMEM + addr + HES(0x002)) = VR[vt][07];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x000)) = rsp_current -> VR[vt][06];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x002)) = rsp_current -> VR[vt][07];
         break;
     case 0x2/2:
-        *(pi16)(DMEM + addr + HES(0x000)) = VR[vt][07];
+        *(pi16)(rsp_current -> DMEM + addr + HES(0x000)) = rsp_current -> VR[vt][07];
         break;
     case 0x0/2:
         break;
@@ -1616,13 +1606,13 @@ void LTV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("LTV\nUncertain case!");
         return; /* For LTV I am not sure; for STV I have an idea. */
     }
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 16*offset) & 0x00000FFF;
     if (addr & 0x0000000F) {
         message("LTV\nIllegal addr.");
         return;
     }
     for (i = 0; i < 8; i++) /* SGI screwed LTV up on N64.  See STV instead. */
-        VR[vt + i][(i - e/2) & 07] = *(pi16)(DMEM + addr + HES(2*i));
+        rsp_current -> VR[vt + i][(i - e/2) & 07] = *(pi16)(rsp_current -> DMEM + addr + HES(2*i));
     return;
 }
 void SWV(unsigned vt, unsigned element, signed offset, unsigned base)
@@ -1644,21 +1634,16 @@ void STV(unsigned vt, unsigned element, signed offset, unsigned base)
         message("STV\nUncertain case!");
         return; /* vt &= 030; */
     }
-    addr = (SR[base] + 16*offset) & 0x00000FFF;
+    addr = (rsp_current -> SR[base] + 16*offset) & 0x00000FFF;
     if (addr & 0x0000000F) {
         message("STV\nIllegal addr.");
         return;
     }
     for (i = 0; i < 8; i++)
-        *(pi16)(DMEM + addr + HES(2*i)) = VR[vt + (e/2 + i)%8][i];
+        *(pi16)(rsp_current -> DMEM + addr + HES(2*i)) = rsp_current -> VR[vt + (e/2 + i)%8][i];
     return;
 }
 
-int temp_PC;
-#ifdef WAIT_FOR_CPU_HOST
-short MFC0_count[32];
-#endif
-
 mwc2_func LWC2[2 * 8*2] = {
     LBV    ,LSV    ,LLV    ,LDV    ,LQV    ,LRV    ,LPV    ,LUV    ,
     LHV    ,LFV    ,res_lsw,LTV    ,res_lsw,res_lsw,res_lsw,res_lsw,
@@ -1672,7 +1657,6 @@ mwc2_func SWC2[2 * 8*2] = {
     res_lsw,res_lsw,res_lsw,res_lsw,res_lsw,res_lsw,res_lsw,res_lsw,
 };
 
-static ALIGNED i16 shuffle_temporary[N];
 #ifndef ARCH_MIN_SSE2
 static const unsigned char ei[1 << 4][N] = {
     { 00, 01, 02, 03, 04, 05, 06, 07 }, /* none (vector-only operand) */
@@ -1703,43 +1687,43 @@ PROFILE_MODE int SPECIAL(u32 inst, u32 PC)
 
     switch (inst % 64) {
     case 000: /* SLL */
-        SR[rd] = SR[rt] << MASK_SA(inst >> 6);
-        SR[zero] = 0x00000000;
+        rsp_current -> SR[rd] = rsp_current -> SR[rt] << MASK_SA(inst >> 6);
+        rsp_current -> SR[zero] = 0x00000000;
         break;
     case 002: /* SRL */
-        SR[rd] = (u32)(SR[rt]) >> MASK_SA(inst >> 6);
-        SR[zero] = 0x00000000;
+        rsp_current -> SR[rd] = (u32)(rsp_current -> SR[rt]) >> MASK_SA(inst >> 6);
+        rsp_current -> SR[zero] = 0x00000000;
         break;
     case 003: /* SRA */
-        SR[rd] = (s32)(SR[rt]) >> MASK_SA(inst >> 6);
-        SR[zero] = 0x00000000;
+        rsp_current -> SR[rd] = (s32)(rsp_current -> SR[rt]) >> MASK_SA(inst >> 6);
+        rsp_current -> SR[zero] = 0x00000000;
         break;
     case 004: /* SLLV */
         rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = SR[rt] << MASK_SA(SR[rs]);
-        SR[zero] = 0x00000000;
+        rsp_current -> SR[rd] = rsp_current -> SR[rt] << MASK_SA(rsp_current -> SR[rs]);
+        rsp_current -> SR[zero] = 0x00000000;
         break;
     case 006: /* SRLV */
         rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = (u32)(SR[rt]) >> MASK_SA(SR[rs]);
-        SR[zero] = 0x00000000;
+        rsp_current -> SR[rd] = (u32)(rsp_current -> SR[rt]) >> MASK_SA(rsp_current -> SR[rs]);
+        rsp_current -> SR[zero] = 0x00000000;
         break;
     case 007: /* SRAV */
         rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = (s32)(SR[rt]) >> MASK_SA(SR[rs]);
-        SR[zero] = 0x00000000;
+        rsp_current -> SR[rd] = (s32)(rsp_current -> SR[rt]) >> MASK_SA(rsp_current -> SR[rs]);
+        rsp_current -> SR[zero] = 0x00000000;
         break;
     case 011: /* JALR */
-        SR[rd] = FIT_IMEM(PC + LINK_OFF);
-        SR[zero] = 0x00000000;
+        rsp_current -> SR[rd] = FIT_IMEM(PC + LINK_OFF);
+        rsp_current -> SR[zero] = 0x00000000;
      /* Fall through. */
     case 010: /* JR */
         rs = SPECIAL_DECODE_RS(inst);
-        set_PC(SR[rs]);
+        set_PC(rsp_current -> SR[rs]);
         return 1;
     case 015: /* BREAK */
-        *CR[0x4] |= SP_STATUS_BROKE | SP_STATUS_HALT;
-        if (*CR[0x4] & SP_STATUS_INTR_BREAK) {
+        *rsp_current -> CR[0x4] |= SP_STATUS_BROKE | SP_STATUS_HALT;
+        if (*rsp_current -> CR[0x4] & SP_STATUS_INTR_BREAK) {
             GET_RCP_REG(MI_INTR_REG) |= 0x00000001;
             GET_RSP_INFO(CheckInterrupts)();
         }
@@ -1747,44 +1731,44 @@ PROFILE_MODE int SPECIAL(u32 inst, u32 PC)
     case 040: /* ADD */
     case 041: /* ADDU */
         rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = SR[rs] + SR[rt];
-        SR[zero] = 0x00000000; /* needed for Rareware micro-codes */
+        rsp_current -> SR[rd] = rsp_current -> SR[rs] + rsp_current -> SR[rt];
+        rsp_current -> SR[zero] = 0x00000000; /* needed for Rareware micro-codes */
         break;
     case 042: /* SUB */
     case 043: /* SUBU */
         rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = SR[rs] - SR[rt];
-        SR[zero] = 0x00000000;
+        rsp_current -> SR[rd] = rsp_current -> SR[rs] - rsp_current -> SR[rt];
+        rsp_current -> SR[zero] = 0x00000000;
         break;
     case 044: /* AND */
         rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = SR[rs] & SR[rt];
-        SR[zero] = 0x00000000; /* needed for Rareware micro-codes */
+        rsp_current -> SR[rd] = rsp_current -> SR[rs] & rsp_current -> SR[rt];
+        rsp_current -> SR[zero] = 0x00000000; /* needed for Rareware micro-codes */
         break;
     case 045: /* OR */
         rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = SR[rs] | SR[rt];
-        SR[zero] = 0x00000000;
+        rsp_current -> SR[rd] = rsp_current -> SR[rs] | rsp_current -> SR[rt];
+        rsp_current -> SR[zero] = 0x00000000;
         break;
     case 046: /* XOR */
         rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = SR[rs] ^ SR[rt];
-        SR[zero] = 0x00000000;
+        rsp_current -> SR[rd] = rsp_current -> SR[rs] ^ rsp_current -> SR[rt];
+        rsp_current -> SR[zero] = 0x00000000;
         break;
     case 047: /* NOR */
         rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = ~(SR[rs] | SR[rt]);
-        SR[zero] = 0x00000000;
+        rsp_current -> SR[rd] = ~(rsp_current -> SR[rs] | rsp_current -> SR[rt]);
+        rsp_current -> SR[zero] = 0x00000000;
         break;
     case 052: /* SLT */
         rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = ((s32)(SR[rs]) < (s32)(SR[rt]));
-        SR[zero] = 0x00000000;
+        rsp_current -> SR[rd] = ((s32)(rsp_current -> SR[rs]) < (s32)(rsp_current -> SR[rt]));
+        rsp_current -> SR[zero] = 0x00000000;
         break;
     case 053: /* SLTU */
         rs = SPECIAL_DECODE_RS(inst);
-        SR[rd] = ((u32)(SR[rs]) < (u32)(SR[rt]));
-        SR[zero] = 0x00000000;
+        rsp_current -> SR[rd] = ((u32)(rsp_current -> SR[rs]) < (u32)(rsp_current -> SR[rt]));
+        rsp_current -> SR[zero] = 0x00000000;
         break;
     default:
         res_S();
@@ -1799,18 +1783,18 @@ PROFILE_MODE int REGIMM(u32 inst, u32 PC)
 
     switch (rt) {
     case 020: /* BLTZAL */
-        SR[ra] = FIT_IMEM(PC + LINK_OFF);
+        rsp_current -> SR[ra] = FIT_IMEM(PC + LINK_OFF);
      /* Fall through. */
     case 000: /* BLTZ */
-        if (!((s32)SR[base] < 0))
+        if (!((s32)rsp_current -> SR[base] < 0))
             return 0;
         set_PC(PC + 4*inst + SLOT_OFF);
         break;
     case 021: /* BGEZAL */
-        SR[ra] = FIT_IMEM(PC + LINK_OFF);
+        rsp_current -> SR[ra] = FIT_IMEM(PC + LINK_OFF);
      /* Fall through. */
     case 001: /* BGEZ */
-        if (!((s32)SR[base] >= 0))
+        if (!((s32)rsp_current -> SR[base] >= 0))
             return 0;
         set_PC(PC + 4*inst + SLOT_OFF);
         break;
@@ -1871,6 +1855,99 @@ PROFILE_MODE void COP0(u32 inst)
     }
 }
 
+/*
+ * vector computational operations, one function for each class of element
+ * The element `e' selects the lane of VR[vt] broadcast to its quarter, half
+ * or the whole vector before COP2_C2[func] combines it with VR[vs].
+ */
+PROFILE_MODE void COP2_V(unsigned vd, unsigned vs, unsigned vt, unsigned func)
+{
+#ifdef ARCH_MIN_SSE2
+    *(v16 *)(rsp_current -> VR[vd]) = COP2_C2[func](*(v16 *)rsp_current -> VR[vs], *(v16 *)rsp_current -> VR[vt]);
+#else
+    COP2_C2[func](&rsp_current -> VR[vs][0], &rsp_current -> VR[vt][0]);
+    vector_copy(&rsp_current -> VR[vd][0], &rsp_current -> V_result[0]);
+#endif
+}
+PROFILE_MODE void COP2_Q(
+    unsigned vd, unsigned vs, unsigned vt, unsigned func, unsigned e)
+{
+#ifdef ARCH_MIN_SSE2
+    v16 target;
+
+    rsp_current -> shuffle_temporary[0] = rsp_current -> VR[vt][0 + (e & 0x1)];
+    rsp_current -> shuffle_temporary[2] = rsp_current -> VR[vt][2 + (e & 0x1)];
+    rsp_current -> shuffle_temporary[4] = rsp_current -> VR[vt][4 + (e & 0x1)];
+    rsp_current -> shuffle_temporary[6] = rsp_current -> VR[vt][6 + (e & 0x1)];
+    target = *(v16 *)(&rsp_current -> shuffle_temporary[0]);
+    target = _mm_shufflehi_epi16(target, _MM_SHUFFLE(2, 2, 0, 0));
+    target = _mm_shufflelo_epi16(target, _MM_SHUFFLE(2, 2, 0, 0));
+    *(v16 *)(rsp_current -> VR[vd]) = COP2_C2[func](*(v16 *)rsp_current -> VR[vs], target);
+#elif defined(ARCH_MIN_ARM_NEON)
+    const int16x8x2_t pairs = vtrnq_s16(vld1q_s16(rsp_current -> VR[vt]), vld1q_s16(rsp_current -> VR[vt]));
+
+    vst1q_s16(rsp_current -> shuffle_temporary, pairs.val[e & 0x1]);
+    COP2_C2[func](&rsp_current -> VR[vs][0], &rsp_current -> shuffle_temporary[0]);
+    vector_copy(&rsp_current -> VR[vd][0], &rsp_current -> V_result[0]);
+#else
+    register unsigned int i;
+
+    for (i = 0; i < N; i++)
+        rsp_current -> shuffle_temporary[i] = rsp_current -> VR[vt][(i & 0xE) + (e & 0x1)];
+    COP2_C2[func](&rsp_current -> VR[vs][0], &rsp_current -> shuffle_temporary[0]);
+    vector_copy(&rsp_current -> VR[vd][0], &rsp_current -> V_result[0]);
+#endif
+}
+PROFILE_MODE void COP2_H(
+    unsigned vd, unsigned vs, unsigned vt, unsigned func, unsigned e)
+{
+#ifdef ARCH_MIN_SSE2
+    v16 target;
+
+    target = _mm_setzero_si128();
+    target = _mm_insert_epi16(target, rsp_current -> VR[vt][0 + (e & 0x3)], 0);
+    target = _mm_insert_epi16(target, rsp_current -> VR[vt][4 + (e & 0x3)], 4);
+    target = _mm_shufflehi_epi16(target, _MM_SHUFFLE(0, 0, 0, 0));
+    target = _mm_shufflelo_epi16(target, _MM_SHUFFLE(0, 0, 0, 0));
+    *(v16 *)(rsp_current -> VR[vd]) = COP2_C2[func](*(v16 *)rsp_current -> VR[vs], target);
+#elif defined(ARCH_MIN_ARM_NEON)
+    vst1q_s16(rsp_current -> shuffle_temporary, vcombine_s16(
+        vdup_n_s16(rsp_current -> VR[vt][0 + (e & 0x3)]),
+        vdup_n_s16(rsp_current -> VR[vt][4 + (e & 0x3)])
+    ));
+    COP2_C2[func](&rsp_current -> VR[vs][0], &rsp_current -> shuffle_temporary[0]);
+    vector_copy(&rsp_current -> VR[vd][0], &rsp_current -> V_result[0]);
+#else
+    register unsigned int i;
+
+    for (i = 0; i < N; i++)
+        rsp_current -> shuffle_temporary[i] = rsp_current -> VR[vt][(i & 0xC) + (e & 0x3)];
+    COP2_C2[func](&rsp_current -> VR[vs][0], &rsp_current -> shuffle_temporary[0]);
+    vector_copy(&rsp_current -> VR[vd][0], &rsp_current -> V_result[0]);
+#endif
+}
+PROFILE_MODE void COP2_W(
+    unsigned vd, unsigned vs, unsigned vt, unsigned func, unsigned e)
+{
+#ifdef ARCH_MIN_SSE2
+    *(v16 *)(rsp_current -> VR[vd]) = COP2_C2[func](
+        *(v16 *)rsp_current -> VR[vs],
+        _mm_set1_epi16(rsp_current -> VR[vt][e & 0x7])
+    );
+#elif defined(ARCH_MIN_ARM_NEON)
+    vst1q_s16(rsp_current -> shuffle_temporary, vdupq_n_s16(rsp_current -> VR[vt][e & 0x7]));
+    COP2_C2[func](&rsp_current -> VR[vs][0], &rsp_current -> shuffle_temporary[0]);
+    vector_copy(&rsp_current -> VR[vd][0], &rsp_current -> V_result[0]);
+#else
+    register unsigned int i;
+
+    for (i = 0; i < N; i++)
+        rsp_current -> shuffle_temporary[i] = rsp_current -> VR[vt][e % N];
+    COP2_C2[func](&rsp_current -> VR[vs][0], &rsp_current -> shuffle_temporary[0]);
+    vector_copy(&rsp_current -> VR[vd][0], &rsp_current -> V_result[0]);
+#endif
+}
+
 PROFILE_MODE void COP2(u32 inst)
 {
     const unsigned int op = (inst >> 21) % (1 << 5); /* inst.R.rs */
@@ -1878,17 +1955,8 @@ PROFILE_MODE void COP2(u32 inst)
     const unsigned int vs = IW_RD(inst);
     const unsigned int vd = (inst >>  6) % (1 << 5); /* inst.R.sa */
     const unsigned int func = inst % (1 << 6);
-#ifndef ARCH_MIN_SSE2
-    const unsigned int e  = op & 0xF; /* With Intel, LEA offsets beat ANDing. */
-#endif
 
     switch (op) {
-#ifdef ARCH_MIN_SSE2
-        v16 target;
-#else
-        register unsigned int i;
-#endif
-
     case 000:
         MFC2(vt, vs, vd >> 1);
         break;
@@ -1903,48 +1971,17 @@ PROFILE_MODE void COP2(u32 inst)
         break;
     case 020:
     case 021:
-#ifdef ARCH_MIN_SSE2
-        *(v16 *)(VR[vd]) = COP2_C2[func](*(v16 *)VR[vs], *(v16 *)VR[vt]);
-#else
-        COP2_C2[func](&VR[vs][0], &VR[vt][0]);
-        vector_copy(&VR[vd][0], &V_result[0]);
-#endif
+        COP2_V(vd, vs, vt, func);
         break;
     case 022:
     case 023:
-#ifdef ARCH_MIN_SSE2
-        shuffle_temporary[0] = VR[vt][0 + op - 0x12];
-        shuffle_temporary[2] = VR[vt][2 + op - 0x12];
-        shuffle_temporary[4] = VR[vt][4 + op - 0x12];
-        shuffle_temporary[6] = VR[vt][6 + op - 0x12];
-        target = *(v16 *)(&shuffle_temporary[0]);
-        target = _mm_shufflehi_epi16(target, _MM_SHUFFLE(2, 2, 0, 0));
-        target = _mm_shufflelo_epi16(target, _MM_SHUFFLE(2, 2, 0, 0));
-        *(v16 *)(VR[vd]) = COP2_C2[func](*(v16 *)VR[vs], target);
-#else
-        for (i = 0; i < N; i++)
-            shuffle_temporary[i] = VR[vt][(i & 0xE) + (e & 0x1)];
-        COP2_C2[func](&VR[vs][0], &shuffle_temporary[0]);
-        vector_copy(&VR[vd][0], &V_result[0]);
-#endif
+        COP2_Q(vd, vs, vt, func, op & 0xF);
         break;
     case 024:
     case 025:
     case 026:
     case 027:
-#ifdef ARCH_MIN_SSE2
-        target = _mm_setzero_si128();
-        target = _mm_insert_epi16(target, VR[vt][0 + op - 0x14], 0);
-        target = _mm_insert_epi16(target, VR[vt][4 + op - 0x14], 4);
-        target = _mm_shufflehi_epi16(target, _MM_SHUFFLE(0, 0, 0, 0));
-        target = _mm_shufflelo_epi16(target, _MM_SHUFFLE(0, 0, 0, 0));
-        *(v16 *)(VR[vd]) = COP2_C2[func](*(v16 *)VR[vs], target);
-#else
-        for (i = 0; i < N; i++)
-            shuffle_temporary[i] = VR[vt][(i & 0xC) + (e & 0x3)];
-        COP2_C2[func](&VR[vs][0], &shuffle_temporary[0]);
-        vector_copy(&VR[vd][0], &V_result[0]);
-#endif
+        COP2_H(vd, vs, vt, func, op & 0xF);
         break;
     case 030:
     case 031:
@@ -1954,17 +1991,7 @@ PROFILE_MODE void COP2(u32 inst)
     case 035:
     case 036:
     case 037:
-#ifdef ARCH_MIN_SSE2
-        *(v16 *)(VR[vd]) = COP2_C2[func](
-            *(v16 *)VR[vs],
-            _mm_set1_epi16(VR[vt][op - 0x18])
-        );
-#else
-        for (i = 0; i < N; i++)
-            shuffle_temporary[i] = VR[vt][e % N];
-        COP2_C2[func](&VR[vs][0], &shuffle_temporary[0]);
-        vector_copy(&VR[vd][0], &V_result[0]);
-#endif
+        COP2_W(vd, vs, vt, func, op & 0xF);
         break;
     default:
         res_S();
@@ -1977,23 +2004,23 @@ NOINLINE void run_task(void)
 
     PC = FIT_IMEM(GET_RCP_REG(SP_PC_REG));
     for (;;) {
-        inst_word = *(pi32)(IMEM + FIT_IMEM(PC));
+        rsp_current -> inst_word = *(pi32)(rsp_current -> IMEM + FIT_IMEM(PC));
 #ifdef EMULATE_STATIC_PC
         PC = (PC + 0x004);
 EX:
 #endif
 #ifdef SP_EXECUTE_LOG
-        step_SP_commands(inst_word);
+        step_SP_commands(rsp_current -> inst_word);
 #endif
 
 #if (0 != 0)
         if (GET_RCP_REG(SP_STATUS_REG) & SP_STATUS_HALT)
             goto RSP_halted_CPU_exit_point; /* Only BREAK and COP0 set this. */
-        SR[zero] = 0x00000000; /* already handled on per-instruction basis */
+        rsp_current -> SR[zero] = 0x00000000; /* already handled on per-instruction basis */
 #endif
-        switch (inst_word >> 26) {
+        switch (rsp_current -> inst_word >> 26) {
         case 000: /* SPECIAL */
-            switch (SPECIAL(inst_word, PC)) {
+            switch (SPECIAL(rsp_current -> inst_word, PC)) {
             case -1: /* BREAK */
                 goto RSP_halted_CPU_exit_point;
             case +1: /* JR and JALR */
@@ -2001,110 +2028,110 @@ EX:
             }
             break;
         case 001: /* REGIMM */
-            if (REGIMM(inst_word, PC) != 0)
+            if (REGIMM(rsp_current -> inst_word, PC) != 0)
                 JUMP;
             break;
         case 002:
-            J(inst_word);
+            J(rsp_current -> inst_word);
             JUMP;
         case 003:
-            JAL(inst_word, PC);
+            JAL(rsp_current -> inst_word, PC);
             JUMP;
         case 004:
-            if (BEQ(inst_word, PC) != 0)
+            if (BEQ(rsp_current -> inst_word, PC) != 0)
                 JUMP;
             break;
         case 005:
-            if (BNE(inst_word, PC) != 0)
+            if (BNE(rsp_current -> inst_word, PC) != 0)
                 JUMP;
             break;
         case 006:
-            if (BLEZ(inst_word, PC) != 0)
+            if (BLEZ(rsp_current -> inst_word, PC) != 0)
                 JUMP;
             break;
         case 007:
-            if (BGTZ(inst_word, PC) != 0)
+            if (BGTZ(rsp_current -> inst_word, PC) != 0)
                 JUMP;
             break;
         case 010: /* ADDI:  Traps don't exist on the RCP. */
         case 011:
-            ADDIU(inst_word);
+            ADDIU(rsp_current -> inst_word);
             break;
         case 012:
-            SLTI(inst_word);
+            SLTI(rsp_current -> inst_word);
             break;
         case 013:
-            SLTIU(inst_word);
+            SLTIU(rsp_current -> inst_word);
             break;
         case 014:
-            ANDI(inst_word);
+            ANDI(rsp_current -> inst_word);
             break;
         case 015:
-            ORI(inst_word);
+            ORI(rsp_current -> inst_word);
             break;
         case 016:
-            XORI(inst_word);
+            XORI(rsp_current -> inst_word);
             break;
         case 017:
-            LUI(inst_word);
+            LUI(rsp_current -> inst_word);
             break;
         case 020:
-            COP0(inst_word);
+            COP0(rsp_current -> inst_word);
             if (GET_RCP_REG(SP_STATUS_REG) & SP_STATUS_HALT)
                 goto RSP_halted_CPU_exit_point;
             break;
         case 022:
-            COP2(inst_word);
+            COP2(rsp_current -> inst_word);
             break;
         case 040:
-            LB(inst_word);
+            LB(rsp_current -> inst_word);
             break;
         case 041:
-            LH(inst_word);
+            LH(rsp_current -> inst_word);
             break;
         case 043:
-            LW(inst_word);
+            LW(rsp_current -> inst_word);
             break;
         case 044:
-            LBU(inst_word);
+            LBU(rsp_current -> inst_word);
             break;
         case 045:
-            LHU(inst_word);
+            LHU(rsp_current -> inst_word);
             break;
         case 050:
-            SB(inst_word);
+            SB(rsp_current -> inst_word);
             break;
         case 051:
-            SH(inst_word);
+            SH(rsp_current -> inst_word);
             break;
         case 053:
-            SW(inst_word);
+            SW(rsp_current -> inst_word);
             break;
         case 062: /* LWC2 */
-            MWC2_load(inst_word);
+            MWC2_load(rsp_current -> inst_word);
             break;
         case 072: /* SWC2 */
-            MWC2_store(inst_word);
+            MWC2_store(rsp_current -> inst_word);
             break;
         default:
             res_S();
         }
 
 #ifndef EMULATE_STATIC_PC
-        if (stage == 2) { /* branch phase of scheduler */
-            stage = 0*stage;
-            PC = FIT_IMEM(temp_PC);
-            GET_RCP_REG(SP_PC_REG) = temp_PC;
+        if (rsp_current -> stage == 2) { /* branch phase of scheduler */
+            rsp_current -> stage = 0*rsp_current -> stage;
+            PC = FIT_IMEM(rsp_current -> temp_PC);
+            GET_RCP_REG(SP_PC_REG) = rsp_current -> temp_PC;
         } else {
-            stage = 2*stage; /* next IW in branch delay slot? */
+            rsp_current -> stage = 2*rsp_current -> stage; /* next IW in branch delay slot? */
             PC = FIT_IMEM(PC + 0x004);
             GET_RCP_REG(SP_PC_REG) = 0x04001000 + PC;
         }
 #else
         continue;
 set_branch_delay:
-        inst_word = *(pi32)(IMEM + FIT_IMEM(PC));
-        PC = FIT_IMEM(temp_PC);
+        rsp_current -> inst_word = *(pi32)(rsp_current -> IMEM + FIT_IMEM(PC));
+        PC = FIT_IMEM(rsp_current -> temp_PC);
         goto EX;
 #endif
     }
@@ -2112,3 +2139,306 @@ RSP_halted_CPU_exit_point:
     GET_RCP_REG(SP_PC_REG) = 0x04001000 | FIT_IMEM(PC);
     return;
 }
+
+/*
+ * handlers of the pre-decoded interpreter
+ * Scalar ALU operations are split out of SPECIAL and vector computes out of
+ * COP2, so each instruction is dispatched by a single switch on `op'.
+ */
+enum {
+    D_NOP = 0, /* must stay zero:  see RSP_DECODED */
+    D_SLL, D_SRL, D_SRA, D_SLLV, D_SRLV, D_SRAV,
+    D_ADDU, D_SUBU, D_AND, D_OR, D_XOR, D_NOR, D_SLT, D_SLTU,
+    D_SPECIAL, /* JR, JALR, BREAK and reserved SPECIAL functions */
+    D_REGIMM, D_J, D_JAL, D_BEQ, D_BNE, D_BLEZ, D_BGTZ,
+    D_ADDIU, D_SLTI, D_SLTIU, D_ANDI, D_ORI, D_XORI, D_LUI,
+    D_COP0,
+    D_COP2, /* moves to or from COP2 and reserved COP2 formats */
+    D_COP2_V, D_COP2_Q, D_COP2_H, D_COP2_W,
+    D_LB, D_LH, D_LW, D_LBU, D_LHU, D_SB, D_SH, D_SW,
+    D_LWC2, D_SWC2,
+    D_RESERVED
+};
+
+static unsigned int decode_op(u32 inst)
+{
+    const unsigned int rs = (inst >> 21) % (1 << 5);
+    const unsigned int rt = (inst >> 16) % (1 << 5);
+    const unsigned int rd = (inst >> 11) % (1 << 5);
+
+    switch (inst >> 26) {
+    case 000: /* SPECIAL */
+        switch (inst % 64) {
+        case 000:  return (rd == zero) ? D_NOP : D_SLL;
+        case 002:  return (rd == zero) ? D_NOP : D_SRL;
+        case 003:  return (rd == zero) ? D_NOP : D_SRA;
+        case 004:  return (rd == zero) ? D_NOP : D_SLLV;
+        case 006:  return (rd == zero) ? D_NOP : D_SRLV;
+        case 007:  return (rd == zero) ? D_NOP : D_SRAV;
+        case 040:
+        case 041:  return (rd == zero) ? D_NOP : D_ADDU;
+        case 042:
+        case 043:  return (rd == zero) ? D_NOP : D_SUBU;
+        case 044:  return (rd == zero) ? D_NOP : D_AND;
+        case 045:  return (rd == zero) ? D_NOP : D_OR;
+        case 046:  return (rd == zero) ? D_NOP : D_XOR;
+        case 047:  return (rd == zero) ? D_NOP : D_NOR;
+        case 052:  return (rd == zero) ? D_NOP : D_SLT;
+        case 053:  return (rd == zero) ? D_NOP : D_SLTU;
+        }
+        return D_SPECIAL;
+    case 001:  return D_REGIMM;
+    case 002:  return D_J;
+    case 003:  return D_JAL;
+    case 004:  return D_BEQ;
+    case 005:  return D_BNE;
+    case 006:  return D_BLEZ;
+    case 007:  return D_BGTZ;
+    case 010: /* ADDI:  Traps don't exist on the RCP. */
+    case 011:  return (rt == zero) ? D_NOP : D_ADDIU;
+    case 012:  return (rt == zero) ? D_NOP : D_SLTI;
+    case 013:  return (rt == zero) ? D_NOP : D_SLTIU;
+    case 014:  return (rt == zero) ? D_NOP : D_ANDI;
+    case 015:  return (rt == zero) ? D_NOP : D_ORI;
+    case 016:  return (rt == zero) ? D_NOP : D_XORI;
+    case 017:  return (rt == zero) ? D_NOP : D_LUI;
+    case 020:  return D_COP0;
+    case 022:
+        if (rs >= 030)
+            return D_COP2_W;
+        if (rs >= 024)
+            return D_COP2_H;
+        if (rs >= 022)
+            return D_COP2_Q;
+        if (rs >= 020)
+            return D_COP2_V;
+        return D_COP2;
+    case 040:  return D_LB;
+    case 041:  return D_LH;
+    case 043:  return D_LW;
+    case 044:  return D_LBU;
+    case 045:  return D_LHU;
+    case 050:  return D_SB;
+    case 051:  return D_SH;
+    case 053:  return D_SW;
+    case 062:  return D_LWC2;
+    case 072:  return D_SWC2;
+    }
+    return D_RESERVED;
+}
+
+NOINLINE static void predecode(RSP_DECODED* slot, u32 inst)
+{
+    slot -> inst = inst;
+    slot -> op = (u8)decode_op(inst);
+    slot -> rs = (inst >> 21) % (1 << 5);
+    slot -> rt = (inst >> 16) % (1 << 5);
+    slot -> rd = (inst >> 11) % (1 << 5);
+    slot -> sa = (inst >>  6) % (1 << 5);
+    slot -> func = inst % (1 << 6);
+    slot -> imm = (u16)(inst & 0x0000FFFFu);
+    if (slot -> op >= D_COP2_V && slot -> op <= D_COP2_W) {
+        slot -> rd = (inst >>  6) % (1 << 5); /* vd */
+        slot -> rs = (inst >> 11) % (1 << 5); /* vs */
+        slot -> sa = (inst >> 21) % (1 << 4); /* e */
+    }
+}
+
+static INLINE const RSP_DECODED* fetch_decoded(u32 PC)
+{
+    RSP_DECODED* slot = &rsp_current -> IMEM_decoded[FIT_IMEM(PC) / 4];
+    const u32 inst = *(pi32)(rsp_current -> IMEM + FIT_IMEM(PC));
+
+    if (slot -> inst != inst)
+        predecode(slot, inst);
+    return (slot);
+}
+
+#ifdef EMULATE_STATIC_PC
+NOINLINE void run_task_predecoded(void)
+{
+    register u32 PC;
+    register const RSP_DECODED* slot;
+
+    PC = FIT_IMEM(GET_RCP_REG(SP_PC_REG));
+    for (;;) {
+        slot = fetch_decoded(PC);
+        PC = (PC + 0x004);
+EX:
+        rsp_current -> inst_word = slot -> inst;
+#ifdef SP_EXECUTE_LOG
+        step_SP_commands(rsp_current -> inst_word);
+#endif
+        switch (slot -> op) {
+        case D_NOP:
+            break;
+        case D_SLL:
+            rsp_current -> SR[slot -> rd] = rsp_current -> SR[slot -> rt] << slot -> sa;
+            break;
+        case D_SRL:
+            rsp_current -> SR[slot -> rd] = (u32)(rsp_current -> SR[slot -> rt]) >> slot -> sa;
+            break;
+        case D_SRA:
+            rsp_current -> SR[slot -> rd] = (s32)(rsp_current -> SR[slot -> rt]) >> slot -> sa;
+            break;
+        case D_SLLV:
+            rsp_current -> SR[slot -> rd] = rsp_current -> SR[slot -> rt] << (rsp_current -> SR[slot -> rs] & 31);
+            break;
+        case D_SRLV:
+            rsp_current -> SR[slot -> rd] = (u32)(rsp_current -> SR[slot -> rt]) >> (rsp_current -> SR[slot -> rs] & 31);
+            break;
+        case D_SRAV:
+            rsp_current -> SR[slot -> rd] = (s32)(rsp_current -> SR[slot -> rt]) >> (rsp_current -> SR[slot -> rs] & 31);
+            break;
+        case D_ADDU:
+            rsp_current -> SR[slot -> rd] = rsp_current -> SR[slot -> rs] + rsp_current -> SR[slot -> rt];
+            break;
+        case D_SUBU:
+            rsp_current -> SR[slot -> rd] = rsp_current -> SR[slot -> rs] - rsp_current -> SR[slot -> rt];
+            break;
+        case D_AND:
+            rsp_current -> SR[slot -> rd] = rsp_current -> SR[slot -> rs] & rsp_current -> SR[slot -> rt];
+            break;
+        case D_OR:
+            rsp_current -> SR[slot -> rd] = rsp_current -> SR[slot -> rs] | rsp_current -> SR[slot -> rt];
+            break;
+        case D_XOR:
+            rsp_current -> SR[slot -> rd] = rsp_current -> SR[slot -> rs] ^ rsp_current -> SR[slot -> rt];
+            break;
+        case D_NOR:
+            rsp_current -> SR[slot -> rd] = ~(rsp_current -> SR[slot -> rs] | rsp_current -> SR[slot -> rt]);
+            break;
+        case D_SLT:
+            rsp_current -> SR[slot -> rd] = ((s32)(rsp_current -> SR[slot -> rs]) < (s32)(rsp_current -> SR[slot -> rt]));
+            break;
+        case D_SLTU:
+            rsp_current -> SR[slot -> rd] = ((u32)(rsp_current -> SR[slot -> rs]) < (u32)(rsp_current -> SR[slot -> rt]));
+            break;
+        case D_SPECIAL:
+            switch (SPECIAL(rsp_current -> inst_word, PC)) {
+            case -1: /* BREAK */
+                goto RSP_halted_CPU_exit_point;
+            case +1: /* JR and JALR */
+                JUMP;
+            }
+            break;
+        case D_REGIMM:
+            if (REGIMM(rsp_current -> inst_word, PC) != 0)
+                JUMP;
+            break;
+        case D_J:
+            J(rsp_current -> inst_word);
+            JUMP;
+        case D_JAL:
+            JAL(rsp_current -> inst_word, PC);
+            JUMP;
+        case D_BEQ:
+            if (rsp_current -> SR[slot -> rs] != rsp_current -> SR[slot -> rt])
+                break;
+            set_PC(PC + 4*rsp_current -> inst_word + SLOT_OFF);
+            JUMP;
+        case D_BNE:
+            if (rsp_current -> SR[slot -> rs] == rsp_current -> SR[slot -> rt])
+                break;
+            set_PC(PC + 4*rsp_current -> inst_word + SLOT_OFF);
+            JUMP;
+        case D_BLEZ:
+            if ((s32)rsp_current -> SR[slot -> rs] > 0)
+                break;
+            set_PC(PC + 4*rsp_current -> inst_word + SLOT_OFF);
+            JUMP;
+        case D_BGTZ:
+            if ((s32)rsp_current -> SR[slot -> rs] <= 0)
+                break;
+            set_PC(PC + 4*rsp_current -> inst_word + SLOT_OFF);
+            JUMP;
+        case D_ADDIU:
+            rsp_current -> SR[slot -> rt] = rsp_current -> SR[slot -> rs] + (s16)(slot -> imm);
+            break;
+        case D_SLTI:
+            rsp_current -> SR[slot -> rt] = ((s32)(rsp_current -> SR[slot -> rs]) < (s16)(slot -> imm));
+            break;
+        case D_SLTIU:
+            rsp_current -> SR[slot -> rt] = ((u32)(rsp_current -> SR[slot -> rs]) < (u16)(slot -> imm));
+            break;
+        case D_ANDI:
+            rsp_current -> SR[slot -> rt] = rsp_current -> SR[slot -> rs] & slot -> imm;
+            break;
+        case D_ORI:
+            rsp_current -> SR[slot -> rt] = rsp_current -> SR[slot -> rs] | slot -> imm;
+            break;
+        case D_XORI:
+            rsp_current -> SR[slot -> rt] = rsp_current -> SR[slot -> rs] ^ slot -> imm;
+            break;
+        case D_LUI:
+            rsp_current -> SR[slot -> rt] = (u32)(slot -> imm) << 16;
+            break;
+        case D_COP0:
+            COP0(rsp_current -> inst_word);
+            if (GET_RCP_REG(SP_STATUS_REG) & SP_STATUS_HALT)
+                goto RSP_halted_CPU_exit_point;
+            break;
+        case D_COP2:
+            COP2(rsp_current -> inst_word);
+            break;
+        case D_COP2_V:
+            COP2_V(slot -> rd, slot -> rs, slot -> rt, slot -> func);
+            break;
+        case D_COP2_Q:
+            COP2_Q(slot -> rd, slot -> rs, slot -> rt, slot -> func, slot -> sa);
+            break;
+        case D_COP2_H:
+            COP2_H(slot -> rd, slot -> rs, slot -> rt, slot -> func, slot -> sa);
+            break;
+        case D_COP2_W:
+            COP2_W(slot -> rd, slot -> rs, slot -> rt, slot -> func, slot -> sa);
+            break;
+        case D_LB:
+            LB(rsp_current -> inst_word);
+            break;
+        case D_LH:
+            LH(rsp_current -> inst_word);
+            break;
+        case D_LW:
+            LW(rsp_current -> inst_word);
+            break;
+        case D_LBU:
+            LBU(rsp_current -> inst_word);
+            break;
+        case D_LHU:
+            LHU(rsp_current -> inst_word);
+            break;
+        case D_SB:
+            SB(rsp_current -> inst_word);
+            break;
+        case D_SH:
+            SH(rsp_current -> inst_word);
+            break;
+        case D_SW:
+            SW(rsp_current -> inst_word);
+            break;
+        case D_LWC2:
+            MWC2_load(rsp_current -> inst_word);
+            break;
+        case D_SWC2:
+            MWC2_store(rsp_current -> inst_word);
+            break;
+        default:
+            res_S();
+        }
+        continue;
+set_branch_delay:
+        slot = fetch_decoded(PC);
+        PC = FIT_IMEM(rsp_current -> temp_PC);
+        goto EX;
+    }
+RSP_halted_CPU_exit_point:
+    GET_RCP_REG(SP_PC_REG) = 0x04001000 | FIT_IMEM(PC);
+    return;
+}
+#else
+NOINLINE void run_task_predecoded(void)
+{
+    run_task(); /* The pre-decoded loop relies on the static PC model. */
+}
+#endif
@@ -21,6 +21,7 @@
 
 #include "my_types.h"
 #include "rsp.h"
+#include "context.h"
 
 #define EXTERN_COMMAND_LIST_GBI
 #define EXTERN_COMMAND_LIST_ABI
@@ -120,11 +121,10 @@ typedef enum {
     S8 = fp
 } GPR_specifier;
 
-extern RSP_INFO RSP_INFO_NAME;
-extern pu8 DRAM;
-extern pu8 DMEM;
-extern pu8 IMEM;
-
+/*
+ * The RSP_INFO and the DRAM, DMEM and IMEM pointers are members of the
+ * context:  `rsp_current -> DMEM' and so on (see `context.h').
+ */
 extern u8 conf[32];
 
 /*
@@ -132,8 +132,9 @@ extern u8 conf[32];
  *
  * based on the MIPS instruction set architecture but without most of the
  * original register names (for example, no kernel-reserved registers)
+ *
+ * u32 SR[32] is `rsp_current -> SR'.
  */
-extern u32 SR[32];
 
 #define FIT_IMEM(PC)    ((PC) & 0xFFFu & 0xFFCu)
 
@@ -149,15 +150,11 @@ extern u32 SR[32];
 #define BASE_OFF    0x004
 #endif
 
-#ifndef EMULATE_STATIC_PC
-int stage;
-#endif
-
-extern int temp_PC;
-#ifdef WAIT_FOR_CPU_HOST
-extern short MFC0_count[32];
-/* Keep one C0 MF status read count for each scalar register. */
-#endif
+/*
+ * `stage' (without EMULATE_STATIC_PC), `temp_PC' and `MFC0_count' are kept
+ * in the current context.  MFC0_count keeps one C0 MF status read count for
+ * each scalar register.
+ */
 
 /*
  * The number of times to tolerate executing `MFC0    $at, $c4`.
@@ -165,8 +162,9 @@ extern short MFC0_count[32];
  *
  * Set to a higher value to avoid prematurely quitting the interpreter.
  * Set to a lower value for speed...you could get away with 10 sometimes.
+ *
+ * This is `rsp_current -> MF_SP_STATUS_TIMEOUT'.
  */
-extern int MF_SP_STATUS_TIMEOUT;
 
 #define SLOT_OFF    ((BASE_OFF) + 0x000)
 #define LINK_OFF    ((BASE_OFF) + 0x004)
@@ -212,7 +210,7 @@ extern void set_PC(unsigned int address);
  * RSP general-purpose registers (GPRs) are always 32-bit scalars (SRs).
  * SR_B(gpr, 0) is SR[gpr]31..24, and SR_B(gpr, 3) is SR[gpr]7..0.
  */
-#define SR_B(scalar, i)         *((unsigned char *)&(SR[scalar]) + BES(i))
+#define SR_B(scalar, i)         *((unsigned char *)&(rsp_current -> SR[scalar]) + BES(i))
 
 /*
  * Universal byte-access macro for 8-element vectors of 16-bit halfwords.
@@ -225,7 +223,7 @@ extern void set_PC(unsigned int address);
  * Either method--dynamic union reads or special aliasing--is undefined
  * behavior and will not truly be portable code anyway, so it hardly matters.
  */
-#define VR_B(vt, element)       *((unsigned char *)&(VR[vt][0]) + MES(element))
+#define VR_B(vt, element)       *((unsigned char *)&(rsp_current -> VR[vt][0]) + MES(element))
 
 /*
  * Optimized byte-access macros for the vector registers.
@@ -234,8 +232,8 @@ extern void set_PC(unsigned int address);
  * They are faster because LEA PTR [offset +/- 1] means fewer CPU
  * instructions generated than (offset ^ 1) does, in most cases.
  */
-#define VR_A(vt, e)             *((unsigned char *)&(VR[vt][0]) + e + MES(0))
-#define VR_U(vt, e)             *((unsigned char *)&(VR[vt][0]) + e - MES(0))
+#define VR_A(vt, e)             *((unsigned char *)&(rsp_current -> VR[vt][0]) + e + MES(0))
+#define VR_U(vt, e)             *((unsigned char *)&(rsp_current -> VR[vt][0]) + e - MES(0))
 
 /*
  * Use this ONLY if you know the element is even, not odd.
@@ -243,7 +241,7 @@ extern void set_PC(unsigned int address);
  * This is only provided for purposes of consistency with VR_B() and friends.
  * Saying `VR[vt][1] = x;` instead of `VR_S(vt, 2) = x` works as well.
  */
-#define VR_S(vt, element)       *(pi16)((unsigned char *)&(VR[vt][0]) + element)
+#define VR_S(vt, element)       *(pi16)((unsigned char *)&(rsp_current -> VR[vt][0]) + element)
 
 /*** Scalar, Coprocessor Operations (system control) ***/
 #define SP_STATUS_HALT          (0x00000001ul <<  0)
@@ -262,8 +260,10 @@ extern void set_PC(unsigned int address);
 #define SP_STATUS_SIG6          (0x00000001ul << 13)
 #define SP_STATUS_SIG7          (0x00000001ul << 14)
 
-#define NUMBER_OF_CP0_REGISTERS         16
-extern pu32 CR[NUMBER_OF_CP0_REGISTERS];
+/*
+ * NUMBER_OF_CP0_REGISTERS pointers to the CP0 registers, `CR', are set up
+ * in the context by rsp_context_init().
+ */
 
 extern void SP_DMA_READ(void);
 extern void SP_DMA_WRITE(void);
@@ -365,4 +365,11 @@ extern void STV(unsigned vt, unsigned element, signed offset, unsigned base);
 
 NOINLINE extern void run_task(void);
 
+/*
+ * same as run_task(), but dispatches on IMEM words decoded once into the
+ * current context's IMEM_decoded[] instead of decoding each word again
+ * every time it executes
+ */
+NOINLINE extern void run_task_predecoded(void);
+
 #endif
@@ -0,0 +1,150 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - context_test.c                                          *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+ * Runs the same RSP task on two contexts at once, from two threads, and
+ * checks that each leaves DMEM exactly as a run of the task on its own does.
+ * Both the plain and the pre-decoding interpreter loop are tested.
+ *
+ * The task multiplies and adds 64 vectors of DMEM with the vector unit and
+ * sums their first words with the scalar unit:
+ *
+ *   0x000-0x3FF   input vectors
+ *   0x400-0x40F   the constant vector
+ *   0x800-0xBFF   output vectors, in[i] * constant + in[i]
+ *   0xC00         sum of the first word of every input vector
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_rsp.h"
+
+#define RUNS            200
+#define TASK_VECTORS    64
+
+typedef struct {
+    TEST_RSP rsp;
+    int predecoded;
+    unsigned int seed;
+    int failures;
+} TEST_THREAD;
+
+static const u32 task_code[] = {
+    OP_ORI(1, 0, 0x000),           /* in */
+    OP_ORI(2, 0, 0x800),           /* out */
+    OP_ORI(3, 0, TASK_VECTORS),
+    OP_ORI(5, 0, 0),
+    OP_ORI(6, 0, 0x400),
+    OP_LQV(1, 0, 6),
+/* loop: */
+    OP_LQV(0, 0, 1),
+    OP_VU(000, 2, 0, 1, 0),        /* VMULF */
+    OP_VU(020, 3, 2, 0, 0),        /* VADD */
+    OP_SQV(3, 0, 2),
+    OP_LW(4, 0, 1),
+    OP_ADDU(5, 5, 4),
+    OP_ADDIU(1, 1, 16),
+    OP_ADDIU(3, 3, -1),
+    OP_BNE(3, 0, -9),
+    OP_ADDIU(2, 2, 16),
+    OP_SW(5, 0xC00, 0),
+    OP_BREAK,
+};
+
+static void task_init(TEST_RSP* rsp, u32 seed)
+{
+    unsigned int i;
+
+    test_rsp_init(rsp);
+    for (i = 0; i < 0x410 / 4; i++)
+        ((pu32)rsp -> mem)[i] = test_rand(&seed);
+    memcpy(rsp -> mem + 0x1000, task_code, sizeof(task_code));
+}
+
+static void* test_thread(void* data)
+{
+    TEST_THREAD* thread = (TEST_THREAD*)data;
+    TEST_RSP* expected = malloc(sizeof(TEST_RSP));
+    int run;
+
+    for (run = 0; run < RUNS; run++) {
+        unsigned int seed = thread -> seed + 2 * run;
+
+        /* the expected DMEM, computed by a run on its own */
+        task_init(expected, seed);
+        task_init(&thread -> rsp, seed);
+        test_rsp_run(&thread -> rsp, thread -> predecoded);
+        test_rsp_run(expected, thread -> predecoded);
+
+        if (memcmp(thread -> rsp.mem, expected -> mem, 0x1000) != 0
+         || !(thread -> rsp.regs[0x4] & SP_STATUS_BROKE)) {
+            fprintf(stderr, "seed %u: DMEM differs from the single run\n", seed);
+            thread -> failures++;
+        }
+    }
+    free(expected);
+    return NULL;
+}
+
+static int test_parallel(int predecoded)
+{
+    static TEST_RSP single;
+    static TEST_THREAD threads[2];
+    pthread_t ids[2];
+    int failures = 0;
+    int i;
+
+    /* the task must compute something in the first place */
+    task_init(&single, 1);
+    test_rsp_run(&single, predecoded);
+    if (!(single.regs[0x4] & SP_STATUS_BROKE)
+     || !memcmp(single.mem + 0x800, single.mem, 0x400)) {
+        fprintf(stderr, "the task did not run\n");
+        return 1;
+    }
+
+    for (i = 0; i < 2; i++) {
+        threads[i].seed = 1 + i;
+        threads[i].predecoded = predecoded;
+        threads[i].failures = 0;
+        pthread_create(&ids[i], NULL, test_thread, &threads[i]);
+    }
+    for (i = 0; i < 2; i++) {
+        pthread_join(ids[i], NULL);
+        failures += threads[i].failures;
+    }
+
+    printf("%s: %d of %d runs differ\n",
+        predecoded ? "run_task_predecoded" : "run_task", failures, 2 * RUNS);
+    return failures;
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    failures += test_parallel(0);
+    failures += test_parallel(1);
+    return (failures != 0);
+}
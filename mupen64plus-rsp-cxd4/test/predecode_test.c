@@ -0,0 +1,343 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - predecode_test.c                                        *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+ * Runs the same seeded tasks through `run_task' and `run_task_predecoded',
+ * and checks that both leave the same DMEM, IMEM and registers, scalar,
+ * vector and control.  `run_task' decodes every instruction as it runs it,
+ * so it is the reference of the pre-decoding loop.
+ *
+ * random      a loop over random instructions of every class the
+ *             pre-decoder tells apart:  scalar computes, $zero as the
+ *             target, loads and stores, forward branches and jumps with
+ *             their delay slots, moves to and from COP2 and vector
+ *             computes with every element
+ * dma         a task which DMAs new code from RDRAM over a routine it
+ *             already ran, and over the code right after the DMA, which
+ *             it ran on its pass before
+ * rewrite     two tasks on the same context, the second loaded over the
+ *             IMEM of the first, which the pre-decoder saw
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "test_rsp.h"
+
+#define RUNS            300
+#define BODY_LENGTH     96
+#define LOOPS           4
+
+#define ROUTINE         0x800   /* IMEM addresses of the dma task */
+#define TAIL_LENGTH     16      /* words */
+#define ROUTINE_LENGTH  16
+#define DRAM_ROUTINES   0x000   /* a version of the routine every 0x100 */
+#define DRAM_TAILS      0x800   /* a version of the tail every 0x100 */
+
+/* $1 to $3 address the DMA, $20 is the pass and $29 the loop counter */
+static const unsigned int dest_regs[] = {
+    0, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+    21, 22, 23, 24, 25, 26, 27, 28,
+};
+
+static unsigned int dest_reg(u32* seed)
+{
+    return dest_regs[test_rand(seed) % (sizeof(dest_regs) / sizeof(dest_regs[0]))];
+}
+
+/*
+ * a random instruction which neither branches nor jumps, nor touches COP0
+ */
+static u32 random_straight(u32* seed)
+{
+    static const unsigned int special[] = {
+        000, 002, 003, 004, 006, 007, 040, 041, 042, 043, 044, 045, 046, 047, 052, 053,
+    };
+    static const unsigned int immediate[] = { 010, 011, 012, 013, 014, 015, 016, 017 };
+    static const unsigned int memory[] = { 040, 041, 043, 044, 045, 050, 051, 053 };
+    const u32 r = test_rand(seed);
+    const unsigned int rs = test_rand(seed) % 32;
+    const unsigned int rt = test_rand(seed) % 32;
+    const unsigned int rd = dest_reg(seed);
+    const u32 imm = test_rand(seed) & 0xFFFF;
+
+    switch (r % 8) {
+    case 0:
+    case 1:
+        return (rs << 21 | rt << 16 | rd << 11 | (test_rand(seed) % 32) << 6
+              | special[test_rand(seed) % (sizeof(special) / sizeof(special[0]))]);
+    case 2:
+        return OP_I_TYPE(immediate[test_rand(seed) % 8], rs, rd, imm);
+    case 3: /* loads write rt, stores read it */
+        return OP_I_TYPE(memory[test_rand(seed) % 8], rs, dest_reg(seed), imm);
+    case 4: /* LWC2 and SWC2 of every kind, the offset in 7 bits */
+        return OP_I_TYPE((r & 8) ? 072 : 062, rs, rt, imm);
+    case 5: { /* MFC2, CFC2, MTC2 and CTC2 */
+        static const unsigned int moves[] = { 000, 002, 004, 006 };
+        const unsigned int move = moves[test_rand(seed) % 4];
+
+        return ((u32)022 << 26 | move << 21 | ((move & 4) ? rt : rd) << 16
+              | (test_rand(seed) % 32) << 11 | (test_rand(seed) % 16) << 7);
+    }
+    default: /* vector computes:  every element, every function */
+        return OP_VU(test_rand(seed) % 64, test_rand(seed) % 32, test_rand(seed) % 32,
+            test_rand(seed) % 32, test_rand(seed) % 16);
+    }
+}
+
+/*
+ * the random task:  `LOOPS' passes over `BODY_LENGTH' instructions, whose
+ * branches and jumps only go forward within the body
+ */
+static void random_task(u32* code, u32 seed)
+{
+    const unsigned int body = 1;
+    unsigned int i;
+
+    code[0] = OP_ORI(29, 0, LOOPS);
+    for (i = 0; i < BODY_LENGTH; i++) {
+        /* past the delay slot, at most to the decrement of the counter */
+        const unsigned int target = i + 2 + test_rand(&seed) % (BODY_LENGTH - i - 1);
+        const unsigned int rs = test_rand(&seed) % 32;
+        const unsigned int rt = test_rand(&seed) % 32;
+        const u32 offset = target - (i + 1);
+
+        /* the last one is a delay slot, and delay slots don't branch */
+        if (i + 1 == BODY_LENGTH || test_rand(&seed) % 6 != 0) {
+            code[body + i] = random_straight(&seed);
+            continue;
+        }
+        switch (test_rand(&seed) % 8) {
+        case 0:
+            code[body + i] = OP_I_TYPE(004, rs, rt, offset); /* BEQ */
+            break;
+        case 1:
+            code[body + i] = OP_BNE(rs, rt, offset);
+            break;
+        case 2:
+            code[body + i] = OP_I_TYPE(006, rs, 0, offset); /* BLEZ */
+            break;
+        case 3:
+            code[body + i] = OP_I_TYPE(007, rs, 0, offset); /* BGTZ */
+            break;
+        case 4: { /* BLTZ, BGEZ, BLTZAL and BGEZAL */
+            static const unsigned int regimm[] = { 000, 001, 020, 021 };
+
+            code[body + i] = OP_I_TYPE(001, rs, regimm[test_rand(&seed) % 4], offset);
+            break;
+        }
+        case 5:
+            code[body + i] = (u32)002 << 26 | (body + target); /* J */
+            break;
+        case 6:
+            code[body + i] = OP_JAL(4 * (body + target));
+            break;
+        default: /* a branch with $zero, taken or not */
+            code[body + i] = OP_I_TYPE(004, 0, (i & 1) ? 0 : rt, offset);
+        }
+        i++;
+        code[body + i] = random_straight(&seed);
+    }
+    code[body + BODY_LENGTH + 0] = OP_ADDIU(29, 29, -1);
+    code[body + BODY_LENGTH + 1] = OP_BNE(29, 0, -(BODY_LENGTH + 2));
+    code[body + BODY_LENGTH + 2] = OP_NOP;
+    code[body + BODY_LENGTH + 3] = OP_BREAK;
+}
+
+static void random_init(TEST_RSP* rsp, u32 seed)
+{
+    unsigned int i;
+
+    test_rsp_init(rsp);
+    for (i = 0; i < 0x1000 / 4; i++)
+        ((pu32)rsp -> mem)[i] = test_rand(&seed);
+    random_task((pu32)(rsp -> mem + 0x1000), seed);
+}
+
+/*
+ * the dma task, in two passes:
+ *
+ *   pass:  JAL ROUTINE
+ *          DMA the routine of the pass over ROUTINE
+ *          DMA the tail of the pass over tail
+ *   tail:  TAIL_LENGTH words, from RDRAM
+ *          next pass
+ *          JAL ROUTINE
+ *          BREAK
+ */
+static void dma_init(TEST_RSP* rsp, u32 seed)
+{
+    pu32 code = (pu32)(rsp -> mem + 0x1000);
+    unsigned int pos = 0, tail, pass;
+    unsigned int i;
+
+    test_rsp_init(rsp);
+    for (i = 0; i < 0x1000 / 4; i++)
+        ((pu32)rsp -> mem)[i] = test_rand(&seed);
+
+    /* the routines and the tails of the two passes, and IMEM's own */
+    for (pass = 0; pass < 3; pass++) {
+        pu32 routine = (pass < 2) ? (pu32)(rsp -> dram + DRAM_ROUTINES + 0x100 * pass) : code + ROUTINE / 4;
+        pu32 tail_code = (pu32)(rsp -> dram + DRAM_TAILS + 0x100 * pass);
+
+        for (i = 0; i < ROUTINE_LENGTH - 2; i++)
+            routine[i] = random_straight(&seed);
+        routine[i++] = OP_JR(31);
+        routine[i] = random_straight(&seed);
+        for (i = 0; i < TAIL_LENGTH; i++)
+            tail_code[i] = random_straight(&seed);
+    }
+
+    code[pos++] = OP_ORI(20, 0, 0);
+    pass = pos;
+    code[pos++] = OP_JAL(0x1000 | ROUTINE);
+    code[pos++] = OP_NOP;
+    code[pos++] = OP_ORI(1, 0, 0x1000 | ROUTINE);
+    code[pos++] = OP_ADDIU(2, 20, DRAM_ROUTINES);
+    code[pos++] = OP_ORI(3, 0, 4*ROUTINE_LENGTH - 1);
+    code[pos++] = OP_MTC0(1, 0);
+    code[pos++] = OP_MTC0(2, 1);
+    code[pos++] = OP_MTC0(3, 2);
+    tail = (pos + 5 + 1) & ~1; /* DMA works in double words */
+    code[pos++] = OP_ORI(1, 0, 0x1000 | 4*tail);
+    code[pos++] = OP_ADDIU(2, 20, DRAM_TAILS);
+    code[pos++] = OP_ORI(3, 0, 4*TAIL_LENGTH - 1);
+    code[pos++] = OP_MTC0(1, 0);
+    code[pos++] = OP_MTC0(2, 1);
+    while (pos < tail - 1)
+        code[pos++] = OP_NOP;
+    code[pos++] = OP_MTC0(3, 2);
+    /* in IMEM before the first DMA, the tail of the third pass */
+    memcpy(code + pos, rsp -> dram + DRAM_TAILS + 0x200, 4*TAIL_LENGTH);
+    pos += TAIL_LENGTH;
+    code[pos++] = OP_ADDIU(20, 20, 0x100);
+    code[pos++] = OP_ORI(29, 0, 0x200);
+    code[pos] = OP_BNE(20, 29, pass - (pos + 1));
+    pos++;
+    code[pos++] = OP_NOP;
+    code[pos++] = OP_JAL(0x1000 | ROUTINE);
+    code[pos++] = OP_NOP;
+    code[pos++] = OP_BREAK;
+}
+
+static int same_state(const TEST_RSP* a, const TEST_RSP* b)
+{
+    const RSP_CONTEXT* x = &a -> context;
+    const RSP_CONTEXT* y = &b -> context;
+
+    return (!memcmp(a -> mem, b -> mem, sizeof(a -> mem))
+         && !memcmp(a -> regs, b -> regs, sizeof(a -> regs))
+         && a -> SP_PC_REG == b -> SP_PC_REG
+         && !memcmp(x -> SR, y -> SR, sizeof(x -> SR))
+         && !memcmp(x -> VR, y -> VR, sizeof(x -> VR))
+         && !memcmp(x -> VACC, y -> VACC, sizeof(x -> VACC))
+         && !memcmp(x -> cf_ne, y -> cf_ne, sizeof(x -> cf_ne))
+         && !memcmp(x -> cf_co, y -> cf_co, sizeof(x -> cf_co))
+         && !memcmp(x -> cf_clip, y -> cf_clip, sizeof(x -> cf_clip))
+         && !memcmp(x -> cf_comp, y -> cf_comp, sizeof(x -> cf_comp))
+         && !memcmp(x -> cf_vce, y -> cf_vce, sizeof(x -> cf_vce))
+         && x -> DivIn == y -> DivIn
+         && x -> DivOut == y -> DivOut
+         && x -> DPH == y -> DPH);
+}
+
+static TEST_RSP plain, predecoded;
+
+static int test_random(void)
+{
+    int failures = 0;
+    u32 seed;
+
+    for (seed = 1; seed <= RUNS; seed++) {
+        random_init(&plain, seed);
+        random_init(&predecoded, seed);
+        test_rsp_run(&plain, 0);
+        test_rsp_run(&predecoded, 1);
+
+        if (!(plain.regs[0x4] & SP_STATUS_BROKE) || !same_state(&plain, &predecoded)) {
+            fprintf(stderr, "random, seed %u: the state differs\n", seed);
+            failures++;
+        }
+    }
+    printf("random: %d of %d runs differ\n", failures, RUNS);
+    return failures;
+}
+
+static int test_dma(void)
+{
+    int failures = 0;
+    u32 seed;
+
+    for (seed = 1; seed <= RUNS; seed++) {
+        dma_init(&plain, seed);
+        dma_init(&predecoded, seed);
+        test_rsp_run(&plain, 0);
+        test_rsp_run(&predecoded, 1);
+
+        /* the task must have replaced its routine with the second one */
+        if (!(plain.regs[0x4] & SP_STATUS_BROKE)
+         || memcmp(plain.mem + 0x1000 + ROUTINE, plain.dram + DRAM_ROUTINES + 0x100, 4*ROUTINE_LENGTH)) {
+            fprintf(stderr, "dma, seed %u: the task did not run\n", seed);
+            failures++;
+        } else if (!same_state(&plain, &predecoded)) {
+            fprintf(stderr, "dma, seed %u: the state differs\n", seed);
+            failures++;
+        }
+    }
+    printf("dma: %d of %d runs differ\n", failures, RUNS);
+    return failures;
+}
+
+static int test_rewrite(void)
+{
+    int failures = 0;
+    u32 seed;
+
+    for (seed = 1; seed <= RUNS; seed++) {
+        TEST_RSP* rsp[2];
+        int i;
+
+        rsp[0] = &plain;
+        rsp[1] = &predecoded;
+        for (i = 0; i < 2; i++) {
+            random_init(rsp[i], seed);
+            test_rsp_run(rsp[i], i);
+            random_task((pu32)(rsp[i] -> mem + 0x1000), seed + RUNS);
+            test_rsp_run(rsp[i], i);
+        }
+        if (!(plain.regs[0x4] & SP_STATUS_BROKE) || !same_state(&plain, &predecoded)) {
+            fprintf(stderr, "rewrite, seed %u: the state differs\n", seed);
+            failures++;
+        }
+    }
+    printf("rewrite: %d of %d runs differ\n", failures, RUNS);
+    return failures;
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    failures += test_random();
+    failures += test_dma();
+    failures += test_rewrite();
+    return (failures != 0);
+}
@@ -0,0 +1,87 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - test_rsp.c                                              *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include <string.h>
+
+#include "test_rsp.h"
+
+/*
+ * The interpreter reports here what it does not emulate, like VSAW with an
+ * illegal element.  The tests check the state that results instead.
+ */
+NOINLINE void message(const char* body)
+{
+    body = NULL; /* unused */
+    return;
+}
+
+static void check_interrupts(void)
+{
+}
+
+void test_rsp_init(TEST_RSP* rsp)
+{
+    RSP_INFO info;
+
+    memset(rsp, 0, sizeof(*rsp));
+    memset(&info, 0, sizeof(info));
+    info.RDRAM = rsp -> dram;
+    info.DMEM = rsp -> mem;
+    info.IMEM = rsp -> mem + 0x1000;
+    info.MI_INTR_REG = &rsp -> MI_INTR_REG;
+    info.SP_MEM_ADDR_REG = &rsp -> regs[0x0];
+    info.SP_DRAM_ADDR_REG = &rsp -> regs[0x1];
+    info.SP_RD_LEN_REG = &rsp -> regs[0x2];
+    info.SP_WR_LEN_REG = &rsp -> regs[0x3];
+    info.SP_STATUS_REG = &rsp -> regs[0x4];
+    info.SP_DMA_FULL_REG = &rsp -> regs[0x5];
+    info.SP_DMA_BUSY_REG = &rsp -> regs[0x6];
+    info.SP_SEMAPHORE_REG = &rsp -> regs[0x7];
+    info.DPC_START_REG = &rsp -> regs[0x8];
+    info.DPC_END_REG = &rsp -> regs[0x9];
+    info.DPC_CURRENT_REG = &rsp -> regs[0xA];
+    info.DPC_STATUS_REG = &rsp -> regs[0xB];
+    info.DPC_CLOCK_REG = &rsp -> regs[0xC];
+    info.DPC_BUFBUSY_REG = &rsp -> regs[0xD];
+    info.DPC_PIPEBUSY_REG = &rsp -> regs[0xE];
+    info.DPC_TMEM_REG = &rsp -> regs[0xF];
+    info.SP_PC_REG = &rsp -> SP_PC_REG;
+    info.CheckInterrupts = check_interrupts;
+    rsp_context_init(&rsp -> context, &info);
+}
+
+void test_rsp_run(TEST_RSP* rsp, int predecoded)
+{
+    rsp_context_make_current(&rsp -> context);
+    rsp -> SP_PC_REG = 0x04001000;
+    rsp -> regs[0x4] = 0x00000000; /* SP_STATUS_REG, running */
+    if (predecoded)
+        run_task_predecoded();
+    else
+        run_task();
+}
+
+u32 test_rand(u32* state)
+{
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16 | *state << 16);
+}
@@ -0,0 +1,78 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - test_rsp.h                                              *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef _TEST_RSP_H_
+#define _TEST_RSP_H_
+
+#include "../su.h"
+#include "../context.h"
+
+/*
+ * an RSP of the tests:  a context with its own DMEM, IMEM and registers,
+ * and a little RDRAM to DMA from
+ */
+typedef struct {
+    RSP_CONTEXT context;
+    u8 mem[0x2000]; /* DMEM then IMEM, as the core lays them out */
+    u8 dram[0x1000];
+    u32 MI_INTR_REG;
+    u32 regs[16];
+    u32 SP_PC_REG;
+} TEST_RSP;
+
+/* MIPS and RSP encodings of the instructions the tests use */
+#define OP_I_TYPE(op, rs, rt, imm) \
+    ((u32)(op) << 26 | (rs) << 21 | (rt) << 16 | ((imm) & 0xFFFF))
+#define OP_ORI(rt, rs, imm)        OP_I_TYPE(015, rs, rt, imm)
+#define OP_ADDIU(rt, rs, imm)      OP_I_TYPE(011, rs, rt, imm)
+#define OP_LW(rt, off, base)       OP_I_TYPE(043, base, rt, off)
+#define OP_SW(rt, off, base)       OP_I_TYPE(053, base, rt, off)
+#define OP_BNE(rs, rt, off)        OP_I_TYPE(005, rs, rt, off)
+#define OP_ADDU(rd, rs, rt)        ((rs) << 21 | (rt) << 16 | (rd) << 11 | 041)
+#define OP_JAL(addr)               ((u32)003 << 26 | ((addr) >> 2 & 0x03FFFFFF))
+#define OP_JR(rs)                  ((rs) << 21 | 010)
+#define OP_MTC0(rt, rd)            ((u32)020 << 26 | 004 << 21 | (rt) << 16 | (rd) << 11)
+#define OP_NOP                     0x00000000
+#define OP_BREAK                   0x0000000D
+#define OP_LQV(vt, off, base)      OP_I_TYPE(062, base, vt, 4 << 11 | ((off) >> 4 & 0x7F))
+#define OP_SQV(vt, off, base)      OP_I_TYPE(072, base, vt, 4 << 11 | ((off) >> 4 & 0x7F))
+#define OP_VU(funct, vd, vs, vt, e) \
+    ((u32)022 << 26 | 1 << 25 | (e) << 21 | (vt) << 16 | (vs) << 11 | (vd) << 6 | (funct))
+
+/*
+ * Wipes the RSP, with its memory, and attaches its context to it.
+ */
+extern void test_rsp_init(TEST_RSP* rsp);
+
+/*
+ * Makes the RSP's context current on the calling thread and runs the
+ * program in IMEM from address 0 to its BREAK.
+ */
+extern void test_rsp_run(TEST_RSP* rsp, int predecoded);
+
+/*
+ * the next number of a sequence private to the caller
+ * (rand() is shared by the threads)
+ */
+extern u32 test_rand(u32* state);
+
+#endif
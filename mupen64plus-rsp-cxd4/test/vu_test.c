@@ -0,0 +1,263 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - vu_test.c                                               *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * Checks every vector computational operation against vectors captured from
+ * the plain C build of the vector unit, so that the SSE2 and NEON builds
+ * are held to the scalar results bit for bit on any host.
+ *
+ *   vu_test vu_vectors.txt            compares, exits with 1 on mismatches
+ *   vu_test --write vu_vectors.txt    captures (from the scalar build only)
+ *
+ * Each case runs one instruction `op $v3, $v1, $v2[e]' through the
+ * interpreter, so the element shuffles of su.c are part of what is tested.
+ * The inputs are VR[vs], VR[vt], the accumulator, VCO, VCC, VCE and the
+ * divide state, drawn from a sequence seeded by the case and biased
+ * towards the 16-bit edge values.  A line of the vectors file holds
+ *
+ *   <op> <e> <inputs> <outputs>
+ *
+ * in hexadecimal:  <inputs> is VR[vt] followed by the words of state_get()
+ * before the instruction, and <outputs> the same words after it except
+ * VR[vs] (see state_format()).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_rsp.h"
+
+#define STATE_WORDS         (N + N + 3*N + 3 + 3)
+#define STATE_TEXT          (4*(N + STATE_WORDS) + 1)
+
+typedef struct {
+    const char* name;
+    unsigned int funct;
+} VU_OP;
+
+static const VU_OP ops[] = {
+    { "VMULF", 000 }, { "VMULU", 001 }, { "VMUDL", 004 }, { "VMUDM", 005 },
+    { "VMUDN", 006 }, { "VMUDH", 007 }, { "VMACF", 010 }, { "VMACU", 011 },
+    { "VMADL", 014 }, { "VMADM", 015 }, { "VMADN", 016 }, { "VMADH", 017 },
+    { "VADD",  020 }, { "VSUB",  021 }, { "VABS",  023 }, { "VADDC", 024 },
+    { "VSUBC", 025 }, { "VSAW",  035 }, { "VLT",   040 }, { "VEQ",   041 },
+    { "VNE",   042 }, { "VGE",   043 }, { "VCL",   044 }, { "VCH",   045 },
+    { "VCR",   046 }, { "VMRG",  047 }, { "VAND",  050 }, { "VNAND", 051 },
+    { "VOR",   052 }, { "VNOR",  053 }, { "VXOR",  054 }, { "VNXOR", 055 },
+    { "VRCP",  060 }, { "VRCPL", 061 }, { "VRCPH", 062 }, { "VMOV",  063 },
+    { "VRSQ",  064 }, { "VRSQL", 065 }, { "VRSQH", 066 }, { "VNOP",  067 },
+};
+
+static const u16 edge_values[] = {
+    0x0000, 0x0001, 0xFFFF, 0x7FFF, 0x8000, 0x7FFE, 0x8001, 0x00FF, 0xFF00,
+};
+
+static u16 test_value(u32* seed)
+{
+    const u32 r = test_rand(seed);
+
+    if ((r & 3) == 0)
+        return edge_values[(r >> 2) % (sizeof(edge_values) / sizeof(edge_values[0]))];
+    return (u16)(r >> 8);
+}
+
+/*
+ * the state an instruction reads or writes, as 16-bit words:
+ * VR[vd], VR[vs] and VR[vt] (the destination first), VACC, VCO, VCC, VCE,
+ * DivIn, DivOut and DPH (each 32-bit one as its low word)
+ */
+static void state_get(u16* state)
+{
+    unsigned int i, j;
+
+    for (i = 0; i < N; i++) {
+        state[0*N + i] = rsp_current -> VR[3][i];
+        state[1*N + i] = rsp_current -> VR[1][i];
+    }
+    for (j = 0; j < 3; j++)
+        for (i = 0; i < N; i++)
+            state[2*N + j*N + i] = rsp_current -> VACC[j][i];
+    state[5*N + 0] = get_VCO();
+    state[5*N + 1] = get_VCC();
+    state[5*N + 2] = get_VCE();
+    state[5*N + 3] = (u16)rsp_current -> DivIn;
+    state[5*N + 4] = (u16)rsp_current -> DivOut;
+    state[5*N + 5] = (u16)rsp_current -> DPH;
+}
+
+static void state_set(const u16* state, const u16* vt)
+{
+    unsigned int i, j;
+
+    for (i = 0; i < N; i++) {
+        rsp_current -> VR[3][i] = state[0*N + i];
+        rsp_current -> VR[1][i] = state[1*N + i];
+        rsp_current -> VR[2][i] = vt[i];
+    }
+    for (j = 0; j < 3; j++)
+        for (i = 0; i < N; i++)
+            rsp_current -> VACC[j][i] = state[2*N + j*N + i];
+    set_VCO(state[5*N + 0]);
+    set_VCC(state[5*N + 1]);
+    set_VCE((u8)state[5*N + 2]);
+    rsp_current -> DivIn = (i16)state[5*N + 3];
+    rsp_current -> DivOut = (i16)state[5*N + 4];
+    rsp_current -> DPH = state[5*N + 5] & 1;
+}
+
+/*
+ * Formats VR[vt] and the state, or without `vt' the state except VR[vs],
+ * which no operation writes.
+ */
+static void state_format(char* text, const u16* state, const u16* vt)
+{
+    unsigned int i;
+
+    if (vt != NULL)
+        for (i = 0; i < N; i++)
+            text += sprintf(text, "%04X", vt[i]);
+    for (i = 0; i < STATE_WORDS; i++)
+        if (vt != NULL || i < 1*N || i >= 2*N)
+            text += sprintf(text, "%04X", state[i]);
+}
+
+/*
+ * Runs `op' with element `e', and formats the state before and after it.
+ */
+static void run_case(
+    TEST_RSP* rsp, const VU_OP* op, unsigned int e, char* inputs, char* outputs)
+{
+    u16 state[STATE_WORDS], vt[N];
+    u32 seed;
+    unsigned int i;
+
+    seed = op -> funct << 8 | e;
+    for (i = 0; i < STATE_WORDS; i++)
+        state[i] = test_value(&seed);
+    for (i = 0; i < N; i++)
+        vt[i] = test_value(&seed);
+    state[5*N + 2] &= 0x00FF;
+    state[5*N + 5] &= 0x0001;
+
+    test_rsp_init(rsp);
+    ((pu32)(rsp -> mem + 0x1000))[0] = OP_VU(op -> funct, 3, 1, 2, e);
+    ((pu32)(rsp -> mem + 0x1000))[1] = OP_BREAK;
+    rsp_context_make_current(&rsp -> context);
+    state_set(state, vt);
+    state_format(inputs, state, vt);
+
+    test_rsp_run(rsp, 0);
+    state_get(state);
+    state_format(outputs, state, NULL);
+}
+
+static int capture(const char* path)
+{
+    static TEST_RSP rsp;
+    char inputs[STATE_TEXT], outputs[STATE_TEXT];
+    FILE* stream;
+    unsigned int i, e;
+
+#if defined(ARCH_MIN_SSE2) || defined(ARCH_MIN_ARM_NEON)
+    fprintf(stderr, "vectors are captured from the scalar build only\n");
+    return 1;
+#endif
+    stream = fopen(path, "w");
+    if (stream == NULL) {
+        perror(path);
+        return 1;
+    }
+    for (i = 0; i < sizeof(ops) / sizeof(ops[0]); i++)
+        for (e = 0; e < 16; e++) {
+            run_case(&rsp, &ops[i], e, inputs, outputs);
+            fprintf(stream, "%s %u %s %s\n", ops[i].name, e, inputs, outputs);
+        }
+    fclose(stream);
+    return 0;
+}
+
+static int compare(const char* path)
+{
+    static TEST_RSP rsp;
+    char line[32 + 2*STATE_TEXT];
+    char name[16], expected_inputs[256], expected_outputs[256];
+    char inputs[STATE_TEXT], outputs[STATE_TEXT];
+    FILE* stream;
+    unsigned int i, e;
+    int cases = 0, failures = 0;
+
+    stream = fopen(path, "r");
+    if (stream == NULL) {
+        perror(path);
+        return 1;
+    }
+    while (fgets(line, sizeof(line), stream) != NULL) {
+        const VU_OP* op = NULL;
+
+        if (sscanf(line, "%15s %u %255s %255s",
+            name, &e, expected_inputs, expected_outputs) != 4)
+            continue;
+        for (i = 0; i < sizeof(ops) / sizeof(ops[0]); i++)
+            if (strcmp(ops[i].name, name) == 0)
+                op = &ops[i];
+        if (op == NULL) {
+            fprintf(stderr, "unknown operation %s\n", name);
+            failures++;
+            continue;
+        }
+
+        run_case(&rsp, op, e, inputs, outputs);
+        cases++;
+        if (strcmp(inputs, expected_inputs) != 0) {
+            fprintf(stderr, "%s %u: inputs differ from the vectors file\n",
+                name, e);
+            failures++;
+        } else if (strcmp(outputs, expected_outputs) != 0) {
+            fprintf(stderr, "%s %u:\n  in       %s\n  expected %s\n  got      %s\n",
+                name, e, inputs, expected_outputs, outputs);
+            failures++;
+        }
+    }
+    fclose(stream);
+
+    printf("%s: %d of %d cases differ\n",
+#if defined(ARCH_MIN_SSE2)
+        "SSE2",
+#elif defined(ARCH_MIN_ARM_NEON)
+        "NEON",
+#else
+        "scalar",
+#endif
+        failures, cases);
+    return (failures != 0 || cases == 0);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 3 && strcmp(argv[1], "--write") == 0)
+        return capture(argv[2]);
+    if (argc == 2)
+        return compare(argv[1]);
+    fprintf(stderr, "usage: %s [--write] VECTORS\n", argv[0]);
+    return 2;
+}
@@ -23,7 +23,7 @@ static INLINE void SIGNED_CLAMP_ADD(pi16 VD, pi16 VS, pi16 VT)
 
     src = _mm_load_si128((v16 *)VS);
     dst = _mm_load_si128((v16 *)VT);
-    vco = _mm_load_si128((v16 *)cf_co);
+    vco = _mm_load_si128((v16 *)rsp_current -> cf_co);
 
 /*
  * Due to premature clamping in between adds, sometimes we need to add the
@@ -45,7 +45,7 @@ static INLINE void SIGNED_CLAMP_SUB(pi16 VD, pi16 VS, pi16 VT)
 
     src = _mm_load_si128((v16 *)VS);
     dst = _mm_load_si128((v16 *)VT);
-    vco = _mm_load_si128((v16 *)cf_co);
+    vco = _mm_load_si128((v16 *)rsp_current -> cf_co);
 
     res = _mm_subs_epi16(src, dst);
 
@@ -75,7 +75,7 @@ static INLINE void SIGNED_CLAMP_ADD(pi16 VD, pi16 VS, pi16 VT)
     register int i;
 
     for (i = 0; i < N; i++)
-        sum[i] = VS[i] + VT[i] + cf_co[i];
+        sum[i] = VS[i] + VT[i] + rsp_current -> cf_co[i];
     for (i = 0; i < N; i++)
         lo[i] = (sum[i] + 0x8000) >> 31;
     for (i = 0; i < N; i++)
@@ -96,7 +96,7 @@ static INLINE void SIGNED_CLAMP_SUB(pi16 VD, pi16 VS, pi16 VT)
     register int i;
 
     for (i = 0; i < N; i++)
-        dif[i] = VS[i] - VT[i] - cf_co[i];
+        dif[i] = VS[i] - VT[i] - rsp_current -> cf_co[i];
     for (i = 0; i < N; i++)
         lo[i] = (dif[i] + 0x8000) >> 31;
     for (i = 0; i < N; i++)
@@ -112,17 +112,107 @@ static INLINE void SIGNED_CLAMP_SUB(pi16 VD, pi16 VS, pi16 VT)
 }
 #endif
 
+#ifdef ARCH_MIN_ARM_NEON
+#define S16(v)  vreinterpretq_s16_u16(v)
+
+INLINE static void clr_ci(pi16 VD, pi16 VS, pi16 VT)
+{ /* clear CARRY and carry in to accumulators */
+    int16x8_t vs, vt, vco;
+    int32x4_t sum_lo, sum_hi;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    vco = vld1q_s16(rsp_current -> cf_co);
+    sum_lo = vaddw_s16(vaddl_s16(vget_low_s16(vs), vget_low_s16(vt)),
+                       vget_low_s16(vco));
+    sum_hi = vaddw_s16(vaddl_s16(vget_high_s16(vs), vget_high_s16(vt)),
+                       vget_high_s16(vco));
+    vst1q_s16(VACC_L, vcombine_s16(vmovn_s32(sum_lo), vmovn_s32(sum_hi)));
+    vst1q_s16(VD, vcombine_s16(vqmovn_s32(sum_lo), vqmovn_s32(sum_hi)));
+
+ /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
+    return;
+}
+
+INLINE static void clr_bi(pi16 VD, pi16 VS, pi16 VT)
+{ /* clear CARRY and borrow in to accumulators */
+    int16x8_t vs, vt, vco;
+    int32x4_t dif_lo, dif_hi;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    vco = vld1q_s16(rsp_current -> cf_co);
+    dif_lo = vsubw_s16(vsubl_s16(vget_low_s16(vs), vget_low_s16(vt)),
+                       vget_low_s16(vco));
+    dif_hi = vsubw_s16(vsubl_s16(vget_high_s16(vs), vget_high_s16(vt)),
+                       vget_high_s16(vco));
+    vst1q_s16(VACC_L, vcombine_s16(vmovn_s32(dif_lo), vmovn_s32(dif_hi)));
+    vst1q_s16(VD, vcombine_s16(vqmovn_s32(dif_lo), vqmovn_s32(dif_hi)));
+
+ /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
+    return;
+}
+
+INLINE static void do_abs(pi16 VD, pi16 VS, pi16 VT)
+{ /* See the generic version below for the corner case. */
+    int16x8_t vs, vt, sign, res;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    sign = vsubq_s16(
+        vector_flag(vcgtq_s16(vs, vdupq_n_s16(0x0000))),
+        vector_flag(vcltq_s16(vs, vdupq_n_s16(0x0000)))
+    );
+    res = vmulq_s16(vt, sign);
+    res = vsubq_s16(res, vector_flag(vceqq_s16(vt, vdupq_n_s16(-32768))));
+    vst1q_s16(VACC_L, res);
+    vst1q_s16(VD, res);
+    return;
+}
+
+INLINE static void set_co(pi16 VD, pi16 VS, pi16 VT)
+{ /* set CARRY and carry out from sum */
+    uint16x8_t vs, sum;
+
+    vs = vld1q_u16((u16 *)VS);
+    sum = vaddq_u16(vs, vld1q_u16((u16 *)VT));
+    vst1q_s16(VACC_L, S16(sum));
+    vst1q_s16(VD, S16(sum));
+
+    vector_wipe(rsp_current -> cf_ne);
+    vst1q_s16(rsp_current -> cf_co, vector_flag(vcltq_u16(sum, vs)));
+    return;
+}
+
+INLINE static void set_bo(pi16 VD, pi16 VS, pi16 VT)
+{ /* set CARRY and borrow out from difference */
+    uint16x8_t vs, vt, dif;
+
+    vs = vld1q_u16((u16 *)VS);
+    vt = vld1q_u16((u16 *)VT);
+    dif = vsubq_u16(vs, vt);
+    vst1q_s16(VACC_L, S16(dif));
+    vst1q_s16(rsp_current -> cf_ne, vector_flag(vmvnq_u16(vceqq_u16(vs, vt))));
+    vst1q_s16(rsp_current -> cf_co, vector_flag(vcltq_u16(vs, vt)));
+    vst1q_s16(VD, S16(dif));
+    return;
+}
+#else
 INLINE static void clr_ci(pi16 VD, pi16 VS, pi16 VT)
 { /* clear CARRY and carry in to accumulators */
     register int i;
 
     for (i = 0; i < N; i++)
-        VACC_L[i] = VS[i] + VT[i] + cf_co[i];
+        VACC_L[i] = VS[i] + VT[i] + rsp_current -> cf_co[i];
     SIGNED_CLAMP_ADD(VD, VS, VT);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
     return;
 }
 
@@ -131,12 +221,12 @@ INLINE static void clr_bi(pi16 VD, pi16 VS, pi16 VT)
     register int i;
 
     for (i = 0; i < N; i++)
-        VACC_L[i] = VS[i] - VT[i] - cf_co[i];
+        VACC_L[i] = VS[i] - VT[i] - rsp_current -> cf_co[i];
     SIGNED_CLAMP_SUB(VD, VS, VT);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
     return;
 }
 
@@ -188,9 +278,9 @@ INLINE static void set_co(pi16 VD, pi16 VS, pi16 VT)
         VACC_L[i] = VS[i] + VT[i];
     vector_copy(VD, VACC_L);
 
-    vector_wipe(cf_ne);
+    vector_wipe(rsp_current -> cf_ne);
     for (i = 0; i < N; i++)
-        cf_co[i] = sum[i] >> 16; /* native:  (sum[i] > +65535) */
+        rsp_current -> cf_co[i] = sum[i] >> 16; /* native:  (sum[i] > +65535) */
     return;
 }
 
@@ -204,12 +294,13 @@ INLINE static void set_bo(pi16 VD, pi16 VS, pi16 VT)
     for (i = 0; i < N; i++)
         VACC_L[i] = VS[i] - VT[i];
     for (i = 0; i < N; i++)
-        cf_ne[i] = (VS[i] != VT[i]);
+        rsp_current -> cf_ne[i] = (VS[i] != VT[i]);
     for (i = 0; i < N; i++)
-        cf_co[i] = (dif[i] < 0);
+        rsp_current -> cf_co[i] = (dif[i] < 0);
     vector_copy(VD, VACC_L);
     return;
 }
+#endif
 
 VECTOR_OPERATION VADD(v16 vs, v16 vt)
 {
@@ -230,7 +321,7 @@ VECTOR_OPERATION VADD(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -254,7 +345,7 @@ VECTOR_OPERATION VSUB(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -278,7 +369,7 @@ VECTOR_OPERATION VABS(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -302,7 +393,7 @@ VECTOR_OPERATION VADDC(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -326,7 +417,7 @@ VECTOR_OPERATION VSUBC(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -335,7 +426,7 @@ VECTOR_OPERATION VSAW(v16 vs, v16 vt)
 {
     unsigned int element;
 
-    element  = 0xF & (inst_word >> 21);
+    element  = 0xF & (rsp_current -> inst_word >> 21);
     element ^= 0x8; /* Convert scalar whole elements 8:F to 0:7. */
 
     if (element > 0x2) {
@@ -343,13 +434,13 @@ VECTOR_OPERATION VSAW(v16 vs, v16 vt)
 #ifdef ARCH_MIN_SSE2
         vector_wipe(vs);
 #else
-        vector_wipe(V_result);
+        vector_wipe(rsp_current -> V_result);
 #endif
     } else {
 #ifdef ARCH_MIN_SSE2
-        vs = *(v16 *)VACC[element];
+        vs = *(v16 *)rsp_current -> VACC[element];
 #else
-        vector_copy(V_result, VACC[element]);
+        vector_copy(rsp_current -> V_result, rsp_current -> VACC[element]);
 #endif
     }
 #ifdef ARCH_MIN_SSE2
@@ -15,8 +15,9 @@
 
 #include "divide.h"
 
-static s32 DivIn = 0; /* buffered numerator of division read from vector file */
-static s32 DivOut = 0; /* global division result set by VRCP/VRCPL/VRSQ/VRSQL */
+/*
+ * DivIn, DivOut and DPH are kept in the current context (`context.h').
+ */
 #if (0 != 0)
 static s32 MovIn; /* We do not emulate this register (obsolete, for VMOV). */
 #endif
@@ -31,7 +32,6 @@ static s32 MovIn; /* We do not emulate this register (obsolete, for VMOV). */
  * else if (lastDivideOp == VMOV, VNOP)
  *     DPH = DPH; // no change--divide-group ops but not real divides
  */
-static int DPH = 0;
 
 /*
  * 11-bit vector divide result look-up table
@@ -1112,37 +1112,37 @@ NOINLINE static void do_div(i32 data, int sqrt, int precision)
     }
     shift ^= 31; /* flipping shift direction from left- to right- */
     shift >>= (sqrt == SP_DIV_SQRT_YES);
-    DivOut = (0x40000000UL | ((u32)div_ROM[addr] << 14)) >> shift;
-    if (DivIn == 0) /* corner case:  overflow via division by zero */
-        DivOut = +0x7FFFFFFFl;
-    else if (DivIn == -32768) /* corner case:  signed underflow barrier */
-        DivOut = -0x00010000l;
+    rsp_current -> DivOut = (0x40000000UL | ((u32)div_ROM[addr] << 14)) >> shift;
+    if (rsp_current -> DivIn == 0) /* corner case:  overflow via division by zero */
+        rsp_current -> DivOut = +0x7FFFFFFFl;
+    else if (rsp_current -> DivIn == -32768) /* corner case:  signed underflow barrier */
+        rsp_current -> DivOut = -0x00010000l;
     else
-        DivOut ^= (DivIn < 0) ? ~0 : 0;
+        rsp_current -> DivOut ^= (rsp_current -> DivIn < 0) ? ~0 : 0;
     return;
 }
 
 VECTOR_OPERATION VRCP(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
-    const int source = (inst_word & 0x0000FFFF) >> 11;
-    const int target = (inst_word >> 16) & 31;
-    const unsigned int element = (inst_word >> 21) & 0x7;
+    const int result = (rsp_current -> inst_word & 0x000007FF) >>  6;
+    const int source = (rsp_current -> inst_word & 0x0000FFFF) >> 11;
+    const int target = (rsp_current -> inst_word >> 16) & 31;
+    const unsigned int element = (rsp_current -> inst_word >> 21) & 0x7;
 
-    DivIn = (i32)VR[target][element];
-    do_div(DivIn, SP_DIV_SQRT_NO, SP_DIV_PRECISION_SINGLE);
+    rsp_current -> DivIn = (i32)rsp_current -> VR[target][element];
+    do_div(rsp_current -> DivIn, SP_DIV_SQRT_NO, SP_DIV_PRECISION_SINGLE);
 #ifdef ARCH_MIN_SSE2
     *(v16 *)VACC_L = vt;
 #else
     vector_copy(VACC_L, vt);
 #endif
-    VR[result][source & 07] = (i16)DivOut;
-    DPH = SP_DIV_PRECISION_SINGLE;
+    rsp_current -> VR[result][source & 07] = (i16)rsp_current -> DivOut;
+    rsp_current -> DPH = SP_DIV_PRECISION_SINGLE;
 #ifdef ARCH_MIN_SSE2
-    vs = *(v16 *)VR[result];
+    vs = *(v16 *)rsp_current -> VR[result];
     return (vs);
 #else
-    vector_copy(V_result, VR[result]);
+    vector_copy(rsp_current -> V_result, rsp_current -> VR[result]);
     vs = vt; /* unused */
     return;
 #endif
@@ -1150,26 +1150,26 @@ VECTOR_OPERATION VRCP(v16 vs, v16 vt)
 
 VECTOR_OPERATION VRCPL(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
-    const int source = (inst_word & 0x0000FFFF) >> 11;
-    const int target = (inst_word >> 16) & 31;
-    const unsigned int element = (inst_word >> 21) & 0x7;
+    const int result = (rsp_current -> inst_word & 0x000007FF) >>  6;
+    const int source = (rsp_current -> inst_word & 0x0000FFFF) >> 11;
+    const int target = (rsp_current -> inst_word >> 16) & 31;
+    const unsigned int element = (rsp_current -> inst_word >> 21) & 0x7;
 
-    DivIn &= DPH;
-    DivIn |= (u16)VR[target][element];
-    do_div(DivIn, SP_DIV_SQRT_NO, DPH);
+    rsp_current -> DivIn &= rsp_current -> DPH;
+    rsp_current -> DivIn |= (u16)rsp_current -> VR[target][element];
+    do_div(rsp_current -> DivIn, SP_DIV_SQRT_NO, rsp_current -> DPH);
 #ifdef ARCH_MIN_SSE2
     *(v16 *)VACC_L = vt;
 #else
     vector_copy(VACC_L, vt);
 #endif
-    VR[result][source & 07] = (i16)DivOut;
-    DPH = SP_DIV_PRECISION_SINGLE;
+    rsp_current -> VR[result][source & 07] = (i16)rsp_current -> DivOut;
+    rsp_current -> DPH = SP_DIV_PRECISION_SINGLE;
 #ifdef ARCH_MIN_SSE2
-    vs = *(v16 *)VR[result];
+    vs = *(v16 *)rsp_current -> VR[result];
     return (vs);
 #else
-    vector_copy(V_result, VR[result]);
+    vector_copy(rsp_current -> V_result, rsp_current -> VR[result]);
     vs = vt; /* unused */
     return;
 #endif
@@ -1177,24 +1177,24 @@ VECTOR_OPERATION VRCPL(v16 vs, v16 vt)
 
 VECTOR_OPERATION VRCPH(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
-    const int source = (inst_word & 0x0000FFFF) >> 11;
-    const int target = (inst_word >> 16) & 31;
-    const unsigned int element = (inst_word >> 21) & 0x7;
+    const int result = (rsp_current -> inst_word & 0x000007FF) >>  6;
+    const int source = (rsp_current -> inst_word & 0x0000FFFF) >> 11;
+    const int target = (rsp_current -> inst_word >> 16) & 31;
+    const unsigned int element = (rsp_current -> inst_word >> 21) & 0x7;
 
-    DivIn = VR[target][element] << 16;
+    rsp_current -> DivIn = rsp_current -> VR[target][element] << 16;
 #ifdef ARCH_MIN_SSE2
     *(v16 *)VACC_L = vt;
 #else
     vector_copy(VACC_L, vt);
 #endif
-    VR[result][source & 07] = DivOut >> 16;
-    DPH = SP_DIV_PRECISION_DOUBLE;
+    rsp_current -> VR[result][source & 07] = rsp_current -> DivOut >> 16;
+    rsp_current -> DPH = SP_DIV_PRECISION_DOUBLE;
 #ifdef ARCH_MIN_SSE2
-    vs = *(v16 *)VR[result];
+    vs = *(v16 *)rsp_current -> VR[result];
     return (vs);
 #else
-    vector_copy(V_result, VR[result]);
+    vector_copy(rsp_current -> V_result, rsp_current -> VR[result]);
     vs = vt; /* unused */
     return;
 #endif
@@ -1202,21 +1202,21 @@ VECTOR_OPERATION VRCPH(v16 vs, v16 vt)
 
 VECTOR_OPERATION VMOV(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
-    const int source = (inst_word & 0x0000FFFF) >> 11;
-    const unsigned int element = (inst_word >> 21) & 0x7;
+    const int result = (rsp_current -> inst_word & 0x000007FF) >>  6;
+    const int source = (rsp_current -> inst_word & 0x0000FFFF) >> 11;
+    const unsigned int element = (rsp_current -> inst_word >> 21) & 0x7;
 
 #ifdef ARCH_MIN_SSE2
     *(v16 *)VACC_L = vt;
 #else
     vector_copy(VACC_L, vt);
 #endif
-    VR[result][source & 07] = VACC_L[element];
+    rsp_current -> VR[result][source & 07] = VACC_L[element];
 #ifdef ARCH_MIN_SSE2
-    vs = *(v16 *)VR[result];
+    vs = *(v16 *)rsp_current -> VR[result];
     return (vs);
 #else
-    vector_copy(V_result, VR[result]);
+    vector_copy(rsp_current -> V_result, rsp_current -> VR[result]);
     vs = vt; /* unused */
     return;
 #endif
@@ -1224,25 +1224,25 @@ VECTOR_OPERATION VMOV(v16 vs, v16 vt)
 
 VECTOR_OPERATION VRSQ(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
-    const int source = (inst_word & 0x0000FFFF) >> 11;
-    const int target = (inst_word >> 16) & 31;
-    const unsigned int element = (inst_word >> 21) & 0x7;
+    const int result = (rsp_current -> inst_word & 0x000007FF) >>  6;
+    const int source = (rsp_current -> inst_word & 0x0000FFFF) >> 11;
+    const int target = (rsp_current -> inst_word >> 16) & 31;
+    const unsigned int element = (rsp_current -> inst_word >> 21) & 0x7;
 
-    DivIn = (i32)VR[target][element];
-    do_div(DivIn, SP_DIV_SQRT_YES, SP_DIV_PRECISION_SINGLE);
+    rsp_current -> DivIn = (i32)rsp_current -> VR[target][element];
+    do_div(rsp_current -> DivIn, SP_DIV_SQRT_YES, SP_DIV_PRECISION_SINGLE);
 #ifdef ARCH_MIN_SSE2
     *(v16 *)VACC_L = vt;
 #else
     vector_copy(VACC_L, vt);
 #endif
-    VR[result][source & 07] = (i16)DivOut;
-    DPH = SP_DIV_PRECISION_SINGLE;
+    rsp_current -> VR[result][source & 07] = (i16)rsp_current -> DivOut;
+    rsp_current -> DPH = SP_DIV_PRECISION_SINGLE;
 #ifdef ARCH_MIN_SSE2
-    vs = *(v16 *)VR[result];
+    vs = *(v16 *)rsp_current -> VR[result];
     return (vs);
 #else
-    vector_copy(V_result, VR[result]);
+    vector_copy(rsp_current -> V_result, rsp_current -> VR[result]);
     vs = vt; /* unused */
     return;
 #endif
@@ -1250,26 +1250,26 @@ VECTOR_OPERATION VRSQ(v16 vs, v16 vt)
 
 VECTOR_OPERATION VRSQL(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
-    const int source = (inst_word & 0x0000FFFF) >> 11;
-    const int target = (inst_word >> 16) & 31;
-    const unsigned int element = (inst_word >> 21) & 0x7;
+    const int result = (rsp_current -> inst_word & 0x000007FF) >>  6;
+    const int source = (rsp_current -> inst_word & 0x0000FFFF) >> 11;
+    const int target = (rsp_current -> inst_word >> 16) & 31;
+    const unsigned int element = (rsp_current -> inst_word >> 21) & 0x7;
 
-    DivIn &= DPH;
-    DivIn |= (u16)VR[target][element];
-    do_div(DivIn, SP_DIV_SQRT_YES, DPH);
+    rsp_current -> DivIn &= rsp_current -> DPH;
+    rsp_current -> DivIn |= (u16)rsp_current -> VR[target][element];
+    do_div(rsp_current -> DivIn, SP_DIV_SQRT_YES, rsp_current -> DPH);
 #ifdef ARCH_MIN_SSE2
     *(v16 *)VACC_L = vt;
 #else
     vector_copy(VACC_L, vt);
 #endif
-    VR[result][source & 07] = (i16)DivOut;
-    DPH = SP_DIV_PRECISION_SINGLE;
+    rsp_current -> VR[result][source & 07] = (i16)rsp_current -> DivOut;
+    rsp_current -> DPH = SP_DIV_PRECISION_SINGLE;
 #ifdef ARCH_MIN_SSE2
-    vs = *(v16 *)VR[result];
+    vs = *(v16 *)rsp_current -> VR[result];
     return (vs);
 #else
-    vector_copy(V_result, VR[result]);
+    vector_copy(rsp_current -> V_result, rsp_current -> VR[result]);
     vs = vt; /* unused */
     return;
 #endif
@@ -1277,24 +1277,24 @@ VECTOR_OPERATION VRSQL(v16 vs, v16 vt)
 
 VECTOR_OPERATION VRSQH(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
-    const int source = (inst_word & 0x0000FFFF) >> 11;
-    const int target = (inst_word >> 16) & 31;
-    const unsigned int element = (inst_word >> 21) & 0x7;
+    const int result = (rsp_current -> inst_word & 0x000007FF) >>  6;
+    const int source = (rsp_current -> inst_word & 0x0000FFFF) >> 11;
+    const int target = (rsp_current -> inst_word >> 16) & 31;
+    const unsigned int element = (rsp_current -> inst_word >> 21) & 0x7;
 
-    DivIn = VR[target][element] << 16;
+    rsp_current -> DivIn = rsp_current -> VR[target][element] << 16;
 #ifdef ARCH_MIN_SSE2
     *(v16 *)VACC_L = vt;
 #else
     vector_copy(VACC_L, vt);
 #endif
-    VR[result][source & 07] = DivOut >> 16;
-    DPH = SP_DIV_PRECISION_DOUBLE;
+    rsp_current -> VR[result][source & 07] = rsp_current -> DivOut >> 16;
+    rsp_current -> DPH = SP_DIV_PRECISION_DOUBLE;
 #ifdef ARCH_MIN_SSE2
-    vs = *(v16 *)VR[result];
+    vs = *(v16 *)rsp_current -> VR[result];
     return (vs);
 #else
-    vector_copy(V_result, VR[result]);
+    vector_copy(rsp_current -> V_result, rsp_current -> VR[result]);
     vs = vt; /* unused */
     return;
 #endif
@@ -1302,13 +1302,13 @@ VECTOR_OPERATION VRSQH(v16 vs, v16 vt)
 
 VECTOR_OPERATION VNOP(v16 vs, v16 vt)
 {
-    const int result = (inst_word & 0x000007FF) >>  6;
+    const int result = (rsp_current -> inst_word & 0x000007FF) >>  6;
 
 #ifdef ARCH_MIN_SSE2
-    vs = *(v16 *)VR[result];
+    vs = *(v16 *)rsp_current -> VR[result];
     return (vt = vs); /* -Wunused-but-set-parameter */
 #else
-    vector_copy(V_result, VR[result]);
+    vector_copy(rsp_current -> V_result, rsp_current -> VR[result]);
     if (vt == vs)
         return; /* -Wunused-but-set-parameter */
     return;
@@ -21,10 +21,16 @@ VECTOR_OPERATION VAND(v16 vs, v16 vt)
     vector_and(vs, vt);
     *(v16 *)VACC_L = vs;
     return (vs);
+#elif defined(ARCH_MIN_ARM_NEON)
+    const int16x8_t result = vandq_s16(vld1q_s16(vs), vld1q_s16(vt));
+
+    vst1q_s16(VACC_L, result);
+    vst1q_s16(rsp_current -> V_result, result);
+    return;
 #else
     vector_copy(VACC_L, vt);
     vector_and(VACC_L, vs);
-    vector_copy(V_result, VACC_L);
+    vector_copy(rsp_current -> V_result, VACC_L);
     return;
 #endif
 }
@@ -37,12 +43,18 @@ VECTOR_OPERATION VNAND(v16 vs, v16 vt)
     vector_xor(vs, vt);
     *(v16 *)VACC_L = vs;
     return (vs);
+#elif defined(ARCH_MIN_ARM_NEON)
+    const int16x8_t result = vmvnq_s16(vandq_s16(vld1q_s16(vs), vld1q_s16(vt)));
+
+    vst1q_s16(VACC_L, result);
+    vst1q_s16(rsp_current -> V_result, result);
+    return;
 #else
     vector_copy(VACC_L, vt);
     vector_and(VACC_L, vs);
-    vector_fill(V_result);
-    vector_xor(VACC_L, V_result);
-    vector_copy(V_result, VACC_L);
+    vector_fill(rsp_current -> V_result);
+    vector_xor(VACC_L, rsp_current -> V_result);
+    vector_copy(rsp_current -> V_result, VACC_L);
     return;
 #endif
 }
@@ -53,10 +65,16 @@ VECTOR_OPERATION VOR(v16 vs, v16 vt)
     vector_or(vs, vt);
     *(v16 *)VACC_L = vs;
     return (vs);
+#elif defined(ARCH_MIN_ARM_NEON)
+    const int16x8_t result = vorrq_s16(vld1q_s16(vs), vld1q_s16(vt));
+
+    vst1q_s16(VACC_L, result);
+    vst1q_s16(rsp_current -> V_result, result);
+    return;
 #else
     vector_copy(VACC_L, vt);
     vector_or(VACC_L, vs);
-    vector_copy(V_result, VACC_L);
+    vector_copy(rsp_current -> V_result, VACC_L);
     return;
 #endif
 }
@@ -69,12 +87,18 @@ VECTOR_OPERATION VNOR(v16 vs, v16 vt)
     vector_xor(vs, vt);
     *(v16 *)VACC_L = vs;
     return (vs);
+#elif defined(ARCH_MIN_ARM_NEON)
+    const int16x8_t result = vmvnq_s16(vorrq_s16(vld1q_s16(vs), vld1q_s16(vt)));
+
+    vst1q_s16(VACC_L, result);
+    vst1q_s16(rsp_current -> V_result, result);
+    return;
 #else
     vector_copy(VACC_L, vt);
     vector_or(VACC_L, vs);
-    vector_fill(V_result);
-    vector_xor(VACC_L, V_result);
-    vector_copy(V_result, VACC_L);
+    vector_fill(rsp_current -> V_result);
+    vector_xor(VACC_L, rsp_current -> V_result);
+    vector_copy(rsp_current -> V_result, VACC_L);
     return;
 #endif
 }
@@ -85,10 +109,16 @@ VECTOR_OPERATION VXOR(v16 vs, v16 vt)
     vector_xor(vs, vt);
     *(v16 *)VACC_L = vs;
     return (vs);
+#elif defined(ARCH_MIN_ARM_NEON)
+    const int16x8_t result = veorq_s16(vld1q_s16(vs), vld1q_s16(vt));
+
+    vst1q_s16(VACC_L, result);
+    vst1q_s16(rsp_current -> V_result, result);
+    return;
 #else
     vector_copy(VACC_L, vt);
     vector_xor(VACC_L, vs);
-    vector_copy(V_result, VACC_L);
+    vector_copy(rsp_current -> V_result, VACC_L);
     return;
 #endif
 }
@@ -101,12 +131,18 @@ VECTOR_OPERATION VNXOR(v16 vs, v16 vt)
     vector_xor(vs, vt);
     *(v16 *)VACC_L = vs;
     return (vs);
+#elif defined(ARCH_MIN_ARM_NEON)
+    const int16x8_t result = vmvnq_s16(veorq_s16(vld1q_s16(vs), vld1q_s16(vt)));
+
+    vst1q_s16(VACC_L, result);
+    vst1q_s16(rsp_current -> V_result, result);
+    return;
 #else
     vector_copy(VACC_L, vt);
     vector_xor(VACC_L, vs);
-    vector_fill(V_result);
-    vector_xor(VACC_L, V_result);
-    vector_copy(V_result, VACC_L);
+    vector_fill(rsp_current -> V_result);
+    vector_xor(VACC_L, rsp_current -> V_result);
+    vector_copy(rsp_current -> V_result, VACC_L);
     return;
 #endif
 }
@@ -40,6 +40,89 @@ static INLINE void SIGNED_CLAMP_AM(pi16 VD)
     _mm_store_si128((v16 *)VD, dst);
     return;
 }
+#elif defined(ARCH_MIN_ARM_NEON)
+#define S16(v)  vreinterpretq_s16_u16(v)
+#define U16(v)  vreinterpretq_u16_s16(v)
+
+/*
+ * signed clamp of accumulator bits 47..16 (or just 31..16, since nothing
+ * above bit 31 is needed to tell whether the clamp saturates)
+ */
+static INLINE int16x8_t clamp_am(int16x8_t acc_md, int16x8_t acc_hi)
+{
+    int32x4_t acc_lo4, acc_hi4;
+
+    acc_lo4 = vorrq_s32(
+        vshll_n_s16(vget_low_s16(acc_hi), 16),
+        vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(U16(acc_md))))
+    );
+    acc_hi4 = vorrq_s32(
+        vshll_n_s16(vget_high_s16(acc_hi), 16),
+        vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(U16(acc_md))))
+    );
+    return vcombine_s16(vqmovn_s32(acc_lo4), vqmovn_s32(acc_hi4));
+}
+
+/*
+ * the clamps of UNSIGNED_CLAMP and SIGNED_CLAMP_AL, in registers
+ */
+static INLINE int16x8_t clamp_unsigned(int16x8_t acc_md, int16x8_t acc_hi)
+{
+    const int16x8_t temp = clamp_am(acc_md, acc_hi);
+    const int16x8_t cond = S16(vcgtq_s16(temp, acc_md));
+
+    return vorrq_s16(vbicq_s16(temp, vshrq_n_s16(temp, 15)), cond);
+}
+static INLINE int16x8_t clamp_al(
+    int16x8_t acc_lo, int16x8_t acc_md, int16x8_t acc_hi)
+{
+    const int16x8_t temp = clamp_am(acc_md, acc_hi);
+    const uint16x8_t cond = vceqq_s16(temp, acc_md);
+
+    return vbslq_s16(cond, acc_lo, veorq_s16(temp, vdupq_n_s16(-0x8000)));
+}
+
+/*
+ * accumulator += (add_hi:add_md:add_lo), with carries between the slices
+ */
+static INLINE void accumulate(
+    int16x8_t add_lo, int16x8_t add_md, int16x8_t add_hi)
+{
+    uint16x8_t acc_lo, acc_md, carry;
+    int16x8_t acc_hi;
+
+    acc_lo = vaddq_u16(vld1q_u16((u16 *)VACC_L), U16(add_lo));
+    carry = vcltq_u16(acc_lo, U16(add_lo));
+    acc_md = vaddq_u16(vld1q_u16((u16 *)VACC_M), U16(add_md));
+    acc_hi = vaddq_s16(vld1q_s16(VACC_H), add_hi);
+    acc_hi = vsubq_s16(acc_hi, S16(vcltq_u16(acc_md, U16(add_md))));
+    acc_md = vsubq_u16(acc_md, carry); /* += 1 if carry, by doing -= ~0 */
+    carry = vandq_u16(carry, vceqq_u16(acc_md, vdupq_n_u16(0x0000)));
+    acc_hi = vsubq_s16(acc_hi, S16(carry));
+
+    vst1q_s16(VACC_L, S16(acc_lo));
+    vst1q_s16(VACC_M, S16(acc_md));
+    vst1q_s16(VACC_H, acc_hi);
+    return;
+}
+
+/*
+ * 32-bit products of the low and high four elements, in each signedness
+ */
+#define PRODUCT_SS(vs, vt, half) \
+    vmull_s16(vget_##half##_s16(vs), vget_##half##_s16(vt))
+#define PRODUCT_UU(vs, vt, half) \
+    vreinterpretq_s32_u32(vmull_u16( \
+        vget_##half##_u16(U16(vs)), vget_##half##_u16(U16(vt))))
+#define PRODUCT_SU(vs, vt, half) \
+    vmulq_s32(vmovl_s16(vget_##half##_s16(vs)), vreinterpretq_s32_u32( \
+        vmovl_u16(vget_##half##_u16(U16(vt)))))
+
+static INLINE void SIGNED_CLAMP_AM(pi16 VD)
+{ /* typical sign-clamp of accumulator-mid (bits 31:16) */
+    vst1q_s16(VD, clamp_am(vld1q_s16(VACC_M), vld1q_s16(VACC_H)));
+    return;
+}
 #else
 static INLINE void SIGNED_CLAMP_AM(pi16 VD)
 { /* typical sign-clamp of accumulator-mid (bits 31:16) */
@@ -97,6 +180,52 @@ static INLINE void SIGNED_CLAMP_AL(pi16 VD)
     return;
 }
 
+#ifdef ARCH_MIN_ARM_NEON
+static INLINE void do_mac(pi16 VD, pi16 VS, pi16 VT, int clamp_unsigned_md)
+{
+    int32x4_t product_lo, product_hi;
+    int16x8_t vs, vt, add_md, add_hi;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    product_lo = PRODUCT_SS(vs, vt, low);
+    product_hi = PRODUCT_SS(vs, vt, high);
+
+/*
+ * accumulator += (product << 1), with the product's sign in bits 47..32
+ */
+    add_md = vcombine_s16(
+        vshrn_n_s32(product_lo, 15), vshrn_n_s32(product_hi, 15));
+    add_hi = vcombine_s16(
+        vshrn_n_s32(product_lo, 16), vshrn_n_s32(product_hi, 16));
+    accumulate(
+        vcombine_s16(
+            vmovn_s32(vshlq_n_s32(product_lo, 1)),
+            vmovn_s32(vshlq_n_s32(product_hi, 1))),
+        add_md,
+        vshrq_n_s16(add_hi, 15)
+    );
+    add_md = vld1q_s16(VACC_M);
+    add_hi = vld1q_s16(VACC_H);
+    if (clamp_unsigned_md)
+        vst1q_s16(VD, clamp_unsigned(add_md, add_hi));
+    else
+        vst1q_s16(VD, clamp_am(add_md, add_hi));
+    return;
+}
+
+INLINE static void do_macf(pi16 VD, pi16 VS, pi16 VT)
+{
+    do_mac(VD, VS, VT, 0);
+    return;
+}
+
+INLINE static void do_macu(pi16 VD, pi16 VS, pi16 VT)
+{
+    do_mac(VD, VS, VT, 1);
+    return;
+}
+#else
 INLINE static void do_macf(pi16 VD, pi16 VS, pi16 VT)
 {
     i32 product[N];
@@ -152,6 +281,7 @@ INLINE static void do_macu(pi16 VD, pi16 VS, pi16 VT)
     UNSIGNED_CLAMP(VD);
     return;
 }
+#endif
 
 VECTOR_OPERATION VMULF(v16 vs, v16 vt)
 {
@@ -204,6 +334,34 @@ VECTOR_OPERATION VMULF(v16 vs, v16 vt)
     *(v16 *)VACC_H = negative; /* 2*i16*i16 only fills L/M; VACC_H = 0 or ~0. */
     vs = _mm_add_epi16(vs, prod_hi); /* prod_hi must be -32768; + -1 = +32767 */
     return (vs);
+#elif defined(ARCH_MIN_ARM_NEON)
+    int32x4_t product_lo, product_hi;
+    uint32x4_t round_lo, round_hi;
+    int16x8_t acc_md, acc_hi;
+
+    product_lo = PRODUCT_SS(vld1q_s16(vs), vld1q_s16(vt), low);
+    product_hi = PRODUCT_SS(vld1q_s16(vs), vld1q_s16(vt), high);
+
+/*
+ * (product << 1) + 32768 in 32 bits, whose sign is lost for -32768 * -32768
+ * but is not needed:  it is negative exactly when product < -16384.
+ */
+    round_lo = vreinterpretq_u32_s32(vshlq_n_s32(product_lo, 1));
+    round_hi = vreinterpretq_u32_s32(vshlq_n_s32(product_hi, 1));
+    round_lo = vaddq_u32(round_lo, vdupq_n_u32(32768));
+    round_hi = vaddq_u32(round_hi, vdupq_n_u32(32768));
+
+    vst1q_u16((u16 *)VACC_L,
+        vcombine_u16(vmovn_u32(round_lo), vmovn_u32(round_hi)));
+    acc_md = vreinterpretq_s16_u16(
+        vcombine_u16(vshrn_n_u32(round_lo, 16), vshrn_n_u32(round_hi, 16)));
+    acc_hi = vreinterpretq_s16_u16(vcombine_u16(
+        vmovn_u32(vcltq_s32(product_lo, vdupq_n_s32(-16384))),
+        vmovn_u32(vcltq_s32(product_hi, vdupq_n_s32(-16384)))));
+    vst1q_s16(VACC_M, acc_md);
+    vst1q_s16(VACC_H, acc_hi);
+    vst1q_s16(rsp_current -> V_result, clamp_am(acc_md, acc_hi));
+    return;
 #else
     word_64 product[N]; /* (-32768 * -32768)<<1 + 32768 confuses 32-bit type. */
     register unsigned int i;
@@ -220,7 +378,7 @@ VECTOR_OPERATION VMULF(v16 vs, v16 vt)
         VACC_M[i] = (product[i].UW & 0x0000FFFF0000) >> 16;
     for (i = 0; i < N; i++)
         VACC_H[i] = -(product[i].SW < 0); /* product>>32 & 0xFFFF */
-    SIGNED_CLAMP_AM(V_result);
+    SIGNED_CLAMP_AM(rsp_current -> V_result);
     return;
 #endif
 }
@@ -268,6 +426,33 @@ VECTOR_OPERATION VMULU(v16 vs, v16 vt)
     vs = _mm_or_si128(prod_hi, prod_lo);
     vs = _mm_andnot_si128(negative, vs); /* unsigned underflow mask */
     return (vs);
+#elif defined(ARCH_MIN_ARM_NEON)
+    int32x4_t product_lo, product_hi;
+    uint32x4_t round_lo, round_hi;
+    int16x8_t acc_md, acc_hi;
+
+    product_lo = PRODUCT_SS(vld1q_s16(vs), vld1q_s16(vt), low);
+    product_hi = PRODUCT_SS(vld1q_s16(vs), vld1q_s16(vt), high);
+
+/*
+ * The accumulator is written just as by VMULF.
+ */
+    round_lo = vreinterpretq_u32_s32(vshlq_n_s32(product_lo, 1));
+    round_hi = vreinterpretq_u32_s32(vshlq_n_s32(product_hi, 1));
+    round_lo = vaddq_u32(round_lo, vdupq_n_u32(32768));
+    round_hi = vaddq_u32(round_hi, vdupq_n_u32(32768));
+
+    vst1q_u16((u16 *)VACC_L,
+        vcombine_u16(vmovn_u32(round_lo), vmovn_u32(round_hi)));
+    acc_md = vreinterpretq_s16_u16(
+        vcombine_u16(vshrn_n_u32(round_lo, 16), vshrn_n_u32(round_hi, 16)));
+    acc_hi = vreinterpretq_s16_u16(vcombine_u16(
+        vmovn_u32(vcltq_s32(product_lo, vdupq_n_s32(-16384))),
+        vmovn_u32(vcltq_s32(product_hi, vdupq_n_s32(-16384)))));
+    vst1q_s16(VACC_M, acc_md);
+    vst1q_s16(VACC_H, acc_hi);
+    vst1q_s16(rsp_current -> V_result, clamp_unsigned(acc_md, acc_hi));
+    return;
 #else
     word_64 product[N]; /* (-32768 * -32768)<<1 + 32768 confuses 32-bit type. */
     register unsigned int i;
@@ -284,7 +469,7 @@ VECTOR_OPERATION VMULU(v16 vs, v16 vt)
         VACC_M[i] = (product[i].UW & 0x0000FFFF0000) >> 16;
     for (i = 0; i < N; i++)
         VACC_H[i] = -(product[i].SW < 0); /* product>>32 & 0xFFFF */
-    UNSIGNED_CLAMP(V_result);
+    UNSIGNED_CLAMP(rsp_current -> V_result);
     return;
 #endif
 }
@@ -298,6 +483,17 @@ VECTOR_OPERATION VMUDL(v16 vs, v16 vt)
     *(v16 *)VACC_M = vt;
     *(v16 *)VACC_H = vt;
     return (vs); /* no possibilities to clamp */
+#elif defined(ARCH_MIN_ARM_NEON)
+    const int16x8_t acc_lo = vcombine_s16(
+        vshrn_n_s32(PRODUCT_UU(vld1q_s16(vs), vld1q_s16(vt), low), 16),
+        vshrn_n_s32(PRODUCT_UU(vld1q_s16(vs), vld1q_s16(vt), high), 16)
+    );
+
+    vst1q_s16(VACC_L, acc_lo);
+    vst1q_s16(rsp_current -> V_result, acc_lo);
+    vector_wipe(VACC_M);
+    vector_wipe(VACC_H);
+    return;
 #else
     word_32 product[N];
     register unsigned int i;
@@ -306,7 +502,7 @@ VECTOR_OPERATION VMUDL(v16 vs, v16 vt)
         product[i].UW = (u16)vs[i] * (u16)vt[i];
     for (i = 0; i < N; i++)
         VACC_L[i] = product[i].UW >> 16; /* product[i].H[HES(0) >> 1] */
-    vector_copy(V_result, VACC_L);
+    vector_copy(rsp_current -> V_result, VACC_L);
     vector_wipe(VACC_M);
     vector_wipe(VACC_H);
     return;
@@ -335,6 +531,20 @@ VECTOR_OPERATION VMUDM(v16 vs, v16 vt)
     prod_hi = _mm_srai_epi16(prod_hi, 15);
     *(v16 *)VACC_H = prod_hi;
     return (vs);
+#elif defined(ARCH_MIN_ARM_NEON)
+    int32x4_t product_lo, product_hi;
+    int16x8_t acc_md;
+
+    product_lo = PRODUCT_SU(vld1q_s16(vs), vld1q_s16(vt), low);
+    product_hi = PRODUCT_SU(vld1q_s16(vs), vld1q_s16(vt), high);
+    acc_md = vcombine_s16(
+        vshrn_n_s32(product_lo, 16), vshrn_n_s32(product_hi, 16));
+    vst1q_s16(VACC_L,
+        vcombine_s16(vmovn_s32(product_lo), vmovn_s32(product_hi)));
+    vst1q_s16(VACC_M, acc_md);
+    vst1q_s16(VACC_H, vshrq_n_s16(acc_md, 15));
+    vst1q_s16(rsp_current -> V_result, acc_md);
+    return;
 #else
     word_32 product[N];
     register unsigned int i;
@@ -347,7 +557,7 @@ VECTOR_OPERATION VMUDM(v16 vs, v16 vt)
         VACC_M[i] = (product[i].W & 0x0000FFFF0000) >> 16;
     for (i = 0; i < N; i++)
         VACC_H[i] = -(VACC_M[i] < 0);
-    vector_copy(V_result, VACC_M);
+    vector_copy(rsp_current -> V_result, VACC_M);
     return;
 #endif
 }
@@ -373,6 +583,20 @@ VECTOR_OPERATION VMUDN(v16 vs, v16 vt)
     prod_hi = _mm_srai_epi16(prod_hi, 15);
     *(v16 *)VACC_H = prod_hi;
     return (vs = prod_lo);
+#elif defined(ARCH_MIN_ARM_NEON)
+    int32x4_t product_lo, product_hi;
+    int16x8_t acc_lo, acc_md;
+
+    product_lo = PRODUCT_SU(vld1q_s16(vt), vld1q_s16(vs), low);
+    product_hi = PRODUCT_SU(vld1q_s16(vt), vld1q_s16(vs), high);
+    acc_lo = vcombine_s16(vmovn_s32(product_lo), vmovn_s32(product_hi));
+    acc_md = vcombine_s16(
+        vshrn_n_s32(product_lo, 16), vshrn_n_s32(product_hi, 16));
+    vst1q_s16(VACC_L, acc_lo);
+    vst1q_s16(VACC_M, acc_md);
+    vst1q_s16(VACC_H, vshrq_n_s16(acc_md, 15));
+    vst1q_s16(rsp_current -> V_result, acc_lo);
+    return;
 #else
     word_32 product[N];
     register unsigned int i;
@@ -385,7 +609,7 @@ VECTOR_OPERATION VMUDN(v16 vs, v16 vt)
         VACC_M[i] = (product[i].W & 0x0000FFFF0000) >> 16;
     for (i = 0; i < N; i++)
         VACC_H[i] = -(VACC_M[i] < 0);
-    vector_copy(V_result, VACC_L);
+    vector_copy(rsp_current -> V_result, VACC_L);
     return;
 #endif
 }
@@ -415,6 +639,19 @@ VECTOR_OPERATION VMUDH(v16 vs, v16 vt)
  */
     vs = _mm_packs_epi32(vs, vt);
     return (vs);
+#elif defined(ARCH_MIN_ARM_NEON)
+    int32x4_t product_lo, product_hi;
+
+    product_lo = PRODUCT_SS(vld1q_s16(vs), vld1q_s16(vt), low);
+    product_hi = PRODUCT_SS(vld1q_s16(vs), vld1q_s16(vt), high);
+    vector_wipe(VACC_L);
+    vst1q_s16(VACC_M,
+        vcombine_s16(vmovn_s32(product_lo), vmovn_s32(product_hi)));
+    vst1q_s16(VACC_H, vcombine_s16(
+        vshrn_n_s32(product_lo, 16), vshrn_n_s32(product_hi, 16)));
+    vst1q_s16(rsp_current -> V_result,
+        vcombine_s16(vqmovn_s32(product_lo), vqmovn_s32(product_hi)));
+    return;
 #else
     word_32 product[N];
     register unsigned int i;
@@ -426,7 +663,7 @@ VECTOR_OPERATION VMUDH(v16 vs, v16 vt)
         VACC_M[i] = (s16)(product[i].W >>  0); /* product[i].HW[HES(0) >> 1] */
     for (i = 0; i < N; i++)
         VACC_H[i] = (s16)(product[i].W >> 16); /* product[i].HW[HES(2) >> 1] */
-    SIGNED_CLAMP_AM(V_result);
+    SIGNED_CLAMP_AM(rsp_current -> V_result);
     return;
 #endif
 }
@@ -450,7 +687,7 @@ VECTOR_OPERATION VMACF(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -474,7 +711,7 @@ VECTOR_OPERATION VMACU(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -531,6 +768,17 @@ VECTOR_OPERATION VMADL(v16 vs, v16 vt)
     acc_md = _mm_slli_epi16(acc_md, 15); /* ... ? ^ 0x8000 : ^ 0x0000 */
     vs = _mm_xor_si128(vs, acc_md); /* Stupid unsigned-clamp-ish adjustment. */
     return (vs);
+#elif defined(ARCH_MIN_ARM_NEON)
+    int16x8_t add_lo;
+
+    add_lo = vcombine_s16(
+        vshrn_n_s32(PRODUCT_UU(vld1q_s16(vs), vld1q_s16(vt), low), 16),
+        vshrn_n_s32(PRODUCT_UU(vld1q_s16(vs), vld1q_s16(vt), high), 16)
+    );
+    accumulate(add_lo, vdupq_n_s16(0x0000), vdupq_n_s16(0x0000));
+    vst1q_s16(rsp_current -> V_result,
+        clamp_al(vld1q_s16(VACC_L), vld1q_s16(VACC_M), vld1q_s16(VACC_H)));
+    return;
 #else
     word_32 product[N], addend[N];
     register unsigned int i;
@@ -549,7 +797,7 @@ VECTOR_OPERATION VMADL(v16 vs, v16 vt)
         VACC_M[i] = addend[i].UW & 0x0000FFFF;
     for (i = 0; i < N; i++)
         VACC_H[i] += addend[i].UW >> 16;
-    SIGNED_CLAMP_AL(V_result);
+    SIGNED_CLAMP_AL(rsp_current -> V_result);
     return;
 #endif
 }
@@ -594,6 +842,21 @@ VECTOR_OPERATION VMADM(v16 vs, v16 vt)
     vs = _mm_unpacklo_epi16(acc_md, acc_hi);
     vs = _mm_packs_epi32(vs, vt);
     return (vs);
+#elif defined(ARCH_MIN_ARM_NEON)
+    int32x4_t product_lo, product_hi;
+    int16x8_t add_md;
+
+    product_lo = PRODUCT_SU(vld1q_s16(vs), vld1q_s16(vt), low);
+    product_hi = PRODUCT_SU(vld1q_s16(vs), vld1q_s16(vt), high);
+    add_md = vcombine_s16(
+        vshrn_n_s32(product_lo, 16), vshrn_n_s32(product_hi, 16));
+    accumulate(
+        vcombine_s16(vmovn_s32(product_lo), vmovn_s32(product_hi)),
+        add_md,
+        vshrq_n_s16(add_md, 15)
+    );
+    vst1q_s16(rsp_current -> V_result, clamp_am(vld1q_s16(VACC_M), vld1q_s16(VACC_H)));
+    return;
 #else
     word_32 product[N], addend[N];
     register unsigned int i;
@@ -612,7 +875,7 @@ VECTOR_OPERATION VMADM(v16 vs, v16 vt)
         VACC_M[i] = addend[i].UW & 0x0000FFFF;
     for (i = 0; i < N; i++)
         VACC_H[i] += addend[i].UW >> 16;
-    SIGNED_CLAMP_AM(V_result);
+    SIGNED_CLAMP_AM(rsp_current -> V_result);
     return;
 #endif
 }
@@ -675,6 +938,22 @@ VECTOR_OPERATION VMADN(v16 vs, v16 vt)
     acc_md = _mm_slli_epi16(acc_md, 15); /* ... ? ^ 0x8000 : ^ 0x0000 */
     vs = _mm_xor_si128(vs, acc_md); /* Stupid unsigned-clamp-ish adjustment. */
     return (vs);
+#elif defined(ARCH_MIN_ARM_NEON)
+    int32x4_t product_lo, product_hi;
+    int16x8_t add_md;
+
+    product_lo = PRODUCT_SU(vld1q_s16(vt), vld1q_s16(vs), low);
+    product_hi = PRODUCT_SU(vld1q_s16(vt), vld1q_s16(vs), high);
+    add_md = vcombine_s16(
+        vshrn_n_s32(product_lo, 16), vshrn_n_s32(product_hi, 16));
+    accumulate(
+        vcombine_s16(vmovn_s32(product_lo), vmovn_s32(product_hi)),
+        add_md,
+        vshrq_n_s16(add_md, 15)
+    );
+    vst1q_s16(rsp_current -> V_result,
+        clamp_al(vld1q_s16(VACC_L), vld1q_s16(VACC_M), vld1q_s16(VACC_H)));
+    return;
 #else
     word_32 product[N], addend[N];
     register unsigned int i;
@@ -693,7 +972,7 @@ VECTOR_OPERATION VMADN(v16 vs, v16 vt)
         VACC_M[i] = addend[i].UW & 0x0000FFFF;
     for (i = 0; i < N; i++)
         VACC_H[i] += addend[i].UW >> 16;
-    SIGNED_CLAMP_AL(V_result);
+    SIGNED_CLAMP_AL(rsp_current -> V_result);
     return;
 #endif
 }
@@ -734,6 +1013,18 @@ VECTOR_OPERATION VMADH(v16 vs, v16 vt)
     vs        = _mm_unpacklo_epi16(vs, vt);
     vs = _mm_packs_epi32(vs, prod_high);
     return (vs);
+#elif defined(ARCH_MIN_ARM_NEON)
+    int32x4_t product_lo, product_hi;
+
+    product_lo = PRODUCT_SS(vld1q_s16(vs), vld1q_s16(vt), low);
+    product_hi = PRODUCT_SS(vld1q_s16(vs), vld1q_s16(vt), high);
+    accumulate(
+        vdupq_n_s16(0x0000),
+        vcombine_s16(vmovn_s32(product_lo), vmovn_s32(product_hi)),
+        vcombine_s16(vshrn_n_s32(product_lo, 16), vshrn_n_s32(product_hi, 16))
+    );
+    vst1q_s16(rsp_current -> V_result, clamp_am(vld1q_s16(VACC_M), vld1q_s16(VACC_H)));
+    return;
 #else
     word_32 product[N], addend[N];
     register unsigned int i;
@@ -746,7 +1037,7 @@ VECTOR_OPERATION VMADH(v16 vs, v16 vt)
         VACC_M[i] += (i16)product[i].SW;
     for (i = 0; i < N; i++)
         VACC_H[i] += (addend[i].UW >> 16) + (product[i].SW >> 16);
-    SIGNED_CLAMP_AM(V_result);
+    SIGNED_CLAMP_AM(rsp_current -> V_result);
     return;
 #endif
 }
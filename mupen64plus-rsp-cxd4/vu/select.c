@@ -15,6 +15,226 @@
 
 #include "select.h"
 
+#ifdef ARCH_MIN_ARM_NEON
+#define S16(v)  vreinterpretq_s16_u16(v)
+#define U16(v)  vreinterpretq_u16_s16(v)
+
+/*
+ * the same multiply-add as the generic merge() below
+ * The clip tests also merge with masks of ~0 instead of flags of 1, so this
+ * cannot be a bit-wise select.
+ */
+static INLINE int16x8_t merge(int16x8_t cmp, int16x8_t pass, int16x8_t fail)
+{
+    return vmlaq_s16(fail, cmp, vsubq_s16(pass, fail));
+}
+
+INLINE static void do_lt(pi16 VD, pi16 VS, pi16 VT)
+{
+    int16x8_t vs, vt, eq, comp;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    eq = vector_flag(vceqq_s16(vs, vt));
+    eq = vandq_s16(eq, vandq_s16(vld1q_s16(rsp_current -> cf_ne), vld1q_s16(rsp_current -> cf_co)));
+    comp = vorrq_s16(vector_flag(vcltq_s16(vs, vt)), eq);
+    vst1q_s16(rsp_current -> cf_comp, comp);
+
+    vs = merge(comp, vs, vt);
+    vst1q_s16(VACC_L, vs);
+    vst1q_s16(VD, vs);
+
+ /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
+
+    vector_wipe(rsp_current -> cf_clip);
+    return;
+}
+
+INLINE static void do_eq(pi16 VD, pi16 VS, pi16 VT)
+{
+    int16x8_t vt, comp;
+
+    vt = vld1q_s16(VT);
+    comp = vector_flag(vceqq_s16(vld1q_s16(VS), vt));
+    comp = vandq_s16(comp, veorq_s16(vld1q_s16(rsp_current -> cf_ne), vdupq_n_s16(1)));
+    vst1q_s16(rsp_current -> cf_comp, comp);
+
+    vst1q_s16(VACC_L, vt);
+    vst1q_s16(VD, vt);
+
+ /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
+
+    vector_wipe(rsp_current -> cf_clip);
+    return;
+}
+
+INLINE static void do_ne(pi16 VD, pi16 VS, pi16 VT)
+{
+    int16x8_t vs, comp;
+
+    vs = vld1q_s16(VS);
+    comp = vector_flag(vmvnq_u16(vceqq_s16(vs, vld1q_s16(VT))));
+    comp = vorrq_s16(comp, vld1q_s16(rsp_current -> cf_ne));
+    vst1q_s16(rsp_current -> cf_comp, comp);
+
+    vst1q_s16(VACC_L, vs);
+    vst1q_s16(VD, vs);
+
+ /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
+
+    vector_wipe(rsp_current -> cf_clip);
+    return;
+}
+
+INLINE static void do_ge(pi16 VD, pi16 VS, pi16 VT)
+{
+    int16x8_t vs, vt, ce, eq, comp;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    ce = vandq_s16(vld1q_s16(rsp_current -> cf_ne), vld1q_s16(rsp_current -> cf_co));
+    ce = veorq_s16(ce, vdupq_n_s16(1));
+    eq = vandq_s16(vector_flag(vceqq_s16(vs, vt)), ce);
+    comp = vorrq_s16(vector_flag(vcgtq_s16(vs, vt)), eq);
+    vst1q_s16(rsp_current -> cf_comp, comp);
+
+    vs = merge(comp, vs, vt);
+    vst1q_s16(VACC_L, vs);
+    vst1q_s16(VD, vs);
+
+ /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
+
+    vector_wipe(rsp_current -> cf_clip);
+    return;
+}
+
+INLINE static void do_cl(pi16 VD, pi16 VS, pi16 VT)
+{
+    uint16x8_t vb, vc;
+    int16x8_t eq, sn, vce, diff, uz, lz, gen, len, le, ge, cmp;
+
+    vb = vld1q_u16((u16 *)VS);
+    vc = vld1q_u16((u16 *)VT);
+    eq = veorq_s16(vld1q_s16(rsp_current -> cf_ne), vdupq_n_s16(1));
+    sn = vld1q_s16(rsp_current -> cf_co);
+    vce = vld1q_s16(rsp_current -> cf_vce);
+
+    vc = veorq_u16(vc, U16(vnegq_s16(sn)));
+    vc = vaddq_u16(vc, U16(sn)); /* conditional negation, if sn */
+    diff = S16(vsubq_u16(vb, vc));
+    uz = S16(vmvnq_u16(vcltq_u16(vaddq_u16(vb, vld1q_u16((u16 *)VT)), vb)));
+    lz = vector_flag(vceqq_s16(diff, vdupq_n_s16(0x0000)));
+    gen = vorrq_s16(lz, uz);
+    len = vandq_s16(lz, uz);
+    gen = vandq_s16(gen, vce);
+    len = vandq_s16(len, veorq_s16(vce, vdupq_n_s16(1)));
+    len = vorrq_s16(len, gen);
+    gen = vector_flag(vcgeq_u16(vb, vc));
+
+    cmp = vandq_s16(eq, sn);
+    le = merge(cmp, len, vld1q_s16(rsp_current -> cf_comp));
+    cmp = vandq_s16(eq, veorq_s16(sn, vdupq_n_s16(1)));
+    ge = merge(cmp, gen, vld1q_s16(rsp_current -> cf_clip));
+
+    cmp = merge(sn, le, ge);
+    cmp = merge(cmp, S16(vc), vld1q_s16(VS));
+    vst1q_s16(VACC_L, cmp);
+    vst1q_s16(VD, cmp);
+
+ /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
+
+    vst1q_s16(rsp_current -> cf_clip, ge);
+    vst1q_s16(rsp_current -> cf_comp, le);
+
+ /* CTC2    $0, $vce # zeroing RSP flags VCF[2] */
+    vector_wipe(rsp_current -> cf_vce);
+    return;
+}
+
+INLINE static void do_ch(pi16 VD, pi16 VS, pi16 VT)
+{
+    int16x8_t vs, vt, vc, cch, sn, vce, eq, diff, ge, le, comp;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    cch = S16(vceqq_s16(vt, vdupq_n_s16(-32768)));
+    sn = vshrq_n_s16(veorq_s16(vs, vt), 15);
+    vc = veorq_s16(vt, sn); /* if (sn == ~0) {VT = ~VT;} else {VT =  VT;} */
+    vce = vandq_s16(vector_flag(vceqq_s16(vs, vc)), sn);
+    vc = vsubq_s16(vc, vandq_s16(sn, cch)); /* ~(VT) into -(VT) if (sign) */
+    eq = vbicq_s16(vector_flag(vceqq_s16(vs, vc)), cch);
+    eq = vorrq_s16(eq, vce);
+
+    diff = vorrq_s16(sn, vs);
+    ge = vector_flag(vcgeq_s16(diff, vt));
+    sn = S16(vshrq_n_u16(U16(sn), 15)); /* ~0 to 1, 0 to 0 */
+    diff = vsubq_s16(vc, vs);
+    diff = vector_flag(vcgeq_s16(diff, vdupq_n_s16(0x0000)));
+    le = vector_flag(vcltq_s16(vt, vdupq_n_s16(0x0000)));
+    le = merge(sn, diff, le);
+
+    comp = merge(sn, le, ge);
+    comp = merge(comp, vc, vs);
+    vst1q_s16(VACC_L, comp);
+    vst1q_s16(VD, comp);
+
+    vst1q_s16(rsp_current -> cf_vce, vce);
+    vst1q_s16(rsp_current -> cf_clip, ge);
+    vst1q_s16(rsp_current -> cf_comp, le);
+    vst1q_s16(rsp_current -> cf_ne, veorq_s16(eq, vdupq_n_s16(1)));
+    vst1q_s16(rsp_current -> cf_co, sn);
+    return;
+}
+
+INLINE static void do_cr(pi16 VD, pi16 VS, pi16 VT)
+{
+    int16x8_t vs, vt, sn, le, ge, cmp;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    sn = vshrq_n_s16(veorq_s16(vs, vt), 15);
+    cmp = vmvnq_s16(vandq_s16(vs, sn));
+    le = vector_flag(vcleq_s16(vt, cmp));
+    cmp = vorrq_s16(vs, sn);
+    ge = vector_flag(vcgeq_s16(cmp, vt));
+
+    cmp = merge(sn, le, ge);
+    cmp = merge(cmp, veorq_s16(vt, sn), vs);
+    vst1q_s16(VACC_L, cmp);
+    vst1q_s16(VD, cmp);
+
+ /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
+
+    vst1q_s16(rsp_current -> cf_clip, ge);
+    vst1q_s16(rsp_current -> cf_comp, le);
+
+ /* CTC2    $0, $vce # zeroing RSP flags VCF[2] */
+    vector_wipe(rsp_current -> cf_vce);
+    return;
+}
+
+INLINE static void do_mrg(pi16 VD, pi16 VS, pi16 VT)
+{
+    int16x8_t vd;
+
+    vd = merge(vld1q_s16(rsp_current -> cf_comp), vld1q_s16(VS), vld1q_s16(VT));
+    vst1q_s16(VACC_L, vd);
+    vst1q_s16(VD, vd);
+    return;
+}
+#else
 /*
  * vector select merge (`VMRG`) formula
  *
@@ -54,22 +274,22 @@ INLINE static void do_lt(pi16 VD, pi16 VS, pi16 VT)
     for (i = 0; i < N; i++)
         eq[i] = (VS[i] == VT[i]);
     for (i = 0; i < N; i++)
-        cn[i] = cf_ne[i] & cf_co[i];
+        cn[i] = rsp_current -> cf_ne[i] & rsp_current -> cf_co[i];
     for (i = 0; i < N; i++)
         eq[i] = eq[i] & cn[i];
     for (i = 0; i < N; i++)
-        cf_comp[i] = (VS[i] < VT[i]); /* less than */
+        rsp_current -> cf_comp[i] = (VS[i] < VT[i]); /* less than */
     for (i = 0; i < N; i++)
-        cf_comp[i] = cf_comp[i] | eq[i]; /* ... or equal (uncommonly) */
+        rsp_current -> cf_comp[i] = rsp_current -> cf_comp[i] | eq[i]; /* ... or equal (uncommonly) */
 
-    merge(VACC_L, cf_comp, VS, VT);
+    merge(VACC_L, rsp_current -> cf_comp, VS, VT);
     vector_copy(VD, VACC_L);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
 
-    vector_wipe(cf_clip);
+    vector_wipe(rsp_current -> cf_clip);
     return;
 }
 
@@ -78,21 +298,21 @@ INLINE static void do_eq(pi16 VD, pi16 VS, pi16 VT)
     register int i;
 
     for (i = 0; i < N; i++)
-        cf_comp[i] = (VS[i] == VT[i]);
+        rsp_current -> cf_comp[i] = (VS[i] == VT[i]);
     for (i = 0; i < N; i++)
-        cf_comp[i] = cf_comp[i] & (cf_ne[i] ^ 1);
+        rsp_current -> cf_comp[i] = rsp_current -> cf_comp[i] & (rsp_current -> cf_ne[i] ^ 1);
 #if (0)
-    merge(VACC_L, cf_comp, VS, VT); /* correct but redundant */
+    merge(VACC_L, rsp_current -> cf_comp, VS, VT); /* correct but redundant */
 #else
     vector_copy(VACC_L, VT);
 #endif
     vector_copy(VD, VACC_L);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
 
-    vector_wipe(cf_clip);
+    vector_wipe(rsp_current -> cf_clip);
     return;
 }
 
@@ -101,21 +321,21 @@ INLINE static void do_ne(pi16 VD, pi16 VS, pi16 VT)
     register int i;
 
     for (i = 0; i < N; i++)
-        cf_comp[i] = (VS[i] != VT[i]);
+        rsp_current -> cf_comp[i] = (VS[i] != VT[i]);
     for (i = 0; i < N; i++)
-        cf_comp[i] = cf_comp[i] | cf_ne[i];
+        rsp_current -> cf_comp[i] = rsp_current -> cf_comp[i] | rsp_current -> cf_ne[i];
 #if (0)
-    merge(VACC_L, cf_comp, VS, VT); /* correct but redundant */
+    merge(VACC_L, rsp_current -> cf_comp, VS, VT); /* correct but redundant */
 #else
     vector_copy(VACC_L, VS);
 #endif
     vector_copy(VD, VACC_L);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
 
-    vector_wipe(cf_clip);
+    vector_wipe(rsp_current -> cf_clip);
     return;
 }
 
@@ -128,22 +348,22 @@ INLINE static void do_ge(pi16 VD, pi16 VS, pi16 VT)
     for (i = 0; i < N; i++)
         eq[i] = (VS[i] == VT[i]);
     for (i = 0; i < N; i++)
-        ce[i] = (cf_ne[i] & cf_co[i]) ^ 1;
+        ce[i] = (rsp_current -> cf_ne[i] & rsp_current -> cf_co[i]) ^ 1;
     for (i = 0; i < N; i++)
         eq[i] = eq[i] & ce[i];
     for (i = 0; i < N; i++)
-        cf_comp[i] = (VS[i] > VT[i]); /* greater than */
+        rsp_current -> cf_comp[i] = (VS[i] > VT[i]); /* greater than */
     for (i = 0; i < N; i++)
-        cf_comp[i] = cf_comp[i] | eq[i]; /* ... or equal (commonly) */
+        rsp_current -> cf_comp[i] = rsp_current -> cf_comp[i] | eq[i]; /* ... or equal (commonly) */
 
-    merge(VACC_L, cf_comp, VS, VT);
+    merge(VACC_L, rsp_current -> cf_comp, VS, VT);
     vector_copy(VD, VACC_L);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
 
-    vector_wipe(cf_clip);
+    vector_wipe(rsp_current -> cf_clip);
     return;
 }
 
@@ -166,8 +386,8 @@ INLINE static void do_cl(pi16 VD, pi16 VS, pi16 VT)
         le[i] = cf_comp[i];
 */
     for (i = 0; i < N; i++)
-        eq[i] = cf_ne[i] ^ 1;
-    vector_copy(sn, cf_co);
+        eq[i] = rsp_current -> cf_ne[i] ^ 1;
+    vector_copy(sn, rsp_current -> cf_co);
 
 /*
  * Now that we have extracted all the flags, we will essentially be masking
@@ -189,9 +409,9 @@ INLINE static void do_cl(pi16 VD, pi16 VS, pi16 VT)
     for (i = 0; i < N; i++)
         len[i] = lz[i] & uz[i];
     for (i = 0; i < N; i++)
-        gen[i] = gen[i] & cf_vce[i];
+        gen[i] = gen[i] & rsp_current -> cf_vce[i];
     for (i = 0; i < N; i++)
-        len[i] = len[i] & (cf_vce[i] ^ 1);
+        len[i] = len[i] & (rsp_current -> cf_vce[i] ^ 1);
     for (i = 0; i < N; i++)
         len[i] = len[i] | gen[i];
     for (i = 0; i < N; i++)
@@ -199,25 +419,25 @@ INLINE static void do_cl(pi16 VD, pi16 VS, pi16 VT)
 
     for (i = 0; i < N; i++)
         cmp[i] = eq[i] & sn[i];
-    merge(le, cmp, len, cf_comp);
+    merge(le, cmp, len, rsp_current -> cf_comp);
 
     for (i = 0; i < N; i++)
         cmp[i] = eq[i] & (sn[i] ^ 1);
-    merge(ge, cmp, gen, cf_clip);
+    merge(ge, cmp, gen, rsp_current -> cf_clip);
 
     merge(cmp, sn, le, ge);
     merge(VACC_L, cmp, (pi16)VC, VS);
     vector_copy(VD, VACC_L);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
 
-    vector_copy(cf_clip, ge);
-    vector_copy(cf_comp, le);
+    vector_copy(rsp_current -> cf_clip, ge);
+    vector_copy(rsp_current -> cf_comp, le);
 
  /* CTC2    $0, $vce # zeroing RSP flags VCF[2] */
-    vector_wipe(cf_vce);
+    vector_wipe(rsp_current -> cf_vce);
     return;
 }
 
@@ -242,15 +462,15 @@ INLINE static void do_ch(pi16 VD, pi16 VS, pi16 VT)
     for (i = 0; i < N; i++)
         VC[i] ^= sn[i]; /* if (sn == ~0) {VT = ~VT;} else {VT =  VT;} */
     for (i = 0; i < N; i++)
-        cf_vce[i]  = (VS[i] == VC[i]); /* 2's complement:  VC = -VT - 1 = ~VT */
+        rsp_current -> cf_vce[i]  = (VS[i] == VC[i]); /* 2's complement:  VC = -VT - 1 = ~VT */
     for (i = 0; i < N; i++)
-        cf_vce[i] &= sn[i];
+        rsp_current -> cf_vce[i] &= sn[i];
     for (i = 0; i < N; i++)
         VC[i] -= sn[i] & cch[i]; /* converts ~(VT) into -(VT) if (sign) */
     for (i = 0; i < N; i++)
         eq[i]  = (VS[i] == VC[i]) & ~cch[i]; /* (VS == +32768) is never true. */
     for (i = 0; i < N; i++)
-        eq[i] |= cf_vce[i];
+        eq[i] |= rsp_current -> cf_vce[i];
 
 #ifdef _DEBUG
     for (i = 0; i < N; i++)
@@ -280,15 +500,15 @@ INLINE static void do_ch(pi16 VD, pi16 VS, pi16 VT)
     merge(le, sn, diff, le);
 #endif
 
-    merge(cf_comp, sn, le, ge);
-    merge(VACC_L, cf_comp, VC, VS);
+    merge(rsp_current -> cf_comp, sn, le, ge);
+    merge(VACC_L, rsp_current -> cf_comp, VC, VS);
     vector_copy(VD, VACC_L);
 
-    vector_copy(cf_clip, ge);
-    vector_copy(cf_comp, le);
+    vector_copy(rsp_current -> cf_clip, ge);
+    vector_copy(rsp_current -> cf_comp, le);
     for (i = 0; i < N; i++)
-        cf_ne[i] = eq[i] ^ 1;
-    vector_copy(cf_co, sn);
+        rsp_current -> cf_ne[i] = eq[i] ^ 1;
+    vector_copy(rsp_current -> cf_co, sn);
     return;
 }
 
@@ -326,23 +546,24 @@ INLINE static void do_cr(pi16 VD, pi16 VS, pi16 VT)
     vector_copy(VD, VACC_L);
 
  /* CTC2    $0, $vco # zeroing RSP flags VCF[0] */
-    vector_wipe(cf_ne);
-    vector_wipe(cf_co);
+    vector_wipe(rsp_current -> cf_ne);
+    vector_wipe(rsp_current -> cf_co);
 
-    vector_copy(cf_clip, ge);
-    vector_copy(cf_comp, le);
+    vector_copy(rsp_current -> cf_clip, ge);
+    vector_copy(rsp_current -> cf_comp, le);
 
  /* CTC2    $0, $vce # zeroing RSP flags VCF[2] */
-    vector_wipe(cf_vce);
+    vector_wipe(rsp_current -> cf_vce);
     return;
 }
 
 INLINE static void do_mrg(pi16 VD, pi16 VS, pi16 VT)
 {
-    merge(VACC_L, cf_comp, VS, VT);
+    merge(VACC_L, rsp_current -> cf_comp, VS, VT);
     vector_copy(VD, VACC_L);
     return;
 }
+#endif
 
 VECTOR_OPERATION VLT(v16 vs, v16 vt)
 {
@@ -363,7 +584,7 @@ VECTOR_OPERATION VLT(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -387,7 +608,7 @@ VECTOR_OPERATION VEQ(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -411,7 +632,7 @@ VECTOR_OPERATION VNE(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -435,7 +656,7 @@ VECTOR_OPERATION VGE(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -459,7 +680,7 @@ VECTOR_OPERATION VCL(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -483,7 +704,7 @@ VECTOR_OPERATION VCH(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -507,7 +728,7 @@ VECTOR_OPERATION VCR(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -531,7 +752,7 @@ VECTOR_OPERATION VMRG(v16 vs, v16 vt)
     vs = *(v16 *)VD;
     return (vs);
 #else
-    vector_copy(V_result, VD);
+    vector_copy(rsp_current -> V_result, VD);
     return;
 #endif
 }
@@ -24,23 +24,6 @@
 #include "pack.h"
 #endif
 
-ALIGNED i16 VR[32][N << VR_STATIC_WRAPAROUND];
-ALIGNED i16 VACC[3][N];
-#ifndef ARCH_MIN_SSE2
-ALIGNED i16 V_result[N];
-#endif
-
-/*
- * These normally should have type `int` because they are Boolean T/F arrays.
- * However, since SSE2 uses 128-bit XMM's, and Win32 `int` storage is 32-bit,
- * we have the problem of 32*8 > 128 bits, so we use `short` to reduce packs.
- */
-ALIGNED i16 cf_ne[N]; /* $vco:  high "NOTEQUAL" */
-ALIGNED i16 cf_co[N]; /* $vco:  low "carry/borrow in/out" */
-ALIGNED i16 cf_clip[N]; /* $vcc:  high (clip tests:  VCL, VCH, VCR) */
-ALIGNED i16 cf_comp[N]; /* $vcc:  low (VEQ, VNE, VLT, VGE, VCL, VCH, VCR) */
-ALIGNED i16 cf_vce[N]; /* $vce:  vector compare extension register */
-
 VECTOR_OPERATION res_V(v16 vs, v16 vt)
 {
     vt = vs; /* unused */
@@ -49,7 +32,7 @@ VECTOR_OPERATION res_V(v16 vs, v16 vt)
     vs = _mm_setzero_si128();
     return (vt = vs); /* -Wunused-but-set-parameter */
 #else
-    vector_wipe(V_result);
+    vector_wipe(rsp_current -> V_result);
     if (vt == vs)
         return; /* -Wunused-but-set-parameter */
     return;
@@ -90,22 +73,22 @@ u16 get_VCO(void)
     register u16 vco;
 
     vco = 0x0000
-      | (cf_ne[0xF % 8] << 0xF)
-      | (cf_ne[0xE % 8] << 0xE)
-      | (cf_ne[0xD % 8] << 0xD)
-      | (cf_ne[0xC % 8] << 0xC)
-      | (cf_ne[0xB % 8] << 0xB)
-      | (cf_ne[0xA % 8] << 0xA)
-      | (cf_ne[0x9 % 8] << 0x9)
-      | (cf_ne[0x8 % 8] << 0x8)
-      | (cf_co[0x7 % 8] << 0x7)
-      | (cf_co[0x6 % 8] << 0x6)
-      | (cf_co[0x5 % 8] << 0x5)
-      | (cf_co[0x4 % 8] << 0x4)
-      | (cf_co[0x3 % 8] << 0x3)
-      | (cf_co[0x2 % 8] << 0x2)
-      | (cf_co[0x1 % 8] << 0x1)
-      | (cf_co[0x0 % 8] << 0x0);
+      | (rsp_current -> cf_ne[0xF % 8] << 0xF)
+      | (rsp_current -> cf_ne[0xE % 8] << 0xE)
+      | (rsp_current -> cf_ne[0xD % 8] << 0xD)
+      | (rsp_current -> cf_ne[0xC % 8] << 0xC)
+      | (rsp_current -> cf_ne[0xB % 8] << 0xB)
+      | (rsp_current -> cf_ne[0xA % 8] << 0xA)
+      | (rsp_current -> cf_ne[0x9 % 8] << 0x9)
+      | (rsp_current -> cf_ne[0x8 % 8] << 0x8)
+      | (rsp_current -> cf_co[0x7 % 8] << 0x7)
+      | (rsp_current -> cf_co[0x6 % 8] << 0x6)
+      | (rsp_current -> cf_co[0x5 % 8] << 0x5)
+      | (rsp_current -> cf_co[0x4 % 8] << 0x4)
+      | (rsp_current -> cf_co[0x3 % 8] << 0x3)
+      | (rsp_current -> cf_co[0x2 % 8] << 0x2)
+      | (rsp_current -> cf_co[0x1 % 8] << 0x1)
+      | (rsp_current -> cf_co[0x0 % 8] << 0x0);
     return (vco); /* Big endian becomes little. */
 }
 u16 get_VCC(void)
@@ -113,22 +96,22 @@ u16 get_VCC(void)
     register u16 vcc;
 
     vcc = 0x0000
-      | (cf_clip[0xF % 8] << 0xF)
-      | (cf_clip[0xE % 8] << 0xE)
-      | (cf_clip[0xD % 8] << 0xD)
-      | (cf_clip[0xC % 8] << 0xC)
-      | (cf_clip[0xB % 8] << 0xB)
-      | (cf_clip[0xA % 8] << 0xA)
-      | (cf_clip[0x9 % 8] << 0x9)
-      | (cf_clip[0x8 % 8] << 0x8)
-      | (cf_comp[0x7 % 8] << 0x7)
-      | (cf_comp[0x6 % 8] << 0x6)
-      | (cf_comp[0x5 % 8] << 0x5)
-      | (cf_comp[0x4 % 8] << 0x4)
-      | (cf_comp[0x3 % 8] << 0x3)
-      | (cf_comp[0x2 % 8] << 0x2)
-      | (cf_comp[0x1 % 8] << 0x1)
-      | (cf_comp[0x0 % 8] << 0x0);
+      | (rsp_current -> cf_clip[0xF % 8] << 0xF)
+      | (rsp_current -> cf_clip[0xE % 8] << 0xE)
+      | (rsp_current -> cf_clip[0xD % 8] << 0xD)
+      | (rsp_current -> cf_clip[0xC % 8] << 0xC)
+      | (rsp_current -> cf_clip[0xB % 8] << 0xB)
+      | (rsp_current -> cf_clip[0xA % 8] << 0xA)
+      | (rsp_current -> cf_clip[0x9 % 8] << 0x9)
+      | (rsp_current -> cf_clip[0x8 % 8] << 0x8)
+      | (rsp_current -> cf_comp[0x7 % 8] << 0x7)
+      | (rsp_current -> cf_comp[0x6 % 8] << 0x6)
+      | (rsp_current -> cf_comp[0x5 % 8] << 0x5)
+      | (rsp_current -> cf_comp[0x4 % 8] << 0x4)
+      | (rsp_current -> cf_comp[0x3 % 8] << 0x3)
+      | (rsp_current -> cf_comp[0x2 % 8] << 0x2)
+      | (rsp_current -> cf_comp[0x1 % 8] << 0x1)
+      | (rsp_current -> cf_comp[0x0 % 8] << 0x0);
     return (vcc); /* Big endian becomes little. */
 }
 u8 get_VCE(void)
@@ -137,14 +120,14 @@ u8 get_VCE(void)
     register u8 vce;
 
     result = 0x00
-      | (cf_vce[07] << 0x7)
-      | (cf_vce[06] << 0x6)
-      | (cf_vce[05] << 0x5)
-      | (cf_vce[04] << 0x4)
-      | (cf_vce[03] << 0x3)
-      | (cf_vce[02] << 0x2)
-      | (cf_vce[01] << 0x1)
-      | (cf_vce[00] << 0x0);
+      | (rsp_current -> cf_vce[07] << 0x7)
+      | (rsp_current -> cf_vce[06] << 0x6)
+      | (rsp_current -> cf_vce[05] << 0x5)
+      | (rsp_current -> cf_vce[04] << 0x4)
+      | (rsp_current -> cf_vce[03] << 0x3)
+      | (rsp_current -> cf_vce[02] << 0x2)
+      | (rsp_current -> cf_vce[01] << 0x1)
+      | (rsp_current -> cf_vce[00] << 0x0);
     vce = result & 0xFF;
     return (vce); /* Big endian becomes little. */
 }
@@ -154,8 +137,8 @@ u16 get_VCO(void)
     v16 xmm, hi, lo;
     register u16 vco;
 
-    hi = _mm_load_si128((v16 *)cf_ne);
-    lo = _mm_load_si128((v16 *)cf_co);
+    hi = _mm_load_si128((v16 *)rsp_current -> cf_ne);
+    lo = _mm_load_si128((v16 *)rsp_current -> cf_co);
 
 /*
  * Rotate Boolean storage from LSB to MSB.
@@ -172,8 +155,8 @@ u16 get_VCC(void)
     v16 xmm, hi, lo;
     register u16 vcc;
 
-    hi = _mm_load_si128((v16 *)cf_clip);
-    lo = _mm_load_si128((v16 *)cf_comp);
+    hi = _mm_load_si128((v16 *)rsp_current -> cf_clip);
+    lo = _mm_load_si128((v16 *)rsp_current -> cf_comp);
 
 /*
  * Rotate Boolean storage from LSB to MSB.
@@ -191,7 +174,7 @@ u8 get_VCE(void)
     register u8 vce;
 
     hi = _mm_setzero_si128();
-    lo = _mm_load_si128((v16 *)cf_vce);
+    lo = _mm_load_si128((v16 *)rsp_current -> cf_vce);
 
     lo = _mm_slli_epi16(lo, 15); /* Rotate Boolean storage from LSB to MSB. */
 
@@ -210,9 +193,9 @@ void set_VCO(u16 vco)
     register int i;
 
     for (i = 0; i < N; i++)
-        cf_co[i] = (vco >> (i + 0x0)) & 1;
+        rsp_current -> cf_co[i] = (vco >> (i + 0x0)) & 1;
     for (i = 0; i < N; i++)
-        cf_ne[i] = (vco >> (i + 0x8)) & 1;
+        rsp_current -> cf_ne[i] = (vco >> (i + 0x8)) & 1;
     return; /* Little endian becomes big. */
 }
 void set_VCC(u16 vcc)
@@ -220,9 +203,9 @@ void set_VCC(u16 vcc)
     register int i;
 
     for (i = 0; i < N; i++)
-        cf_comp[i] = (vcc >> (i + 0x0)) & 1;
+        rsp_current -> cf_comp[i] = (vcc >> (i + 0x0)) & 1;
     for (i = 0; i < N; i++)
-        cf_clip[i] = (vcc >> (i + 0x8)) & 1;
+        rsp_current -> cf_clip[i] = (vcc >> (i + 0x8)) & 1;
     return; /* Little endian becomes big. */
 }
 void set_VCE(u8 vce)
@@ -230,6 +213,6 @@ void set_VCE(u8 vce)
     register int i;
 
     for (i = 0; i < N; i++)
-        cf_vce[i] = (vce >> i) & 1;
+        rsp_current -> cf_vce[i] = (vce >> i) & 1;
     return; /* Little endian becomes big. */
 }
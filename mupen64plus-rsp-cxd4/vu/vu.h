@@ -19,6 +19,19 @@
 #include <emmintrin.h>
 #endif
 
+/*
+ * ARM builds with HAVE_NEON use NEON intrinsics in the vector unit.  The
+ * compiler must actually be targeting NEON (`__ARM_NEON'), since the build
+ * defines HAVE_NEON for some platforms without passing -mfpu=neon.
+ *
+ * Unlike SSE2, vectors are still passed to and from the COP2_C2[] functions
+ * by pointer (`v16' is `pi16'), so only the kernels behind them change.
+ */
+#if defined(HAVE_NEON) && defined(__ARM_NEON) && !defined(ARCH_MIN_SSE2)
+#define ARCH_MIN_ARM_NEON
+#include <arm_neon.h>
+#endif
+
 #include "../my_types.h"
 
 #define N       8
@@ -40,8 +53,12 @@
 /*
  * We are going to need this for vector operations doing scalar things.
  * The divides and VSAW need bit-wise information from the instruction word.
+ *
+ * The vector unit's state, like the rest of the RSP's, belongs to the
+ * current context:  `rsp_current -> inst_word', `VR', `VACC', `V_result' and
+ * the `cf_*' flags below.
  */
-extern u32 inst_word;
+#include "../context.h"
 
 /*
  * RSP virtual registers (of vector unit)
@@ -50,26 +67,27 @@ extern u32 inst_word;
  *
  * For ?WC2 we may need to do byte-precision access just as directly.
  * This is amended by using the `VU_S` and `VU_B` macros defined in `rsp.h`.
+ *
+ * ALIGNED i16 VR[32][N << VR_STATIC_WRAPAROUND];
  */
-ALIGNED extern i16 VR[32][N << VR_STATIC_WRAPAROUND];
 
 /*
  * The RSP accumulator is a vector of 3 48-bit integers.  Nearly all of the
  * vector operations access it, but it's for multiply-accumulate operations.
  *
  * Access dimensions would be VACC[8][3] but are inverted for SIMD benefits.
+ *
+ * ALIGNED i16 VACC[3][N];
  */
-ALIGNED extern i16 VACC[3][N];
 
 /*
  * When compiling without SSE2, we need to use a pointer to a destination
  * vector instead of an XMM register in the return slot of the function.
  * The vector "result" register will be emulated to serve this pointer
- * as a shared global rather than the return slot of a function call.
+ * as a member of the context rather than the return slot of a function call.
+ *
+ * ALIGNED i16 V_result[N];
  */
-#ifndef ARCH_MIN_SSE2
-ALIGNED extern i16 V_result[N];
-#endif
 
 /*
  * accumulator-indexing macros
@@ -78,9 +96,9 @@ ALIGNED extern i16 V_result[N];
 #define MD      01
 #define LO      02
 
-#define VACC_L      (VACC[LO])
-#define VACC_M      (VACC[MD])
-#define VACC_H      (VACC[HI])
+#define VACC_L      (rsp_current -> VACC[LO])
+#define VACC_M      (rsp_current -> VACC[MD])
+#define VACC_H      (rsp_current -> VACC[HI])
 
 #define ACC_L(i)    (VACC_L)[i]
 #define ACC_M(i)    (VACC_M)[i]
@@ -132,6 +150,41 @@ VECTOR_EXTERN (*COP2_C2[8*7 + 8])(v16, v16);
 #define vector_cmpgt(vd, vs) { \
     *(v16 *)&(vd) = _mm_cmpgt_epi16(*(v16 *)&(vd), *(v16 *)&(vs)); }
 
+#elif defined(ARCH_MIN_ARM_NEON)
+
+#define vector_copy(vd, vs) { \
+    vst1q_s16((i16 *)(vd), vld1q_s16((const i16 *)(vs))); }
+#define vector_wipe(vd) { \
+    vst1q_s16((i16 *)(vd), vdupq_n_s16(0x0000)); }
+#define vector_fill(vd) { \
+    vst1q_s16((i16 *)(vd), vdupq_n_s16(~0x0000)); }
+
+#define vector_and(vd, vs) { \
+    vst1q_s16((i16 *)(vd), vandq_s16(vld1q_s16((i16 *)(vd)), \
+                                     vld1q_s16((const i16 *)(vs)))); }
+#define vector_or(vd, vs) { \
+    vst1q_s16((i16 *)(vd), vorrq_s16(vld1q_s16((i16 *)(vd)), \
+                                     vld1q_s16((const i16 *)(vs)))); }
+#define vector_xor(vd, vs) { \
+    vst1q_s16((i16 *)(vd), veorq_s16(vld1q_s16((i16 *)(vd)), \
+                                     vld1q_s16((const i16 *)(vs)))); }
+
+#define vector_cmplt(vd, vs) { \
+    vst1q_s16((i16 *)(vd), vreinterpretq_s16_u16(vcltq_s16( \
+        vld1q_s16((i16 *)(vd)), vld1q_s16((const i16 *)(vs))))); }
+#define vector_cmpeq(vd, vs) { \
+    vst1q_s16((i16 *)(vd), vreinterpretq_s16_u16(vceqq_s16( \
+        vld1q_s16((i16 *)(vd)), vld1q_s16((const i16 *)(vs))))); }
+#define vector_cmpgt(vd, vs) { \
+    vst1q_s16((i16 *)(vd), vreinterpretq_s16_u16(vcgtq_s16( \
+        vld1q_s16((i16 *)(vd)), vld1q_s16((const i16 *)(vs))))); }
+
+/*
+ * The RSP flags are kept as 0 or 1 per element, while NEON comparisons give
+ * 0 or ~0 masks.
+ */
+#define vector_flag(mask)   vreinterpretq_s16_u16(vshrq_n_u16((mask), 15))
+
 #else
 
 #define vector_copy(vd, vs) { \
@@ -242,12 +295,6 @@ extern u16 VCO;
 extern u16 VCC;
 extern u8 VCE;
 
-ALIGNED extern i16 cf_ne[N];
-ALIGNED extern i16 cf_co[N];
-ALIGNED extern i16 cf_clip[N];
-ALIGNED extern i16 cf_comp[N];
-ALIGNED extern i16 cf_vce[N];
-
 extern u16 get_VCO(void);
 extern u16 get_VCC(void);
 extern u8 get_VCE(void);
@@ -25,7 +25,9 @@
 #include <stdint.h>
 
 #ifdef ENABLE_TASK_DUMP
+#include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 #endif
 
 #include "hle_external.h"
@@ -33,6 +35,8 @@
 #include "memory.h"
 #include "ucodes.h"
 
+#include "main/trace.h"
+
 #define min(a,b) (((a) < (b)) ? (a) : (b))
 
 /* some rdp status flags */
@@ -56,6 +60,7 @@ static void dump_binary(struct hle_t* hle, const char *const filename,
 static void dump_task(struct hle_t* hle, const char *const filename);
 static void dump_unknown_task(struct hle_t* hle, unsigned int sum);
 static void dump_unknown_non_task(struct hle_t* hle, unsigned int sum);
+static void dump_audio_task(struct hle_t* hle, const char *const name);
 #endif
 
 /* Global functions */
@@ -154,6 +159,14 @@ void rsp_break(struct hle_t* hle, unsigned int setbits)
     }
 }
 
+/* runs the ucode emulated by task, in a trace zone of the same name */
+static void run_ucode(struct hle_t* hle, const char* name, void (*task)(struct hle_t* hle))
+{
+    TRACE_BEGIN(name);
+    task(hle);
+    TRACE_END();
+}
+
 static void send_alist_to_audio_plugin(struct hle_t* hle)
 {
     HleProcessAlistList(hle->user_defined);
@@ -189,11 +202,11 @@ static bool try_fast_audio_dispatching(struct hle_t* hle)
             switch(v)
             {
             case 0x1e24138c: /* audio ABI (most common) */
-                alist_process_audio(hle); return true;
+                run_ucode(hle, "alist_process_audio", alist_process_audio); return true;
             case 0x1dc8138c: /* GoldenEye */
-                alist_process_audio_ge(hle); return true;
+                run_ucode(hle, "alist_process_audio_ge", alist_process_audio_ge); return true;
             case 0x1e3c1390: /* BlastCorp, DiddyKongRacing */
-                alist_process_audio_bc(hle); return true;
+                run_ucode(hle, "alist_process_audio_bc", alist_process_audio_bc); return true;
             default:
                 HleWarnMessage(hle->user_defined, "ABI1 identification regression: v=%08x", v);
             }
@@ -202,33 +215,36 @@ static bool try_fast_audio_dispatching(struct hle_t* hle)
             switch(v)
             {
             case 0x11181350: /* MarioKart, WaveRace (E) */
-                alist_process_nead_mk(hle); return true;
+                run_ucode(hle, "alist_process_nead_mk", alist_process_nead_mk); return true;
             case 0x111812e0: /* StarFox (J) */
-                alist_process_nead_sfj(hle); return true;
+                run_ucode(hle, "alist_process_nead_sfj", alist_process_nead_sfj); return true;
             case 0x110412ac: /* WaveRace (J RevB) */
-                alist_process_nead_wrjb(hle); return true;
+                run_ucode(hle, "alist_process_nead_wrjb", alist_process_nead_wrjb); return true;
             case 0x110412cc: /* StarFox/LylatWars (except J) */
-                alist_process_nead_sf(hle); return true;
+                run_ucode(hle, "alist_process_nead_sf", alist_process_nead_sf); return true;
             case 0x1cd01250: /* FZeroX */
-                alist_process_nead_fz(hle); return true;
+                run_ucode(hle, "alist_process_nead_fz", alist_process_nead_fz); return true;
             case 0x1f08122c: /* YoshisStory */
-                alist_process_nead_ys(hle); return true;
+                run_ucode(hle, "alist_process_nead_ys", alist_process_nead_ys); return true;
             case 0x1f38122c: /* 1080° Snowboarding */
-                alist_process_nead_1080(hle); return true;
+                run_ucode(hle, "alist_process_nead_1080", alist_process_nead_1080); return true;
             case 0x1f681230: /* Zelda OoT / Zelda MM (J, J RevA) */
-                alist_process_nead_oot(hle); return true;
+                run_ucode(hle, "alist_process_nead_oot", alist_process_nead_oot); return true;
             case 0x1f801250: /* Zelda MM (except J, J RevA, E Beta), PokemonStadium 2 */
-                alist_process_nead_mm(hle); return true;
+                run_ucode(hle, "alist_process_nead_mm", alist_process_nead_mm); return true;
             case 0x109411f8: /* Zelda MM (E Beta) */
-                alist_process_nead_mmb(hle); return true;
+                run_ucode(hle, "alist_process_nead_mmb", alist_process_nead_mmb); return true;
             case 0x1eac11b8: /* AnimalCrossing */
-                alist_process_nead_ac(hle); return true;
+                run_ucode(hle, "alist_process_nead_ac", alist_process_nead_ac); return true;
             case 0x00010010: /* MusyX v2 (IndianaJones, BattleForNaboo) */
-                musyx_v2_task(hle); return true;
+#ifdef ENABLE_TASK_DUMP
+                dump_audio_task(hle, "musyx_v2");
+#endif
+                run_ucode(hle, "musyx_v2_task", musyx_v2_task); return true;
             case 0x1f701238: /* Mario Artist Talent Studio */
-                alist_process_nead_mats(hle); return true;
+                run_ucode(hle, "alist_process_nead_mats", alist_process_nead_mats); return true;
             case 0x1f4c1230: /* FZeroX Expansion */
-                alist_process_nead_efz(hle); return true;
+                run_ucode(hle, "alist_process_nead_efz", alist_process_nead_efz); return true;
             default:
                 HleWarnMessage(hle->user_defined, "ABI2 identification regression: v=%08x", v);
             }
@@ -241,17 +257,23 @@ static bool try_fast_audio_dispatching(struct hle_t* hle)
             RogueSquadron, ResidentEvil2, PolarisSnoCross,
             TheWorldIsNotEnough, RugratsInParis, NBAShowTime,
             HydroThunder, Tarzan, GauntletLegend, Rush2049 */
-            musyx_v1_task(hle); return true;
+#ifdef ENABLE_TASK_DUMP
+            dump_audio_task(hle, "musyx_v1");
+#endif
+            run_ucode(hle, "musyx_v1_task", musyx_v1_task); return true;
         case 0x0000127c: /* naudio (many games) */
-            alist_process_naudio(hle); return true;
+            run_ucode(hle, "alist_process_naudio", alist_process_naudio); return true;
         case 0x00001280: /* BanjoKazooie */
-            alist_process_naudio_bk(hle); return true;
+            run_ucode(hle, "alist_process_naudio_bk", alist_process_naudio_bk); return true;
         case 0x1c58126c: /* DonkeyKong */
-            alist_process_naudio_dk(hle); return true;
+            run_ucode(hle, "alist_process_naudio_dk", alist_process_naudio_dk); return true;
         case 0x1ae8143c: /* BanjoTooie, JetForceGemini, MickeySpeedWayUSA, PerfectDark */
-            alist_process_naudio_mp3(hle); return true;
+#ifdef ENABLE_TASK_DUMP
+            dump_audio_task(hle, "naudio_mp3");
+#endif
+            run_ucode(hle, "alist_process_naudio_mp3", alist_process_naudio_mp3); return true;
         case 0x1ab0140c: /* ConkerBadFurDay */
-            alist_process_naudio_cbfd(hle); return true;
+            run_ucode(hle, "alist_process_naudio_cbfd", alist_process_naudio_cbfd); return true;
 
         default:
             HleWarnMessage(hle->user_defined, "ABI3 identification regression: v=%08x", v);
@@ -315,18 +337,18 @@ static void normal_task_dispatching(struct hle_t* hle)
 
     /* JPEG: found in Pokemon Stadium J */
     case 0x2c85a:
-        jpeg_decode_PS0(hle);
+        run_ucode(hle, "jpeg_decode_PS0", jpeg_decode_PS0);
         return;
 
     /* JPEG: found in Zelda Ocarina of Time, Pokemon Stadium 1, Pokemon Stadium 2 */
     case 0x2caa6:
-        jpeg_decode_PS(hle);
+        run_ucode(hle, "jpeg_decode_PS", jpeg_decode_PS);
         return;
 
     /* JPEG: found in Ogre Battle, Bottom of the 9th */
     case 0x130de:
     case 0x278b0:
-        jpeg_decode_OB(hle);
+        run_ucode(hle, "jpeg_decode_OB", jpeg_decode_OB);
         return;
     }
 
@@ -351,7 +373,7 @@ static void non_task_dispatching(struct hle_t* hle)
     if (sum == 0x9e2)
     {
         /* CIC x105 ucode (used during boot of CIC x105 games) */
-        cicx105_ucode(hle);
+        run_ucode(hle, "cicx105_ucode", cicx105_ucode);
         return;
     }
 
@@ -375,15 +397,15 @@ static bool try_re2_task_dispatching(struct hle_t* hle)
     switch (sum) {
 
     case 0x450f:
-        resize_bilinear_task(hle);
+        run_ucode(hle, "resize_bilinear_task", resize_bilinear_task);
         return true;
 
     case 0x3b44:
-        decode_video_frame_task(hle);
+        run_ucode(hle, "decode_video_frame_task", decode_video_frame_task);
         return true;
 
     case 0x3d84:
-        fill_video_double_buffer_task(hle);
+        run_ucode(hle, "fill_video_double_buffer_task", fill_video_double_buffer_task);
         return true;
     }
 
@@ -436,6 +458,45 @@ static void dump_unknown_non_task(struct hle_t* hle, unsigned int sum)
     dump_binary(hle, filename, hle->dmem, 0x1000);
 }
 
+/* Saves the input of an audio task, for the replay harness of
+ * libretro/benchmark/hle_audio_benchmark.c: one task out of 64, up to 16.
+ *
+ * The file holds, in host byte order:
+ *   - "HLETASK1", and the ucode name padded with zeros to 16 bytes,
+ *   - the size of the ucode state, as an uint32_t,
+ *   - DMEM (0x1000 bytes),
+ *   - the ucode state: struct hle_t from alist_buffer to its end,
+ *   - RDRAM (0x800000 bytes). */
+static void dump_audio_task(struct hle_t* hle, const char *const name)
+{
+    static unsigned int count = 0;
+    const uint32_t state_size = sizeof(*hle) - offsetof(struct hle_t, alist_buffer);
+    char header[24] = "HLETASK1";
+    char filename[256];
+    FILE *f;
+
+    if ((count++ % 64) != 0 || count > 64 * 16)
+        return;
+
+    strncpy(header + 8, name, 15);
+    sprintf(&filename[0], "%s_%02u.task", name, count / 64);
+
+    f = fopen(filename, "wb");
+    if (f == NULL) {
+        HleErrorMessage(hle->user_defined, "Couldn't open %s for writing !", filename);
+        return;
+    }
+
+    if (fwrite(header, 1, sizeof(header), f) != sizeof(header)
+     || fwrite(&state_size, sizeof(state_size), 1, f) != 1
+     || fwrite(hle->dmem, 1, 0x1000, f) != 0x1000
+     || fwrite(hle->alist_buffer, 1, state_size, f) != state_size
+     || fwrite(hle->dram, 1, 0x800000, f) != 0x800000)
+        HleErrorMessage(hle->user_defined, "Writing error on %s", filename);
+
+    fclose(f);
+}
+
 static void dump_binary(struct hle_t* hle, const char *const filename,
                         const unsigned char *const bytes, unsigned int size)
 {
@@ -27,6 +27,7 @@
 #include "arithmetics.h"
 #include "hle_internal.h"
 #include "memory.h"
+#include "simd.h"
 
 static void InnerLoop(struct hle_t* hle,
                       uint32_t outPtr, uint32_t inPtr,
@@ -167,6 +168,89 @@ static const uint16_t DeWindowLUT [0x420] = {
     0x0B37, 0xF736, 0x037A, 0xFF38, 0x005D, 0xFFF3, 0x0000, 0x0000
 };
 
+#if defined(HLE_SSE2)
+/* rounded products of 8 samples with 8 window coefficients, summed in pairs
+ * and negated in odd lanes of signs */
+static inline __m128i dewindow8(const uint8_t* samples, const uint16_t* window, __m128i signs)
+{
+    const __m128i round = _mm_set1_epi32(0x4000);
+    __m128i x = _mm_loadu_si128((const __m128i *)samples);
+    __m128i h = _mm_loadu_si128((const __m128i *)window);
+    __m128i lo = _mm_srai_epi32(_mm_add_epi32(simd_mull_lo(x, h), round), 15);
+    __m128i hi = _mm_srai_epi32(_mm_add_epi32(simd_mull_hi(x, h), round), 15);
+
+    lo = _mm_sub_epi32(_mm_xor_si128(lo, signs), signs);
+    hi = _mm_sub_epi32(_mm_xor_si128(hi, signs), signs);
+
+    return _mm_add_epi32(lo, hi);
+}
+#elif defined(HLE_NEON)
+static inline int32x4_t dewindow8(const uint8_t* samples, const uint16_t* window, int32x4_t signs)
+{
+    int16x8_t x = vld1q_s16((const int16_t *)samples);
+    int16x8_t h = vreinterpretq_s16_u16(vld1q_u16(window));
+    int32x4_t lo = vrshrq_n_s32(vmull_s16(vget_low_s16(x),  vget_low_s16(h)),  15);
+    int32x4_t hi = vrshrq_n_s32(vmull_s16(vget_high_s16(x), vget_high_s16(h)), 15);
+
+    lo = vsubq_s32(veorq_s32(lo, signs), signs);
+    hi = vsubq_s32(veorq_s32(hi, signs), signs);
+
+    return vaddq_s32(lo, hi);
+}
+#endif
+
+/* v[k] = sum of the rounded products of the 8 samples at samples[k] with
+ * the 8 window coefficients at window + 0x00, 0x08, 0x20, 0x28 for k = 0..3.
+ * Odd products are subtracted when alternate is set. */
+static inline void dewindow(int32_t* v, const uint8_t* const samples[4],
+                            const uint16_t* window, int alternate)
+{
+    static const unsigned int window_offsets[4] = { 0x00, 0x08, 0x20, 0x28 };
+
+#if defined(HLE_SSE2)
+    const __m128i signs = alternate ? _mm_set_epi32(-1, 0, -1, 0) : _mm_setzero_si128();
+    __m128i s0 = dewindow8(samples[0], window + window_offsets[0], signs);
+    __m128i s1 = dewindow8(samples[1], window + window_offsets[1], signs);
+    __m128i s2 = dewindow8(samples[2], window + window_offsets[2], signs);
+    __m128i s3 = dewindow8(samples[3], window + window_offsets[3], signs);
+
+    /* transpose and add */
+    __m128i s01 = _mm_add_epi32(_mm_unpacklo_epi32(s0, s1), _mm_unpackhi_epi32(s0, s1));
+    __m128i s23 = _mm_add_epi32(_mm_unpacklo_epi32(s2, s3), _mm_unpackhi_epi32(s2, s3));
+
+    _mm_storeu_si128((__m128i *)v, _mm_add_epi32(_mm_unpacklo_epi64(s01, s23),
+                                                 _mm_unpackhi_epi64(s01, s23)));
+#elif defined(HLE_NEON)
+    static const int32_t alternate_signs[4] = { 0, -1, 0, -1 };
+    const int32x4_t signs = alternate ? vld1q_s32(alternate_signs) : vdupq_n_s32(0);
+    int32x4_t s0 = dewindow8(samples[0], window + window_offsets[0], signs);
+    int32x4_t s1 = dewindow8(samples[1], window + window_offsets[1], signs);
+    int32x4_t s2 = dewindow8(samples[2], window + window_offsets[2], signs);
+    int32x4_t s3 = dewindow8(samples[3], window + window_offsets[3], signs);
+
+    int32x2_t s01 = vpadd_s32(vpadd_s32(vget_low_s32(s0), vget_high_s32(s0)),
+                              vpadd_s32(vget_low_s32(s1), vget_high_s32(s1)));
+    int32x2_t s23 = vpadd_s32(vpadd_s32(vget_low_s32(s2), vget_high_s32(s2)),
+                              vpadd_s32(vget_low_s32(s3), vget_high_s32(s3)));
+
+    vst1q_s32(v, vcombine_s32(s01, s23));
+#else
+    int32_t even[4] = { 0, 0, 0, 0 };
+    int32_t odd[4] = { 0, 0, 0, 0 };
+    int i, k;
+
+    for (i = 0; i < 8; i += 2) {
+        for (k = 0; k < 4; k++) {
+            even[k] += ((int) * (int16_t *)(samples[k] + 2 * i + 0) * (short)window[window_offsets[k] + i + 0] + 0x4000) >> 0xF;
+            odd[k]  += ((int) * (int16_t *)(samples[k] + 2 * i + 2) * (short)window[window_offsets[k] + i + 1] + 0x4000) >> 0xF;
+        }
+    }
+
+    for (k = 0; k < 4; k++)
+        v[k] = alternate ? even[k] - odd[k] : even[k] + odd[k];
+#endif
+}
+
 static void MP3AB0(int32_t* v)
 {
     /* Part 2 - 100% Accurate */
@@ -271,7 +355,8 @@ static void InnerLoop(struct hle_t* hle,
     uint32_t t1;
     uint32_t t2;
     uint32_t t3;
-    int32_t v2 = 0, v4 = 0, v6 = 0, v8 = 0;
+    int32_t v2 = 0, v4 = 0;
+    int32_t sums[4];
     uint32_t offset;
     uint32_t addptr;
     int x;
@@ -577,20 +662,21 @@ static void InnerLoop(struct hle_t* hle,
 
     offset = 0x10 - (t4 >> 1);
     for (x = 0; x < 8; x++) {
+        const uint8_t* const samples[4] = {
+            hle->mp3_buffer + addptr + 0x00,
+            hle->mp3_buffer + addptr + 0x10,
+            hle->mp3_buffer + addptr + 0x20,
+            hle->mp3_buffer + addptr + 0x30
+        };
         int32_t v0;
         int32_t v18;
-        v2 = v4 = v6 = v8 = 0;
-
-        for (i = 7; i >= 0; i--) {
-            v2 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x00) * (short)DeWindowLUT[offset + 0x00] + 0x4000) >> 0xF;
-            v4 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x10) * (short)DeWindowLUT[offset + 0x08] + 0x4000) >> 0xF;
-            v6 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x20) * (short)DeWindowLUT[offset + 0x20] + 0x4000) >> 0xF;
-            v8 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x30) * (short)DeWindowLUT[offset + 0x28] + 0x4000) >> 0xF;
-            addptr += 2;
-            offset++;
-        }
-        v0  = v2 + v4;
-        v18 = v6 + v8;
+
+        dewindow(sums, samples, DeWindowLUT + offset, 0);
+        addptr += 0x10;
+        offset += 8;
+
+        v0  = sums[0] + sums[1];
+        v18 = sums[2] + sums[3];
         /* Clamp(v0); */
         /* Clamp(v18); */
         /* clamp??? */
@@ -626,26 +712,22 @@ static void InnerLoop(struct hle_t* hle,
     addptr -= 0x50;
 
     for (x = 0; x < 8; x++) {
+        const uint8_t* const samples[4] = {
+            hle->mp3_buffer + addptr + 0x20,
+            hle->mp3_buffer + addptr + 0x30,
+            hle->mp3_buffer + addptr + 0x00,
+            hle->mp3_buffer + addptr + 0x10
+        };
         int32_t v0;
         int32_t v18;
-        v2 = v4 = v6 = v8 = 0;
 
         offset = (0x22F - (t4 >> 1) + x * 0x40);
 
-        for (i = 0; i < 4; i++) {
-            v2 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x20) * (short)DeWindowLUT[offset + 0x00] + 0x4000) >> 0xF;
-            v2 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x20) * (short)DeWindowLUT[offset + 0x01] + 0x4000) >> 0xF;
-            v4 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x30) * (short)DeWindowLUT[offset + 0x08] + 0x4000) >> 0xF;
-            v4 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x30) * (short)DeWindowLUT[offset + 0x09] + 0x4000) >> 0xF;
-            v6 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x00) * (short)DeWindowLUT[offset + 0x20] + 0x4000) >> 0xF;
-            v6 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x00) * (short)DeWindowLUT[offset + 0x21] + 0x4000) >> 0xF;
-            v8 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x10) * (short)DeWindowLUT[offset + 0x28] + 0x4000) >> 0xF;
-            v8 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x10) * (short)DeWindowLUT[offset + 0x29] + 0x4000) >> 0xF;
-            addptr += 4;
-            offset += 2;
-        }
-        v0  = v2 + v4;
-        v18 = v6 + v8;
+        dewindow(sums, samples, DeWindowLUT + offset, 1);
+        addptr += 0x10;
+
+        v0  = sums[0] + sums[1];
+        v18 = sums[2] + sums[3];
         /* Clamp(v0); */
         /* Clamp(v18); */
         /* clamp??? */
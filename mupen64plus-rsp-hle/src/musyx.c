@@ -30,6 +30,7 @@
 #include "hle_external.h"
 #include "hle_internal.h"
 #include "memory.h"
+#include "simd.h"
 
 /* various constants */
 enum { SUBFRAME_SIZE = 192 };
@@ -174,6 +175,9 @@ static void mix_sfx_with_main_subframes_v1(musyx_t *musyx, const int16_t *subfra
 static void mix_sfx_with_main_subframes_v2(musyx_t *musyx, const int16_t *subframe,
                                            const uint16_t* gains);
 
+static void resample_subframe(int16_t *dst, const int16_t *const *samples,
+                              const int16_t *const *luts);
+static int16_t envmix(int16_t *dst, const int16_t *src, int32_t env, int32_t env_step);
 static void mix_samples(int16_t *y, int16_t x, int16_t hgain);
 static void mix_subframes(int16_t *y, const int16_t *x, int16_t hgain);
 static void mix_fir4(int16_t *y, const int16_t *x, int16_t hgain, const int16_t *hcoeffs);
@@ -697,6 +701,10 @@ static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
     int16_t *v4_dst[4];
     int16_t  v4[4];
 
+    const int16_t *sample_ptrs[SUBFRAME_SIZE];
+    const int16_t *lut_ptrs[SUBFRAME_SIZE];
+    int16_t  resampled[SUBFRAME_SIZE];
+
     dram_load_u32(hle, (uint32_t *)v4_env,      voice_ptr + VOICE_ENV_BEGIN, 4);
     dram_load_u32(hle, (uint32_t *)v4_env_step, voice_ptr + VOICE_ENV_STEP,  4);
 
@@ -723,7 +731,6 @@ static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
         /* update sample and lut pointers and then pitch_accu */
         const int16_t *lut = (RESAMPLE_LUT + ((pitch_accu & 0xfc00) >> 8));
         int dist;
-        int16_t v;
 
         sample += (pitch_accu >> 16);
         pitch_accu &= 0xffff;
@@ -734,21 +741,17 @@ static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
         if (dist >= 0)
             sample = sample_restart + dist;
 
-        /* apply resample filter */
-        v = clamp_s16(dot4(sample, lut));
-
-        for (k = 0; k < 4; ++k) {
-            /* envmix */
-            int32_t accu = (v * (v4_env[k] >> 16)) >> 15;
-            v4[k] = clamp_s16(accu);
-            *(v4_dst[k]) = clamp_s16(accu + *(v4_dst[k]));
-
-            /* update envelopes and dst pointers */
-            ++(v4_dst[k]);
-            v4_env[k] += v4_env_step[k];
-        }
+        sample_ptrs[i] = sample;
+        lut_ptrs[i] = lut;
     }
 
+    /* apply resample filter */
+    resample_subframe(resampled, sample_ptrs, lut_ptrs);
+
+    /* envmix resampled subframe into each internal subframe */
+    for (k = 0; k < 4; ++k)
+        v4[k] = envmix(v4_dst[k], resampled, v4_env[k], v4_env_step[k]);
+
     /* save last resampled sample */
     dram_store_u16(hle, (uint16_t *)v4, last_sample_ptr, 4);
 
@@ -854,9 +857,27 @@ static void sfx_stage(struct hle_t* hle, mix_sfx_with_main_subframes_t mix_sfx_w
 static void mix_sfx_with_main_subframes_v1(musyx_t *musyx, const int16_t *subframe,
                                            const uint16_t* UNUSED(gains))
 {
-    unsigned i;
+    unsigned i = 0;
 
-    for (i = 0; i < SUBFRAME_SIZE; ++i) {
+#if defined(HLE_SSE2)
+    for (; i < SUBFRAME_SIZE; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&subframe[i]);
+        __m128i l = _mm_loadu_si128((const __m128i *)&musyx->left[i]);
+        __m128i r = _mm_loadu_si128((const __m128i *)&musyx->right[i]);
+
+        _mm_storeu_si128((__m128i *)&musyx->left[i],  _mm_adds_epi16(l, v));
+        _mm_storeu_si128((__m128i *)&musyx->right[i], _mm_adds_epi16(r, v));
+    }
+#elif defined(HLE_NEON)
+    for (; i < SUBFRAME_SIZE; i += 8) {
+        int16x8_t v = vld1q_s16(&subframe[i]);
+
+        vst1q_s16(&musyx->left[i],  vqaddq_s16(vld1q_s16(&musyx->left[i]),  v));
+        vst1q_s16(&musyx->right[i], vqaddq_s16(vld1q_s16(&musyx->right[i]), v));
+    }
+#endif
+
+    for (; i < SUBFRAME_SIZE; ++i) {
         int16_t v = subframe[i];
         musyx->left[i]  = clamp_s16(musyx->left[i]  + v);
         musyx->right[i] = clamp_s16(musyx->right[i] + v);
@@ -866,9 +887,53 @@ static void mix_sfx_with_main_subframes_v1(musyx_t *musyx, const int16_t *subfra
 static void mix_sfx_with_main_subframes_v2(musyx_t *musyx, const int16_t *subframe,
                                            const uint16_t* gains)
 {
-    unsigned i;
+    unsigned i = 0;
+
+#if defined(HLE_SSE2) || defined(HLE_NEON)
+    /* gains are unsigned: (v * g) >> 16 is the high half of the signed
+     * product v * (int16_t)g, plus v when the top bit of g is set */
+    const int16_t g1 = (int16_t)gains[0];
+    const int16_t g2 = (int16_t)gains[1];
+    const int16_t m1 = (gains[0] & 0x8000) ? -1 : 0;
+    const int16_t m2 = (gains[1] & 0x8000) ? -1 : 0;
+#endif
+
+#if defined(HLE_SSE2)
+    const __m128i vg1 = _mm_set1_epi16(g1);
+    const __m128i vg2 = _mm_set1_epi16(g2);
+    const __m128i vm1 = _mm_set1_epi16(m1);
+    const __m128i vm2 = _mm_set1_epi16(m2);
+
+    for (; i < SUBFRAME_SIZE; i += 8) {
+        __m128i v  = _mm_loadu_si128((const __m128i *)&subframe[i]);
+        __m128i v1 = _mm_add_epi16(_mm_mulhi_epi16(v, vg1), _mm_and_si128(v, vm1));
+        __m128i v2 = _mm_add_epi16(_mm_mulhi_epi16(v, vg2), _mm_and_si128(v, vm2));
+        __m128i l  = _mm_loadu_si128((const __m128i *)&musyx->left[i]);
+        __m128i r  = _mm_loadu_si128((const __m128i *)&musyx->right[i]);
+        __m128i c  = _mm_loadu_si128((const __m128i *)&musyx->cc0[i]);
+
+        _mm_storeu_si128((__m128i *)&musyx->left[i],  _mm_adds_epi16(l, v1));
+        _mm_storeu_si128((__m128i *)&musyx->right[i], _mm_adds_epi16(r, v1));
+        _mm_storeu_si128((__m128i *)&musyx->cc0[i],   _mm_adds_epi16(c, v2));
+    }
+#elif defined(HLE_NEON)
+    for (; i < SUBFRAME_SIZE; i += 8) {
+        int16x8_t v  = vld1q_s16(&subframe[i]);
+        int16x8_t v1 = vcombine_s16(vshrn_n_s32(vmull_n_s16(vget_low_s16(v),  g1), 16),
+                                    vshrn_n_s32(vmull_n_s16(vget_high_s16(v), g1), 16));
+        int16x8_t v2 = vcombine_s16(vshrn_n_s32(vmull_n_s16(vget_low_s16(v),  g2), 16),
+                                    vshrn_n_s32(vmull_n_s16(vget_high_s16(v), g2), 16));
+
+        v1 = vaddq_s16(v1, vandq_s16(v, vdupq_n_s16(m1)));
+        v2 = vaddq_s16(v2, vandq_s16(v, vdupq_n_s16(m2)));
+
+        vst1q_s16(&musyx->left[i],  vqaddq_s16(vld1q_s16(&musyx->left[i]),  v1));
+        vst1q_s16(&musyx->right[i], vqaddq_s16(vld1q_s16(&musyx->right[i]), v1));
+        vst1q_s16(&musyx->cc0[i],   vqaddq_s16(vld1q_s16(&musyx->cc0[i]),   v2));
+    }
+#endif
 
-    for (i = 0; i < SUBFRAME_SIZE; ++i) {
+    for (; i < SUBFRAME_SIZE; ++i) {
         int16_t v = subframe[i];
         int16_t v1 = (int32_t)(v * gains[0]) >> 16;
         int16_t v2 = (int32_t)(v * gains[1]) >> 16;
@@ -879,6 +944,162 @@ static void mix_sfx_with_main_subframes_v2(musyx_t *musyx, const int16_t *subfra
     }
 }
 
+#if defined(HLE_SSE2)
+/* t[j][i] = rows[i][j] for 8 rows of 4 samples */
+static inline void transpose_8x4(__m128i *t, const int16_t *const *rows)
+{
+    __m128i r01 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)rows[0]),
+                                     _mm_loadl_epi64((const __m128i *)rows[1]));
+    __m128i r23 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)rows[2]),
+                                     _mm_loadl_epi64((const __m128i *)rows[3]));
+    __m128i r45 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)rows[4]),
+                                     _mm_loadl_epi64((const __m128i *)rows[5]));
+    __m128i r67 = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)rows[6]),
+                                     _mm_loadl_epi64((const __m128i *)rows[7]));
+    __m128i r0123_lo = _mm_unpacklo_epi32(r01, r23);
+    __m128i r0123_hi = _mm_unpackhi_epi32(r01, r23);
+    __m128i r4567_lo = _mm_unpacklo_epi32(r45, r67);
+    __m128i r4567_hi = _mm_unpackhi_epi32(r45, r67);
+
+    t[0] = _mm_unpacklo_epi64(r0123_lo, r4567_lo);
+    t[1] = _mm_unpackhi_epi64(r0123_lo, r4567_lo);
+    t[2] = _mm_unpacklo_epi64(r0123_hi, r4567_hi);
+    t[3] = _mm_unpackhi_epi64(r0123_hi, r4567_hi);
+}
+#elif defined(HLE_NEON)
+/* t[j][i] = rows[i][j] for 4 rows of 4 samples */
+static inline void transpose_4x4(int16x4_t *t, const int16_t *const *rows)
+{
+    int16x4x2_t r01 = vtrn_s16(vld1_s16(rows[0]), vld1_s16(rows[1]));
+    int16x4x2_t r23 = vtrn_s16(vld1_s16(rows[2]), vld1_s16(rows[3]));
+    int32x2x2_t even = vtrn_s32(vreinterpret_s32_s16(r01.val[0]), vreinterpret_s32_s16(r23.val[0]));
+    int32x2x2_t odd  = vtrn_s32(vreinterpret_s32_s16(r01.val[1]), vreinterpret_s32_s16(r23.val[1]));
+
+    t[0] = vreinterpret_s16_s32(even.val[0]);
+    t[1] = vreinterpret_s16_s32(odd.val[0]);
+    t[2] = vreinterpret_s16_s32(even.val[1]);
+    t[3] = vreinterpret_s16_s32(odd.val[1]);
+}
+#endif
+
+/* dst[i] = dot4(samples[i], luts[i]), luts pointing into RESAMPLE_LUT */
+static void resample_subframe(int16_t *dst, const int16_t *const *samples,
+                              const int16_t *const *luts)
+{
+    unsigned int i = 0;
+
+    /* The vector paths compute dot4 in 16 bits: no coefficient of
+     * RESAMPLE_LUT is -0x8000, so each (x * h) >> 15 fits */
+#if defined(HLE_SSE2)
+    for (; i < SUBFRAME_SIZE; i += 8) {
+        __m128i x[4];
+        __m128i h[4];
+        __m128i accu = _mm_setzero_si128();
+        unsigned int k;
+
+        transpose_8x4(x, &samples[i]);
+        transpose_8x4(h, &luts[i]);
+
+        for (k = 0; k < 4; ++k) {
+            __m128i hi = _mm_slli_epi16(_mm_mulhi_epi16(x[k], h[k]), 1);
+            __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(x[k], h[k]), 15);
+
+            accu = _mm_adds_epi16(accu, _mm_or_si128(hi, lo));
+        }
+
+        _mm_storeu_si128((__m128i *)&dst[i], accu);
+    }
+#elif defined(HLE_NEON)
+    for (; i < SUBFRAME_SIZE; i += 4) {
+        int16x4_t x[4];
+        int16x4_t h[4];
+        int16x4_t accu = vdup_n_s16(0);
+        unsigned int k;
+
+        transpose_4x4(x, &samples[i]);
+        transpose_4x4(h, &luts[i]);
+
+        for (k = 0; k < 4; ++k)
+            accu = vqadd_s16(accu, vshrn_n_s32(vmull_s16(x[k], h[k]), 15));
+
+        vst1_s16(&dst[i], accu);
+    }
+#endif
+
+    for (; i < SUBFRAME_SIZE; ++i)
+        dst[i] = clamp_s16(dot4(samples[i], luts[i]));
+}
+
+/* Mix src, scaled by a linear envelope, into dst.
+ * Returns the last scaled sample. */
+static int16_t envmix(int16_t *dst, const int16_t *src, int32_t env, int32_t env_step)
+{
+    unsigned int i = 0;
+    int32_t accu = 0;
+
+#if defined(HLE_SSE2) || defined(HLE_NEON)
+    /* the last samples go through the scalar loop, which leaves the last
+     * scaled sample in accu */
+    const int32_t envs[8] = {
+        env,
+        (int32_t)((uint32_t)env + 1 * (uint32_t)env_step),
+        (int32_t)((uint32_t)env + 2 * (uint32_t)env_step),
+        (int32_t)((uint32_t)env + 3 * (uint32_t)env_step),
+        (int32_t)((uint32_t)env + 4 * (uint32_t)env_step),
+        (int32_t)((uint32_t)env + 5 * (uint32_t)env_step),
+        (int32_t)((uint32_t)env + 6 * (uint32_t)env_step),
+        (int32_t)((uint32_t)env + 7 * (uint32_t)env_step)
+    };
+#endif
+
+#if defined(HLE_SSE2)
+    const __m128i step = _mm_set1_epi32((int32_t)(8 * (uint32_t)env_step));
+    __m128i env_lo = _mm_loadu_si128((const __m128i *)&envs[0]);
+    __m128i env_hi = _mm_loadu_si128((const __m128i *)&envs[4]);
+
+    for (; i + 8 < SUBFRAME_SIZE; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *)&src[i]);
+        __m128i y = _mm_loadu_si128((const __m128i *)&dst[i]);
+        __m128i e = _mm_packs_epi32(_mm_srai_epi32(env_lo, 16), _mm_srai_epi32(env_hi, 16));
+        __m128i lo = _mm_add_epi32(_mm_srai_epi32(simd_mull_lo(x, e), 15), simd_widen_lo(y));
+        __m128i hi = _mm_add_epi32(_mm_srai_epi32(simd_mull_hi(x, e), 15), simd_widen_hi(y));
+
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_packs_epi32(lo, hi));
+
+        env_lo = _mm_add_epi32(env_lo, step);
+        env_hi = _mm_add_epi32(env_hi, step);
+    }
+    env = (int32_t)((uint32_t)env + i * (uint32_t)env_step);
+#elif defined(HLE_NEON)
+    const int32x4_t step = vdupq_n_s32((int32_t)(8 * (uint32_t)env_step));
+    int32x4_t env_lo = vld1q_s32(&envs[0]);
+    int32x4_t env_hi = vld1q_s32(&envs[4]);
+
+    for (; i + 8 < SUBFRAME_SIZE; i += 8) {
+        int16x8_t x = vld1q_s16(&src[i]);
+        int16x8_t y = vld1q_s16(&dst[i]);
+        int32x4_t lo = vshrq_n_s32(vmull_s16(vget_low_s16(x),  vshrn_n_s32(env_lo, 16)), 15);
+        int32x4_t hi = vshrq_n_s32(vmull_s16(vget_high_s16(x), vshrn_n_s32(env_hi, 16)), 15);
+
+        lo = vaddw_s16(lo, vget_low_s16(y));
+        hi = vaddw_s16(hi, vget_high_s16(y));
+        vst1q_s16(&dst[i], vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+
+        env_lo = vaddq_s32(env_lo, step);
+        env_hi = vaddq_s32(env_hi, step);
+    }
+    env = (int32_t)((uint32_t)env + i * (uint32_t)env_step);
+#endif
+
+    for (; i < SUBFRAME_SIZE; ++i) {
+        accu = (src[i] * (env >> 16)) >> 15;
+        dst[i] = clamp_s16(accu + dst[i]);
+        env += env_step;
+    }
+
+    return clamp_s16(accu);
+}
+
 static void mix_samples(int16_t *y, int16_t x, int16_t hgain)
 {
     *y = clamp_s16(*y + ((x * hgain + 0x4000) >> 15));
@@ -886,15 +1107,42 @@ static void mix_samples(int16_t *y, int16_t x, int16_t hgain)
 
 static void mix_subframes(int16_t *y, const int16_t *x, int16_t hgain)
 {
-    unsigned int i;
+    unsigned int i = 0;
+
+#if defined(HLE_SSE2)
+    const __m128i h = _mm_set1_epi16(hgain);
+    const __m128i round = _mm_set1_epi32(0x4000);
+
+    for (; i < SUBFRAME_SIZE; i += 8) {
+        __m128i vx = _mm_loadu_si128((const __m128i *)&x[i]);
+        __m128i vy = _mm_loadu_si128((const __m128i *)&y[i]);
+        __m128i lo = _mm_srai_epi32(_mm_add_epi32(simd_mull_lo(vx, h), round), 15);
+        __m128i hi = _mm_srai_epi32(_mm_add_epi32(simd_mull_hi(vx, h), round), 15);
 
-    for (i = 0; i < SUBFRAME_SIZE; ++i)
+        lo = _mm_add_epi32(lo, simd_widen_lo(vy));
+        hi = _mm_add_epi32(hi, simd_widen_hi(vy));
+        _mm_storeu_si128((__m128i *)&y[i], _mm_packs_epi32(lo, hi));
+    }
+#elif defined(HLE_NEON)
+    for (; i < SUBFRAME_SIZE; i += 8) {
+        int16x8_t vx = vld1q_s16(&x[i]);
+        int16x8_t vy = vld1q_s16(&y[i]);
+        int32x4_t lo = vrshrq_n_s32(vmull_n_s16(vget_low_s16(vx),  hgain), 15);
+        int32x4_t hi = vrshrq_n_s32(vmull_n_s16(vget_high_s16(vx), hgain), 15);
+
+        lo = vaddw_s16(lo, vget_low_s16(vy));
+        hi = vaddw_s16(hi, vget_high_s16(vy));
+        vst1q_s16(&y[i], vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+#endif
+
+    for (; i < SUBFRAME_SIZE; ++i)
         mix_samples(&y[i], x[i], hgain);
 }
 
 static void mix_fir4(int16_t *y, const int16_t *x, int16_t hgain, const int16_t *hcoeffs)
 {
-    unsigned int i;
+    unsigned int i = 0;
     int32_t h[4];
 
     h[0] = (hgain * hcoeffs[0]) >> 15;
@@ -902,22 +1150,100 @@ static void mix_fir4(int16_t *y, const int16_t *x, int16_t hgain, const int16_t
     h[2] = (hgain * hcoeffs[2]) >> 15;
     h[3] = (hgain * hcoeffs[3]) >> 15;
 
-    for (i = 0; i < SUBFRAME_SIZE; ++i) {
+#if defined(HLE_SSE2) || defined(HLE_NEON)
+    /* h is 0x8000 when hgain and a coefficient are both -0x8000, which does
+     * not fit the 16-bit multipliers: leave it to the scalar loop */
+    if (h[0] <= INT16_MAX && h[1] <= INT16_MAX && h[2] <= INT16_MAX && h[3] <= INT16_MAX) {
+#if defined(HLE_SSE2)
+        const __m128i h01 = _mm_set_epi16(h[1], h[0], h[1], h[0], h[1], h[0], h[1], h[0]);
+        const __m128i h23 = _mm_set_epi16(h[3], h[2], h[3], h[2], h[3], h[2], h[3], h[2]);
+
+        for (; i < SUBFRAME_SIZE; i += 8) {
+            __m128i x0 = _mm_loadu_si128((const __m128i *)&x[i]);
+            __m128i x1 = _mm_loadu_si128((const __m128i *)&x[i + 1]);
+            __m128i x2 = _mm_loadu_si128((const __m128i *)&x[i + 2]);
+            __m128i x3 = _mm_loadu_si128((const __m128i *)&x[i + 3]);
+            __m128i vy = _mm_loadu_si128((const __m128i *)&y[i]);
+            __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(x0, x1), h01),
+                                       _mm_madd_epi16(_mm_unpacklo_epi16(x2, x3), h23));
+            __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(x0, x1), h01),
+                                       _mm_madd_epi16(_mm_unpackhi_epi16(x2, x3), h23));
+
+            lo = _mm_add_epi32(_mm_srai_epi32(lo, 15), simd_widen_lo(vy));
+            hi = _mm_add_epi32(_mm_srai_epi32(hi, 15), simd_widen_hi(vy));
+            _mm_storeu_si128((__m128i *)&y[i], _mm_packs_epi32(lo, hi));
+        }
+#else
+        for (; i < SUBFRAME_SIZE; i += 8) {
+            int16x8_t x0 = vld1q_s16(&x[i]);
+            int16x8_t x1 = vld1q_s16(&x[i + 1]);
+            int16x8_t x2 = vld1q_s16(&x[i + 2]);
+            int16x8_t x3 = vld1q_s16(&x[i + 3]);
+            int16x8_t vy = vld1q_s16(&y[i]);
+            int32x4_t lo = vmull_n_s16(vget_low_s16(x0), h[0]);
+            int32x4_t hi = vmull_n_s16(vget_high_s16(x0), h[0]);
+
+            lo = vmlal_n_s16(lo, vget_low_s16(x1),  h[1]);
+            hi = vmlal_n_s16(hi, vget_high_s16(x1), h[1]);
+            lo = vmlal_n_s16(lo, vget_low_s16(x2),  h[2]);
+            hi = vmlal_n_s16(hi, vget_high_s16(x2), h[2]);
+            lo = vmlal_n_s16(lo, vget_low_s16(x3),  h[3]);
+            hi = vmlal_n_s16(hi, vget_high_s16(x3), h[3]);
+
+            lo = vaddw_s16(vshrq_n_s32(lo, 15), vget_low_s16(vy));
+            hi = vaddw_s16(vshrq_n_s32(hi, 15), vget_high_s16(vy));
+            vst1q_s16(&y[i], vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+        }
+#endif
+    }
+#endif
+
+    for (; i < SUBFRAME_SIZE; ++i) {
         int32_t v = (h[0] * x[i] + h[1] * x[i + 1] + h[2] * x[i + 2] + h[3] * x[i + 3]) >> 15;
         y[i] = clamp_s16(y[i] + v);
     }
 }
 
+/* dst[i] = (l[i] << 16) | r[i] */
+static void interleave_subframes(uint32_t *dst, const int16_t *left, const int16_t *right)
+{
+    size_t i = 0;
+
+#if defined(HLE_SSE2)
+    for (; i < SUBFRAME_SIZE; i += 8) {
+        __m128i l = _mm_loadu_si128((const __m128i *)&left[i]);
+        __m128i r = _mm_loadu_si128((const __m128i *)&right[i]);
+
+        _mm_storeu_si128((__m128i *)&dst[i],     _mm_unpacklo_epi16(r, l));
+        _mm_storeu_si128((__m128i *)&dst[i + 4], _mm_unpackhi_epi16(r, l));
+    }
+#elif defined(HLE_NEON)
+    for (; i < SUBFRAME_SIZE; i += 8) {
+        int16x8x2_t rl;
+
+        rl.val[0] = vld1q_s16(&right[i]);
+        rl.val[1] = vld1q_s16(&left[i]);
+        vst2q_s16((int16_t *)&dst[i], rl);
+    }
+#endif
+
+    for (; i < SUBFRAME_SIZE; ++i) {
+        uint16_t l = left[i];
+        uint16_t r = right[i];
+
+        dst[i] = (l << 16) | r;
+    }
+}
+
 static void interleave_stage_v1(struct hle_t* hle, musyx_t *musyx, uint32_t output_ptr)
 {
-    size_t i;
+    size_t i = 0;
 
     int16_t base_left;
     int16_t base_right;
 
     int16_t *left;
     int16_t *right;
-    uint32_t *dst;
 
     HleVerboseMessage(hle->user_defined, "interleave: %08x", output_ptr);
 
@@ -926,14 +1252,28 @@ static void interleave_stage_v1(struct hle_t* hle, musyx_t *musyx, uint32_t outp
 
     left  = musyx->left;
     right = musyx->right;
-    dst  = dram_u32(hle, output_ptr);
 
-    for (i = 0; i < SUBFRAME_SIZE; ++i) {
-        uint16_t l = clamp_s16(*(left++)  + base_left);
-        uint16_t r = clamp_s16(*(right++) + base_right);
+#if defined(HLE_SSE2)
+    for (; i < SUBFRAME_SIZE; i += 8) {
+        __m128i l = _mm_loadu_si128((const __m128i *)&left[i]);
+        __m128i r = _mm_loadu_si128((const __m128i *)&right[i]);
+
+        _mm_storeu_si128((__m128i *)&left[i],  _mm_adds_epi16(l, _mm_set1_epi16(base_left)));
+        _mm_storeu_si128((__m128i *)&right[i], _mm_adds_epi16(r, _mm_set1_epi16(base_right)));
+    }
+#elif defined(HLE_NEON)
+    for (; i < SUBFRAME_SIZE; i += 8) {
+        vst1q_s16(&left[i],  vqaddq_s16(vld1q_s16(&left[i]),  vdupq_n_s16(base_left)));
+        vst1q_s16(&right[i], vqaddq_s16(vld1q_s16(&right[i]), vdupq_n_s16(base_right)));
+    }
+#endif
 
-        *(dst++) = (l << 16) | r;
+    for (; i < SUBFRAME_SIZE; ++i) {
+        left[i]  = clamp_s16(left[i]  + base_left);
+        right[i] = clamp_s16(right[i] + base_right);
     }
+
+    interleave_subframes(dram_u32(hle, output_ptr), left, right);
 }
 
 static void interleave_stage_v2(struct hle_t* hle, musyx_t *musyx,
@@ -942,7 +1282,7 @@ static void interleave_stage_v2(struct hle_t* hle, musyx_t *musyx,
 {
     unsigned i, k;
     int16_t subframe[SUBFRAME_SIZE];
-    uint32_t *dst;
+    int16_t samples[3][SUBFRAME_SIZE];
     uint16_t mask;
 
     HleVerboseMessage(hle->user_defined,
@@ -968,20 +1308,15 @@ static void interleave_stage_v2(struct hle_t* hle, musyx_t *musyx,
         address = *dram_u32(hle, ptr_18);
         hgain   = *dram_u16(hle, ptr_18 + 4);
 
-        for(i = 0; i < SUBFRAME_SIZE; ++i, address += 2) {
-            mix_samples(&musyx->left[i],  *dram_u16(hle, address), hgain);
-            mix_samples(&musyx->right[i], *dram_u16(hle, address + 2*SUBFRAME_SIZE), hgain);
-            mix_samples(&subframe[i],     *dram_u16(hle, address + 4*SUBFRAME_SIZE), hgain);
-        }
+        dram_load_u16(hle, (uint16_t *)samples, address, 3 * SUBFRAME_SIZE);
+
+        mix_subframes(musyx->left,  samples[0], hgain);
+        mix_subframes(musyx->right, samples[1], hgain);
+        mix_subframes(subframe,     samples[2], hgain);
     }
 
     /* interleave L_total and R_total */
-    dst = dram_u32(hle, output_ptr);
-    for(i = 0; i < SUBFRAME_SIZE; ++i) {
-        uint16_t l = musyx->left[i];
-        uint16_t r = musyx->right[i];
-        *(dst++) = (l << 16) | r;
-    }
+    interleave_subframes(dram_u32(hle, output_ptr), musyx->left, musyx->right);
 
     /* writeback subframe @ptr_1c */
     dram_store_u16(hle, (uint16_t*)subframe, ptr_1c, SUBFRAME_SIZE);
@@ -0,0 +1,67 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - simd.h                                          *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+/* SSE2 and NEON paths of the audio ucodes.
+ *
+ * They must give the same results as the scalar code, bit for bit, which
+ * stays next to them as the reference and for the other hosts.
+ * Define HLE_NO_SIMD to build the scalar code only. */
+
+#if !defined(HLE_NO_SIMD) && !defined(M64P_BIG_ENDIAN)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HLE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HLE_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#include "common.h"
+
+#if defined(HLE_SSE2)
+/* 32-bit products of the low (high) four int16 lanes of x and y */
+static inline __m128i simd_mull_lo(__m128i x, __m128i y)
+{
+    return _mm_unpacklo_epi16(_mm_mullo_epi16(x, y), _mm_mulhi_epi16(x, y));
+}
+
+static inline __m128i simd_mull_hi(__m128i x, __m128i y)
+{
+    return _mm_unpackhi_epi16(_mm_mullo_epi16(x, y), _mm_mulhi_epi16(x, y));
+}
+
+/* sign extension of the low (high) four int16 lanes of x */
+static inline __m128i simd_widen_lo(__m128i x)
+{
+    return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+}
+
+static inline __m128i simd_widen_hi(__m128i x)
+{
+    return _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+}
+#endif
+
+#endif